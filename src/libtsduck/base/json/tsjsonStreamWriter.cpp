@@ -0,0 +1,288 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsjsonStreamWriter.h"
+#include "tsxmlElement.h"
+#include "tsxmlText.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::json::StreamWriter::StreamWriter(TextFormatter& output, bool compact) :
+    _out(output),
+    _compact(compact),
+    _levels()
+{
+}
+
+ts::json::StreamWriter::~StreamWriter()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Start and terminate a value in the current level.
+//----------------------------------------------------------------------------
+
+void ts::json::StreamWriter::startValue(const UString& name)
+{
+    if (_levels.empty()) {
+        // Top-level value.
+        if (!_compact) {
+            _out << ts::margin;
+        }
+    }
+    else {
+        Level& level(_levels.back());
+        if (level.count++ > 0) {
+            _out << ",";
+        }
+        if (!_compact) {
+            _out << std::endl << ts::margin;
+        }
+        if (!level.is_array) {
+            _out << '"' << name.toJSON() << (_compact ? "\":" : "\": ");
+        }
+    }
+}
+
+void ts::json::StreamWriter::endValue()
+{
+    // Each top-level value is terminated by a new line, even in compact mode.
+    if (_levels.empty()) {
+        _out << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Open and close objects and arrays.
+//----------------------------------------------------------------------------
+
+void ts::json::StreamWriter::beginLevel(const UString& name, bool is_array, char opening)
+{
+    startValue(name);
+    _out << opening;
+    if (!_compact) {
+        _out << ts::indent;
+    }
+    _levels.push_back({is_array, 0});
+}
+
+void ts::json::StreamWriter::endLevel(bool is_array, char closing)
+{
+    if (!_levels.empty() && _levels.back().is_array == is_array) {
+        const size_t count = _levels.back().count;
+        _levels.pop_back();
+        if (!_compact) {
+            _out << ts::unindent;
+            if (count > 0) {
+                _out << std::endl << ts::margin;
+            }
+        }
+        _out << closing;
+        endValue();
+    }
+}
+
+void ts::json::StreamWriter::beginObject(const UString& name)
+{
+    beginLevel(name, false, '{');
+}
+
+void ts::json::StreamWriter::endObject()
+{
+    endLevel(false, '}');
+}
+
+void ts::json::StreamWriter::beginArray(const UString& name)
+{
+    beginLevel(name, true, '[');
+}
+
+void ts::json::StreamWriter::endArray()
+{
+    endLevel(true, ']');
+}
+
+void ts::json::StreamWriter::close()
+{
+    while (!_levels.empty()) {
+        endLevel(_levels.back().is_array, _levels.back().is_array ? ']' : '}');
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Add simple values.
+//----------------------------------------------------------------------------
+
+void ts::json::StreamWriter::addString(const UString& name, const UString& value)
+{
+    startValue(name);
+    _out << '"' << value.toJSON() << '"';
+    endValue();
+}
+
+void ts::json::StreamWriter::addInteger(const UString& name, int64_t value)
+{
+    startValue(name);
+    _out << value;
+    endValue();
+}
+
+void ts::json::StreamWriter::addBoolean(const UString& name, bool value)
+{
+    startValue(name);
+    _out << (value ? "true" : "false");
+    endValue();
+}
+
+void ts::json::StreamWriter::addNull(const UString& name)
+{
+    startValue(name);
+    _out << "null";
+    endValue();
+}
+
+
+
+//----------------------------------------------------------------------------
+// Add a copy of an existing JSON value.
+//----------------------------------------------------------------------------
+
+void ts::json::StreamWriter::addValue(const UString& name, const Value& value)
+{
+    switch (value.type()) {
+        case TypeNull:
+            addNull(name);
+            break;
+        case TypeTrue:
+            addBoolean(name, true);
+            break;
+        case TypeFalse:
+            addBoolean(name, false);
+            break;
+        case TypeString:
+            addString(name, value.toString());
+            break;
+        case TypeNumber:
+            addInteger(name, value.toInteger());
+            break;
+        case TypeObject: {
+            UStringList names;
+            value.getNames(names);
+            beginObject(name);
+            for (auto it = names.begin(); it != names.end(); ++it) {
+                addValue(*it, value.value(*it));
+            }
+            endObject();
+            break;
+        }
+        case TypeArray: {
+            beginArray(name);
+            for (size_t i = 0; i < value.size(); ++i) {
+                addValue(UString(), value.at(i));
+            }
+            endArray();
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Add an XML element as a JSON object.
+//----------------------------------------------------------------------------
+
+void ts::json::StreamWriter::addXML(const UString& name, const xml::Element* element)
+{
+    if (element != nullptr) {
+        beginObject(name);
+        addXMLContent(element);
+        endObject();
+    }
+}
+
+void ts::json::StreamWriter::addXMLContent(const xml::Element* element)
+{
+    if (element == nullptr) {
+        return;
+    }
+
+    // Element name and attributes, in the same order as in the XML text.
+    // The attribute values are kept as strings: without the XML model, a string
+    // which looks like a number (a service name for instance) cannot be distinguished
+    // from an integer value and its representation would be lost.
+    addString(u"#name", element->name());
+    UStringList names;
+    element->getAttributesNamesInModificationOrder(names);
+    for (auto it = names.begin(); it != names.end(); ++it) {
+        addString(*it, element->attribute(*it, true).value());
+    }
+
+    // Children elements and text nodes. The array is open on the first meaningful child only.
+    bool nodes = false;
+    for (const xml::Node* node = element->firstChild(); node != nullptr; node = node->nextSibling()) {
+        const xml::Element* child = dynamic_cast<const xml::Element*>(node);
+        const xml::Text* text = dynamic_cast<const xml::Text*>(node);
+        UString str;
+        if (text != nullptr) {
+            // Compact all sequences of spaces, typically in multi-line hexadecimal content.
+            UStringVector words;
+            text->value().toSubstituted(LINE_FEED, SPACE).toSubstituted(CARRIAGE_RETURN, SPACE).toSubstituted(HORIZONTAL_TABULATION, SPACE).split(words, SPACE, true, true);
+            str = UString::Join(words, u" ");
+            if (str.empty()) {
+                continue;
+            }
+        }
+        else if (child == nullptr) {
+            continue;
+        }
+        if (!nodes) {
+            nodes = true;
+            beginArray(u"#nodes");
+        }
+        if (child != nullptr) {
+            addXML(UString(), child);
+        }
+        else {
+            addString(UString(), str);
+        }
+    }
+    if (nodes) {
+        endArray();
+    }
+}
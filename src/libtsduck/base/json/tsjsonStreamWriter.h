@@ -0,0 +1,208 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Streaming JSON writer, without in-memory tree.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsjsonValue.h"
+
+namespace ts {
+    namespace xml {
+        class Element;
+    }
+    namespace json {
+        //!
+        //! Streaming JSON writer.
+        //! @ingroup json
+        //!
+        //! Unlike the ts::json::Value classes, this class does not build any in-memory tree.
+        //! Values are directly serialized on a text formatter as they are added. Objects and
+        //! arrays are explicitly opened and closed. The writer only tracks the stack of currently
+        //! open objects and arrays.
+        //!
+        //! Each method which adds a value takes a name. The name is used only when the value is
+        //! added inside an object. It is ignored when the value is added inside an array or at
+        //! top level.
+        //!
+        //! Several top-level values can be written in sequence. Each top-level value is terminated
+        //! by a new line. In compact mode, each value is entirely written on one line, without
+        //! any space. A sequence of top-level values in compact mode is therefore a stream of
+        //! line-delimited JSON (also known as "JSON lines" or "NDJSON").
+        //!
+        class TSDUCKDLL StreamWriter
+        {
+            TS_NOBUILD_NOCOPY(StreamWriter);
+        public:
+            //!
+            //! Constructor.
+            //! @param [in,out] output The text formatter where the JSON text is written.
+            //! The formatter must remain valid as long as this object is used.
+            //! @param [in] compact If true, generate compact one-line values.
+            //!
+            explicit StreamWriter(TextFormatter& output, bool compact = false);
+
+            //!
+            //! Destructor.
+            //! All open objects and arrays are closed.
+            //!
+            ~StreamWriter();
+
+            //!
+            //! Set compact mode.
+            //! Should be set between top-level values only.
+            //! @param [in] compact If true, generate compact one-line values.
+            //!
+            void setCompact(bool compact) { _compact = compact; }
+
+            //!
+            //! Check if compact mode is used.
+            //! @return True if compact mode is used.
+            //!
+            bool isCompact() const { return _compact; }
+
+            //!
+            //! Get the current depth of open objects and arrays.
+            //! @return The number of currently open objects and arrays, zero at top level.
+            //!
+            size_t depth() const { return _levels.size(); }
+
+            //!
+            //! Open a new object.
+            //! @param [in] name Name of the object in the enclosing object.
+            //!
+            void beginObject(const UString& name = UString());
+
+            //!
+            //! Close the current object.
+            //! Ignored if the current level is not an object.
+            //!
+            void endObject();
+
+            //!
+            //! Open a new array.
+            //! @param [in] name Name of the array in the enclosing object.
+            //!
+            void beginArray(const UString& name = UString());
+
+            //!
+            //! Close the current array.
+            //! Ignored if the current level is not an array.
+            //!
+            void endArray();
+
+            //!
+            //! Close all open objects and arrays.
+            //!
+            void close();
+
+            //!
+            //! Add a string value.
+            //! @param [in] name Name of the value in the enclosing object.
+            //! @param [in] value The value to add.
+            //!
+            void addString(const UString& name, const UString& value);
+
+            //!
+            //! Add an integer value.
+            //! @param [in] name Name of the value in the enclosing object.
+            //! @param [in] value The value to add.
+            //!
+            void addInteger(const UString& name, int64_t value);
+
+            //!
+            //! Add a boolean value.
+            //! @param [in] name Name of the value in the enclosing object.
+            //! @param [in] value The value to add.
+            //!
+            void addBoolean(const UString& name, bool value);
+
+            //!
+            //! Add a null value.
+            //! @param [in] name Name of the value in the enclosing object.
+            //!
+            void addNull(const UString& name);
+
+            //!
+            //! Add a copy of an existing JSON value.
+            //! @param [in] name Name of the value in the enclosing object.
+            //! @param [in] value The value to serialize.
+            //!
+            void addValue(const UString& name, const Value& value);
+
+            //!
+            //! Add an XML element as a JSON object.
+            //!
+            //! The XML element is translated as an object. The name of the element is
+            //! stored in a field named "#name". The attributes are translated as fields
+            //! of the object, in their order of creation. Their values are always strings,
+            //! exactly as in the XML text, because the XML element alone does not tell if a
+            //! value is a number or a string which looks like a number. The children elements
+            //! and the non-empty text nodes are stored in an array named "#nodes". Comments
+            //! and other XML nodes are ignored.
+            //!
+            //! @param [in] name Name of the object in the enclosing object.
+            //! @param [in] element The XML element to serialize. Ignored if null.
+            //!
+            void addXML(const UString& name, const xml::Element* element);
+
+            //!
+            //! Add the content of an XML element in the currently open object.
+            //! Same as addXML() without opening and closing a new object.
+            //! This is useful to add application-specific fields in the same object.
+            //! @param [in] element The XML element to serialize. Ignored if null.
+            //!
+            void addXMLContent(const xml::Element* element);
+
+        private:
+            // Description of an open object or array.
+            struct Level
+            {
+                bool   is_array;  // Array or object.
+                size_t count;     // Number of values in that level.
+            };
+
+            TextFormatter&     _out;
+            bool               _compact;
+            std::vector<Level> _levels;
+
+            // Start a new value in the current level, output separator and name if necessary.
+            void startValue(const UString& name);
+
+            // Terminate a value, output a new line after top-level values.
+            void endValue();
+
+            // Open and close a level.
+            void beginLevel(const UString& name, bool is_array, char opening);
+            void endLevel(bool is_array, char closing);
+        };
+    }
+}
@@ -52,7 +52,10 @@ ts::UDPReceiver::UDPReceiver(ts::Report& report, bool with_short_options, bool d
     _recv_timeout(-1),
     _use_source(),
     _first_source(),
-    _sources()
+    _sources(),
+    _report_drops(false),
+    _reported_drops(0),
+    _next_drops_report()
 {
 }
 
@@ -104,6 +107,12 @@ void ts::UDPReceiver::defineArgs(ts::Args& args) const
     args.help(u"no-reuse-port",
               u"Disable the reuse port socket option. Do not use unless completely necessary.");
 
+    args.option(u"report-drops");
+    args.help(u"report-drops",
+              u"Report the UDP datagrams which are dropped by the kernel when the socket receive "
+              u"buffer overflows. A warning is displayed, at most once per second, when new losses "
+              u"are detected. This option is currently supported on Linux only.");
+
     args.option(u"reuse-port", _with_short_options ? 'r' : 0);
     args.help(u"reuse-port",
               u"Set the reuse port socket option. This is now enabled by default, the option "
@@ -152,6 +161,7 @@ bool ts::UDPReceiver::loadArgs(DuckContext& duck, Args& args)
     _default_interface = args.present(u"default-interface");
     _use_ssm = args.present(u"ssm");
     _use_first_source = args.present(u"first-source");
+    _report_drops = args.present(u"report-drops");
     _recv_bufsize = args.intValue<size_t>(u"buffer-size", 0);
     _recv_timeout = args.intValue<MilliSecond>(u"receive-timeout", _recv_timeout); // preserve previous value
 
@@ -286,6 +296,8 @@ bool ts::UDPReceiver::open(ts::Report& report)
     // Clear collection of source address information.
     _first_source.clear();
     _sources.clear();
+    _reported_drops = 0;
+    _next_drops_report = Time::Epoch;
 
     // The local socket address to bind is the optional local IP address and the destination port.
     // Except on Linux, macOS and probably most Unix, when listening to a multicast group.
@@ -305,6 +317,7 @@ bool ts::UDPReceiver::open(ts::Report& report)
         UDPSocket::open(report) &&
         reusePort(_reuse_port, report) &&
         setReceiveTimestamps(_recv_timestamps, report) &&
+        (!_report_drops || setReceiveDropCounter(true, report)) &&
         (_recv_bufsize <= 0 || setReceiveBufferSize(_recv_bufsize, report)) &&
         (_recv_timeout < 0 || setReceiveTimeout(_recv_timeout, report)) &&
         bind(local_addr, report);
@@ -356,76 +369,142 @@ bool ts::UDPReceiver::receive(void* data,
         if (!UDPSocket::receive(data, max_size, ret_size, sender, destination, abort, report, timestamp)) {
             return false;
         }
+        reportDrops(report);
 
-        // Debug (level 2) message for each message.
-        if (report.maxSeverity() >= 2) {
-            // Prior report level checking to avoid evaluating parameters when not necessary.
-            report.log(2, u"received UDP packet, source: %s, destination: %s, timestamp: %'d", {sender, destination, timestamp != nullptr ? *timestamp : -1});
+        // Return the message if it matches all filtering criteria.
+        if (acceptMessage(sender, destination, timestamp != nullptr ? *timestamp : -1, report)) {
+            return true;
         }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Receive several messages. Override UDPSocket::receiveBatch().
+//----------------------------------------------------------------------------
+
+bool ts::UDPReceiver::receiveBatch(Datagram* msgs, size_t max_count, size_t& ret_count, const AbortInterface* abort, Report& report)
+{
+    // Loop on reception until at least one message matches the filtering criteria.
+    for (;;) {
 
-        // Check the destination address to exclude packets from other streams.
-        // When several multicast streams use the same destination port and several
-        // applications on the same system listen to these distinct streams,
-        // the multicast MAC address management is such that any socket which
-        // is bound to the common port will receive the traffic for all streams.
-        // This is why we need to check the destination address and exclude
-        // packets which are not from the intended stream.
-        //
-        // We accept a packet in any of:
-        // 1) Actual packet destination is unknown. Probably, the system cannot
-        //    report the destination address.
-        // 2) We listen to a multicast address and the actual destination is the same.
-        // 3) If we listen to unicast traffic and the actual destination is unicast.
-        //    In that case, unicast is by definition sent to us.
-
-        if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
-            // This is a spurious packet.
-            if (report.maxSeverity() >= Severity::Debug) {
-                // Prior report level checking to avoid evaluating parameters when not necessary.
-                report.debug(u"rejecting packet, destination: %s, expecting: %s", {destination, _dest_addr});
+        // Wait for UDP messages from the superclass.
+        size_t count = 0;
+        if (!UDPSocket::receiveBatch(msgs, max_count, count, abort, report)) {
+            ret_count = 0;
+            return false;
+        }
+        reportDrops(report);
+
+        // Keep only the messages which match the filtering criteria, in sequence.
+        ret_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (acceptMessage(msgs[i].sender, msgs[i].destination, msgs[i].timestamp, report)) {
+                if (ret_count < i) {
+                    msgs[ret_count].moveFrom(msgs[i]);
+                }
+                ret_count++;
             }
-            continue;
         }
+        if (ret_count > 0) {
+            return true;
+        }
+    }
+}
 
-        // Keep track of the first sender address.
-        if (!_first_source.hasAddress()) {
-            // First packet, keep address of the sender.
-            _first_source = sender;
-            _sources.insert(sender);
-
-            // With option --first-source, use this one to filter packets.
-            if (_use_first_source) {
-                assert(!_use_source.hasAddress());
-                _use_source = sender;
-                report.verbose(u"now filtering on source address %s", {sender});
-            }
+
+//----------------------------------------------------------------------------
+// Report new datagrams which were dropped by the kernel.
+//----------------------------------------------------------------------------
+
+void ts::UDPReceiver::reportDrops(Report& report)
+{
+    const uint64_t drops = receiveDropCount();
+    if (_report_drops && drops > _reported_drops) {
+        const Time now(Time::CurrentUTC());
+        if (now >= _next_drops_report) {
+            report.warning(u"%'d UDP datagrams dropped by the kernel (socket buffer overflow), total: %'d", {drops - _reported_drops, drops});
+            _reported_drops = drops;
+            _next_drops_report = now + MilliSecPerSec;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if a received message matches all filtering criteria.
+//----------------------------------------------------------------------------
+
+bool ts::UDPReceiver::acceptMessage(const SocketAddress& sender, const SocketAddress& destination, MicroSecond timestamp, Report& report)
+{
+    // Debug (level 2) message for each message.
+    if (report.maxSeverity() >= 2) {
+        // Prior report level checking to avoid evaluating parameters when not necessary.
+        report.log(2, u"received UDP packet, source: %s, destination: %s, timestamp: %'d", {sender, destination, timestamp});
+    }
+
+    // Check the destination address to exclude packets from other streams.
+    // When several multicast streams use the same destination port and several
+    // applications on the same system listen to these distinct streams,
+    // the multicast MAC address management is such that any socket which
+    // is bound to the common port will receive the traffic for all streams.
+    // This is why we need to check the destination address and exclude
+    // packets which are not from the intended stream.
+    //
+    // We accept a packet in any of:
+    // 1) Actual packet destination is unknown. Probably, the system cannot
+    //    report the destination address.
+    // 2) We listen to a multicast address and the actual destination is the same.
+    // 3) If we listen to unicast traffic and the actual destination is unicast.
+    //    In that case, unicast is by definition sent to us.
+
+    if (destination.hasAddress() && ((_dest_addr.hasAddress() && destination != _dest_addr) || (!_dest_addr.hasAddress() && destination.isMulticast()))) {
+        // This is a spurious packet.
+        if (report.maxSeverity() >= Severity::Debug) {
+            // Prior report level checking to avoid evaluating parameters when not necessary.
+            report.debug(u"rejecting packet, destination: %s, expecting: %s", {destination, _dest_addr});
         }
+        return false;
+    }
 
-        // Keep track of senders (sources) to detect or filter multiple sources.
-        if (_sources.count(sender) == 0) {
-            // Detected an additional source, warn the user that distinct streams are potentially mixed.
-            // If no source filtering is applied, this is a warning since this may affect the resulting stream.
-            // With source filtering, this is just an informational verbose-level message.
-            const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
-            if (_sources.size() == 1) {
-                report.log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination});
-                report.log(level, u"detected source: %s", {_first_source});
-            }
-            report.log(level, u"detected source: %s", {sender});
-            _sources.insert(sender);
+    // Keep track of the first sender address.
+    if (!_first_source.hasAddress()) {
+        // First packet, keep address of the sender.
+        _first_source = sender;
+        _sources.insert(sender);
+
+        // With option --first-source, use this one to filter packets.
+        if (_use_first_source) {
+            assert(!_use_source.hasAddress());
+            _use_source = sender;
+            report.verbose(u"now filtering on source address %s", {sender});
         }
+    }
 
-        // Filter packets based on source address if requested.
-        if (!sender.match(_use_source)) {
-            // Not the expected source, this is a spurious packet.
-            if (report.maxSeverity() >= Severity::Debug) {
-                // Prior report level checking to avoid evaluating parameters when not necessary.
-                report.debug(u"rejecting packet, source: %s, expecting: %s", {sender, _use_source});
-            }
-            continue;
+    // Keep track of senders (sources) to detect or filter multiple sources.
+    if (_sources.count(sender) == 0) {
+        // Detected an additional source, warn the user that distinct streams are potentially mixed.
+        // If no source filtering is applied, this is a warning since this may affect the resulting stream.
+        // With source filtering, this is just an informational verbose-level message.
+        const int level = _use_source.hasAddress() ? Severity::Verbose : Severity::Warning;
+        if (_sources.size() == 1) {
+            report.log(level, u"detected multiple sources for the same destination %s with potentially distinct streams", {destination});
+            report.log(level, u"detected source: %s", {_first_source});
         }
+        report.log(level, u"detected source: %s", {sender});
+        _sources.insert(sender);
+    }
 
-        // Now found a packet matching all criteria.
-        return true;
+    // Filter packets based on source address if requested.
+    if (!sender.match(_use_source)) {
+        // Not the expected source, this is a spurious packet.
+        if (report.maxSeverity() >= Severity::Debug) {
+            // Prior report level checking to avoid evaluating parameters when not necessary.
+            report.debug(u"rejecting packet, source: %s, expecting: %s", {sender, _use_source});
+        }
+        return false;
     }
+
+    // Now found a packet matching all criteria.
+    return true;
 }
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsUDPSocket.h"
 #include "tsArgsSupplierInterface.h"
+#include "tsTime.h"
 
 namespace ts {
     //!
@@ -91,6 +92,11 @@ namespace ts {
                              const AbortInterface* abort = nullptr,
                              Report& report = CERR,
                              MicroSecond* timestamp = nullptr) override;
+        virtual bool receiveBatch(Datagram* msgs,
+                                  size_t max_count,
+                                  size_t& ret_count,
+                                  const AbortInterface* abort = nullptr,
+                                  Report& report = CERR) override;
 
     private:
         bool                    _with_short_options;
@@ -108,5 +114,14 @@ namespace ts {
         SocketAddress           _use_source;         // Filter on this socket address of sender (can be a simple filter of an SSM source).
         SocketAddress           _first_source;       // Socket address of first received packet.
         std::set<SocketAddress> _sources;            // Set of all detected packet sources.
+        bool                    _report_drops;       // Report datagrams which are dropped by the kernel.
+        uint64_t                _reported_drops;     // Number of already reported dropped datagrams.
+        Time                    _next_drops_report;  // Next time to report dropped datagrams.
+
+        // Check if a received message matches all filtering criteria.
+        bool acceptMessage(const SocketAddress& sender, const SocketAddress& destination, MicroSecond timestamp, Report& report);
+
+        // Report new datagrams which were dropped by the kernel.
+        void reportDrops(Report& report);
     };
 }
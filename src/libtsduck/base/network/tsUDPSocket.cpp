@@ -35,9 +35,13 @@
 #include "tsNullReport.h"
 TSDUCK_SOURCE;
 
-// Network timestampting feature in Linux.
+// Network timestampting and UDP segmentation offload features in Linux.
 #if defined(TS_LINUX)
 #include <linux/net_tstamp.h>
+#include <netinet/udp.h>
+#if !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
 #endif
 
 // Furiously idiotic Windows feature, see comment in receiveOne()
@@ -55,7 +59,20 @@ ts::UDPSocket::UDPSocket(bool auto_open, Report& report) :
     _local_address(),
     _default_destination(),
     _mcast(),
-    _ssmcast()
+    _ssmcast(),
+    _drop_count(0),
+    _use_gso(true),
+#if defined(TS_LINUX)
+    _mmsg_headers(),
+    _mmsg_vecs(),
+    _mmsg_senders(),
+    _mmsg_control(),
+    _smsg_headers(),
+    _smsg_vecs(),
+    _smsg_control()
+#else
+    _send_buffer()
+#endif
 {
     if (auto_open) {
         // Returned value ignored on purpose, the socket is marked as closed in the object on error.
@@ -86,6 +103,7 @@ bool ts::UDPSocket::open(Report& report)
     if (!createSocket(PF_INET, SOCK_DGRAM, IPPROTO_UDP, report)) {
         return false;
     }
+    _drop_count = 0;
 
     // Set the IP_PKTINFO option. This option is used to get the destination address of all
     // UDP packets arriving on this socket. Actual socket option is an int.
@@ -248,6 +266,25 @@ bool ts::UDPSocket::setReceiveTimestamps(bool on, Report& report)
 }
 
 
+//----------------------------------------------------------------------------
+// Enable or disable the kernel counter of dropped datagrams.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::setReceiveDropCounter(bool on, Report& report)
+{
+    // The option exists only on Linux and is silently ignored on other systems.
+#if defined(TS_LINUX)
+    int enable = int(on);
+    if (::setsockopt(getSocket(), SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) != 0) {
+        report.error(u"socket option SO_RXQ_OVFL: " + SocketErrorCodeMessage());
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Enable or disable the broadcast option.
 //----------------------------------------------------------------------------
@@ -428,6 +465,185 @@ bool ts::UDPSocket::send(const void* data, size_t size, const SocketAddress& des
 }
 
 
+//----------------------------------------------------------------------------
+// Send several messages in one operation.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::sendBatch(const OutputDatagram* msgs, size_t count, Report& report)
+{
+    return sendBatch(msgs, count, _default_destination, report);
+}
+
+bool ts::UDPSocket::sendBatch(const OutputDatagram* msgs, size_t count, const SocketAddress& dest, Report& report)
+{
+    if (msgs == nullptr || count == 0) {
+        return true;
+    }
+
+    ::sockaddr addr;
+    dest.copy(addr);
+
+#if defined(TS_LINUX)
+
+    const SocketErrorCode err = sendMany(msgs, count, addr);
+    if (err != SYS_SUCCESS) {
+        report.error(u"error sending UDP message: %s", {SocketErrorCodeMessage(err)});
+        return false;
+    }
+
+#else
+
+    // No multi-message system call, send messages one by one.
+    for (size_t i = 0; i < count; ++i) {
+        const void* data = msgs[i].data;
+        size_t size = msgs[i].size;
+        if (msgs[i].header_size > 0) {
+            // Build a contiguous message.
+            _send_buffer.copy(msgs[i].header, msgs[i].header_size);
+            _send_buffer.append(msgs[i].data, msgs[i].size);
+            data = _send_buffer.data();
+            size = _send_buffer.size();
+        }
+        if (::sendto(getSocket(), TS_SENDBUF_T(data), TS_SOCKET_SSIZE_T(size), 0, &addr, sizeof(addr)) < 0) {
+            report.error(u"error sending UDP message: " + SocketErrorCodeMessage());
+            return false;
+        }
+    }
+
+#endif
+
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Linux implementation of batch emission.
+//----------------------------------------------------------------------------
+
+#if defined(TS_LINUX)
+
+// Limits of UDP segmentation offload in the kernel.
+namespace {
+    constexpr size_t GSO_MAX_SEGMENTS = 64;     // UDP_MAX_SEGMENTS in kernel.
+    constexpr size_t GSO_MAX_SIZE = 65507;      // Max UDP payload over IPv4.
+}
+
+// Number of messages at start of list which can be sent in one GSO operation.
+// All segments must have the same size, except the last one which can be shorter.
+size_t ts::UDPSocket::gsoSegmentCount(const OutputDatagram* msgs, size_t count) const
+{
+    const size_t seg_size = msgs[0].header_size + msgs[0].size;
+    if (seg_size == 0) {
+        return 0;
+    }
+    size_t seg_count = 1;
+    size_t total_size = seg_size;
+    while (seg_count < count && seg_count < GSO_MAX_SEGMENTS) {
+        const size_t size = msgs[seg_count].header_size + msgs[seg_count].size;
+        if (size == 0 || size > seg_size || total_size + size > GSO_MAX_SIZE) {
+            break;
+        }
+        seg_count++;
+        total_size += size;
+        if (size < seg_size) {
+            // A shorter segment is always the last one.
+            break;
+        }
+    }
+    return seg_count;
+}
+
+// Send messages using sendmmsg() and UDP segmentation offload.
+ts::SocketErrorCode ts::UDPSocket::sendMany(const OutputDatagram* msgs, size_t count, ::sockaddr& addr)
+{
+    // Resize the work areas only when the batch is larger than the previous ones.
+    if (_smsg_headers.size() < count) {
+        _smsg_headers.resize(count);
+        _smsg_vecs.resize(2 * count);
+    }
+    if (_smsg_control.size() < CMSG_SPACE(sizeof(uint16_t))) {
+        _smsg_control.resize(CMSG_SPACE(sizeof(uint16_t)));
+    }
+
+    // Build the I/O vectors of all messages: header (if any) and payload.
+    size_t vec_count = 0;
+    size_t msg_vec_index = 0;
+    for (size_t i = 0; i < count; ++i) {
+        ::msghdr& hdr(_smsg_headers[i].msg_hdr);
+        TS_ZERO(hdr);
+        hdr.msg_name = &addr;
+        hdr.msg_namelen = sizeof(addr);
+        hdr.msg_iov = &_smsg_vecs[vec_count];
+        if (msgs[i].header_size > 0) {
+            _smsg_vecs[vec_count].iov_base = const_cast<void*>(msgs[i].header);
+            _smsg_vecs[vec_count].iov_len = msgs[i].header_size;
+            vec_count++;
+        }
+        _smsg_vecs[vec_count].iov_base = const_cast<void*>(msgs[i].data);
+        _smsg_vecs[vec_count].iov_len = msgs[i].size;
+        vec_count++;
+        hdr.msg_iovlen = vec_count - msg_vec_index;
+        msg_vec_index = vec_count;
+        _smsg_headers[i].msg_len = 0;
+    }
+
+    size_t index = 0;
+    while (index < count) {
+
+        // Try to send a sequence of messages of the same size in one GSO operation.
+        // The kernel splits the concatenated payload in segments of the same size.
+        const size_t seg_count = _use_gso ? gsoSegmentCount(msgs + index, count - index) : 0;
+        if (seg_count >= 2) {
+            ::msghdr hdr(_smsg_headers[index].msg_hdr);
+            hdr.msg_iovlen = size_t(_smsg_headers[index + seg_count - 1].msg_hdr.msg_iov - hdr.msg_iov) + _smsg_headers[index + seg_count - 1].msg_hdr.msg_iovlen;
+            hdr.msg_control = _smsg_control.data();
+            hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+            ::cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            const uint16_t seg_size = uint16_t(msgs[index].header_size + msgs[index].size);
+            ::memcpy(CMSG_DATA(cmsg), &seg_size, sizeof(seg_size));
+
+            if (::sendmsg(getSocket(), &hdr, 0) >= 0) {
+                index += seg_count;
+                continue;
+            }
+            const SocketErrorCode err = LastSocketErrorCode();
+            if (err == EINTR) {
+                continue;
+            }
+            else if (err != EIO && err != EINVAL && err != ENOPROTOOPT && err != EOPNOTSUPP) {
+                return err;
+            }
+            // GSO not supported by the kernel, the interface or for that segment size.
+            // Fallback to sendmmsg() and never use GSO again on this socket.
+            _use_gso = false;
+        }
+
+        // Send all subsequent messages which are not eligible to GSO in one call.
+        size_t end = index + 1;
+        while (end < count && (!_use_gso || gsoSegmentCount(msgs + end, count - end) < 2)) {
+            end++;
+        }
+        const int sent = ::sendmmsg(getSocket(), &_smsg_headers[index], unsigned(end - index), 0);
+        if (sent < 0) {
+            const SocketErrorCode err = LastSocketErrorCode();
+            if (err != EINTR) {
+                return err;
+            }
+        }
+        else {
+            // Some messages may be left unsent, loop again.
+            index += size_t(sent);
+        }
+    }
+    return SYS_SUCCESS;
+}
+
+#endif
+
+
 //----------------------------------------------------------------------------
 // Receive a message.
 // If abort interface is non-zero, invoke it when I/O is interrupted
@@ -599,6 +815,26 @@ ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data,
         return LastSocketErrorCode();
     }
 
+    // Browse returned ancillary data.
+    getAncillaryData(hdr, destination, timestamp);
+
+#endif // Windows vs. UNIX
+
+    // Successfully received a message
+    ret_size = size_t(insize);
+    sender = SocketAddress(sender_sock);
+
+    return SYS_SUCCESS;
+}
+
+
+//----------------------------------------------------------------------------
+// Analyze the ancillary data of a received message (UNIX only).
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+void ts::UDPSocket::getAncillaryData(::msghdr& hdr, SocketAddress& destination, MicroSecond* timestamp)
+{
     // Because of invalid definition of CMSG_NXTHDR in musl libc (Alpine Linux)
     TS_PUSH_WARNING()
     TS_GCC_NOWARNING(zero-as-null-pointer-constant)
@@ -612,7 +848,7 @@ ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data,
             destination = SocketAddress(info->ipi_addr, _local_address.port());
         }
 
-        // On Linux, look for receive timestamp.
+        // On Linux, look for receive timestamp and drop counter.
 #if defined(TS_LINUX)
         else if (timestamp != nullptr && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS && cmsg->cmsg_len >= sizeof(::timespec)) {
             // System time stamp in nanosecond.
@@ -623,16 +859,155 @@ ts::SocketErrorCode ts::UDPSocket::receiveOne(void* data,
                 *timestamp = nano / NanoSecPerMicroSec;
             }
         }
+        else if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL && cmsg->cmsg_len >= CMSG_LEN(sizeof(uint32_t))) {
+            // The kernel reports a 32-bit wrapping counter of drops since the socket creation.
+            uint32_t drops = 0;
+            ::memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+            const uint32_t previous = uint32_t(_drop_count);
+            _drop_count += uint32_t(drops - previous);
+        }
 #endif
     }
 
     TS_POP_WARNING()
+}
+#endif
 
-#endif // Windows vs. UNIX
 
-    // Successfully received a message
-    ret_size = size_t(insize);
-    sender = SocketAddress(sender_sock);
+//----------------------------------------------------------------------------
+// Move a received message from another datagram description.
+//----------------------------------------------------------------------------
+
+void ts::UDPSocket::Datagram::moveFrom(const Datagram& other)
+{
+    if (&other != this) {
+        size = std::min(other.size, max_size);
+        if (size > 0 && data != other.data) {
+            ::memmove(data, other.data, size);
+        }
+        sender = other.sender;
+        destination = other.destination;
+        timestamp = other.timestamp;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Receive several messages in one operation.
+//----------------------------------------------------------------------------
+
+bool ts::UDPSocket::receiveBatch(Datagram* msgs, size_t max_count, size_t& ret_count, const AbortInterface* abort, Report& report)
+{
+    ret_count = 0;
+    if (msgs == nullptr || max_count == 0) {
+        return true;
+    }
+
+    // Loop on unsollicited interrupts
+    for (;;) {
+
+        // Wait for at least one message.
+        size_t count = 0;
+        const SocketErrorCode err = receiveMany(msgs, max_count, count, report);
 
+        if (abort != nullptr && abort->aborting()) {
+            // Aborting, no error message.
+            return false;
+        }
+        else if (err == SYS_SUCCESS) {
+            // Sometimes, we get "successful" empty message coming from nowhere. Ignore them.
+            for (size_t i = 0; i < count; ++i) {
+                if (msgs[i].size > 0 || msgs[i].sender.hasAddress()) {
+                    if (ret_count < i) {
+                        msgs[ret_count].moveFrom(msgs[i]);
+                    }
+                    ret_count++;
+                }
+            }
+            if (ret_count > 0) {
+                return true;
+            }
+        }
+#if !defined(TS_WINDOWS)
+        else if (err == EINTR) {
+            // Got a signal, not a user interrupt, will ignore it
+            report.debug(u"signal, not user interrupt");
+        }
+#endif
+        else {
+            // Abort on non-interrupt errors.
+            report.error(u"error receiving from UDP socket: %s", {SocketErrorCodeMessage(err)});
+            return false;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Perform one batch receive operation.
+//----------------------------------------------------------------------------
+
+ts::SocketErrorCode ts::UDPSocket::receiveMany(Datagram* msgs, size_t max_count, size_t& ret_count, Report& report)
+{
+    ret_count = 0;
+
+#if defined(TS_LINUX)
+
+    // Size of ancillary data per message: destination address, timestamp, drop counter.
+    constexpr size_t ANCIL_SIZE = 256;
+
+    // Resize the work areas only when the batch is larger than the previous ones.
+    if (_mmsg_headers.size() < max_count) {
+        _mmsg_headers.resize(max_count);
+        _mmsg_vecs.resize(max_count);
+        _mmsg_senders.resize(max_count);
+        _mmsg_control.resize(max_count * ANCIL_SIZE);
+    }
+
+    // Build the array of message headers for recvmmsg().
+    for (size_t i = 0; i < max_count; ++i) {
+        TS_ZERO(_mmsg_senders[i]);
+        _mmsg_vecs[i].iov_base = msgs[i].data;
+        _mmsg_vecs[i].iov_len = msgs[i].max_size;
+        ::msghdr& hdr(_mmsg_headers[i].msg_hdr);
+        TS_ZERO(hdr);
+        hdr.msg_name = &_mmsg_senders[i];
+        hdr.msg_namelen = sizeof(::sockaddr);
+        hdr.msg_iov = &_mmsg_vecs[i];
+        hdr.msg_iovlen = 1;
+        hdr.msg_control = _mmsg_control.data() + i * ANCIL_SIZE;
+        hdr.msg_controllen = ANCIL_SIZE;
+        _mmsg_headers[i].msg_len = 0;
+    }
+
+    // Wait for at least one message, then get all available messages without waiting.
+    const int count = ::recvmmsg(getSocket(), _mmsg_headers.data(), unsigned(max_count), MSG_WAITFORONE, nullptr);
+    if (count < 0) {
+        return LastSocketErrorCode();
+    }
+
+    // Analyze all received messages.
+    for (size_t i = 0; i < size_t(count); ++i) {
+        Datagram& msg(msgs[i]);
+        msg.timestamp = -1;
+        msg.destination.clear();
+        getAncillaryData(_mmsg_headers[i].msg_hdr, msg.destination, &msg.timestamp);
+        msg.size = size_t(_mmsg_headers[i].msg_len);
+        msg.sender = SocketAddress(_mmsg_senders[i]);
+    }
+    ret_count = size_t(count);
     return SYS_SUCCESS;
+
+#else
+
+    // No multi-message system call, receive one message only.
+    Datagram& msg(msgs[0]);
+    msg.timestamp = -1;
+    const SocketErrorCode err = receiveOne(msg.data, msg.max_size, msg.size, msg.sender, msg.destination, report, &msg.timestamp);
+    if (err == SYS_SUCCESS) {
+        ret_count = 1;
+    }
+    return err;
+
+#endif
 }
@@ -39,6 +39,7 @@
 #include "tsAbortInterface.h"
 #include "tsReport.h"
 #include "tsMemory.h"
+#include "tsByteBlock.h"
 
 namespace ts {
     //!
@@ -204,6 +205,29 @@ namespace ts {
         //!
         bool setReceiveTimestamps(bool on, Report& report = CERR);
 
+        //!
+        //! Enable or disable the kernel counter of dropped datagrams.
+        //!
+        //! When enabled, each received UDP packet comes with the number of datagrams which were
+        //! dropped by the kernel on this socket because the receive buffer was full.
+        //! See receiveDropCount().
+        //!
+        //! Currently, this option is supported on Linux only (SO_RXQ_OVFL). It is ignored on other systems.
+        //!
+        //! @param [in] on If true, the drop counter is activated on the socket. Otherwise, it is disabled.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        bool setReceiveDropCounter(bool on, Report& report = CERR);
+
+        //!
+        //! Get the number of datagrams which were dropped by the kernel on this socket.
+        //! The value is updated each time a datagram is received, when the drop counter
+        //! is enabled using setReceiveDropCounter().
+        //! @return The total number of dropped datagrams since the socket was opened.
+        //!
+        uint64_t receiveDropCount() const { return _drop_count; }
+
         //!
         //! Enable or disable the broadcast option.
         //!
@@ -305,6 +329,70 @@ namespace ts {
         //!
         virtual bool send(const void* data, size_t size, Report& report = CERR);
 
+        //!
+        //! Description of one outgoing datagram in a batch emission with sendBatch().
+        //! A datagram is made of an optional header, followed by a payload. Both
+        //! parts are sent from their own location, without intermediate copy.
+        //!
+        struct TSDUCKDLL OutputDatagram
+        {
+            const void* header;       //!< Address of the header of the message, can be null.
+            size_t      header_size;  //!< Size in bytes of the header, can be zero.
+            const void* data;         //!< Address of the payload of the message.
+            size_t      size;         //!< Size in bytes of the payload.
+
+            //!
+            //! Constructor.
+            //! @param [in] data_ Address of the payload of the message.
+            //! @param [in] size_ Size in bytes of the payload.
+            //! @param [in] header_ Address of the header of the message.
+            //! @param [in] header_size_ Size in bytes of the header.
+            //!
+            OutputDatagram(const void* data_ = nullptr, size_t size_ = 0, const void* header_ = nullptr, size_t header_size_ = 0) :
+                header(header_), header_size(header_size_), data(data_), size(size_)
+            {
+            }
+
+            //! @cond nodoxygen
+            OutputDatagram(const OutputDatagram&) = default;
+            OutputDatagram& operator=(const OutputDatagram&) = default;
+            //! @endcond
+        };
+
+        //!
+        //! Send several messages to a destination address and port in one operation.
+        //!
+        //! On Linux, the messages are sent using UDP segmentation offload (GSO) when
+        //! consecutive messages have the same size and the kernel supports it, or
+        //! otherwise in one single system call (sendmmsg). On other systems, the
+        //! messages are sent one by one.
+        //!
+        //! @param [in] msgs Array of @a count datagram descriptions.
+        //! @param [in] count Number of messages to send.
+        //! @param [in] destination Socket address of the destination.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool sendBatch(const OutputDatagram* msgs, size_t count, const SocketAddress& destination, Report& report = CERR);
+
+        //!
+        //! Send several messages to the default destination address and port in one operation.
+        //! @param [in] msgs Array of @a count datagram descriptions.
+        //! @param [in] count Number of messages to send.
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //! @see sendBatch(const OutputDatagram*, size_t, const SocketAddress&, Report&)
+        //!
+        virtual bool sendBatch(const OutputDatagram* msgs, size_t count, Report& report = CERR);
+
+        //!
+        //! Enable or disable the usage of UDP segmentation offload (GSO) in sendBatch().
+        //! GSO is enabled by default on Linux and automatically disabled when the
+        //! kernel does not support it. It is never used on other systems.
+        //! @param [in] on Use GSO when possible.
+        //!
+        void setSegmentationOffload(bool on) { _use_gso = on; }
+
         //!
         //! Receive a message.
         //!
@@ -332,6 +420,68 @@ namespace ts {
                              Report& report = CERR,
                              MicroSecond* timestamp = nullptr);
 
+        //!
+        //! Description of one datagram in a batch reception with receiveBatch().
+        //!
+        struct TSDUCKDLL Datagram
+        {
+            void*         data;         //!< [in] Address of the buffer for the received message.
+            size_t        max_size;     //!< [in] Size in bytes of the reception buffer.
+            size_t        size;         //!< [out] Size in bytes of the received message.
+            SocketAddress sender;       //!< [out] Socket address of the sender.
+            SocketAddress destination;  //!< [out] Socket address of the packet destination.
+            MicroSecond   timestamp;    //!< [out] Receive timestamp in micro-seconds, negative if not available.
+
+            //!
+            //! Constructor.
+            //! @param [in] buffer Address of the buffer for the received message.
+            //! @param [in] buffer_size Size in bytes of the reception buffer.
+            //!
+            Datagram(void* buffer = nullptr, size_t buffer_size = 0) :
+                data(buffer), max_size(buffer_size), size(0), sender(), destination(), timestamp(-1)
+            {
+            }
+
+            //! @cond nodoxygen
+            Datagram(const Datagram&) = default;
+            Datagram& operator=(const Datagram&) = default;
+            //! @endcond
+
+            //!
+            //! Move a received message from another datagram description into this one.
+            //! The message data are copied into the buffer of this object, the buffer
+            //! address and size of this object are unchanged.
+            //! @param [in] other Description of the received message to move.
+            //!
+            void moveFrom(const Datagram& other);
+        };
+
+        //!
+        //! Receive several messages in one operation.
+        //!
+        //! The method waits for at least one message and returns all messages which are
+        //! immediately available, up to @a max_count. On Linux, all messages are received
+        //! in one single system call (recvmmsg). On other systems, one message is returned
+        //! at a time.
+        //!
+        //! @param [in,out] msgs Array of @a max_count datagram descriptions. On input, the
+        //! fields @a data and @a max_size must be set in each element. On output, the
+        //! @a ret_count first elements describe the received messages. The fields @a data
+        //! and @a max_size are never modified: the k-th received message is always stored
+        //! in the buffer of the k-th element.
+        //! @param [in] max_count Number of elements in @a msgs.
+        //! @param [out] ret_count Number of received messages.
+        //! @param [in] abort If non-zero, invoked when I/O is interrupted
+        //! (in case of user-interrupt, return, otherwise retry).
+        //! @param [in,out] report Where to report error.
+        //! @return True on success, false on error.
+        //!
+        virtual bool receiveBatch(Datagram* msgs,
+                                  size_t max_count,
+                                  size_t& ret_count,
+                                  const AbortInterface* abort = nullptr,
+                                  Report& report = CERR);
+
         // Implementation of Socket interface.
         virtual bool open(Report& report = CERR) override;
         virtual bool close(Report& report = CERR) override;
@@ -391,10 +541,39 @@ namespace ts {
         SocketAddress _default_destination;
         MReqSet       _mcast;    // Current set of multicast memberships
         SSMReqSet     _ssmcast;  // Current set of source-specific multicast memberships
+        uint64_t      _drop_count;  // Number of datagrams dropped by the kernel (SO_RXQ_OVFL)
+        bool          _use_gso;     // Use UDP segmentation offload in sendBatch()
+
+        // Work areas for recvmmsg() and sendmmsg(), kept between calls to avoid reallocation.
+#if defined(TS_LINUX)
+        std::vector<::mmsghdr>  _mmsg_headers;
+        std::vector<::iovec>    _mmsg_vecs;
+        std::vector<::sockaddr> _mmsg_senders;
+        ByteBlock               _mmsg_control;
+        std::vector<::mmsghdr>  _smsg_headers;  // Work areas for sendmmsg().
+        std::vector<::iovec>    _smsg_vecs;
+        ByteBlock               _smsg_control;
+#else
+        ByteBlock               _send_buffer;   // Contiguous copy of header and payload.
+#endif
 
         // Perform one receive operation. Hide the system mud.
         SocketErrorCode receiveOne(void* data, size_t max_size, size_t& ret_size, SocketAddress& sender, SocketAddress& destination, Report& report, MicroSecond* timestamp);
 
+        // Perform one batch receive operation. Return the number of received messages in ret_count.
+        SocketErrorCode receiveMany(Datagram* msgs, size_t max_count, size_t& ret_count, Report& report);
+
+#if defined(TS_LINUX)
+        // Send messages using sendmmsg() and UDP segmentation offload.
+        SocketErrorCode sendMany(const OutputDatagram* msgs, size_t count, ::sockaddr& addr);
+        size_t gsoSegmentCount(const OutputDatagram* msgs, size_t count) const;
+#endif
+
+#if !defined(TS_WINDOWS)
+        // Analyze the ancillary data of a received message (destination, timestamp, drop counter).
+        void getAncillaryData(::msghdr& hdr, SocketAddress& destination, MicroSecond* timestamp);
+#endif
+
         // Furiously idiotic Windows feature, see comment in receiveOne()
 #if defined(TS_WINDOWS)
         static volatile ::LPFN_WSARECVMSG _wsaRevcMsg;
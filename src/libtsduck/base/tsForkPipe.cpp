@@ -55,6 +55,7 @@ ts::ForkPipe::ForkPipe() :
     _ignore_abort(false),
     _broken_pipe(false),
     _eof(false),
+    _env(),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE),
     _process(INVALID_HANDLE_VALUE)
@@ -94,6 +95,23 @@ bool ts::ForkPipe::endOfStream()
 }
 
 
+//----------------------------------------------------------------------------
+// Get the process id of the created process.
+//----------------------------------------------------------------------------
+
+ts::ProcessId ts::ForkPipe::processId() const
+{
+    if (!_is_open) {
+        return 0;
+    }
+#if defined(TS_WINDOWS)
+    return _process == INVALID_HANDLE_VALUE ? 0 : ::GetProcessId(_process);
+#else
+    return _fpid;
+#endif
+}
+
+
 //----------------------------------------------------------------------------
 // Create the process, open the pipe.
 //----------------------------------------------------------------------------
@@ -246,9 +264,29 @@ bool ts::ForkPipe::open(const UString& command, WaitMode wait_mode, size_t buffe
     UString cmd(command);
     ::WCHAR* cmdp = const_cast<::WCHAR*>(cmd.wc_str());
 
+    // Build a new environment block when additional variables are specified.
+    // The block is a sequence of null-terminated "name=value" strings, followed by a null character.
+    UString env_block;
+    if (!_env.empty()) {
+        Environment env;
+        GetEnvironment(env);
+        for (auto it = _env.begin(); it != _env.end(); ++it) {
+            env[it->first] = it->second;
+        }
+        for (auto it = env.begin(); it != env.end(); ++it) {
+            env_block.append(it->first);
+            env_block.append(u'=');
+            env_block.append(it->second);
+            env_block.append(CHAR_NULL);
+        }
+        env_block.append(CHAR_NULL);
+    }
+    const ::DWORD flags = env_block.empty() ? 0 : CREATE_UNICODE_ENVIRONMENT;
+    ::LPVOID envp = env_block.empty() ? NULL : const_cast<::WCHAR*>(env_block.wc_str());
+
     // Create the process
     ::PROCESS_INFORMATION pi;
-    if (::CreateProcessW(NULL, cmdp, NULL, NULL, TRUE, 0, NULL, NULL, &si, &pi) == 0) {
+    if (::CreateProcessW(NULL, cmdp, NULL, NULL, TRUE, flags, envp, NULL, &si, &pi) == 0) {
         report.error(u"error creating process: %s", {ErrorCodeMessage()});
         if (_use_pipe) {
             ::CloseHandle(read_handle);
@@ -301,6 +339,29 @@ bool ts::ForkPipe::open(const UString& command, WaitMode wait_mode, size_t buffe
 
 #else // UNIX
 
+    // Prepare everything which allocates memory before fork(). In a multithreaded process,
+    // only async-signal-safe functions can be called in the child process before exec.
+    // Another thread may hold a libc lock (malloc, environment) at the time of fork().
+    const std::string command8(command.toUTF8());
+    std::vector<std::string> env_strings;
+    std::vector<char*> envp;
+    if (!_env.empty()) {
+        Environment env;
+        GetEnvironment(env);
+        for (auto it = _env.begin(); it != _env.end(); ++it) {
+            env[it->first] = it->second;
+        }
+        env_strings.reserve(env.size());
+        for (auto it = env.begin(); it != env.end(); ++it) {
+            env_strings.push_back((it->first + u"=" + it->second).toUTF8());
+        }
+        envp.reserve(env_strings.size() + 1);
+        for (auto it = env_strings.begin(); it != env_strings.end(); ++it) {
+            envp.push_back(const_cast<char*>(it->c_str()));
+        }
+        envp.push_back(nullptr);
+    }
+
     // Create a pipe
     int filedes[PIPE_COUNT];
     if (_use_pipe && ::pipe(filedes) < 0) {
@@ -424,8 +485,14 @@ bool ts::ForkPipe::open(const UString& command, WaitMode wait_mode, size_t buffe
         }
 
         // Execute the command if there was no prior error.
+        // With additional environment variables, only the created process gets the new environment.
         if (message == nullptr) {
-            ::execl("/bin/sh", "/bin/sh", "-c", command.toUTF8().c_str(), nullptr);
+            if (envp.empty()) {
+                ::execl("/bin/sh", "/bin/sh", "-c", command8.c_str(), nullptr);
+            }
+            else {
+                ::execle("/bin/sh", "/bin/sh", "-c", command8.c_str(), nullptr, envp.data());
+            }
             // Should not return, so this is an error if we get there.
             error = errno;
             message = "exec error";
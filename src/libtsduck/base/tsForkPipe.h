@@ -147,6 +147,13 @@ namespace ts {
             return _wait_mode == SYNCHRONOUS;
         }
 
+        //!
+        //! Get the process id of the created process.
+        //! @return The process id of the created process or zero if unknown
+        //! (not open or, on Windows, not synchronous).
+        //!
+        ProcessId processId() const;
+
         //!
         //! Set "ignore abort".
         //! @param [in] on If true and the process aborts, do not report error when writing data.
@@ -166,6 +173,26 @@ namespace ts {
             return _ignore_abort;
         }
 
+        //!
+        //! Set an environment variable in the created process.
+        //! The environment of the current process is unchanged.
+        //! The variable is used by all subsequent calls to open().
+        //! @param [in] name Environment variable name.
+        //! @param [in] value Environment variable value.
+        //!
+        void setEnvironment(const UString& name, const UString& value)
+        {
+            _env[name] = value;
+        }
+
+        //!
+        //! Clear all environment variables which were set using setEnvironment().
+        //!
+        void clearEnvironment()
+        {
+            _env.clear();
+        }
+
         //!
         //! Abort any currenly input/output operation in the pipe.
         //! The pipe is left in a broken state and can be only closed.
@@ -206,6 +233,7 @@ namespace ts {
         bool          _ignore_abort;  // Ignore early termination of child process.
         volatile bool _broken_pipe;   // Pipe is broken, do not attempt to write.
         volatile bool _eof;           // Got end of file on input pipe.
+        Environment   _env;           // Additional environment variables for the created process.
 #if defined(TS_WINDOWS)
         ::HANDLE      _handle;        // Pipe output handle.
         ::HANDLE      _process;       // Handle to child process.
@@ -86,6 +86,16 @@ namespace ts {
     //!
     TSDUCKDLL bool IdenticalBytes(const void* area, size_t area_size);
 
+    //!
+    //! Exclusive-OR of two memory areas.
+    //! This is typically used in block cipher chaining modes.
+    //! @param [out] dest Destination area, receives @a src1 XOR @a src2. Can be identical to @a src1 or @a src2.
+    //! @param [in] src1 Address of first source area.
+    //! @param [in] src2 Address of second source area.
+    //! @param [in] size Size in bytes of the three memory areas.
+    //!
+    TSDUCKDLL void MemXor(void* dest, const void* src1, const void* src2, size_t size);
+
     //------------------------------------------------------------------------
     // Serialization of integer data.
     // Suffix BE means serialized data in Big-Endian representation.
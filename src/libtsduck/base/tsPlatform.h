@@ -840,6 +840,7 @@ TS_MSC_NOWARNING(5204)
 #include <net/if.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #include <unistd.h>
 #include <time.h>
 #include <glob.h>
@@ -855,6 +856,7 @@ TS_MSC_NOWARNING(5204)
 #if defined(TS_LINUX)
 #include <limits.h>
 #include <sys/mman.h>
+#include <sys/epoll.h>
 #include <byteswap.h>
 #include <linux/dvb/version.h>
 #include <linux/dvb/frontend.h>
@@ -35,6 +35,11 @@
 #include <sys/param.h>
 #include <sys/sysctl.h>
 #endif
+#if (defined(TS_I386) || defined(TS_X86_64)) && defined(TS_GCC)
+#include <cpuid.h>
+#elif (defined(TS_I386) || defined(TS_X86_64)) && defined(TS_MSC)
+#include <intrin.h>
+#endif
 TSDUCK_SOURCE;
 
 // Define singleton instance
@@ -78,7 +83,13 @@ ts::SysInfo::SysInfo() :
     _systemVersion(),
     _systemName(),
     _hostName(),
-    _memoryPageSize(0)
+    _memoryPageSize(0),
+    _cpuHasSSE2(false),
+    _cpuHasSSSE3(false),
+    _cpuHasSSE41(false),
+    _cpuHasAVX2(false),
+    _cpuHasPCLMULQDQ(false),
+    _cpuHasAES(false)
 {
     //
     // Get operating system name and version.
@@ -221,5 +232,59 @@ ts::SysInfo::SysInfo() :
         _memoryPageSize = size_t(pageSize);
     }
 
+#endif
+
+    //
+    // Get CPU features (Intel CPU only).
+    //
+#if defined(TS_I386) || defined(TS_X86_64)
+
+    // Registers eax, ebx, ecx, edx from cpuid leaf 1 and 7, extended control register 0.
+    uint32_t regs1[4] = {0, 0, 0, 0};
+    uint32_t regs7[4] = {0, 0, 0, 0};
+    uint64_t xcr0 = 0;
+
+#if defined(TS_GCC)
+    const uint32_t max_leaf = ::__get_cpuid_max(0, nullptr);
+    if (max_leaf >= 1) {
+        __cpuid(1, regs1[0], regs1[1], regs1[2], regs1[3]);
+    }
+    if (max_leaf >= 7) {
+        __cpuid_count(7, 0, regs7[0], regs7[1], regs7[2], regs7[3]);
+    }
+    if ((regs1[2] & (1 << 27)) != 0) { // OSXSAVE
+        uint32_t xlo = 0, xhi = 0;
+        __asm__ __volatile__ ("xgetbv" : "=a" (xlo), "=d" (xhi) : "c" (0));
+        xcr0 = (uint64_t(xhi) << 32) | xlo;
+    }
+#elif defined(TS_MSC)
+    int info[4];
+    ::__cpuid(info, 0);
+    const int max_leaf = info[0];
+    if (max_leaf >= 1) {
+        ::__cpuidex(info, 1, 0);
+        for (int i = 0; i < 4; ++i) {
+            regs1[i] = uint32_t(info[i]);
+        }
+    }
+    if (max_leaf >= 7) {
+        ::__cpuidex(info, 7, 0);
+        for (int i = 0; i < 4; ++i) {
+            regs7[i] = uint32_t(info[i]);
+        }
+    }
+    if ((regs1[2] & (1 << 27)) != 0) { // OSXSAVE
+        xcr0 = uint64_t(::_xgetbv(0));
+    }
+#endif
+
+    _cpuHasSSE2 = (regs1[3] & (1 << 26)) != 0;
+    _cpuHasSSSE3 = (regs1[2] & (1 << 9)) != 0;
+    _cpuHasSSE41 = (regs1[2] & (1 << 19)) != 0;
+    _cpuHasPCLMULQDQ = (regs1[2] & (1 << 1)) != 0;
+    _cpuHasAES = (regs1[2] & (1 << 25)) != 0;
+    // AVX2 also requires the operating system to save the XMM and YMM registers.
+    _cpuHasAVX2 = (regs7[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+
 #endif
 }
@@ -112,6 +112,37 @@ namespace ts {
         //! @return The system memory page size in bytes.
         //!
         size_t memoryPageSize() const { return _memoryPageSize; }
+        //!
+        //! Check if the CPU supports the SSE2 instructions (Intel CPU only).
+        //! @return True if the CPU supports the SSE2 instructions.
+        //!
+        bool cpuHasSSE2() const { return _cpuHasSSE2; }
+        //!
+        //! Check if the CPU supports the SSSE3 instructions (Intel CPU only).
+        //! @return True if the CPU supports the SSSE3 instructions.
+        //!
+        bool cpuHasSSSE3() const { return _cpuHasSSSE3; }
+        //!
+        //! Check if the CPU supports the SSE4.1 instructions (Intel CPU only).
+        //! @return True if the CPU supports the SSE4.1 instructions.
+        //!
+        bool cpuHasSSE41() const { return _cpuHasSSE41; }
+        //!
+        //! Check if the CPU supports the AVX2 instructions (Intel CPU only).
+        //! The operating system must also support the AVX registers.
+        //! @return True if the CPU supports the AVX2 instructions.
+        //!
+        bool cpuHasAVX2() const { return _cpuHasAVX2; }
+        //!
+        //! Check if the CPU supports the carry-less multiplication instruction PCLMULQDQ (Intel CPU only).
+        //! @return True if the CPU supports the carry-less multiplication instruction PCLMULQDQ.
+        //!
+        bool cpuHasPCLMULQDQ() const { return _cpuHasPCLMULQDQ; }
+        //!
+        //! Check if the CPU supports the AES-NI instructions (Intel CPU only).
+        //! @return True if the CPU supports the AES-NI instructions.
+        //!
+        bool cpuHasAES() const { return _cpuHasAES; }
 
     private:
         bool    _isLinux;
@@ -127,5 +158,11 @@ namespace ts {
         UString _systemName;
         UString _hostName;
         size_t  _memoryPageSize;
+        bool    _cpuHasSSE2;
+        bool    _cpuHasSSSE3;
+        bool    _cpuHasSSE41;
+        bool    _cpuHasAVX2;
+        bool    _cpuHasPCLMULQDQ;
+        bool    _cpuHasAES;
     };
 }
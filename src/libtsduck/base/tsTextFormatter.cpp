@@ -142,15 +142,24 @@ bool ts::TextFormatter::isOpen() const
 // Close the current output.
 //----------------------------------------------------------------------------
 
-void ts::TextFormatter::close()
+bool ts::TextFormatter::close()
 {
+    // Write pending output, check write errors on the external stream or file.
+    bool success = true;
+    if (isOpen()) {
+        flush();
+        success = good() && !_out->fail();
+    }
+
     // Close resources.
     if (_out == &_outString) {
         // Output is set to string. Reset internal buffer.
         _outString.str(std::string());
     }
     if (_outFile.is_open()) {
+        // Closing the file writes its buffer, this is where a full disk is detected.
         _outFile.close();
+        success = success && !_outFile.fail();
     }
 
     // Set output to a closed file. Thus, _out is never null, it is safe to
@@ -161,6 +170,11 @@ void ts::TextFormatter::close()
     _column = 0;
     _afterSpace = false;
     _curMargin = _margin;
+
+    // Forget errors from the previous output.
+    _outFile.clear();
+    clear();
+    return success;
 }
 
 
@@ -139,8 +139,9 @@ namespace ts {
         //! - The external stream is no longer referenced.
         //! - The external file is closed.
         //! - The internal string buffer is emptied.
+        //! @return True on success, false if some output could not be written.
         //!
-        void close();
+        bool close();
 
         //!
         //! Insert all necessary new-lines and spaces to move to the current margin.
@@ -38,7 +38,9 @@ TSDUCK_SOURCE;
 ts::TextParser::TextParser(Report& report) :
     _report(report),
     _lines(),
-    _pos(_lines)
+    _pos(_lines),
+    _file(),
+    _stream(nullptr)
 {
 }
 
@@ -73,6 +75,7 @@ ts::TextParser::~TextParser()
 
 void ts::TextParser::clear()
 {
+    closeStream();
     _lines.clear();
     _pos = Position(_lines);
 }
@@ -84,18 +87,20 @@ void ts::TextParser::clear()
 
 void ts::TextParser::loadDocument(const UStringList& lines)
 {
-    _lines.clear();
+    clear();
     _pos = Position(lines);
 }
 
 void ts::TextParser::loadDocument(const UString& text)
 {
+    closeStream();
     text.toSubstituted(u"\r", UString()).split(_lines, u'\n', false);
     _pos = Position(_lines);
 }
 
 bool ts::TextParser::loadFile(const UString& fileName)
 {
+    closeStream();
     // Load the file into the internal lines buffer.
     const bool ok = UString::Load(_lines, fileName);
     if (!ok) {
@@ -109,6 +114,7 @@ bool ts::TextParser::loadFile(const UString& fileName)
 
 bool ts::TextParser::loadStream(std::istream& strm)
 {
+    closeStream();
     // Load the file into the internal lines buffer.
     const bool ok = UString::Load(_lines, strm);
     if (!ok) {
@@ -121,6 +127,80 @@ bool ts::TextParser::loadStream(std::istream& strm)
 }
 
 
+//----------------------------------------------------------------------------
+// Parse a document incrementally.
+//----------------------------------------------------------------------------
+
+bool ts::TextParser::openFile(const UString& fileName)
+{
+    clear();
+    _file.open(fileName.toUTF8().c_str(), std::ios::in);
+    if (!_file) {
+        _report.error(u"error opening file %s", {fileName});
+        return false;
+    }
+    return openStream(_file);
+}
+
+bool ts::TextParser::openStream(std::istream& strm)
+{
+    if (&strm != &_file) {
+        clear();
+    }
+    _stream = &strm;
+
+    // Read the first line, the parser is never positioned at end of document while lines remain.
+    readLine();
+    if (_stream != nullptr && _stream->bad()) {
+        _report.error(u"error reading input document");
+        closeStream();
+        return false;
+    }
+    return true;
+}
+
+void ts::TextParser::closeStream()
+{
+    _stream = nullptr;
+    if (_file.is_open()) {
+        _file.close();
+    }
+    _file.clear();
+}
+
+void ts::TextParser::discardParsedLines()
+{
+    // Keep the current line, it may be partially parsed.
+    if (_pos._lines == &_lines) {
+        _lines.erase(_lines.begin(), _pos._curLine);
+    }
+}
+
+// Read one more line from the input stream, if any, and position the parser on it.
+void ts::TextParser::readLine()
+{
+    if (_stream != nullptr && _pos._curLine == _lines.end()) {
+        UString line;
+        if (line.getLine(*_stream)) {
+            _lines.push_back(line);
+            _pos._curLine = --_lines.end();
+        }
+        else {
+            closeStream();
+        }
+    }
+}
+
+// Move to the beginning of next line.
+void ts::TextParser::nextLine()
+{
+    _pos._curLine++;
+    _pos._curLineNumber++;
+    _pos._curIndex = 0;
+    readLine();
+}
+
+
 //----------------------------------------------------------------------------
 // Save the document to parse to a text file.
 //----------------------------------------------------------------------------
@@ -190,9 +270,7 @@ bool ts::TextParser::skipWhiteSpace()
             return true;
         }
         // Move to next line.
-        _pos._curLine++;
-        _pos._curLineNumber++;
-        _pos._curIndex = 0;
+        nextLine();
     }
     return true;
 }
@@ -205,9 +283,7 @@ bool ts::TextParser::skipWhiteSpace()
 bool ts::TextParser::skipLine()
 {
     while (_pos._curLine != _pos._lines->end()) {
-        _pos._curLine++;
-        _pos._curLineNumber++;
-        _pos._curIndex = 0;
+        nextLine();
     }
     return true;
 }
@@ -469,9 +545,7 @@ bool ts::TextParser::parseText(UString& result, const UString endToken, bool ski
             // End token not found, include the complete end of line.
             result.append(*_pos._curLine, _pos._curIndex);
             result.append(LINE_FEED);
-            _pos._curLine++;
-            _pos._curLineNumber++;
-            _pos._curIndex = 0;
+            nextLine();
         }
         else {
             // Found end token, stop here.
@@ -103,6 +103,36 @@ namespace ts {
         //!
         bool loadStream(std::istream& strm);
 
+        //!
+        //! Open a text file to parse incrementally.
+        //! Unlike loadFile(), the lines are read from the file only when the parser needs them.
+        //! Use discardParsedLines() to free the lines which are already parsed, so that the
+        //! memory usage does not depend on the file size.
+        //! @param [in] fileName Name of the file to parse.
+        //! @return True on success, false on failure.
+        //!
+        bool openFile(const UString& fileName);
+
+        //!
+        //! Open a text stream to parse incrementally.
+        //! Unlike loadStream(), the lines are read from the stream only when the parser needs them.
+        //! Use discardParsedLines() to free the lines which are already parsed, so that the
+        //! memory usage does not depend on the document size.
+        //! @param [in,out] strm A standard text stream in input mode. The stream must remain
+        //! valid until the end of the parsing.
+        //! @return True on success, false on error.
+        //!
+        bool openStream(std::istream& strm);
+
+        //!
+        //! Free all lines of the document before the current line.
+        //! This is typically used when parsing a large document incrementally.
+        //! All positions which were previously saved before the current line become
+        //! invalid and rewind() only returns to the current line.
+        //! Do not use when the parser works on an external list of lines.
+        //!
+        void discardParsedLines();
+
         //!
         //! Save the document to parse to a text file.
         //! @param [in] fileName Name of the file to save.
@@ -271,8 +301,15 @@ namespace ts {
         virtual bool parseJSONStringLiteral(UString& str);
 
     private:
-        Report&     _report;
-        UStringList _lines;
-        Position    _pos;
+        Report&       _report;
+        UStringList   _lines;
+        Position      _pos;
+        std::ifstream _file;    // Input file when parsed incrementally.
+        std::istream* _stream;  // Input stream when parsed incrementally, null when reached the end.
+
+        // Incremental parsing: close the input stream, read one more line if needed, move to next line.
+        void closeStream();
+        void readLine();
+        void nextLine();
     };
 }
@@ -199,6 +199,27 @@ bool ts::xml::Document::validate(const Document& model) const
     }
 }
 
+// Validate one child of the root element.
+bool ts::xml::Document::validateRootChild(const Document& model, const Element* element) const
+{
+    const Element* modelRoot = model.rootElement();
+    if (modelRoot == nullptr) {
+        _report.error(u"invalid XML model, no root element");
+        return false;
+    }
+    if (element == nullptr) {
+        _report.error(u"invalid XML document");
+        return false;
+    }
+    const Element* modelChild = findModelElement(modelRoot, element->name());
+    if (modelChild == nullptr) {
+        const Element* parent = dynamic_cast<const Element*>(element->parent());
+        _report.error(u"unexpected node <%s> in <%s>, line %d", {element->name(), parent == nullptr ? modelRoot->name() : parent->name(), element->lineNumber()});
+        return false;
+    }
+    return validateElement(modelChild, element);
+}
+
 // Validate an XML tree of elements, used by validate().
 bool ts::xml::Document::validateElement(const Element* model, const Element* doc) const
 {
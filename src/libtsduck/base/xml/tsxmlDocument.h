@@ -103,6 +103,17 @@ namespace ts {
             //!
             bool validate(const Document& model) const;
 
+            //!
+            //! Validate one child of the root element, according to a model document.
+            //! This is typically used when the document is parsed incrementally, one child
+            //! of the root element at a time (see PullParser). The root element itself is
+            //! validated using validate() before its children are parsed.
+            //! @param [in] model The model document, see validate().
+            //! @param [in] element The element to validate, a child of the root element.
+            //! @return True if @a element matches @a model, false if it does not.
+            //!
+            bool validateRootChild(const Document& model, const Element* element) const;
+
             //!
             //! Save an XML file.
             //! @param [in] fileName Name of the XML file to save.
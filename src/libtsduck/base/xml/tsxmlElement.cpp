@@ -758,6 +758,15 @@ void ts::xml::Element::printClose(TextFormatter& output, size_t levels) const
 
 bool ts::xml::Element::parseNode(TextParser& parser, const Node* parent)
 {
+    // Opening tag with attributes, then all children, then closing tag.
+    bool standalone = false;
+    return parseOpeningTag(parser, standalone) && (standalone || (parseChildren(parser) && parseClosingTag(parser)));
+}
+
+bool ts::xml::Element::parseOpeningTag(TextParser& parser, bool& standalone)
+{
+    standalone = false;
+
     // We just read the "<". Skip spaces and read the tag name.
     parser.skipWhiteSpace();
     if (!parser.parseXMLName(_value)) {
@@ -780,7 +789,8 @@ bool ts::xml::Element::parseNode(TextParser& parser, const Node* parent)
         }
         else if (parser.match(u"/>", true)) {
             // Found end of standalone tag, without children.
-            return true;
+            standalone = true;
+            break;
         }
         else if (parser.parseXMLName(name)) {
             // Found a name, probably an attribute.
@@ -830,16 +840,14 @@ bool ts::xml::Element::parseNode(TextParser& parser, const Node* parent)
     if (!ok) {
         UString ignored;
         parser.parseText(ignored, u">", true, false);
-        return false;
-    }
-
-    // End of tag, swallow all children.
-    if (!parseChildren(parser)) {
-        return false;
     }
+    return ok;
+}
 
+bool ts::xml::Element::parseClosingTag(TextParser& parser)
+{
     // We now must be at "</tag>".
-    ok = parser.match(u"</", true);
+    bool ok = parser.match(u"</", true);
     if (ok) {
         UString endTag;
         ok = parser.skipWhiteSpace() && parser.parseXMLName(endTag) && parser.skipWhiteSpace() && endTag.similar(_value);
@@ -710,6 +710,9 @@ namespace ts {
             virtual bool parseNode(TextParser& parser, const Node* parent) override;
 
         private:
+            // The pull parser needs to parse the root element in several steps.
+            friend class PullParser;
+
             CaseSensitivity _attributeCase;  //!< For attribute names.
             AttributeMap    _attributes;     //!< Map of attributes.
 
@@ -721,6 +724,12 @@ namespace ts {
 
             // Get a modifiable reference to an attribute, create if does not exist.
             Attribute& refAttribute(const UString& attributeName);
+
+            // Parse the opening tag with attributes, up to and including ">" or "/>".
+            bool parseOpeningTag(TextParser& parser, bool& standalone);
+
+            // Parse the closing tag "</name>".
+            bool parseClosingTag(TextParser& parser);
         };
     }
 }
@@ -322,6 +322,9 @@ namespace ts {
             UString                  _value;        //!< Value of the node, depend on the node type.
 
         private:
+            // The pull parser drives the parsing of the nodes one by one.
+            friend class PullParser;
+
             Node*   _parent;        //!< Parent node, null for a document.
             Node*   _firstChild;    //!< First child, can be null, other children are linked through the RingNode.
             size_t  _inputLineNum;  //!< Line number in input document, zero if build programmatically.
@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsxmlPullParser.h"
+#include "tsxmlComment.h"
+#include "tsxmlText.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::xml::PullParser::PullParser(Report& report) :
+    _report(report),
+    _parser(report),
+    _doc(report),
+    _root(nullptr),
+    _current(nullptr),
+    _success(true),
+    _end(true)
+{
+}
+
+ts::xml::PullParser::~PullParser()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Open a document.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::open(const UString& fileName, bool search)
+{
+    close();
+
+    // Actual file name to load after optional search in directories.
+    const UString actualFileName(search ? SearchConfigurationFile(fileName) : fileName);
+    if (actualFileName.empty()) {
+        _report.error(u"file not found: %s", {fileName});
+        return fail();
+    }
+
+    _report.debug(u"parsing XML file %s", {actualFileName});
+    return (_parser.openFile(actualFileName) || fail()) && parseStart();
+}
+
+bool ts::xml::PullParser::open(std::istream& strm)
+{
+    close();
+    return (_parser.openStream(strm) || fail()) && parseStart();
+}
+
+bool ts::xml::PullParser::openText(const UString& text)
+{
+    close();
+    _parser.loadDocument(text);
+    return parseStart();
+}
+
+
+//----------------------------------------------------------------------------
+// Close the document and free all resources.
+//----------------------------------------------------------------------------
+
+void ts::xml::PullParser::close()
+{
+    _current = nullptr;
+    _root = nullptr;
+    _doc.clear();
+    _parser.clear();
+    _success = true;
+    _end = true;
+}
+
+
+//----------------------------------------------------------------------------
+// Report an error and terminate the parsing.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::fail()
+{
+    _success = false;
+    _end = true;
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Parse the beginning of the document, up to the opening tag of the root.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::parseStart()
+{
+    _end = false;
+
+    // Parse leading declarations, comments and DTD, until the root element.
+    Node* node = nullptr;
+    while ((node = _doc.identifyNextNode(_parser)) != nullptr) {
+
+        Element* elem = dynamic_cast<Element*>(node);
+        if (elem != nullptr) {
+            // Found the root element, parse its opening tag only.
+            bool standalone = false;
+            if (!elem->parseOpeningTag(_parser, standalone)) {
+                delete elem;
+                return fail();
+            }
+            elem->reparent(&_doc);
+            _root = elem;
+            if (standalone) {
+                // The root element has no child, this is already the end of the document.
+                _end = true;
+                return parseEnd() || fail();
+            }
+            return true;
+        }
+        else if (dynamic_cast<Text*>(node) != nullptr) {
+            _report.error(u"line %d: unexpected text before root element, invalid XML document", {node->lineNumber()});
+            delete node;
+            return fail();
+        }
+        else if (!node->parseNode(_parser, &_doc)) {
+            delete node;
+            return fail();
+        }
+        node->reparent(&_doc);
+    }
+
+    _report.error(u"invalid XML document, no root element found");
+    return fail();
+}
+
+
+//----------------------------------------------------------------------------
+// Parse and get the next child element of the root element.
+//----------------------------------------------------------------------------
+
+const ts::xml::Element* ts::xml::PullParser::nextElement()
+{
+    // Deallocating the element removes it from the document through the destructor.
+    delete _current;
+    _current = nullptr;
+
+    if (_end || _root == nullptr) {
+        return nullptr;
+    }
+
+    // All input text before the current position is no longer needed.
+    _parser.discardParsedLines();
+
+    // Parse direct children of the root, until the next element.
+    Node* node = nullptr;
+    while ((node = _root->identifyNextNode(_parser)) != nullptr) {
+        if (!node->parseNode(_parser, _root)) {
+            // Error, we expect the child's parser to have displayed the error message.
+            delete node;
+            fail();
+            return nullptr;
+        }
+        Element* elem = dynamic_cast<Element*>(node);
+        if (elem != nullptr) {
+            elem->reparent(_root);
+            _current = elem;
+            return elem;
+        }
+        // Comments and texts between elements are ignored.
+        delete node;
+    }
+
+    // End of children, we must be at the closing tag of the root.
+    _end = true;
+    if (!_root->parseClosingTag(_parser) || !parseEnd()) {
+        fail();
+    }
+    return nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Parse the end of the document, after the closing tag of the root.
+//----------------------------------------------------------------------------
+
+bool ts::xml::PullParser::parseEnd()
+{
+    // Only comments are allowed after the root element.
+    Node* node = nullptr;
+    while ((node = _doc.identifyNextNode(_parser)) != nullptr) {
+        const bool comment = dynamic_cast<Comment*>(node) != nullptr;
+        if (!comment) {
+            _report.error(u"line %d: trailing %s, invalid XML document, need one single root element", {node->lineNumber(), node->typeName()});
+        }
+        const bool ok = comment && node->parseNode(_parser, &_doc);
+        delete node;
+        if (!ok) {
+            return false;
+        }
+    }
+
+    // We must have reached the end of document.
+    if (!_parser.eof()) {
+        _report.error(u"line %d: trailing character sequence, invalid XML document", {_parser.lineNumber()});
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,163 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Incremental (pull) parser for large XML documents.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsxmlDocument.h"
+#include "tsxmlElement.h"
+#include "tsTextParser.h"
+
+namespace ts {
+    namespace xml {
+        //!
+        //! Incremental (pull) parser for large XML documents.
+        //! @ingroup xml
+        //!
+        //! Parsing a complete Document builds the complete tree of nodes in memory. This is not
+        //! suitable for very large documents which contain a long list of independent children
+        //! of the root element, typically the tables in huge EPG files.
+        //!
+        //! The pull parser reads the document incrementally. The declarations and the root element
+        //! with its attributes are parsed first and are available in a document which contains
+        //! the root element only. Then, each call to nextElement() parses and returns the next
+        //! child of the root element, with all its descendants. The previous child is deleted and
+        //! the corresponding input text is freed. Therefore, the memory usage depends on the size
+        //! of the largest child of the root element only, not on the size of the document.
+        //!
+        //! Texts and comments which are direct children of the root element are ignored.
+        //!
+        class TSDUCKDLL PullParser
+        {
+            TS_NOCOPY(PullParser);
+        public:
+            //!
+            //! Constructor.
+            //! @param [in,out] report Where to report errors.
+            //!
+            explicit PullParser(Report& report = NULLREP);
+
+            //!
+            //! Destructor.
+            //!
+            ~PullParser();
+
+            //!
+            //! Set new XML tweaks for the document and its elements.
+            //! @param [in] tw The new XML tweaks.
+            //!
+            void setTweaks(const Tweaks& tw) { _doc.setTweaks(tw); }
+
+            //!
+            //! Open an XML file and parse it up to the opening tag of the root element.
+            //! @param [in] fileName Name of the XML file to parse.
+            //! @param [in] search If true, search the XML file in the TSDuck configuration directories
+            //! if @a fileName is not found and does not contain any directory part.
+            //! @return True on success, false on error.
+            //!
+            bool open(const UString& fileName, bool search = false);
+
+            //!
+            //! Open an XML text stream and parse it up to the opening tag of the root element.
+            //! @param [in,out] strm A standard text stream in input mode. The stream must remain
+            //! valid until the end of the parsing.
+            //! @return True on success, false on error.
+            //!
+            bool open(std::istream& strm);
+
+            //!
+            //! Open an XML document text and parse it up to the opening tag of the root element.
+            //! @param [in] text The XML document text.
+            //! @return True on success, false on error.
+            //!
+            bool openText(const UString& text);
+
+            //!
+            //! Close the document and free all resources.
+            //!
+            void close();
+
+            //!
+            //! Get the document which is being parsed.
+            //! It contains the declarations, the root element and the last child of the
+            //! root element which was returned by nextElement().
+            //! @return A constant reference to the document.
+            //!
+            const Document& document() const { return _doc; }
+
+            //!
+            //! Get the root element of the document.
+            //! @return The root element or null if the document is not open.
+            //!
+            const Element* rootElement() const { return _root; }
+
+            //!
+            //! Parse and get the next child element of the root element.
+            //! The element which was returned by the previous call is deleted.
+            //! @return The next child element of the root, with all its descendants. The returned
+            //! element is valid until the next call to nextElement() or close(). Return null at
+            //! the end of the document or on error.
+            //!
+            const Element* nextElement();
+
+            //!
+            //! Check if errors were found during the parsing.
+            //! @return True if no error was found so far.
+            //!
+            bool success() const { return _success; }
+
+            //!
+            //! Check if the end of the document was reached.
+            //! @return True when the end of the document was reached (or on error).
+            //!
+            bool endOfDocument() const { return _end; }
+
+        private:
+            Report&    _report;
+            TextParser _parser;
+            Document   _doc;
+            Element*   _root;     // Root element in _doc.
+            Element*   _current;  // Last returned child of _root.
+            bool       _success;  // No error so far.
+            bool       _end;      // End of document reached.
+
+            // Parse the beginning of the document, up to the opening tag of the root.
+            bool parseStart();
+
+            // Parse the end of the document, after the closing tag of the root.
+            bool parseEnd();
+
+            // Report an error and terminate the parsing.
+            bool fail();
+        };
+    }
+}
@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsxmlStreamWriter.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::xml::StreamWriter::StreamWriter(Report& report) :
+    _out(report),
+    _doc(report),
+    _root(nullptr),
+    _started(false)
+{
+}
+
+ts::xml::StreamWriter::~StreamWriter()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Open the document.
+//----------------------------------------------------------------------------
+
+bool ts::xml::StreamWriter::open(const UString& fileName, const UString& rootName, size_t indent)
+{
+    close();
+    if (!_out.setFile(fileName)) {
+        return false;
+    }
+    _out.setIndentSize(indent);
+    _root = _doc.initialize(rootName);
+    return _root != nullptr;
+}
+
+bool ts::xml::StreamWriter::open(std::ostream& strm, const UString& rootName, size_t indent)
+{
+    close();
+    _out.setStream(strm);
+    _out.setIndentSize(indent);
+    _root = _doc.initialize(rootName);
+    return _root != nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Write all current children of the root element and delete them.
+//----------------------------------------------------------------------------
+
+void ts::xml::StreamWriter::flush()
+{
+    if (_root == nullptr || !_root->hasChildren()) {
+        return;
+    }
+
+    if (!_started) {
+        // First children: print the beginning of the document with them, keep the root open.
+        _started = true;
+        _doc.print(_out, true);
+    }
+    else {
+        for (const Node* node = _root->firstChild(); node != nullptr; node = node->nextSibling()) {
+            _out << ts::margin;
+            node->print(_out, false);
+            _out << std::endl;
+        }
+    }
+
+    // Deallocating the children removes them from the document through the destructor.
+    while (_root->hasChildren()) {
+        delete _root->firstChild();
+    }
+    _out.flush();
+}
+
+
+//----------------------------------------------------------------------------
+// Close the document.
+//----------------------------------------------------------------------------
+
+bool ts::xml::StreamWriter::close()
+{
+    const bool was_open = _root != nullptr;
+    if (was_open) {
+        flush();
+        if (_started) {
+            _doc.printClose(_out);
+        }
+        else {
+            // No children were ever written, print the complete empty document.
+            _doc.print(_out, false);
+        }
+        _root = nullptr;
+    }
+    _doc.clear();
+    const bool success = _out.close();
+    _started = false;
+    if (was_open && !success) {
+        _doc.report().error(u"error writing XML document");
+    }
+    return success;
+}
@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Incremental writer for large XML documents.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsxmlDocument.h"
+#include "tsxmlElement.h"
+#include "tsTextFormatter.h"
+
+namespace ts {
+    namespace xml {
+        //!
+        //! Incremental writer for large XML documents.
+        //! @ingroup xml
+        //!
+        //! This is the reverse of PullParser. The application adds children to the root element.
+        //! Each call to flush() writes all current children of the root element and deletes them.
+        //! Therefore, the memory usage depends on the size of the children which are added between
+        //! two calls to flush() only, not on the size of the document. The produced text is identical
+        //! to the text of the complete document, as saved by Document::save().
+        //!
+        class TSDUCKDLL StreamWriter
+        {
+            TS_NOCOPY(StreamWriter);
+        public:
+            //!
+            //! Constructor.
+            //! @param [in,out] report Where to report errors.
+            //!
+            explicit StreamWriter(Report& report = NULLREP);
+
+            //!
+            //! Destructor.
+            //! The document is closed if necessary.
+            //!
+            ~StreamWriter();
+
+            //!
+            //! Set new XML tweaks for the document and its elements.
+            //! @param [in] tw The new XML tweaks.
+            //!
+            void setTweaks(const Tweaks& tw) { _doc.setTweaks(tw); }
+
+            //!
+            //! Create an XML file.
+            //! @param [in] fileName Name of the XML file to create.
+            //! @param [in] rootName Name of the root element.
+            //! @param [in] indent Indentation width of each level.
+            //! @return True on success, false on error.
+            //!
+            bool open(const UString& fileName, const UString& rootName, size_t indent = 2);
+
+            //!
+            //! Start writing an XML document on a text stream.
+            //! @param [in,out] strm A standard text stream in output mode. The stream must
+            //! remain valid until the document is closed.
+            //! @param [in] rootName Name of the root element.
+            //! @param [in] indent Indentation width of each level.
+            //! @return True on success, false on error.
+            //!
+            bool open(std::ostream& strm, const UString& rootName, size_t indent = 2);
+
+            //!
+            //! Check if the document is open.
+            //! @return True if the document is open.
+            //!
+            bool isOpen() const { return _root != nullptr; }
+
+            //!
+            //! Get the document which is being written.
+            //! @return A constant reference to the document.
+            //!
+            const Document& document() const { return _doc; }
+
+            //!
+            //! Get the root element of the document.
+            //! New elements shall be added as children of the root element.
+            //! @return The root element or null if the document is not open.
+            //!
+            Element* rootElement() { return _root; }
+
+            //!
+            //! Write all current children of the root element and delete them.
+            //!
+            void flush();
+
+            //!
+            //! Write all current children of the root element and close the document.
+            //! @return True on success, false if the document could not be completely written.
+            //!
+            bool close();
+
+        private:
+            TextFormatter _out;
+            Document      _doc;
+            Element*      _root;     // Root element in _doc.
+            bool          _started;  // Beginning of document already written.
+        };
+    }
+}
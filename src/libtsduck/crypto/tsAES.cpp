@@ -14,8 +14,23 @@
 //----------------------------------------------------------------------------
 
 #include "tsAES.h"
+#include "tsSysInfo.h"
 TSDUCK_SOURCE;
 
+// AES-NI is used on Intel CPU's when supported at runtime.
+// With GCC and clang, the functions are compiled for AES-NI without
+// requiring it for the rest of the code (no global -maes).
+#if (defined(TS_I386) || defined(TS_X86_64)) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_AES_NI 1
+    #include <emmintrin.h>
+    #include <wmmintrin.h>
+    #if defined(TS_GCC)
+        #define TS_AES_NI_TARGET __attribute__((target("sse2,aes")))
+    #else
+        #define TS_AES_NI_TARGET
+    #endif
+#endif
+
 #define BYTE(x,n) (((x) >> (8 * (n))) & 255)
 
 namespace {
@@ -1012,6 +1027,143 @@ namespace {
 }
 
 
+//----------------------------------------------------------------------------
+// AES-NI implementation.
+//----------------------------------------------------------------------------
+
+#if defined(TS_AES_NI)
+namespace {
+
+    // Number of blocks in flight. The latency of AESENC and AESDEC is several
+    // times their throughput. Processing independent blocks in an interleaved
+    // way keeps the AES unit busy.
+    constexpr size_t AESNI_LANES = 8;
+
+    // Apply one AES-NI instruction with the same round key on 8 blocks.
+    #define AESNI_ROUND8(op, k)       \
+        b0 = op(b0, k);               \
+        b1 = op(b1, k);               \
+        b2 = op(b2, k);               \
+        b3 = op(b3, k);               \
+        b4 = op(b4, k);               \
+        b5 = op(b5, k);               \
+        b6 = op(b6, k);               \
+        b7 = op(b7, k)
+
+    // Process blocks with AES-NI. The round keys are serialized in the order of
+    // application. The instructions for the middle and final rounds are given
+    // as template parameters: AESENC/AESENCLAST or AESDEC/AESDECLAST.
+    // Input and output areas can be identical.
+    template <__m128i (*ROUND)(__m128i, __m128i), __m128i (*LAST)(__m128i, __m128i)>
+    TS_AES_NI_TARGET inline void ProcessNI(const uint8_t* rkeys, int rounds, const uint8_t* in, uint8_t* out, size_t count)
+    {
+        __m128i rk[ts::AES::MAX_ROUNDS + 1];
+        for (int r = 0; r <= rounds; ++r) {
+            rk[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rkeys) + r);
+        }
+
+        const __m128i* src = reinterpret_cast<const __m128i*>(in);
+        __m128i* dst = reinterpret_cast<__m128i*>(out);
+
+        // Groups of 8 blocks in flight.
+        for (; count >= AESNI_LANES; count -= AESNI_LANES, src += AESNI_LANES, dst += AESNI_LANES) {
+            __m128i b0 = _mm_loadu_si128(src + 0);
+            __m128i b1 = _mm_loadu_si128(src + 1);
+            __m128i b2 = _mm_loadu_si128(src + 2);
+            __m128i b3 = _mm_loadu_si128(src + 3);
+            __m128i b4 = _mm_loadu_si128(src + 4);
+            __m128i b5 = _mm_loadu_si128(src + 5);
+            __m128i b6 = _mm_loadu_si128(src + 6);
+            __m128i b7 = _mm_loadu_si128(src + 7);
+            AESNI_ROUND8(_mm_xor_si128, rk[0]);
+            for (int r = 1; r < rounds; ++r) {
+                AESNI_ROUND8(ROUND, rk[r]);
+            }
+            AESNI_ROUND8(LAST, rk[rounds]);
+            _mm_storeu_si128(dst + 0, b0);
+            _mm_storeu_si128(dst + 1, b1);
+            _mm_storeu_si128(dst + 2, b2);
+            _mm_storeu_si128(dst + 3, b3);
+            _mm_storeu_si128(dst + 4, b4);
+            _mm_storeu_si128(dst + 5, b5);
+            _mm_storeu_si128(dst + 6, b6);
+            _mm_storeu_si128(dst + 7, b7);
+        }
+
+        // Remaining blocks, one by one.
+        for (; count > 0; --count, ++src, ++dst) {
+            __m128i b = _mm_xor_si128(_mm_loadu_si128(src), rk[0]);
+            for (int r = 1; r < rounds; ++r) {
+                b = ROUND(b, rk[r]);
+            }
+            _mm_storeu_si128(dst, LAST(b, rk[rounds]));
+        }
+    }
+
+    #undef AESNI_ROUND8
+
+    // The intrinsics are not necessarily functions, use wrappers as template arguments.
+    TS_AES_NI_TARGET inline __m128i AesEnc(__m128i b, __m128i k) { return _mm_aesenc_si128(b, k); }
+    TS_AES_NI_TARGET inline __m128i AesEncLast(__m128i b, __m128i k) { return _mm_aesenclast_si128(b, k); }
+    TS_AES_NI_TARGET inline __m128i AesDec(__m128i b, __m128i k) { return _mm_aesdec_si128(b, k); }
+    TS_AES_NI_TARGET inline __m128i AesDecLast(__m128i b, __m128i k) { return _mm_aesdeclast_si128(b, k); }
+
+    TS_AES_NI_TARGET void EncryptNI(const uint8_t* rkeys, int rounds, const void* in, void* out, size_t count)
+    {
+        ProcessNI<AesEnc, AesEncLast>(rkeys, rounds, reinterpret_cast<const uint8_t*>(in), reinterpret_cast<uint8_t*>(out), count);
+    }
+
+    TS_AES_NI_TARGET void DecryptNI(const uint8_t* rkeys, int rounds, const void* in, void* out, size_t count)
+    {
+        ProcessNI<AesDec, AesDecLast>(rkeys, rounds, reinterpret_cast<const uint8_t*>(in), reinterpret_cast<uint8_t*>(out), count);
+    }
+}
+#endif
+
+
+//----------------------------------------------------------------------------
+// Selection of the implementation.
+//----------------------------------------------------------------------------
+
+bool ts::AES::IsSupported(Implementation impl)
+{
+    switch (impl) {
+        case IMPL_AUTO:
+        case IMPL_SOFTWARE:
+            return true;
+#if defined(TS_AES_NI)
+        case IMPL_AESNI:
+            return SysInfo::Instance()->cpuHasSSE2() && SysInfo::Instance()->cpuHasAES();
+#endif
+        default:
+            return false;
+    }
+}
+
+// Current implementation, shared by all threads.
+std::atomic<ts::AES::Implementation>& ts::AES::CurrentImplementation()
+{
+    static std::atomic<Implementation> impl(IsSupported(IMPL_AESNI) ? IMPL_AESNI : IMPL_SOFTWARE);
+    return impl;
+}
+
+bool ts::AES::SetImplementation(Implementation impl)
+{
+    if (!IsSupported(impl)) {
+        return false;
+    }
+    else {
+        CurrentImplementation().store(impl != IMPL_AUTO ? impl : (IsSupported(IMPL_AESNI) ? IMPL_AESNI : IMPL_SOFTWARE));
+        return true;
+    }
+}
+
+ts::AES::Implementation ts::AES::GetImplementation()
+{
+    return CurrentImplementation().load(std::memory_order_relaxed);
+}
+
+
 //----------------------------------------------------------------------------
 // Schedule a new key. If rounds is zero, the default is used.
 //----------------------------------------------------------------------------
@@ -1164,6 +1316,13 @@ bool ts::AES::setKeyImpl(const void* key_, size_t key_length, size_t rounds)
     *rk++ = *rrk++;
     *rk   = *rrk;
 
+    // Serialized round keys, in the byte order of the state, for AES-NI.
+    // The decryption keys are already in the form of the "equivalent inverse cipher".
+    for (i = 0; i < 4 * (_Nr + 1); i++) {
+        PutUInt32(_eKb + 4 * i, _eK[i]);
+        PutUInt32(_dKb + 4 * i, _dK[i]);
+    }
+
     return true;
 }
 
@@ -1178,6 +1337,16 @@ bool ts::AES::encryptImpl(const void* plain, size_t plain_length, void* cipher,
         return false;
     }
 
+#if defined(TS_AES_NI)
+    if (GetImplementation() == IMPL_AESNI) {
+        EncryptNI(_eKb, _Nr, plain, cipher, 1);
+        if (cipher_length != nullptr) {
+            *cipher_length = BLOCK_SIZE;
+        }
+        return true;
+    }
+#endif
+
     const uint8_t* pt = reinterpret_cast<const uint8_t*> (plain);
     uint8_t* ct = reinterpret_cast<uint8_t*> (cipher);
 
@@ -1303,6 +1472,16 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
         return false;
     }
 
+#if defined(TS_AES_NI)
+    if (GetImplementation() == IMPL_AESNI) {
+        DecryptNI(_dKb, _Nr, cipher, plain, 1);
+        if (plain_length != nullptr) {
+            *plain_length = BLOCK_SIZE;
+        }
+        return true;
+    }
+#endif
+
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
 
@@ -1419,6 +1598,33 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
 }
 
 
+//----------------------------------------------------------------------------
+// Encryption and decryption of several independent blocks.
+//----------------------------------------------------------------------------
+
+bool ts::AES::encryptBlocksImpl(const void* plain, void* cipher, size_t count)
+{
+#if defined(TS_AES_NI)
+    if (GetImplementation() == IMPL_AESNI) {
+        EncryptNI(_eKb, _Nr, plain, cipher, count);
+        return true;
+    }
+#endif
+    return BlockCipher::encryptBlocksImpl(plain, cipher, count);
+}
+
+bool ts::AES::decryptBlocksImpl(const void* cipher, void* plain, size_t count)
+{
+#if defined(TS_AES_NI)
+    if (GetImplementation() == IMPL_AESNI) {
+        DecryptNI(_dKb, _Nr, cipher, plain, count);
+        return true;
+    }
+#endif
+    return BlockCipher::decryptBlocksImpl(cipher, plain, count);
+}
+
+
 //----------------------------------------------------------------------------
 // Constructor
 //----------------------------------------------------------------------------
@@ -1426,7 +1632,9 @@ bool ts::AES::decryptImpl(const void* cipher, size_t cipher_length, void* plain,
 ts::AES::AES() :
     _Nr(0),
     _eK(),
-    _dK()
+    _dK(),
+    _eKb(),
+    _dKb()
 {
 }
 
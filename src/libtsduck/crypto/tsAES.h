@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsBlockCipher.h"
+#include <atomic>
 
 namespace ts {
     //!
@@ -62,15 +63,53 @@ namespace ts {
         virtual size_t maxRounds() const override;
         virtual size_t defaultRounds() const override;
 
+        //!
+        //! Implementation of the AES algorithm.
+        //!
+        enum Implementation {
+            IMPL_AUTO,      //!< Use the fastest implementation on this CPU.
+            IMPL_SOFTWARE,  //!< Portable table-based software implementation.
+            IMPL_AESNI      //!< Intel AES-NI instructions, several blocks in flight when possible.
+        };
+
+        //!
+        //! Check if an implementation of AES is supported on this platform and CPU.
+        //! @param [in] impl The implementation to check.
+        //! @return True if @a impl is supported.
+        //!
+        static bool IsSupported(Implementation impl);
+
+        //!
+        //! Force the implementation of AES (typically for tests and benchmarks).
+        //! This is a global setting for all instances of AES. It can be safely called
+        //! while other threads use AES instances, which switch at their next operation.
+        //! @param [in] impl The implementation to use. The default is IMPL_AUTO.
+        //! @return True on success, false if @a impl is not supported on this CPU.
+        //!
+        static bool SetImplementation(Implementation impl);
+
+        //!
+        //! Get the implementation of AES which is currently used.
+        //! @return The current implementation, never IMPL_AUTO.
+        //!
+        static Implementation GetImplementation();
+
     protected:
         // Implementation of BlockCipher interface:
         virtual bool setKeyImpl(const void* key, size_t key_length, size_t rounds) override;
         virtual bool encryptImpl(const void* plain, size_t plain_length, void* cipher, size_t cipher_maxsize, size_t* cipher_length) override;
         virtual bool decryptImpl(const void* cipher, size_t cipher_length, void* plain, size_t plain_maxsize, size_t* plain_length) override;
+        virtual bool encryptBlocksImpl(const void* plain, void* cipher, size_t count) override;
+        virtual bool decryptBlocksImpl(const void* cipher, void* plain, size_t count) override;
 
     private:
         int      _Nr;     //!< Number of rounds
         uint32_t _eK[60]; //!< Scheduled encryption keys
         uint32_t _dK[60]; //!< Scheduled decryption keys
+        uint8_t  _eKb[(MAX_ROUNDS + 1) * BLOCK_SIZE]; //!< Scheduled encryption keys, serialized for AES-NI
+        uint8_t  _dKb[(MAX_ROUNDS + 1) * BLOCK_SIZE]; //!< Scheduled decryption keys, serialized for AES-NI
+
+        // Current global implementation, never IMPL_AUTO.
+        static std::atomic<Implementation>& CurrentImplementation();
     };
 }
@@ -189,6 +189,39 @@ namespace ts {
         //!
         bool decryptInPlace(void* data, size_t data_length, size_t* max_actual_length = nullptr);
 
+        //!
+        //! Encrypt several consecutive blocks of data, independently from each other.
+        //!
+        //! This is the same as calling encrypt() on each block but some implementations
+        //! (typically hardware-accelerated ones) can process several blocks in parallel.
+        //! This is mostly useful for chaining modes which do not depend on the previous
+        //! cipher block (ECB, CTR). Each block counts as one use of the current key.
+        //!
+        //! @param [in] plain Address of plain text, @a count times blockSize() bytes.
+        //! @param [out] cipher Address of buffer for cipher text, @a count times blockSize() bytes.
+        //! Can be the same as @a plain if the algorithm supports in-place encryption.
+        //! @param [in] count Number of blocks to encrypt.
+        //! @return True on success, false on error.
+        //!
+        bool encryptBlocks(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several consecutive blocks of data, independently from each other.
+        //!
+        //! This is the same as calling decrypt() on each block but some implementations
+        //! (typically hardware-accelerated ones) can process several blocks in parallel.
+        //! This is mostly useful for chaining modes where the decryption of a block does
+        //! not depend on the decryption of the previous one (ECB, CBC). Each block
+        //! counts as one use of the current key.
+        //!
+        //! @param [in] cipher Address of cipher text, @a count times blockSize() bytes.
+        //! @param [out] plain Address of buffer for plain text, @a count times blockSize() bytes.
+        //! Can be the same as @a cipher if the algorithm supports in-place decryption.
+        //! @param [in] count Number of blocks to decrypt.
+        //! @return True on success, false on error.
+        //!
+        bool decryptBlocks(const void* cipher, void* plain, size_t count);
+
         //!
         //! Get the number of times the current key was used for encryption.
         //! @return The number of times the current key was used for encryption.
@@ -255,6 +288,22 @@ namespace ts {
         int cipherId() const { return _cipher_id; }
 
     protected:
+        //!
+        //! Check if encryption is allowed with the current key. Increment the usage counter.
+        //! Can be used by subclasses which implement other forms of encryption than encrypt().
+        //! @param [in] count Number of uses of the current key.
+        //! @return True if encryption is allowed, false otherwise.
+        //!
+        bool allowEncrypt(size_t count = 1);
+
+        //!
+        //! Check if decryption is allowed with the current key. Increment the usage counter.
+        //! Can be used by subclasses which implement other forms of decryption than decrypt().
+        //! @param [in] count Number of uses of the current key.
+        //! @return True if decryption is allowed, false otherwise.
+        //!
+        bool allowDecrypt(size_t count = 1);
+
         //!
         //! Schedule a new key (implementation of algorithm-specific part).
         //! @param [in] key Address of key value.
@@ -314,6 +363,28 @@ namespace ts {
         //!
         virtual bool decryptInPlaceImpl(void* data, size_t data_length, size_t* max_actual_length);
 
+        //!
+        //! Encrypt several consecutive blocks of data (implementation of algorithm-specific part).
+        //! The default implementation is to call encryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] plain Address of plain text, @a count times blockSize() bytes.
+        //! @param [out] cipher Address of buffer for cipher text, @a count times blockSize() bytes.
+        //! @param [in] count Number of blocks to encrypt.
+        //! @return True on success, false on error.
+        //!
+        virtual bool encryptBlocksImpl(const void* plain, void* cipher, size_t count);
+
+        //!
+        //! Decrypt several consecutive blocks of data (implementation of algorithm-specific part).
+        //! The default implementation is to call decryptImpl() on each block.
+        //! A subclass may provide a more efficient implementation.
+        //! @param [in] cipher Address of cipher text, @a count times blockSize() bytes.
+        //! @param [out] plain Address of buffer for plain text, @a count times blockSize() bytes.
+        //! @param [in] count Number of blocks to decrypt.
+        //! @return True on success, false on error.
+        //!
+        virtual bool decryptBlocksImpl(const void* cipher, void* plain, size_t count);
+
     private:
         bool      _key_set;                // Current key successfully set.
         int       _cipher_id;              // Cipher identity (from application).
@@ -324,8 +395,5 @@ namespace ts {
         ByteBlock _current_key;            // Current unscheduled key.
         BlockCipherAlertInterface* _alert; // Alert handler.
 
-        // Check if encryption or decryption is allowed. Increment counters.
-        bool allowEncrypt();
-        bool allowDecrypt();
     };
 }
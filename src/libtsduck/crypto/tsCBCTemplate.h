@@ -33,6 +33,7 @@
 //----------------------------------------------------------------------------
 
 #pragma once
+#include "tsMemory.h"
 
 
 //----------------------------------------------------------------------------
@@ -60,9 +61,7 @@ bool ts::CBC<CIPHER>::encryptImpl(const void* plain, size_t plain_length, void*
 
     while (plain_length > 0) {
         // work = previous-cipher XOR plain-text
-        for (size_t i = 0; i < this->block_size; ++i) {
-            this->work[i] = previous[i] ^ pt[i];
-        }
+        MemXor(this->work.data(), previous, pt, this->block_size);
         // cipher-text = encrypt (work)
         if (!this->algo->encrypt(this->work.data(), this->block_size, ct, this->block_size)) {
             return false;
@@ -101,22 +100,27 @@ bool ts::CBC<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, void
     const uint8_t* previous = this->iv.data();
     const uint8_t* ct = reinterpret_cast<const uint8_t*> (cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*> (plain);
+    const size_t work_blocks = this->work.size() / this->block_size;
 
+    // Unlike encryption, the decryption of all blocks are independent.
+    // Decrypt as many blocks as possible at once in the work buffer.
     while (cipher_length > 0) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
+        const size_t count = std::min(cipher_length / this->block_size, work_blocks);
+        const size_t size = count * this->block_size;
+        // work = decrypt (cipher-text blocks)
+        if (!this->algo->decryptBlocks(ct, this->work.data(), count)) {
             return false;
         }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+        // first plain-text = previous-cipher XOR work
+        // next plain-texts = previous cipher-text XOR work
+        MemXor(pt, previous, this->work.data(), this->block_size);
+        MemXor(pt + this->block_size, ct, this->work.data() + this->block_size, size - this->block_size);
+        // previous-cipher = last cipher-text
+        previous = ct + size - this->block_size;
+        // advance all blocks
+        ct += size;
+        pt += size;
+        cipher_length -= size;
     }
 
     return true;
@@ -87,9 +87,10 @@ namespace ts {
     private:
         size_t _counter_bits; // size in bits of the counter part.
 
-        // We need two work blocks.
+        // We need at least three work blocks.
         // The first one contains the "input block" or counter.
-        // The second one contains the "output block", the encrypted counter.
+        // The next ones contain successive counter values and the "output blocks",
+        // the encrypted counters, up to PARALLEL_BLOCKS of each.
         // This private method increments the counter block.
         bool incrementCounter();
     };
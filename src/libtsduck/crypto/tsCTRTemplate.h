@@ -37,7 +37,7 @@
 
 template<class CIPHER>
 ts::CTR<CIPHER>::CTR(size_t counter_bits) :
-    CipherChainingTemplate<CIPHER>(1, 1, 2),
+    CipherChainingTemplate<CIPHER>(1, 1, 1 + 2 * CipherChaining::PARALLEL_BLOCKS),
     _counter_bits(0)
 {
     setCounterBits(counter_bits);
@@ -121,7 +121,7 @@ bool ts::CTR<CIPHER>::encryptImpl(const void* plain, size_t plain_length, void*
 {
     if (this->algo == nullptr ||
         this->iv.size() != this->block_size ||
-        this->work.size() < 2 * this->block_size ||
+        this->work.size() < 3 * this->block_size ||
         cipher_maxsize < plain_length)
     {
         return false;
@@ -133,27 +133,36 @@ bool ts::CTR<CIPHER>::encryptImpl(const void* plain, size_t plain_length, void*
     // work[0] = iv
     ::memcpy(this->work.data(), this->iv.data(), this->block_size);
 
+    // The rest of the work buffer is split in two equal parts: successive counter values
+    // and their encrypted values. All counter blocks are encrypted at once.
+    const size_t max_blocks = (this->work.size() / this->block_size - 1) / 2;
+    uint8_t* const counters = this->work.data() + this->block_size;
+    uint8_t* const stream = counters + max_blocks * this->block_size;
+
     // Loop on all blocks, including last truncated one.
 
     const uint8_t* pt = reinterpret_cast<const uint8_t*>(plain);
     uint8_t* ct = reinterpret_cast<uint8_t*>(cipher);
 
     while (plain_length > 0) {
-        // work[1] = encrypt(work[0])
-        if (!this->algo->encrypt(this->work.data(), this->block_size, this->work.data() + this->block_size, this->block_size)) {
-            return false;
-        }
-        // This block size:
-        const size_t size = std::min(plain_length, this->block_size);
-        // cipher-text = plain-text XOR work[1]
-        for (size_t i = 0; i < size; ++i) {
-            ct[i] = this->work[this->block_size + i] ^ pt[i];
+        // Number of blocks in this pass, including a truncated one:
+        const size_t count = std::min((plain_length + this->block_size - 1) / this->block_size, max_blocks);
+        // counters[n] = work[0]++
+        for (size_t n = 0; n < count; ++n) {
+            ::memcpy(counters + n * this->block_size, this->work.data(), this->block_size);
+            if (!incrementCounter()) {
+                return false;
+            }
         }
-        // work[0] += 1
-        if (!incrementCounter()) {
+        // stream = encrypt(counters)
+        if (!this->algo->encryptBlocks(counters, stream, count)) {
             return false;
         }
-        // advance one block
+        // This data size:
+        const size_t size = std::min(plain_length, count * this->block_size);
+        // cipher-text = plain-text XOR stream
+        MemXor(ct, pt, stream, size);
+        // advance all blocks
         ct += size;
         pt += size;
         plain_length -= size;
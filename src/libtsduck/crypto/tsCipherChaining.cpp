@@ -30,6 +30,10 @@
 #include "tsCipherChaining.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::CipherChaining::PARALLEL_BLOCKS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor for subclasses
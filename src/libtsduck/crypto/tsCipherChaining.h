@@ -91,6 +91,13 @@ namespace ts {
         //!
         virtual bool residueAllowed() const = 0;
 
+        //!
+        //! Maximum number of blocks which are submitted at once to the block cipher
+        //! in chaining modes where the blocks can be processed independently.
+        //! Some block cipher implementations process several blocks in parallel.
+        //!
+        static constexpr size_t PARALLEL_BLOCKS = 8;
+
     protected:
         // Protected fields, for chaining mode subclass implementation.
         BlockCipher* algo;        //!< An instance of the block cipher.
@@ -10,6 +10,7 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#include "tsSysInfo.h"
 TSDUCK_SOURCE;
 
 // Operations on 64-bit areas.
@@ -719,6 +720,781 @@ bool ts::DVBCSA2::decryptInPlaceImpl(void* addr, size_t size, size_t* max_actual
 }
 
 
+//----------------------------------------------------------------------------
+// Bitsliced batch processing.
+//
+// When many packets are scrambled with the same control word, the stream
+// cipher is computed on all packets in parallel, one bit of a "slice" word
+// per packet (bitslicing, as in libdvbcsa). The stream cipher operates on
+// nibbles and bits, its S-boxes become small boolean circuits. The slice word
+// is a 64-bit integer (portable) or a 128/256-bit vector (SSE2/AVX2).
+//
+// The block cipher is based on a 8-bit S-box which is too expensive as a
+// boolean circuit. It is "byte-sliced" instead: the same byte of all blocks
+// is stored contiguously and the XOR operations apply on 8 blocks at a time.
+//
+// The two ciphers are independent: in decryption, the stream cipher is
+// applied first on all blocks, then the reverse CBC block cipher. In
+// encryption, the block cipher is applied first.
+//----------------------------------------------------------------------------
+
+#if defined(TS_GCC) && (defined(TS_I386) || defined(TS_X86_64))
+    #define TS_CSA_SIMD 1
+#endif
+
+#if defined(TS_MSC)
+    #define TS_CSA_INLINE __forceinline
+#elif defined(TS_GCC)
+    #define TS_CSA_INLINE inline __attribute__((always_inline))
+#else
+    #define TS_CSA_INLINE inline
+#endif
+
+namespace {
+
+    // Maximum number of packets in a group, processed in parallel (256 with AVX2).
+    constexpr size_t MAX_LANES = 256;
+    constexpr size_t MAX_LANE_WORDS = MAX_LANES / 64;
+
+    // Slice words: one bit per packet.
+    typedef uint64_t Slice64;
+#if defined(TS_CSA_SIMD)
+    typedef uint64_t Slice128 __attribute__((vector_size(16)));
+    typedef uint64_t Slice256 __attribute__((vector_size(32)));
+#endif
+
+    // Number of 64-bit words in a slice word.
+    template <typename W>
+    struct SliceWords
+    {
+        static constexpr size_t value = sizeof(W) / sizeof(uint64_t);
+    };
+
+    // Load and store a slice word from/to an array of 64-bit integers.
+    template <typename W>
+    TS_CSA_INLINE void SliceLoad(W& w, const uint64_t* p)
+    {
+        ::memcpy(&w, p, sizeof(W));
+    }
+
+    template <typename W>
+    TS_CSA_INLINE void SliceStore(uint64_t* p, const W& w)
+    {
+        ::memcpy(p, &w, sizeof(W));
+    }
+
+    // Transpose a 8x8 bit matrix: bit j of byte i becomes bit i of byte j.
+    TS_CSA_INLINE uint64_t Transpose8x8(uint64_t x)
+    {
+        uint64_t t;
+        t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AA;
+        x = x ^ t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCC;
+        x = x ^ t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0;
+        x = x ^ t ^ (t << 28);
+        return x;
+    }
+
+    // Bitslice byte 'index' of all packets: bit b of packet l becomes bit l of bits[b].
+    void GatherBits(const ts::DVBCSA2::BatchEntry* entries, size_t count, size_t index, uint64_t bits[8][MAX_LANE_WORDS], size_t words)
+    {
+        for (size_t b = 0; b < 8; ++b) {
+            for (size_t w = 0; w < words; ++w) {
+                bits[b][w] = 0;
+            }
+        }
+        for (size_t lane = 0; lane < count; lane += 8) {
+            uint64_t x = 0;
+            for (size_t i = 0; i < 8 && lane + i < count; ++i) {
+                x |= uint64_t(entries[lane + i].data[index]) << (8 * i);
+            }
+            x = Transpose8x8(x);
+            const size_t shift = lane % 64;
+            for (size_t b = 0; b < 8; ++b) {
+                bits[b][lane / 64] |= ((x >> (8 * b)) & 0xFF) << shift;
+            }
+        }
+    }
+
+    // Reverse of GatherBits: xor bit l of bits[b] into bit b of byte 'index' of packet l.
+    // Packets which are shorter than 'index' are unmodified.
+    void ScatterBits(const ts::DVBCSA2::BatchEntry* entries, size_t count, size_t index, const uint64_t bits[8][MAX_LANE_WORDS])
+    {
+        for (size_t lane = 0; lane < count; lane += 8) {
+            uint64_t x = 0;
+            const size_t shift = lane % 64;
+            for (size_t b = 0; b < 8; ++b) {
+                x |= ((bits[b][lane / 64] >> shift) & 0xFF) << (8 * b);
+            }
+            x = Transpose8x8(x);
+            for (size_t i = 0; i < 8 && lane + i < count; ++i) {
+                if (index < entries[lane + i].size) {
+                    entries[lane + i].data[index] ^= uint8_t(x >> (8 * i));
+                }
+            }
+        }
+    }
+
+    // Boolean circuits for the S-boxes of the stream cipher: 5 input bits
+    // (x4 is the most significant one in the index of the original S-box),
+    // 2 output bits. Generated from the tables sbox1 to sbox7 using a binary
+    // decision diagram with shared sub-functions.
+
+    // S-box 1 (36 operations).
+    template <typename W>
+    TS_CSA_INLINE void StreamSbox1(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& hi, W& lo)
+    {
+        const W t0 = ~x4;
+        const W t1 = x2 | t0;
+        const W t2 = x2 | x4;
+        const W t3 = t1 ^ (x0 & (t1 ^ t2));
+        const W t4 = x2 ^ x4;
+        const W t5 = ~x0 & t4;
+        const W t6 = t3 ^ (x1 & (t3 ^ t5));
+        const W t7 = ~x2;
+        const W t8 = ~t4;
+        const W t9 = x0 ^ t8;
+        const W t10 = t7 ^ (x1 & (t7 ^ t9));
+        const W t11 = t6 ^ (x3 & (t6 ^ t10));
+        const W t12 = x0 & t4;
+        const W t13 = x1 ^ t12;
+        const W t14 = t1 ^ (x0 & (t1 ^ x2));
+        const W t15 = x2 & x4;
+        const W t16 = t15 ^ (x0 & (t15 ^ t4));
+        const W t17 = t14 ^ (x1 & (t14 ^ t16));
+        const W t18 = t13 ^ (x3 & (t13 ^ t17));
+        hi = t11;
+        lo = t18;
+    }
+
+    // S-box 2 (38 operations).
+    template <typename W>
+    TS_CSA_INLINE void StreamSbox2(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& hi, W& lo)
+    {
+        const W t0 = ~x1;
+        const W t1 = x2 | t0;
+        const W t2 = x3 ^ t1;
+        const W t3 = t0 ^ (x3 & (t0 ^ x2));
+        const W t4 = t2 ^ (x4 & (t2 ^ t3));
+        const W t5 = x2 ^ x1;
+        const W t6 = x3 ^ t5;
+        const W t7 = x2 | x1;
+        const W t8 = ~t1;
+        const W t9 = t7 ^ (x3 & (t7 ^ t8));
+        const W t10 = t6 ^ (x4 & (t6 ^ t9));
+        const W t11 = t4 ^ (x0 & (t4 ^ t10));
+        const W t12 = ~t5;
+        const W t13 = x3 ^ t0;
+        const W t14 = t12 ^ (x4 & (t12 ^ t13));
+        const W t15 = ~x2;
+        const W t16 = t0 ^ (x3 & (t0 ^ t15));
+        const W t17 = x3 ^ t15;
+        const W t18 = t16 ^ (x4 & (t16 ^ t17));
+        const W t19 = t14 ^ (x0 & (t14 ^ t18));
+        hi = t11;
+        lo = t19;
+    }
+
+    // S-box 3 (25 operations).
+    template <typename W>
+    TS_CSA_INLINE void StreamSbox3(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& hi, W& lo)
+    {
+        const W t0 = ~x1;
+        const W t1 = ~x4 & t0;
+        const W t2 = x2 | t1;
+        const W t3 = x4 ^ x1;
+        const W t4 = x2 ^ t3;
+        const W t5 = t2 ^ (x0 & (t2 ^ t4));
+        const W t6 = x4 & t0;
+        const W t7 = x2 ^ t6;
+        const W t8 = x1 ^ (x2 & (x1 ^ t6));
+        const W t9 = t7 ^ (x0 & (t7 ^ t8));
+        const W t10 = t5 ^ (x3 & (t5 ^ t9));
+        const W t11 = x2 ^ x4;
+        const W t12 = t3 ^ (x0 & (t3 ^ t11));
+        const W t13 = x3 ^ t12;
+        hi = t10;
+        lo = t13;
+    }
+
+    // S-box 4 (26 operations).
+    template <typename W>
+    TS_CSA_INLINE void StreamSbox4(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& hi, W& lo)
+    {
+        const W t0 = ~x0;
+        const W t1 = x1 | t0;
+        const W t2 = t1 ^ (x2 & (t1 ^ x0));
+        const W t3 = ~t1;
+        const W t4 = x1 ^ t0;
+        const W t5 = t3 ^ (x2 & (t3 ^ t4));
+        const W t6 = t2 ^ (x3 & (t2 ^ t5));
+        const W t7 = x1 & t0;
+        const W t8 = x2 ^ t7;
+        const W t9 = ~t4;
+        const W t10 = t8 ^ (x3 & (t8 ^ t9));
+        const W t11 = t6 ^ (x4 & (t6 ^ t10));
+        const W t12 = ~t10;
+        const W t13 = t12 ^ (x4 & (t12 ^ t6));
+        hi = t11;
+        lo = t13;
+    }
+
+    // S-box 5 (36 operations).
+    template <typename W>
+    TS_CSA_INLINE void StreamSbox5(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& hi, W& lo)
+    {
+        const W t0 = ~x3;
+        const W t1 = x1 ^ t0;
+        const W t2 = x1 | t0;
+        const W t3 = t1 ^ (x2 & (t1 ^ t2));
+        const W t4 = x2 ^ t2;
+        const W t5 = t3 ^ (x4 & (t3 ^ t4));
+        const W t6 = x1 & x3;
+        const W t7 = t6 ^ (x2 & (t6 ^ t0));
+        const W t8 = t7 ^ (x4 & (t7 ^ t1));
+        const W t9 = t5 ^ (x0 & (t5 ^ t8));
+        const W t10 = x2 ^ t6;
+        const W t11 = ~t1;
+        const W t12 = x3 ^ (x2 & (x3 ^ t11));
+        const W t13 = t10 ^ (x4 & (t10 ^ t12));
+        const W t14 = x1 | x3;
+        const W t15 = t14 ^ (x2 & (t14 ^ t6));
+        const W t16 = x4 ^ t15;
+        const W t17 = t13 ^ (x0 & (t13 ^ t16));
+        hi = t9;
+        lo = t17;
+    }
+
+    // S-box 6 (32 operations).
+    template <typename W>
+    TS_CSA_INLINE void StreamSbox6(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& hi, W& lo)
+    {
+        const W t0 = x4 ^ x1;
+        const W t1 = x2 ^ t0;
+        const W t2 = t0 ^ (x3 & (t0 ^ t1));
+        const W t3 = x4 | x1;
+        const W t4 = x2 ^ t3;
+        const W t5 = x4 & x1;
+        const W t6 = x2 ^ t5;
+        const W t7 = t4 ^ (x3 & (t4 ^ t6));
+        const W t8 = t2 ^ (x0 & (t2 ^ t7));
+        const W t9 = ~x1;
+        const W t10 = x4 | t9;
+        const W t11 = x2 & t10;
+        const W t12 = t11 ^ (x3 & (t11 ^ x1));
+        const W t13 = ~t6;
+        const W t14 = ~t5;
+        const W t15 = t9 ^ (x2 & (t9 ^ t14));
+        const W t16 = t13 ^ (x3 & (t13 ^ t15));
+        const W t17 = t12 ^ (x0 & (t12 ^ t16));
+        hi = t8;
+        lo = t17;
+    }
+
+    // S-box 7 (37 operations).
+    template <typename W>
+    TS_CSA_INLINE void StreamSbox7(const W& x4, const W& x3, const W& x2, const W& x1, const W& x0, W& hi, W& lo)
+    {
+        const W t0 = x0 ^ x2;
+        const W t1 = ~x4 & t0;
+        const W t2 = x3 ^ t1;
+        const W t3 = ~x2;
+        const W t4 = x0 | t3;
+        const W t5 = t3 ^ (x4 & (t3 ^ t4));
+        const W t6 = x0 & x2;
+        const W t7 = t0 ^ (x4 & (t0 ^ t6));
+        const W t8 = t5 ^ (x3 & (t5 ^ t7));
+        const W t9 = t2 ^ (x1 & (t2 ^ t8));
+        const W t10 = x4 ^ t0;
+        const W t11 = ~x0;
+        const W t12 = x4 ^ t11;
+        const W t13 = t10 ^ (x3 & (t10 ^ t12));
+        const W t14 = x4 ^ t6;
+        const W t15 = ~x0 & t3;
+        const W t16 = t4 ^ (x4 & (t4 ^ t15));
+        const W t17 = t14 ^ (x3 & (t14 ^ t16));
+        const W t18 = t13 ^ (x1 & (t13 ^ t17));
+        hi = t9;
+        lo = t18;
+    }
+
+    // Bitsliced state of the stream cipher: the registers are stored as one
+    // slice word per bit (see StreamCipher for the meaning of the registers).
+    template <typename W>
+    class StreamSlices
+    {
+    public:
+        // Initialize the state from the control word, same for all packets.
+        TS_CSA_INLINE void init(const uint8_t* key)
+        {
+            const W zero = W();
+            for (size_t i = 0; i < 4; ++i) {
+                for (size_t n = 0; n < 2; ++n) {
+                    for (size_t b = 0; b < 4; ++b) {
+                        A[1 + 2*i + n][b] = ((key[i] >> (4 - 4*n + b)) & 1) != 0 ? ~zero : zero;
+                        B[1 + 2*i + n][b] = ((key[4 + i] >> (4 - 4*n + b)) & 1) != 0 ? ~zero : zero;
+                    }
+                }
+            }
+            for (size_t b = 0; b < 4; ++b) {
+                A[9][b] = A[10][b] = B[9][b] = B[10][b] = zero;
+                X[b] = Y[b] = Z[b] = D[b] = E[b] = F[b] = zero;
+            }
+            p = q = r = zero;
+        }
+
+        // One step (2 bits) of the stream cipher. The input nibbles are used
+        // during initialization only, null during generation.
+        TS_CSA_INLINE void step(const W* in_a, const W* in_b, W& op_hi, W& op_lo)
+        {
+            W s1h, s1l, s2h, s2l, s3h, s3l, s4h, s4l, s5h, s5l, s6h, s6l, s7h, s7l;
+            StreamSbox1(A[4][0], A[1][2], A[6][1], A[7][3], A[9][0], s1h, s1l);
+            StreamSbox2(A[2][1], A[3][2], A[6][3], A[7][0], A[9][1], s2h, s2l);
+            StreamSbox3(A[1][3], A[2][0], A[5][1], A[5][3], A[6][2], s3h, s3l);
+            StreamSbox4(A[3][3], A[1][1], A[2][3], A[4][2], A[8][0], s4h, s4l);
+            StreamSbox5(A[5][2], A[4][3], A[6][0], A[8][1], A[9][2], s5h, s5l);
+            StreamSbox6(A[3][1], A[4][1], A[5][0], A[7][2], A[9][3], s6h, s6l);
+            StreamSbox7(A[2][2], A[3][0], A[7][1], A[8][2], A[8][3], s7h, s7l);
+
+            // Extra nibble for T3.
+            W extra_b[4];
+            extra_b[3] = B[3][0] ^ B[6][1] ^ B[7][2] ^ B[9][3];
+            extra_b[2] = B[6][0] ^ B[8][1] ^ B[3][3] ^ B[4][2];
+            extra_b[1] = B[5][3] ^ B[8][2] ^ B[4][0] ^ B[5][1];
+            extra_b[0] = B[9][2] ^ B[6][3] ^ B[3][1] ^ B[8][0];
+
+            // T1 and T2.
+            W next_a1[4], next_b1[4], rot_b1[4];
+            for (size_t b = 0; b < 4; ++b) {
+                next_a1[b] = A[10][b] ^ X[b];
+                next_b1[b] = B[7][b] ^ B[10][b] ^ Y[b];
+                if (in_a != nullptr) {
+                    next_a1[b] = next_a1[b] ^ D[b] ^ in_a[b];
+                    next_b1[b] = next_b1[b] ^ in_b[b];
+                }
+            }
+
+            // If p=1, rotate next_b1 left.
+            for (size_t b = 0; b < 4; ++b) {
+                rot_b1[b] = next_b1[(b + 3) & 3];
+            }
+            for (size_t b = 0; b < 4; ++b) {
+                next_b1[b] = next_b1[b] ^ (p & (next_b1[b] ^ rot_b1[b]));
+            }
+
+            // T3 and T4: if q=1, F = Z + E + r with carry in r, otherwise F = E.
+            W carry = r;
+            for (size_t b = 0; b < 4; ++b) {
+                const W ze = Z[b] ^ E[b];
+                const W sum = ze ^ carry;
+                carry = (Z[b] & E[b]) | (carry & ze);
+                D[b] = ze ^ extra_b[b];
+                const W next_e = F[b];
+                F[b] = E[b] ^ (q & (E[b] ^ sum));
+                E[b] = next_e;
+            }
+            r = r ^ (q & (r ^ carry));
+
+            // Shift registers.
+            for (size_t i = 10; i > 1; --i) {
+                for (size_t b = 0; b < 4; ++b) {
+                    A[i][b] = A[i-1][b];
+                    B[i][b] = B[i-1][b];
+                }
+            }
+            for (size_t b = 0; b < 4; ++b) {
+                A[1][b] = next_a1[b];
+                B[1][b] = next_b1[b];
+            }
+
+            X[3] = s4l; X[2] = s3l; X[1] = s2h; X[0] = s1h;
+            Y[3] = s6l; Y[2] = s5l; Y[1] = s4h; Y[0] = s3h;
+            Z[3] = s2l; Z[2] = s1l; Z[1] = s6h; Z[0] = s5h;
+            p = s7h;
+            q = s7l;
+
+            // 2 output bits, function of the 4 bits of D.
+            op_hi = D[2] ^ D[3];
+            op_lo = D[0] ^ D[1];
+        }
+
+    private:
+        W A[11][4];  // A[1]..A[10], index 0 unused.
+        W B[11][4];  // B[1]..B[10], index 0 unused.
+        W X[4], Y[4], Z[4], D[4], E[4], F[4];
+        W p, q, r;
+    };
+
+    // Apply the stream cipher on a group of packets. The first 8 bytes of each
+    // packet initialize the stream cipher. The rest of the packet is xor'ed
+    // with the generated stream.
+    template <typename W>
+    TS_CSA_INLINE void StreamGroup(const uint8_t* key, const ts::DVBCSA2::BatchEntry* entries, size_t count)
+    {
+        constexpr size_t words = SliceWords<W>::value;
+        uint64_t bits[8][MAX_LANE_WORDS];
+        W in[8];
+        W out[8];
+
+        size_t max_size = 0;
+        for (size_t i = 0; i < count; ++i) {
+            max_size = std::max(max_size, entries[i].size);
+        }
+
+        StreamSlices<W> stream;
+        stream.init(key);
+
+        // Initialization using the first block of each packet.
+        for (size_t index = 0; index < 8; ++index) {
+            GatherBits(entries, count, index, bits, words);
+            for (size_t b = 0; b < 8; ++b) {
+                SliceLoad<W>(in[b], bits[b]);
+            }
+            // in1 = most significant nibble, in2 = least significant nibble.
+            const W* in1 = in + 4;
+            const W* in2 = in;
+            stream.step(in1, in2, out[7], out[6]);
+            stream.step(in2, in1, out[5], out[4]);
+            stream.step(in1, in2, out[3], out[2]);
+            stream.step(in2, in1, out[1], out[0]);
+        }
+
+        // Generate the stream for subsequent bytes.
+        for (size_t index = 8; index < max_size; ++index) {
+            stream.step(nullptr, nullptr, out[7], out[6]);
+            stream.step(nullptr, nullptr, out[5], out[4]);
+            stream.step(nullptr, nullptr, out[3], out[2]);
+            stream.step(nullptr, nullptr, out[1], out[0]);
+            for (size_t b = 0; b < 8; ++b) {
+                SliceStore<W>(bits[b], out[b]);
+            }
+            ScatterBits(entries, count, index, bits);
+        }
+    }
+
+    // Byte-sliced blocks: byte k of the block of packet l is byte l of row k.
+    // The operations on rows use 64-bit words, 8 packets at a time.
+    typedef uint64_t BlockRows[8][MAX_LANES / 8];
+
+    TS_CSA_INLINE uint8_t* RowBytes(uint64_t* row)
+    {
+        return reinterpret_cast<uint8_t*>(row);
+    }
+
+    // Decipher all blocks in byte-sliced rows.
+    void BlockDecipherRows(const int* kk, BlockRows& rows, size_t count)
+    {
+        const size_t words = (count + 7) / 8;
+        uint64_t sbox_out[MAX_LANES / 8];
+        uint64_t perm_out[MAX_LANES / 8];
+        uint8_t* const s8 = RowBytes(sbox_out);
+        uint8_t* const p8 = RowBytes(perm_out);
+
+        // Instead of moving the registers R[1]..R[8] at each round, the logical
+        // register Rk is stored in row (k - 1 + off) % 8 and 'off' is rotated.
+        size_t off = 0;
+        for (int i = 56; i > 0; i--) {
+            uint64_t* const r2 = rows[(off + 1) & 7];
+            uint64_t* const r3 = rows[(off + 2) & 7];
+            uint64_t* const r4 = rows[(off + 3) & 7];
+            uint64_t* const r6 = rows[(off + 5) & 7];
+            uint64_t* const r7 = rows[(off + 6) & 7];
+            uint64_t* const r8 = rows[(off + 7) & 7];
+            const uint8_t* const r7b = RowBytes(r7);
+            const uint8_t k = uint8_t(kk[i]);
+            for (size_t l = 0; l < 8 * words; ++l) {
+                s8[l] = block_sbox[k ^ r7b[l]];
+                p8[l] = uint8_t(block_perm[s8[l]]);
+            }
+            // R8 ^ sbox_out becomes R1, R2..R4 are xor'ed with it, R6 with perm_out.
+            for (size_t w = 0; w < words; ++w) {
+                const uint64_t t = r8[w] ^ sbox_out[w];
+                r8[w] = t;
+                r2[w] ^= t;
+                r3[w] ^= t;
+                r4[w] ^= t;
+                r6[w] ^= perm_out[w];
+            }
+            off = (off + 7) & 7;
+        }
+    }
+
+    // Encipher all blocks in byte-sliced rows.
+    void BlockEncipherRows(const int* kk, BlockRows& rows, size_t count)
+    {
+        const size_t words = (count + 7) / 8;
+        uint64_t sbox_out[MAX_LANES / 8];
+        uint64_t perm_out[MAX_LANES / 8];
+        uint8_t* const s8 = RowBytes(sbox_out);
+        uint8_t* const p8 = RowBytes(perm_out);
+
+        size_t off = 0;
+        for (int i = 1; i <= 56; i++) {
+            uint64_t* const r1 = rows[(off + 0) & 7];
+            uint64_t* const r3 = rows[(off + 2) & 7];
+            uint64_t* const r4 = rows[(off + 3) & 7];
+            uint64_t* const r5 = rows[(off + 4) & 7];
+            uint64_t* const r7 = rows[(off + 6) & 7];
+            uint64_t* const r8 = rows[(off + 7) & 7];
+            const uint8_t* const r8b = RowBytes(r8);
+            const uint8_t k = uint8_t(kk[i]);
+            for (size_t l = 0; l < 8 * words; ++l) {
+                s8[l] = block_sbox[k ^ r8b[l]];
+                p8[l] = uint8_t(block_perm[s8[l]]);
+            }
+            // R3..R5 are xor'ed with R1, R7 with perm_out, R1 ^ sbox_out becomes R8.
+            for (size_t w = 0; w < words; ++w) {
+                const uint64_t t = r1[w];
+                r3[w] ^= t;
+                r4[w] ^= t;
+                r5[w] ^= t;
+                r7[w] ^= perm_out[w];
+                r1[w] = t ^ sbox_out[w];
+            }
+            off = (off + 1) & 7;
+        }
+    }
+
+    // Reverse CBC block decryption on a group of packets, after stream decryption:
+    // block i becomes decipher(block i) ^ block i+1 (the block after the last one is zero).
+    void BlockDecryptGroup(const int* kk, const ts::DVBCSA2::BatchEntry* entries, size_t count)
+    {
+        BlockRows rows;
+        size_t max_blocks = 0;
+        for (size_t l = 0; l < count; ++l) {
+            max_blocks = std::max(max_blocks, entries[l].size / 8);
+        }
+        ::memset(rows, 0, sizeof(rows));
+
+        for (size_t i = 0; i < max_blocks; ++i) {
+            for (size_t l = 0; l < count; ++l) {
+                if (i < entries[l].size / 8) {
+                    const uint8_t* const data = entries[l].data + 8 * i;
+                    for (size_t k = 0; k < 8; ++k) {
+                        RowBytes(rows[k])[l] = data[k];
+                    }
+                }
+            }
+            BlockDecipherRows(kk, rows, count);
+            for (size_t l = 0; l < count; ++l) {
+                const size_t nblocks = entries[l].size / 8;
+                if (i < nblocks) {
+                    uint8_t* const data = entries[l].data + 8 * i;
+                    for (size_t k = 0; k < 8; ++k) {
+                        data[k] = RowBytes(rows[k])[l] ^ (i + 1 < nblocks ? data[8 + k] : 0);
+                    }
+                }
+            }
+        }
+    }
+
+    // Reverse CBC block encryption on a group of packets, before stream encryption:
+    // starting from the last block, block i becomes encipher(block i ^ block i+1).
+    void BlockEncryptGroup(const int* kk, const ts::DVBCSA2::BatchEntry* entries, size_t count)
+    {
+        BlockRows rows;
+        size_t max_blocks = 0;
+        for (size_t l = 0; l < count; ++l) {
+            max_blocks = std::max(max_blocks, entries[l].size / 8);
+        }
+        ::memset(rows, 0, sizeof(rows));
+
+        for (size_t i = max_blocks; i-- > 0; ) {
+            for (size_t l = 0; l < count; ++l) {
+                const size_t nblocks = entries[l].size / 8;
+                if (i < nblocks) {
+                    const uint8_t* const data = entries[l].data + 8 * i;
+                    for (size_t k = 0; k < 8; ++k) {
+                        RowBytes(rows[k])[l] = data[k] ^ (i + 1 < nblocks ? data[8 + k] : 0);
+                    }
+                }
+            }
+            BlockEncipherRows(kk, rows, count);
+            for (size_t l = 0; l < count; ++l) {
+                if (i < entries[l].size / 8) {
+                    uint8_t* const data = entries[l].data + 8 * i;
+                    for (size_t k = 0; k < 8; ++k) {
+                        data[k] = RowBytes(rows[k])[l];
+                    }
+                }
+            }
+        }
+    }
+
+    // Process a group of packets, up to the number of bits in a slice word.
+    // All packets have at least one complete block.
+    template <typename W>
+    TS_CSA_INLINE void BatchGroup(const uint8_t* key, const int* kk, const ts::DVBCSA2::BatchEntry* entries, size_t count, bool encrypt)
+    {
+        if (encrypt) {
+            BlockEncryptGroup(kk, entries, count);
+            StreamGroup<W>(key, entries, count);
+        }
+        else {
+            StreamGroup<W>(key, entries, count);
+            BlockDecryptGroup(kk, entries, count);
+        }
+    }
+
+    // Instantiation of the group processing for each type of slice.
+    typedef void (*BatchGroupFunction)(const uint8_t*, const int*, const ts::DVBCSA2::BatchEntry*, size_t, bool);
+
+    void BatchGroup64(const uint8_t* key, const int* kk, const ts::DVBCSA2::BatchEntry* entries, size_t count, bool encrypt)
+    {
+        BatchGroup<Slice64>(key, kk, entries, count, encrypt);
+    }
+
+#if defined(TS_CSA_SIMD)
+    __attribute__((target("sse2")))
+    void BatchGroup128(const uint8_t* key, const int* kk, const ts::DVBCSA2::BatchEntry* entries, size_t count, bool encrypt)
+    {
+        BatchGroup<Slice128>(key, kk, entries, count, encrypt);
+    }
+
+    __attribute__((target("avx2")))
+    void BatchGroup256(const uint8_t* key, const int* kk, const ts::DVBCSA2::BatchEntry* entries, size_t count, bool encrypt)
+    {
+        BatchGroup<Slice256>(key, kk, entries, count, encrypt);
+    }
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Selection of the batch mode.
+//----------------------------------------------------------------------------
+
+bool ts::DVBCSA2::IsSupported(BatchMode mode)
+{
+    switch (mode) {
+        case BATCH_AUTO:
+        case BATCH_SERIAL:
+        case BATCH_BITSLICE64:
+            return true;
+#if defined(TS_CSA_SIMD)
+        case BATCH_SSE2:
+            return SysInfo::Instance()->cpuHasSSE2();
+        case BATCH_AVX2:
+            return SysInfo::Instance()->cpuHasAVX2();
+#endif
+        default:
+            return false;
+    }
+}
+
+ts::DVBCSA2::BatchMode ts::DVBCSA2::BestBatchMode()
+{
+    if (IsSupported(BATCH_AVX2)) {
+        return BATCH_AVX2;
+    }
+    else if (IsSupported(BATCH_SSE2)) {
+        return BATCH_SSE2;
+    }
+    else {
+        return BATCH_BITSLICE64;
+    }
+}
+
+// Current batch mode, can be changed while other threads are scrambling.
+std::atomic<ts::DVBCSA2::BatchMode>& ts::DVBCSA2::CurrentBatchMode()
+{
+    static std::atomic<BatchMode> mode(BestBatchMode());
+    return mode;
+}
+
+bool ts::DVBCSA2::SetBatchMode(BatchMode mode)
+{
+    if (!IsSupported(mode)) {
+        return false;
+    }
+    else {
+        CurrentBatchMode().store(mode != BATCH_AUTO ? mode : BestBatchMode());
+        return true;
+    }
+}
+
+ts::DVBCSA2::BatchMode ts::DVBCSA2::GetBatchMode()
+{
+    return CurrentBatchMode().load(std::memory_order_relaxed);
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt or decrypt a batch of data areas.
+//----------------------------------------------------------------------------
+
+bool ts::DVBCSA2::encryptBatch(const BatchEntry* entries, size_t count)
+{
+    return processBatch(entries, count, true);
+}
+
+bool ts::DVBCSA2::decryptBatch(const BatchEntry* entries, size_t count)
+{
+    return processBatch(entries, count, false);
+}
+
+bool ts::DVBCSA2::processBatch(const BatchEntry* entries, size_t count, bool encrypt)
+{
+    // Filter invalid parameters.
+    if (entries == nullptr || !_init) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (entries[i].data == nullptr || entries[i].size / 8 > MAX_NBLOCKS || !(encrypt ? allowEncrypt() : allowDecrypt())) {
+            return false;
+        }
+    }
+
+    // Select the implementation.
+    BatchGroupFunction func = nullptr;
+    size_t lanes = 0;
+    switch (GetBatchMode()) {
+        case BATCH_BITSLICE64:
+            func = BatchGroup64;
+            lanes = 64;
+            break;
+#if defined(TS_CSA_SIMD)
+        case BATCH_SSE2:
+            func = BatchGroup128;
+            lanes = 128;
+            break;
+        case BATCH_AVX2:
+            func = BatchGroup256;
+            lanes = 256;
+            break;
+#endif
+        case BATCH_SERIAL:
+        case BATCH_AUTO:
+        default:
+            break;
+    }
+
+    // Process small batches one by one, bitslicing is not worth the setup.
+    if (func == nullptr || count < 4) {
+        bool ok = true;
+        for (size_t i = 0; ok && i < count; ++i) {
+            ok = encrypt ? encryptInPlaceImpl(entries[i].data, entries[i].size, nullptr) : decryptInPlaceImpl(entries[i].data, entries[i].size, nullptr);
+        }
+        return ok;
+    }
+
+    // Build groups of packets. Data areas smaller than 8 bytes are left unscrambled.
+    BatchEntry group[MAX_LANES];
+    size_t group_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (entries[i].size >= 8) {
+            group[group_count++] = entries[i];
+        }
+        if (group_count > 0 && (group_count == lanes || i + 1 == count)) {
+            func(_key, _block.schedule(), group, group_count, encrypt);
+            group_count = 0;
+        }
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Wrappers for encrypt and decrypt.
 //----------------------------------------------------------------------------
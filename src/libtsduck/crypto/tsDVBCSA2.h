@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsCipherChaining.h"
+#include <atomic>
 
 namespace ts {
     //!
@@ -88,6 +89,71 @@ namespace ts {
         //!
         static bool IsReducedCW(const uint8_t *cw);
 
+        //!
+        //! Description of one data area in a batch of DVB-CSA2 operations.
+        //! Typically the payload of a TS packet.
+        //!
+        struct BatchEntry
+        {
+            uint8_t* data;  //!< Address of data to encrypt or decrypt in place.
+            size_t   size;  //!< Size in bytes of the data area, up to 184 bytes.
+        };
+
+        //!
+        //! Implementation of batch operations.
+        //! When several TS packets are scrambled with the same control word, they can
+        //! be processed in parallel using "bitslicing", one bit of a machine word per packet.
+        //!
+        enum BatchMode {
+            BATCH_AUTO,        //!< Use the fastest implementation on this CPU.
+            BATCH_SERIAL,      //!< Process packets one by one, no parallelism.
+            BATCH_BITSLICE64,  //!< Bitsliced on 64-bit integers (64 packets in parallel), portable.
+            BATCH_SSE2,        //!< Bitsliced on 128-bit SSE2 vectors (128 packets in parallel).
+            BATCH_AVX2         //!< Bitsliced on 256-bit AVX2 vectors (256 packets in parallel).
+        };
+
+        //!
+        //! Check if a batch mode is supported on this platform and CPU.
+        //! @param [in] mode The batch mode to check.
+        //! @return True if @a mode is supported.
+        //!
+        static bool IsSupported(BatchMode mode);
+
+        //!
+        //! Force the implementation of batch operations (typically for tests and benchmarks).
+        //! This is a global setting for all instances of DVBCSA2. It can be safely called
+        //! while other threads use DVBCSA2 instances, which switch at their next batch.
+        //! @param [in] mode The batch mode to use. The default is BATCH_AUTO.
+        //! @return True on success, false if @a mode is not supported on this CPU.
+        //!
+        static bool SetBatchMode(BatchMode mode);
+
+        //!
+        //! Get the implementation of batch operations which is currently used.
+        //! @return The current batch mode, never BATCH_AUTO.
+        //!
+        static BatchMode GetBatchMode();
+
+        //!
+        //! Encrypt several data areas in place with the current control word.
+        //! The result is identical to calling encryptInPlace() on each area.
+        //! Data areas which are smaller than 8 bytes are left unmodified.
+        //! @param [in] entries Address of an array of data areas.
+        //! @param [in] count Number of data areas in @a entries.
+        //! @return True on success, false on error.
+        //!
+        bool encryptBatch(const BatchEntry* entries, size_t count);
+
+        //!
+        //! Decrypt several data areas in place with the current control word.
+        //! The result is identical to calling decryptInPlace() on each area.
+        //! Data areas which are smaller than 8 bytes are left unmodified.
+        //! @param [in] entries Address of an array of data areas.
+        //! @param [in] count Number of data areas in @a entries.
+        //! @return True on success, false on error.
+        //!
+        bool decryptBatch(const BatchEntry* entries, size_t count);
+
         // Implementation of CipherChaining interface. Cannot set IV with DVB CSA.
         virtual bool setIV(const void*, size_t) override;
         virtual size_t minIVSize() const override;
@@ -123,6 +189,7 @@ namespace ts {
             void init(const uint8_t *cw);
             void encipher(const uint8_t *bd, uint8_t *ib);
             void decipher(const uint8_t *ib, uint8_t *bd);
+            const int* schedule() const { return _kk; }
         };
 
         // Stream cipher data
@@ -145,6 +212,15 @@ namespace ts {
             void cipher(const uint8_t* sb, uint8_t *cb);
         };
 
+        // Process a batch, using the current batch mode.
+        bool processBatch(const BatchEntry* entries, size_t count, bool encrypt);
+
+        // Current global batch mode, never BATCH_AUTO.
+        static std::atomic<BatchMode>& CurrentBatchMode();
+
+        // Fastest batch mode on this CPU.
+        static BatchMode BestBatchMode();
+
         // DVB-CSA scrambling data
         bool         _init;
         EntropyMode  _mode;
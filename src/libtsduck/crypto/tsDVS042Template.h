@@ -45,7 +45,7 @@ TS_MSC_NOWARNING(4505) // warning C4505: 'ts::DVS042<ts::AES>::encrypt': unrefer
 
 template<class CIPHER>
 ts::DVS042<CIPHER>::DVS042() :
-    CipherChainingTemplate<CIPHER>(1, 1, 1),
+    CipherChainingTemplate<CIPHER>(1, 1, CipherChaining::PARALLEL_BLOCKS),
     shortIV(this->block_size)
 {
 }
@@ -134,9 +134,7 @@ bool ts::DVS042<CIPHER>::encryptImpl(const void* plain, size_t plain_length, voi
 
     while (plain_length >= this->block_size) {
         // work = previous-cipher XOR plain-text
-        for (size_t i = 0; i < this->block_size; ++i) {
-            this->work[i] = previous[i] ^ pt[i];
-        }
+        MemXor(this->work.data(), previous, pt, this->block_size);
         // cipher-text = encrypt (work)
         if (!this->algo->encrypt(this->work.data(), this->block_size, ct, this->block_size)) {
             return false;
@@ -188,25 +186,29 @@ bool ts::DVS042<CIPHER>::decryptImpl(const void* cipher, size_t cipher_length, v
     // Select IV depending on block size.
     const uint8_t* previous = cipher_length < this->block_size ? this->shortIV.data() : this->iv.data();
 
-    // Decrypt all blocks in CBC mode, except the last one if partial
+    // Decrypt all blocks in CBC mode, except the last one if partial.
+    // As in CBC mode, decrypt as many blocks as possible at once in the work buffer.
     const uint8_t* ct = reinterpret_cast<const uint8_t*>(cipher);
     uint8_t* pt = reinterpret_cast<uint8_t*>(plain);
+    const size_t work_blocks = this->work.size() / this->block_size;
 
     while (cipher_length >= this->block_size) {
-        // work = decrypt (cipher-text)
-        if (!this->algo->decrypt(ct, this->block_size, this->work.data(), this->block_size)) {
+        const size_t count = std::min(cipher_length / this->block_size, work_blocks);
+        const size_t size = count * this->block_size;
+        // work = decrypt (cipher-text blocks)
+        if (!this->algo->decryptBlocks(ct, this->work.data(), count)) {
             return false;
         }
-        // plain-text = previous-cipher XOR work
-        for (size_t i = 0; i < this->block_size; ++i) {
-            pt[i] = previous[i] ^ this->work[i];
-        }
-        // previous-cipher = cipher-text
-        previous = ct;
-        // advance one block
-        ct += this->block_size;
-        pt += this->block_size;
-        cipher_length -= this->block_size;
+        // first plain-text = previous-cipher XOR work
+        // next plain-texts = previous cipher-text XOR work
+        MemXor(pt, previous, this->work.data(), this->block_size);
+        MemXor(pt + this->block_size, ct, this->work.data() + this->block_size, size - this->block_size);
+        // previous-cipher = last cipher-text
+        previous = ct + size - this->block_size;
+        // advance all blocks
+        ct += size;
+        pt += size;
+        cipher_length -= size;
     }
 
     // Process final block if incomplete
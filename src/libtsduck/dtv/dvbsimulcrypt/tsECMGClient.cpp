@@ -41,6 +41,7 @@ TSDUCK_SOURCE;
 const size_t ts::ECMGClient::RECEIVER_STACK_SIZE;
 const size_t ts::ECMGClient::RESPONSE_QUEUE_SIZE;
 const ts::MilliSecond ts::ECMGClient::RESPONSE_TIMEOUT;
+const size_t ts::ECMGClient::MAX_LATENCY_SAMPLES;
 #endif
 
 
@@ -56,13 +57,30 @@ ts::ECMGClient::ECMGClient(size_t extra_handler_stack_size) :
     _connection(ecmgscs::Protocol::Instance(), true, 3),
     _channel_status(),
     _stream_status(),
+    _max_requests(0),
     _mutex(),
     _work_to_do(),
-    _async_requests(),
+    _request_done(),
+    _streams(),
+    _pending(),
+    _latencies(),
+    _latency_next(0),
+    _control_mutex(),
+    _control_pending(false),
     _response_queue(RESPONSE_QUEUE_SIZE)
 {
 }
 
+ts::ECMGClient::LatencyStatistics::LatencyStatistics() :
+    count(0),
+    min(0),
+    p50(0),
+    p90(0),
+    p99(0),
+    max(0)
+{
+}
+
 
 //----------------------------------------------------------------------------
 // Destructor
@@ -83,6 +101,7 @@ ts::ECMGClient::~ECMGClient()
         _state = DESTRUCTING;
         lock.signal();
     }
+    cancelAllRequests();
     waitForTermination();
 }
 
@@ -97,11 +116,14 @@ bool ts::ECMGClient::abortConnection(const UString& message)
         _logger.report().error(message);
     }
 
-    GuardCondition lock(_mutex, _work_to_do);
-    _state = DISCONNECTED;
-    _connection.disconnect(_logger.report());
-    _connection.close(_logger.report());
-    lock.signal();
+    {
+        GuardCondition lock(_mutex, _work_to_do);
+        _state = DISCONNECTED;
+        _connection.disconnect(_logger.report());
+        _connection.close(_logger.report());
+        lock.signal();
+    }
+    cancelAllRequests();
 
     _logger.setReport(NullReport::Instance());
     return false;
@@ -133,6 +155,11 @@ bool ts::ECMGClient::connect(const ECMGClientArgs& args,
         }
         _abort = abort;
         _logger = logger;
+        _max_requests = args.max_ecm_requests;
+        _streams.clear();
+        _pending.clear();
+        _latencies.clear();
+        _latency_next = 0;
     }
 
     // Perform TCP connection to ECMG server
@@ -172,67 +199,164 @@ bool ts::ECMGClient::connect(const ECMGClientArgs& args,
     assert(csp != nullptr);
     channel_status = _channel_status = *csp;
 
+    // Open the initial ECM stream
+    if (!openStream(args.ecm_stream_id, args.ecm_id, args.cp_duration, stream_status)) {
+        return abortConnection();
+    }
+    _stream_status = stream_status;
+
+    // ECM stream now established
+    {
+        Guard lock(_mutex);
+        _state = CONNECTED;
+    }
+
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Send a stream_setup and wait for the stream_status.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::openStream(uint16_t stream_id, uint16_t ecm_id, MilliSecond cp_duration, ecmgscs::StreamStatus& stream_status)
+{
     // Send a stream_setup message to ECMG
     ecmgscs::StreamSetup stream_setup;
-    stream_setup.channel_id = args.ecm_channel_id;
-    stream_setup.stream_id = args.ecm_stream_id;
-    stream_setup.ECM_id = args.ecm_id;
-    stream_setup.nominal_CP_duration = uint16_t(args.cp_duration / 100); // unit is 1/10 second
+    stream_setup.channel_id = _channel_status.channel_id;
+    stream_setup.stream_id = stream_id;
+    stream_setup.ECM_id = ecm_id;
+    stream_setup.nominal_CP_duration = uint16_t(cp_duration / 100); // unit is 1/10 second
+    setControlPending(true);
     if (!_connection.send(stream_setup, _logger)) {
-        return abortConnection();
+        setControlPending(false);
+        return false;
     }
 
     // Wait for a stream_status from the ECMG
-    if (!_response_queue.dequeue(msg, RESPONSE_TIMEOUT)) {
-        return abortConnection(u"ECMG stream_setup response timeout");
+    tlv::MessagePtr msg;
+    const bool received = _response_queue.dequeue(msg, RESPONSE_TIMEOUT);
+    setControlPending(false);
+    if (!received) {
+        _logger.report().error(u"ECMG stream_setup response timeout");
+        return false;
     }
     if (msg->tag() != ecmgscs::Tags::stream_status) {
-        return abortConnection(u"unexpected response from ECMG (expected stream_status):\n" + msg->dump(4));
+        _logger.report().error(u"unexpected response from ECMG (expected stream_status):\n" + msg->dump(4));
+        return false;
     }
     ecmgscs::StreamStatus* const ssp = dynamic_cast<ecmgscs::StreamStatus*>(msg.pointer());
     assert(ssp != nullptr);
-    stream_status = _stream_status = *ssp;
+    stream_status = *ssp;
 
-    // ECM stream now established
+    // Register the stream for automatic replies to stream_test.
+    Guard lock(_mutex);
+    _streams[stream_id] = stream_status;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Send a stream_close_request and wait for the stream_close_response.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::closeStream(uint16_t stream_id)
+{
+    // Politely send a stream_close_request and wait for a stream_close_response
+    ecmgscs::StreamCloseRequest req;
+    req.channel_id = _channel_status.channel_id;
+    req.stream_id = stream_id;
+    tlv::MessagePtr resp;
+    setControlPending(true);
+    const bool ok = _connection.send(req, _logger) &&
+        _response_queue.dequeue(resp, RESPONSE_TIMEOUT) &&
+        resp->tag() == ecmgscs::Tags::stream_close_response;
+    setControlPending(false);
+
+    // Forget the stream and its pending requests, they will never be answered.
+    Guard lock(_mutex);
+    _streams.erase(stream_id);
+    for (auto it = _pending.begin(); it != _pending.end(); ) {
+        if (uint16_t(it->first >> 16) == stream_id) {
+            it = dropRequest(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Open or close additional ECM streams.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::addStream(uint16_t stream_id, uint16_t ecm_id, MilliSecond cp_duration, ecmgscs::StreamStatus& stream_status)
+{
+    Guard control(_control_mutex);
     {
         Guard lock(_mutex);
-        _state = CONNECTED;
+        if (_state != CONNECTED) {
+            _logger.report().error(u"ECMG not connected");
+            return false;
+        }
+        if (_streams.find(stream_id) != _streams.end()) {
+            _logger.report().error(u"ECM stream id %d already open", {stream_id});
+            return false;
+        }
     }
+    return openStream(stream_id, ecm_id, cp_duration, stream_status);
+}
 
-    return true;
+bool ts::ECMGClient::removeStream(uint16_t stream_id)
+{
+    Guard control(_control_mutex);
+    {
+        Guard lock(_mutex);
+        if (_state != CONNECTED) {
+            _logger.report().error(u"ECMG not connected");
+            return false;
+        }
+        if (_streams.find(stream_id) == _streams.end()) {
+            _logger.report().error(u"ECM stream id %d not open", {stream_id});
+            return false;
+        }
+    }
+    return closeStream(stream_id);
 }
 
 
 //----------------------------------------------------------------------------
-// Disconnect from remote ECMG. Close stream and channel.
+// Disconnect from remote ECMG. Close all streams and channel.
 //----------------------------------------------------------------------------
 
 bool ts::ECMGClient::disconnect()
 {
+    Guard control(_control_mutex);
+
     // Mark disconnection in progress
     State previous_state;
+    std::vector<uint16_t> streams;
     {
         Guard lock(_mutex);
         previous_state = _state;
         if (_state == CONNECTING || _state == CONNECTED) {
             _state = DISCONNECTING;
         }
+        for (auto it = _streams.begin(); it != _streams.end(); ++it) {
+            streams.push_back(it->first);
+        }
     }
 
     // Disconnection sequence
     bool ok = previous_state == CONNECTED;
     if (ok) {
-        // Politely send a stream_close_request
-        ecmgscs::StreamCloseRequest req;
-        req.channel_id = _stream_status.channel_id;
-        req.stream_id = _stream_status.stream_id;
-        tlv::MessagePtr resp;
-        // Politely send a stream_close_request
-        // and wait for a stream_close_response
-        ok = _connection.send(req, _logger) &&
-            _response_queue.dequeue(resp, RESPONSE_TIMEOUT) &&
-            resp->tag() == ecmgscs::Tags::stream_close_response;
-        // If we get a polite reply, send a channel_close
+        // Politely close all streams
+        for (auto it = streams.begin(); ok && it != streams.end(); ++it) {
+            ok = closeStream(*it);
+        }
+        // If we get polite replies, send a channel_close
         if (ok) {
             ecmgscs::ChannelClose cc;
             cc.channel_id = _channel_status.channel_id;
@@ -241,13 +365,16 @@ bool ts::ECMGClient::disconnect()
     }
 
     // TCP disconnection
-    GuardCondition lock(_mutex, _work_to_do);
-    if (previous_state == CONNECTING || previous_state == CONNECTED) {
-        _state = DISCONNECTED;
-        ok = _connection.disconnect(_logger.report()) && ok;
-        ok = _connection.close(_logger.report()) && ok;
-        lock.signal();
+    {
+        GuardCondition lock(_mutex, _work_to_do);
+        if (previous_state == CONNECTING || previous_state == CONNECTED) {
+            _state = DISCONNECTED;
+            ok = _connection.disconnect(_logger.report()) && ok;
+            ok = _connection.close(_logger.report()) && ok;
+            lock.signal();
+        }
     }
+    cancelAllRequests();
 
     return ok;
 }
@@ -258,14 +385,15 @@ bool ts::ECMGClient::disconnect()
 //----------------------------------------------------------------------------
 
 void ts::ECMGClient::buildCWProvision(ecmgscs::CWProvision& msg,
+                                      uint16_t stream_id,
                                       uint16_t cp_number,
                                       const ByteBlock& current_cw,
                                       const ByteBlock& next_cw,
                                       const ByteBlock& ac,
                                       uint16_t cp_duration)
 {
-    msg.channel_id = _stream_status.channel_id;
-    msg.stream_id = _stream_status.stream_id;
+    msg.channel_id = _channel_status.channel_id;
+    msg.stream_id = stream_id;
     msg.CP_number = cp_number;
     msg.has_CW_encryption = false;
     msg.has_CP_duration = cp_duration != 0;
@@ -283,11 +411,110 @@ void ts::ECMGClient::buildCWProvision(ecmgscs::CWProvision& msg,
 }
 
 
+//----------------------------------------------------------------------------
+// Register an in-flight ECM request, waiting for a free slot if necessary.
+//----------------------------------------------------------------------------
+
+bool ts::ECMGClient::registerRequest(uint16_t stream_id, uint16_t cp_number, ECMGClientHandlerInterface* handler, Condition* waiting)
+{
+    GuardCondition lock(_mutex, _request_done);
+
+    const uint32_t key = RequestKey(stream_id, cp_number);
+    if (_pending.find(key) != _pending.end()) {
+        _logger.report().error(u"ECM request already in progress for stream id %d, CP number %d", {stream_id, cp_number});
+        return false;
+    }
+
+    // Wait for a free slot in the window of in-flight requests.
+    Monotonic limit(true);
+    limit += ecmTimeout() * NanoSecPerMilliSec;
+    for (;;) {
+        if (_state != CONNECTED) {
+            _logger.report().error(u"ECMG not connected");
+            return false;
+        }
+        // Lost responses shall not hold a slot forever.
+        const Monotonic now(true);
+        Monotonic next(limit);
+        expireRequests(now, next);
+        if (_max_requests == 0 || _pending.size() < _max_requests) {
+            break;
+        }
+        if (now >= limit) {
+            _logger.report().error(u"timeout waiting for a slot, %d ECM requests in progress", {_pending.size()});
+            return false;
+        }
+        lock.waitCondition(std::max<MilliSecond>(1, (next - now) / NanoSecPerMilliSec));
+    }
+
+    PendingRequest& req(_pending[key]);
+    req.handler = handler;
+    req.waiting = waiting;
+    req.sent.getSystemTime();
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Cancel in-flight ECM requests.
+//----------------------------------------------------------------------------
+
+void ts::ECMGClient::cancelRequest(uint16_t stream_id, uint16_t cp_number)
+{
+    Guard lock(_mutex);
+    const PendingRequests::iterator it = _pending.find(RequestKey(stream_id, cp_number));
+    if (it != _pending.end()) {
+        dropRequest(it);
+    }
+}
+
+ts::ECMGClient::PendingRequests::iterator ts::ECMGClient::dropRequest(PendingRequests::iterator it)
+{
+    if (it->second.waiting != nullptr) {
+        it->second.waiting->signal();
+    }
+    _request_done.signal();
+    return _pending.erase(it);
+}
+
+void ts::ECMGClient::expireRequests(const Monotonic& now, Monotonic& next)
+{
+    // Synchronous requests are expired by their own waiting thread.
+    const NanoSecond timeout = ecmTimeout() * NanoSecPerMilliSec;
+    for (auto it = _pending.begin(); it != _pending.end(); ) {
+        Monotonic expiration(it->second.sent);
+        expiration += timeout;
+        if (it->second.handler == nullptr) {
+            ++it;
+        }
+        else if (now >= expiration) {
+            _logger.report().error(u"ECM generation timeout for stream id %d, CP number %d", {uint16_t(it->first >> 16), uint16_t(it->first)});
+            it = dropRequest(it);
+        }
+        else {
+            if (expiration < next) {
+                next = expiration;
+            }
+            ++it;
+        }
+    }
+}
+
+void ts::ECMGClient::cancelAllRequests()
+{
+    Guard lock(_mutex);
+    while (!_pending.empty()) {
+        dropRequest(_pending.begin());
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Synchronously generate an ECM.
 //----------------------------------------------------------------------------
 
-bool ts::ECMGClient::generateECM(uint16_t cp_number,
+bool ts::ECMGClient::generateECM(uint16_t stream_id,
+                                 uint16_t cp_number,
                                  const ByteBlock& current_cw,
                                  const ByteBlock& next_cw,
                                  const ByteBlock& ac,
@@ -296,38 +523,90 @@ bool ts::ECMGClient::generateECM(uint16_t cp_number,
 {
     // Build a CW_provision message
     ecmgscs::CWProvision msg;
-    buildCWProvision(msg, cp_number, current_cw, next_cw, ac, cp_duration);
+    buildCWProvision(msg, stream_id, cp_number, current_cw, next_cw, ac, cp_duration);
 
-    // Send the CW_provision message
+    // Register a synchronous request (no handler) and send the CW_provision message
+    Condition response_ready;
+    if (!registerRequest(stream_id, cp_number, nullptr, &response_ready)) {
+        return false;
+    }
     if (!_connection.send(msg, _logger)) {
+        cancelRequest(stream_id, cp_number);
         return false;
     }
 
-    // Compute ECM generation timeout (very conservative)
-    const MilliSecond timeout = std::max(RESPONSE_TIMEOUT, 2 * MilliSecond(_channel_status.max_comp_time));
+    // Wait for the ECM response from the ECMG. The receiver thread stores it in our request.
+    // The shared response queue is not used, it is reserved to control exchanges.
+    UString error;
+    {
+        GuardCondition lock(_mutex, response_ready);
+        const uint32_t key = RequestKey(stream_id, cp_number);
+        Monotonic limit(true);
+        limit += ecmTimeout() * NanoSecPerMilliSec;
+        for (;;) {
+            const PendingRequests::iterator it = _pending.find(key);
+            if (it == _pending.end()) {
+                // Cancelled on disconnection or stream closing.
+                _logger.report().error(u"ECM request cancelled for stream id %d, CP number %d", {stream_id, cp_number});
+                return false;
+            }
+            if (it->second.done) {
+                ecm_response = it->second.response;
+                error = it->second.error;
+                dropRequest(it);
+                break;
+            }
+            const Monotonic now(true);
+            if (now >= limit) {
+                dropRequest(it);
+                _logger.report().error(u"ECM generation timeout");
+                return false;
+            }
+            lock.waitCondition(std::max<MilliSecond>(1, (limit - now) / NanoSecPerMilliSec));
+        }
+    }
 
-    // Wait for an ECM response from the ECMG
-    tlv::MessagePtr resp;
-    if (!_response_queue.dequeue(resp, timeout)) {
-        _logger.report().error(u"ECM generation timeout");
+    // Instead of an ECM_response, the ECMG may have sent a channel_error or stream_error.
+    if (!error.empty()) {
+        _logger.report().error(u"unexpected response to ECM request:\n%s", {error});
         return false;
     }
-    if (resp->tag() == ecmgscs::Tags::ECM_response) {
-        ecmgscs::ECMResponse* const ep = dynamic_cast <ecmgscs::ECMResponse*>(resp.pointer());
-        assert(ep != nullptr);
-        if (ep->CP_number == cp_number) {
-            // This is our ECM
-            ecm_response = *ep;
-            return true;
-        }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Deliver an error message to the synchronous requests it applies to.
+//----------------------------------------------------------------------------
+
+void ts::ECMGClient::setControlPending(bool pending)
+{
+    Guard lock(_mutex);
+    _control_pending = pending;
+}
+
+bool ts::ECMGClient::deliverError(const tlv::Message& msg, int stream_id)
+{
+    Guard lock(_mutex);
+
+    // During a control exchange, an error is the response to this exchange.
+    if (_control_pending) {
+        return false;
     }
 
-    // Unexpected response. Messages other than our ECM_response are channel_test
-    // and status_test. They are automatically handled in the reception thread.
-    // At this point, if we receive a message, this is an error or an truely
-    // unexpected message.
-    _logger.report().error(u"unexpected response to ECM request:\n%s", {resp->dump(4)});
-    return false;
+    // The errors do not contain the CP number: a stream_error fails all synchronous
+    // requests on this stream and a channel_error all synchronous requests. This is
+    // intentional, waiting for the ECM's of a failing stream or channel is pointless.
+    bool found = false;
+    for (auto it = _pending.begin(); it != _pending.end(); ++it) {
+        if (it->second.handler == nullptr && !it->second.done && (stream_id < 0 || int(it->first >> 16) == stream_id)) {
+            it->second.done = true;
+            it->second.error = msg.dump(4);
+            it->second.waiting->signal();
+            found = true;
+        }
+    }
+    return found;
 }
 
 
@@ -335,7 +614,8 @@ bool ts::ECMGClient::generateECM(uint16_t cp_number,
 // Asynchronously generate an ECM.
 //----------------------------------------------------------------------------
 
-bool ts::ECMGClient::submitECM(uint16_t cp_number,
+bool ts::ECMGClient::submitECM(uint16_t stream_id,
+                               uint16_t cp_number,
                                const ByteBlock& current_cw,
                                const ByteBlock& next_cw,
                                const ByteBlock& ac,
@@ -344,12 +624,11 @@ bool ts::ECMGClient::submitECM(uint16_t cp_number,
 {
     // Build a CW_provision message
     ecmgscs::CWProvision msg;
-    buildCWProvision(msg, cp_number, current_cw, next_cw, ac, cp_duration);
+    buildCWProvision(msg, stream_id, cp_number, current_cw, next_cw, ac, cp_duration);
 
-    // Register an asynchronous request
-    {
-        Guard lock(_mutex);
-        _async_requests.insert(std::make_pair(cp_number, ecm_handler));
+    // Register an asynchronous request, possibly waiting for a free slot
+    if (!registerRequest(stream_id, cp_number, ecm_handler, nullptr)) {
+        return false;
     }
 
     // Send the CW_provision message
@@ -357,14 +636,46 @@ bool ts::ECMGClient::submitECM(uint16_t cp_number,
 
     // Clear asynchronous request on error
     if (!ok) {
-        Guard lock(_mutex);
-        _async_requests.erase(cp_number);
+        cancelRequest(stream_id, cp_number);
     }
 
     return ok;
 }
 
 
+//----------------------------------------------------------------------------
+// Get the latency statistics of the ECM requests.
+//----------------------------------------------------------------------------
+
+void ts::ECMGClient::getLatencyStatistics(LatencyStatistics& stats) const
+{
+    std::vector<NanoSecond> lat;
+    {
+        Guard lock(_mutex);
+        lat = _latencies;
+    }
+
+    stats.compute(lat);
+}
+
+void ts::ECMGClient::LatencyStatistics::compute(std::vector<NanoSecond>& lat)
+{
+    *this = LatencyStatistics();
+    if (!lat.empty()) {
+        std::sort(lat.begin(), lat.end());
+        const size_t n = lat.size();
+        // Nearest-rank percentile.
+        auto percentile = [&lat, n](size_t p) { return lat[std::max<size_t>(1, (n * p + 99) / 100) - 1] / NanoSecPerMicroSec; };
+        count = n;
+        min = lat.front() / NanoSecPerMicroSec;
+        p50 = percentile(50);
+        p90 = percentile(90);
+        p99 = percentile(99);
+        max = lat.back() / NanoSecPerMicroSec;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Receiver thread main code
 //----------------------------------------------------------------------------
@@ -405,33 +716,72 @@ void ts::ECMGClient::main()
                     break;
                 }
                 case ecmgscs::Tags::stream_test: {
-                    // Automatic reply to stream_test
-                    ok = _connection.send(_stream_status, _logger);
+                    // Automatic reply to stream_test, using the status of the tested stream.
+                    ecmgscs::StreamTest* const test = dynamic_cast <ecmgscs::StreamTest*>(msg.pointer());
+                    assert(test != nullptr);
+                    ecmgscs::StreamStatus status(_stream_status);
+                    {
+                        Guard lock(_mutex);
+                        const StreamStatusMap::const_iterator it = _streams.find(test->stream_id);
+                        if (it != _streams.end()) {
+                            status = it->second;
+                        }
+                    }
+                    ok = _connection.send(status, _logger);
                     break;
                 }
                 case ecmgscs::Tags::ECM_response: {
-                    // Check if this is an asynchronous ECM response
+                    // Locate the corresponding request using the stream id and CP number.
                     ecmgscs::ECMResponse* const resp = dynamic_cast <ecmgscs::ECMResponse*>(msg.pointer());
                     assert(resp != nullptr);
                     ECMGClientHandlerInterface* handler = nullptr;
+                    bool found = false;
                     {
                         Guard lock(_mutex);
-                        AsyncRequests::iterator it = _async_requests.find(resp->CP_number);
-                        if (it != _async_requests.end()) {
-                            handler = it->second;
-                            _async_requests.erase(resp->CP_number);
+                        PendingRequests::iterator it = _pending.find(RequestKey(resp->stream_id, resp->CP_number));
+                        if (it != _pending.end() && !it->second.done) {
+                            // Record the latency of the request in the circular buffer.
+                            const NanoSecond latency = Monotonic(true) - it->second.sent;
+                            if (_latencies.size() < MAX_LATENCY_SAMPLES) {
+                                _latencies.push_back(latency);
+                            }
+                            else {
+                                _latencies[_latency_next] = latency;
+                                _latency_next = (_latency_next + 1) % MAX_LATENCY_SAMPLES;
+                            }
+                            found = true;
+                            handler = it->second.handler;
+                            if (handler == nullptr) {
+                                // Synchronous request -> deliver the response to the waiting application thread.
+                                it->second.done = true;
+                                it->second.response = *resp;
+                                it->second.waiting->signal();
+                            }
+                            else {
+                                dropRequest(it);
+                            }
                         }
                     }
-                    if (handler == nullptr) {
-                        // Not an asynchronous request -> enqueue response for application thread
-                        _response_queue.enqueue(msg);
+                    if (!found) {
+                        // Late response to an expired or cancelled request.
+                        _logger.report().debug(u"ignored ECM_response for stream id %d, CP number %d", {resp->stream_id, resp->CP_number});
                     }
-                    else {
+                    else if (handler != nullptr) {
                         // Pending request -> notify application
                         handler->handleECM(*resp);
                     }
                     break;
                 }
+                case ecmgscs::Tags::channel_error:
+                case ecmgscs::Tags::stream_error: {
+                    // Errors on ECM generation fail the corresponding synchronous requests.
+                    // Otherwise, this is the response to a control exchange.
+                    const ecmgscs::StreamError* const err = dynamic_cast <ecmgscs::StreamError*>(msg.pointer());
+                    if (!deliverError(*msg, err == nullptr ? -1 : int(err->stream_id))) {
+                        _response_queue.enqueue(msg);
+                    }
+                    break;
+                }
                 default: {
                     // Enqueue the message for application thread
                     _response_queue.enqueue(msg);
@@ -451,6 +801,10 @@ void ts::ECMGClient::main()
                 _connection.disconnect(NULLREP);
                 _connection.close(NULLREP);
             }
+            // Wake up application threads which wait for a response or a free request slot.
+            while (!_pending.empty()) {
+                dropRequest(_pending.begin());
+            }
         }
     }
 }
@@ -41,6 +41,7 @@
 #include "tstlvConnection.h"
 #include "tsMessageQueue.h"
 #include "tsCondition.h"
+#include "tsMonotonic.h"
 #include "tsMutex.h"
 #include "tsThread.h"
 
@@ -89,7 +90,27 @@ namespace ts {
                      const tlv::Logger& logger);
 
         //!
-        //! Synchronously generate an ECM.
+        //! Open an additional ECM stream on the channel of a connected ECMG.
+        //! The first ECM stream is opened by connect(). Additional ECM streams can be
+        //! used to simultaneously generate ECM's for several services or components.
+        //!
+        //! @param [in] stream_id ECM_stream_id of the new stream.
+        //! @param [in] ecm_id ECM_id of the new stream.
+        //! @param [in] cp_duration Nominal crypto-period duration in milliseconds.
+        //! @param [out] stream_status Response to stream_setup.
+        //! @return True on success, false on error.
+        //!
+        bool addStream(uint16_t stream_id, uint16_t ecm_id, MilliSecond cp_duration, ecmgscs::StreamStatus& stream_status);
+
+        //!
+        //! Close one ECM stream on the channel of a connected ECMG.
+        //! @param [in] stream_id ECM_stream_id of the stream to close.
+        //! @return True on success, false on error.
+        //!
+        bool removeStream(uint16_t stream_id);
+
+        //!
+        //! Synchronously generate an ECM on the initial ECM stream.
         //!
         //! @param [in] cp_number Current crypto-period number.
         //! @param [in] current_cw Control word for current crypto-period.
@@ -101,6 +122,33 @@ namespace ts {
         //! @return True on success, false on error.
         //!
         bool generateECM(uint16_t cp_number,
+                         const ByteBlock& current_cw,
+                         const ByteBlock& next_cw,
+                         const ByteBlock& ac,
+                         uint16_t cp_duration,
+                         ecmgscs::ECMResponse& response)
+        {
+            return generateECM(_stream_status.stream_id, cp_number, current_cw, next_cw, ac, cp_duration, response);
+        }
+
+        //!
+        //! Synchronously generate an ECM on a given ECM stream.
+        //!
+        //! Several application threads can simultaneously generate ECM's, on the same
+        //! or different ECM streams. Each response is delivered to its own request.
+        //!
+        //! @param [in] stream_id ECM_stream_id of the stream.
+        //! @param [in] cp_number Current crypto-period number.
+        //! @param [in] current_cw Control word for current crypto-period.
+        //! @param [in] next_cw Control word for next crypto-period.
+        //! If empty, the ECMG must work with CW_per_msg = 1.
+        //! @param [in] ac Access criteria, can be empty.
+        //! @param [in] cp_duration Crypto-period in 100 ms units, unspecified if zero.
+        //! @param [out] response Returned ECM.
+        //! @return True on success, false on error.
+        //!
+        bool generateECM(uint16_t stream_id,
+                         uint16_t cp_number,
                          const ByteBlock& current_cw,
                          const ByteBlock& next_cw,
                          const ByteBlock& ac,
@@ -108,7 +156,7 @@ namespace ts {
                          ecmgscs::ECMResponse& response);
 
         //!
-        //! Asynchronously generate an ECM.
+        //! Asynchronously generate an ECM on the initial ECM stream.
         //! Submit the ECM request and return immediately.
         //! The notification of the ECM generation or error is performed through the specified handler.
         //!
@@ -122,15 +170,88 @@ namespace ts {
         //! @return True on success, false on error.
         //!
         bool submitECM(uint16_t cp_number,
+                       const ByteBlock& current_cw,
+                       const ByteBlock& next_cw,
+                       const ByteBlock& ac,
+                       uint16_t cp_duration,
+                       ECMGClientHandlerInterface* handler)
+        {
+            return submitECM(_stream_status.stream_id, cp_number, current_cw, next_cw, ac, cp_duration, handler);
+        }
+
+        //!
+        //! Asynchronously generate an ECM on a given ECM stream.
+        //!
+        //! Submit the ECM request and return immediately. Several requests, on the same
+        //! or different ECM streams, can be in progress at the same time. Responses are
+        //! matched with requests using the ECM_stream_id and CP_number. When the maximum
+        //! number of in-flight requests (see ECMGClientArgs::max_ecm_requests) is reached,
+        //! this method waits for the completion of a previous request. Asynchronous requests
+        //! which are not answered within the ECM generation timeout are dropped and reported
+        //! as errors, so that a lost response does not hold a slot forever.
+        //!
+        //! @param [in] stream_id ECM_stream_id of the stream.
+        //! @param [in] cp_number Current crypto-period number.
+        //! @param [in] current_cw Control word for current crypto-period.
+        //! @param [in] next_cw Control word for next crypto-period.
+        //! If empty, the ECMG must work with CW_per_msg = 1.
+        //! @param [in] ac Access criteria, can be empty.
+        //! @param [in] cp_duration Crypto-period in 100 ms units, unspecified if zero.
+        //! @param [in] handler Object which will be notified of the returned ECM.
+        //! @return True on success, false on error.
+        //!
+        bool submitECM(uint16_t stream_id,
+                       uint16_t cp_number,
                        const ByteBlock& current_cw,
                        const ByteBlock& next_cw,
                        const ByteBlock& ac,
                        uint16_t cp_duration,
                        ECMGClientHandlerInterface* handler);
 
+        //!
+        //! Statistics on the latency of ECM generation.
+        //! The latency of an ECM request is the time between the CW_provision
+        //! and the corresponding ECM_response. All latencies are in microseconds.
+        //!
+        class TSDUCKDLL LatencyStatistics
+        {
+        public:
+            size_t      count;  //!< Number of ECM requests in the statistics.
+            MicroSecond min;    //!< Minimum latency.
+            MicroSecond p50;    //!< Median latency (50th percentile).
+            MicroSecond p90;    //!< 90th percentile latency.
+            MicroSecond p99;    //!< 99th percentile latency.
+            MicroSecond max;    //!< Maximum latency.
+
+            //!
+            //! Default constructor.
+            //!
+            LatencyStatistics();
+
+            //!
+            //! Compute the statistics from a set of latencies.
+            //! The percentiles use the nearest-rank method.
+            //! @param [in,out] latencies Latencies in nanoseconds, in any order. Sorted on return.
+            //!
+            void compute(std::vector<NanoSecond>& latencies);
+        };
+
+        //!
+        //! Get the latency statistics of the ECM requests.
+        //! The statistics are computed on the most recent requests only
+        //! (see MAX_LATENCY_SAMPLES).
+        //! @param [out] stats Latency statistics.
+        //!
+        void getLatencyStatistics(LatencyStatistics& stats) const;
+
+        //!
+        //! Maximum number of recent ECM requests which are used in latency statistics.
+        //!
+        static const size_t MAX_LATENCY_SAMPLES = 10000;
+
         //!
         //! Disconnect from remote ECMG.
-        //! Close stream and channel.
+        //! Close all streams and channel.
         //! @return True on success, false on error.
         //!
         bool disconnect();
@@ -161,8 +282,29 @@ namespace ts {
         // Timeout for responses from ECMG (except ECM generation)
         static const MilliSecond RESPONSE_TIMEOUT = 5000;
 
-        // List of asynchronous ECM requests: key=cp_number, value=handler
-        typedef std::map <uint16_t, ECMGClientHandlerInterface*> AsyncRequests;
+        // An in-flight ECM request. A null handler means a synchronous request.
+        // The response to a synchronous request is stored in the request, the
+        // waiting application thread is notified using its own condition.
+        // Since a condition wakes up one single thread, _request_done is used
+        // to wake up the threads which wait for a free slot only.
+        struct PendingRequest
+        {
+            ECMGClientHandlerInterface* handler;   // handler to notify
+            Condition*                  waiting;   // condition of the thread waiting for a synchronous request
+            Monotonic                   sent;      // time of CW_provision
+            bool                        done;      // a synchronous request is complete
+            ecmgscs::ECMResponse        response;  // ECM response to a synchronous request
+            UString                     error;     // error response to a synchronous request, if not empty
+            PendingRequest() : handler(nullptr), waiting(nullptr), sent(), done(false), response(), error() {}
+            PendingRequest(const PendingRequest&) = default;
+            PendingRequest& operator=(const PendingRequest&) = default;
+        };
+
+        // List of in-flight ECM requests: key=RequestKey(stream_id,cp_number)
+        typedef std::map <uint32_t, PendingRequest> PendingRequests;
+
+        // Open ECM streams: key=stream_id, value=response to stream_setup
+        typedef std::map <uint16_t, ecmgscs::StreamStatus> StreamStatusMap;
 
         // Private members
         State                   _state;
@@ -171,13 +313,65 @@ namespace ts {
         tlv::Connection <Mutex> _connection;     // connection with ECMG server
         ecmgscs::ChannelStatus  _channel_status; // initial response to channel_setup
         ecmgscs::StreamStatus   _stream_status;  // initial response to stream_setup
-        Mutex                   _mutex;          // exclusive access to protected fields
+        size_t                  _max_requests;   // max number of in-flight ECM requests
+        mutable Mutex           _mutex;          // exclusive access to protected fields
         Condition               _work_to_do;     // notify receiver thread to do some work
-        AsyncRequests           _async_requests;
+        Condition               _request_done;   // notify a free slot for a new ECM request
+        StreamStatusMap         _streams;        // all open ECM streams
+        PendingRequests         _pending;        // all in-flight ECM requests
+        std::vector<NanoSecond> _latencies;      // circular buffer of recent latencies
+        size_t                  _latency_next;   // next index to write in _latencies
+        Mutex                   _control_mutex;  // serialize control exchanges (stream setup and close)
+        bool                    _control_pending; // a control exchange waits for its response (protected by _mutex)
         MessageQueue <tlv::Message, NullMutex> _response_queue;
 
+        // Key of an ECM request in _pending.
+        static uint32_t RequestKey(uint16_t stream_id, uint16_t cp_number)
+        {
+            return (uint32_t(stream_id) << 16) | cp_number;
+        }
+
+        // Register an in-flight ECM request, waiting for a free slot if necessary.
+        // Either the handler (asynchronous request) or the condition of the waiting thread (synchronous request) is not null.
+        bool registerRequest(uint16_t stream_id, uint16_t cp_number, ECMGClientHandlerInterface* handler, Condition* waiting);
+
+        // Cancel an in-flight ECM request.
+        void cancelRequest(uint16_t stream_id, uint16_t cp_number);
+
+        // Drop the asynchronous requests which were not answered within ecmTimeout().
+        // Must be called with _mutex held. Update next with the next expiration time.
+        void expireRequests(const Monotonic& now, Monotonic& next);
+
+        // Deliver an error message to the synchronous requests it applies to: all requests
+        // on the stream or all streams if stream_id is negative. Return false if there is no
+        // such request or if a control exchange is in progress (the error is its response).
+        bool deliverError(const tlv::Message& msg, int stream_id);
+
+        // Declare the start or end of a control exchange.
+        void setControlPending(bool pending);
+
+        // Remove an in-flight ECM request, notify the thread which waits for it, if any,
+        // and one thread waiting for a free slot. Must be called with _mutex held.
+        PendingRequests::iterator dropRequest(PendingRequests::iterator it);
+
+        // Cancel all in-flight ECM requests.
+        void cancelAllRequests();
+
+        // Timeout for ECM generation (very conservative).
+        MilliSecond ecmTimeout() const
+        {
+            return std::max(RESPONSE_TIMEOUT, 2 * MilliSecond(_channel_status.max_comp_time));
+        }
+
+        // Open one ECM stream, send stream_setup and wait for stream_status.
+        bool openStream(uint16_t stream_id, uint16_t ecm_id, MilliSecond cp_duration, ecmgscs::StreamStatus& stream_status);
+
+        // Close one ECM stream, send stream_close_request and wait for stream_close_response.
+        bool closeStream(uint16_t stream_id);
+
         // Build a CW_provision message.
         void buildCWProvision(ecmgscs::CWProvision& msg,
+                              uint16_t stream_id,
                               uint16_t cp_number,
                               const ByteBlock& current_cw,
                               const ByteBlock& next_cw,
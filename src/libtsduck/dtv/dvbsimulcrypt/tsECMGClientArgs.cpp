@@ -31,6 +31,10 @@
 #include "tsArgs.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::ECMGClientArgs::DEFAULT_MAX_ECM_REQUESTS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -46,7 +50,8 @@ ts::ECMGClientArgs::ECMGClientArgs() :
     ecm_stream_id(0),
     ecm_id(0),
     log_protocol(0),
-    log_data(0)
+    log_data(0),
+    max_ecm_requests(DEFAULT_MAX_ECM_REQUESTS)
 {
 }
 
@@ -92,6 +97,13 @@ void ts::ECMGClientArgs::defineArgs(Args& args) const
          u"option is present without value, the messages are logged at info level. "
          u"A level can be a numerical debug level or a name.");
 
+    args.option(u"max-ecm-requests", 0, Args::POSITIVE);
+    args.help(u"max-ecm-requests",
+         u"Maximum number of asynchronous ECM requests which can be simultaneously in progress "
+         u"with the ECMG, ie. CW_provision messages which have been sent without receiving the "
+         u"corresponding ECM_response yet. When the limit is reached, a new request waits for the "
+         u"completion of a previous one. The default is " + UString::Decimal(DEFAULT_MAX_ECM_REQUESTS) + u".");
+
     args.option(u"stream-id", 0, Args::UINT16);
     args.help(u"stream-id", u"Specifies the DVB SimulCrypt ECM_stream_id for the ECMG (default: 1).");
 
@@ -115,6 +127,7 @@ bool ts::ECMGClientArgs::loadArgs(DuckContext& duck, Args& args)
     log_protocol = args.present(u"log-protocol") ? args.intValue<int>(u"log-protocol", ts::Severity::Info) : ts::Severity::Debug;
     log_data = args.present(u"log-data") ? args.intValue<int>(u"log-data", ts::Severity::Info) : log_protocol;
     dvbsim_version = args.intValue<tlv::VERSION>(u"ecmg-scs-version", 2);
+    max_ecm_requests = args.intValue<size_t>(u"max-ecm-requests", DEFAULT_MAX_ECM_REQUESTS);
 
     // Decode access criteria.
     if (!args.value(u"access-criteria").hexaDecode(access_criteria)) {
@@ -52,6 +52,11 @@ namespace ts {
         //!
         ECMGClientArgs();
 
+        //!
+        //! Default maximum number of simultaneous asynchronous ECM requests.
+        //!
+        static const size_t DEFAULT_MAX_ECM_REQUESTS = 16;
+
         // Public fields, by options.
         SocketAddress ecmg_address;     //!< -\-ecmg, ECMG socket address (required or optional)
         uint32_t      super_cas_id;     //!< -\-super-cas-id, CA system & subsystem id
@@ -63,6 +68,7 @@ namespace ts {
         uint16_t      ecm_id;           //!< -\-ecm-id
         int           log_protocol;     //!< -\-log-protocol
         int           log_data;         //!< -\-log-data
+        size_t        max_ecm_requests; //!< -\-max-ecm-requests, max number of in-flight asynchronous ECM requests
 
         // Implementation of ArgsSupplierInterface.
         virtual void defineArgs(Args& args) const override;
@@ -46,6 +46,8 @@
 #include "tsForkPacketPlugin.h"
 #include "tsIPInputPlugin.h"
 #include "tsIPOutputPlugin.h"
+#include "tsSharedMemoryInputPlugin.h"
+#include "tsSharedMemoryOutputPlugin.h"
 #include "tsDektecInputPlugin.h"
 #include "tsDektecOutputPlugin.h"
 #include "tshlsInputPlugin.h"
@@ -93,6 +95,8 @@ ts::StaticReferencesDVB::StaticReferencesDVB() :
     REF_OBJECT(ForkPacketPlugin::REFERENCE);
     REF_OBJECT(IPInputPlugin::REFERENCE);
     REF_OBJECT(IPOutputPlugin::REFERENCE);
+    REF_OBJECT(SharedMemoryInputPlugin::REFERENCE);
+    REF_OBJECT(SharedMemoryOutputPlugin::REFERENCE);
     REF_OBJECT(DektecInputPlugin::REFERENCE);
     REF_OBJECT(DektecOutputPlugin::REFERENCE);
     REF_OBJECT(hls::InputPlugin::REFERENCE);
@@ -256,6 +256,26 @@ void ts::BinaryTable::setVersion(uint8_t version, bool recompute_crc)
     }
 }
 
+void ts::BinaryTable::patchTableIdExtension(uint16_t tid_ext)
+{
+    _tid_ext = tid_ext;
+    for (SectionPtrVector::iterator it = _sections.begin(); it != _sections.end(); ++it) {
+        if (!it->isNull() && (*it)->isLongSection()) {
+            (*it)->patchUInt16(3, tid_ext);
+        }
+    }
+}
+
+void ts::BinaryTable::patchVersion(uint8_t version)
+{
+    _version = version;
+    for (SectionPtrVector::iterator it = _sections.begin(); it != _sections.end(); ++it) {
+        if (!it->isNull() && (*it)->isLongSection()) {
+            (*it)->patchUInt8(5, uint8_t(((*it)->content()[5] & 0xC1) | ((version & 0x1F) << 1)));
+        }
+    }
+}
+
 void ts::BinaryTable::setSourcePID(PID pid)
 {
     _source_pid = pid;
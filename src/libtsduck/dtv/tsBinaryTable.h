@@ -243,6 +243,24 @@ namespace ts {
         //!
         void setVersion(uint8_t version, bool recompute_crc = true);
 
+        //!
+        //! Set the table id extension of all sections with an incremental update of the CRC32's.
+        //! The CRC32's of the sections must be valid before the call. This is faster than
+        //! setTableIdExtension() on large sections.
+        //! @param [in] tid_ext The new table id extension.
+        //! @see Section::patchBytes()
+        //!
+        void patchTableIdExtension(uint16_t tid_ext);
+
+        //!
+        //! Set the table version number of all sections with an incremental update of the CRC32's.
+        //! The CRC32's of the sections must be valid before the call. This is faster than
+        //! setVersion() on large sections.
+        //! @param [in] version The new table version number.
+        //! @see Section::patchBytes()
+        //!
+        void patchVersion(uint8_t version);
+
         //!
         //! Set the source PID of all sections in the table.
         //! @param [in] pid The new source PID.
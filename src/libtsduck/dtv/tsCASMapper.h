@@ -78,6 +78,17 @@ namespace ts {
             _demux.setCurrentNext(current, next);
         }
 
+        //!
+        //! Use a pool of recycled sections in the internal section demux.
+        //! @param [in] pool Address of a section pool or zero to allocate all sections.
+        //! The pool shall remain valid as long as it is used by this object.
+        //! @see SectionDemux::setSectionPool()
+        //!
+        void setSectionPool(SectionPool* pool)
+        {
+            _demux.setSectionPool(pool);
+        }
+
         //!
         //! Check if a PID is a known CA PID.
         //! @param [in] pid A PID to check.
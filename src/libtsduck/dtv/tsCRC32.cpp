@@ -32,8 +32,25 @@
 //----------------------------------------------------------------------------
 
 #include "tsCRC32.h"
+#include "tsSysInfo.h"
+#include "tsMemory.h"
 TSDUCK_SOURCE;
 
+// Carry-less multiplication is implemented on Intel CPU with GCC, clang and MSVC.
+// With GCC and clang, the function is compiled for SSSE3 and PCLMULQDQ without
+// requiring the same options for the rest of the code.
+#if (defined(TS_I386) || defined(TS_X86_64)) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_CRC32_CLMUL 1
+    #include <emmintrin.h>
+    #include <tmmintrin.h>
+    #include <wmmintrin.h>
+    #if defined(TS_GCC)
+        #define TS_CRC32_CLMUL_TARGET __attribute__((target("ssse3,pclmul")))
+    #else
+        #define TS_CRC32_CLMUL_TARGET
+    #endif
+#endif
+
 
 // The FCS-32 generator polynomial:
 //     x**0 + x**1 + x**2 + x**4 + x**5 +
@@ -41,6 +58,8 @@ TSDUCK_SOURCE;
 //     x**22 + x**23 + x**26 + x**32.
 
 namespace {
+    const uint32_t FCS_POLY = 0x04C11DB7;
+
     const uint32_t fcstab_32 [256] = {
         0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9,
         0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
@@ -107,15 +126,301 @@ namespace {
         0xAFB010B1, 0xAB710D06, 0xA6322BDF, 0xA2F33668,
         0xBCB4666D, 0xB8757BDA, 0xB5365D03, 0xB1F740B4
     };
+
+    // Tables for the slicing-by-8 algorithm. The first one is fcstab_32.
+    // The table N gives the CRC contribution of a byte followed by N zero bytes.
+    class SliceTables
+    {
+        TS_NOCOPY(SliceTables);
+    public:
+        uint32_t t[8][256];
+        SliceTables()
+        {
+            for (size_t b = 0; b < 256; ++b) {
+                t[0][b] = fcstab_32[b];
+            }
+            for (size_t n = 1; n < 8; ++n) {
+                for (size_t b = 0; b < 256; ++b) {
+                    t[n][b] = (t[n-1][b] << 8) ^ fcstab_32[t[n-1][b] >> 24];
+                }
+            }
+        }
+        static const SliceTables& Instance()
+        {
+            static const SliceTables instance;
+            return instance;
+        }
+    };
+
+    // Compute x**n modulo the FCS-32 generator polynomial.
+    uint32_t PowerModPoly(size_t n)
+    {
+        uint32_t r = 1;
+        while (n-- > 0) {
+            r = (r & 0x80000000) == 0 ? (r << 1) : ((r << 1) ^ FCS_POLY);
+        }
+        return r;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Selection of the algorithm.
+//----------------------------------------------------------------------------
+
+// Current algorithm, an atomic pointer since all algorithms give the same results.
+std::atomic<ts::CRC32::AddFunction>& ts::CRC32::CurrentFunction()
+{
+    static std::atomic<AddFunction> add(GetFunction(AUTO));
+    return add;
+}
+
+bool ts::CRC32::IsSupported(Algorithm algo)
+{
+    switch (algo) {
+        case AUTO:
+        case BYTEWISE:
+        case SLICE8:
+            return true;
+        case CLMUL:
+#if defined(TS_CRC32_CLMUL)
+            return SysInfo::Instance()->cpuHasSSSE3() && SysInfo::Instance()->cpuHasPCLMULQDQ();
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+ts::CRC32::AddFunction ts::CRC32::GetFunction(Algorithm algo)
+{
+    switch (algo) {
+        case BYTEWISE:
+            return AddBytewise;
+        case SLICE8:
+            return AddSlice8;
+        case CLMUL:
+            return AddCLMUL;
+        case AUTO:
+        default:
+            return IsSupported(CLMUL) ? AddCLMUL : AddSlice8;
+    }
+}
+
+bool ts::CRC32::SetAlgorithm(Algorithm algo)
+{
+    if (!IsSupported(algo)) {
+        return false;
+    }
+    else {
+        CurrentFunction().store(GetFunction(algo));
+        return true;
+    }
+}
+
+ts::CRC32::Algorithm ts::CRC32::GetAlgorithm()
+{
+    const AddFunction add = CurrentFunction().load();
+    return add == AddBytewise ? BYTEWISE : (add == AddCLMUL ? CLMUL : SLICE8);
 }
 
+
+//----------------------------------------------------------------------------
 // Continue the computation of a data area, following a previous CRC32
+//----------------------------------------------------------------------------
 
-void ts::CRC32::add (const void* data, size_t size)
+void ts::CRC32::add(const void* data, size_t size)
 {
-    const uint8_t* cp = static_cast <const uint8_t*> (data);
+    _fcs = CurrentFunction().load(std::memory_order_relaxed)(_fcs, static_cast<const uint8_t*>(data), size);
+}
+
+
+//----------------------------------------------------------------------------
+// Update the CRC32 of a data area after modification of some bytes.
+//----------------------------------------------------------------------------
+
+namespace {
+    // Multiply two polynomials modulo the generator polynomial.
+    uint32_t MultModPoly(uint32_t a, uint32_t b)
+    {
+        uint32_t r = 0;
+        for (uint32_t bit = 0x80000000; bit != 0; bit >>= 1) {
+            r = (r << 1) ^ ((r & 0x80000000) != 0 ? FCS_POLY : 0);
+            if ((b & bit) != 0) {
+                r ^= a;
+            }
+        }
+        return r;
+    }
+}
+
+uint32_t ts::CRC32::Update(uint32_t crc, size_t total_size, size_t offset, const void* old_data, const void* new_data, size_t size)
+{
+    // The CRC32 is an affine function of the data for a given size. Therefore, the
+    // difference between the old and new CRC32 is the CRC32 (with zero initial value)
+    // of the difference between the old and new data, that is to say the CRC32 of the
+    // modified bytes, followed by zeroes. The leading zeroes do not change a zero CRC.
+    if (offset + size > total_size || size == 0) {
+        return crc;
+    }
+    const uint8_t* op = static_cast<const uint8_t*>(old_data);
+    const uint8_t* np = static_cast<const uint8_t*>(new_data);
+    uint32_t diff = 0;
+    for (size_t i = 0; i < size; ++i) {
+        diff = (diff << 8) ^ fcstab_32[((diff >> 24) ^ op[i] ^ np[i]) & 0xFF];
+    }
+
+    // Processing N trailing zero bytes is a multiplication by x^(8*N) modulo the
+    // generator polynomial. Compute it by successive squares of x^8 (0x100).
+    uint32_t power = 0x00000100;
+    for (size_t trailing = total_size - offset - size; trailing != 0 && diff != 0; trailing >>= 1) {
+        if ((trailing & 1) != 0) {
+            diff = MultModPoly(diff, power);
+        }
+        power = MultModPoly(power, power);
+    }
+    return crc ^ diff;
+}
+
+
+//----------------------------------------------------------------------------
+// Original algorithm: one byte at a time.
+//----------------------------------------------------------------------------
 
+uint32_t ts::CRC32::AddBytewise(uint32_t fcs, const uint8_t* cp, size_t size)
+{
     while (size-- > 0) {
-        _fcs = (_fcs << 8) ^ fcstab_32 [((_fcs >> 24) ^ (*cp++)) & 0xFF];
+        fcs = (fcs << 8) ^ fcstab_32[((fcs >> 24) ^ (*cp++)) & 0xFF];
+    }
+    return fcs;
+}
+
+
+//----------------------------------------------------------------------------
+// Slicing-by-8 algorithm: 8 bytes at a time.
+//----------------------------------------------------------------------------
+
+uint32_t ts::CRC32::AddSlice8(uint32_t fcs, const uint8_t* cp, size_t size)
+{
+    const SliceTables& tab(SliceTables::Instance());
+
+    while (size >= 8) {
+        const uint32_t x = fcs ^ GetUInt32BE(cp);
+        const uint32_t y = GetUInt32BE(cp + 4);
+        fcs = tab.t[7][x >> 24] ^ tab.t[6][(x >> 16) & 0xFF] ^ tab.t[5][(x >> 8) & 0xFF] ^ tab.t[4][x & 0xFF] ^
+              tab.t[3][y >> 24] ^ tab.t[2][(y >> 16) & 0xFF] ^ tab.t[1][(y >> 8) & 0xFF] ^ tab.t[0][y & 0xFF];
+        cp += 8;
+        size -= 8;
+    }
+    return AddBytewise(fcs, cp, size);
+}
+
+
+//----------------------------------------------------------------------------
+// Carry-less multiplication algorithm: fold 64 bytes at a time.
+//
+// The data are seen as a polynomial, the first bit being the highest degree.
+// The CRC of a message M, with the initial value xored in its first 4 bytes,
+// is M.x**32 mod P. Each 16-byte block is loaded as a big-endian 128-bit
+// polynomial. Four accumulators A are used in parallel. For each new block B,
+// A = A.x**512 + B, computed as the two 64-bit halves of A multiplied by the
+// 32-bit constants x**576 mod P and x**512 mod P. The four accumulators are
+// then folded into one (same method, constants x**192 mod P and x**128 mod P).
+// Finally, the 128-bit accumulator A is a 16-byte message with the same CRC
+// as the processed data. Its CRC and the CRC of the remaining bytes are computed
+// using the slicing-by-8 algorithm.
+//----------------------------------------------------------------------------
+
+#if defined(TS_CRC32_CLMUL)
+
+namespace {
+    // Folding constants, low 64 bits for the low half of A, high 64 bits for the high half.
+    class FoldConstants
+    {
+        TS_NOCOPY(FoldConstants);
+    public:
+        uint64_t k128[2];  // Fold 128 bits: x**128 mod P, x**192 mod P
+        uint64_t k512[2];  // Fold 512 bits: x**512 mod P, x**576 mod P
+        FoldConstants()
+        {
+            k128[0] = PowerModPoly(128);
+            k128[1] = PowerModPoly(192);
+            k512[0] = PowerModPoly(512);
+            k512[1] = PowerModPoly(576);
+        }
+        static const FoldConstants& Instance()
+        {
+            static const FoldConstants instance;
+            return instance;
+        }
+    };
+
+    // Load 16 bytes as a big-endian 128-bit polynomial.
+    TS_CRC32_CLMUL_TARGET inline __m128i LoadBE(const uint8_t* p, __m128i swap)
+    {
+        return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), swap);
+    }
+
+    // Fold A into A.x**N + B, N being defined by the constants k.
+    TS_CRC32_CLMUL_TARGET inline __m128i Fold(__m128i a, __m128i k, __m128i b)
+    {
+        return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(a, k, 0x00), _mm_clmulepi64_si128(a, k, 0x11)), b);
     }
 }
+
+TS_CRC32_CLMUL_TARGET uint32_t ts::CRC32::AddCLMUL(uint32_t fcs, const uint8_t* cp, size_t size)
+{
+    // Not worth the setup for short data.
+    if (size < 128) {
+        return AddSlice8(fcs, cp, size);
+    }
+
+    const FoldConstants& fc(FoldConstants::Instance());
+    const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k128 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fc.k128));
+    const __m128i k512 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fc.k512));
+
+    // Load the first 64 bytes, xor the current CRC value in the first 4 bytes.
+    __m128i a0 = _mm_xor_si128(LoadBE(cp, swap), _mm_set_epi32(int(fcs), 0, 0, 0));
+    __m128i a1 = LoadBE(cp + 16, swap);
+    __m128i a2 = LoadBE(cp + 32, swap);
+    __m128i a3 = LoadBE(cp + 48, swap);
+    cp += 64;
+    size -= 64;
+
+    // Fold 64 bytes at a time.
+    while (size >= 64) {
+        a0 = Fold(a0, k512, LoadBE(cp, swap));
+        a1 = Fold(a1, k512, LoadBE(cp + 16, swap));
+        a2 = Fold(a2, k512, LoadBE(cp + 32, swap));
+        a3 = Fold(a3, k512, LoadBE(cp + 48, swap));
+        cp += 64;
+        size -= 64;
+    }
+
+    // Fold the four accumulators into one, then remaining 16-byte blocks.
+    a0 = Fold(a0, k128, a1);
+    a0 = Fold(a0, k128, a2);
+    a0 = Fold(a0, k128, a3);
+    while (size >= 16) {
+        a0 = Fold(a0, k128, LoadBE(cp, swap));
+        cp += 16;
+        size -= 16;
+    }
+
+    // The accumulator is a 16-byte message with the same CRC, using zero as initial value.
+    uint8_t acc[16];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc), _mm_shuffle_epi8(a0, swap));
+    return AddSlice8(AddSlice8(0, acc, sizeof(acc)), cp, size);
+}
+
+#else
+
+uint32_t ts::CRC32::AddCLMUL(uint32_t fcs, const uint8_t* cp, size_t size)
+{
+    // Not supported on this platform, never selected.
+    return AddSlice8(fcs, cp, size);
+}
+
+#endif
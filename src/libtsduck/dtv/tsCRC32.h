@@ -36,15 +36,67 @@
 
 #pragma once
 #include "tsPlatform.h"
+#include <atomic>
 
 namespace ts {
     //!
     //! Cyclic Redundancy Check as used in MPEG sections.
     //! @ingroup mpeg
     //!
+    //! Several algorithms are available to compute the CRC32. They all produce
+    //! the same result. By default, the fastest algorithm on the current CPU is
+    //! selected at run time.
+    //!
     class TSDUCKDLL CRC32
     {
     public:
+        //!
+        //! Algorithms to compute a CRC32.
+        //!
+        enum Algorithm {
+            AUTO,      //!< Select the fastest algorithm on the current CPU.
+            BYTEWISE,  //!< Process one byte at a time using a 256-entry table.
+            SLICE8,    //!< Portable "slicing-by-8" algorithm, 8 bytes at a time using eight 256-entry tables.
+            CLMUL,     //!< Folding using carry-less multiplication (Intel PCLMULQDQ instruction).
+        };
+
+        //!
+        //! Check if an algorithm is supported on the current CPU.
+        //! @param [in] algo The algorithm to check.
+        //! @return True if @a algo is supported.
+        //!
+        static bool IsSupported(Algorithm algo);
+
+        //!
+        //! Set the algorithm which is used by all instances of CRC32.
+        //! This is typically useful for testing or benchmarking.
+        //! It can be called while other threads compute CRC32's since all algorithms
+        //! give the same results.
+        //! @param [in] algo The algorithm to use. Use AUTO to restore the default.
+        //! @return True on success, false if @a algo is not supported on this CPU.
+        //!
+        static bool SetAlgorithm(Algorithm algo);
+
+        //!
+        //! Get the algorithm which is used by all instances of CRC32.
+        //! @return The current algorithm, never AUTO.
+        //!
+        static Algorithm GetAlgorithm();
+
+        //!
+        //! Compute the CRC32 of a data area after the modification of some bytes.
+        //! The new CRC32 is computed from the previous CRC32 of the complete data area
+        //! and the modified bytes only. The rest of the data area is not needed.
+        //! @param [in] crc The CRC32 of the complete data area before modification.
+        //! @param [in] total_size Total size in bytes of the data area.
+        //! @param [in] offset Offset in the data area of the modified bytes.
+        //! @param [in] old_data Address of the previous value of the modified bytes.
+        //! @param [in] new_data Address of the new value of the modified bytes.
+        //! @param [in] size Number of modified bytes.
+        //! @return The CRC32 of the complete modified data area.
+        //!
+        static uint32_t Update(uint32_t crc, size_t total_size, size_t offset, const void* old_data, const void* new_data, size_t size);
+
         //!
         //! Default constructor.
         //!
@@ -144,6 +196,16 @@ namespace ts {
 
     private:
         uint32_t _fcs;
+
+        // Implementations of the various algorithms.
+        typedef uint32_t (*AddFunction)(uint32_t fcs, const uint8_t* data, size_t size);
+        static uint32_t AddBytewise(uint32_t fcs, const uint8_t* data, size_t size);
+        static uint32_t AddSlice8(uint32_t fcs, const uint8_t* data, size_t size);
+        static uint32_t AddCLMUL(uint32_t fcs, const uint8_t* data, size_t size);
+        static AddFunction GetFunction(Algorithm algo);
+
+        // Current implementation, selected once on first use in a thread-safe way.
+        static std::atomic<AddFunction>& CurrentFunction();
     };
 
     //!
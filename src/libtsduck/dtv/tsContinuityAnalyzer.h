@@ -36,6 +36,7 @@
 #include "tsMPEG.h"
 #include "tsTSPacket.h"
 #include "tsReport.h"
+#include "tsPIDIndexedMap.h"
 
 namespace ts {
     //!
@@ -254,7 +255,7 @@ namespace ts {
         };
 
         // A map of PID state, indexed by PID.
-        typedef std::map<PID,PIDState> PIDStateMap;
+        typedef PIDIndexedMap<PIDState> PIDStateMap;
 
         // Private members.
         Report*       _report;            // Where to report errors, never null.
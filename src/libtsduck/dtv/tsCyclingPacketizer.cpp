@@ -47,10 +47,15 @@ ts::CyclingPacketizer::CyclingPacketizer(const DuckContext& duck, PID pid, Stuff
     _section_count(0),
     _sched_sections(),
     _other_sections(),
+    _free_sections(),
     _sched_packets(0),
     _current_cycle(1),
     _remain_in_cycle(0),
-    _cycle_end(UNDEFINED)
+    _cycle_end(UNDEFINED),
+    _cache_enabled(true),
+    _cache_state(CACHE_EMPTY),
+    _cache(),
+    _cache_next(0)
 {
 }
 
@@ -67,6 +72,16 @@ ts::CyclingPacketizer::SectionDesc::SectionDesc(const SectionPtr& sec, MilliSeco
 {
 }
 
+// Reinitialize a recycled section descriptor.
+void ts::CyclingPacketizer::SectionDesc::reset(const SectionPtr& sec, MilliSecond rep)
+{
+    section = sec;
+    repetition = rep;
+    last_packet = 0;
+    due_packet = 0;
+    last_cycle = 0;
+}
+
 
 //----------------------------------------------------------------------------
 // Add sections into the packetizer.
@@ -145,21 +160,34 @@ bool ts::CyclingPacketizer::SectionDesc::insertAfter(const SectionDesc& other) c
 
 
 //----------------------------------------------------------------------------
-// Insert a scheduled section in the list, sorted by due_packet.
+// Find the position of a scheduled section in the list, sorted by due_packet.
 //----------------------------------------------------------------------------
 
-void ts::CyclingPacketizer::addScheduledSection(const SectionDescPtr& sect)
+ts::CyclingPacketizer::SectionDescList::iterator ts::CyclingPacketizer::schedulePosition(const SectionDesc& sect, SectionDescList::iterator start)
 {
     report().log(2, u"schedule section: PID 0x%X, TID 0x%X, TIDext 0x%X, section %d/%d, cycle: %'d, packet: %'d, due packet: %'d",
-                 {getPID(), sect->section->tableId(), sect->section->tableIdExtension(),
-                  sect->section->sectionNumber(), sect->section->lastSectionNumber(),
-                  sect->last_cycle, sect->last_packet, sect->due_packet});
+                 {getPID(), sect.section->tableId(), sect.section->tableIdExtension(),
+                  sect.section->sectionNumber(), sect.section->lastSectionNumber(),
+                  sect.last_cycle, sect.last_packet, sect.due_packet});
+
+    while (start != _sched_sections.end() && sect.insertAfter(**start)) {
+        ++start;
+    }
+    return start;
+}
+
+
+//----------------------------------------------------------------------------
+// Move a section descriptor into the list of released descriptors.
+// The list node and the descriptor are reused by the next addSection().
+//----------------------------------------------------------------------------
 
-    auto it = _sched_sections.begin();
-    while (it != _sched_sections.end() && sect->insertAfter(**it)) {
-        ++it;
+void ts::CyclingPacketizer::releaseSections(SectionDescList& list, SectionDescList::iterator first, SectionDescList::iterator last)
+{
+    for (auto it = first; it != last; ++it) {
+        (*it)->section.clear();
     }
-    _sched_sections.insert(it, sect);
+    _free_sections.splice(_free_sections.end(), list, first, last);
 }
 
 
@@ -169,16 +197,25 @@ void ts::CyclingPacketizer::addScheduledSection(const SectionDescPtr& sect)
 
 void ts::CyclingPacketizer::addSection(const SectionPtr& sect, MilliSecond rep_rate)
 {
-    SectionDescPtr desc(new SectionDesc(sect, rep_rate));
+    invalidateCache();
+
+    // Reuse a previously released section descriptor and its list node when possible.
+    if (_free_sections.empty()) {
+        _free_sections.push_back(SectionDescPtr(new SectionDesc(sect, rep_rate)));
+    }
+    else {
+        _free_sections.front()->reset(sect, rep_rate);
+    }
+    const SectionDescList::iterator desc(_free_sections.begin());
 
     if (rep_rate == 0 || _bitrate == 0) {
         // Unschedule section, simply add it at end of queue
-        _other_sections.push_back(desc);
+        _other_sections.splice(_other_sections.end(), _free_sections, desc);
     }
     else {
         // Scheduled section, its due time is "now"
-        desc->due_packet = packetCount();
-        addScheduledSection(desc);
+        (*desc)->due_packet = packetCount();
+        _sched_sections.splice(schedulePosition(**desc, _sched_sections.begin()), _free_sections, desc);
         _sched_packets += sect->packetCount();
     }
 
@@ -193,6 +230,7 @@ void ts::CyclingPacketizer::addSection(const SectionPtr& sect, MilliSecond rep_r
 
 void ts::CyclingPacketizer::removeSections(TID tid)
 {
+    invalidateCache();
     removeSections(_sched_sections, tid, 0, false, true);
     removeSections(_other_sections, tid, 0, false, false);
 }
@@ -204,6 +242,7 @@ void ts::CyclingPacketizer::removeSections(TID tid)
 
 void ts::CyclingPacketizer::removeSections(TID tid, uint16_t tid_ext)
 {
+    invalidateCache();
     removeSections(_sched_sections, tid, tid_ext, true, true);
     removeSections(_other_sections, tid, tid_ext, true, false);
 }
@@ -231,7 +270,9 @@ void ts::CyclingPacketizer::removeSections(SectionDescList& list, TID tid, uint1
                 assert(_sched_packets >= sect.packetCount());
                 _sched_packets -= sect.packetCount();
             }
-            it = list.erase(it);
+            const SectionDescList::iterator next(std::next(it));
+            releaseSections(list, it, next);
+            it = next;
         }
         else {
             ++it;
@@ -246,11 +287,12 @@ void ts::CyclingPacketizer::removeSections(SectionDescList& list, TID tid, uint1
 
 void ts::CyclingPacketizer::removeAll()
 {
+    invalidateCache();
     _section_count = 0;
     _remain_in_cycle = 0;
     _sched_packets = 0;
-    _sched_sections.clear();
-    _other_sections.clear();
+    releaseSections(_sched_sections, _sched_sections.begin(), _sched_sections.end());
+    releaseSections(_other_sections, _other_sections.begin(), _other_sections.end());
 }
 
 
@@ -278,13 +320,13 @@ void ts::CyclingPacketizer::setBitRate(BitRate new_bitrate)
         // Do not do anything if bitrate unchanged.
         return;
     }
-    else if (new_bitrate == 0) {
+
+    invalidateCache();
+
+    if (new_bitrate == 0) {
         // Bitrate now unknown, unable to schedule sections, move them all
         // into the list of unscheduled sections.
-        while (!_sched_sections.empty()) {
-            _other_sections.push_back(_sched_sections.front());
-            _sched_sections.pop_front();
-        }
+        _other_sections.splice(_other_sections.end(), _sched_sections);
         _sched_packets = 0;
     }
     else if (_bitrate == 0) {
@@ -299,13 +341,12 @@ void ts::CyclingPacketizer::setBitRate(BitRate new_bitrate)
             }
             else {
                 // Scheduled section
-                const SectionDescPtr sp(*it);
-                it = _other_sections.erase(it);
-                if (sp->due_packet < current_packet) {
-                    sp->due_packet = current_packet;
+                const SectionDescList::iterator sp(it++);
+                if ((*sp)->due_packet < current_packet) {
+                    (*sp)->due_packet = current_packet;
                 }
-                addScheduledSection(sp);
-                _sched_packets += sp->section->packetCount();
+                _sched_sections.splice(schedulePosition(**sp, _sched_sections.begin()), _other_sections, sp);
+                _sched_packets += (*sp)->section->packetCount();
             }
         }
     }
@@ -315,10 +356,9 @@ void ts::CyclingPacketizer::setBitRate(BitRate new_bitrate)
         SectionDescList tmp_list;
         tmp_list.swap(_sched_sections);
         while (!tmp_list.empty()) {
-            SectionDesc* sp(tmp_list.back().pointer());
-            sp->due_packet = sp->last_packet + PacketDistance(new_bitrate, sp->repetition);
-            addScheduledSection(tmp_list.back());
-            tmp_list.pop_back();
+            const SectionDescList::iterator sp(std::prev(tmp_list.end()));
+            (*sp)->due_packet = (*sp)->last_packet + PacketDistance(new_bitrate, (*sp)->repetition);
+            _sched_sections.splice(schedulePosition(**sp, _sched_sections.begin()), tmp_list, sp);
         }
     }
 
@@ -327,6 +367,148 @@ void ts::CyclingPacketizer::setBitRate(BitRate new_bitrate)
 }
 
 
+//----------------------------------------------------------------------------
+// Set the TS packet stuffing policy at end of packet.
+//----------------------------------------------------------------------------
+
+void ts::CyclingPacketizer::setStuffingPolicy(StuffingPolicy sp)
+{
+    if (sp != _stuffing) {
+        invalidateCache();
+        _stuffing = sp;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Enable or disable the cache of packets.
+//----------------------------------------------------------------------------
+
+void ts::CyclingPacketizer::setCacheEnabled(bool enabled)
+{
+    if (enabled != _cache_enabled) {
+        invalidateCache();
+        _cache.shrink_to_fit();
+        _cache_enabled = enabled;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the current cycle can be cached.
+//----------------------------------------------------------------------------
+
+bool ts::CyclingPacketizer::cacheable() const
+{
+    // Scheduled sections depend on the packet index and may be repeated inside a cycle.
+    // Without stuffing, a cycle does not start at a packet boundary.
+    return _cache_enabled && _section_count > 0 && _sched_sections.empty() && _stuffing != NEVER;
+}
+
+
+//----------------------------------------------------------------------------
+// Invalidate the cache before a modification of the sections or parameters.
+//----------------------------------------------------------------------------
+
+void ts::CyclingPacketizer::invalidateCache()
+{
+    if (_cache_state == CACHE_READY && _cache_next > 0) {
+        // The cache was replayed up to the middle of a cycle. The actual state of the
+        // sections and the packetizer is still at the beginning of this cycle. Build
+        // the same packets again from the sections to get the corresponding state.
+        SectionCounter sections_in = 0;
+        SectionCounter sections_out = 0;
+        for (size_t i = 0; i < _cache_next; ++i) {
+            sections_in += _cache[i].sections_in;
+            sections_out += _cache[i].sections_out;
+        }
+        const uint8_t cc = nextContinuityCounter();
+        setCounters(packetCount() - _cache_next, providedSectionCount() - sections_in, sectionCount() - sections_out);
+        setNextContinuityCounter(uint8_t(cc - _cache_next));
+        TSPacket pkt;
+        for (size_t i = 0; i < _cache_next; ++i) {
+            Packetizer::getNextPacket(pkt);
+        }
+        assert(nextContinuityCounter() == cc);
+    }
+    _cache_state = CACHE_EMPTY;
+    _cache.clear();
+    _cache_next = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Update the state of the packetizer after the last packet of a replayed
+// cycle, as provideSection() would have done for each section.
+//----------------------------------------------------------------------------
+
+void ts::CyclingPacketizer::endReplayedCycle()
+{
+    for (SectionDescList::iterator it = _other_sections.begin(); it != _other_sections.end(); ++it) {
+        (*it)->last_cycle = _current_cycle;
+        (*it)->last_packet += _cache.size();
+    }
+    _cycle_end = providedSectionCount() - 1;
+    _current_cycle++;
+    _remain_in_cycle = _section_count;
+    _cache_next = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Build the next MPEG packet for the list of sections.
+//----------------------------------------------------------------------------
+
+bool ts::CyclingPacketizer::getNextPacket(TSPacket& pkt)
+{
+    // When a complete cycle is cached, replay it, only updating the PID and continuity counter.
+    if (_cache_state == CACHE_READY) {
+        const CachedPacket& cp(_cache[_cache_next++]);
+        pkt = cp.packet;
+        pkt.setPID(getPID());
+        pkt.setCC(nextContinuityCounter());
+        setNextContinuityCounter(nextContinuityCounter() + 1);
+        setCounters(packetCount() + 1, providedSectionCount() + cp.sections_in, sectionCount() + cp.sections_out);
+        if (_cache_next >= _cache.size()) {
+            endReplayedCycle();
+        }
+        return true;
+    }
+
+    // Start recording packets at the beginning of a cycle.
+    if (_cache_state == CACHE_EMPTY && atCycleBoundary() && cacheable()) {
+        _cache.clear();
+        _cache_state = CACHE_RECORDING;
+    }
+
+    const SectionCounter sections_in = providedSectionCount();
+    const SectionCounter sections_out = sectionCount();
+    const bool real = Packetizer::getNextPacket(pkt);
+
+    if (_cache_state == CACHE_RECORDING) {
+        if (!real || _cache.size() >= MAX_CACHED_PACKETS) {
+            // Cycle too large, do not keep a large unused buffer.
+            _cache_state = real ? CACHE_DISABLED : CACHE_EMPTY;
+            _cache.clear();
+            _cache.shrink_to_fit();
+        }
+        else {
+            _cache.resize(_cache.size() + 1);
+            CachedPacket& cp(_cache.back());
+            cp.packet = pkt;
+            cp.sections_in = uint8_t(providedSectionCount() - sections_in);
+            cp.sections_out = uint8_t(sectionCount() - sections_out);
+            if (atCycleBoundary()) {
+                // Complete cycle recorded, next cycles are replayed from the cache.
+                _cache_state = CACHE_READY;
+                _cache_next = 0;
+            }
+        }
+    }
+    return real;
+}
+
+
 //----------------------------------------------------------------------------
 // This hook is invoked when a new section is required.
 // If a null pointer is provided, no section is available.
@@ -359,18 +541,17 @@ void ts::CyclingPacketizer::provideSection(SectionCounter counter, SectionPtr& s
     if (!force_unscheduled && !_sched_sections.empty() && _sched_sections.front()->due_packet <= current_packet) {
         // One scheduled section is ready
         sp = _sched_sections.front();
-        _sched_sections.pop_front();
         // Reschedule the section. Make sure we add at least one packet to
-        // ensure that all scheduled sections may pass.
+        // ensure that all scheduled sections may pass. The list node is
+        // moved, not reallocated.
         sp->due_packet = current_packet + std::max(PacketCounter(1), PacketDistance(_bitrate, sp->repetition));
-        addScheduledSection(sp);
+        _sched_sections.splice(schedulePosition(*sp, std::next(_sched_sections.begin())), _sched_sections, _sched_sections.begin());
     }
     else if (!_other_sections.empty()) {
         // An unscheduled section is ready
         sp = _other_sections.front();
-        _other_sections.pop_front();
         // Move section back at end of queue
-        _other_sections.push_back(sp);
+        _other_sections.splice(_other_sections.end(), _other_sections, _other_sections.begin());
     }
 
     if (sp.isNull()) {
@@ -450,6 +631,7 @@ std::ostream& ts::CyclingPacketizer::display(std::ostream& strm) const
         << "  Current cycle: " << _current_cycle << std::endl
         << "  Remaining sections in cycle: " << _remain_in_cycle << std::endl
         << "  Section cycle end: " << (_cycle_end == UNDEFINED ? u"undefined" : UString::Decimal(_cycle_end)) << std::endl
+        << "  Cached packets: " << (_cache_state == CACHE_READY ? _cache.size() : 0) << std::endl
         << "  Stored sections: " << _section_count << std::endl
         << "  Scheduled sections: " << _sched_sections.size() << std::endl
         << "  Scheduled packets max: " << _sched_packets << std::endl;
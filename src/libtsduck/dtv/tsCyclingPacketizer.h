@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsPacketizer.h"
+#include "tsTSPacket.h"
 #include "tsSectionProviderInterface.h"
 #include "tsBinaryTable.h"
 #include "tsAbstractTable.h"
@@ -74,6 +75,13 @@ namespace ts {
     //! A bitrate is specified in bits/second. Zero means undefined.
     //! A repetition rate is specified in milliseconds. Zero means undefined.
     //!
+    //! When all sections are unscheduled and the stuffing policy is not NEVER,
+    //! all cycles are made of the same TS packets, except the continuity counters.
+    //! In that case, the packets of a complete cycle are kept in a cache and the
+    //! subsequent cycles are replayed from the cache without packetizing the sections
+    //! again. The cache is invalidated when the sections or the parameters of the
+    //! packetizer are modified. The cache can be disabled, the output is the same.
+    //!
     class TSDUCKDLL CyclingPacketizer: public Packetizer, private SectionProviderInterface
     {
         TS_NOBUILD_NOCOPY(CyclingPacketizer);
@@ -107,10 +115,7 @@ namespace ts {
         //! Set the TS packet stuffing policy at end of packet.
         //! @param [in] sp TS packet stuffing policy at end of packet.
         //!
-        void setStuffingPolicy(StuffingPolicy sp)
-        {
-            _stuffing = sp;
-        }
+        void setStuffingPolicy(StuffingPolicy sp);
 
         //!
         //! Get the TS packet stuffing policy at end of packet.
@@ -134,6 +139,24 @@ namespace ts {
             return _bitrate;
         }
 
+        //!
+        //! Enable or disable the cache of packets of a complete cycle.
+        //! The cache is enabled by default. The generated packets are the same with
+        //! or without cache. Disabling the cache is only useful to save memory or to
+        //! check the cached packets against packets which are built from the sections.
+        //! @param [in] enabled When false, all packets are built from the sections.
+        //!
+        void setCacheEnabled(bool enabled);
+
+        //!
+        //! Check if the cache of packets of a complete cycle is enabled.
+        //! @return True if the cache is enabled.
+        //!
+        bool cacheEnabled() const
+        {
+            return _cache_enabled;
+        }
+
         //!
         //! Add one section into the packetizer.
         //! The contents of the sections are shared.
@@ -210,6 +233,7 @@ namespace ts {
         bool atCycleBoundary() const;
 
         // Inherited from Packetizer.
+        virtual bool getNextPacket(TSPacket& packet) override;
         virtual void reset() override;
         virtual std::ostream& display(std::ostream& strm) const override;
 
@@ -228,6 +252,9 @@ namespace ts {
             // Constructor
             SectionDesc(const SectionPtr& sec, MilliSecond rep);
 
+            // Reinitialize a recycled section descriptor.
+            void reset(const SectionPtr& sec, MilliSecond rep);
+
             // Check if this section shall be inserted after some other one.
             bool insertAfter(const SectionDesc& other) const;
 
@@ -241,25 +268,62 @@ namespace ts {
         // List of sections
         typedef std::list <SectionDescPtr> SectionDescList;
 
+        // A packet of a complete cycle in the cache, with the number of sections it starts and terminates.
+        class CachedPacket
+        {
+        public:
+            TSPacket packet;       // Packet content, CC to be updated.
+            uint8_t  sections_in;  // Number of provided sections in this packet.
+            uint8_t  sections_out; // Number of terminated sections in this packet.
+        };
+
+        // State of the cache of packets.
+        enum CacheState {
+            CACHE_EMPTY,      // Nothing in cache, wait for next cycle boundary.
+            CACHE_RECORDING,  // Recording packets of the current cycle.
+            CACHE_READY,      // Cache contains a complete cycle, replay it.
+            CACHE_DISABLED    // Cycle too large for the cache, do not retry until next modification.
+        };
+
+        // Maximum number of packets in the cache (a cycle is larger than the cache, it is not cached).
+        static const size_t MAX_CACHED_PACKETS = 10000;
+
         // Private members:
         StuffingPolicy  _stuffing;
         BitRate         _bitrate;
         size_t          _section_count;   // Number of sections in the 2 lists
         SectionDescList _sched_sections;  // Scheduled sections, with repetition rates
         SectionDescList _other_sections;  // Unscheduled sections
+        SectionDescList _free_sections;   // Released section descriptors, reused by addSection()
         PacketCounter   _sched_packets;   // Size in TS packets of all sections in _sched_sections
         SectionCounter  _current_cycle;   // Cycle number (start at 1, always increasing)
         size_t          _remain_in_cycle; // Number of unsent sections in this cycle
         SectionCounter  _cycle_end;       // At end of cycle, contains the index of last section
+        bool            _cache_enabled;   // Use the cache of packets when possible
+        CacheState      _cache_state;     // State of the cache of packets
+        std::vector<CachedPacket> _cache; // Packets of a complete cycle
+        size_t          _cache_next;      // Index of next packet to replay in _cache
 
         static const SectionCounter UNDEFINED = ~SectionCounter(0);
 
-        // Insert a scheduled section in the list, sorted by due_packet.
-        void addScheduledSection(const SectionDescPtr&);
+        // Find the position of a scheduled section in the list, sorted by due_packet, starting at a given position.
+        SectionDescList::iterator schedulePosition(const SectionDesc&, SectionDescList::iterator);
+
+        // Move a range of section descriptors into the list of released descriptors.
+        void releaseSections(SectionDescList&, SectionDescList::iterator, SectionDescList::iterator);
 
         // Remove all sections with the specified tid/tid_ext in the specified list.
         void removeSections(SectionDescList&, TID, uint16_t tid_ext, bool use_tid_ext, bool scheduled);
 
+        // Check if the current cycle can be cached.
+        bool cacheable() const;
+
+        // Invalidate the cache before a modification of the sections or the parameters.
+        void invalidateCache();
+
+        // Update the state of the packetizer after the last packet of a replayed cycle.
+        void endReplayedCycle();
+
         // Inherited from SectionProviderInterface
         virtual void provideSection(SectionCounter, SectionPtr&) override;
         virtual bool doStuffing() override;
@@ -34,6 +34,11 @@
 #include "tsFatal.h"
 #include "tsCerrReport.h"
 #include "tsPSIRepository.h"
+#include "tsTime.h"
+#if defined(TS_UNIX)
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
 TSDUCK_SOURCE;
 
 
@@ -50,6 +55,43 @@ ts::NamesOUI::NamesOUI() : Names(u"tsduck.oui.names") {}
 ts::NamesOUI::~NamesOUI() {}
 
 
+//----------------------------------------------------------------------------
+// Sections of the configuration instances, resolved on first use.
+//----------------------------------------------------------------------------
+
+namespace {
+    template <class REPO>
+    class NamesSection
+    {
+        TS_NOBUILD_NOCOPY(NamesSection);
+    public:
+        NamesSection(const ts::UChar* name) : _repo(REPO::Instance()), _section(_repo->getSection(name)) {}
+
+        bool exists(ts::Names::Value value) const
+        {
+            return _repo->nameExists(_section, value);
+        }
+
+        ts::UString name(ts::Names::Value value, ts::names::Flags flags, size_t bits = 0, ts::Names::Value alternateValue = 0) const
+        {
+            return _repo->nameFromSection(_section, value, flags, bits, alternateValue);
+        }
+
+        ts::UString nameWithFallback(ts::Names::Value value1, ts::Names::Value value2, ts::names::Flags flags, size_t bits) const
+        {
+            return _repo->nameFromSectionWithFallback(_section, value1, value2, flags, bits);
+        }
+
+    private:
+        const REPO* const _repo;
+        const ts::Names::SectionHandle _section;
+    };
+
+    typedef NamesSection<ts::NamesMain> MainSection;
+    typedef NamesSection<ts::NamesOUI> OUISection;
+}
+
+
 //----------------------------------------------------------------------------
 // Tables ids: specific standards processing
 //----------------------------------------------------------------------------
@@ -57,8 +99,7 @@ ts::NamesOUI::~NamesOUI() {}
 ts::UString ts::names::TID(const DuckContext& duck, uint8_t tid, uint16_t cas, Flags flags)
 {
     // Where to search table ids.
-    const Names* const repo = NamesMain::Instance();
-    const UString section(u"TableId");
+    static const MainSection section(u"TableId");
 
     // Check without standard, then with all known standards in TSDuck context.
     // In all cases, use version with CAS first, then without CAS.
@@ -69,11 +110,11 @@ ts::UString ts::names::TID(const DuckContext& duck, uint8_t tid, uint16_t cas, F
     const Names::Value casMask = Names::Value(CASFamilyOf(cas)) << 8;
     Names::Value finalValue = Names::Value(tid);
 
-    if (repo->nameExists(section, finalValue | casMask)) {
+    if (section.exists(finalValue | casMask)) {
         // Found without standard, with CAS.
         finalValue |= casMask;
     }
-    else if (repo->nameExists(section, finalValue)) {
+    else if (section.exists(finalValue)) {
         // Found without standard, without CAS. Nothing to do. Keep this value.
     }
     else {
@@ -86,13 +127,13 @@ ts::UString ts::names::TID(const DuckContext& duck, uint8_t tid, uint16_t cas, F
             const bool supportedStandard = (duck.standards() & mask) != 0;
             // Lookup name only if supported standard or no previous standard was found.
             if (!foundOnce || supportedStandard) {
-                bool foundHere = repo->nameExists(section, value | casMask);
+                bool foundHere = section.exists(value | casMask);
                 if (foundHere) {
                     // Found with that standard, with CAS.
                     finalValue = value | casMask;
                     foundOnce = true;
                 }
-                else if (repo->nameExists(section, value)) {
+                else if (section.exists(value)) {
                     // Found with that standard, without CAS.
                     finalValue = value;
                     foundHere = foundOnce = true;
@@ -105,7 +146,7 @@ ts::UString ts::names::TID(const DuckContext& duck, uint8_t tid, uint16_t cas, F
     }
 
     // Return the name for best matched value.
-    return repo->nameFromSection(section, finalValue, flags, 8);
+    return section.name(finalValue, flags, 8);
 }
 
 
@@ -113,11 +154,19 @@ ts::UString ts::names::TID(const DuckContext& duck, uint8_t tid, uint16_t cas, F
 // Descriptor ids: specific processing for table-specific descriptors.
 //----------------------------------------------------------------------------
 
+namespace {
+    const MainSection& DescriptorIdSection()
+    {
+        static const MainSection section(u"DescriptorId");
+        return section;
+    }
+}
+
 bool ts::names::HasTableSpecificName(uint8_t did, uint8_t tid)
 {
     return tid != TID_NULL &&
         did < 0x80 &&
-        NamesMain::Instance()->nameExists(u"DescriptorId", (Names::Value(tid) << 40) | TS_UCONST64(0x000000FFFFFFFF00) | Names::Value(did));
+        DescriptorIdSection().exists((Names::Value(tid) << 40) | TS_UCONST64(0x000000FFFFFFFF00) | Names::Value(did));
 }
 
 ts::UString ts::names::DID(uint8_t did, uint32_t pds, uint8_t tid, Flags flags)
@@ -125,15 +174,15 @@ ts::UString ts::names::DID(uint8_t did, uint32_t pds, uint8_t tid, Flags flags)
     if (did >= 0x80 && pds != 0 && pds != PDS_NULL) {
         // If this is a private descriptor, only consider the private value.
         // Do not fallback because the same value with PDS == 0 can be different.
-        return NamesMain::Instance()->nameFromSection(u"DescriptorId", (Names::Value(pds) << 8) | Names::Value(did), flags, 8);
+        return DescriptorIdSection().name((Names::Value(pds) << 8) | Names::Value(did), flags, 8);
     }
     else if (tid != 0xFF) {
         // Could be a table-specific descriptor.
         const Names::Value fullValue = (Names::Value(tid) << 40) | TS_UCONST64(0x000000FFFFFFFF00) | Names::Value(did);
-        return NamesMain::Instance()->nameFromSectionWithFallback(u"DescriptorId", fullValue, Names::Value(did), flags, 8);
+        return DescriptorIdSection().nameWithFallback(fullValue, Names::Value(did), flags, 8);
     }
     else {
-        return NamesMain::Instance()->nameFromSection(u"DescriptorId", Names::Value(did), flags, 8);
+        return DescriptorIdSection().name(Names::Value(did), flags, 8);
     }
 }
 
@@ -143,153 +192,183 @@ ts::UString ts::names::DID(uint8_t did, uint32_t pds, uint8_t tid, Flags flags)
 
 ts::UString ts::names::EDID(uint8_t edid, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"DVBExtendedDescriptorId", Names::Value(edid), flags, 8);
+    static const MainSection section(u"DVBExtendedDescriptorId");
+    return section.name(Names::Value(edid), flags, 8);
 }
 
 ts::UString ts::names::StreamType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"StreamType", Names::Value(type), flags, 8);
+    static const MainSection section(u"StreamType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 ts::UString ts::names::Content(uint8_t x, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"ContentId", Names::Value(x), flags, 8);
+    static const MainSection section(u"ContentId");
+    return section.name(Names::Value(x), flags, 8);
 }
 
 ts::UString ts::names::PrivateDataSpecifier(uint32_t pds, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"PrivateDataSpecifier", Names::Value(pds), flags, 32);
+    static const MainSection section(u"PrivateDataSpecifier");
+    return section.name(Names::Value(pds), flags, 32);
 }
 
 ts::UString ts::names::CASFamily(ts::CASFamily cas)
 {
-    return NamesMain::Instance()->nameFromSection(u"CASFamily", Names::Value(cas), NAME | DECIMAL);
+    static const MainSection section(u"CASFamily");
+    return section.name(Names::Value(cas), NAME | DECIMAL);
 }
 
 ts::UString ts::names::CASId(const DuckContext& duck, uint16_t id, Flags flags)
 {
-    const UChar* section = (duck.standards() & STD_ISDB) != 0 ? u"ARIBCASystemId" : u"CASystemId";
-    return NamesMain::Instance()->nameFromSection(section, Names::Value(id), flags, 16);
+    static const MainSection dvb(u"CASystemId");
+    static const MainSection arib(u"ARIBCASystemId");
+    return ((duck.standards() & STD_ISDB) != 0 ? arib : dvb).name(Names::Value(id), flags, 16);
 }
 
 ts::UString ts::names::BouquetId(uint16_t id, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"BouquetId", Names::Value(id), flags, 16);
+    static const MainSection section(u"BouquetId");
+    return section.name(Names::Value(id), flags, 16);
 }
 
 ts::UString ts::names::OriginalNetworkId(uint16_t id, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"OriginalNetworkId", Names::Value(id), flags, 16);
+    static const MainSection section(u"OriginalNetworkId");
+    return section.name(Names::Value(id), flags, 16);
 }
 
 ts::UString ts::names::NetworkId(uint16_t id, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"NetworkId", Names::Value(id), flags, 16);
+    static const MainSection section(u"NetworkId");
+    return section.name(Names::Value(id), flags, 16);
 }
 
 ts::UString ts::names::PlatformId(uint32_t id, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"PlatformId", Names::Value(id), flags, 24);
+    static const MainSection section(u"PlatformId");
+    return section.name(Names::Value(id), flags, 24);
 }
 
 ts::UString ts::names::DataBroadcastId(uint16_t id, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"DataBroadcastId", Names::Value(id), flags, 16);
+    static const MainSection section(u"DataBroadcastId");
+    return section.name(Names::Value(id), flags, 16);
 }
 
 ts::UString ts::names::OUI(uint32_t oui, Flags flags)
 {
-    return NamesOUI::Instance()->nameFromSection(u"OUI", Names::Value(oui), flags, 24);
+    static const OUISection section(u"OUI");
+    return section.name(Names::Value(oui), flags, 24);
 }
 
 ts::UString ts::names::StreamId(uint8_t sid, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"StreamId", Names::Value(sid), flags, 8);
+    static const MainSection section(u"StreamId");
+    return section.name(Names::Value(sid), flags, 8);
 }
 
 ts::UString ts::names::PESStartCode(uint8_t code, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"PESStartCode", Names::Value(code), flags, 8);
+    static const MainSection section(u"PESStartCode");
+    return section.name(Names::Value(code), flags, 8);
 }
 
 ts::UString ts::names::AspectRatio(uint8_t ar, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"AspectRatio", Names::Value(ar), flags, 8);
+    static const MainSection section(u"AspectRatio");
+    return section.name(Names::Value(ar), flags, 8);
 }
 
 ts::UString ts::names::ChromaFormat(uint8_t cf, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"ChromaFormat", Names::Value(cf), flags, 8);
+    static const MainSection section(u"ChromaFormat");
+    return section.name(Names::Value(cf), flags, 8);
 }
 
 ts::UString ts::names::AVCUnitType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"AVCUnitType", Names::Value(type), flags, 8);
+    static const MainSection section(u"AVCUnitType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 ts::UString ts::names::AVCProfile(int profile, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"AVCProfile", Names::Value(profile), flags, 8);
+    static const MainSection section(u"AVCProfile");
+    return section.name(Names::Value(profile), flags, 8);
 }
 
 ts::UString ts::names::ServiceType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"ServiceType", Names::Value(type), flags, 8);
+    static const MainSection section(u"ServiceType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 ts::UString ts::names::LinkageType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"LinkageType", Names::Value(type), flags, 8);
+    static const MainSection section(u"LinkageType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 ts::UString ts::names::TeletextType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"TeletextType", Names::Value(type), flags, 8);
+    static const MainSection section(u"TeletextType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 ts::UString ts::names::RunningStatus(uint8_t status, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"RunningStatus", Names::Value(status), flags, 8);
+    static const MainSection section(u"RunningStatus");
+    return section.name(Names::Value(status), flags, 8);
 }
 
 ts::UString ts::names::AudioType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"AudioType", Names::Value(type), flags, 8);
+    static const MainSection section(u"AudioType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 ts::UString ts::names::SubtitlingType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"SubtitlingType", Names::Value(type), flags, 8);
+    static const MainSection section(u"SubtitlingType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 ts::UString ts::names::DTSSampleRateCode(uint8_t x, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"DTSSampleRate", Names::Value(x), flags, 8);
+    static const MainSection section(u"DTSSampleRate");
+    return section.name(Names::Value(x), flags, 8);
 }
 
 ts::UString ts::names::DTSBitRateCode(uint8_t x, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"DTSBitRate", Names::Value(x), flags, 8);
+    static const MainSection section(u"DTSBitRate");
+    return section.name(Names::Value(x), flags, 8);
 }
 
 ts::UString ts::names::DTSSurroundMode(uint8_t x, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"DTSSurroundMode", Names::Value(x), flags, 8);
+    static const MainSection section(u"DTSSurroundMode");
+    return section.name(Names::Value(x), flags, 8);
 }
 
 ts::UString ts::names::DTSExtendedSurroundMode(uint8_t x, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"DTSExtendedSurroundMode", Names::Value(x), flags, 8);
+    static const MainSection section(u"DTSExtendedSurroundMode");
+    return section.name(Names::Value(x), flags, 8);
 }
 
 ts::UString ts::names::ScramblingControl(uint8_t scv, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"ScramblingControl", Names::Value(scv), flags, 8);
+    static const MainSection section(u"ScramblingControl");
+    return section.name(Names::Value(scv), flags, 8);
 }
 
 ts::UString ts::names::T2MIPacketType(uint8_t type, Flags flags)
 {
-    return NamesMain::Instance()->nameFromSection(u"T2MIPacketType", Names::Value(type), flags, 8);
+    static const MainSection section(u"T2MIPacketType");
+    return section.name(Names::Value(type), flags, 8);
 }
 
 
@@ -326,7 +405,8 @@ ts::UString ts::names::ComponentType(const DuckContext& duck, uint16_t type, Fla
 
     if (duck.standards() & STD_JAPAN) {
         // Japan / ISDB uses a completely different mapping.
-        return NamesMain::Instance()->nameFromSection(u"ComponentTypeJapan", Names::Value(nType), flags | names::ALTERNATE, 16, dType);
+        static const MainSection japan(u"ComponentTypeJapan");
+        return japan.name(Names::Value(nType), flags | names::ALTERNATE, 16, dType);
     }
     else if ((nType & 0xFF00) == 0x3F00) {
         return SubtitlingType(nType & 0x00FF, flags);
@@ -335,7 +415,8 @@ ts::UString ts::names::ComponentType(const DuckContext& duck, uint16_t type, Fla
         return AC3ComponentType(nType & 0x00FF, flags);
     }
     else {
-        return NamesMain::Instance()->nameFromSection(u"ComponentType", Names::Value(nType), flags | names::ALTERNATE, 16, dType);
+        static const MainSection dvb(u"ComponentType");
+        return dvb.name(Names::Value(nType), flags | names::ALTERNATE, 16, dType);
     }
 }
 
@@ -378,6 +459,62 @@ ts::UString ts::names::AC3ComponentType(uint8_t type, Flags flags)
 }
 
 
+//----------------------------------------------------------------------------
+// Layout of the compiled image.
+// All integers are in native byte order. All structures have a size which
+// is a multiple of 8 bytes to keep the alignment of the next arrays.
+//----------------------------------------------------------------------------
+
+const ts::UChar* const ts::Names::CACHE_ENVIRONMENT_VARIABLE = u"TSDUCK_NAMES_CACHE";
+
+namespace {
+    constexpr uint32_t IMAGE_MAGIC = 0x4D4E5354;  // "TSNM" in little endian.
+    constexpr uint32_t IMAGE_VERSION = 1;
+}
+
+// Image header.
+struct ts::Names::ImageHeader
+{
+    uint32_t magic;          // IMAGE_MAGIC
+    uint32_t version;        // IMAGE_VERSION
+    uint32_t image_size;     // Total size of image in bytes.
+    uint32_t source_count;   // Number of ImageSource.
+    uint32_t section_count;  // Number of SectionData.
+    uint32_t entry_count;    // Number of ImageEntry.
+    uint32_t pool_size;      // Number of UChar in string pool.
+    uint32_t reserved;
+};
+
+// Description of a source configuration file.
+struct ts::Names::ImageSource
+{
+    int64_t  size;           // File size in bytes.
+    int64_t  time;           // File modification time in milliseconds since Epoch.
+    uint32_t path_offset;    // Offset of file path in string pool.
+    uint32_t path_length;    // Length of file path in string pool.
+};
+
+// Description of a section.
+struct ts::Names::SectionData
+{
+    uint32_t name_offset;    // Offset of lower-case section name in string pool.
+    uint32_t name_length;    // Length of section name in string pool.
+    uint32_t bits;           // Number of significant bits in values of the type.
+    uint32_t first_entry;    // Index of first ImageEntry in the section.
+    uint32_t entry_count;    // Number of ImageEntry in the section.
+    uint32_t reserved;
+};
+
+// Description of a range of values with a name.
+struct ts::Names::ImageEntry
+{
+    uint64_t first;          // First value in range.
+    uint64_t last;           // Last value in range.
+    uint32_t name_offset;    // Offset of name in string pool.
+    uint32_t name_length;    // Length of name in string pool.
+};
+
+
 //----------------------------------------------------------------------------
 // Constructor (load the configuration file).
 //----------------------------------------------------------------------------
@@ -386,15 +523,26 @@ ts::Names::Names(const UString& fileName, bool mergeExtensions) :
     _log(CERR),
     _configFile(SearchConfigurationFile(fileName)),
     _configErrors(0),
-    _sections()
+    _fromCache(false),
+    _image(),
+    _mapAddress(nullptr),
+    _mapSize(0),
+    _header(nullptr),
+    _sources(nullptr),
+    _sections(nullptr),
+    _entries(nullptr),
+    _pool(nullptr)
 {
+    // List of configuration files to load, with absolute paths.
+    UStringVector sources;
+
     // Locate the configuration file.
     if (_configFile.empty()) {
         // Cannot load configuration, names will not be available.
         _log.error(u"configuration file '%s' not found", {fileName});
     }
     else {
-        loadFile(_configFile);
+        sources.push_back(AbsoluteFilePath(_configFile));
     }
 
     // Merge extensions if required.
@@ -408,27 +556,80 @@ ts::Names::Names(const UString& fileName, bool mergeExtensions) :
                 _log.error(u"extension file '%s' not found", {*name});
             }
             else {
-                loadFile(path);
+                sources.push_back(AbsoluteFilePath(path));
+            }
+        }
+    }
+
+    // Name of the cache file, when the cache is used.
+    UString cacheFile;
+    if (!sources.empty()) {
+        UString cacheDir;
+        if (EnvironmentExists(CACHE_ENVIRONMENT_VARIABLE)) {
+            cacheDir = GetEnvironment(CACHE_ENVIRONMENT_VARIABLE);
+        }
+        else {
+#if defined(TS_WINDOWS)
+            const UString local(GetEnvironment(u"LOCALAPPDATA"));
+            if (!local.empty()) {
+                cacheDir = local + u"\\tsduck\\cache";
             }
+#else
+            const UString xdg(GetEnvironment(u"XDG_CACHE_HOME"));
+            const UString home(UserHomeDirectory());
+            if (!xdg.empty()) {
+                cacheDir = xdg + u"/tsduck";
+            }
+            else if (!home.empty()) {
+                cacheDir = home + u"/.cache/tsduck";
+            }
+#endif
+        }
+        if (!cacheDir.empty()) {
+            cacheFile = cacheDir + PathSeparator + BaseName(sources.front()) + u".cache";
         }
     }
+
+    // Use the cache file if it is up to date. Otherwise, load all configuration files.
+    if (cacheFile.empty() || !loadCache(cacheFile, sources)) {
+        LoadSectionMap sections;
+        for (auto it = sources.begin(); it != sources.end(); ++it) {
+            loadFile(*it, sections);
+        }
+        buildImage(sections, sources);
+        // Do not save incorrect configurations, errors must be reported each time.
+        if (!cacheFile.empty() && _configErrors == 0) {
+            saveCache(cacheFile);
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Destructor: free all resources.
+//----------------------------------------------------------------------------
+
+ts::Names::~Names()
+{
+    unmapCache();
 }
 
 
 //----------------------------------------------------------------------------
-// Load a configuration file and merge its content into this instance.
+// Load a configuration file and merge its content into a map of sections.
 //----------------------------------------------------------------------------
 
-void ts::Names::loadFile(const UString& fileName)
+void ts::Names::loadFile(const UString& fileName, LoadSectionMap& sections)
 {
     // Open configuration file.
     std::ifstream strm(fileName.toUTF8().c_str());
     if (!strm) {
         _log.error(u"error opening file %s", {fileName});
+        _configErrors++;
         return;
     }
 
-    ConfigSection* section = nullptr;
+    LoadSection* section = nullptr;
     UString line;
 
     // Read configuration file line by line.
@@ -447,18 +648,9 @@ void ts::Names::loadFile(const UString& fileName)
             line.convertToLower();
 
             // Get or create associated section.
-            ConfigSectionMap::iterator it = _sections.find(line);
-            if (it != _sections.end()) {
-                section = it->second;
-            }
-            else {
-                // Create new section.
-                section = new ConfigSection;
-                CheckNonNull(section);
-                _sections.insert(std::make_pair(line, section));
-            }
+            section = &sections[line];
         }
-        else if (!decodeDefinition(line, section)) {
+        else if (!decodeDefinition(fileName, line, section)) {
             // Invalid line.
             _log.error(u"%s: invalid line %d: %s", {fileName, lineNumber, line});
             if (++_configErrors >= 20) {
@@ -476,7 +668,7 @@ void ts::Names::loadFile(const UString& fileName)
 // Decode a line as "first[-last] = name". Return true on success.
 //----------------------------------------------------------------------------
 
-bool ts::Names::decodeDefinition(const UString& line, ConfigSection* section)
+bool ts::Names::decodeDefinition(const UString& fileName, const UString& line, LoadSection* section)
 {
     // Check the presence of the '=' and in a valid section.
     const size_t equal = line.find(UChar('='));
@@ -516,10 +708,12 @@ bool ts::Names::decodeDefinition(const UString& line, ConfigSection* section)
     // Add the definition.
     if (valid) {
         if (section->freeRange(first, last)) {
-            section->addEntry(first, last, value);
+            LoadEntry& entry(section->entries[first]);
+            entry.last = last;
+            entry.name = value;
         }
         else {
-            _log.error(u"%s: range 0x%X-0x%X overlaps with an existing range", {_configFile, first, last});
+            _log.error(u"%s: range 0x%X-0x%X overlaps with an existing range", {fileName, first, last});
             valid = false;
         }
     }
@@ -528,113 +722,338 @@ bool ts::Names::decodeDefinition(const UString& line, ConfigSection* section)
 
 
 //----------------------------------------------------------------------------
-// Destructor: free all resources.
+// Check if a range is free, ie no value is defined in the range.
 //----------------------------------------------------------------------------
 
-ts::Names::~Names()
+bool ts::Names::LoadSection::freeRange(Value first, Value last) const
 {
-    // Deallocate all configuration sections.
-    for (ConfigSectionMap::iterator it = _sections.begin(); it != _sections.end(); ++it) {
-        delete it->second;
+    // Get an iterator pointing to the first element that is "not less" than 'first'.
+    LoadEntryMap::const_iterator it = entries.lower_bound(first);
+
+    if (it != entries.end() && it->first <= last) {
+        // This is an existing range which starts inside [first..last].
+        assert(it->first >= first);
+        return false;
+    }
+
+    if (it != entries.begin() && (--it)->second.last >= first) {
+        // The previous range ends inside [first..last].
+        assert(it->first < first);
+        return false;
     }
-    _sections.clear();
+
+    // No overlap found.
+    return true;
 }
 
 
 //----------------------------------------------------------------------------
-// Configuration entry.
+// Build the compiled image from loaded sections.
 //----------------------------------------------------------------------------
 
-ts::Names::ConfigEntry::ConfigEntry(Value l, const UString& n) :
-    last(l),
-    name(n)
+void ts::Names::buildImage(const LoadSectionMap& sections, const UStringVector& sources)
 {
+    // Build the string pool and all arrays separately.
+    UString pool;
+    std::vector<ImageSource> srcs(sources.size());
+    std::vector<SectionData> secs(sections.size());
+    std::vector<ImageEntry> entries;
+
+    const auto addString = [&pool](const UString& str, uint32_t& offset, uint32_t& length) {
+        offset = uint32_t(pool.size());
+        length = uint32_t(str.size());
+        pool.append(str);
+    };
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        srcs[i].size = GetFileSize(sources[i]);
+        srcs[i].time = GetFileModificationTimeUTC(sources[i]) - Time::Epoch;
+        addString(sources[i], srcs[i].path_offset, srcs[i].path_length);
+    }
+
+    // The map of sections is already sorted by lower-case names.
+    size_t si = 0;
+    for (auto sec = sections.begin(); sec != sections.end(); ++sec, ++si) {
+        addString(sec->first, secs[si].name_offset, secs[si].name_length);
+        secs[si].bits = uint32_t(sec->second.bits);
+        secs[si].first_entry = uint32_t(entries.size());
+        secs[si].entry_count = uint32_t(sec->second.entries.size());
+        secs[si].reserved = 0;
+        // The map of entries is already sorted by first value.
+        for (auto ent = sec->second.entries.begin(); ent != sec->second.entries.end(); ++ent) {
+            ImageEntry entry;
+            entry.first = ent->first;
+            entry.last = ent->second.last;
+            addString(ent->second.name, entry.name_offset, entry.name_length);
+            entries.push_back(entry);
+        }
+    }
+
+    // Build the image.
+    ImageHeader header;
+    header.magic = IMAGE_MAGIC;
+    header.version = IMAGE_VERSION;
+    header.source_count = uint32_t(srcs.size());
+    header.section_count = uint32_t(secs.size());
+    header.entry_count = uint32_t(entries.size());
+    header.pool_size = uint32_t(pool.size());
+    header.reserved = 0;
+    header.image_size = uint32_t(sizeof(ImageHeader) + srcs.size() * sizeof(ImageSource) + secs.size() * sizeof(SectionData) + entries.size() * sizeof(ImageEntry) + pool.size() * sizeof(UChar));
+
+    _image.clear();
+    _image.reserve(header.image_size);
+    _image.append(&header, sizeof(header));
+    _image.append(srcs.data(), srcs.size() * sizeof(ImageSource));
+    _image.append(secs.data(), secs.size() * sizeof(SectionData));
+    _image.append(entries.data(), entries.size() * sizeof(ImageEntry));
+    _image.append(pool.data(), pool.size() * sizeof(UChar));
+
+    const bool valid = setImage(_image.data(), _image.size());
+    assert(valid);
 }
 
 
 //----------------------------------------------------------------------------
-// Configuration section.
+// Check the validity of a compiled image and set the internal pointers.
 //----------------------------------------------------------------------------
 
-ts::Names::ConfigSection::ConfigSection() :
-    bits(0),
-    entries()
+bool ts::Names::setImage(const uint8_t* data, size_t size)
 {
+    const ImageHeader* header = reinterpret_cast<const ImageHeader*>(data);
+    if (data == nullptr ||
+        size < sizeof(ImageHeader) ||
+        header->magic != IMAGE_MAGIC ||
+        header->version != IMAGE_VERSION ||
+        header->image_size != size ||
+        size != sizeof(ImageHeader) +
+                size_t(header->source_count) * sizeof(ImageSource) +
+                size_t(header->section_count) * sizeof(SectionData) +
+                size_t(header->entry_count) * sizeof(ImageEntry) +
+                size_t(header->pool_size) * sizeof(UChar))
+    {
+        return false;
+    }
+
+    const ImageSource* sources = reinterpret_cast<const ImageSource*>(header + 1);
+    const SectionData* sections = reinterpret_cast<const SectionData*>(sources + header->source_count);
+    const ImageEntry* entries = reinterpret_cast<const ImageEntry*>(sections + header->section_count);
+    const UChar* pool = reinterpret_cast<const UChar*>(entries + header->entry_count);
+
+    // Check that all indexes are in range to avoid any crash on corrupted cache files.
+    for (uint32_t i = 0; i < header->source_count; ++i) {
+        if (size_t(sources[i].path_offset) + sources[i].path_length > header->pool_size) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->section_count; ++i) {
+        if (size_t(sections[i].name_offset) + sections[i].name_length > header->pool_size ||
+            size_t(sections[i].first_entry) + sections[i].entry_count > header->entry_count)
+        {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->entry_count; ++i) {
+        if (size_t(entries[i].name_offset) + entries[i].name_length > header->pool_size) {
+            return false;
+        }
+    }
+
+    _header = header;
+    _sources = sources;
+    _sections = sections;
+    _entries = entries;
+    _pool = pool;
+    return true;
 }
 
-ts::Names::ConfigSection::~ConfigSection()
+
+//----------------------------------------------------------------------------
+// Check if the compiled image was built from the current configuration files.
+//----------------------------------------------------------------------------
+
+bool ts::Names::sameSources(const UStringVector& sources) const
 {
-    // Deallocate all configuration entries.
-    for (ConfigEntryMap::iterator it = entries.begin(); it != entries.end(); ++it) {
-        delete it->second;
+    if (_header == nullptr || _header->source_count != sources.size()) {
+        return false;
     }
-    entries.clear();
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const ImageSource& src(_sources[i]);
+        if (UString(_pool + src.path_offset, src.path_length) != sources[i] ||
+            src.size != GetFileSize(sources[i]) ||
+            src.time != GetFileModificationTimeUTC(sources[i]) - Time::Epoch)
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 
 //----------------------------------------------------------------------------
-// Check if a range is free, ie no value is defined in the range.
+// Load the cache file. Return true if the cache file was valid.
 //----------------------------------------------------------------------------
 
-bool ts::Names::ConfigSection::freeRange(Value first, Value last) const
+bool ts::Names::loadCache(const UString& cacheFile, const UStringVector& sources)
 {
-    // Get an iterator pointing to the first element that is "not less" than 'first'.
-    ConfigEntryMap::const_iterator it = entries.lower_bound(first);
-
-    if (it != entries.end() && it->first <= last) {
-        // This is an existing range which starts inside [first..last].
-        assert(it->first >= first);
+    const int64_t fileSize = GetFileSize(cacheFile);
+    if (fileSize < int64_t(sizeof(ImageHeader)) || fileSize > int64_t(std::numeric_limits<uint32_t>::max())) {
         return false;
     }
 
-    if (it != entries.begin() && (--it)->second->last >= first) {
-        // The previous range ends inside [first..last].
-        assert(it->first < first);
+#if defined(TS_UNIX)
+    // Map the cache file in memory.
+    const int fd = ::open(cacheFile.toUTF8().c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    void* addr = ::mmap(nullptr, size_t(fileSize), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
         return false;
     }
+    _mapAddress = addr;
+    _mapSize = size_t(fileSize);
+    _fromCache = setImage(reinterpret_cast<const uint8_t*>(addr), _mapSize) && sameSources(sources);
+#else
+    // Read the cache file in memory.
+    std::ifstream strm(cacheFile.toUTF8().c_str(), std::ios::in | std::ios::binary);
+    _image.resize(size_t(fileSize));
+    _fromCache = strm.read(reinterpret_cast<char*>(_image.data()), std::streamsize(_image.size())) &&
+                 setImage(_image.data(), _image.size()) &&
+                 sameSources(sources);
+#endif
+
+    if (!_fromCache) {
+        // Invalid or obsolete cache file.
+        unmapCache();
+        _image.clear();
+        _header = nullptr;
+        _sources = nullptr;
+        _sections = nullptr;
+        _entries = nullptr;
+        _pool = nullptr;
+    }
+    return _fromCache;
+}
 
-    // No overlap found.
-    return true;
+
+//----------------------------------------------------------------------------
+// Unmap the cache file, if mapped.
+//----------------------------------------------------------------------------
+
+void ts::Names::unmapCache()
+{
+#if defined(TS_UNIX)
+    if (_mapAddress != nullptr) {
+        ::munmap(_mapAddress, _mapSize);
+    }
+#endif
+    _mapAddress = nullptr;
+    _mapSize = 0;
 }
 
 
 //----------------------------------------------------------------------------
-// Add a new configuration entry.
+// Save the compiled image in the cache file.
 //----------------------------------------------------------------------------
 
-void ts::Names::ConfigSection::addEntry(Value first, Value last, const UString& name)
+void ts::Names::saveCache(const UString& cacheFile) const
 {
-    ConfigEntry* entry = new ConfigEntry(last, name);
-    CheckNonNull(entry);
-    entries.insert(std::make_pair(first, entry));
+    // The cache is only an optimization, errors are silently ignored.
+    // Write a temporary file first, then rename it. This is an atomic operation
+    // in case another process concurrently loads or saves the cache file.
+    CreateDirectory(DirectoryName(cacheFile), true);
+    const UString tmpFile(UString::Format(u"%s.%d.tmp", {cacheFile, CurrentProcessId()}));
+    std::ofstream strm(tmpFile.toUTF8().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (strm) {
+        const bool success = bool(strm.write(reinterpret_cast<const char*>(_image.data()), std::streamsize(_image.size())));
+        strm.close();
+        if (!success || RenameFile(tmpFile, cacheFile) != SYS_SUCCESS) {
+            DeleteFile(tmpFile);
+        }
+    }
 }
 
 
 //----------------------------------------------------------------------------
-// Get a name from a value, empty if not found.
+// Get the handle of a section.
 //----------------------------------------------------------------------------
 
-ts::UString ts::Names::ConfigSection::getName(Value val) const
+ts::Names::SectionHandle ts::Names::getSection(const UString& sectionName) const
 {
-    // Eliminate trivial cases which would cause issues with code below.
-    if (entries.empty()) {
-        return UString();
+    if (_header == nullptr) {
+        return nullptr;
     }
 
-    // The key in the 'entries' map is the _first_ value of a range.
-    // Get an iterator pointing to the first element that is "not less" than 'val'.
-    ConfigEntryMap::const_iterator it = entries.lower_bound(val);
+    // Ignore leading and trailing spaces in section name.
+    size_t start = 0;
+    size_t end = sectionName.size();
+    while (start < end && IsSpace(sectionName[start])) {
+        start++;
+    }
+    while (end > start && IsSpace(sectionName[end - 1])) {
+        end--;
+    }
 
-    if (it == entries.end() || (it != entries.begin() && it->first != val)) {
-        // There is no entry with a value range starting at 'val'.
-        // Maybe 'val' is in the range of the previous entry.
-        --it;
+    // Compare a lower-case section name from the pool with the searched name, without
+    // building a lower-case copy of the searched name. Same result as UString::compare().
+    const auto compare = [&](const SectionData& sec) -> int {
+        const UChar* name = _pool + sec.name_offset;
+        const size_t len = end - start;
+        for (size_t i = 0; i < len && i < sec.name_length; ++i) {
+            const UChar c = ToLower(sectionName[start + i]);
+            if (name[i] != c) {
+                return name[i] < c ? -1 : 1;
+            }
+        }
+        return sec.name_length == len ? 0 : (sec.name_length < len ? -1 : 1);
+    };
+
+    // Binary search in sorted array of sections.
+    size_t low = 0;
+    size_t high = _header->section_count;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int cmp = compare(_sections[mid]);
+        if (cmp == 0) {
+            return &_sections[mid];
+        }
+        else if (cmp < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
     }
+    return nullptr;
+}
 
-    assert(it != entries.end());
-    assert(it->second != nullptr);
 
-    return val >= it->first && val <= it->second->last ? it->second->name : UString();
+//----------------------------------------------------------------------------
+// Get an entry from a value, null if not found.
+//----------------------------------------------------------------------------
+
+const ts::Names::ImageEntry* ts::Names::getEntry(SectionHandle section, Value value) const
+{
+    if (section == nullptr || section->entry_count == 0) {
+        return nullptr;
+    }
+
+    // Find the last entry with a first value lower than or equal to 'value'.
+    const ImageEntry* const begin = _entries + section->first_entry;
+    const ImageEntry* const end = begin + section->entry_count;
+    const ImageEntry* it = std::upper_bound(begin, end, value, [](Value val, const ImageEntry& ent) { return val < ent.first; });
+
+    if (it == begin) {
+        return nullptr;
+    }
+    --it;
+    return value <= it->last ? it : nullptr;
+}
+
+ts::UString ts::Names::entryName(const ImageEntry* entry) const
+{
+    return entry == nullptr ? UString() : UString(_pool + entry->name_offset, entry->name_length);
 }
 
 
@@ -736,11 +1155,10 @@ ts::UString ts::Names::Formatted(Value value, const UString& name, names::Flags
 // Check if a name exists in a specified section.
 //----------------------------------------------------------------------------
 
-bool ts::Names::nameExists(const UString& sectionName, Value value) const
+bool ts::Names::nameExists(SectionHandle section, Value value) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    return it != _sections.end() && !it->second->getName(value).empty();
+    const ImageEntry* entry = getEntry(section, value);
+    return entry != nullptr && entry->name_length > 0;
 }
 
 
@@ -748,18 +1166,14 @@ bool ts::Names::nameExists(const UString& sectionName, Value value) const
 // Get a name from a specified section.
 //----------------------------------------------------------------------------
 
-ts::UString ts::Names::nameFromSection(const UString& sectionName, Value value, names::Flags flags, size_t bits, Value alternateValue) const
+ts::UString ts::Names::nameFromSection(SectionHandle section, Value value, names::Flags flags, size_t bits, Value alternateValue) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    const ConfigSection* section = it == _sections.end() ? nullptr : it->second;
-
     if (section == nullptr) {
         // Non-existent section, no name.
         return Formatted(value, UString(), flags, bits, alternateValue);
     }
     else {
-        return Formatted(value, section->getName(value), flags, bits != 0 ? bits : section->bits, alternateValue);
+        return Formatted(value, entryName(getEntry(section, value)), flags, bits != 0 ? bits : section->bits, alternateValue);
     }
 }
 
@@ -768,25 +1182,21 @@ ts::UString ts::Names::nameFromSection(const UString& sectionName, Value value,
 // Get a name from a specified section, with alternate fallback value.
 //----------------------------------------------------------------------------
 
-ts::UString ts::Names::nameFromSectionWithFallback(const UString& sectionName, Value value1, Value value2, names::Flags flags, size_t bits, Value alternateValue) const
+ts::UString ts::Names::nameFromSectionWithFallback(SectionHandle section, Value value1, Value value2, names::Flags flags, size_t bits, Value alternateValue) const
 {
-    // Get the section, normalize the section name.
-    ConfigSectionMap::const_iterator it = _sections.find(sectionName.toTrimmed().toLower());
-    const ConfigSection* section = it == _sections.end() ? nullptr : it->second;
-
     if (section == nullptr) {
         // Non-existent section, no name.
         return Formatted(value1, UString(), flags, bits, alternateValue);
     }
     else {
-        const UString name(section->getName(value1));
+        const UString name(entryName(getEntry(section, value1)));
         if (!name.empty()) {
             // value1 has a name
             return Formatted(value1, name, flags, bits != 0 ? bits : section->bits, alternateValue);
         }
         else {
             // value1 has no name, use value2.
-            return Formatted(value2, section->getName(value2), flags, bits != 0 ? bits : section->bits, alternateValue);
+            return Formatted(value2, entryName(getEntry(section, value2)), flags, bits != 0 ? bits : section->bits, alternateValue);
         }
     }
 }
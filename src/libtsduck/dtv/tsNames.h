@@ -38,6 +38,7 @@
 #include "tsCASFamily.h"
 #include "tsMPEG.h"
 #include "tsReport.h"
+#include "tsByteBlock.h"
 #include "tsSingletonManager.h"
 
 namespace ts {
@@ -357,6 +358,20 @@ namespace ts {
     //! A repository of names for MPEG/DVB entities.
     //! All names are loaded from configuration files @em tsduck*.names.
     //!
+    //! After loading the configuration files, the repository is compiled into a compact
+    //! binary image: sorted arrays of sections and value ranges, with all names in one
+    //! string pool. Lookups are binary searches in these arrays.
+    //!
+    //! The compiled image is saved in a cache file. The next time the same configuration
+    //! files are loaded, the cache file is directly mapped in memory instead of parsing the
+    //! configuration files again. The cache file is rebuilt when any configuration file
+    //! (including names files from extensions) is modified. The cache files are stored in
+    //! the directory which is specified by the environment variable @c TSDUCK_NAMES_CACHE.
+    //! When this variable is not defined, the default directory is @c $XDG_CACHE_HOME/tsduck
+    //! or @c $HOME/.cache/tsduck on UNIX systems and the subdirectory @c tsduck/cache of the
+    //! local application data directory on Windows. When the variable is defined but empty,
+    //! no cache file is used.
+    //!
     class TSDUCKDLL Names
     {
         TS_NOBUILD_NOCOPY(Names);
@@ -378,6 +393,24 @@ namespace ts {
         //!
         typedef uint64_t Value;
 
+        //!
+        //! Description of a section in the compiled repository (opaque structure).
+        //!
+        struct SectionData;
+
+        //!
+        //! Handle to a section in the repository of names.
+        //! A section handle is resolved once using getSection() and remains valid as long
+        //! as the repository exists. Using a handle avoids searching the section by name
+        //! at each lookup. A null handle means a non-existent section.
+        //!
+        typedef const SectionData* SectionHandle;
+
+        //!
+        //! Name of the environment variable which contains the directory of cache files.
+        //!
+        static const UChar* const CACHE_ENVIRONMENT_VARIABLE;
+
         //!
         //! Get the complete path of the configuration file from which the names were loaded.
         //! @return The complete path of the configuration file. Empty if does not exist.
@@ -396,13 +429,41 @@ namespace ts {
             return _configErrors;
         }
 
+        //!
+        //! Check if the compiled repository was loaded from a cache file.
+        //! @return True if the compiled repository was loaded from a cache file,
+        //! false if the configuration files were parsed.
+        //!
+        bool loadedFromCache() const
+        {
+            return _fromCache;
+        }
+
+        //!
+        //! Get the handle of a section.
+        //! @param [in] sectionName Name of section to search. Not case-sensitive.
+        //! @return The section handle or a null pointer if the section does not exist.
+        //!
+        SectionHandle getSection(const UString& sectionName) const;
+
         //!
         //! Check if a name exists in a specified section.
         //! @param [in] sectionName Name of section to search. Not case-sensitive.
         //! @param [in] value Value to get the name for.
         //! @return True if a name exists for @a value in @a sectionName.
         //!
-        bool nameExists(const UString& sectionName, Value value) const;
+        bool nameExists(const UString& sectionName, Value value) const
+        {
+            return nameExists(getSection(sectionName), value);
+        }
+
+        //!
+        //! Check if a name exists in a specified section.
+        //! @param [in] section Handle of the section to search.
+        //! @param [in] value Value to get the name for.
+        //! @return True if a name exists for @a value in @a section.
+        //!
+        bool nameExists(SectionHandle section, Value value) const;
 
         //!
         //! Get a name from a specified section.
@@ -413,7 +474,21 @@ namespace ts {
         //! @param [in] alternateValue Display this integer value if flags ALTERNATE is set.
         //! @return The corresponding name.
         //!
-        UString nameFromSection(const UString& sectionName, Value value, names::Flags flags = names::NAME, size_t bits = 0, Value alternateValue = 0) const;
+        UString nameFromSection(const UString& sectionName, Value value, names::Flags flags = names::NAME, size_t bits = 0, Value alternateValue = 0) const
+        {
+            return nameFromSection(getSection(sectionName), value, flags, bits, alternateValue);
+        }
+
+        //!
+        //! Get a name from a specified section.
+        //! @param [in] section Handle of the section to search.
+        //! @param [in] value Value to get the name for.
+        //! @param [in] flags Presentation flags.
+        //! @param [in] bits Nominal size in bits of the data, optional.
+        //! @param [in] alternateValue Display this integer value if flags ALTERNATE is set.
+        //! @return The corresponding name.
+        //!
+        UString nameFromSection(SectionHandle section, Value value, names::Flags flags = names::NAME, size_t bits = 0, Value alternateValue = 0) const;
 
         //!
         //! Get a name from a specified section, with alternate fallback value.
@@ -425,7 +500,22 @@ namespace ts {
         //! @param [in] alternateValue Display this integer value if flags ALTERNATE is set.
         //! @return The corresponding name.
         //!
-        UString nameFromSectionWithFallback(const UString& sectionName, Value value1, Value value2, names::Flags flags = names::NAME, size_t bits = 0, Value alternateValue = 0) const;
+        UString nameFromSectionWithFallback(const UString& sectionName, Value value1, Value value2, names::Flags flags = names::NAME, size_t bits = 0, Value alternateValue = 0) const
+        {
+            return nameFromSectionWithFallback(getSection(sectionName), value1, value2, flags, bits, alternateValue);
+        }
+
+        //!
+        //! Get a name from a specified section, with alternate fallback value.
+        //! @param [in] section Handle of the section to search.
+        //! @param [in] value1 Value to get the name for.
+        //! @param [in] value2 Alternate value if no name is found for @a value1.
+        //! @param [in] flags Presentation flags.
+        //! @param [in] bits Nominal size in bits of the data, optional.
+        //! @param [in] alternateValue Display this integer value if flags ALTERNATE is set.
+        //! @return The corresponding name.
+        //!
+        UString nameFromSectionWithFallback(SectionHandle section, Value value1, Value value2, names::Flags flags = names::NAME, size_t bits = 0, Value alternateValue = 0) const;
 
         //!
         //! Format a name using flags.
@@ -439,46 +529,61 @@ namespace ts {
         static UString Formatted(Value value, const UString& name, names::Flags flags, size_t bits, Value alternateValue = 0);
 
     private:
-        // Description of a configuration entry.
-        // The first value of the range is the key in a map.
-        class ConfigEntry
+        // Structures of the compiled image, defined in the implementation.
+        struct ImageHeader;
+        struct ImageSource;
+        struct ImageEntry;
+
+        // Configuration entries and sections, while loading the configuration files.
+        // The first value of a range is the key in the map of entries.
+        struct LoadEntry
         {
-        public:
             Value   last;   // Last value in the range.
             UString name;   // Associated name.
 
-            ConfigEntry(Value l = 0, const UString& n = UString());
+            LoadEntry() : last(0), name() {}
         };
+        typedef std::map<Value, LoadEntry> LoadEntryMap;
 
-        // Map of configuration entries, indexed by first value of the range.
-        typedef std::map<Value, ConfigEntry*> ConfigEntryMap;
-
-        // Description of a configuration section.
-        // The name of the section is the key in a map.
-        class ConfigSection
+        struct LoadSection
         {
-        public:
-            size_t          bits;     // Number of significant bits in values of the type.
-            ConfigEntryMap  entries;  // All entries, indexed by names.
+            size_t       bits;     // Number of significant bits in values of the type.
+            LoadEntryMap entries;  // All entries, indexed by first value.
 
-            ConfigSection();
-            ~ConfigSection();
+            LoadSection() : bits(0), entries() {}
 
             // Check if a range is free, ie no value is defined in the range.
             bool freeRange(Value first, Value last) const;
-
-            // Add a new entry.
-            void addEntry(Value first, Value last, const UString& name);
-
-            // Get a name from a value, empty if not found.
-            UString getName(Value val) const;
         };
 
-        // Map of configuration sections, indexed by name.
-        typedef std::map<UString, ConfigSection*> ConfigSectionMap;
+        // Map of sections, indexed by lower-case name.
+        typedef std::map<UString, LoadSection> LoadSectionMap;
+
+        // Load a configuration file and merge its content into a map of sections.
+        void loadFile(const UString& fileName, LoadSectionMap& sections);
 
         // Decode a line as "first[-last] = name". Return true on success, false on error.
-        bool decodeDefinition(const UString& line, ConfigSection* section);
+        bool decodeDefinition(const UString& fileName, const UString& line, LoadSection* section);
+
+        // Build the compiled image from loaded sections.
+        void buildImage(const LoadSectionMap& sections, const UStringVector& sources);
+
+        // Check the validity of a compiled image and set the internal pointers.
+        bool setImage(const uint8_t* data, size_t size);
+
+        // Check if the compiled image was built from the current version of some configuration files.
+        bool sameSources(const UStringVector& sources) const;
+
+        // Load or save the cache file.
+        bool loadCache(const UString& cacheFile, const UStringVector& sources);
+        void saveCache(const UString& cacheFile) const;
+        void unmapCache();
+
+        // Get an entry from a value, null if not found.
+        const ImageEntry* getEntry(SectionHandle section, Value value) const;
+
+        // Get the name of an entry, empty if null.
+        UString entryName(const ImageEntry* entry) const;
 
         // Compute a number of hexa digits.
         static int HexaDigits(size_t bits);
@@ -486,14 +591,19 @@ namespace ts {
         // Compute the display mask
         static Value DisplayMask(size_t bits);
 
-        // Load a configuration file and merge its content into this instance.
-        void loadFile(const UString& fileName);
-
         // Names private fields.
-        Report&          _log;           // Error logger.
-        const UString    _configFile;    // Configuration file path.
-        size_t           _configErrors;  // Number of errors in configuration file.
-        ConfigSectionMap _sections;      // Configuration sections.
+        Report&            _log;           // Error logger.
+        const UString      _configFile;    // Configuration file path.
+        size_t             _configErrors;  // Number of errors in configuration file.
+        bool               _fromCache;     // The image was loaded from a cache file.
+        ByteBlock          _image;         // Compiled image, when built or read in memory.
+        void*              _mapAddress;    // Address of mapped cache file, if any.
+        size_t             _mapSize;       // Size of mapped cache file.
+        const ImageHeader* _header;        // Header of the compiled image.
+        const ImageSource* _sources;       // Array of source configuration files.
+        const SectionData* _sections;      // Array of sections, sorted by lower-case names.
+        const ImageEntry*  _entries;       // Array of entries, sorted by section and value ranges.
+        const UChar*       _pool;          // Pool of all strings.
     };
 
     //!
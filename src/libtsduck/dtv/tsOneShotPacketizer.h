@@ -78,6 +78,6 @@ namespace ts {
     private:
         // Hide these methods
         void setStuffingPolicy(StuffingPolicy) = delete;
-        bool getNextPacket(TSPacket&) = delete;
+        using CyclingPacketizer::getNextPacket;
     };
 }
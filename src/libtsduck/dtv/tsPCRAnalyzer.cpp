@@ -61,7 +61,6 @@ ts::PCRAnalyzer::PCRAnalyzer(size_t min_pid, size_t min_pcr) :
     _pid(),
     _packet_pcr_index_map()
 {
-    TS_ZERO(_pid);
 }
 
 
@@ -153,13 +152,7 @@ void ts::PCRAnalyzer::reset()
     _inst_ts_bitrate_188 = 0;
     _inst_ts_bitrate_204 = 0;
 
-    for (size_t i = 0; i < PID_MAX; ++i) {
-        if (_pid[i] != nullptr) {
-            delete _pid[i];
-            _pid[i] = nullptr;
-        }
-    }
-
+    _pid.clear();
     _packet_pcr_index_map.clear();
 }
 
@@ -195,10 +188,8 @@ void ts::PCRAnalyzer::processDiscontinuity()
     _discontinuities++;
 
     // All collected PCR's become invalid since at least one packet is missing.
-    for (size_t i = 0; i < PID_MAX; ++i) {
-        if (_pid[i] != nullptr) {
-            _pid[i]->last_pcr_value = INVALID_PCR;
-        }
+    for (auto it = _pid.begin(); it != _pid.end(); ++it) {
+        it->second.last_pcr_value = INVALID_PCR;
     }
     _packet_pcr_index_map.clear();
 }
@@ -237,14 +228,16 @@ ts::BitRate ts::PCRAnalyzer::instantaneousBitrate204() const
 
 ts::BitRate ts::PCRAnalyzer::bitrate188(PID pid) const
 {
-    return (pid >= PID_MAX || _ts_bitrate_cnt == 0 || _ts_pkt_cnt == 0 || _pid[pid] == nullptr) ? 0 :
-        BitRate((_ts_bitrate_188 * _pid[pid]->ts_pkt_cnt) / (_ts_bitrate_cnt * _ts_pkt_cnt));
+    const auto it = _pid.find(pid);
+    return (_ts_bitrate_cnt == 0 || _ts_pkt_cnt == 0 || it == _pid.end()) ? 0 :
+        BitRate((_ts_bitrate_188 * it->second.ts_pkt_cnt) / (_ts_bitrate_cnt * _ts_pkt_cnt));
 }
 
 ts::BitRate ts::PCRAnalyzer::bitrate204(PID pid) const
 {
-    return (pid >= PID_MAX || _ts_bitrate_cnt == 0 || _ts_pkt_cnt == 0 || _pid[pid] == nullptr) ? 0 :
-        BitRate((_ts_bitrate_204 * _pid[pid]->ts_pkt_cnt) / (_ts_bitrate_cnt * _ts_pkt_cnt));
+    const auto it = _pid.find(pid);
+    return (_ts_bitrate_cnt == 0 || _ts_pkt_cnt == 0 || it == _pid.end()) ? 0 :
+        BitRate((_ts_bitrate_204 * it->second.ts_pkt_cnt) / (_ts_bitrate_cnt * _ts_pkt_cnt));
 }
 
 
@@ -254,7 +247,8 @@ ts::BitRate ts::PCRAnalyzer::bitrate204(PID pid) const
 
 ts::PacketCounter ts::PCRAnalyzer::packetCount(PID pid) const
 {
-    return (pid >= PID_MAX || _pid[pid] == nullptr) ? 0 : _pid[pid]->ts_pkt_cnt;
+    const auto it = _pid.find(pid);
+    return it == _pid.end() ? 0 : it->second.ts_pkt_cnt;
 }
 
 
@@ -296,10 +290,7 @@ bool ts::PCRAnalyzer::feedPacket(const TSPacket& pkt)
     const PID pid = pkt.getPID();
     assert(pid < PID_MAX);
 
-    PIDAnalysis* ps = _pid[pid];
-    if (ps == nullptr) {
-        ps = _pid[pid] = new PIDAnalysis;
-    }
+    PIDAnalysis* const ps = &_pid[pid];
 
     // Count one more packet in the PID
     ps->ts_pkt_cnt++;
@@ -36,6 +36,7 @@
 #include "tsMPEG.h"
 #include "tsTSPacket.h"
 #include "tsStringifyInterface.h"
+#include "tsPIDIndexedMap.h"
 
 namespace ts {
     //!
@@ -231,7 +232,7 @@ namespace ts {
         size_t   _completed_pids;      // Number of PIDs with enough PCRs
         size_t   _pcr_pids;            // Number of PIDs with PCRs
         size_t   _discontinuities;     // Number of discontinuities
-        PIDAnalysis* _pid[PID_MAX];    // Per-PID stats
+        PIDIndexedMap<PIDAnalysis> _pid; // Per-PID stats
         std::map<uint64_t, uint64_t> _packet_pcr_index_map; // Map of PCR/DTS to packet index across entire TS
         static constexpr size_t FOOLPROOF_MAP_LIMIT = 1000; // Max number of entries in the PCR map
     };
@@ -35,6 +35,10 @@
 #include "tsPMT.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::PESDemux::MAX_FREE_BUFFERS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Delimiters
@@ -57,9 +61,13 @@ namespace {
 ts::PESDemux::PESDemux(DuckContext& duck, PESHandlerInterface* pes_handler, const PIDSet& pid_filter) :
     SuperClass(duck, pid_filter),
     _pes_handler(pes_handler),
+    _scatter_mode(false),
     _pids(),
     _stream_types(),
-    _section_demux(_duck, this)
+    _section_demux(_duck, this),
+    _scattered(),
+    _spill_pids(),
+    _free_buffers()
 {
     // Analyze the PAT, to get the PMT's, to get the stream types.
     _section_demux.addPID(PID_PAT);
@@ -85,13 +93,85 @@ ts::PESDemux::PIDContext::PIDContext() :
     sync(false),
     first_pkt(0),
     last_pkt(0),
-    ts(new ByteBlock()),
+    ts(),
     audio(),
     video(),
     avc(),
     ac3(),
-    ac3_count(0)
+    ac3_count(0),
+    size(0),
+    spill_pending(false),
+    spill(),
+    packets()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Called when packet synchronization is lost on the pid.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::syncLost()
+{
+    sync = false;
+    clearData();
+}
+
+
+//----------------------------------------------------------------------------
+// Drop the data of the current PES packet.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::PIDContext::clearData()
+{
+    if (!ts.isNull()) {
+        if (ts.count() > 1) {
+            // The buffer is still referenced by a PESPacket in some handler, leave it there.
+            ts.clear();
+        }
+        else {
+            ts->clear();
+        }
+    }
+    size = 0;
+    packets.clear();
+    spill.clear();
+}
+
+
+//----------------------------------------------------------------------------
+// Management of recycled reassembly buffers.
+//----------------------------------------------------------------------------
+
+ts::ByteBlockPtr ts::PESDemux::getBuffer()
+{
+    if (_free_buffers.empty()) {
+        return ByteBlockPtr(new ByteBlock);
+    }
+    else {
+        ByteBlockPtr bb(_free_buffers.back());
+        _free_buffers.pop_back();
+        return bb;
+    }
+}
+
+void ts::PESDemux::recycleBuffer(ByteBlockPtr& bb)
+{
+    // Recycle the buffer only if it is not referenced by some PESPacket outside the demux.
+    if (!bb.isNull() && bb.count() == 1 && _free_buffers.size() < MAX_FREE_BUFFERS) {
+        bb->clear();
+        _free_buffers.push_back(bb);
+    }
+    bb.clear();
+}
+
+void ts::PESDemux::erasePID(PID pid)
 {
+    const PIDContextMap::iterator pci = _pids.find(pid);
+    if (pci != _pids.end()) {
+        recycleBuffer(pci->second.ts);
+        _pids.erase(pid);
+    }
 }
 
 
@@ -102,7 +182,11 @@ ts::PESDemux::PIDContext::PIDContext() :
 void ts::PESDemux::immediateReset()
 {
     SuperClass::immediateReset();
+    for (auto it = _pids.begin(); it != _pids.end(); ++it) {
+        recycleBuffer(it->second.ts);
+    }
     _pids.clear();
+    _spill_pids.clear();
     _stream_types.clear();
 
     // Reset the section demux back to initial state (intercepting the PAT).
@@ -113,11 +197,29 @@ void ts::PESDemux::immediateReset()
 void ts::PESDemux::immediateResetPID(PID pid)
 {
     SuperClass::immediateResetPID(pid);
-    _pids.erase(pid);
+    erasePID(pid);
     _stream_types.erase(pid);
 }
 
 
+//----------------------------------------------------------------------------
+// Set the PES delivery mode.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::setScatterMode(bool on)
+{
+    if (on != _scatter_mode) {
+        // Drop all partially built PES packets, they use the other representation.
+        for (auto it = _pids.begin(); it != _pids.end(); ++it) {
+            it->second.syncLost();
+            recycleBuffer(it->second.ts);
+        }
+        _spill_pids.clear();
+        _scatter_mode = on;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Get current audio/video attributes on the specified PID.
 // Check isValid() on returned object.
@@ -175,21 +277,35 @@ bool ts::PESDemux::allAC3(PID pid) const
 
 
 //----------------------------------------------------------------------------
-// Feed the demux with a TS packet.
+// Feed the demux with TS packets.
 //----------------------------------------------------------------------------
 
 void ts::PESDemux::feedPacket(const TSPacket& pkt)
 {
-    // Feed the section demux to get the PAT and PMT's.
-    _section_demux.feedPacket(pkt);
+    feedPackets(&pkt, 1);
+}
+
+void ts::PESDemux::feedPackets(const TSPacket* pkts, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const TSPacket& pkt(pkts[i]);
+
+        // Feed the section demux to get the PAT and PMT's.
+        _section_demux.feedPacket(pkt);
+
+        // Process PES data on filtered PID's.
+        if (_pid_filter[pkt.getPID()]) {
+            processPacket(pkt);
+        }
 
-    // Process PES data on filtered PID's.
-    if (_pid_filter[pkt.getPID()]) {
-        processPacket(pkt);
+        // Invoke super class for its own processing.
+        SuperClass::feedPacket(pkt);
     }
 
-    // Invoke super class for its own processing.
-    SuperClass::feedPacket(pkt);
+    // In scatter mode, the caller's packets are no longer valid after this call.
+    if (!_spill_pids.empty()) {
+        spillPackets();
+    }
 }
 
 void ts::PESDemux::processPacket(const TSPacket& pkt)
@@ -223,7 +339,7 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     // for a while => release context.
     if (pkt.getScrambling() != SC_CLEAR) {
         if (pc_exists) {
-            _pids.erase(pid);
+            erasePID(pid);
         }
         return;
     }
@@ -241,13 +357,13 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
             PIDContext& pc(_pids[pid]);
             pc.continuity = pkt.getCC();
             pc.sync = true;
-            pc.ts->copy(pl, pl_size);
+            startPESData(pid, pc, pkt);
             pc.first_pkt = _packet_count;
             pc.last_pkt = _packet_count;
         }
         else if (pc_exists) {
             // This PID does not contain PES packet, reset context
-            _pids.erase(pid);
+            erasePID(pid);
         }
         // PUSI packet processing done.
         return;
@@ -273,6 +389,71 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
     pc.continuity = pkt.getCC();
 
     // Append the TS payload in PID context.
+    addPESData(pid, pc, pkt);
+
+    // Last TS packet containing actual data for this PES packet
+    pc.last_pkt = _packet_count;
+
+    // Check if the complete PES packet is now present (without waiting for the next PUSI).
+    // If the size is zero, the PES packet is "unbounded", meaning it ends at the next PUSI.
+    // But if the PES packet size is specified, check if we have the complete PES packet
+    // (6-byte fixed header, including the length field, followed by the specified size).
+    const size_t len = PESLength(pc);
+    if (len != 0 && pc.dataSize() >= 6 + len) {
+        // We have the complete PES packet.
+        processPESPacket(pid, pc);
+        // Reset PES buffer. Recheck PID context in case it was reset by a handler.
+        pci = _pids.find(pid);
+        if (pci != _pids.end()) {
+            pci->second.clearData();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Start or continue the current PES packet in a context.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::startPESData(PID pid, PIDContext& pc, const TSPacket& pkt)
+{
+    if (_scatter_mode) {
+        // Keep a reference to the TS packet, do not copy the payload.
+        pc.clearData();
+        pc.packets.push_back(&pkt);
+        pc.size = pkt.getPayloadSize();
+        if (!pc.spill_pending) {
+            pc.spill_pending = true;
+            _spill_pids.push_back(pid);
+        }
+    }
+    else {
+        // Use another buffer if the previous one is still referenced outside the demux.
+        if (pc.ts.isNull() || pc.ts.count() > 1) {
+            pc.ts = getBuffer();
+        }
+        pc.ts->copy(pkt.getPayload(), pkt.getPayloadSize());
+    }
+}
+
+void ts::PESDemux::addPESData(PID pid, PIDContext& pc, const TSPacket& pkt)
+{
+    const size_t pl_size = pkt.getPayloadSize();
+
+    if (_scatter_mode) {
+        pc.packets.push_back(&pkt);
+        pc.size += pl_size;
+        if (!pc.spill_pending) {
+            pc.spill_pending = true;
+            _spill_pids.push_back(pid);
+        }
+        return;
+    }
+
+    if (pc.ts.isNull()) {
+        pc.ts = getBuffer();
+    }
+
     size_t capacity = pc.ts->capacity();
     if (pc.ts->size() + pl_size > capacity) {
         // Internal reallocation needed in ts buffer.
@@ -290,24 +471,58 @@ void ts::PESDemux::processPacket(const TSPacket& pkt)
             pc.ts->reserve(2 * capacity);
         }
     }
-    pc.ts->append(pl, pl_size);
+    pc.ts->append(pkt.getPayload(), pl_size);
+}
 
-    // Last TS packet containing actual data for this PES packet
-    pc.last_pkt = _packet_count;
 
-    // Check if the complete PES packet is now present (without waiting for the next PUSI).
-    if (pc.ts->size() >= 6 && pc.sync) {
-        // There is enought to get the PES packet length.
-        const size_t len = GetUInt16(pc.ts->data() + 4);
-        // If the size is zero, the PES packet is "unbounded", meaning it ends at the next PUSI.
-        // But if the PES packet size is specified, check if we have the complete PES packet.
-        if (len != 0 && pc.ts->size() >= 4 + len) {
-            // We have the complete PES packet.
-            processPESPacket(pid, pc);
-            // Reset PES buffer.
-            pc.ts->clear();
+//----------------------------------------------------------------------------
+// Get the PES packet length field, zero if unknown or unbounded.
+//----------------------------------------------------------------------------
+
+size_t ts::PESDemux::PESLength(const PIDContext& pc)
+{
+    if (!pc.sync || pc.dataSize() < 6) {
+        return 0;
+    }
+    else if (!pc.ts.isNull()) {
+        return GetUInt16(pc.ts->data() + 4);
+    }
+    else {
+        // Scatter mode, the length field may span two TS packets in theory.
+        uint8_t header[6];
+        size_t size = 0;
+        for (auto it = pc.packets.begin(); it != pc.packets.end() && size < sizeof(header); ++it) {
+            const size_t chunk = std::min((*it)->getPayloadSize(), sizeof(header) - size);
+            ::memcpy(header + size, (*it)->getPayload(), chunk);
+            size += chunk;
+        }
+        return GetUInt16(header + 4);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Copy the TS packets of incomplete PES packets in scatter mode.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::spillPackets()
+{
+    for (auto pid = _spill_pids.begin(); pid != _spill_pids.end(); ++pid) {
+        const PIDContextMap::iterator pci = _pids.find(*pid);
+        if (pci != _pids.end() && pci->second.spill_pending) {
+            PIDContext& pc(pci->second);
+            pc.spill_pending = false;
+            // The first packets are already in the spill area, copy the new ones.
+            // Then, make all packet references point to the spill area.
+            for (size_t i = pc.spill.size(); i < pc.packets.size(); ++i) {
+                pc.spill.push_back(*pc.packets[i]);
+            }
+            for (size_t i = 0; i < pc.packets.size(); ++i) {
+                pc.packets[i] = &pc.spill[i];
+            }
         }
     }
+    _spill_pids.clear();
 }
 
 
@@ -348,7 +563,7 @@ void ts::PESDemux::handleTable(SectionDemux& demux, const BinaryTable& table)
 
 
 //-----------------------------------------------------------------------------
-// This hook is invoked when a complete PES packet is available.
+// These hooks are invoked when a complete PES packet is available.
 //-----------------------------------------------------------------------------
 
 void ts::PESDemux::handlePESPacket(const PESPacket& packet)
@@ -358,6 +573,13 @@ void ts::PESDemux::handlePESPacket(const PESPacket& packet)
     }
 }
 
+void ts::PESDemux::handleScatteredPESPacket(const ScatteredPESPacket& packet)
+{
+    if (_pes_handler != nullptr) {
+        _pes_handler->handleScatteredPESPacket(*this, packet);
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Process a complete PES packet
@@ -365,6 +587,11 @@ void ts::PESDemux::handlePESPacket(const PESPacket& packet)
 
 void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
 {
+    if (_scatter_mode) {
+        processScatteredPESPacket(pid, pc);
+        return;
+    }
+
     // Build a PES packet object around the TS buffer
     PESPacket pp(pc.ts, pid);
     if (!pp.isValid()) {
@@ -529,3 +756,47 @@ void ts::PESDemux::processPESPacket(PID pid, PIDContext& pc)
     }
     afterCallingHandler(true);
 }
+
+
+//----------------------------------------------------------------------------
+// Process a complete PES packet in scatter mode.
+//----------------------------------------------------------------------------
+
+void ts::PESDemux::processScatteredPESPacket(PID pid, PIDContext& pc)
+{
+    // Build the list of payload slices. Ignore trailing data after a bounded PES packet.
+    const size_t len = PESLength(pc);
+    size_t remain = len == 0 ? pc.size : std::min(pc.size, 6 + len);
+    _scattered.clear();
+    for (auto it = pc.packets.begin(); it != pc.packets.end() && remain > 0; ++it) {
+        const size_t size = std::min((*it)->getPayloadSize(), remain);
+        _scattered.addSlice((*it)->getPayload(), size);
+        remain -= size;
+    }
+    if (!_scattered.isValid()) {
+        return;
+    }
+
+    // Count valid PES packets
+    pc.pes_count++;
+
+    // Description of the PES packet inside the demultiplexed stream
+    _scattered.setSourcePID(pid);
+    _scattered.setFirstTSPacketIndex(pc.first_pkt);
+    _scattered.setLastTSPacketIndex(pc.last_pkt);
+    const StreamTypeMap::const_iterator it = _stream_types.find(pid);
+    if (it != _stream_types.end()) {
+        _scattered.setStreamType(it->second);
+    }
+
+    // Invoke the handler. No content analysis in that mode.
+    beforeCallingHandler(pid);
+    try {
+        handleScatteredPESPacket(_scattered);
+    }
+    catch (...) {
+        afterCallingHandler(false);
+        throw;
+    }
+    afterCallingHandler(true);
+}
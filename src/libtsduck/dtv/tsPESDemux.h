@@ -36,11 +36,14 @@
 #include "tsTimeTrackerDemux.h"
 #include "tsPESPacket.h"
 #include "tsPESHandlerInterface.h"
+#include "tsScatteredPESPacket.h"
+#include "tsTSPacket.h"
 #include "tsAudioAttributes.h"
 #include "tsVideoAttributes.h"
 #include "tsAVCAttributes.h"
 #include "tsAC3Attributes.h"
 #include "tsSectionDemux.h"
+#include "tsPIDIndexedMap.h"
 
 namespace ts {
     //!
@@ -72,6 +75,37 @@ namespace ts {
         // Inherited methods
         virtual void feedPacket(const TSPacket& pkt) override;
 
+        //!
+        //! Feed the demux with a batch of consecutive TS packets.
+        //! In scatter mode, the PES packets which are completed inside the batch
+        //! reference the TS packets of the batch without copy. The TS payloads of
+        //! PES packets which are still incomplete at the end of the batch are
+        //! copied in the demux. Using large batches therefore minimizes copies.
+        //! @param [in] pkts Address of the first TS packet.
+        //! @param [in] count Number of TS packets.
+        //!
+        void feedPackets(const TSPacket* pkts, size_t count);
+
+        //!
+        //! Set the PES delivery mode.
+        //! In scatter mode, complete PES packets are passed to the handler as a list of slices
+        //! in the original TS packets, without reassembly in contiguous memory, using
+        //! PESHandlerInterface::handleScatteredPESPacket(). The other hooks of the handler are
+        //! not invoked and the audio and video attributes are not analyzed in that mode.
+        //! The partially built PES packets are dropped when the mode changes.
+        //! @param [in] on True to deliver scattered PES packets, false to deliver contiguous PES packets (the default).
+        //!
+        void setScatterMode(bool on);
+
+        //!
+        //! Check if the PES delivery mode is the scatter mode.
+        //! @return True if the PES packets are delivered as scattered PES packets.
+        //!
+        bool scatterMode() const
+        {
+            return _scatter_mode;
+        }
+
         //!
         //! Replace the PES packet handler.
         //! @param [in] h The object to invoke when PES packets are analyzed.
@@ -132,6 +166,13 @@ namespace ts {
         //!
         virtual void handlePESPacket(const PESPacket& packet);
 
+        //!
+        //! This hook is invoked when a complete PES packet is available in scatter mode.
+        //! Can be overloaded by subclasses to add intermediate processing.
+        //! @param [in] packet The scattered PES packet.
+        //!
+        virtual void handleScatteredPESPacket(const ScatteredPESPacket& packet);
+
         // Inherited methods
         virtual void immediateReset() override;
         virtual void immediateResetPID(PID pid) override;
@@ -151,17 +192,27 @@ namespace ts {
             AVCAttributes   avc;         // Current AVC attributes
             AC3Attributes   ac3;         // Current AC-3 attributes
             PacketCounter   ac3_count;   // Number of PES packets with contents which looks like AC-3
+            size_t          size;        // Scatter mode: accumulated payload size
+            bool            spill_pending; // Scatter mode: some packets are not yet copied in spill
+            TSPacketVector  spill;       // Scatter mode: copies of the first packets, from previous batches
+            std::vector<const TSPacket*> packets;  // Scatter mode: TS packets of current PES packet
 
             // Default constructor:
             PIDContext();
 
             // Called when packet synchronization is lost on the pid
-            void syncLost() {sync = false; ts->clear();}
+            void syncLost();
+
+            // Drop the data of the current PES packet.
+            void clearData();
+
+            // Size of the current PES data.
+            size_t dataSize() const { return ts.isNull() ? size : ts->size(); }
         };
 
         // Map of PID contexts, indexed by PID.
         // One context is created per demuxed PES PID.
-        typedef std::map<PID,PIDContext> PIDContextMap;
+        typedef PIDIndexedMap<PIDContext> PIDContextMap;
 
         // Map of stream types (from PMT), indexed by PID.
         // All known PID's are referenced here, not only demuxed PES PID's.
@@ -170,16 +221,39 @@ namespace ts {
         // Feed the demux with a TS packet (PID already filtered).
         void processPacket(const TSPacket&);
 
+        // Start or continue the current PES packet in a context.
+        void startPESData(PID, PIDContext&, const TSPacket&);
+        void addPESData(PID, PIDContext&, const TSPacket&);
+
+        // Get the PES packet length field, zero if unknown or unbounded.
+        static size_t PESLength(const PIDContext&);
+
         // Process a complete PES packet
         void processPESPacket(PID, PIDContext&);
+        void processScatteredPESPacket(PID, PIDContext&);
+
+        // Copy the TS packets of incomplete PES packets in scatter mode at end of batch.
+        void spillPackets();
+
+        // Management of recycled reassembly buffers.
+        ByteBlockPtr getBuffer();
+        void recycleBuffer(ByteBlockPtr&);
+        void erasePID(PID);
 
         // Implementation of TableHandlerInterface.
         virtual void handleTable(SectionDemux& demux, const BinaryTable& table) override;
 
         // Private members:
-        PESHandlerInterface* _pes_handler;
-        PIDContextMap        _pids;
-        StreamTypeMap        _stream_types;
-        SectionDemux         _section_demux;
+        PESHandlerInterface*      _pes_handler;
+        bool                      _scatter_mode;
+        PIDContextMap             _pids;
+        StreamTypeMap             _stream_types;
+        SectionDemux              _section_demux;
+        ScatteredPESPacket        _scattered;     // Scatter mode: reused description of PES packets
+        std::vector<PID>          _spill_pids;    // Scatter mode: PID's with packets to spill at end of batch
+        std::vector<ByteBlockPtr> _free_buffers;  // Recycled reassembly buffers
+
+        // Maximum number of recycled reassembly buffers.
+        static constexpr size_t MAX_FREE_BUFFERS = 8;
     };
 }
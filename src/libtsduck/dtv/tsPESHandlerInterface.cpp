@@ -36,6 +36,10 @@ void ts::PESHandlerInterface::handlePESPacket(PESDemux& demux, const PESPacket&
 {
 }
 
+void ts::PESHandlerInterface::handleScatteredPESPacket(PESDemux& demux, const ScatteredPESPacket& packet)
+{
+}
+
 void ts::PESHandlerInterface::handleVideoStartCode(PESDemux& demux, const PESPacket& packet, uint8_t start_code, size_t offset, size_t size)
 {
 }
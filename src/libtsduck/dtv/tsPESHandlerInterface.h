@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tsPESPacket.h"
+#include "tsScatteredPESPacket.h"
 #include "tsAudioAttributes.h"
 #include "tsVideoAttributes.h"
 #include "tsAVCAttributes.h"
@@ -58,6 +59,16 @@ namespace ts {
         //!
         virtual void handlePESPacket(PESDemux& demux, const PESPacket& packet);
 
+        //!
+        //! This hook is invoked when a complete PES packet is available and the demux is in scatter mode.
+        //! In scatter mode, handlePESPacket() and the analysis hooks are not invoked.
+        //! @param [in,out] demux A reference to the PES demux.
+        //! @param [in] packet The demultiplexed PES packet as a list of slices in the TS packets.
+        //! The slices are valid only during the execution of the hook.
+        //! @see PESDemux::setScatterMode()
+        //!
+        virtual void handleScatteredPESPacket(PESDemux& demux, const ScatteredPESPacket& packet);
+
         //!
         //! This hook is invoked when a video start code is encountered.
         //! @param [in,out] demux A reference to the PES demux.
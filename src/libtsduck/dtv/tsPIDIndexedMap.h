@@ -0,0 +1,228 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  A map of contexts which is directly indexed by PID.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+
+namespace ts {
+    //!
+    //! A map of contexts which is directly indexed by PID.
+    //! @ingroup mpeg
+    //!
+    //! This container is a replacement for @c std::map<PID,T> in packet processing
+    //! paths. The lookup of a PID is one array index instead of a tree walk.
+    //! The contexts are allocated on demand. The interface is a subset of the
+    //! interface of @c std::map and the iteration order is the same, by increasing
+    //! PID value. Iterating over the map is slower than iterating over a std::map
+    //! when there are few PID's, this is not the intended usage in packet processing.
+    //!
+    //! As with @c std::map, a reference to an element remains valid until the element
+    //! is erased. Only the iterators to an erased element are invalidated.
+    //!
+    //! @tparam T The type of the PID contexts. It must be default-constructible.
+    //!
+    template <typename T>
+    class PIDIndexedMap
+    {
+    public:
+        typedef PID key_type;                         //!< Type of the map key, always a PID.
+        typedef T mapped_type;                        //!< Type of the PID contexts.
+        typedef std::pair<const PID, T> value_type;   //!< Type of the map elements, as in std::map.
+        typedef size_t size_type;                     //!< Type for sizes.
+
+    private:
+        typedef std::vector<value_type*> EntryVector;
+
+        // Common implementation of iterator and const_iterator.
+        template <typename VALUE>
+        class Iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef VALUE value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef VALUE* pointer;
+            typedef VALUE& reference;
+
+            Iterator() : _entries(nullptr), _index(PID_MAX) {}
+            Iterator(const EntryVector* entries, size_t index) : _entries(entries), _index(index) { skip(); }
+            // Conversion from iterator to const_iterator only.
+            template <typename V2, typename std::enable_if<std::is_same<const V2, VALUE>::value && !std::is_same<V2, VALUE>::value>::type* = nullptr>
+            Iterator(const Iterator<V2>& other) : _entries(other._entries), _index(other._index) {}
+
+            reference operator*() const { return *(*_entries)[_index]; }
+            pointer operator->() const { return (*_entries)[_index]; }
+            Iterator& operator++() { ++_index; skip(); return *this; }
+            Iterator operator++(int) { Iterator tmp(*this); ++*this; return tmp; }
+            bool operator==(const Iterator& other) const { return _index == other._index; }
+            bool operator!=(const Iterator& other) const { return _index != other._index; }
+
+        private:
+            template <typename V2> friend class Iterator;
+            friend class PIDIndexedMap;
+            const EntryVector* _entries;
+            size_t _index;
+
+            // Move to the next used entry, starting at the current one.
+            void skip() { while (_index < PID_MAX && (*_entries)[_index] == nullptr) { ++_index; } }
+        };
+
+    public:
+        typedef Iterator<value_type> iterator;              //!< Iterator, by increasing PID value.
+        typedef Iterator<const value_type> const_iterator;  //!< Constant iterator, by increasing PID value.
+
+        //!
+        //! Default constructor, build an empty map.
+        //!
+        PIDIndexedMap() : _count(0), _entries(PID_MAX, nullptr) {}
+
+        //!
+        //! Copy constructor. The contexts are duplicated.
+        //! @param [in] other Another instance to copy.
+        //!
+        PIDIndexedMap(const PIDIndexedMap& other);
+
+        //!
+        //! Destructor.
+        //!
+        ~PIDIndexedMap() { clear(); }
+
+        //!
+        //! Assignment operator. The contexts are duplicated.
+        //! @param [in] other Another instance to copy.
+        //! @return A reference to this object.
+        //!
+        PIDIndexedMap& operator=(const PIDIndexedMap& other);
+
+        //!
+        //! Access or create the context of a PID.
+        //! @param [in] pid A PID value. Must be less than PID_MAX.
+        //! @return A reference to the context of @a pid. A default context is created if it did not exist.
+        //!
+        T& operator[](PID pid)
+        {
+            assert(pid < PID_MAX);
+            value_type* entry = _entries[pid];
+            return entry != nullptr ? entry->second : create(pid);
+        }
+
+        //!
+        //! Find the context of a PID.
+        //! @param [in] pid A PID value.
+        //! @return An iterator to the context of @a pid or end() if it does not exist.
+        //!
+        iterator find(PID pid) { return exists(pid) ? iterator(&_entries, pid) : end(); }
+
+        //!
+        //! Find the context of a PID.
+        //! @param [in] pid A PID value.
+        //! @return A constant iterator to the context of @a pid or end() if it does not exist.
+        //!
+        const_iterator find(PID pid) const { return exists(pid) ? const_iterator(&_entries, pid) : end(); }
+
+        //!
+        //! Count the number of contexts for a PID.
+        //! @param [in] pid A PID value.
+        //! @return 1 if the context of @a pid exists, 0 otherwise.
+        //!
+        size_type count(PID pid) const { return exists(pid) ? 1 : 0; }
+
+        //!
+        //! Erase the context of a PID.
+        //! @param [in] pid A PID value.
+        //! @return The number of erased contexts, 1 or 0.
+        //!
+        size_type erase(PID pid);
+
+        //!
+        //! Erase the context at a given position.
+        //! @param [in] pos Iterator to an existing context.
+        //! @return An iterator to the next context.
+        //!
+        iterator erase(const_iterator pos);
+
+        //!
+        //! Erase all contexts.
+        //!
+        void clear();
+
+        //!
+        //! Get the number of contexts in the map.
+        //! @return The number of contexts in the map.
+        //!
+        size_type size() const { return _count; }
+
+        //!
+        //! Check if the map is empty.
+        //! @return True if the map is empty.
+        //!
+        bool empty() const { return _count == 0; }
+
+        //!
+        //! Get an iterator to the first context.
+        //! @return An iterator to the first context, by increasing PID value.
+        //!
+        iterator begin() { return iterator(&_entries, _count == 0 ? PID_MAX : 0); }
+
+        //!
+        //! Get an iterator after the last context.
+        //! @return An iterator after the last context.
+        //!
+        iterator end() { return iterator(&_entries, PID_MAX); }
+
+        //!
+        //! Get a constant iterator to the first context.
+        //! @return A constant iterator to the first context, by increasing PID value.
+        //!
+        const_iterator begin() const { return const_iterator(&_entries, _count == 0 ? PID_MAX : 0); }
+
+        //!
+        //! Get a constant iterator after the last context.
+        //! @return A constant iterator after the last context.
+        //!
+        const_iterator end() const { return const_iterator(&_entries, PID_MAX); }
+
+    private:
+        size_t      _count;    // Number of contexts.
+        EntryVector _entries;  // Contexts, indexed by PID, null when unused.
+
+        // Check if a PID context exists.
+        bool exists(PID pid) const { return pid < PID_MAX && _entries[pid] != nullptr; }
+
+        // Create a new context.
+        T& create(PID pid);
+    };
+}
+
+#include "tsPIDIndexedMapTemplate.h"
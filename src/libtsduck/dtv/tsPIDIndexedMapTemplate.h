@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#pragma once
+
+
+//----------------------------------------------------------------------------
+// Copy constructor and assignment.
+//----------------------------------------------------------------------------
+
+template <typename T>
+ts::PIDIndexedMap<T>::PIDIndexedMap(const PIDIndexedMap& other) :
+    _count(0),
+    _entries(PID_MAX, nullptr)
+{
+    *this = other;
+}
+
+template <typename T>
+ts::PIDIndexedMap<T>& ts::PIDIndexedMap<T>::operator=(const PIDIndexedMap& other)
+{
+    if (&other != this) {
+        clear();
+        for (size_t pid = 0; pid < PID_MAX; ++pid) {
+            if (other._entries[pid] != nullptr) {
+                _entries[pid] = new value_type(*other._entries[pid]);
+                _count++;
+            }
+        }
+    }
+    return *this;
+}
+
+
+//----------------------------------------------------------------------------
+// Create a new context.
+//----------------------------------------------------------------------------
+
+template <typename T>
+T& ts::PIDIndexedMap<T>::create(PID pid)
+{
+    value_type* entry = new value_type(std::piecewise_construct, std::forward_as_tuple(pid), std::forward_as_tuple());
+    _entries[pid] = entry;
+    _count++;
+    return entry->second;
+}
+
+
+//----------------------------------------------------------------------------
+// Erase contexts.
+//----------------------------------------------------------------------------
+
+template <typename T>
+typename ts::PIDIndexedMap<T>::size_type ts::PIDIndexedMap<T>::erase(PID pid)
+{
+    if (exists(pid)) {
+        delete _entries[pid];
+        _entries[pid] = nullptr;
+        _count--;
+        return 1;
+    }
+    else {
+        return 0;
+    }
+}
+
+template <typename T>
+typename ts::PIDIndexedMap<T>::iterator ts::PIDIndexedMap<T>::erase(const_iterator pos)
+{
+    const size_t index = pos._index;
+    erase(PID(index));
+    return iterator(&_entries, index);
+}
+
+template <typename T>
+void ts::PIDIndexedMap<T>::clear()
+{
+    for (size_t pid = 0; _count > 0 && pid < PID_MAX; ++pid) {
+        if (_entries[pid] != nullptr) {
+            delete _entries[pid];
+            _entries[pid] = nullptr;
+            _count--;
+        }
+    }
+}
@@ -64,9 +64,12 @@ ts::PSILogger::PSILogger(TablesDisplay& display) :
     _received_pmt(0),
     _clear_packets_cnt(0),
     _scrambled_packets_cnt(0),
+    _closed(true),
+    _pool(),
     _demux(_duck, this, _dump ? this : nullptr),
     _standards(STD_NONE)
 {
+    _demux.setSectionPool(&_pool);
 }
 
 ts::PSILogger::~PSILogger()
@@ -143,6 +146,7 @@ bool ts::PSILogger::open()
     }
 
     // Specify the PID filters
+    _closed = false;
     _demux.reset();
     if (!_cat_only) {
         _demux.addPID(PID_PAT);   // MPEG
@@ -167,6 +171,11 @@ bool ts::PSILogger::open()
 
 void ts::PSILogger::close()
 {
+    if (!_closed) {
+        _closed = true;
+        _duck.report().debug(u"sections: %'d created, %'d buffers allocated, %'d allocated and %'d recycled from pool",
+                             {Section::InstanceCount(), Section::BufferCount(), _pool.allocatedCount(), _pool.recycledCount()});
+    }
 }
 
 
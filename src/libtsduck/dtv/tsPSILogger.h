@@ -127,6 +127,8 @@ namespace ts {
         int              _received_pmt;  // Received PMT count
         PacketCounter    _clear_packets_cnt;
         PacketCounter    _scrambled_packets_cnt;
+        bool             _closed;        // Logger is closed, allocation statistics reported.
+        SectionPool      _pool;          // Pool of recycled sections for the demux.
         SectionDemux     _demux;         // Demux reporting PSI tables.
         Standards        _standards;     // List of current standards in the PSI logger.
 
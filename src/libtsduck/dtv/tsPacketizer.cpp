@@ -70,6 +70,18 @@ void ts::Packetizer::reset()
 }
 
 
+//----------------------------------------------------------------------------
+// Force the values of the packet and section counters.
+//----------------------------------------------------------------------------
+
+void ts::Packetizer::setCounters(PacketCounter packets, SectionCounter sections_in, SectionCounter sections_out)
+{
+    _packet_count = packets;
+    _section_in_count = sections_in;
+    _section_out_count = sections_out;
+}
+
+
 //----------------------------------------------------------------------------
 // Build the next MPEG packet for the list of sections.
 //----------------------------------------------------------------------------
@@ -140,7 +140,7 @@ namespace ts {
         //! @param [out] packet The next TS packet.
         //! @return True if a real packet is returned, false if a null packet was returned.
         //!
-        bool getNextPacket(TSPacket& packet);
+        virtual bool getNextPacket(TSPacket& packet);
 
         //!
         //! Get the number of generated packets so far.
@@ -187,6 +187,25 @@ namespace ts {
         // Protected directly accessible to subclasses.
         const DuckContext& _duck;  //!< The TSDuck execution context is accessible to all subclasses.
 
+        //!
+        //! Get the number of sections which were provided so far.
+        //! @return The number of sections which were provided so far.
+        //!
+        SectionCounter providedSectionCount() const
+        {
+            return _section_in_count;
+        }
+
+        //!
+        //! Force the values of the packet and section counters.
+        //! This is used by subclasses which return packets without building them
+        //! in Packetizer::getNextPacket(), for instance from a cache of packets.
+        //! @param [in] packets Number of generated packets.
+        //! @param [in] sections_in Number of provided sections.
+        //! @param [in] sections_out Number of completely packetized sections.
+        //!
+        void setCounters(PacketCounter packets, SectionCounter sections_in, SectionCounter sections_out);
+
     private:
         SectionProviderInterface* _provider;
         Report&        _report;            // Report object for debug.
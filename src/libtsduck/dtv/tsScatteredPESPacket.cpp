@@ -0,0 +1,164 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsScatteredPESPacket.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::ScatteredPESPacket::ScatteredPESPacket(PID source_pid) :
+    _slices(),
+    _size(0),
+    _source_pid(source_pid),
+    _stream_type(ST_NULL),
+    _first_pkt(0),
+    _last_pkt(0)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Clear the list of slices and the packet description.
+//----------------------------------------------------------------------------
+
+void ts::ScatteredPESPacket::clear()
+{
+    _slices.clear();
+    _size = 0;
+    _source_pid = PID_NULL;
+    _stream_type = ST_NULL;
+    _first_pkt = 0;
+    _last_pkt = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Append a slice at the end of the PES packet.
+//----------------------------------------------------------------------------
+
+void ts::ScatteredPESPacket::addSlice(const uint8_t* data, size_t size)
+{
+    if (data != nullptr && size > 0) {
+        _slices.push_back(Slice(data, size));
+        _size += size;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Copy part of the PES packet into a contiguous buffer.
+//----------------------------------------------------------------------------
+
+size_t ts::ScatteredPESPacket::read(size_t offset, void* buffer, size_t size) const
+{
+    uint8_t* out = reinterpret_cast<uint8_t*>(buffer);
+    size_t done = 0;
+
+    for (auto it = _slices.begin(); it != _slices.end() && done < size; ++it) {
+        if (offset >= it->size) {
+            // Read area starts after this slice.
+            offset -= it->size;
+        }
+        else {
+            const size_t chunk = std::min(it->size - offset, size - done);
+            ::memcpy(out + done, it->data + offset, chunk);
+            done += chunk;
+            offset = 0;
+        }
+    }
+    return done;
+}
+
+
+//----------------------------------------------------------------------------
+// Size of the PES packet header, using the same checks as PESPacket.
+//----------------------------------------------------------------------------
+
+size_t ts::ScatteredPESPacket::headerSize() const
+{
+    // Read the start of the fixed and optional headers.
+    uint8_t header[9];
+    const size_t size = read(0, header, sizeof(header));
+
+    // Check start code prefix: 00 00 01
+    if (size < 6 || header[0] != 0 || header[1] != 0 || header[2] != 1) {
+        return 0;
+    }
+    else if (!IsLongHeaderSID(header[3])) {
+        // No additional header fields
+        return 6;
+    }
+    else if (size < 9 || _size < 9 + size_t(header[8])) {
+        return 0;
+    }
+    else {
+        return 9 + size_t(header[8]);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get the stream id of the PES packet.
+//----------------------------------------------------------------------------
+
+uint8_t ts::ScatteredPESPacket::getStreamId() const
+{
+    uint8_t sid = 0;
+    read(3, &sid, 1);
+    return sid;
+}
+
+
+//----------------------------------------------------------------------------
+// Build a contiguous copy of the PES packet.
+//----------------------------------------------------------------------------
+
+void ts::ScatteredPESPacket::getContent(ByteBlock& content) const
+{
+    content.resize(_size);
+    size_t offset = 0;
+    for (auto it = _slices.begin(); it != _slices.end(); ++it) {
+        ::memcpy(content.data() + offset, it->data, it->size);
+        offset += it->size;
+    }
+}
+
+bool ts::ScatteredPESPacket::getPESPacket(PESPacket& packet) const
+{
+    ByteBlockPtr content(new ByteBlock);
+    getContent(*content);
+    packet.reload(content, _source_pid);
+    packet.setStreamType(_stream_type);
+    packet.setFirstTSPacketIndex(_first_pkt);
+    packet.setLastTSPacketIndex(_last_pkt);
+    return packet.isValid();
+}
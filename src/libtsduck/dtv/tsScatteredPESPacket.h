@@ -0,0 +1,241 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Representation of a PES packet as a list of slices in TS packets.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPESPacket.h"
+
+namespace ts {
+    //!
+    //! Representation of a PES packet as a scatter list of slices in TS packets.
+    //! @ingroup mpeg
+    //!
+    //! A scattered PES packet does not own its content. Each slice points to the
+    //! payload of a TS packet which was used to build the PES packet. This is the
+    //! form used by a PESDemux in scatter mode to avoid copying TS payloads.
+    //! The slices are valid only as long as the TS packets they point to.
+    //! A contiguous copy of the PES packet can be built on demand using
+    //! getContent() or getPESPacket().
+    //!
+    class TSDUCKDLL ScatteredPESPacket
+    {
+    public:
+        //!
+        //! Description of one contiguous slice of the PES packet.
+        //!
+        struct TSDUCKDLL Slice
+        {
+            const uint8_t* data;  //!< Address of the slice.
+            size_t         size;  //!< Size in bytes of the slice.
+
+            //!
+            //! Constructor.
+            //! @param [in] d Address of the slice.
+            //! @param [in] s Size in bytes of the slice.
+            //!
+            Slice(const uint8_t* d = nullptr, size_t s = 0) : data(d), size(s) {}
+            //! @cond nodoxygen
+            Slice(const Slice&) = default;
+            Slice& operator=(const Slice&) = default;
+            //! @endcond
+        };
+
+        //!
+        //! Vector of slices.
+        //!
+        typedef std::vector<Slice> SliceVector;
+
+        //!
+        //! Default constructor.
+        //! @param [in] source_pid PID from which the packet was read.
+        //!
+        ScatteredPESPacket(PID source_pid = PID_NULL);
+
+        //!
+        //! Clear the list of slices and the packet description.
+        //! The allocated capacity of the list of slices is preserved.
+        //!
+        void clear();
+
+        //!
+        //! Append a slice at the end of the PES packet.
+        //! The content is not copied, the memory area must remain valid while the slice is used.
+        //! @param [in] data Address of the slice.
+        //! @param [in] size Size in bytes of the slice.
+        //!
+        void addSlice(const uint8_t* data, size_t size);
+
+        //!
+        //! Get the list of slices of the PES packet.
+        //! @return A constant reference to the list of slices.
+        //!
+        const SliceVector& slices() const
+        {
+            return _slices;
+        }
+
+        //!
+        //! Get the total size of the PES packet.
+        //! @return The total size in bytes of the PES packet.
+        //!
+        size_t size() const
+        {
+            return _size;
+        }
+
+        //!
+        //! Copy part of the PES packet into a contiguous buffer.
+        //! @param [in] offset Offset in the PES packet of the first byte to read.
+        //! @param [out] buffer Address of the returned data.
+        //! @param [in] size Maximum number of bytes to read.
+        //! @return The number of copied bytes, less than @a size if the end of the packet is reached.
+        //!
+        size_t read(size_t offset, void* buffer, size_t size) const;
+
+        //!
+        //! Check if the PES packet has a valid header.
+        //! @return True if the start code prefix is valid and the header is complete.
+        //!
+        bool isValid() const
+        {
+            return headerSize() > 0;
+        }
+
+        //!
+        //! Size of the PES packet header.
+        //! @return The size of the PES packet header in bytes or zero if the header is invalid.
+        //!
+        size_t headerSize() const;
+
+        //!
+        //! Get the stream id of the PES packet.
+        //! @return The stream id of the PES packet or zero if the packet is too short.
+        //!
+        uint8_t getStreamId() const;
+
+        //!
+        //! Get the source PID.
+        //! @return The source PID.
+        //!
+        PID getSourcePID() const
+        {
+            return _source_pid;
+        }
+
+        //!
+        //! Set the source PID.
+        //! @param [in] pid The source PID.
+        //!
+        void setSourcePID(PID pid)
+        {
+            _source_pid = pid;
+        }
+
+        //!
+        //! Get the stream type, as specified in the PMT (optional).
+        //! @return The stream type.
+        //!
+        uint8_t getStreamType() const
+        {
+            return _stream_type;
+        }
+
+        //!
+        //! Set the stream type, as specified in the PMT.
+        //! @param [in] type The stream type.
+        //!
+        void setStreamType(uint8_t type)
+        {
+            _stream_type = type;
+        }
+
+        //!
+        //! Index of first TS packet of the PES packet in the demultiplexed stream.
+        //! @return The first TS packet of the PES packet in the demultiplexed stream.
+        //!
+        PacketCounter getFirstTSPacketIndex() const
+        {
+            return _first_pkt;
+        }
+
+        //!
+        //! Index of last TS packet of the PES packet in the demultiplexed stream.
+        //! @return The last TS packet of the PES packet in the demultiplexed stream.
+        //!
+        PacketCounter getLastTSPacketIndex() const
+        {
+            return _last_pkt;
+        }
+
+        //!
+        //! Set the first TS packet of the PES packet in the demultiplexed stream.
+        //! @param [in] i The first TS packet of the PES packet in the demultiplexed stream.
+        //!
+        void setFirstTSPacketIndex(PacketCounter i)
+        {
+            _first_pkt = i;
+        }
+
+        //!
+        //! Set the last TS packet of the PES packet in the demultiplexed stream.
+        //! @param [in] i The last TS packet of the PES packet in the demultiplexed stream.
+        //!
+        void setLastTSPacketIndex(PacketCounter i)
+        {
+            _last_pkt = i;
+        }
+
+        //!
+        //! Build a contiguous copy of the complete PES packet.
+        //! @param [out] content The binary content of the PES packet. Its allocated
+        //! capacity is reused, making it possible to recycle the same buffer.
+        //!
+        void getContent(ByteBlock& content) const;
+
+        //!
+        //! Build a contiguous PESPacket object from the scattered PES packet.
+        //! @param [out] packet The returned PES packet. Its source PID, stream type
+        //! and TS packet indexes are copied from this object.
+        //! @return True if @a packet is valid, false otherwise.
+        //!
+        bool getPESPacket(PESPacket& packet) const;
+
+    private:
+        SliceVector   _slices;       // List of content slices.
+        size_t        _size;         // Total size in bytes.
+        PID           _source_pid;   // Source PID (informational).
+        uint8_t       _stream_type;  // Stream type from PMT (informational).
+        PacketCounter _first_pkt;    // Index of first packet in demultiplexed stream.
+        PacketCounter _last_pkt;     // Index of last packet in demultiplexed stream.
+    };
+}
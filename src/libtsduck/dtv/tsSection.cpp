@@ -34,8 +34,15 @@
 #include "tsNames.h"
 #include "tsMemory.h"
 #include "tsReportWithPrefix.h"
+#include <atomic>
 TSDUCK_SOURCE;
 
+// Instrumentation counters.
+namespace {
+    std::atomic<uint64_t> InstanceCounter(0);
+    std::atomic<uint64_t> BufferCounter(0);
+}
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -48,6 +55,7 @@ ts::Section::Section() :
     _last_pkt(0),
     _data()
 {
+    InstanceCounter++;
 }
 
 
@@ -62,12 +70,13 @@ ts::Section::Section(const Section& sect, CopyShare mode) :
     _last_pkt(sect._last_pkt),
     _data()
 {
+    InstanceCounter++;
     switch (mode) {
         case SHARE:
             _data = sect._data;
             break;
         case COPY:
-            _data = sect._is_valid ? new ByteBlock (*sect._data) : nullptr;
+            _data = sect._is_valid ? newBuffer(sect._data->data(), sect._data->size()) : nullptr;
             break;
         default:
             // should not get there
@@ -90,7 +99,8 @@ ts::Section::Section(const void* content,
     _last_pkt(0),
     _data()
 {
-    initialize(new ByteBlock(content, content_size), source_pid, crc_op);
+    InstanceCounter++;
+    initialize(newBuffer(content, content_size), source_pid, crc_op);
 }
 
 
@@ -107,7 +117,8 @@ ts::Section::Section(const ByteBlock& content,
     _last_pkt(0),
     _data()
 {
-    initialize(new ByteBlock(content), source_pid, crc_op);
+    InstanceCounter++;
+    initialize(newBuffer(content.data(), content.size()), source_pid, crc_op);
 }
 
 
@@ -124,6 +135,7 @@ ts::Section::Section(const ByteBlockPtr& content_ptr,
     _last_pkt(0),
     _data()
 {
+    InstanceCounter++;
     initialize(content_ptr, source_pid, crc_op);
 }
 
@@ -143,6 +155,7 @@ ts::Section::Section(TID tid,
     _last_pkt(0),
     _data()
 {
+    InstanceCounter++;
     reload(tid, is_private_section, payload, payload_size, source_pid);
 }
 
@@ -167,12 +180,28 @@ ts::Section::Section(TID tid,
     _last_pkt(0),
     _data()
 {
+    InstanceCounter++;
     reload(tid, is_private_section, tid_ext, version, is_current,
            section_number, last_section_number,
            payload, payload_size, source_pid);
 }
 
 
+//----------------------------------------------------------------------------
+// Reload from full binary content.
+//----------------------------------------------------------------------------
+
+void ts::Section::reload(const void* content, size_t content_size, PID source_pid, CRC32::Validation crc_op)
+{
+    initialize(newBuffer(content, content_size), source_pid, crc_op);
+}
+
+void ts::Section::reload(const ByteBlock& content, PID source_pid, CRC32::Validation crc_op)
+{
+    initialize(newBuffer(content.data(), content.size()), source_pid, crc_op);
+}
+
+
 //----------------------------------------------------------------------------
 // Reload short section
 //----------------------------------------------------------------------------
@@ -183,9 +212,10 @@ void ts::Section::reload(TID tid,
                          size_t payload_size,
                          PID source_pid)
 {
+    ByteBlockPtr data(newBuffer(nullptr, SHORT_SECTION_HEADER_SIZE + payload_size));
     initialize(source_pid);
     _is_valid = SHORT_SECTION_HEADER_SIZE + payload_size <= MAX_PRIVATE_SECTION_SIZE;
-    _data = new ByteBlock(SHORT_SECTION_HEADER_SIZE + payload_size);
+    _data = data;
     PutUInt8(_data->data(), tid);
     PutUInt16(_data->data() + 1, (is_private_section ? 0x4000 : 0x0000) | 0x3000 | uint16_t (payload_size & 0x0FFF));
     ::memcpy(_data->data() + 3, payload, payload_size);  // Flawfinder: ignore: memcpy()
@@ -209,10 +239,11 @@ void ts::Section::reload(TID tid,
                          size_t payload_size,
                          PID source_pid)
 {
-    initialize (source_pid);
+    ByteBlockPtr data(newBuffer(nullptr, LONG_SECTION_HEADER_SIZE + payload_size + SECTION_CRC32_SIZE));
+    initialize(source_pid);
     _is_valid = section_number <= last_section_number && version <= 31 &&
         LONG_SECTION_HEADER_SIZE + payload_size + SECTION_CRC32_SIZE <= MAX_PRIVATE_SECTION_SIZE;
-    _data = new ByteBlock(LONG_SECTION_HEADER_SIZE + payload_size + SECTION_CRC32_SIZE);
+    _data = data;
     PutUInt8(_data->data(), tid);
     PutUInt16(_data->data() + 1,
               0x8000 | (is_private_section ? 0x4000 : 0x0000) | 0x3000 |
@@ -240,6 +271,50 @@ void ts::Section::initialize(PID pid)
 }
 
 
+//----------------------------------------------------------------------------
+// Private method: Get a content buffer, reuse the current one when possible.
+//----------------------------------------------------------------------------
+
+ts::ByteBlockPtr ts::Section::newBuffer(const void* content, size_t size)
+{
+    const uint8_t* const addr = reinterpret_cast<const uint8_t*>(content);
+    ByteBlockPtr bbp;
+
+    // The current buffer is reused when it is not shared with another section
+    // and when it does not contain the new content.
+    if (!_data.isNull() && _data.count() == 1 &&
+        (addr == nullptr || addr + size <= _data->data() || addr >= _data->data() + _data->size()))
+    {
+        bbp = _data;
+        bbp->resize(size);
+    }
+    else {
+        bbp = new ByteBlock(size);
+        CheckNonNull(bbp.pointer());
+        BufferCounter++;
+    }
+    if (addr != nullptr && size > 0) {
+        ::memcpy(bbp->data(), addr, size);  // Flawfinder: ignore: memcpy()
+    }
+    return bbp;
+}
+
+
+//----------------------------------------------------------------------------
+// Instrumentation counters.
+//----------------------------------------------------------------------------
+
+uint64_t ts::Section::InstanceCount()
+{
+    return InstanceCounter;
+}
+
+uint64_t ts::Section::BufferCount()
+{
+    return BufferCounter;
+}
+
+
 //----------------------------------------------------------------------------
 // Static method to compute a section size. Return zero on error.
 //----------------------------------------------------------------------------
@@ -329,7 +404,7 @@ ts::Section& ts::Section::copy(const Section& sect)
         _source_pid = sect._source_pid;
         _first_pkt = sect._first_pkt;
         _last_pkt = sect._last_pkt;
-        _data = sect._is_valid ? new ByteBlock(*sect._data) : nullptr;
+        _data = sect._is_valid ? newBuffer(sect._data->data(), sect._data->size()) : nullptr;
     }
     return *this;
 }
@@ -467,6 +542,37 @@ void ts::Section::setUInt16(size_t offset, uint16_t value, bool recompute_crc)
 }
 
 
+
+//----------------------------------------------------------------------------
+// Modify bytes with an incremental update of the CRC32.
+//----------------------------------------------------------------------------
+
+bool ts::Section::patchBytes(size_t offset, const void* data, size_t size)
+{
+    if (!_is_valid) {
+        return false;
+    }
+    const bool crc = isLongSection();
+    const size_t end = crc ? _data->size() - 4 : _data->size();
+    if (offset > end || size > end - offset) {
+        return false;
+    }
+    uint8_t* const base = _data->data();
+    if (crc) {
+        PutUInt32(base + end, CRC32::Update(GetUInt32(base + end), end, offset, base + offset, data, size));
+    }
+    ::memcpy(base + offset, data, size);  // Flawfinder: ignore: memcpy()
+    return true;
+}
+
+bool ts::Section::patchUInt16(size_t offset, uint16_t value)
+{
+    uint8_t data[2];
+    PutUInt16(data, value);
+    return patchBytes(offset, data, sizeof(data));
+}
+
+
 //----------------------------------------------------------------------------
 // Write section on standard streams.
 //----------------------------------------------------------------------------
@@ -513,6 +619,7 @@ std::istream& ts::Section::read(std::istream& strm, CRC32::Validation crc_op, Re
         secsize += GetUInt16(header + 1) & 0x0FFF;
         secdata = new ByteBlock(secsize);
         CheckNonNull(secdata.pointer());
+        BufferCounter++;
         ::memcpy(secdata->data(), header, 3);  // Flawfinder: ignore: memcpy()
         strm.read(reinterpret_cast <char*>(secdata->data() + 3), std::streamsize(secsize - 3));
         insize += size_t(strm.gcount());
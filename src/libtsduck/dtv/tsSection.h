@@ -153,6 +153,7 @@ namespace ts {
         //!
         //! Reload from full binary content.
         //! The content is copied into the section if valid.
+        //! The previous content buffer is reused when it is not shared with another section.
         //! @param [in] content Address of the binary section data.
         //! @param [in] content_size Size in bytes of the section.
         //! @param [in] source_pid PID from which the section was read.
@@ -161,10 +162,7 @@ namespace ts {
         void reload(const void* content,
                     size_t content_size,
                     PID source_pid = PID_NULL,
-                    CRC32::Validation crc_op = CRC32::IGNORE)
-        {
-            initialize(new ByteBlock(content, content_size), source_pid, crc_op);
-        }
+                    CRC32::Validation crc_op = CRC32::IGNORE);
 
         //!
         //! Reload from full binary content.
@@ -174,10 +172,7 @@ namespace ts {
         //!
         void reload(const ByteBlock& content,
                      PID source_pid = PID_NULL,
-                     CRC32::Validation crc_op = CRC32::IGNORE)
-        {
-            initialize(new ByteBlock(content), source_pid, crc_op);
-        }
+                     CRC32::Validation crc_op = CRC32::IGNORE);
 
         //!
         //! Reload from full binary content.
@@ -521,6 +516,39 @@ namespace ts {
         //!
         void setUInt16(size_t offset, uint16_t value, bool recompute_crc = true);
 
+        //!
+        //! Replace bytes in the section and incrementally update the CRC32.
+        //! Unlike recomputeCRC(), the CRC32 is not computed from the complete content of the
+        //! section but updated from its current value and the modified bytes only. Therefore,
+        //! the current CRC32 of the section must be correct. Short sections have no CRC32.
+        //! @param [in] offset Byte offset in the complete section, including the header.
+        //! @param [in] data Address of the new bytes.
+        //! @param [in] size Number of bytes to replace. The replaced bytes cannot overlap the CRC32.
+        //! @return True on success, false if the section is invalid or the area is out of range.
+        //!
+        bool patchBytes(size_t offset, const void* data, size_t size);
+
+        //!
+        //! Replace one byte in the section and incrementally update the CRC32.
+        //! @param [in] offset Byte offset in the complete section, including the header.
+        //! @param [in] value The new byte value.
+        //! @return True on success, false if the section is invalid or the area is out of range.
+        //! @see patchBytes()
+        //!
+        bool patchUInt8(size_t offset, uint8_t value)
+        {
+            return patchBytes(offset, &value, 1);
+        }
+
+        //!
+        //! Replace a 16-bit integer in the section and incrementally update the CRC32.
+        //! @param [in] offset Byte offset in the complete section, including the header.
+        //! @param [in] value The new value, stored in big endian representation.
+        //! @return True on success, false if the section is invalid or the area is out of range.
+        //! @see patchBytes()
+        //!
+        bool patchUInt16(size_t offset, uint16_t value);
+
         //!
         //! Set the source PID.
         //! @param [in] pid The source PID.
@@ -638,6 +666,20 @@ namespace ts {
         template <class CONTAINER>
         static PacketCounter PacketCount(const CONTAINER& container, bool pack = true);
 
+        //!
+        //! Get the number of Section objects which were created since the start of the application.
+        //! This instrumentation counter is used to evaluate the heap allocation load of sections.
+        //! @return The number of created Section objects.
+        //!
+        static uint64_t InstanceCount();
+
+        //!
+        //! Get the number of section content buffers which were allocated since the start of the application.
+        //! This instrumentation counter is used to evaluate the heap allocation load of sections.
+        //! @return The number of allocated section content buffers.
+        //!
+        static uint64_t BufferCount();
+
         // Implementation of AbstractDefinedByStandards
         virtual Standards definingStandards() const override;
 
@@ -653,6 +695,10 @@ namespace ts {
         void initialize(PID);
         void initialize(const ByteBlockPtr&, PID, CRC32::Validation);
 
+        // Get a content buffer of the specified size, optionally copying a content.
+        // The current buffer is reused when it is not shared.
+        ByteBlockPtr newBuffer(const void* content, size_t size);
+
         // Inaccessible operations
         Section(const Section&) = delete;
     };
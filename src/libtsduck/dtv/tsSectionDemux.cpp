@@ -138,9 +138,10 @@ void ts::SectionDemux::ETIDContext::init(uint8_t new_version, uint8_t last_secti
     sect_received = 0;
     sects.resize(sect_expected);
 
-    // Mark all section entries as unused
+    // Mark all section entries as unused. Only release our reference, the
+    // sections may still be used by the application or by a section pool.
     for (size_t i = 0; i < sect_expected; i++) {
-        sects[i].reset();
+        sects[i].clear();
     }
 }
 
@@ -149,8 +150,12 @@ void ts::SectionDemux::ETIDContext::notify(SectionDemux& demux, bool pack, bool
 {
     if (!notified && (sect_received == sect_expected || pack || fill_eit) && demux._table_handler != nullptr) {
 
-        // Build the table
-        BinaryTable table;
+        // Build the table. When a section pool is used, the table object of the demux is
+        // reused, unless the handler is currently processing it (nested notification).
+        const bool reuse = demux._pool != nullptr && !demux._table_in_use;
+        BinaryTable local_table;
+        BinaryTable& table(reuse ? demux._table : local_table);
+        table.clear();
         for (size_t i = 0; i < sects.size(); ++i) {
             table.addSection(sects[i]);
         }
@@ -168,7 +173,14 @@ void ts::SectionDemux::ETIDContext::notify(SectionDemux& demux, bool pack, bool
         // Invoke the table handler.
         if (table.isValid()) {
             notified = true;
+            demux._table_in_use = reuse;
             demux._table_handler->handleTable(demux, table);
+            demux._table_in_use = false;
+        }
+
+        // Release the sections so that they can be recycled.
+        if (reuse) {
+            table.clear();
         }
     }
 }
@@ -206,7 +218,10 @@ ts::SectionDemux::SectionDemux(DuckContext& duck, TableHandlerInterface* table_h
     _pids(),
     _status(),
     _get_current(true),
-    _get_next(false)
+    _get_next(false),
+    _pool(nullptr),
+    _table(),
+    _table_in_use(false)
 {
 }
 
@@ -219,6 +234,8 @@ void ts::SectionDemux::immediateReset()
 {
     SuperClass::immediateReset();
     _pids.clear();
+    _table.clear();
+    _table_in_use = false;
 }
 
 void ts::SectionDemux::immediateResetPID(PID pid)
@@ -492,7 +509,12 @@ void ts::SectionDemux::processPacket(const TSPacket& pkt)
             SectionPtr sect_ptr;
 
             if (section_ok && (_section_handler != nullptr || (tc != nullptr && tc->sects[section_number].isNull()))) {
-                sect_ptr = new Section(ts_start, section_length, pid, CRC32::CHECK);
+                if (_pool != nullptr) {
+                    sect_ptr = _pool->newSection(ts_start, section_length, pid, CRC32::CHECK);
+                }
+                else {
+                    sect_ptr = new Section(ts_start, section_length, pid, CRC32::CHECK);
+                }
                 sect_ptr->setFirstTSPacketIndex(pusi_pkt_index);
                 sect_ptr->setLastTSPacketIndex(_packet_count);
                 if (!sect_ptr->isValid()) {
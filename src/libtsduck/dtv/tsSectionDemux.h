@@ -36,7 +36,10 @@
 #include "tsAbstractDemux.h"
 #include "tsTableHandlerInterface.h"
 #include "tsSectionHandlerInterface.h"
+#include "tsSectionPool.h"
+#include "tsBinaryTable.h"
 #include "tsETID.h"
+#include "tsPIDIndexedMap.h"
 
 namespace ts {
     //!
@@ -135,6 +138,20 @@ namespace ts {
             _get_next = next;
         }
 
+        //!
+        //! Use a pool of sections to reduce heap allocations.
+        //! By default, no pool is used and each demuxed section is allocated on the heap.
+        //! With a pool, the sections which are no longer referenced by the application
+        //! are reused for the next demuxed sections.
+        //! @param [in] pool Address of the section pool to use. Use a null pointer to stop
+        //! using a pool. The pool object must remain valid as long as it is used by the demux.
+        //! The same pool shall not be shared by demuxes running in different threads.
+        //!
+        void setSectionPool(SectionPool* pool)
+        {
+            _pool = pool;
+        }
+
         //!
         //! Demux status information.
         //! It contains error counters.
@@ -256,10 +273,13 @@ namespace ts {
         // Private members:
         TableHandlerInterface*   _table_handler;
         SectionHandlerInterface* _section_handler;
-        std::map<PID,PIDContext> _pids;
+        PIDIndexedMap<PIDContext> _pids;
         Status                   _status;
         bool                     _get_current;
         bool                     _get_next;
+        SectionPool*             _pool;          // Optional pool of sections.
+        BinaryTable              _table;         // Reused table when a pool is used.
+        bool                     _table_in_use;  // _table is being processed by a handler.
     };
 }
 
@@ -393,57 +393,71 @@ bool ts::SectionFile::LoadModel(xml::Document& doc)
 bool ts::SectionFile::loadXML(const UString& file_name, Report& report)
 {
     clear();
-    xml::Document doc(report);
-    doc.setTweaks(_xmlTweaks);
-    return doc.load(file_name, false) && parseDocument(doc);
+    xml::PullParser parser(report);
+    parser.setTweaks(_xmlTweaks);
+    return parser.open(file_name, false) && parseDocument(parser, report);
 }
 
 bool ts::SectionFile::loadXML(std::istream& strm, Report& report)
 {
     clear();
-    xml::Document doc(report);
-    doc.setTweaks(_xmlTweaks);
-    return doc.load(strm) && parseDocument(doc);
+    xml::PullParser parser(report);
+    parser.setTweaks(_xmlTweaks);
+    return parser.open(strm) && parseDocument(parser, report);
 }
 
 bool ts::SectionFile::parseXML(const UString& xml_content, Report& report)
 {
     clear();
-    xml::Document doc(report);
-    doc.setTweaks(_xmlTweaks);
-    return doc.parse(xml_content) && parseDocument(doc);
+    xml::PullParser parser(report);
+    parser.setTweaks(_xmlTweaks);
+    return parser.openText(xml_content) && parseDocument(parser, report);
 }
 
-bool ts::SectionFile::parseDocument(const xml::Document& doc)
+bool ts::SectionFile::parseDocument(xml::PullParser& parser, Report& report, std::ostream* bin)
 {
     // Load the XML model for TSDuck files. Search it in TSDuck directory.
-    xml::Document model(doc.report());
+    xml::Document model(report);
     if (!LoadModel(model)) {
         return false;
     }
 
-    // Validate the input document according to the model.
+    // Validate the root of the input document according to the model.
+    // At this stage, the root element has no child yet.
+    const xml::Document& doc(parser.document());
     if (!doc.validate(model)) {
         return false;
     }
 
-    // Get the root in the document. Should be ok since we validated the document.
-    const xml::Element* root = doc.rootElement();
+    // Analyze all tables in the document, one by one. Each table element is
+    // deleted by the parser when the next one is read.
     bool success = true;
-
-    // Analyze all tables in the document.
-    for (const xml::Element* node = root == nullptr ? nullptr : root->firstChildElement(); node != nullptr; node = node->nextSiblingElement()) {
-        BinaryTablePtr bin(new BinaryTable);
-        CheckNonNull(bin.pointer());
-        if (bin->fromXML(_duck, node) && bin->isValid()) {
-            add(bin);
+    for (const xml::Element* node = parser.nextElement(); node != nullptr; node = parser.nextElement()) {
+        if (!doc.validateRootChild(model, node)) {
+            success = false;
+            continue;
         }
-        else {
-            doc.report().error(u"Error in table <%s> at line %d", {node->name(), node->lineNumber()});
+        BinaryTablePtr table(new BinaryTable);
+        CheckNonNull(table.pointer());
+        if (!table->fromXML(_duck, node) || !table->isValid()) {
+            report.error(u"Error in table <%s> at line %d", {node->name(), node->lineNumber()});
             success = false;
         }
+        else if (bin == nullptr) {
+            add(table);
+        }
+        else {
+            _duck.addStandards(table->definingStandards());
+            for (size_t i = 0; i < table->sectionCount() && bin->good(); ++i) {
+                const SectionPtr& section(table->sectionAt(i));
+                if (!section.isNull() && section->isValid()) {
+                    section->write(*bin, report);
+                }
+            }
+            success = success && bin->good();
+        }
     }
-    return success;
+    return parser.success() && success;
 }
 
 
@@ -453,16 +467,23 @@ bool ts::SectionFile::parseDocument(const xml::Document& doc)
 
 bool ts::SectionFile::saveXML(const UString& file_name, Report& report) const
 {
-    xml::Document doc(report);
-    doc.setTweaks(_xmlTweaks);
-    return generateDocument(doc) && doc.save(file_name);
+    xml::StreamWriter writer(report);
+    writer.setTweaks(_xmlTweaks);
+    if (!writer.open(file_name, u"tsduck")) {
+        return false;
+    }
+    return generateDocument(writer, report);
 }
 
 ts::UString ts::SectionFile::toXML(Report& report) const
 {
-    xml::Document doc(report);
-    doc.setTweaks(_xmlTweaks);
-    return generateDocument(doc) ? doc.toString() : UString();
+    std::ostringstream strm;
+    xml::StreamWriter writer(report);
+    writer.setTweaks(_xmlTweaks);
+    if (!writer.open(strm, u"tsduck") || !generateDocument(writer, report)) {
+        return UString();
+    }
+    return UString::FromUTF8(strm.str());
 }
 
 
@@ -470,28 +491,115 @@ ts::UString ts::SectionFile::toXML(Report& report) const
 // Generate an XML document.
 //----------------------------------------------------------------------------
 
-bool ts::SectionFile::generateDocument(xml::Document& doc) const
+void ts::SectionFile::writeTables(xml::StreamWriter& writer) const
 {
-    // Initialize the document structure.
-    xml::Element* root = doc.initialize(u"tsduck");
-    if (root == nullptr) {
-        return false;
-    }
-
-    // Format all tables.
+    // Format and write tables one by one.
     for (BinaryTablePtrVector::const_iterator it = _tables.begin(); it != _tables.end(); ++it) {
         const BinaryTablePtr& table(*it);
         if (!table.isNull()) {
-            table->toXML(_duck, root, false);
+            table->toXML(_duck, writer.rootElement(), false);
+            writer.flush();
         }
     }
+}
+
+bool ts::SectionFile::generateDocument(xml::StreamWriter& writer, Report& report) const
+{
+    writeTables(writer);
 
     // Issue a warning if incomplete tables were not saved.
     if (!_orphanSections.empty()) {
-        doc.report().warning(u"%d orphan sections not saved in XML document (%d tables saved)", {_orphanSections.size(), _tables.size()});
+        report.warning(u"%d orphan sections not saved in XML document (%d tables saved)", {_orphanSections.size(), _tables.size()});
     }
 
-    return true;
+    return writer.close();
+}
+
+
+//----------------------------------------------------------------------------
+// Streaming conversions between XML and binary files.
+//----------------------------------------------------------------------------
+
+bool ts::SectionFile::convertXMLToBinary(const UString& xml_file, const UString& bin_file, Report& report)
+{
+    xml::PullParser parser(report);
+    parser.setTweaks(_xmlTweaks);
+    if (!parser.open(xml_file, false)) {
+        return false;
+    }
+
+    std::ofstream strm(bin_file.toUTF8().c_str(), std::ios::out | std::ios::binary);
+    if (!strm.is_open()) {
+        report.error(u"error creating %s", {bin_file});
+        return false;
+    }
+
+    // Do not leave a partial binary file on error, the XML file shall be fixed first.
+    const bool success = parseDocument(parser, report, &strm);
+    strm.close();
+    if (!success) {
+        DeleteFile(bin_file);
+    }
+    return success;
+}
+
+bool ts::SectionFile::convertBinaryToXML(const UString& bin_file, const UString& xml_file, bool pack_orphans, Report& report)
+{
+    clear();
+
+    std::ifstream strm(bin_file.toUTF8().c_str(), std::ios::in | std::ios::binary);
+    if (!strm.is_open()) {
+        report.error(u"cannot open %s", {bin_file});
+        return false;
+    }
+
+    xml::StreamWriter writer(report);
+    writer.setTweaks(_xmlTweaks);
+    if (!writer.open(xml_file, u"tsduck")) {
+        return false;
+    }
+
+    // Read binary sections one by one. Complete tables are written and forgotten.
+    // Only the sections of incomplete tables remain in memory.
+    ReportWithPrefix report_internal(report, bin_file + u": ");
+    size_t table_count = 0;
+    for (;;) {
+        SectionPtr sp(new Section);
+        if (!sp->read(strm, _crc_op, report_internal)) {
+            break;
+        }
+        add(sp);
+        if (!_tables.empty()) {
+            writeTables(writer);
+            table_count += _tables.size();
+            _tables.clear();
+            _sections.clear();
+        }
+    }
+    // A truncated last section also ends on EOF but it is reported as an error.
+    bool success = strm.eof() && !report_internal.gotErrors();
+    strm.close();
+
+    // Process remaining incomplete tables.
+    if (pack_orphans) {
+        const size_t count = packOrphanSections();
+        if (count > 0) {
+            report.verbose(u"Packed %d incomplete tables, may be invalid", {count});
+        }
+        writeTables(writer);
+        table_count += _tables.size();
+    }
+    if (!_orphanSections.empty()) {
+        report.warning(u"%d orphan sections not saved in XML document (%d tables saved)", {_orphanSections.size(), table_count});
+    }
+
+    // Do not leave a truncated XML file on read or write error.
+    success = writer.close() && success;
+    clear();
+    if (!success) {
+        DeleteFile(xml_file);
+    }
+    return success;
 }
 
 
@@ -35,6 +35,8 @@
 #pragma once
 #include "tsxmlDocument.h"
 #include "tsxmlElement.h"
+#include "tsxmlPullParser.h"
+#include "tsxmlStreamWriter.h"
 #include "tsMPEG.h"
 #include "tsSection.h"
 #include "tsBinaryTable.h"
@@ -347,6 +349,31 @@ namespace ts {
         //!
         size_t packOrphanSections();
 
+        //!
+        //! Convert an XML file into a binary section file without loading all tables in memory.
+        //! The tables are parsed, converted and written one by one. The memory footprint does
+        //! not depend on the size of the file. The content of this object is not modified.
+        //! On error, the binary file is deleted.
+        //! @param [in] xml_file Input XML file name.
+        //! @param [in] bin_file Output binary file name.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool convertXMLToBinary(const UString& xml_file, const UString& bin_file, Report& report = CERR);
+
+        //!
+        //! Convert a binary section file into an XML file without loading all tables in memory.
+        //! Each table is written as soon as all its sections are read. Only incomplete tables
+        //! are kept in memory. On return, this object is cleared. On error, the XML file is deleted.
+        //! @param [in] bin_file Input binary file name.
+        //! @param [in] xml_file Output XML file name.
+        //! @param [in] pack_orphans If true, pack and write the orphan sections at end of file.
+        //! See packOrphanSections().
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool convertBinaryToXML(const UString& bin_file, const UString& xml_file, bool pack_orphans, Report& report = CERR);
+
         //!
         //! This static method loads the XML model for tables and descriptors.
         //! It loads the main model and merges all extensions.
@@ -364,18 +391,28 @@ namespace ts {
         CRC32::Validation    _crc_op;          //!< Processing of CRC32 when loading sections.
 
         //!
-        //! Parse an XML document.
-        //! @param [in] doc Document to load.
+        //! Parse an XML document, table by table.
+        //! @param [in,out] parser XML pull parser, already open.
+        //! @param [in,out] report Where to report errors.
+        //! @param [in,out] bin If not null, the sections of each table are written on this
+        //! binary stream instead of being added in this object.
         //! @return True on success, false on error.
         //!
-        bool parseDocument(const xml::Document& doc);
+        bool parseDocument(xml::PullParser& parser, Report& report, std::ostream* bin = nullptr);
 
         //!
-        //! Generate an XML document.
-        //! @param [in,out] doc XML document.
-        //! @return True on success, false on error.
+        //! Write all tables in an XML document which is generated incrementally.
+        //! @param [in,out] writer XML stream writer, already open.
+        //!
+        void writeTables(xml::StreamWriter& writer) const;
+
+        //!
+        //! Save all tables in an XML document which is generated incrementally and close it.
+        //! @param [in,out] writer XML stream writer, already open.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on write error.
         //!
-        bool generateDocument(xml::Document& doc) const;
+        bool generateDocument(xml::StreamWriter& writer, Report& report) const;
 
         //!
         //! Check it a table can be formed using the last sections in _orphanSections.
@@ -0,0 +1,115 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  A pool of recyclable sections.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSectionPool.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::SectionPool::DEFAULT_MAX_SIZE;
+constexpr size_t ts::SectionPool::MAX_PROBES;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::SectionPool::SectionPool(size_t max_size) :
+    _max_size(max_size),
+    _next(0),
+    _allocated(0),
+    _recycled(0),
+    _sections()
+{
+    _sections.reserve(_max_size);
+}
+
+
+//----------------------------------------------------------------------------
+// Release all sections and reset counters.
+//----------------------------------------------------------------------------
+
+void ts::SectionPool::clear()
+{
+    _sections.clear();
+    _next = 0;
+}
+
+void ts::SectionPool::resetCounters()
+{
+    _allocated = 0;
+    _recycled = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Get a section from full binary content.
+//----------------------------------------------------------------------------
+
+ts::SectionPtr ts::SectionPool::newSection(const void* content, size_t content_size, PID source_pid, CRC32::Validation crc_op)
+{
+    const size_t count = _sections.size();
+
+    // Look for a section which is referenced by the pool only.
+    // Check a few entries only, starting after the last reused one.
+    for (size_t i = 0; i < count && i < MAX_PROBES; ++i) {
+        SectionPtr& sect(_sections[_next]);
+        _next = (_next + 1) % count;
+        if (sect.isNull()) {
+            // The section was explicitly deallocated by its user, reuse the entry.
+            sect = new Section(content, content_size, source_pid, crc_op);
+            _allocated++;
+            return sect;
+        }
+        else if (sect.count() == 1) {
+            sect->reload(content, content_size, source_pid, crc_op);
+            _recycled++;
+            return sect;
+        }
+    }
+
+    // No free section found, allocate a new one.
+    SectionPtr sect(new Section(content, content_size, source_pid, crc_op));
+    _allocated++;
+
+    if (count < _max_size) {
+        _sections.push_back(sect);
+    }
+    else if (count > 0) {
+        // The pool is full of used sections. Replace one of them with the new one.
+        // The replaced section remains valid until released by its users.
+        _sections[_next] = sect;
+        _next = (_next + 1) % count;
+    }
+    return sect;
+}
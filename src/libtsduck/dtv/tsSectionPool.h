@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  A pool of recyclable sections.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsSection.h"
+
+namespace ts {
+    //!
+    //! A pool of recyclable sections.
+    //! @ingroup mpeg
+    //!
+    //! Each section which is built from binary data normally allocates a Section object,
+    //! the control block of its safe pointer and a ByteBlock for its content. On streams
+    //! with many sections, such as EIT, this is a lot of small heap allocations.
+    //!
+    //! A SectionPool keeps references to the sections it has provided. When a section
+    //! is no longer referenced outside the pool, the Section object, its safe pointer
+    //! and its binary content are reused for the next section, without heap allocation.
+    //!
+    //! A SectionPool is not thread-safe. It is typically associated with one SectionDemux.
+    //!
+    class TSDUCKDLL SectionPool
+    {
+        TS_NOCOPY(SectionPool);
+    public:
+        //!
+        //! Default maximum number of sections in the pool.
+        //!
+        static constexpr size_t DEFAULT_MAX_SIZE = 256;
+
+        //!
+        //! Number of pool entries which are checked for a free section.
+        //!
+        static constexpr size_t MAX_PROBES = 8;
+
+        //!
+        //! Constructor.
+        //! @param [in] max_size Maximum number of sections in the pool.
+        //!
+        explicit SectionPool(size_t max_size = DEFAULT_MAX_SIZE);
+
+        //!
+        //! Get a section from full binary content.
+        //! A free section from the pool is reused when possible, otherwise a new section is allocated.
+        //! @param [in] content Address of the binary section data. The content is copied into the section.
+        //! @param [in] content_size Size in bytes of the section.
+        //! @param [in] source_pid PID from which the section was read.
+        //! @param [in] crc_op How to process the CRC32.
+        //! @return A safe pointer to the section. The section may be invalid.
+        //!
+        SectionPtr newSection(const void* content,
+                              size_t content_size,
+                              PID source_pid = PID_NULL,
+                              CRC32::Validation crc_op = CRC32::IGNORE);
+
+        //!
+        //! Release all sections from the pool.
+        //! The sections which are still referenced elsewhere remain valid.
+        //!
+        void clear();
+
+        //!
+        //! Get the number of sections currently in the pool, used or free.
+        //! @return The number of sections in the pool.
+        //!
+        size_t size() const { return _sections.size(); }
+
+        //!
+        //! Get the maximum number of sections in the pool.
+        //! @return The maximum number of sections in the pool.
+        //!
+        size_t maxSize() const { return _max_size; }
+
+        //!
+        //! Get the number of sections which were allocated by the pool.
+        //! @return The number of sections which were allocated on the heap.
+        //!
+        uint64_t allocatedCount() const { return _allocated; }
+
+        //!
+        //! Get the number of sections which were reused from the pool.
+        //! @return The number of sections which were reused without heap allocation.
+        //!
+        uint64_t recycledCount() const { return _recycled; }
+
+        //!
+        //! Reset the allocation counters.
+        //!
+        void resetCounters();
+
+    private:
+        size_t           _max_size;   // Maximum number of sections in the pool.
+        size_t           _next;       // Next entry to probe for a free section.
+        uint64_t         _allocated;  // Number of allocated sections.
+        uint64_t         _recycled;   // Number of reused sections.
+        SectionPtrVector _sections;   // All sections in the pool, used or free.
+    };
+}
@@ -87,6 +87,7 @@ ts::TSAnalyzer::TSAnalyzer(DuckContext& duck, BitRate bitrate_hint) :
     _pids(),
     _services(),
     _modified(false),
+    _preloading(false),
     _ts_bitrate_sum(0),
     _ts_bitrate_cnt(0),
     _preceding_errors(0),
@@ -161,6 +162,7 @@ void ts::TSAnalyzer::reset()
     _services.clear();
     _ts_bitrate_sum = 0;
     _ts_bitrate_cnt = 0;
+    _preloading = false;
     _preceding_errors = 0;
     _preceding_suspects = 0;
     _pes_demux.reset();
@@ -281,7 +283,16 @@ ts::TSAnalyzer::PIDContext::PIDContext(PID pid_, const UString& description_) :
     last_pcr(0),
     last_pcr_pkt(0),
     ts_bitrate_sum(0),
-    ts_bitrate_cnt(0)
+    ts_bitrate_cnt(0),
+    first_pkt(0),
+    first_cc(0),
+    first_discont(false),
+    first_payload(false),
+    first_ts_sc(0),
+    first_cryptop_ts(0),
+    first_pcr(0),
+    first_pcr_pkt(0),
+    broken_before_pcr(false)
 {
     // Guess the initial description, based on the PID
     // Global PID's (PAT, CAT, etc) are marked as "referenced" since they
@@ -458,6 +469,11 @@ void ts::TSAnalyzer::PIDContext::addService(uint16_t service_id)
 
 void ts::TSAnalyzer::handleSection(SectionDemux&, const Section& section)
 {
+    // Sections from preloaded packets belong to the preceding analysis.
+    if (_preloading) {
+        return;
+    }
+
     ETIDContextPtr etc(getETID(section));
     const uint8_t version = section.version();
 
@@ -555,14 +571,14 @@ void ts::TSAnalyzer::handleTable(SectionDemux&, const BinaryTable& table)
         }
         case TID_TDT: {
             const TDT tdt(_duck, table);
-            if (tdt.isValid()) {
+            if (tdt.isValid() && !_preloading) {
                 analyzeTDT(tdt);
             }
             break;
         }
         case TID_TOT: {
             const TOT tot(_duck, table);
-            if (tot.isValid()) {
+            if (tot.isValid() && !_preloading) {
                 analyzeTOT(tot);
             }
             break;
@@ -641,9 +657,11 @@ void ts::TSAnalyzer::analyzeCAT(const CAT& cat)
 
 void ts::TSAnalyzer::analyzePMT(PID pid, const PMT& pmt)
 {
-    // Count the number of PMT's on this PID
+    // Count the number of PMT's on this PID (preloaded PMT's belong to the preceding analysis).
     PIDContextPtr ps(getPID(pid));
-    ps->pmt_cnt++;
+    if (!_preloading) {
+        ps->pmt_cnt++;
+    }
 
     // Get service description
     ServiceContextPtr svp(getService(pmt.service_id));
@@ -1322,6 +1340,10 @@ void ts::TSAnalyzer::handleT2MINewPID(T2MIDemux& demux, const PMT& pmt, PID pid,
 
 void ts::TSAnalyzer::handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt)
 {
+    if (_preloading) {
+        return;
+    }
+
     PIDContextPtr pc(getPID(pkt.getSourcePID(), u"T2-MI"));
 
     // Count T2-MI packets.
@@ -1345,6 +1367,10 @@ void ts::TSAnalyzer::handleT2MIPacket(T2MIDemux& demux, const T2MIPacket& pkt)
 
 void ts::TSAnalyzer::handleTSPacket(T2MIDemux& demux, const T2MIPacket& t2mi, const TSPacket& ts)
 {
+    if (_preloading) {
+        return;
+    }
+
     PIDContextPtr pc(getPID(t2mi.getSourcePID(), u"T2-MI"));
 
     // Count demux'ed TS packets from this PLP.
@@ -1413,6 +1439,15 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
     PIDContextPtr ps(getPID(pkt.getPID()));
     ps->ts_pkt_cnt++;
 
+    // Keep the characteristics of the first packet, used when merging analyses.
+    if (ps->ts_pkt_cnt == 1) {
+        ps->first_pkt = packet_index;
+        ps->first_cc = pkt.getCC();
+        ps->first_discont = pkt.getDiscontinuityIndicator();
+        ps->first_payload = pkt.hasPayload();
+        ps->first_ts_sc = pkt.getScrambling();
+    }
+
     // Accumulate stat from packet
     if (pkt.hasAF()) {
         ps->ts_af_cnt++;
@@ -1447,6 +1482,9 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
             if (ps->cryptop_cnt > 1) {
                 ps->cryptop_ts_cnt += packet_index - ps->cur_ts_sc_pkt;
             }
+            else {
+                ps->first_cryptop_ts = packet_index - ps->cur_ts_sc_pkt;
+            }
         }
         ps->cur_ts_sc = pkt.getScrambling();
         ps->cur_ts_sc_pkt = packet_index;
@@ -1488,12 +1526,18 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
     if (broken_rate) {
         // Suspected packet loss, forget last PCR.
         ps->last_pcr = 0;
+        if (ps->pcr_cnt == 0) {
+            ps->broken_before_pcr = true;
+        }
     }
     if (pkt.hasPCR()) {
         uint64_t pcr(pkt.getPCR());
         // Count PID's with PCR
-        if (ps->pcr_cnt++ == 0)
+        if (ps->pcr_cnt++ == 0) {
             _pcr_pid_cnt++;
+            ps->first_pcr = pcr;
+            ps->first_pcr_pkt = packet_index;
+        }
         // If last PCR valid, compute transport rate between the two
         if (ps->last_pcr != 0 && ps->last_pcr < pcr) {
             // Compute transport rate in b/s since last PCR
@@ -1558,6 +1602,338 @@ void ts::TSAnalyzer::feedPacket(const TSPacket& pkt)
 }
 
 
+//----------------------------------------------------------------------------
+// Feed the analyzer with a TS packet which precedes the analyzed part.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::preloadPacket(const TSPacket& pkt)
+{
+    // Invalid packets are ignored, as in feedPacket().
+    if (pkt.hasValidSync() && !pkt.getTEI()) {
+        // Only build the state of the demuxes. The handlers ignore
+        // or do not count what they receive during preloading.
+        _preloading = true;
+        _demux.feedPacket(pkt);
+        _pes_demux.feedPacket(pkt);
+        _t2mi_demux.feedPacket(pkt);
+        _preloading = false;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Merge the analysis of the next part of a stream into this analyzer.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::merge(const TSAnalyzer& other)
+{
+    // Packet indexes in the other analyzer are relative to its own part of the stream.
+    const uint64_t offset = _ts_pkt_cnt;
+
+    _modified = true;
+
+    // Global counters.
+    _ts_pkt_cnt += other._ts_pkt_cnt;
+    _invalid_sync += other._invalid_sync;
+    _transport_errors += other._transport_errors;
+    _suspect_ignored += other._suspect_ignored;
+    _tid_present |= other._tid_present;
+    if (other._ts_id_valid) {
+        _ts_id = other._ts_id;
+        _ts_id_valid = true;
+    }
+
+    // The suspect packets detection continues with the state at the end of the other part.
+    _preceding_errors = other._preceding_errors;
+    _preceding_suspects = other._preceding_suspects;
+
+    // Keep the earliest analysis start time.
+    if (other._first_utc != Time::Epoch && (_first_utc == Time::Epoch || other._first_utc < _first_utc)) {
+        _first_utc = other._first_utc;
+        _first_local = other._first_local;
+    }
+
+    // Time stamps from the stream: first ones from this part, last ones from the other part.
+    if (_first_tdt == Time::Epoch) {
+        _first_tdt = other._first_tdt;
+    }
+    if (other._last_tdt != Time::Epoch) {
+        _last_tdt = other._last_tdt;
+    }
+    if (_first_tot == Time::Epoch) {
+        _first_tot = other._first_tot;
+        _country_code = other._country_code;
+    }
+    if (other._last_tot != Time::Epoch) {
+        _last_tot = other._last_tot;
+    }
+    if (_first_stt == Time::Epoch) {
+        _first_stt = other._first_stt;
+    }
+    if (other._last_stt != Time::Epoch) {
+        _last_stt = other._last_stt;
+    }
+
+    // Bitrates which were computed inside the other part. The bitrates
+    // which are computed across the boundary are added by mergePID().
+    _ts_bitrate_sum += other._ts_bitrate_sum;
+    _ts_bitrate_cnt += other._ts_bitrate_cnt;
+
+    // Merge services. The latest known characteristics win.
+    for (ServiceContextMap::const_iterator it = other._services.begin(); it != other._services.end(); ++it) {
+        const ServiceContext& osv(*it->second);
+        const ServiceContextPtr svp(getService(it->first));
+        if (osv.orig_netw_id != 0) {
+            svp->orig_netw_id = osv.orig_netw_id;
+        }
+        if (osv.service_type != 0) {
+            svp->service_type = osv.service_type;
+        }
+        if (!osv.name.empty()) {
+            svp->name = osv.name;
+        }
+        if (!osv.provider.empty()) {
+            svp->provider = osv.provider;
+        }
+        if (osv.pmt_pid != 0) {
+            svp->pmt_pid = osv.pmt_pid;
+        }
+        if (osv.pcr_pid != 0) {
+            svp->pcr_pid = osv.pcr_pid;
+        }
+        svp->carry_ssu = svp->carry_ssu || osv.carry_ssu;
+        svp->carry_t2mi = svp->carry_t2mi || osv.carry_t2mi;
+    }
+
+    // Merge PID's.
+    for (PIDContextMap::const_iterator it = other._pids.begin(); it != other._pids.end(); ++it) {
+        mergePID(*getPID(it->first), *it->second, offset);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Merge a PID context from another analyzer.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::mergePID(PIDContext& pc, const PIDContext& other, uint64_t offset)
+{
+    // Descriptive data: the latest known values win, lists are merged.
+    if (other.description != UNREFERENCED) {
+        pc.description = other.description;
+    }
+    if (!other.comment.empty()) {
+        pc.comment = other.comment;
+    }
+    if (!other.language.empty()) {
+        pc.language = other.language;
+    }
+    if (other.cas_id != 0) {
+        pc.cas_id = other.cas_id;
+    }
+    for (UStringVector::const_iterator it = other.attributes.begin(); it != other.attributes.end(); ++it) {
+        AppendUnique(pc.attributes, *it);
+    }
+    pc.services.insert(other.services.begin(), other.services.end());
+    pc.cas_operators.insert(other.cas_operators.begin(), other.cas_operators.end());
+    pc.ssu_oui.insert(other.ssu_oui.begin(), other.ssu_oui.end());
+    pc.is_pmt_pid = pc.is_pmt_pid || other.is_pmt_pid;
+    pc.is_pcr_pid = pc.is_pcr_pid || other.is_pcr_pid;
+    pc.referenced = pc.referenced || other.referenced;
+    pc.carry_pes = pc.carry_pes || other.carry_pes;
+    pc.carry_section = pc.carry_section || other.carry_section;
+    pc.carry_ecm = pc.carry_ecm || other.carry_ecm;
+    pc.carry_emm = pc.carry_emm || other.carry_emm;
+    pc.carry_audio = pc.carry_audio || other.carry_audio;
+    pc.carry_video = pc.carry_video || other.carry_video;
+    pc.carry_t2mi = pc.carry_t2mi || other.carry_t2mi;
+    if (other.scrambled && !pc.scrambled) {
+        pc.scrambled = true;
+        _scrambled_pid_cnt++;
+    }
+    if (pc.pes_stream_id == 0) {
+        pc.pes_stream_id = other.pes_stream_id;
+        pc.same_stream_id = other.same_stream_id;
+    }
+    else if (other.pes_stream_id != 0) {
+        pc.same_stream_id = pc.same_stream_id && other.same_stream_id && pc.pes_stream_id == other.pes_stream_id;
+    }
+
+    // Merge sections.
+    for (ETIDContextMap::const_iterator it = other.sections.begin(); it != other.sections.end(); ++it) {
+        ETIDContextPtr& etc(pc.sections[it->first]);
+        if (etc.isNull()) {
+            etc = new ETIDContext(it->first);
+        }
+        MergeETID(*etc, *it->second, offset);
+    }
+
+    // T2-MI encapsulated packets.
+    for (auto it = other.t2mi_plp_ts.begin(); it != other.t2mi_plp_ts.end(); ++it) {
+        pc.t2mi_plp_ts[it->first] += it->second;
+    }
+
+    // Evaluate the first packet of the other part as feedPacket() would have done.
+    if (other.ts_pkt_cnt > 0) {
+
+        const uint64_t first_pkt = other.first_pkt + offset;
+        bool broken_rate = false;
+
+        // Continuity at the boundary. The continuity counter of null packets is undefined.
+        if (pc.ts_pkt_cnt == 0) {
+            pc.first_pkt = first_pkt;
+            pc.first_cc = other.first_cc;
+            pc.first_discont = other.first_discont;
+            pc.first_payload = other.first_payload;
+            pc.first_ts_sc = other.first_ts_sc;
+        }
+        else if (pc.pid != PID_NULL) {
+            if (other.first_discont) {
+                pc.exp_discont++;
+                broken_rate = true;
+            }
+            else if (other.first_payload) {
+                if (other.first_cc == pc.cur_continuity) {
+                    pc.duplicated++;
+                }
+                else if (other.first_cc != (pc.cur_continuity + 1) % CC_MAX) {
+                    pc.unexp_discont++;
+                    broken_rate = true;
+                }
+            }
+            else if (other.first_cc != pc.cur_continuity) {
+                pc.unexp_discont++;
+                broken_rate = true;
+            }
+        }
+        pc.cur_continuity = other.cur_continuity;
+
+        // PCR-based bitrate between the last PCR of this part and the first PCR of the other part.
+        broken_rate = broken_rate || other.broken_before_pcr;
+        if (broken_rate) {
+            pc.last_pcr = 0;
+            if (pc.pcr_cnt == 0) {
+                pc.broken_before_pcr = true;
+            }
+        }
+        if (other.pcr_cnt > 0) {
+            if (pc.last_pcr != 0 && pc.last_pcr < other.first_pcr) {
+                const uint64_t ts_bitrate =
+                    (uint64_t(other.first_pcr_pkt + offset - pc.last_pcr_pkt) * SYSTEM_CLOCK_FREQ * PKT_SIZE * 8) /
+                    (other.first_pcr - pc.last_pcr);
+                pc.ts_bitrate_sum += ts_bitrate;
+                pc.ts_bitrate_cnt++;
+                _ts_bitrate_sum += ts_bitrate;
+                _ts_bitrate_cnt++;
+            }
+            if (pc.pcr_cnt == 0) {
+                _pcr_pid_cnt++;
+                pc.first_pcr = other.first_pcr;
+                pc.first_pcr_pkt = other.first_pcr_pkt + offset;
+            }
+            pc.last_pcr = other.last_pcr;
+            pc.last_pcr_pkt = other.last_pcr_pkt + offset;
+        }
+
+        // Crypto-periods. The other part started its analysis in the clear state.
+        const uint8_t prev_sc = pc.cur_ts_sc;
+        const uint64_t prev_sc_pkt = pc.cur_ts_sc_pkt;
+        if (other.first_ts_sc != prev_sc && prev_sc != SC_CLEAR) {
+            // End of a crypto-period on the first packet of the other part.
+            if (++pc.cryptop_cnt > 1) {
+                pc.cryptop_ts_cnt += first_pkt - prev_sc_pkt;
+            }
+            else {
+                pc.first_cryptop_ts = first_pkt - prev_sc_pkt;
+            }
+        }
+        if (other.cryptop_cnt > 0) {
+            // The first crypto-period which ended in the other part may have started in this part.
+            uint64_t count = other.first_cryptop_ts;
+            if (other.first_ts_sc != SC_CLEAR && other.first_ts_sc == prev_sc) {
+                count += first_pkt - prev_sc_pkt;
+            }
+            if (++pc.cryptop_cnt > 1) {
+                pc.cryptop_ts_cnt += count;
+            }
+            else {
+                pc.first_cryptop_ts = count;
+            }
+            pc.cryptop_cnt += other.cryptop_cnt - 1;
+            pc.cryptop_ts_cnt += other.cryptop_ts_cnt;
+        }
+        if (other.cryptop_cnt > 0 || other.first_ts_sc != prev_sc || prev_sc == SC_CLEAR) {
+            // Otherwise, the current crypto-period of this part continues until the end of the other part.
+            pc.cur_ts_sc = other.cur_ts_sc;
+            pc.cur_ts_sc_pkt = other.cur_ts_sc_pkt + offset;
+        }
+    }
+
+    // Accumulate counters.
+    pc.ts_pkt_cnt += other.ts_pkt_cnt;
+    pc.ts_af_cnt += other.ts_af_cnt;
+    pc.unit_start_cnt += other.unit_start_cnt;
+    pc.pl_start_cnt += other.pl_start_cnt;
+    pc.pmt_cnt += other.pmt_cnt;
+    pc.unexp_discont += other.unexp_discont;
+    pc.exp_discont += other.exp_discont;
+    pc.duplicated += other.duplicated;
+    pc.ts_sc_cnt += other.ts_sc_cnt;
+    pc.inv_ts_sc_cnt += other.inv_ts_sc_cnt;
+    pc.inv_pes_start += other.inv_pes_start;
+    pc.t2mi_cnt += other.t2mi_cnt;
+    pc.pcr_cnt += other.pcr_cnt;
+    pc.ts_bitrate_sum += other.ts_bitrate_sum;
+    pc.ts_bitrate_cnt += other.ts_bitrate_cnt;
+}
+
+
+//----------------------------------------------------------------------------
+// Merge an ETID context from another analyzer.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzer::MergeETID(ETIDContext& etc, const ETIDContext& other, uint64_t offset)
+{
+    // The first version is the one of the first section, replaced by the one of the first section# 0.
+    if (etc.section_count == 0 || (etc.table_count == 0 && other.table_count > 0 && etc.etid.isLongSection())) {
+        etc.first_version = other.first_version;
+    }
+    etc.section_count += other.section_count;
+    etc.versions |= other.versions;
+
+    if (other.table_count > 0) {
+        const uint64_t first_pkt = other.first_pkt + offset;
+        const uint64_t last_pkt = other.last_pkt + offset;
+
+        // Minimum and maximum intervals, including the interval across the boundary.
+        bool valid = etc.table_count > 1;
+        if (etc.table_count > 0) {
+            const uint64_t rep = first_pkt - etc.last_pkt;
+            etc.min_repetition_ts = valid ? std::min(etc.min_repetition_ts, rep) : rep;
+            etc.max_repetition_ts = valid ? std::max(etc.max_repetition_ts, rep) : rep;
+            valid = true;
+        }
+        else {
+            etc.first_pkt = first_pkt;
+        }
+        if (other.table_count > 1) {
+            etc.min_repetition_ts = valid ? std::min(etc.min_repetition_ts, other.min_repetition_ts) : other.min_repetition_ts;
+            etc.max_repetition_ts = valid ? std::max(etc.max_repetition_ts, other.max_repetition_ts) : other.max_repetition_ts;
+        }
+
+        // Average interval, computed as in handleSection().
+        etc.table_count += other.table_count;
+        etc.last_pkt = last_pkt;
+        if (etc.table_count > 1) {
+            etc.repetition_ts = (etc.last_pkt - etc.first_pkt + (etc.table_count - 1) / 2) / (etc.table_count - 1);
+        }
+        if (etc.etid.isLongSection()) {
+            etc.last_version = other.last_version;
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Specify a "bitrate hint" for the analysis. It is the user-specified
 // bitrate in bits/seconds, based on 188-byte packets. The bitrate is
@@ -51,6 +51,7 @@
 #include "tsTime.h"
 #include "tsUString.h"
 #include "tsSafePtr.h"
+#include "tsPIDIndexedMap.h"
 
 namespace ts {
     //!
@@ -87,6 +88,47 @@ namespace ts {
         //!
         void feedPacket(const TSPacket& packet);
 
+        //!
+        //! Feed the analyzer with a TS packet which precedes the analyzed part of the stream.
+        //!
+        //! When a large stream is split into chunks which are analyzed separately, the
+        //! last packets before a chunk are preloaded in the analyzer of this chunk. They
+        //! are only used to build the state of the demuxes (PSI structure, partially received
+        //! sections and PES packets) as if the analysis had started at the beginning of the
+        //! stream. Preloaded packets are not counted in the analysis. All preloaded packets
+        //! shall be passed before the first call to feedPacket().
+        //!
+        //! @param [in] packet One TS packet preceding the analyzed part of the stream.
+        //! @see merge()
+        //!
+        void preloadPacket(const TSPacket& packet);
+
+        //!
+        //! Merge the analysis of the next part of a stream into this analyzer.
+        //!
+        //! The part of the stream which was analyzed by @a other is considered as immediately
+        //! following the part which was analyzed by this object. All counters are accumulated,
+        //! the PID, service and table contexts are merged and the transitions at the boundary
+        //! between the two parts (continuity counters, PCR-based bitrates, crypto-periods, table
+        //! repetition intervals) are evaluated as a sequential analysis would have done.
+        //!
+        //! When the analyzer of each part (except the first one) has been preloaded with enough
+        //! packets of the preceding part (see preloadPacket()), the merged analysis is identical
+        //! to the sequential analysis of the complete stream, except for the detection of suspect
+        //! packets. Otherwise, sections and PES packets which overlap the boundary are lost.
+        //! The detection of suspect packets is never performed across the boundary: in each part,
+        //! it only knows the PID's of that part and ignores the invalid packets which precede it.
+        //! When suspect packet detection is enabled, the number of ignored suspect packets may
+        //! therefore differ from a sequential analysis.
+        //!
+        //! After merging, this analyzer can be used for reporting. Subsequent calls to feedPacket()
+        //! continue the analysis of the stream which was analyzed by this object, not @a other.
+        //!
+        //! @param [in] other The analyzer of the next part of the stream. It shall use the same
+        //! bitrate hint and suspect packets detection parameters as this object.
+        //!
+        void merge(const TSAnalyzer& other);
+
         //!
         //! Reset the analysis context.
         //!
@@ -358,6 +400,16 @@ namespace ts {
             uint64_t       last_pcr_pkt;    //!< Index of packet with last PCR.
             uint64_t       ts_bitrate_sum;  //!< Sum of all computed TS bitrates.
             uint64_t       ts_bitrate_cnt;  //!< Number of computed TS bitrates.
+            // Public members - Analysis data: Start of the PID, used to merge analyses.
+            uint64_t       first_pkt;         //!< Index of first packet in the PID.
+            uint8_t        first_cc;          //!< Continuity counter of first packet.
+            bool           first_discont;     //!< First packet has a discontinuity indicator.
+            bool           first_payload;     //!< First packet has a payload.
+            uint8_t        first_ts_sc;       //!< Scrambling control in TS header of first packet.
+            uint64_t       first_cryptop_ts;  //!< Number of TS packets in first crypto-period (not included in cryptop_ts_cnt).
+            uint64_t       first_pcr;         //!< First PCR value.
+            uint64_t       first_pcr_pkt;     //!< Index of packet with first PCR.
+            bool           broken_before_pcr; //!< Bitrate evaluation was broken (discontinuity) before first PCR.
 
             //!
             //! Default constructor.
@@ -400,7 +452,7 @@ namespace ts {
         //!
         //! Map of PIDContext, indexed by PID.
         //!
-        typedef std::map <PID, PIDContextPtr> PIDContextMap;
+        typedef PIDIndexedMap<PIDContextPtr> PIDContextMap;
 
         //!
         //! Check if a PID context exists.
@@ -482,6 +534,11 @@ namespace ts {
         // Reset the section demux.
         void resetSectionDemux();
 
+        // Merge a PID context or ETID context from another analyzer. The packet indexes
+        // in the other contexts are relative to the other analyzer and must be offset.
+        void mergePID(PIDContext& pc, const PIDContext& other, uint64_t offset);
+        static void MergeETID(ETIDContext& etc, const ETIDContext& other, uint64_t offset);
+
         // Analyze the various PSI tables
         void analyzePAT(const PAT&);
         void analyzeCAT(const CAT&);
@@ -523,6 +580,7 @@ namespace ts {
 
         // TSAnalyzer private members (state data, used during analysis):
         bool              _modified;                  // Internal data modified, need recomputeStatistics
+        bool              _preloading;                // Currently processing a preloaded packet
         uint64_t          _ts_bitrate_sum;            // Sum of all computed TS bitrates
         uint64_t          _ts_bitrate_cnt;            // Number of computed TS bitrates
         uint64_t          _preceding_errors;          // Number of contiguous invalid packets before current packet
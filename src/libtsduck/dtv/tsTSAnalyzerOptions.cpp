@@ -49,6 +49,8 @@ ts::TSAnalyzerOptions::TSAnalyzerOptions() :
     table_analysis(false),
     error_analysis(false),
     normalized(false),
+    json(false),
+    json_line(false),
     service_list(false),
     pid_list(false),
     global_pid_list(false),
@@ -78,7 +80,8 @@ void ts::TSAnalyzerOptions::defineArgs(Args &args) const
     args.help(u"ts-analysis",
               u"Report global transport stream analysis.\n\n"
               u"The output can include full synthetic analysis (options *-analysis), "
-              u"fully normalized output (option --normalized) or a simple list of "
+              u"fully normalized output (option --normalized), JSON output (option --json) "
+              u"or a simple list of "
               u"values on one line (options --*-list). The second and third type of "
               u"options are useful to write automated scripts.\n\n"
               u"If output-control options are specified, only the selected outputs "
@@ -105,6 +108,18 @@ void ts::TSAnalyzerOptions::defineArgs(Args &args) const
               u"Complete report about the transport stream, the services and the "
               u"PID's in a normalized output format (useful for automatic analysis).");
 
+    args.option(u"json");
+    args.help(u"json",
+              u"Complete report about the transport stream, the services, the PID's and "
+              u"the tables in JSON format (useful for automatic analysis). The JSON text "
+              u"is directly streamed, without intermediate in-memory representation.");
+
+    args.option(u"json-line");
+    args.help(u"json-line",
+              u"Same as --json but report the analysis as one single line in compact "
+              u"JSON format. This is the line-delimited JSON format (also known as "
+              u"\"JSON lines\"), where each report is one line.");
+
     args.option(u"service-list");
     args.help(u"service-list", u"Report the list of all service ids.");
 
@@ -184,6 +199,8 @@ bool ts::TSAnalyzerOptions::loadArgs(DuckContext &duck, Args &args)
     table_analysis = args.present(u"table-analysis");
     error_analysis = args.present(u"error-analysis");
     normalized = args.present(u"normalized");
+    json_line = args.present(u"json-line");
+    json = json_line || args.present(u"json");
     service_list = args.present(u"service-list");
     pid_list = args.present(u"pid-list");
     global_pid_list = args.present(u"global-pid-list");
@@ -203,6 +220,7 @@ bool ts::TSAnalyzerOptions::loadArgs(DuckContext &duck, Args &args)
         !table_analysis &&
         !error_analysis &&
         !normalized &&
+        !json &&
         !service_list &&
         !pid_list &&
         !global_pid_list &&
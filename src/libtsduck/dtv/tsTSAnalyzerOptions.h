@@ -68,6 +68,10 @@ namespace ts {
         // Normalized output:
         bool normalized;             //!< Option -\-normalized
 
+        // JSON output:
+        bool json;                   //!< Option -\-json
+        bool json_line;              //!< Option -\-json-line
+
         // One-line report options:
         bool service_list;           //!< Option -\-service-list
         bool pid_list;               //!< Option -\-pid-list
@@ -179,6 +179,11 @@ void ts::TSAnalyzerReport::report(std::ostream& stm, const TSAnalyzerOptions& op
     if (opt.normalized) {
         reportNormalized(stm, opt.title);
     }
+
+    // JSON report.
+    if (opt.json) {
+        reportJSON(stm, opt.title, opt.json_line);
+    }
 }
 
 
@@ -1055,3 +1060,292 @@ void ts::TSAnalyzerReport::reportNormalized(std::ostream& stm, const UString& ti
         }
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Add a JSON object for a time value.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzerReport::reportJSONTime(json::StreamWriter& json, const Time& time, const UString& name, const UString& country)
+{
+    if (time != Time::Epoch) {
+        const Time::Fields f(time);
+        json.beginObject(name);
+        json.addString(u"date", UString::Format(u"%04d-%02d-%02d", {f.year, f.month, f.day}));
+        json.addString(u"time", UString::Format(u"%02d:%02d:%02d", {f.hour, f.minute, f.second}));
+        json.addInteger(u"seconds-since-2000", (time - Time(2000, 1, 1, 0, 0, 0)) / MilliSecPerSec);
+        if (!country.empty()) {
+            json.addString(u"country", country);
+        }
+        json.endObject();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Add a JSON array of global or unreferenced PID's.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzerReport::reportJSONPIDList(json::StreamWriter& json, const UString& name, bool global) const
+{
+    json.beginArray(name);
+    for (PIDContextMap::const_iterator it = _pids.begin(); it != _pids.end(); ++it) {
+        const PIDContext& pc(*it->second);
+        if ((global ? pc.referenced && pc.services.size() == 0 : !pc.referenced) && (pc.ts_pkt_cnt != 0 || !pc.optional)) {
+            json.addInteger(UString(), pc.pid);
+        }
+    }
+    json.endArray();
+}
+
+
+//----------------------------------------------------------------------------
+// This method displays a JSON report.
+// The structure is the same as the normalized report.
+//----------------------------------------------------------------------------
+
+void ts::TSAnalyzerReport::reportJSON(std::ostream& stm, const UString& title, bool compact)
+{
+    // Update the global statistics value if internal data were modified.
+    recomputeStatistics();
+
+    TextFormatter out;
+    out.setStream(stm);
+    json::StreamWriter json(out, compact);
+
+    json.beginObject();
+    json.addString(u"title", title);
+
+    // Transport stream description.
+    json.beginObject(u"ts");
+    if (_ts_id_valid) {
+        json.addInteger(u"id", _ts_id);
+    }
+    json.beginObject(u"services");
+    json.addInteger(u"total", _services.size());
+    json.addInteger(u"clear", _services.size() - _scrambled_services_cnt);
+    json.addInteger(u"scrambled", _scrambled_services_cnt);
+    json.endObject();
+    json.beginObject(u"pids");
+    json.addInteger(u"total", _pid_cnt);
+    json.addInteger(u"clear", _pid_cnt - _scrambled_pid_cnt);
+    json.addInteger(u"scrambled", _scrambled_pid_cnt);
+    json.addInteger(u"pcr", _pcr_pid_cnt);
+    json.addInteger(u"unreferenced", _unref_pid_cnt);
+    json.endObject();
+    json.beginObject(u"packets");
+    json.addInteger(u"total", _ts_pkt_cnt);
+    json.addInteger(u"invalid-syncs", _invalid_sync);
+    json.addInteger(u"transport-errors", _transport_errors);
+    json.addInteger(u"suspect-ignored", _suspect_ignored);
+    json.endObject();
+    json.addInteger(u"bytes", PKT_SIZE * _ts_pkt_cnt);
+    json.addInteger(u"bitrate", _ts_bitrate);
+    json.addInteger(u"bitrate-204", ToBitrate204(_ts_bitrate));
+    json.addInteger(u"user-bitrate", _ts_user_bitrate);
+    json.addInteger(u"user-bitrate-204", ToBitrate204(_ts_user_bitrate));
+    json.addInteger(u"pcr-bitrate", _ts_pcr_bitrate_188);
+    json.addInteger(u"pcr-bitrate-204", _ts_pcr_bitrate_204);
+    json.addInteger(u"duration", _duration / 1000);
+    if (!_country_code.empty()) {
+        json.addString(u"country", _country_code);
+    }
+    json.endObject();
+
+    // First and last UTC and local time.
+    json.beginObject(u"time");
+    reportJSONTime(json, _first_tdt, u"utc-tdt-first");
+    reportJSONTime(json, _last_tdt, u"utc-tdt-last");
+    reportJSONTime(json, _first_tot, u"local-tot-first", _country_code);
+    reportJSONTime(json, _last_tot, u"local-tot-last", _country_code);
+    reportJSONTime(json, _first_utc, u"utc-system-first");
+    reportJSONTime(json, _last_utc, u"utc-system-last");
+    reportJSONTime(json, _first_local, u"local-system-first");
+    reportJSONTime(json, _last_local, u"local-system-last");
+    json.endObject();
+
+    // Global PIDs.
+    json.beginObject(u"global");
+    json.addInteger(u"pids", _global_pid_cnt);
+    json.addInteger(u"clear-pids", _global_pid_cnt - _global_scr_pids);
+    json.addInteger(u"scrambled-pids", _global_scr_pids);
+    json.addInteger(u"packets", _global_pkt_cnt);
+    json.addInteger(u"bitrate", _global_bitrate);
+    json.addInteger(u"bitrate-204", ToBitrate204(_global_bitrate));
+    json.addBoolean(u"scrambled", _global_scr_pids > 0);
+    reportJSONPIDList(json, u"pid-list", true);
+    json.endObject();
+
+    // Unreferenced PIDs.
+    json.beginObject(u"unreferenced");
+    json.addInteger(u"pids", _unref_pid_cnt);
+    json.addInteger(u"clear-pids", _unref_pid_cnt - _unref_scr_pids);
+    json.addInteger(u"scrambled-pids", _unref_scr_pids);
+    json.addInteger(u"packets", _unref_pkt_cnt);
+    json.addInteger(u"bitrate", _unref_bitrate);
+    json.addInteger(u"bitrate-204", ToBitrate204(_unref_bitrate));
+    json.addBoolean(u"scrambled", _unref_scr_pids > 0);
+    reportJSONPIDList(json, u"pid-list", false);
+    json.endObject();
+
+    // One object per service.
+    json.beginArray(u"services");
+    for (ServiceContextMap::const_iterator it = _services.begin(); it != _services.end(); ++it) {
+        const ServiceContext& sv(*it->second);
+        json.beginObject();
+        json.addInteger(u"id", sv.service_id);
+        json.addInteger(u"tsid", _ts_id);
+        json.addInteger(u"original-network-id", sv.orig_netw_id);
+        json.addInteger(u"type", sv.service_type);
+        json.addString(u"provider", sv.getProvider());
+        json.addString(u"name", sv.getName());
+        json.addBoolean(u"scrambled", sv.scrambled_pid_cnt > 0);
+        json.addBoolean(u"ssu", sv.carry_ssu);
+        json.addBoolean(u"t2mi", sv.carry_t2mi);
+        json.addInteger(u"pids", sv.pid_cnt);
+        json.addInteger(u"clear-pids", sv.pid_cnt - sv.scrambled_pid_cnt);
+        json.addInteger(u"scrambled-pids", sv.scrambled_pid_cnt);
+        json.addInteger(u"packets", sv.ts_pkt_cnt);
+        json.addInteger(u"bitrate", sv.bitrate);
+        json.addInteger(u"bitrate-204", ToBitrate204(sv.bitrate));
+        if (sv.pmt_pid != 0) {
+            json.addInteger(u"pmt-pid", sv.pmt_pid);
+        }
+        if (sv.pcr_pid != 0 && sv.pcr_pid != PID_NULL) {
+            json.addInteger(u"pcr-pid", sv.pcr_pid);
+        }
+        json.beginArray(u"pid-list");
+        for (PIDContextMap::const_iterator it_pid = _pids.begin(); it_pid != _pids.end(); ++it_pid) {
+            if (it_pid->second->services.count(sv.service_id) != 0) {
+                json.addInteger(UString(), it_pid->first);
+            }
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+
+    // One object per PID.
+    json.beginArray(u"pids");
+    for (PIDContextMap::const_iterator it = _pids.begin(); it != _pids.end(); ++it) {
+        const PIDContext& pc(*it->second);
+        if (pc.ts_pkt_cnt == 0 && pc.optional) {
+            continue;
+        }
+        json.beginObject();
+        json.addInteger(u"pid", pc.pid);
+        json.addString(u"description", pc.fullDescription(true));
+        json.addBoolean(u"pmt", pc.is_pmt_pid);
+        json.addBoolean(u"ecm", pc.carry_ecm);
+        json.addBoolean(u"emm", pc.carry_emm);
+        json.addBoolean(u"audio", pc.carry_audio);
+        json.addBoolean(u"video", pc.carry_video);
+        json.addBoolean(u"t2mi", pc.carry_t2mi);
+        json.addBoolean(u"scrambled", pc.scrambled);
+        if (pc.cas_id != 0) {
+            json.addInteger(u"cas", pc.cas_id);
+        }
+        if (!pc.cas_operators.empty()) {
+            json.beginArray(u"operators");
+            for (std::set<uint32_t>::const_iterator it1 = pc.cas_operators.begin(); it1 != pc.cas_operators.end(); ++it1) {
+                json.addInteger(UString(), *it1);
+            }
+            json.endArray();
+        }
+        if (pc.crypto_period != 0 && _ts_bitrate != 0) {
+            json.addInteger(u"crypto-period", (pc.crypto_period * PKT_SIZE * 8) / _ts_bitrate);
+        }
+        if (pc.same_stream_id) {
+            json.addInteger(u"stream-id", pc.pes_stream_id);
+        }
+        if (!pc.language.empty()) {
+            json.addString(u"language", pc.language);
+        }
+        json.addBoolean(u"global", pc.referenced && pc.services.empty());
+        json.addBoolean(u"unreferenced", !pc.referenced);
+        json.beginArray(u"services");
+        for (ServiceIdSet::const_iterator it1 = pc.services.begin(); it1 != pc.services.end(); ++it1) {
+            json.addInteger(UString(), *it1);
+        }
+        json.endArray();
+        if (!pc.ssu_oui.empty()) {
+            json.beginArray(u"ssu-oui");
+            for (std::set<uint32_t>::const_iterator it1 = pc.ssu_oui.begin(); it1 != pc.ssu_oui.end(); ++it1) {
+                json.addInteger(UString(), *it1);
+            }
+            json.endArray();
+        }
+        if (pc.carry_t2mi) {
+            json.beginArray(u"plp");
+            for (std::map<uint8_t, uint64_t>::const_iterator it1 = pc.t2mi_plp_ts.begin(); it1 != pc.t2mi_plp_ts.end(); ++it1) {
+                json.addInteger(UString(), it1->first);
+            }
+            json.endArray();
+        }
+        json.addInteger(u"bitrate", pc.bitrate);
+        json.addInteger(u"bitrate-204", ToBitrate204(pc.bitrate));
+        json.beginObject(u"packets");
+        json.addInteger(u"total", pc.ts_pkt_cnt);
+        json.addInteger(u"clear", pc.ts_pkt_cnt - pc.ts_sc_cnt - pc.inv_ts_sc_cnt);
+        json.addInteger(u"scrambled", pc.ts_sc_cnt);
+        json.addInteger(u"invalid-scrambling", pc.inv_ts_sc_cnt);
+        json.addInteger(u"af", pc.ts_af_cnt);
+        json.addInteger(u"pcr", pc.pcr_cnt);
+        json.addInteger(u"discontinuities", pc.unexp_discont);
+        json.addInteger(u"duplicated", pc.duplicated);
+        if (pc.carry_pes) {
+            json.addInteger(u"pes", pc.pl_start_cnt);
+            json.addInteger(u"invalid-pes-prefix", pc.inv_pes_start);
+        }
+        else {
+            json.addInteger(u"unit-start", pc.unit_start_cnt);
+        }
+        json.endObject();
+        json.endObject();
+    }
+    json.endArray();
+
+    // One object per table.
+    json.beginArray(u"tables");
+    for (PIDContextMap::const_iterator pci = _pids.begin(); pci != _pids.end(); ++pci) {
+        const PIDContext& pc(*pci->second);
+        for (ETIDContextMap::const_iterator it = pc.sections.begin(); it != pc.sections.end(); ++it) {
+            const ETIDContext& etc(*it->second);
+            json.beginObject();
+            json.addInteger(u"pid", pc.pid);
+            json.addInteger(u"tid", etc.etid.tid());
+            if (etc.etid.isLongSection()) {
+                json.addInteger(u"tid-ext", etc.etid.tidExt());
+            }
+            json.addInteger(u"tables", etc.table_count);
+            json.addInteger(u"sections", etc.section_count);
+            json.beginObject(u"repetition-packets");
+            json.addInteger(u"average", etc.repetition_ts);
+            json.addInteger(u"min", etc.min_repetition_ts);
+            json.addInteger(u"max", etc.max_repetition_ts);
+            json.endObject();
+            if (_ts_bitrate != 0) {
+                json.beginObject(u"repetition-ms");
+                json.addInteger(u"average", PacketInterval(_ts_bitrate, etc.repetition_ts));
+                json.addInteger(u"min", PacketInterval(_ts_bitrate, etc.min_repetition_ts));
+                json.addInteger(u"max", PacketInterval(_ts_bitrate, etc.max_repetition_ts));
+                json.endObject();
+            }
+            if (etc.versions.any()) {
+                json.addInteger(u"first-version", etc.first_version);
+                json.addInteger(u"last-version", etc.last_version);
+                json.beginArray(u"versions");
+                for (size_t i = 0; i < etc.versions.size(); ++i) {
+                    if (etc.versions.test(i)) {
+                        json.addInteger(UString(), i);
+                    }
+                }
+                json.endArray();
+            }
+            json.endObject();
+        }
+    }
+    json.endArray();
+
+    json.endObject();
+}
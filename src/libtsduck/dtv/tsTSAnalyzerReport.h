@@ -36,6 +36,7 @@
 #include "tsTSAnalyzer.h"
 #include "tsTSAnalyzerOptions.h"
 #include "tsGrid.h"
+#include "tsjsonStreamWriter.h"
 
 namespace ts {
     //!
@@ -124,6 +125,15 @@ namespace ts {
         //!
         void reportNormalized(std::ostream& strm, const UString& title = UString());
 
+        //!
+        //! This methods displays a JSON report.
+        //! The JSON text is directly streamed, without building an in-memory JSON tree.
+        //! @param [in,out] strm Output text stream.
+        //! @param [in] title Title string to display.
+        //! @param [in] compact If true, the JSON report is written in compact form on one single line.
+        //!
+        void reportJSON(std::ostream& strm, const UString& title = UString(), bool compact = false);
+
     private:
         // Display header of a service PID list.
         void reportServiceHeader(Grid& grid, const UString& usage, bool scrambled, BitRate bitrate, BitRate ts_bitrate, bool wide) const;
@@ -142,5 +152,11 @@ namespace ts {
 
         // Display one normalized line of a time value.
         static void reportNormalizedTime(std::ostream&, const Time&, const char* type, const UString& country = UString());
+
+        // Add a JSON object for a time value.
+        static void reportJSONTime(json::StreamWriter&, const Time&, const UString& name, const UString& country = UString());
+
+        // Add a JSON array of PID's.
+        void reportJSONPIDList(json::StreamWriter&, const UString& name, bool global) const;
     };
 }
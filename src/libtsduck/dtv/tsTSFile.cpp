@@ -33,6 +33,23 @@
 #include "tsSysUtils.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TSFile::DEFAULT_QUEUE_DEPTH;
+#endif
+
+// Size of a mapped window of the file in READ_MMAP mode.
+#define MMAP_WINDOW_SIZE (64 * 1024 * 1024)
+
+// Size and alignment of each asynchronous read request in READ_DIRECT mode.
+#define DIRECT_REQUEST_SIZE (1024 * 1024)
+#define DIRECT_ALIGNMENT 4096
+
+const ts::Enumeration ts::TSFile::ReadModeEnum({
+    {u"standard", ts::TSFile::READ_STANDARD},
+    {u"mmap",     ts::TSFile::READ_MMAP},
+    {u"direct",   ts::TSFile::READ_DIRECT},
+});
+
 
 //----------------------------------------------------------------------------
 // Default constructor.
@@ -51,10 +68,25 @@ ts::TSFile::TSFile() :
     _aborted(false),
     _rewindable(false),
     _regular(false),
+    _read_mode(READ_STANDARD),
+    _queue_depth(DEFAULT_QUEUE_DEPTH),
+    _cur_mode(READ_STANDARD),
+    _file_pos(0),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
-    _fd(-1)
+    _fd(-1),
+    _file_size(0),
+    _map_base(nullptr),
+    _map_size(0),
+    _map_offset(0),
+    _aio(),
+    _aio_buffer(),
+    _aio_next(0),
+    _aio_index(0),
+    _aio_size(NPOS),
+    _aio_offset(0),
+    _aio_started(false)
 #endif
 {
 }
@@ -77,10 +109,25 @@ ts::TSFile::TSFile(const TSFile& other) :
     _aborted(false),
     _rewindable(false),
     _regular(false),
+    _read_mode(other._read_mode),
+    _queue_depth(other._queue_depth),
+    _cur_mode(READ_STANDARD),
+    _file_pos(0),
 #if defined(TS_WINDOWS)
     _handle(INVALID_HANDLE_VALUE)
 #else
-    _fd(-1)
+    _fd(-1),
+    _file_size(0),
+    _map_base(nullptr),
+    _map_size(0),
+    _map_offset(0),
+    _aio(),
+    _aio_buffer(),
+    _aio_next(0),
+    _aio_index(0),
+    _aio_size(NPOS),
+    _aio_offset(0),
+    _aio_started(false)
 #endif
 {
 }
@@ -103,18 +150,37 @@ ts::TSFile::TSFile(TSFile&& other) noexcept :
     _aborted(other._aborted),
     _rewindable(other._rewindable),
     _regular(other._regular),
+    _read_mode(other._read_mode),
+    _queue_depth(other._queue_depth),
+    _cur_mode(other._cur_mode),
+    _file_pos(other._file_pos),
 #if defined(TS_WINDOWS)
     _handle(other._handle)
 #else
-    _fd(other._fd)
+    _fd(other._fd),
+    _file_size(other._file_size),
+    _map_base(other._map_base),
+    _map_size(other._map_size),
+    _map_offset(other._map_offset),
+    _aio(std::move(other._aio)),           // pending requests are not moved in memory
+    _aio_buffer(std::move(other._aio_buffer)),
+    _aio_next(other._aio_next),
+    _aio_index(other._aio_index),
+    _aio_size(other._aio_size),
+    _aio_offset(other._aio_offset),
+    _aio_started(other._aio_started)
 #endif
 {
     // Mark other object as closed, just in case.
     other._is_open = false;
+    other._cur_mode = READ_STANDARD;
 #if defined(TS_WINDOWS)
     other._handle = INVALID_HANDLE_VALUE;
 #else
     other._fd = -1;
+    other._map_base = nullptr;
+    other._map_size = 0;
+    other._aio_started = false;
 #endif
 }
 
@@ -152,6 +218,17 @@ ts::UString ts::TSFile::getDisplayFileName() const
 }
 
 
+//----------------------------------------------------------------------------
+// Set the read mode of regular files.
+//----------------------------------------------------------------------------
+
+void ts::TSFile::setReadMode(ReadMode mode, size_t queue_depth)
+{
+    _read_mode = mode;
+    _queue_depth = std::max<size_t>(1, queue_depth);
+}
+
+
 //----------------------------------------------------------------------------
 // Open file for read in a rewindable mode.
 //----------------------------------------------------------------------------
@@ -337,10 +414,15 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
 
     // Close first if this is a reopen.
     if (reopen) {
+        stopDirect();
+        unmapFile();
         ::close(_fd);
         _fd = -1;
     }
 
+    // Special read modes apply to named read-only regular files only.
+    const bool special_read = read_only && !_filename.empty() && _read_mode != READ_STANDARD;
+
     if (read_only) {
         uflags |= O_RDONLY;
     }
@@ -363,7 +445,16 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
     }
     else {
         // Open a named file.
+        _fd = -1;
+#if defined(O_DIRECT)
+        // Bypass the page cache in direct read mode. Some file systems do not support it.
+        if (special_read && _read_mode == READ_DIRECT && (_fd = ::open(_filename.toUTF8().c_str(), uflags | O_DIRECT, mode)) < 0) {
+            report.debug(u"cannot open %s with O_DIRECT: %s", {_filename, ErrorCodeMessage(LastErrorCode())});
+        }
+        if (_fd < 0 && (_fd = ::open(_filename.toUTF8().c_str(), uflags, mode)) < 0) {
+#else
         if ((_fd = ::open(_filename.toUTF8().c_str(), uflags, mode)) < 0) {
+#endif
             const ErrorCode err = LastErrorCode();
             report.log(_severity, u"cannot open file %s: %s", {getDisplayFileName(), ErrorCodeMessage(err)});
             return false;
@@ -393,6 +484,24 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
         return false;
     }
     _regular = S_ISREG(st.st_mode);
+    _file_size = uint64_t(st.st_size);
+
+    // Select the actual read mode.
+    _cur_mode = special_read && _regular ? _read_mode : READ_STANDARD;
+#if defined(O_DIRECT)
+    // O_DIRECT requires aligned buffers, only the READ_DIRECT mode can use it.
+    if (special_read && _cur_mode != READ_DIRECT) {
+        const int fl = ::fcntl(_fd, F_GETFL);
+        if (fl >= 0 && (fl & O_DIRECT) != 0) {
+            ::fcntl(_fd, F_SETFL, fl & ~O_DIRECT);
+        }
+    }
+#elif defined(TS_MAC)
+    // Equivalent of O_DIRECT on macOS.
+    if (_cur_mode == READ_DIRECT) {
+        ::fcntl(_fd, F_NOCACHE, 1);
+    }
+#endif
 
     // Check if seek is required or possible.
     if (!seekCheck(report)) {
@@ -414,6 +523,9 @@ bool ts::TSFile::openInternal(bool reopen, Report& report)
 
 #endif
 
+    // Position of next read in READ_MMAP and READ_DIRECT modes.
+    _file_pos = _start_offset;
+
     // Reset counters only if not a reopen.
     if (!reopen) {
         _total_read = _total_write = 0;
@@ -456,6 +568,9 @@ bool ts::TSFile::seekCheck(Report& report)
 
 bool ts::TSFile::seekInternal(uint64_t index, Report& report)
 {
+    // Data which were read before the new position are no longer valid.
+    discardResyncBuffer();
+
     // If seeking at the beginning and REOPEN is set, close and reopen the file.
     if (index == 0 && (_flags & REOPEN) != 0) {
         return openInternal(true, report);
@@ -463,6 +578,16 @@ bool ts::TSFile::seekInternal(uint64_t index, Report& report)
 
     report.debug(u"seeking %s at offset %'d", {_filename, _start_offset + index});
 
+#if !defined(TS_WINDOWS)
+    // In READ_MMAP and READ_DIRECT modes, there is no file pointer, the next read starts at the new position.
+    if (_cur_mode != READ_STANDARD) {
+        stopDirect();
+        _file_pos = _start_offset + index;
+        _at_eof = false;
+        return true;
+    }
+#endif
+
 #if defined(TS_WINDOWS)
     // In Win32, LARGE_INTEGER is a 64-bit structure, not an integer type
     uint64_t where = _start_offset + index;
@@ -513,6 +638,11 @@ bool ts::TSFile::close(Report& report)
         return false;
     }
 
+#if !defined(TS_WINDOWS)
+    stopDirect();
+    unmapFile();
+#endif
+
     if (!_filename.empty()) {
 #if defined(TS_WINDOWS)
         ::CloseHandle(_handle);
@@ -522,6 +652,7 @@ bool ts::TSFile::close(Report& report)
     }
 
     _is_open = _at_eof = _aborted = false;
+    _cur_mode = READ_STANDARD;
     _total_read = _total_write = 0;
     _flags = NONE;
     _filename.clear();
@@ -581,6 +712,13 @@ bool ts::TSFile::readStreamPartial(void* buffer, size_t request_size, size_t& re
 #else
 
     // UNIX implementation
+    if (_cur_mode == READ_MMAP) {
+        return readMapped(buffer, request_size, read_size, report);
+    }
+    else if (_cur_mode == READ_DIRECT) {
+        return readDirect(buffer, request_size, read_size, report);
+    }
+
     for (;;) {
         const ssize_t insize = ::read(_fd, buffer, request_size);
         if (insize == 0) {
@@ -619,7 +757,8 @@ size_t ts::TSFile::readPackets(TSPacket* buffer, TSPacketMetadata* metadata, siz
 
     // Repeat reading packets until the buffer is full or error.
     // Rewind on end of file if repeating is set.
-    while (max_packets > 0 && !_at_eof) {
+    // In resynchronization mode, the data which are still buffered are processed first.
+    while (max_packets > 0 && (!_at_eof || resyncPending())) {
 
         // Invoke superclass.
         const size_t count = TSPacketStream::readPackets(buffer, metadata, max_packets, report);
@@ -639,7 +778,7 @@ size_t ts::TSFile::readPackets(TSPacket* buffer, TSPacketMetadata* metadata, siz
         // At end of file, if the file must be repeated a finite number of times,
         // check if this was the last time. If the file must be repeated again,
         // rewind to original start offset.
-        if (_at_eof && (_repeat == 0 || ++_counter < _repeat) && !seekInternal(0, report)) {
+        if (_at_eof && !resyncPending() && (_repeat == 0 || ++_counter < _repeat) && !seekInternal(0, report)) {
             break; // rewind error
         }
     }
@@ -740,3 +879,198 @@ void ts::TSFile::abort()
 #endif
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Read from a memory-mapped file (READ_MMAP mode).
+//----------------------------------------------------------------------------
+
+#if !defined(TS_WINDOWS)
+
+bool ts::TSFile::readMapped(void* buffer, size_t request_size, size_t& read_size, Report& report)
+{
+    // Check end of file. The file may grow while being read (recording in progress).
+    if (_file_pos >= _file_size) {
+        struct stat st;
+        if (::fstat(_fd, &st) == 0) {
+            _file_size = uint64_t(st.st_size);
+        }
+        if (_file_pos >= _file_size) {
+            _at_eof = true;
+            return false;
+        }
+    }
+
+    // Map a new window of the file when the current position is outside the current one.
+    if (_map_base == nullptr || _file_pos < _map_offset || _file_pos >= _map_offset + _map_size) {
+        unmapFile();
+        const uint64_t page_size = uint64_t(::sysconf(_SC_PAGESIZE));
+        _map_offset = _file_pos - _file_pos % page_size;
+        _map_size = size_t(std::min<uint64_t>(MMAP_WINDOW_SIZE, _file_size - _map_offset));
+        void* const base = ::mmap(nullptr, _map_size, PROT_READ, MAP_SHARED, _fd, off_t(_map_offset));
+        if (base == MAP_FAILED) {
+            report.error(u"error mapping %s in memory: %s", {getDisplayFileName(), ErrorCodeMessage(LastErrorCode())});
+            _map_size = 0;
+            return false;
+        }
+        _map_base = reinterpret_cast<uint8_t*>(base);
+        // The file is read sequentially, let the kernel read ahead and free behind.
+        ::madvise(base, _map_size, MADV_SEQUENTIAL);
+    }
+
+    // Copy as much as possible from the current window.
+    read_size = std::min(request_size, size_t(_map_offset + _map_size - _file_pos));
+    ::memcpy(buffer, _map_base + (_file_pos - _map_offset), read_size);
+    _file_pos += read_size;
+    return true;
+}
+
+void ts::TSFile::unmapFile()
+{
+    if (_map_base != nullptr) {
+        ::munmap(_map_base, _map_size);
+        _map_base = nullptr;
+        _map_size = 0;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Read with asynchronous read-ahead requests (READ_DIRECT mode).
+//----------------------------------------------------------------------------
+
+// Address of the aligned buffer of a request.
+uint8_t* ts::TSFile::directBuffer(size_t index)
+{
+    uint8_t* const base = _aio_buffer.data();
+    const size_t misalign = size_t(reinterpret_cast<uintptr_t>(base) % DIRECT_ALIGNMENT);
+    return base + (misalign == 0 ? 0 : DIRECT_ALIGNMENT - misalign) + index * DIRECT_REQUEST_SIZE;
+}
+
+// Submit one read request.
+bool ts::TSFile::submitDirect(size_t index, uint64_t offset, Report& report)
+{
+    ::aiocb& cb(_aio[index]);
+    TS_ZERO(cb);
+    cb.aio_fildes = _fd;
+    cb.aio_offset = off_t(offset);
+    cb.aio_buf = directBuffer(index);
+    cb.aio_nbytes = DIRECT_REQUEST_SIZE;
+    cb.aio_sigevent.sigev_notify = SIGEV_NONE;
+    if (::aio_read(&cb) < 0) {
+        report.error(u"error reading from %s: %s", {getDisplayFileName(), ErrorCodeMessage(LastErrorCode())});
+        return false;
+    }
+    return true;
+}
+
+// Submit all read requests, starting at the current position in file.
+bool ts::TSFile::startDirect(Report& report)
+{
+    // Requests must be aligned in file, start at the previous aligned offset.
+    const uint64_t start = _file_pos - _file_pos % DIRECT_ALIGNMENT;
+
+    // Allocate the buffers once. The requests are not moved in memory while active.
+    _aio.resize(_queue_depth);
+    _aio_buffer.resize(_queue_depth * DIRECT_REQUEST_SIZE + DIRECT_ALIGNMENT);
+
+    _aio_next = 0;
+    _aio_index = size_t(_file_pos - start);
+    _aio_size = NPOS;
+    _aio_offset = start;
+    _aio_started = true;
+
+    for (size_t i = 0; i < _aio.size(); ++i) {
+        if (!submitDirect(i, _aio_offset, report)) {
+            // Make sure that previously submitted requests are not outstanding.
+            _aio.resize(i);
+            stopDirect();
+            return false;
+        }
+        _aio_offset += DIRECT_REQUEST_SIZE;
+    }
+    return true;
+}
+
+// Cancel and wait for all pending requests.
+void ts::TSFile::stopDirect()
+{
+    if (_aio_started) {
+        ::aio_cancel(_fd, nullptr);
+        for (size_t i = 0; i < _aio.size(); ++i) {
+            // Skip the current request when its completion was already collected.
+            if (i != _aio_next || _aio_size == NPOS) {
+                const ::aiocb* list[1] = {&_aio[i]};
+                while (::aio_error(&_aio[i]) == EINPROGRESS) {
+                    ::aio_suspend(list, 1, nullptr);
+                }
+                ::aio_return(&_aio[i]);
+            }
+        }
+        _aio_started = false;
+    }
+}
+
+// Read data from the completed requests, in sequence.
+bool ts::TSFile::readDirect(void* buffer, size_t request_size, size_t& read_size, Report& report)
+{
+    if (!_aio_started && !startDirect(report)) {
+        return false;
+    }
+
+    // Wait for the completion of the next request.
+    ::aiocb& cb(_aio[_aio_next]);
+    if (_aio_size == NPOS) {
+        const ::aiocb* list[1] = {&cb};
+        int err = 0;
+        while ((err = ::aio_error(&cb)) == EINPROGRESS) {
+            ::aio_suspend(list, 1, nullptr);
+        }
+        const ssize_t size = ::aio_return(&cb);
+        if (err != 0 || size < 0) {
+            _aio_size = 0;
+            if (!_aborted) {
+                report.error(u"error reading from %s: %s", {getDisplayFileName(), ErrorCodeMessage(err)});
+            }
+            stopDirect();
+            return false;
+        }
+        _aio_size = size_t(size);
+    }
+
+    // No more data in this request means end of file.
+    if (_aio_index >= _aio_size) {
+        stopDirect();
+        _at_eof = true;
+        return false;
+    }
+
+    // Copy as much as possible from the current request.
+    read_size = std::min(request_size, _aio_size - _aio_index);
+    ::memcpy(buffer, directBuffer(_aio_next) + _aio_index, read_size);
+    _aio_index += read_size;
+    _file_pos += read_size;
+
+    // When the current request is fully read, reuse it to read ahead.
+    if (_aio_index >= _aio_size) {
+        if (_aio_size < DIRECT_REQUEST_SIZE) {
+            // Short read, this was the end of file at the time of the request.
+            // Restart from the current position at next read, the file may have grown.
+            stopDirect();
+        }
+        else if (!submitDirect(_aio_next, _aio_offset, report)) {
+            // Current request was already collected and others may be pending.
+            stopDirect();
+            return false;
+        }
+        else {
+            _aio_offset += DIRECT_REQUEST_SIZE;
+            _aio_next = (_aio_next + 1) % _aio.size();
+            _aio_index = 0;
+            _aio_size = NPOS;
+        }
+    }
+    return true;
+}
+
+#endif
@@ -36,6 +36,11 @@
 #include "tsTSPacketStream.h"
 #include "tsAbstractReadStreamInterface.h"
 #include "tsAbstractWriteStreamInterface.h"
+#include "tsByteBlock.h"
+
+#if !defined(TS_WINDOWS)
+#include <aio.h>
+#endif
 
 namespace ts {
 
@@ -121,6 +126,41 @@ namespace ts {
             REOPEN_SPEC = 0x0080,   //!< Force REOPEN when the file is not a regular file.
         };
 
+        //!
+        //! Read modes of regular files.
+        //! Special files such as pipes and devices are always read using the standard mode.
+        //!
+        enum ReadMode {
+            READ_STANDARD,  //!< Standard read operations into the caller's buffer.
+            READ_MMAP,      //!< Map the file in memory, with a sequential access hint. UNIX only.
+            READ_DIRECT,    //!< Direct I/O (bypass the page cache) with asynchronous read-ahead. UNIX only.
+        };
+
+        //!
+        //! Enumeration description of ts::TSFile::ReadMode.
+        //!
+        static const Enumeration ReadModeEnum;
+
+        //!
+        //! Default number of asynchronous read requests in READ_DIRECT mode.
+        //!
+        static constexpr size_t DEFAULT_QUEUE_DEPTH = 8;
+
+        //!
+        //! Set the read mode of regular files.
+        //! Must be called before opening the file. The default mode is READ_STANDARD.
+        //! On systems where the requested mode is not supported, the standard mode is used.
+        //! @param [in] mode Read mode of regular files.
+        //! @param [in] queue_depth Number of asynchronous read requests in READ_DIRECT mode.
+        //!
+        void setReadMode(ReadMode mode, size_t queue_depth = DEFAULT_QUEUE_DEPTH);
+
+        //!
+        //! Get the read mode of regular files.
+        //! @return The read mode of regular files, as set by setReadMode().
+        //!
+        ReadMode readMode() const { return _read_mode; }
+
         //!
         //! Open or create the file (generic form).
         //! The file is rewindable if the underlying file is seekable, eg. not a pipe.
@@ -208,16 +248,40 @@ namespace ts {
         volatile bool _aborted;        //!< Operation has been aborted, no operation available
         bool          _rewindable;     //!< Opened in rewindable mode
         bool          _regular;        //!< Is a regular file (ie. not a pipe or special device)
+        ReadMode      _read_mode;      //!< Requested read mode of regular files
+        size_t        _queue_depth;    //!< Number of asynchronous read requests in READ_DIRECT mode
+        ReadMode      _cur_mode;       //!< Actual read mode of current file
+        uint64_t      _file_pos;       //!< Offset in file of next byte to read (READ_MMAP, READ_DIRECT)
 #if defined(TS_WINDOWS)
         ::HANDLE      _handle;         //!< File handle
 #else
         int           _fd;             //!< File descriptor
+        uint64_t      _file_size;      //!< Last known file size (READ_MMAP)
+        uint8_t*      _map_base;       //!< Address of current mapped window (READ_MMAP)
+        size_t        _map_size;       //!< Size of current mapped window (READ_MMAP)
+        uint64_t      _map_offset;     //!< Offset in file of current mapped window (READ_MMAP)
+        std::vector<::aiocb> _aio;     //!< Asynchronous read requests, used as a ring (READ_DIRECT)
+        ByteBlock     _aio_buffer;     //!< Buffers for asynchronous read requests (READ_DIRECT)
+        size_t        _aio_next;       //!< Index in _aio of next request to consume (READ_DIRECT)
+        size_t        _aio_index;      //!< Byte index in buffer of next request (READ_DIRECT)
+        size_t        _aio_size;       //!< Data size in buffer of next request, NPOS if not yet completed (READ_DIRECT)
+        uint64_t      _aio_offset;     //!< Offset in file of next request to submit (READ_DIRECT)
+        bool          _aio_started;    //!< Requests are submitted (READ_DIRECT)
 #endif
 
         // Internal methods
         bool openInternal(bool reopen, Report& report);
         bool seekCheck(Report& report);
         bool seekInternal(uint64_t index, Report& report);
+#if !defined(TS_WINDOWS)
+        bool readMapped(void* addr, size_t max_size, size_t& ret_size, Report& report);
+        bool readDirect(void* addr, size_t max_size, size_t& ret_size, Report& report);
+        uint8_t* directBuffer(size_t index);
+        bool startDirect(Report& report);
+        bool submitDirect(size_t index, uint64_t offset, Report& report);
+        void stopDirect();
+        void unmapFile();
+#endif
 
         // Inaccessible operations.
         TSFile& operator=(TSFile&) = delete;
@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSFileReadArgs.h"
+#include "tsArgs.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::TSFileReadArgs::TSFileReadArgs() :
+    read_mode(TSFile::READ_STANDARD),
+    queue_depth(TSFile::DEFAULT_QUEUE_DEPTH),
+    resync(false)
+{
+}
+
+ts::TSFileReadArgs::~TSFileReadArgs()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Define command line options in an Args.
+//----------------------------------------------------------------------------
+
+void ts::TSFileReadArgs::defineArgs(Args& args) const
+{
+    args.option(u"read-mode", 0, TSFile::ReadModeEnum);
+    args.help(u"read-mode", u"name",
+              u"Specify how regular input files are read. "
+              u"The mode 'standard' uses standard read operations. "
+              u"The mode 'mmap' maps the file in memory with a sequential access hint, "
+              u"reducing the number of system calls. "
+              u"The mode 'direct' bypasses the system cache and reads ahead using asynchronous "
+              u"read requests (see option --queue-depth). It avoids polluting the cache "
+              u"when reading very large files. "
+              u"The modes 'mmap' and 'direct' are not available on Windows. "
+              u"Pipes and devices are always read in standard mode. "
+              u"The default is 'standard'.");
+
+    args.option(u"queue-depth", 0, Args::INTEGER, 0, 1, 1, 256);
+    args.help(u"queue-depth",
+              u"With --read-mode direct, specify the number of asynchronous read requests of 1 MB each. "
+              u"The default is " + UString::Decimal(TSFile::DEFAULT_QUEUE_DEPTH) + u".");
+
+    args.option(u"resync");
+    args.help(u"resync",
+              u"Resynchronize the TS packets in corrupted or non-standard input files. "
+              u"The input data are scanned for sequences of consecutive 188-byte (TS), "
+              u"204-byte (TS with trailing Reed-Solomon outer FEC) or 192-byte (M2TS) packets. "
+              u"Garbage data are skipped and the synchronization is searched again when lost. "
+              u"In this mode, the file format is always automatically detected.");
+}
+
+
+//----------------------------------------------------------------------------
+// Load arguments from command line.
+// Args error indicator is set in case of incorrect arguments
+//----------------------------------------------------------------------------
+
+bool ts::TSFileReadArgs::loadArgs(DuckContext& duck, Args& args)
+{
+    read_mode = args.enumValue<TSFile::ReadMode>(u"read-mode", TSFile::READ_STANDARD);
+    queue_depth = args.intValue<size_t>(u"queue-depth", TSFile::DEFAULT_QUEUE_DEPTH);
+    resync = args.present(u"resync");
+    return true;
+}
@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Command line arguments for the read mode of TS files.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsArgsSupplierInterface.h"
+#include "tsTSFile.h"
+
+namespace ts {
+    //!
+    //! Command line arguments for the read mode of TS files (@c -\-read-mode, @c -\-queue-depth and @c -\-resync).
+    //! @ingroup cmd
+    //!
+    class TSDUCKDLL TSFileReadArgs : public ArgsSupplierInterface
+    {
+        TS_NOCOPY(TSFileReadArgs);
+    public:
+        // Public fields
+        TSFile::ReadMode read_mode;    //!< Read mode of regular files.
+        size_t           queue_depth;  //!< Number of asynchronous read requests in direct mode.
+        bool             resync;       //!< Resynchronize packets in corrupted or non-standard files.
+
+        //!
+        //! Default constructor.
+        //!
+        TSFileReadArgs();
+
+        //!
+        //! Virtual destructor.
+        //!
+        virtual ~TSFileReadArgs();
+
+        // Implementation of ArgsSupplierInterface.
+        virtual void defineArgs(Args& args) const override;
+        virtual bool loadArgs(DuckContext& duck, Args& args) override;
+
+        //!
+        //! Apply the read mode to a TS file, before opening it.
+        //! @param [in,out] file The TS file to configure.
+        //!
+        void apply(TSFile& file) const
+        {
+            file.setReadMode(read_mode, queue_depth);
+            file.setResync(resync);
+        }
+    };
+}
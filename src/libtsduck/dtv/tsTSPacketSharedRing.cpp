@@ -0,0 +1,657 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSPacketSharedRing.h"
+#include "tsNullReport.h"
+#include "tsSysUtils.h"
+#include "tsMemory.h"
+#include "tsGuard.h"
+#include <atomic>
+#if defined(TS_LINUX)
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TSPacketSharedRing::DEFAULT_SIZE;
+#endif
+
+const ts::UChar* const ts::TSPacketSharedRing::ENVIRONMENT_VARIABLE = u"TSDUCK_SHM_RING";
+
+
+//----------------------------------------------------------------------------
+// Internal definitions.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Magic number at the beginning of a shared memory ring ("TSRR").
+    constexpr uint32_t RING_MAGIC = 0x54535252;
+
+    // Flags in the ring header.
+    constexpr uint32_t FLAG_EOF  = 0x0001;  // The producer has reported an end of file.
+    constexpr uint32_t FLAG_STOP = 0x0002;  // The consumer has reported a stop condition.
+
+    // Maximum duration of one individual wait, before checking abort and peer termination.
+    constexpr ts::MilliSecond WAIT_SLICE = 100;
+
+    // Minimum interval between two checks of the peer process.
+    constexpr ts::MilliSecond PEER_CHECK_INTERVAL = 100;
+
+    // Alignment of the various areas in the shared memory segment (cache line).
+    constexpr size_t AREA_ALIGN = 64;
+
+    // The atomic variables are shared between processes, they must be lock-free
+    // and the futex words must have the same layout as plain 32-bit integers.
+    static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "lock-free atomic integers are required in shared memory");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "invalid layout for atomic futex words");
+
+    // Round up a size to an area alignment.
+    size_t AlignArea(size_t size)
+    {
+        return (size + AREA_ALIGN - 1) & ~(AREA_ALIGN - 1);
+    }
+
+    // Wait until a futex word no longer contains a given value, with a timeout.
+    // Spurious returns are possible, the caller must always recheck its condition.
+    void WaitWord(std::atomic<uint32_t>& word, uint32_t value, ts::MilliSecond timeout)
+    {
+#if defined(TS_LINUX)
+        ::timespec ts;
+        ts.tv_sec = ::time_t(timeout / ts::MilliSecPerSec);
+        ts.tv_nsec = long((timeout % ts::MilliSecPerSec) * ts::NanoSecPerMilliSec);
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, value, &ts, nullptr, 0);
+#else
+        // No futex, simply poll the ring.
+        if (word.load() == value) {
+            ts::SleepThread(1);
+        }
+#endif
+    }
+
+    // Wake up all processes which are waiting on a futex word.
+    void WakeWord(std::atomic<uint32_t>& word)
+    {
+#if defined(TS_LINUX)
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+
+#if !defined(TS_WINDOWS)
+
+    // Check if a process is still alive.
+    bool ProcessAlive(int32_t pid)
+    {
+        // A terminated child process remains a zombie until it is waited for by its parent.
+        // Detect this case without reaping the child, this is done by the owner of the child.
+        ::siginfo_t info;
+        TS_ZERO(info);
+        if (::waitid(P_PID, ::id_t(pid), &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == pid) {
+            return false;
+        }
+        return ::kill(::pid_t(pid), 0) == 0 || errno == EPERM;
+    }
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Header of the shared memory segment.
+// The write and read sides are in distinct cache lines.
+//----------------------------------------------------------------------------
+
+struct ts::TSPacketSharedRing::Header
+{
+    uint32_t              magic;             // RING_MAGIC.
+    uint32_t              header_size;       // Size of this structure, check binary compatibility.
+    uint32_t              mdata_size;        // Size of TSPacketMetadata, check binary compatibility.
+    uint32_t              packet_count;      // Size of the ring in packets.
+    uint32_t              creator_role;      // Role of the creator process.
+    std::atomic<int32_t>  creator_pid;       // Process id of the creator.
+    std::atomic<int32_t>  attacher_pid;      // Process id of the attached process, zero if not yet attached.
+    std::atomic<uint32_t> flags;             // FLAG_EOF, FLAG_STOP.
+
+    alignas(AREA_ALIGN)
+    std::atomic<uint64_t> write_count;       // Total number of packets written by the producer.
+    std::atomic<uint32_t> data_word;         // Futex word, incremented when packets are written and the consumer waits.
+    std::atomic<uint32_t> consumer_waiting;  // The consumer waits on data_word.
+
+    alignas(AREA_ALIGN)
+    std::atomic<uint64_t> read_count;        // Total number of packets read by the consumer.
+    std::atomic<uint32_t> space_word;        // Futex word, incremented when packets are read and the producer waits.
+    std::atomic<uint32_t> producer_waiting;  // The producer waits on space_word.
+};
+
+
+//----------------------------------------------------------------------------
+// Constructors and destructors.
+//----------------------------------------------------------------------------
+
+ts::TSPacketSharedRing::TSPacketSharedRing() :
+    _mutex(),
+    _header(nullptr),
+    _base(nullptr),
+    _map_size(0),
+    _size(0),
+    _packets(nullptr),
+    _mdata(nullptr),
+    _role(CONSUMER),
+    _creator(false),
+    _aborted(false),
+    _peer_dead(false),
+    _peer_pid(0),
+    _peer_check(),
+    _name()
+{
+}
+
+ts::TSPacketSharedRing::~TSPacketSharedRing()
+{
+    close(NULLREP);
+}
+
+
+//----------------------------------------------------------------------------
+// Create a new shared memory ring with a unique name.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::create(Role role, size_t size, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared memory ring %s is already open", {_name});
+        return false;
+    }
+
+#if defined(TS_WINDOWS)
+
+    report.error(u"shared memory packet rings are not supported on Windows");
+    return false;
+
+#else
+
+    // Build a unique name. Keep it short, some systems limit the size of shared memory names.
+    static std::atomic<uint32_t> counter(0);
+    _name.format(u"/tsduck-%d-%d", {::getpid(), counter++});
+
+    const std::string name8(_name.toUTF8());
+    const int fd = ::shm_open(name8.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        report.error(u"error creating shared memory %s: %s", {_name, ErrorCodeMessage()});
+        _name.clear();
+        return false;
+    }
+
+    // Compute the layout of the shared memory segment.
+    _size = std::max<size_t>(1, std::min<size_t>(size, std::numeric_limits<uint32_t>::max()));
+    const size_t map_size = SegmentSize(_size);
+
+    bool ok = ::ftruncate(fd, ::off_t(map_size)) == 0;
+    if (!ok) {
+        report.error(u"error resizing shared memory %s: %s", {_name, ErrorCodeMessage()});
+    }
+    else {
+        ok = map(fd, map_size, report);
+    }
+    ::close(fd);
+
+    if (!ok) {
+        ::shm_unlink(name8.c_str());
+        _name.clear();
+        return false;
+    }
+
+    // Initialize the ring.
+    setAreas();
+    {
+        Guard lock(_mutex);
+        _header = new(_base) Header();
+    }
+    _header->magic = RING_MAGIC;
+    _header->header_size = uint32_t(sizeof(Header));
+    _header->mdata_size = uint32_t(sizeof(TSPacketMetadata));
+    _header->packet_count = uint32_t(_size);
+    _header->creator_role = uint32_t(role);
+    _header->creator_pid = int32_t(::getpid());
+    for (size_t i = 0; i < _size; ++i) {
+        new(&_mdata[i]) TSPacketMetadata();
+    }
+
+    _role = role;
+    _creator = true;
+    report.debug(u"created shared memory ring %s, %'d packets", {_name, _size});
+    return true;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Attach to an existing shared memory ring.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::attach(const UString& name, Role role, Report& report)
+{
+    if (isOpen()) {
+        report.error(u"shared memory ring %s is already open", {_name});
+        return false;
+    }
+
+#if defined(TS_WINDOWS)
+
+    report.error(u"shared memory packet rings are not supported on Windows");
+    return false;
+
+#else
+
+    _name = name;
+    const std::string name8(_name.toUTF8());
+    const int fd = ::shm_open(name8.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        report.error(u"error opening shared memory %s: %s", {_name, ErrorCodeMessage()});
+        _name.clear();
+        return false;
+    }
+
+    // Map the complete segment. Some systems round up the size of the segment to a page size.
+    struct ::stat st;
+    bool ok = ::fstat(fd, &st) == 0;
+    if (!ok) {
+        report.error(u"error getting size of shared memory %s: %s", {name, ErrorCodeMessage()});
+    }
+    else if (size_t(st.st_size) < sizeof(Header)) {
+        report.error(u"shared memory %s is not a TS packet ring", {name});
+        ok = false;
+    }
+    else {
+        ok = map(fd, size_t(st.st_size), report);
+    }
+    ::close(fd);
+    if (!ok) {
+        _name.clear();
+        return false;
+    }
+
+    // Check that the segment was created by a compatible version of TSDuck.
+    {
+        Guard lock(_mutex);
+        _header = reinterpret_cast<Header*>(_base);
+    }
+    _size = _header->packet_count;
+    if (_header->magic != RING_MAGIC ||
+        _header->header_size != sizeof(Header) ||
+        _header->mdata_size != sizeof(TSPacketMetadata) ||
+        _size == 0 ||
+        _map_size < SegmentSize(_size))
+    {
+        report.error(u"shared memory %s is not a TS packet ring or was created by an incompatible version", {name});
+        unmap();
+        _name.clear();
+        return false;
+    }
+    if (_header->creator_role == uint32_t(role)) {
+        report.error(u"shared memory ring %s: attaching process must be a %s", {name, role == PRODUCER ? u"consumer" : u"producer"});
+        unmap();
+        _name.clear();
+        return false;
+    }
+
+    setAreas();
+
+    // There must be only one attached process.
+    int32_t expected = 0;
+    if (!_header->attacher_pid.compare_exchange_strong(expected, int32_t(::getpid()))) {
+        report.error(u"shared memory ring %s is already used by process %d", {name, expected});
+        unmap();
+        _name.clear();
+        return false;
+    }
+
+    // Now that the two processes have mapped the segment, remove its name.
+    // The segment remains in memory until it is unmapped by the two processes.
+    ::shm_unlink(name8.c_str());
+
+    _role = role;
+    _creator = false;
+    report.debug(u"attached to shared memory ring %s, %'d packets", {_name, _size});
+    return true;
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Map / unmap a shared memory segment.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::map(int fd, size_t map_size, Report& report)
+{
+#if defined(TS_WINDOWS)
+    return false;
+#else
+    void* base = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        report.error(u"error mapping shared memory %s: %s", {_name, ErrorCodeMessage()});
+        return false;
+    }
+    _base = base;
+    _map_size = map_size;
+    _aborted = false;
+    _peer_dead = false;
+    _peer_check = Time::Epoch;
+    return true;
+#endif
+}
+
+size_t ts::TSPacketSharedRing::SegmentSize(size_t size)
+{
+    return MetadataOffset(size) + size * sizeof(TSPacketMetadata);
+}
+
+size_t ts::TSPacketSharedRing::MetadataOffset(size_t size)
+{
+    return AlignArea(AlignArea(sizeof(Header)) + size * PKT_SIZE);
+}
+
+void ts::TSPacketSharedRing::setAreas()
+{
+    uint8_t* const base = reinterpret_cast<uint8_t*>(_base);
+    _packets = reinterpret_cast<TSPacket*>(base + AlignArea(sizeof(Header)));
+    _mdata = reinterpret_cast<TSPacketMetadata*>(base + MetadataOffset(_size));
+}
+
+void ts::TSPacketSharedRing::unmap()
+{
+    // Do not unmap while abort() uses the header in another thread.
+    Guard lock(_mutex);
+#if !defined(TS_WINDOWS)
+    if (_base != nullptr) {
+        ::munmap(_base, _map_size);
+    }
+#endif
+    _header = nullptr;
+    _base = nullptr;
+    _peer_pid = 0;
+    _map_size = 0;
+    _size = 0;
+    _packets = nullptr;
+    _mdata = nullptr;
+}
+
+
+//----------------------------------------------------------------------------
+// Close the ring.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::close(Report& report)
+{
+    if (!isOpen()) {
+        return true;
+    }
+
+    // Notify the peer.
+    if (_role == PRODUCER) {
+        setEOF();
+    }
+    else {
+        _header->flags.fetch_or(FLAG_STOP);
+        _header->space_word++;
+        WakeWord(_header->space_word);
+    }
+
+    unmap();
+
+#if !defined(TS_WINDOWS)
+    // If the peer never attached, the name still exists.
+    if (_creator) {
+        ::shm_unlink(_name.toUTF8().c_str());
+    }
+#endif
+
+    report.debug(u"closed shared memory ring %s", {_name});
+    _name.clear();
+    _creator = false;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Abort any current or future wait in this process.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketSharedRing::abort()
+{
+    _aborted = true;
+    Guard lock(_mutex);
+    if (_header != nullptr) {
+        // Spurious wake-ups are harmless for the peer process.
+        WakeWord(_header->data_word);
+        WakeWord(_header->space_word);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Check if the peer process is still alive.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::peerAlive(bool force)
+{
+#if !defined(TS_WINDOWS)
+    if (!_peer_dead && _header != nullptr) {
+        const Time now(Time::CurrentUTC());
+        if (force || now - _peer_check >= PEER_CHECK_INTERVAL) {
+            _peer_check = now;
+            // The peer of the creator is unknown until it attaches, use the expected peer if known.
+            int32_t pid = _creator ? _header->attacher_pid.load() : _header->creator_pid.load();
+            if (pid == 0) {
+                pid = int32_t(_peer_pid);
+            }
+            _peer_dead = pid > 0 && !ProcessAlive(pid);
+        }
+    }
+#endif
+    return !_peer_dead;
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for an event on the ring, the caller must recheck its condition.
+// When the peer is waiting, it sets its "waiting" flag before checking the
+// ring. When the ring is updated, the "waiting" flag is checked after the
+// update. With sequentially consistent operations on both sides, either
+// the waiting process sees the update or the updating process sees the
+// "waiting" flag and increments the futex word before waking the peer.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::waitForData(const AbortInterface* abort)
+{
+    const uint32_t value = _header->data_word.load();
+    _header->consumer_waiting.store(1);
+    if (_header->write_count.load() == _header->read_count.load() && (_header->flags.load() & FLAG_EOF) == 0) {
+        WaitWord(_header->data_word, value, WAIT_SLICE);
+    }
+    _header->consumer_waiting.store(0);
+    return !_aborted && (abort == nullptr || !abort->aborting()) && peerAlive(false);
+}
+
+bool ts::TSPacketSharedRing::waitForSpace(const AbortInterface* abort)
+{
+    const uint32_t value = _header->space_word.load();
+    _header->producer_waiting.store(1);
+    if (_header->write_count.load() - _header->read_count.load() >= _size && (_header->flags.load() & FLAG_STOP) == 0) {
+        WaitWord(_header->space_word, value, WAIT_SLICE);
+    }
+    _header->producer_waiting.store(0);
+    return !_aborted && (abort == nullptr || !abort->aborting()) && peerAlive(false);
+}
+
+
+//----------------------------------------------------------------------------
+// Producer side.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::write(const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, const AbortInterface* abort)
+{
+    if (_header == nullptr || _role != PRODUCER) {
+        return false;
+    }
+
+    while (count > 0) {
+        if ((_header->flags.load() & FLAG_STOP) != 0) {
+            return false;
+        }
+
+        // Only this process updates write_count.
+        const uint64_t wr = _header->write_count.load(std::memory_order_relaxed);
+        const uint64_t rd = _header->read_count.load(std::memory_order_acquire);
+        const size_t free = _size - size_t(wr - rd);
+
+        if (free == 0) {
+            if (!waitForSpace(abort)) {
+                return false;
+            }
+            continue;
+        }
+
+        // Copy as many packets as possible up to the end of the ring.
+        const size_t index = size_t(wr % _size);
+        const size_t n = std::min(count, std::min(free, _size - index));
+        TSPacket::Copy(_packets + index, buffer, n);
+        if (mdata != nullptr) {
+            TSPacketMetadata::Copy(_mdata + index, mdata, n);
+            mdata += n;
+        }
+        else {
+            TSPacketMetadata::Reset(_mdata + index, n);
+        }
+        buffer += n;
+        count -= n;
+
+        // Publish the packets, then wake up the consumer if it is waiting.
+        _header->write_count.store(wr + n);
+        if (_header->consumer_waiting.load() != 0) {
+            _header->data_word++;
+            WakeWord(_header->data_word);
+        }
+    }
+    return true;
+}
+
+void ts::TSPacketSharedRing::setEOF()
+{
+    if (_header != nullptr && _role == PRODUCER) {
+        _header->flags.fetch_or(FLAG_EOF);
+        _header->data_word++;
+        WakeWord(_header->data_word);
+    }
+}
+
+bool ts::TSPacketSharedRing::stopped()
+{
+    return _header == nullptr || (_header->flags.load() & FLAG_STOP) != 0 || !peerAlive(false);
+}
+
+
+//----------------------------------------------------------------------------
+// Consumer side.
+//----------------------------------------------------------------------------
+
+bool ts::TSPacketSharedRing::getPacket(TSPacket& packet, TSPacketMetadata& mdata)
+{
+    if (_header == nullptr || _role != CONSUMER) {
+        return false;
+    }
+
+    // Only this process updates read_count.
+    const uint64_t rd = _header->read_count.load(std::memory_order_relaxed);
+    if (_header->write_count.load(std::memory_order_acquire) == rd) {
+        return false;
+    }
+
+    const size_t index = size_t(rd % _size);
+    packet = _packets[index];
+    mdata = _mdata[index];
+
+    // Release the slot, then wake up the producer if it is waiting.
+    _header->read_count.store(rd + 1);
+    if (_header->producer_waiting.load() != 0) {
+        _header->space_word++;
+        WakeWord(_header->space_word);
+    }
+    return true;
+}
+
+size_t ts::TSPacketSharedRing::read(TSPacket* buffer, TSPacketMetadata* mdata, size_t max_count, const AbortInterface* abort)
+{
+    if (_header == nullptr || _role != CONSUMER || max_count == 0) {
+        return 0;
+    }
+
+    for (;;) {
+        // Check end of file before the number of packets: the producer sets the
+        // EOF flag after writing its last packets, we must not miss them.
+        const bool end = (_header->flags.load() & FLAG_EOF) != 0 || _peer_dead;
+        const uint64_t rd = _header->read_count.load(std::memory_order_relaxed);
+        const uint64_t wr = _header->write_count.load(std::memory_order_acquire);
+
+        if (wr != rd) {
+            // Copy as many packets as possible up to the end of the ring.
+            const size_t index = size_t(rd % _size);
+            const size_t n = std::min(max_count, std::min(size_t(wr - rd), _size - index));
+            TSPacket::Copy(buffer, _packets + index, n);
+            if (mdata != nullptr) {
+                TSPacketMetadata::Copy(mdata, _mdata + index, n);
+            }
+
+            // Release the slots, then wake up the producer if it is waiting.
+            _header->read_count.store(rd + n);
+            if (_header->producer_waiting.load() != 0) {
+                _header->space_word++;
+                WakeWord(_header->space_word);
+            }
+            return n;
+        }
+
+        // When the peer has terminated, loop once more to get its last packets.
+        if (end || _aborted || (!waitForData(abort) && !_peer_dead)) {
+            return 0;
+        }
+    }
+}
+
+bool ts::TSPacketSharedRing::eof()
+{
+    if (_header == nullptr) {
+        return true;
+    }
+    const bool end = (_header->flags.load() & FLAG_EOF) != 0 || !peerAlive(false);
+    return end && _header->write_count.load() == _header->read_count.load();
+}
@@ -0,0 +1,248 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Shared memory ring buffer of TS packets for inter-process communication.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSPacket.h"
+#include "tsTSPacketMetadata.h"
+#include "tsAbortInterface.h"
+#include "tsReport.h"
+#include "tsTime.h"
+#include "tsMutex.h"
+#include "tsSysUtils.h"
+
+namespace ts {
+    //!
+    //! Shared memory ring buffer of TS packets for inter-process communication.
+    //! @ingroup mpeg
+    //!
+    //! One process produces packets and another process consumes them. The packets
+    //! and their metadata are directly written and read in a shared memory segment
+    //! which is mapped in both processes. Unlike a pipe, no data is copied through the
+    //! kernel and no system call is involved as long as packets flow. When the ring
+    //! is empty (consumer side) or full (producer side), the waiting process sleeps
+    //! on a futex word inside the shared memory (Linux) or polls the ring (other UNIX
+    //! systems). The other side issues a wake-up system call only when it knows that
+    //! its peer is actually waiting.
+    //!
+    //! The creator of the ring, typically a plugin which forks a process, creates the
+    //! shared memory segment with a unique name and passes this name to the created
+    //! process, usually in the environment variable @link ENVIRONMENT_VARIABLE @endlink.
+    //! The created process attaches to the segment using this name. Exactly one
+    //! process shall attach to a ring.
+    //!
+    //! Each process checks that its peer is still alive when it waits. When the peer
+    //! process has terminated without closing the ring, a producer stops writing and
+    //! a consumer gets an end of file.
+    //!
+    //! The two processes must use the same version of TSDuck since the packet metadata
+    //! are directly shared in binary form.
+    //!
+    //! This class is not supported on Windows.
+    //!
+    class TSDUCKDLL TSPacketSharedRing
+    {
+        TS_NOCOPY(TSPacketSharedRing);
+    public:
+        //!
+        //! Default size in packets of the ring.
+        //!
+        static constexpr size_t DEFAULT_SIZE = 4096;
+
+        //!
+        //! Name of the environment variable which is used to pass the name of the ring to a created process.
+        //!
+        static const UChar* const ENVIRONMENT_VARIABLE;
+
+        //!
+        //! Role of the application in the ring.
+        //!
+        enum Role {
+            PRODUCER,  //!< The application writes packets into the ring.
+            CONSUMER,  //!< The application reads packets from the ring.
+        };
+
+        //!
+        //! Default constructor.
+        //!
+        TSPacketSharedRing();
+
+        //!
+        //! Destructor.
+        //!
+        ~TSPacketSharedRing();
+
+        //!
+        //! Create a new shared memory ring with a unique name.
+        //! @param [in] role Role of this application in the ring.
+        //! @param [in] size Size of the ring in packets.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool create(Role role, size_t size, Report& report);
+
+        //!
+        //! Attach to an existing shared memory ring which was created by another process.
+        //! @param [in] name Name of the ring, as returned by name() in the creator process.
+        //! @param [in] role Role of this application in the ring. Must be the opposite of the creator's role.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool attach(const UString& name, Role role, Report& report);
+
+        //!
+        //! Close the ring.
+        //! A producer reports an end of file to the consumer. A consumer reports a stop condition to the producer.
+        //! @param [in,out] report Where to report errors.
+        //! @return True on success, false on error.
+        //!
+        bool close(Report& report);
+
+        //!
+        //! Check if the ring is open.
+        //! @return True if the ring is open.
+        //!
+        bool isOpen() const { return _base != nullptr; }
+
+        //!
+        //! Get the name of the ring, to pass to the other process.
+        //! @return The name of the shared memory segment.
+        //!
+        UString name() const { return _name; }
+
+        //!
+        //! Get the size of the ring in packets.
+        //! @return The size of the ring in packets.
+        //!
+        size_t bufferSize() const { return _size; }
+
+        //!
+        //! Set the identity of the peer process before it attaches to the ring.
+        //! This is useful in the creator process only, when the peer process is created
+        //! after the ring. If the specified process terminates before any process attaches
+        //! to the ring, the peer is considered as terminated. The specified process can be
+        //! the peer process itself or one of its ancestors (a shell for instance).
+        //! @param [in] pid Identity of the peer process or one of its ancestors. Zero if unknown.
+        //!
+        void setPeerProcess(ProcessId pid) { _peer_pid = pid; }
+
+        //!
+        //! Abort any current or future wait in this process.
+        //! Can be called from any thread, even while another thread closes the ring.
+        //! The ring must be closed after that.
+        //!
+        void abort();
+
+        //!
+        //! Called by the producer to write packets in the ring.
+        //! The producer is suspended until enough free space is available in the ring.
+        //! @param [in] buffer Address of the packets to write.
+        //! @param [in] mdata Address of the corresponding metadata. Can be null.
+        //! @param [in] count Number of packets to write.
+        //! @param [in] abort An optional interface to check for an abort condition while waiting.
+        //! @return True when all packets are written. False when the consumer has stopped
+        //! or terminated or when the wait was aborted.
+        //!
+        bool write(const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, const AbortInterface* abort = nullptr);
+
+        //!
+        //! Called by the producer to report the end of the stream to the consumer.
+        //!
+        void setEOF();
+
+        //!
+        //! Check if the consumer has reported a stop condition or has terminated.
+        //! @return True if the consumer will no longer read packets.
+        //!
+        bool stopped();
+
+        //!
+        //! Called by the consumer to get the next packet without waiting.
+        //! @param [out] packet The returned packet. Unmodified when no packet is available.
+        //! @param [out] mdata The returned packet metadata. Unmodified when no packet is available.
+        //! @return True if a packet was returned. False if none was available or an end of file occured.
+        //!
+        bool getPacket(TSPacket& packet, TSPacketMetadata& mdata);
+
+        //!
+        //! Called by the consumer to read packets.
+        //! The consumer is suspended until at least one packet is available.
+        //! @param [out] buffer Address of the packet buffer.
+        //! @param [out] mdata Address of the corresponding metadata buffer. Can be null.
+        //! @param [in] max_count Size of @a buffer in number of packets.
+        //! @param [in] abort An optional interface to check for an abort condition while waiting.
+        //! @return The number of read packets. Zero on end of file, error or abort.
+        //!
+        size_t read(TSPacket* buffer, TSPacketMetadata* mdata, size_t max_count, const AbortInterface* abort = nullptr);
+
+        //!
+        //! Check if the producer has reported an end of file or has terminated and all packets were read.
+        //! @return True if no more packet will be available.
+        //!
+        bool eof();
+
+    private:
+        struct Header;
+
+        Mutex             _mutex;      // Protect _header between abort() and map/unmap in another thread.
+        Header*           _header;     // Ring header in shared memory.
+        void*             _base;       // Base address of the mapped segment.
+        size_t            _map_size;   // Size of the mapped segment in bytes.
+        size_t            _size;       // Size of the ring in packets.
+        TSPacket*         _packets;    // Packets area in shared memory.
+        TSPacketMetadata* _mdata;      // Metadata area in shared memory.
+        Role              _role;       // Our role in the ring.
+        bool              _creator;    // We created the segment.
+        volatile bool     _aborted;    // Local abort request.
+        bool              _peer_dead;  // The peer process has terminated without closing the ring.
+        ProcessId         _peer_pid;   // Expected peer process or ancestor, before it attaches.
+        Time              _peer_check; // Last time the peer process was checked.
+        UString           _name;       // Name of the shared memory segment.
+
+        // Layout of the shared memory segment.
+        static size_t SegmentSize(size_t size);
+        static size_t MetadataOffset(size_t size);
+        void setAreas();
+
+        // Map and unmap the shared memory segment.
+        bool map(int fd, size_t map_size, Report& report);
+        void unmap();
+
+        // Check if the peer process is still alive, check at most every few milliseconds unless forced.
+        bool peerAlive(bool force);
+
+        // Wait for an event on the ring. Return false on abort or peer termination.
+        bool waitForData(const AbortInterface* abort);
+        bool waitForSpace(const AbortInterface* abort);
+    };
+}
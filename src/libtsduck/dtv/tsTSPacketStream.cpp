@@ -35,6 +35,11 @@ TSDUCK_SOURCE;
 // Must be lower than the TS packet size to allow auto-detection on read.
 namespace {
     constexpr size_t MAX_HEADER_SIZE = ts::TSPacketMetadata::SERIALIZATION_SIZE;
+
+    // In resynchronization mode, size of the raw input buffer and minimum size
+    // of a sequence of consecutive packets (about 16 packets) to lock on.
+    constexpr size_t RESYNC_BUFFER_SIZE = 512 * ts::PKT_RS_SIZE;
+    constexpr size_t RESYNC_MIN_SIZE = 16 * ts::PKT_SIZE;
 }
 
 const ts::Enumeration ts::TSPacketStream::FormatEnum({
@@ -55,7 +60,13 @@ ts::TSPacketStream::TSPacketStream(PacketFormat format, AbstractReadStreamInterf
     _format(format),
     _reader(reader),
     _writer(writer),
-    _last_timestamp(0)
+    _last_timestamp(0),
+    _resync(false),
+    _scanner(),
+    _resync_buffer(),
+    _resync_start(0),
+    _resync_end(0),
+    _resync_skipped(0)
 {
 }
 
@@ -76,6 +87,31 @@ void ts::TSPacketStream::resetPacketStream(PacketFormat format, AbstractReadStre
     _reader = reader;
     _writer = writer;
     _last_timestamp = 0;
+    _resync_skipped = 0;
+    discardResyncBuffer();
+}
+
+
+//----------------------------------------------------------------------------
+// Discard the raw input data which are buffered in resynchronization mode.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketStream::discardResyncBuffer()
+{
+    _scanner.unlock();
+    _resync_start = _resync_end = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Set or reset the resynchronization mode on read.
+//----------------------------------------------------------------------------
+
+void ts::TSPacketStream::setResync(bool on)
+{
+    _resync = on;
+    discardResyncBuffer();
+    _resync_buffer.resize(on ? RESYNC_BUFFER_SIZE : 0);
 }
 
 
@@ -105,6 +141,9 @@ size_t ts::TSPacketStream::readPackets(TSPacket *buffer, TSPacketMetadata *metad
         report.error(u"internal error, cannot read TS packets from this stream");
         return 0;
     }
+    else if (_resync) {
+        return readResyncPackets(buffer, metadata, max_packets, report);
+    }
 
     // Number of read packets.
     size_t read_packets = 0;
@@ -229,6 +268,102 @@ size_t ts::TSPacketStream::readPackets(TSPacket *buffer, TSPacketMetadata *metad
 }
 
 
+//----------------------------------------------------------------------------
+// Read TS packets in resynchronization mode.
+//----------------------------------------------------------------------------
+
+size_t ts::TSPacketStream::readResyncPackets(TSPacket* buffer, TSPacketMetadata* metadata, size_t max_packets, Report& report)
+{
+    size_t read_packets = 0;
+    bool eof = false;
+
+    while (read_packets < max_packets) {
+
+        uint8_t* const data = _resync_buffer.data();
+        size_t avail = _resync_end - _resync_start;
+
+        if (_scanner.isLocked()) {
+            // Extract all valid packets, up to the first invalid one.
+            const size_t pkt_size = _scanner.packetSize();
+            const size_t header_size = _scanner.headerSize();
+            const size_t count = std::min(max_packets - read_packets, _scanner.countPackets(data + _resync_start, avail));
+            for (size_t i = 0; i < count; ++i) {
+                const uint8_t* const pkt = data + _resync_start + i * pkt_size;
+                buffer[read_packets + i].copyFrom(pkt + header_size);
+                if (metadata != nullptr) {
+                    metadata[read_packets + i].reset();
+                    if (_format == FMT_M2TS) {
+                        metadata[read_packets + i].setInputTimeStamp(GetUInt32(pkt) & 0x3FFFFFFF, SYSTEM_CLOCK_FREQ);
+                    }
+                }
+            }
+            _resync_start += count * pkt_size;
+            avail -= count * pkt_size;
+            read_packets += count;
+            if (read_packets < max_packets && avail >= pkt_size) {
+                // There is a complete invalid packet.
+                report.verbose(u"TS packets synchronization lost after %'d packets", {_total_read + read_packets});
+                _scanner.unlock();
+                continue;
+            }
+        }
+        else if (avail >= RESYNC_MIN_SIZE || (eof && avail > 0)) {
+            // Look for a sequence of consecutive packets.
+            size_t offset = 0;
+            if (_scanner.lock(data + _resync_start, avail, RESYNC_MIN_SIZE, offset)) {
+                _format = _scanner.headerSize() == M2TS_HEADER_SIZE ? FMT_M2TS : FMT_TS;
+                _resync_start += offset;
+                _resync_skipped += offset;
+                report.verbose(u"TS packets synchronization found after skipping %'d bytes, %d-byte packets", {offset, _scanner.packetSize()});
+                continue;
+            }
+            // Skip all data which cannot be the start of a sequence of packets.
+            const size_t skip = eof ? avail : avail - RESYNC_MIN_SIZE + 1;
+            _resync_start += skip;
+            _resync_skipped += skip;
+        }
+
+        // The rest of the data is kept for the next call when the buffer is full.
+        if (read_packets >= max_packets) {
+            break;
+        }
+
+        // Now, we need more data.
+        if (eof) {
+            // Drop truncated packet at end of stream.
+            _resync_skipped += _resync_end - _resync_start;
+            _resync_start = _resync_end = 0;
+            break;
+        }
+        if (read_packets > 0) {
+            // Do not wait for more data when we already have packets.
+            break;
+        }
+
+        // Compact the buffer and read as much data as possible.
+        avail = _resync_end - _resync_start;
+        if (avail > 0 && _resync_start > 0) {
+            ::memmove(data, data + _resync_start, avail);
+        }
+        _resync_start = 0;
+        _resync_end = avail;
+        size_t read_size = 0;
+        if (_reader->readStreamPartial(data + _resync_end, _resync_buffer.size() - _resync_end, read_size, report) && read_size > 0) {
+            _resync_end += read_size;
+        }
+        else if (_reader->endOfStream()) {
+            eof = true;
+        }
+        else {
+            break; // read error
+        }
+    }
+
+    _total_read += read_packets;
+    return read_packets;
+}
+
+
 //----------------------------------------------------------------------------
 // Write TS packets.
 //----------------------------------------------------------------------------
@@ -36,6 +36,8 @@
 #include "tsAbstractReadStreamInterface.h"
 #include "tsAbstractWriteStreamInterface.h"
 #include "tsTSPacket.h"
+#include "tsTSSyncScanner.h"
+#include "tsByteBlock.h"
 #include "tsEnumeration.h"
 
 namespace ts {
@@ -134,6 +136,30 @@ namespace ts {
         //!
         UString packetFormatString() const { return FormatEnum.name(_format); }
 
+        //!
+        //! Set or reset the resynchronization mode on read.
+        //!
+        //! In resynchronization mode, the input data are not assumed to be a clean sequence
+        //! of packets. The stream is scanned for sequences of consecutive packets with 188-byte
+        //! (TS), 204-byte (TS with trailing Reed-Solomon outer FEC) or 192-byte (M2TS) size.
+        //! Data between sequences of packets are skipped. When the synchronization is lost,
+        //! the stream is scanned again. The initial file format is ignored in this mode.
+        //! @param [in] on True to set the resynchronization mode, false to reset it.
+        //!
+        void setResync(bool on);
+
+        //!
+        //! Check if the resynchronization mode is set on read.
+        //! @return True if the resynchronization mode is set.
+        //!
+        bool resync() const { return _resync; }
+
+        //!
+        //! Get the number of input bytes which were skipped in resynchronization mode.
+        //! @return The number of skipped bytes.
+        //!
+        uint64_t resyncSkippedBytes() const { return _resync_skipped; }
+
     protected:
         //!
         //! Reset the stream format and counters.
@@ -143,6 +169,18 @@ namespace ts {
         //!
         void resetPacketStream(PacketFormat format, AbstractReadStreamInterface* reader, AbstractWriteStreamInterface* writer);
 
+        //!
+        //! Check if raw input data are still buffered in resynchronization mode.
+        //! @return True if some input data were read but not yet returned as packets or skipped.
+        //!
+        bool resyncPending() const { return _resync_end > _resync_start; }
+
+        //!
+        //! Discard the raw input data which are buffered in resynchronization mode.
+        //! Must be called when the reader is repositioned in the input stream.
+        //!
+        void discardResyncBuffer();
+
         PacketCounter _total_read;   //!< Total read packets.
         PacketCounter _total_write;  //!< Total written packets.
 
@@ -151,5 +189,14 @@ namespace ts {
         AbstractReadStreamInterface*  _reader;
         AbstractWriteStreamInterface* _writer;
         uint64_t                      _last_timestamp; // Last write time stamp in PCR units (M2TS files).
+        bool                          _resync;         // Resynchronization mode on read.
+        TSSyncScanner                 _scanner;        // Sync scanner in resynchronization mode.
+        ByteBlock                     _resync_buffer;  // Raw input data in resynchronization mode.
+        size_t                        _resync_start;   // Index of first unprocessed byte in _resync_buffer.
+        size_t                        _resync_end;     // Index after last read byte in _resync_buffer.
+        uint64_t                      _resync_skipped; // Number of skipped bytes in resynchronization mode.
+
+        // Read packets in resynchronization mode.
+        size_t readResyncPackets(TSPacket* buffer, TSPacketMetadata* metadata, size_t max_packets, Report& report);
     };
 }
@@ -30,9 +30,141 @@
 #include "tsTSScrambling.h"
 #include "tsNames.h"
 #include "tsArgs.h"
+#include "tsGuardCondition.h"
+#include "tsNullReport.h"
+#include "tsThread.h"
 TSDUCK_SOURCE;
 
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+const size_t ts::TSScrambling::MIN_PACKETS_PER_THREAD;
+#endif
+
+
+//----------------------------------------------------------------------------
+// A worker thread for parallel encryption or decryption.
+//----------------------------------------------------------------------------
+
+class ts::TSScrambling::Worker : private Thread
+{
+    TS_NOBUILD_NOCOPY(Worker);
+public:
+    // Constructor, start the thread.
+    Worker(const TSScrambling& master);
+
+    // Destructor, terminate the thread.
+    virtual ~Worker() override;
+
+    // Post a job to the worker. The ciphers of the worker are first synchronized with the master.
+    void post(const TSScrambling& master, uint8_t scv, bool encrypt, TSPacket* const* pkts, size_t count);
+
+    // Wait for the completion of the last job, return its status.
+    bool wait();
+
+private:
+    TSScrambling     _engine;     // Private copy of the ciphers, with silent report.
+    Mutex            _mutex;
+    Condition        _cond;       // Signaled on new job, completion or termination.
+    bool             _terminate;
+    bool             _busy;       // A job is posted and not yet completed.
+    bool             _success;    // Status of last job.
+    uint8_t          _scv;
+    bool             _encrypt;
+    TSPacket* const* _pkts;
+    size_t           _count;
+
+    // Implementation of Thread.
+    virtual void main() override;
+};
+
+ts::TSScrambling::Worker::Worker(const TSScrambling& master) :
+    Thread(),
+    _engine(master, NULLREP),
+    _mutex(),
+    _cond(),
+    _terminate(false),
+    _busy(false),
+    _success(true),
+    _scv(SC_CLEAR),
+    _encrypt(false),
+    _pkts(nullptr),
+    _count(0)
+{
+    _engine._thread_count = 1;
+    start();
+}
+
+ts::TSScrambling::Worker::~Worker()
+{
+    {
+        GuardCondition lock(_mutex, _cond);
+        _terminate = true;
+        lock.signal();
+    }
+    waitForTermination();
+}
+
+void ts::TSScrambling::Worker::post(const TSScrambling& master, uint8_t scv, bool encrypt, TSPacket* const* pkts, size_t count)
+{
+    // The worker is idle, its ciphers can be safely updated from the calling thread.
+    bool rekey = false;
+    if (_engine._scrambling_type != master._scrambling_type) {
+        _engine.setScramblingType(master._scrambling_type);
+        rekey = true;
+    }
+    if (_engine._dvbcsa[0].entropyMode() != master._dvbcsa[0].entropyMode()) {
+        _engine.setEntropyMode(master._dvbcsa[0].entropyMode());
+        rekey = true;
+    }
+    ByteBlock key, current;
+    if (master._scrambler[scv & 1]->getKey(key) && (rekey || !_engine._scrambler[scv & 1]->getKey(current) || key != current)) {
+        _engine._scrambler[scv & 1]->setKey(key.data(), key.size());
+    }
+
+    GuardCondition lock(_mutex, _cond);
+    _scv = scv;
+    _encrypt = encrypt;
+    _pkts = pkts;
+    _count = count;
+    _busy = true;
+    lock.signal();
+}
+
+bool ts::TSScrambling::Worker::wait()
+{
+    GuardCondition lock(_mutex, _cond);
+    while (_busy) {
+        lock.waitCondition();
+    }
+    return _success;
+}
+
+void ts::TSScrambling::Worker::main()
+{
+    for (;;) {
+        // Wait for a job.
+        {
+            GuardCondition lock(_mutex, _cond);
+            while (!_busy && !_terminate) {
+                lock.waitCondition();
+            }
+            if (_terminate) {
+                return;
+            }
+        }
+
+        // Process the packets outside the mutex, the master waits for us.
+        const bool success = _engine.processPackets(_scv, _encrypt, _pkts, _count);
+
+        // Notify completion.
+        GuardCondition lock(_mutex, _cond);
+        _success = success;
+        _busy = false;
+        lock.signal();
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Constructors.
 //----------------------------------------------------------------------------
@@ -52,13 +184,19 @@ ts::TSScrambling::TSScrambling(Report& report, uint8_t scrambling) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scrambler{nullptr, nullptr},
+    _aes_iv(),
+    _ctr_bits(0),
+    _thread_count(1),
+    _workers(),
+    _batch(),
+    _batch_packets()
 {
     setScramblingType(scrambling);
 }
 
-ts::TSScrambling::TSScrambling(const TSScrambling& other) :
-    _report(other._report),
+ts::TSScrambling::TSScrambling(const TSScrambling& other, Report& report) :
+    _report(report),
     _scrambling_type(other._scrambling_type),
     _explicit_type(other._explicit_type),
     _out_cw_name(),
@@ -72,33 +210,40 @@ ts::TSScrambling::TSScrambling(const TSScrambling& other) :
     _idsa(),
     _aescbc(),
     _aesctr(),
-    _scrambler{nullptr, nullptr}
+    _scrambler{nullptr, nullptr},
+    _aes_iv(other._aes_iv),
+    _ctr_bits(other._ctr_bits),
+    _thread_count(other._thread_count),
+    _workers(),
+    _batch(),
+    _batch_packets()
 {
     setScramblingType(_scrambling_type);
     _dvbcsa[0].setEntropyMode(other._dvbcsa[0].entropyMode());
     _dvbcsa[1].setEntropyMode(other._dvbcsa[1].entropyMode());
+    if (!_aes_iv.empty()) {
+        _aescbc[0].setIV(_aes_iv.data(), _aes_iv.size());
+        _aescbc[1].setIV(_aes_iv.data(), _aes_iv.size());
+        _aesctr[0].setIV(_aes_iv.data(), _aes_iv.size());
+        _aesctr[1].setIV(_aes_iv.data(), _aes_iv.size());
+    }
+    _aesctr[0].setCounterBits(_ctr_bits);
+    _aesctr[1].setCounterBits(_ctr_bits);
+}
+
+ts::TSScrambling::TSScrambling(const TSScrambling& other) :
+    TSScrambling(other, other._report)
+{
 }
 
 ts::TSScrambling::TSScrambling(TSScrambling&& other) :
-    _report(other._report),
-    _scrambling_type(other._scrambling_type),
-    _explicit_type(other._explicit_type),
-    _out_cw_name(),
-    _out_cw_file(),
-    _cw_list(other._cw_list),
-    _next_cw(_cw_list.end()),
-    _encrypt_scv(SC_CLEAR),
-    _decrypt_scv(SC_CLEAR),
-    _dvbcsa(),
-    _dvbcissa(),
-    _idsa(),
-    _aescbc(),
-    _aesctr(),
-    _scrambler{nullptr, nullptr}
+    TSScrambling(other, other._report)
 {
-    setScramblingType(_scrambling_type);
-    _dvbcsa[0].setEntropyMode(other._dvbcsa[0].entropyMode());
-    _dvbcsa[1].setEntropyMode(other._dvbcsa[1].entropyMode());
+}
+
+ts::TSScrambling::~TSScrambling()
+{
+    stopWorkers();
 }
 
 
@@ -165,6 +310,26 @@ void ts::TSScrambling::setEntropyMode(DVBCSA2::EntropyMode mode)
 }
 
 
+//----------------------------------------------------------------------------
+// Set the number of threads for batch processing.
+//----------------------------------------------------------------------------
+
+void ts::TSScrambling::setThreadCount(size_t count)
+{
+    count = std::max<size_t>(1, count);
+    if (count != _thread_count) {
+        stopWorkers();
+        _thread_count = count;
+    }
+}
+
+void ts::TSScrambling::stopWorkers()
+{
+    // The destructor of each worker terminates its thread.
+    _workers.clear();
+}
+
+
 //----------------------------------------------------------------------------
 // Define command line options in an Args.
 //----------------------------------------------------------------------------
@@ -241,6 +406,13 @@ void ts::TSScrambling::defineArgs(Args &args) const
     args.option(u"dvb-csa2");
     args.help(u"dvb-csa2", u"Use DVB-CSA2 scrambling. This is the default.");
 
+    args.option(u"threads", 0, Args::POSITIVE);
+    args.help(u"threads",
+              u"Number of threads to use for the encryption or decryption of TS packets. "
+              u"When greater than 1, the packets of each window of packets are distributed "
+              u"among the threads which process them in parallel. Packet order and "
+              u"crypto-period boundaries are preserved. The default is 1 (no parallelism).");
+
     args.option(u"no-entropy-reduction", 'n');
     args.help(u"no-entropy-reduction",
               u"With DVB-CSA2, do not perform control word entropy reduction to 48 bits. "
@@ -303,12 +475,18 @@ bool ts::TSScrambling::loadArgs(DuckContext& duck, Args& args)
     {
         args.error(u"error setting AES initialization vector");
     }
+    else {
+        _aes_iv = iv;
+    }
 
     // Set the size of the counter part with CTS mode.
     // The default is zero, meaning half nounce / half counter.
-    const size_t counter_bits = args.intValue<size_t>(u"ctr-counter-bits");
-    _aesctr[0].setCounterBits(counter_bits);
-    _aesctr[1].setCounterBits(counter_bits);
+    _ctr_bits = args.intValue<size_t>(u"ctr-counter-bits");
+    _aesctr[0].setCounterBits(_ctr_bits);
+    _aesctr[1].setCounterBits(_ctr_bits);
+
+    // Number of threads for batch processing.
+    setThreadCount(args.intValue<size_t>(u"threads", 1));
 
     // Get control words as list of strings.
     UStringList lines;
@@ -380,6 +558,9 @@ bool ts::TSScrambling::start()
 
 bool ts::TSScrambling::stop()
 {
+    // Terminate worker threads, if any was started.
+    stopWorkers();
+
     // Close the output file for control words, if one was created.
     if (_out_cw_file.is_open()) {
         _out_cw_file.close();
@@ -582,3 +763,179 @@ bool ts::TSScrambling::decrypt(TSPacket& pkt)
     }
     return ok;
 }
+
+
+//----------------------------------------------------------------------------
+// Encrypt or decrypt packets in the current thread.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::processPackets(uint8_t scv, bool encrypt, TSPacket* const* pkts, size_t count)
+{
+    bool ok = true;
+    const uint8_t new_scv = encrypt ? scv : uint8_t(SC_CLEAR);
+
+    if (_scrambler[0] == &_dvbcsa[0]) {
+        // DVB-CSA2: all packets are processed together.
+        _batch.clear();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t psize = pkts[i]->getPayloadSize();
+            if (psize > 0) {
+                _batch.push_back({pkts[i]->getPayload(), psize});
+            }
+        }
+        DVBCSA2& algo(_dvbcsa[scv & 1]);
+        ok = _batch.empty() || (encrypt ? algo.encryptBatch(_batch.data(), _batch.size()) : algo.decryptBatch(_batch.data(), _batch.size()));
+        _batch.clear();
+        for (size_t i = 0; ok && i < count; ++i) {
+            pkts[i]->setScrambling(new_scv);
+        }
+    }
+    else {
+        // Other algorithms: packets are processed one by one.
+        CipherChaining* algo = _scrambler[scv & 1];
+        assert(algo != nullptr);
+        for (size_t i = 0; ok && i < count; ++i) {
+            // Check if the residue shall be included in the scrambling.
+            size_t psize = pkts[i]->getPayloadSize();
+            if (!algo->residueAllowed()) {
+                assert(algo->blockSize() != 0);
+                psize -= psize % algo->blockSize();
+            }
+            ok = psize == 0 || (encrypt ? algo->encryptInPlace(pkts[i]->getPayload(), psize) : algo->decryptInPlace(pkts[i]->getPayload(), psize));
+            if (ok) {
+                pkts[i]->setScrambling(new_scv);
+            }
+        }
+    }
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt or decrypt the pending batch of packets, possibly in parallel.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::flushBatch(uint8_t scv, bool encrypt)
+{
+    const size_t count = _batch_packets.size();
+    if (count == 0) {
+        return true;
+    }
+
+    // Number of threads to use, including the current one.
+    const size_t threads = std::min(_thread_count, count / MIN_PACKETS_PER_THREAD);
+    TSPacket* const* pkts = _batch_packets.data();
+    bool ok = true;
+
+    if (threads <= 1) {
+        ok = processPackets(scv, encrypt, pkts, count);
+    }
+    else {
+        // Start the worker threads on first use.
+        while (_workers.size() + 1 < _thread_count) {
+            _workers.push_back(new Worker(*this));
+        }
+
+        // Split the packets in contiguous slices. The workers process the last slices.
+        // The first slice, including the remainder, is processed in the current thread.
+        // This is the only one which uses our own ciphers and triggers cipher alerts.
+        const size_t slice = count / threads;
+        const size_t first = count - (threads - 1) * slice;
+        for (size_t i = 1; i < threads; ++i) {
+            _workers[i - 1]->post(*this, scv, encrypt, pkts + first + (i - 1) * slice, slice);
+        }
+        ok = processPackets(scv, encrypt, pkts, first);
+
+        // Wait for all workers, the packets are not released before all slices are processed.
+        for (size_t i = 1; i < threads; ++i) {
+            ok = _workers[i - 1]->wait() && ok;
+        }
+    }
+
+    if (!ok) {
+        _report.error(u"packet %s error using %s", {encrypt ? u"encryption" : u"decryption", _scrambler[scv & 1]->name()});
+    }
+    _batch_packets.clear();
+    return ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Encrypt several TS packets with the current parity and corresponding CW.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::encrypt(TSPacket* const* pkts, size_t count)
+{
+    // Without DVB-CSA2 or threads, there is no batch implementation.
+    if (!useBatch()) {
+        bool ok = true;
+        for (size_t i = 0; ok && i < count; ++i) {
+            ok = encrypt(*pkts[i]);
+        }
+        return ok;
+    }
+
+    // If no current parity is set, start with even by default.
+    if (_encrypt_scv == SC_CLEAR && !setEncryptParity(SC_EVEN_KEY)) {
+        return false;
+    }
+    assert(_encrypt_scv == SC_EVEN_KEY || _encrypt_scv == SC_ODD_KEY);
+
+    // Collect all packets with a payload, stop on already scrambled packets.
+    bool ok = true;
+    for (size_t i = 0; ok && i < count; ++i) {
+        TSPacket* pkt = pkts[i];
+        if (pkt->isScrambled()) {
+            _report.error(u"try to scramble an already scrambled packet");
+            ok = false;
+        }
+        else if (pkt->hasPayload()) {
+            _batch_packets.push_back(pkt);
+        }
+    }
+    return flushBatch(_encrypt_scv, true) && ok;
+}
+
+
+//----------------------------------------------------------------------------
+// Decrypt several TS packets with the CW corresponding to their parity.
+//----------------------------------------------------------------------------
+
+bool ts::TSScrambling::decrypt(TSPacket* const* pkts, size_t count)
+{
+    // Without DVB-CSA2 or threads, there is no batch implementation.
+    if (!useBatch()) {
+        bool ok = true;
+        for (size_t i = 0; ok && i < count; ++i) {
+            ok = decrypt(*pkts[i]);
+        }
+        return ok;
+    }
+
+    // Process runs of packets with the same parity.
+    for (size_t i = 0; i < count; ++i) {
+        TSPacket* pkt = pkts[i];
+
+        // Clear or invalid packets are silently accepted.
+        const uint8_t scv = pkt->getScrambling();
+        if (scv != SC_EVEN_KEY && scv != SC_ODD_KEY) {
+            continue;
+        }
+
+        // On parity change, descramble previous packets and update the current parity.
+        if (scv != _decrypt_scv) {
+            const uint8_t previous_scv = _decrypt_scv;
+            if (!flushBatch(previous_scv, false)) {
+                return false;
+            }
+            _decrypt_scv = scv;
+
+            // In case of fixed control word, use next key when the scrambling control changes.
+            if (hasFixedCW() && !setNextFixedCW(_decrypt_scv)) {
+                return false;
+            }
+        }
+        _batch_packets.push_back(pkt);
+    }
+    return flushBatch(_decrypt_scv, false);
+}
@@ -44,6 +44,7 @@
 #include "tsCTR.h"
 #include "tsIDSA.h"
 #include "tsMPEG.h"
+#include "tsSafePtr.h"
 
 namespace ts {
     //!
@@ -87,6 +88,11 @@ namespace ts {
         //!
         TSScrambling(TSScrambling&& other);
 
+        //!
+        //! Destructor.
+        //!
+        virtual ~TSScrambling() override;
+
         // Implementation of ArgsSupplierInterface.
         virtual void defineArgs(Args& args) const override;
         virtual bool loadArgs(DuckContext& duck, Args& args) override;
@@ -149,6 +155,21 @@ namespace ts {
         //!
         void setEntropyMode(DVBCSA2::EntropyMode mode);
 
+        //!
+        //! Set the number of threads for the encryption or decryption of several packets.
+        //! By default, use settings from the command line.
+        //! @param [in] count Number of threads. When greater than 1, the packets which are
+        //! passed to encrypt() or decrypt() with an array of packets are split among @a count
+        //! threads which process them in parallel. The calling thread is one of them.
+        //!
+        void setThreadCount(size_t count);
+
+        //!
+        //! Get the number of threads for the encryption or decryption of several packets.
+        //! @return The number of threads.
+        //!
+        size_t threadCount() const { return _thread_count; }
+
         //!
         //! Start the scrambling session.
         //! Reinitialize list of CW's, open files, etc.
@@ -192,10 +213,41 @@ namespace ts {
         //!
         bool decrypt(TSPacket& pkt);
 
+        //!
+        //! Encrypt several TS packets with the current parity and corresponding CW.
+        //! The result is the same as calling encrypt() on each packet. With DVB-CSA2,
+        //! all packets are scrambled in parallel, which is much faster. When the thread
+        //! count is greater than 1, the packets are also split among several threads.
+        //! @param [in] pkts Address of an array of pointers to packets.
+        //! @param [in] count Number of packets in @a pkts.
+        //! @return True on success, false on error. An already encrypted packet is an error.
+        //!
+        bool encrypt(TSPacket* const* pkts, size_t count);
+
+        //!
+        //! Decrypt several TS packets with the CW corresponding to the parity in each packet.
+        //! The result is the same as calling decrypt() on each packet. With DVB-CSA2,
+        //! consecutive packets with the same parity are descrambled in parallel. When the
+        //! thread count is greater than 1, consecutive packets with the same parity are
+        //! also split among several threads.
+        //! @param [in] pkts Address of an array of pointers to packets.
+        //! @param [in] count Number of packets in @a pkts.
+        //! @return True on success, false on error. A clear packet is not an error.
+        //!
+        bool decrypt(TSPacket* const* pkts, size_t count);
+
     private:
         // List of control words
         typedef std::list<ByteBlock> CWList;
 
+        // A worker thread for parallel encryption or decryption, using its own copy of the ciphers.
+        class Worker;
+        typedef SafePtr<Worker, NullMutex> WorkerPtr;
+        typedef std::vector<WorkerPtr> WorkerVector;
+
+        // Minimum number of packets per thread, avoid dispatching tiny batches.
+        static const size_t MIN_PACKETS_PER_THREAD = 16;
+
         Report&          _report;
         uint8_t          _scrambling_type;
         bool             _explicit_type;
@@ -211,10 +263,32 @@ namespace ts {
         CBC<AES>         _aescbc[2];
         CTR<AES>         _aesctr[2];
         CipherChaining*  _scrambler[2];
+        ByteBlock        _aes_iv;       // AES-CBC and AES-CTR initialization vector.
+        size_t           _ctr_bits;     // AES-CTR counter size in bits.
+        size_t           _thread_count; // Number of threads for batch processing.
+        WorkerVector     _workers;      // Worker threads, created on demand (_thread_count - 1 threads).
+        std::vector<DVBCSA2::BatchEntry> _batch;  // DVB-CSA2 batch being processed.
+        std::vector<TSPacket*> _batch_packets;    // Packets in pending batch.
+
+        // Constructor for internal copies with a specific report.
+        TSScrambling(const TSScrambling& other, Report& report);
 
         // Set the next fixed control word as scrambling key.
         bool setNextFixedCW(int parity);
 
+        // Check if batches of packets shall be collected before processing.
+        bool useBatch() const { return _thread_count > 1 || _scrambler[0] == &_dvbcsa[0]; }
+
+        // Encrypt or decrypt the pending batch with the key of the given parity.
+        bool flushBatch(uint8_t scv, bool encrypt);
+
+        // Encrypt or decrypt packets with the key of the given parity in the current thread.
+        // All packets have a payload and must be processed. Update the scrambling control.
+        bool processPackets(uint8_t scv, bool encrypt, TSPacket* const* pkts, size_t count);
+
+        // Terminate all worker threads.
+        void stopWorkers();
+
         // Implementation of BlockCipherAlertInterface.
         virtual bool handleBlockCipherAlert(BlockCipher& cipher, AlertReason reason) override;
 
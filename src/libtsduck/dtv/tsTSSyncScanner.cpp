@@ -0,0 +1,374 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSSyncScanner.h"
+#include "tsSysInfo.h"
+#include "tsMPEG.h"
+#include <atomic>
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::TSSyncScanner::MAX_FORMATS;
+#endif
+
+// Vectorized implementations are available on Intel CPU with GCC, clang and MSVC.
+// With GCC and clang, the functions are compiled for SSE2 or AVX2 without requiring
+// the same options for the rest of the code.
+#if (defined(TS_I386) || defined(TS_X86_64)) && (defined(TS_GCC) || defined(TS_MSC))
+    #define TS_SYNC_SIMD 1
+    #include <immintrin.h>
+    #if defined(TS_GCC)
+        #define TS_SYNC_SSE2_TARGET __attribute__((target("sse2")))
+        #define TS_SYNC_AVX2_TARGET __attribute__((target("avx2")))
+        #define TS_SYNC_CTZ(x) size_t(__builtin_ctz(x))
+    #else
+        #include <intrin.h>
+        #define TS_SYNC_SSE2_TARGET
+        #define TS_SYNC_AVX2_TARGET
+        #define TS_SYNC_CTZ(x) CountTrailingZeroes(x)
+        namespace {
+            inline size_t CountTrailingZeroes(unsigned int x)
+            {
+                unsigned long index = 0;
+                _BitScanForward(&index, x);
+                return size_t(index);
+            }
+        }
+    #endif
+#endif
+
+
+//----------------------------------------------------------------------------
+// Implementations of the scanning primitives.
+//----------------------------------------------------------------------------
+
+namespace {
+
+    // Portable search of sync byte.
+    size_t FindSyncScalar(const uint8_t* data, size_t size)
+    {
+        const void* p = ::memchr(data, ts::SYNC_BYTE, size);
+        return p == nullptr ? size : size_t(reinterpret_cast<const uint8_t*>(p) - data);
+    }
+
+    // Portable count of packets, unrolled on 4 packets.
+    size_t CountScalar(const uint8_t* data, size_t size, size_t packet_size, size_t header_size)
+    {
+        const size_t total = size / packet_size;
+        const uint8_t* p = data + header_size;
+        size_t count = 0;
+        while (count + 4 <= total &&
+               p[0] == ts::SYNC_BYTE &&
+               p[packet_size] == ts::SYNC_BYTE &&
+               p[2 * packet_size] == ts::SYNC_BYTE &&
+               p[3 * packet_size] == ts::SYNC_BYTE)
+        {
+            count += 4;
+            p += 4 * packet_size;
+        }
+        while (count < total && *p == ts::SYNC_BYTE) {
+            count++;
+            p += packet_size;
+        }
+        return count;
+    }
+
+#if defined(TS_SYNC_SIMD)
+
+    // SSE2 search of sync byte, 16 bytes at a time.
+    TS_SYNC_SSE2_TARGET size_t FindSyncSSE2(const uint8_t* data, size_t size)
+    {
+        const __m128i sync = _mm_set1_epi8(char(ts::SYNC_BYTE));
+        size_t index = 0;
+        for (; index + 16 <= size; index += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+            const unsigned int mask = unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, sync)));
+            if (mask != 0) {
+                return index + TS_SYNC_CTZ(mask);
+            }
+        }
+        return index + FindSyncScalar(data + index, size - index);
+    }
+
+    // AVX2 search of sync byte, 32 bytes at a time.
+    TS_SYNC_AVX2_TARGET size_t FindSyncAVX2(const uint8_t* data, size_t size)
+    {
+        const __m256i sync = _mm256_set1_epi8(char(ts::SYNC_BYTE));
+        size_t index = 0;
+        for (; index + 32 <= size; index += 32) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + index));
+            const unsigned int mask = unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, sync)));
+            if (mask != 0) {
+                return index + TS_SYNC_CTZ(mask);
+            }
+        }
+        return index + FindSyncScalar(data + index, size - index);
+    }
+
+    // AVX2 count of packets: the sync bytes of 8 packets are gathered in one vector.
+    // The gather operation loads 32-bit words at the sync byte of each packet. The
+    // sync byte is the least significant byte of each word (Intel CPU are little
+    // endian). The 3 other bytes are still inside the packet.
+    TS_SYNC_AVX2_TARGET size_t CountAVX2(const uint8_t* data, size_t size, size_t packet_size, size_t header_size)
+    {
+        // The offsets of the 8 packets must fit in 32-bit signed integers.
+        if (packet_size > 0x0FFFFFFF) {
+            return CountScalar(data, size, packet_size, header_size);
+        }
+        const size_t total = size / packet_size;
+        const int ps = int(packet_size);
+        const __m256i offsets = _mm256_setr_epi32(0, ps, 2 * ps, 3 * ps, 4 * ps, 5 * ps, 6 * ps, 7 * ps);
+        const __m256i low = _mm256_set1_epi32(0xFF);
+        const __m256i sync = _mm256_set1_epi32(ts::SYNC_BYTE);
+        const uint8_t* p = data + header_size;
+        size_t count = 0;
+        while (count + 8 <= total) {
+            const __m256i words = _mm256_i32gather_epi32(reinterpret_cast<const int*>(p), offsets, 1);
+            const __m256i valid = _mm256_cmpeq_epi32(_mm256_and_si256(words, low), sync);
+            const unsigned int mask = unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(valid)));
+            if (mask != 0xFF) {
+                return count + TS_SYNC_CTZ(~mask);
+            }
+            count += 8;
+            p += 8 * packet_size;
+        }
+        return count + CountScalar(p - header_size, size - (p - header_size - data), packet_size, header_size);
+    }
+
+#endif
+}
+
+
+//----------------------------------------------------------------------------
+// Selection of the scan mode.
+//----------------------------------------------------------------------------
+
+bool ts::TSSyncScanner::IsSupported(ScanMode mode)
+{
+    switch (mode) {
+        case SCAN_AUTO:
+        case SCAN_SCALAR:
+            return true;
+#if defined(TS_SYNC_SIMD)
+        case SCAN_SSE2:
+            return SysInfo::Instance()->cpuHasSSE2();
+        case SCAN_AVX2:
+            return SysInfo::Instance()->cpuHasAVX2();
+#endif
+        default:
+            return false;
+    }
+}
+
+// Resolve SCAN_AUTO into the fastest supported scan mode.
+namespace {
+    ts::TSSyncScanner::ScanMode ResolveScanMode(ts::TSSyncScanner::ScanMode mode)
+    {
+        if (mode != ts::TSSyncScanner::SCAN_AUTO) {
+            return mode;
+        }
+        else if (ts::TSSyncScanner::IsSupported(ts::TSSyncScanner::SCAN_AVX2)) {
+            return ts::TSSyncScanner::SCAN_AVX2;
+        }
+        else if (ts::TSSyncScanner::IsSupported(ts::TSSyncScanner::SCAN_SSE2)) {
+            return ts::TSSyncScanner::SCAN_SSE2;
+        }
+        else {
+            return ts::TSSyncScanner::SCAN_SCALAR;
+        }
+    }
+
+    // Current scan mode, initialized on first use.
+    std::atomic<ts::TSSyncScanner::ScanMode>& CurrentScanMode()
+    {
+        static std::atomic<ts::TSSyncScanner::ScanMode> mode(ResolveScanMode(ts::TSSyncScanner::SCAN_AUTO));
+        return mode;
+    }
+}
+
+bool ts::TSSyncScanner::SetScanMode(ScanMode mode)
+{
+    if (!IsSupported(mode)) {
+        return false;
+    }
+    else {
+        CurrentScanMode().store(ResolveScanMode(mode));
+        return true;
+    }
+}
+
+ts::TSSyncScanner::ScanMode ts::TSSyncScanner::GetScanMode()
+{
+    return CurrentScanMode().load(std::memory_order_relaxed);
+}
+
+
+//----------------------------------------------------------------------------
+// Scanning primitives.
+//----------------------------------------------------------------------------
+
+size_t ts::TSSyncScanner::FindSyncByte(const void* data, size_t size)
+{
+    const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+    switch (GetScanMode()) {
+#if defined(TS_SYNC_SIMD)
+        case SCAN_AVX2:
+            return FindSyncAVX2(bytes, size);
+        case SCAN_SSE2:
+            return FindSyncSSE2(bytes, size);
+#endif
+        default:
+            return FindSyncScalar(bytes, size);
+    }
+}
+
+size_t ts::TSSyncScanner::CountPackets(const void* data, size_t size, size_t packet_size, size_t header_size)
+{
+    assert(packet_size >= header_size + PKT_SIZE);
+    const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+#if defined(TS_SYNC_SIMD)
+    if (GetScanMode() == SCAN_AVX2) {
+        return CountAVX2(bytes, size, packet_size, header_size);
+    }
+#endif
+    // There is no gather operation in SSE2, the stride is too large for vectors.
+    return CountScalar(bytes, size, packet_size, header_size);
+}
+
+
+//----------------------------------------------------------------------------
+// Constructor and candidate formats.
+//----------------------------------------------------------------------------
+
+ts::TSSyncScanner::TSSyncScanner() :
+    _formats(),
+    _count(0),
+    _current(0),
+    _locked(false)
+{
+    setDefaultFormats();
+}
+
+void ts::TSSyncScanner::setFormat(size_t packet_size, size_t header_size)
+{
+    assert(packet_size >= header_size + PKT_SIZE);
+    _formats[0].packet_size = packet_size;
+    _formats[0].header_size = header_size;
+    _count = 1;
+    _current = 0;
+    _locked = false;
+}
+
+void ts::TSSyncScanner::setDefaultFormats()
+{
+    _formats[0].packet_size = PKT_SIZE;
+    _formats[0].header_size = 0;
+    _formats[1].packet_size = PKT_RS_SIZE;
+    _formats[1].header_size = 0;
+    _formats[2].packet_size = PKT_M2TS_SIZE;
+    _formats[2].header_size = M2TS_HEADER_SIZE;
+    _count = 3;
+    _current = 0;
+    _locked = false;
+}
+
+
+//----------------------------------------------------------------------------
+// Lock on the first sequence of consecutive packets.
+//----------------------------------------------------------------------------
+
+bool ts::TSSyncScanner::lock(const void* data, size_t size, size_t min_size, size_t& offset)
+{
+    const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+    constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    _locked = false;
+    offset = 0;
+
+    // Last possible start of a sequence of min_size bytes. When the data are shorter
+    // than min_size (typically the end of a stream), try all positions and require
+    // that all remaining complete packets are valid.
+    const size_t last = size >= min_size ? size - min_size : (size > 0 ? size - 1 : 0);
+
+    // Next candidate start of packet for each format, based on the next sync byte.
+    // Instead of checking all formats at each position, we jump to the next sync byte.
+    const auto search = [&](size_t fi, size_t pos) -> size_t {
+        const size_t start = pos + _formats[fi].header_size;
+        if (start >= size) {
+            return NONE;
+        }
+        const size_t index = FindSyncByte(bytes + start, size - start);
+        return index < size - start ? pos + index : NONE;
+    };
+    size_t next[MAX_FORMATS];
+    for (size_t fi = 0; fi < _count; ++fi) {
+        next[fi] = search(fi, 0);
+    }
+
+    for (size_t pos = 0; pos <= last; ++pos) {
+
+        // Locate the next candidate position, after the ones which were already tried.
+        size_t first = NONE;
+        for (size_t fi = 0; fi < _count; ++fi) {
+            if (next[fi] < pos) {
+                next[fi] = search(fi, pos);
+            }
+            first = std::min(first, next[fi]);
+        }
+        if (first == NONE || first > last) {
+            break;
+        }
+        pos = first;
+
+        // Try all candidate formats at this position, in order of preference.
+        for (size_t fi = 0; fi < _count; ++fi) {
+            if (next[fi] == pos) {
+                const size_t ps = _formats[fi].packet_size;
+                const size_t required = std::max<size_t>(1, std::min(min_size, size - pos) / ps);
+                if (CountPackets(bytes + pos, size - pos, ps, _formats[fi].header_size) >= required) {
+                    _current = fi;
+                    _locked = true;
+                    offset = pos;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+//----------------------------------------------------------------------------
+// Count consecutive packets of the locked encapsulation.
+//----------------------------------------------------------------------------
+
+size_t ts::TSSyncScanner::countPackets(const void* data, size_t size) const
+{
+    return _locked ? CountPackets(data, size, _formats[_current].packet_size, _formats[_current].header_size) : 0;
+}
@@ -0,0 +1,191 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Fast search of TS packets synchronization in raw binary data.
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsPlatform.h"
+
+namespace ts {
+    //!
+    //! Fast search of TS packets synchronization in raw binary data.
+    //! @ingroup mpeg
+    //!
+    //! A sync scanner locks on a sequence of consecutive TS packets in a raw data buffer,
+    //! using a list of candidate packet encapsulations (packet size and header size before
+    //! the 0x47 sync byte). Once locked, it counts the consecutive valid packets in the
+    //! next buffers, thus giving the position where synchronization is lost, if any.
+    //!
+    //! On Intel processors, the search for sync bytes and the validation of consecutive
+    //! sync bytes at the packet stride are vectorized using SSE2 or AVX2 instructions,
+    //! when available on the CPU.
+    //!
+    class TSDUCKDLL TSSyncScanner
+    {
+    public:
+        //!
+        //! Implementation of the scanning operations.
+        //!
+        enum ScanMode {
+            SCAN_AUTO,    //!< Use the fastest implementation on this CPU.
+            SCAN_SCALAR,  //!< Portable implementation, one byte at a time.
+            SCAN_SSE2,    //!< Use 128-bit SSE2 vectors (16 bytes at a time).
+            SCAN_AVX2     //!< Use 256-bit AVX2 vectors (32 bytes or 8 packets at a time).
+        };
+
+        //!
+        //! Check if a scan mode is supported on this platform and CPU.
+        //! @param [in] mode The scan mode to check.
+        //! @return True if @a mode is supported.
+        //!
+        static bool IsSupported(ScanMode mode);
+
+        //!
+        //! Force the implementation of scanning operations (typically for tests and benchmarks).
+        //! This is a global setting for all instances of TSSyncScanner. It can be called at any
+        //! time, scans which are already in progress in other threads use the previous mode.
+        //! @param [in] mode The scan mode to use. The default is SCAN_AUTO.
+        //! @return True on success, false if @a mode is not supported on this CPU.
+        //!
+        static bool SetScanMode(ScanMode mode);
+
+        //!
+        //! Get the implementation of scanning operations which is currently used.
+        //! @return The current scan mode, never SCAN_AUTO.
+        //!
+        static ScanMode GetScanMode();
+
+        //!
+        //! Find the first sync byte (0x47) in a memory area.
+        //! @param [in] data Address of data area.
+        //! @param [in] size Size in bytes of the data area.
+        //! @return The index of the first sync byte in @a data or @a size if there is none.
+        //!
+        static size_t FindSyncByte(const void* data, size_t size);
+
+        //!
+        //! Count consecutive packets at the beginning of a memory area.
+        //! @param [in] data Address of data area. The first packet starts here.
+        //! @param [in] size Size in bytes of the data area.
+        //! @param [in] packet_size Size in bytes of each packet, including its header.
+        //! @param [in] header_size Size in bytes of the header before the TS packet.
+        //! @return The number of complete packets in @a data which have a sync byte at
+        //! offset @a header_size. The first invalid packet, if any, starts at offset
+        //! @a packet_size times the returned value.
+        //!
+        static size_t CountPackets(const void* data, size_t size, size_t packet_size, size_t header_size);
+
+        //!
+        //! Constructor.
+        //! The default candidate encapsulations are 188-byte TS packets, 204-byte TS packets
+        //! (trailing 16-byte Reed-Solomon outer FEC) and 192-byte M2TS packets (leading
+        //! 4-byte timestamp), in this order of preference.
+        //!
+        TSSyncScanner();
+
+        //!
+        //! Use one specific packet encapsulation instead of the default candidates.
+        //! The scanner is unlocked.
+        //! @param [in] packet_size Size in bytes of each packet, including its header.
+        //! Must be at least 188 plus @a header_size.
+        //! @param [in] header_size Size in bytes of the header before the TS packet.
+        //!
+        void setFormat(size_t packet_size, size_t header_size = 0);
+
+        //!
+        //! Restore the default candidate packet encapsulations.
+        //! The scanner is unlocked.
+        //!
+        void setDefaultFormats();
+
+        //!
+        //! Lock on the first sequence of consecutive packets in a memory area.
+        //! At each position in the data, the candidate encapsulations are tried in order.
+        //! @param [in] data Address of data area.
+        //! @param [in] size Size in bytes of the data area.
+        //! @param [in] min_size Minimum size in bytes of the sequence of consecutive packets.
+        //! All complete packets in this size must be valid (at least one packet).
+        //! When @a size is lower than @a min_size, all complete packets between the
+        //! returned @a offset and the end of the data must be valid (at least one packet).
+        //! @param [out] offset Offset in @a data of the first packet of the sequence.
+        //! @return True when the scanner is locked, false if no valid sequence was found.
+        //!
+        bool lock(const void* data, size_t size, size_t min_size, size_t& offset);
+
+        //!
+        //! Unlock the scanner. The next buffers must be searched using lock().
+        //!
+        void unlock() { _locked = false; }
+
+        //!
+        //! Check if the scanner is locked on a packet encapsulation.
+        //! @return True if the scanner is locked.
+        //!
+        bool isLocked() const { return _locked; }
+
+        //!
+        //! Get the packet size of the locked encapsulation.
+        //! @return The packet size in bytes, including the header. Zero when unlocked.
+        //!
+        size_t packetSize() const { return _locked ? _formats[_current].packet_size : 0; }
+
+        //!
+        //! Get the header size of the locked encapsulation.
+        //! @return The header size in bytes before the TS packet. Zero when unlocked.
+        //!
+        size_t headerSize() const { return _locked ? _formats[_current].header_size : 0; }
+
+        //!
+        //! Count consecutive packets of the locked encapsulation at the beginning of a memory area.
+        //! @param [in] data Address of data area. The first packet starts here.
+        //! @param [in] size Size in bytes of the data area.
+        //! @return The number of valid complete packets in @a data. Zero when unlocked.
+        //! @see CountPackets()
+        //!
+        size_t countPackets(const void* data, size_t size) const;
+
+    private:
+        // Description of a candidate encapsulation.
+        struct Format
+        {
+            size_t packet_size;
+            size_t header_size;
+        };
+
+        static constexpr size_t MAX_FORMATS = 3;
+
+        Format _formats[MAX_FORMATS];
+        size_t _count;    // Number of candidate formats.
+        size_t _current;  // Index of locked format.
+        bool   _locked;
+    };
+}
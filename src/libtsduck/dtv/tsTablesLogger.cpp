@@ -55,15 +55,20 @@ ts::TablesLogger::TablesLogger(TablesDisplay& display) :
     SectionHandlerInterface(),
     _use_text(false),
     _use_xml(false),
+    _use_json(false),
+    _use_json_udp(false),
     _use_binary(false),
     _use_udp(false),
     _text_destination(),
     _xml_destination(),
+    _json_destination(),
+    _json_udp(),
     _bin_destination(),
     _udp_destination(),
     _multi_files(false),
     _flush(false),
     _rewrite_xml(false),
+    _json_line(false),
     _rewrite_binary(false),
     _udp_local(),
     _udp_ttl(0),
@@ -90,11 +95,17 @@ ts::TablesLogger::TablesLogger(TablesDisplay& display) :
     _exit(false),
     _table_count(0),
     _packet_count(0),
+    _pool(),
     _demux(_duck),
     _cas_mapper(_duck),
     _xmlOut(_report),
     _xmlDoc(_report),
     _xmlOpen(false),
+    _jsonOut(_report),
+    _jsonWriter(_jsonOut),
+    _jsonDoc(_report),
+    _jsonOpen(false),
+    _jsonSock(false, _report),
     _binfile(),
     _sock(false, _report),
     _shortSections(),
@@ -102,6 +113,9 @@ ts::TablesLogger::TablesLogger(TablesDisplay& display) :
     _sectionsOnce(),
     _section_filters()
 {
+    _demux.setSectionPool(&_pool);
+    _cas_mapper.setSectionPool(&_pool);
+
     // Create an instance of each registered section filter.
     TablesLoggerFilterRepository::Instance()->createFilters(_section_filters);
     _report.debug(u"TablesLogger has %s section filters", {_section_filters.size()});
@@ -142,7 +156,8 @@ void ts::TablesLogger::defineArgs(Args& args) const
               u"collect complete tables, with all sections of the tables grouped and "
               u"ordered and collect each version of a table only once. Note that this "
               u"mode is incompatible with --xml-output since valid XML structures may "
-              u"contain complete tables only.");
+              u"contain complete tables only. With --json-output or --json-udp, the "
+              u"sections are described with their raw payload.");
 
     args.option(u"binary-output", 'b', Args::STRING);
     args.help(u"binary-output", u"filename",
@@ -174,9 +189,38 @@ void ts::TablesLogger::defineArgs(Args& args) const
               u"or multicast. It can be also a host name that translates to an IP "
               u"address. The 'port' specifies the destination UDP port.");
 
+    args.option(u"json-line");
+    args.help(u"json-line",
+              u"With --json-output, save each table on one line in compact JSON format. "
+              u"This is the line-delimited JSON format (also known as \"JSON lines\"). "
+              u"By default, a complete JSON document is produced, with all tables in "
+              u"one array.");
+
+    args.option(u"json-output", 0, Args::STRING);
+    args.help(u"json-output", u"filename",
+              u"Save the tables in JSON format in the specified file. To output the JSON "
+              u"text on the standard output, explicitly specify this option with \"-\" "
+              u"as output file name.\n\n"
+              u"The tables are directly streamed in JSON format, without building a complete "
+              u"document in memory. Each table is a JSON object which is built from its XML "
+              u"representation: the field \"#name\" is the XML element name, the XML "
+              u"attributes are fields of the object and the XML children are in an array "
+              u"named \"#nodes\". The field \"#metadata\" contains the PID of the table "
+              u"and the optional time stamp and packet indexes.");
+
+    args.option(u"json-udp", 0, Args::STRING);
+    args.help(u"json-udp", u"address:port",
+              u"Send the tables in JSON format over UDP/IP to the specified destination. "
+              u"Each UDP message contains one table in compact one-line JSON format, "
+              u"followed by a new line, as with --json-line. Tables which are too large "
+              u"for one UDP message are dropped with a warning. The 'address' specifies "
+              u"an IP address which can be either unicast or multicast. It can be also a "
+              u"host name that translates to an IP address. The 'port' specifies the "
+              u"destination UDP port.");
+
     args.option(u"local-udp", 0, Args::STRING);
     args.help(u"local-udp", u"address",
-              u"With --ip-udp, when the destination is a multicast address, specify "
+              u"With --ip-udp or --json-udp, when the destination is a multicast address, specify "
               u"the IP address of the outgoing local interface. It can be also a host "
               u"name that translates to a local address.");
 
@@ -224,7 +268,7 @@ void ts::TablesLogger::defineArgs(Args& args) const
               u"this option with \"-\" as output file name.\n\n"
               u"By default, the tables are interpreted and formatted as text on the standard "
               u"output. Several destinations can be specified at the same time: human-readable "
-              u"text output, binary output, UDP/IP messages.");
+              u"text output, binary output, XML or JSON output, UDP/IP messages.");
 
     args.option(u"pack-all-sections");
     args.help(u"pack-all-sections",
@@ -264,7 +308,7 @@ void ts::TablesLogger::defineArgs(Args& args) const
 
     args.option(u"ttl", 0, Args::POSITIVE);
     args.help(u"ttl",
-              u"With --ip-udp, specifies the TTL (Time-To-Live) socket option. "
+              u"With --ip-udp or --json-udp, specifies the TTL (Time-To-Live) socket option. "
               u"The actual option is either \"Unicast TTL\" or \"Multicast TTL\", "
               u"depending on the destination address. Remember that the default "
               u"Multicast TTL is 1 on most systems.");
@@ -287,7 +331,9 @@ bool ts::TablesLogger::loadArgs(DuckContext& duck, Args& args)
     _use_xml = args.present(u"xml-output");
     _use_binary = args.present(u"binary-output");
     _use_udp = args.present(u"ip-udp");
-    _use_text = args.present(u"output-file") || args.present(u"text-output") || ( !_use_xml && !_use_binary && !_use_udp);
+    _use_json = args.present(u"json-output");
+    _use_json_udp = args.present(u"json-udp");
+    _use_text = args.present(u"output-file") || args.present(u"text-output") || (!_use_xml && !_use_json && !_use_binary && !_use_udp && !_use_json_udp);
 
     // --output-file and --text-output are synonyms.
     if (args.present(u"output-file") && args.present(u"text-output")) {
@@ -296,6 +342,8 @@ bool ts::TablesLogger::loadArgs(DuckContext& duck, Args& args)
 
     // Output destinations.
     _xml_destination = args.value(u"xml-output");
+    _json_destination = args.value(u"json-output");
+    _json_udp = args.value(u"json-udp");
     _bin_destination = args.value(u"binary-output");
     _udp_destination = args.value(u"ip-udp");
     _text_destination = args.value(u"output-file", args.value(u"text-output").c_str());
@@ -307,10 +355,14 @@ bool ts::TablesLogger::loadArgs(DuckContext& duck, Args& args)
     if (_xml_destination == u"-") {
         _xml_destination.clear();
     }
+    if (_json_destination == u"-") {
+        _json_destination.clear();
+    }
 
     _multi_files = args.present(u"multiple-files");
     _rewrite_binary = args.present(u"rewrite-binary");
     _rewrite_xml = args.present(u"rewrite-xml");
+    _json_line = args.present(u"json-line");
     _flush = args.present(u"flush");
     _udp_local = args.value(u"local-udp");
     _udp_ttl = args.intValue(u"ttl", 0);
@@ -365,6 +417,9 @@ bool ts::TablesLogger::open()
     _xmlOut.close();
     _xmlDoc.clear();
     _xmlOpen = false;
+    _jsonWriter.close();
+    _jsonOut.close();
+    _jsonOpen = false;
     _shortSections.clear();
     _allSections.clear();
     _sectionsOnce.clear();
@@ -375,6 +430,9 @@ bool ts::TablesLogger::open()
     if (_sock.isOpen()) {
         _sock.close(_report);
     }
+    if (_jsonSock.isOpen()) {
+        _jsonSock.close(_report);
+    }
 
     // Set PID's to filter.
     _demux.setPIDFilter(_initial_pids);
@@ -408,6 +466,14 @@ bool ts::TablesLogger::open()
         return false;
     }
 
+    // Open/create the JSON output. Tables are converted in a transient XML document first.
+    _jsonDoc.setTweaks(_xml_tweaks);
+    _jsonDoc.initialize(u"tsduck");
+    if (_use_json && !createJSON(_json_destination)) {
+        _abort = true;
+        return false;
+    }
+
     // Open/create the binary output.
     if (_use_binary && !_multi_files && !_rewrite_binary && !createBinaryFile(_bin_destination)) {
         _abort = true;
@@ -428,6 +494,19 @@ bool ts::TablesLogger::open()
         }
     }
 
+    // Initialize JSON UDP output.
+    if (_use_json_udp) {
+        _abort =
+            !_jsonSock.open(_report) ||
+            !_jsonSock.setDefaultDestination(_json_udp, _report) ||
+            (!_udp_local.empty() && !_jsonSock.setOutgoingMulticast(_udp_local, _report)) ||
+            (_udp_ttl > 0 && !_jsonSock.setTTL(_udp_ttl, _report));
+        if (_abort) {
+            _jsonSock.close(_report);
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -450,12 +529,19 @@ void ts::TablesLogger::close()
 
         // Close files and documents.
         closeXML();
+        closeJSON();
         if (_binfile.is_open()) {
             _binfile.close();
         }
         if (_sock.isOpen()) {
             _sock.close(_report);
         }
+        if (_jsonSock.isOpen()) {
+            _jsonSock.close(_report);
+        }
+
+        _report.debug(u"sections: %'d created, %'d buffers allocated, %'d allocated and %'d recycled from pool",
+                      {Section::InstanceCount(), Section::BufferCount(), _pool.allocatedCount(), _pool.recycledCount()});
 
         // Now completed.
         _exit = true;
@@ -503,9 +589,14 @@ void ts::TablesLogger::handleTable(SectionDemux&, const BinaryTable& table)
 
     // Ignore duplicate tables with a short section.
     if (_no_duplicate && table.isShortSection()) {
-        if (_shortSections[pid].isNull() || *_shortSections[pid] != *table.sectionAt(0)) {
-            // Not the same section, keep it for next time.
-            _shortSections[pid] = new Section(*table.sectionAt(0), COPY);
+        SectionPtr& previous(_shortSections[pid]);
+        if (previous.isNull()) {
+            // First section on this PID, keep it for next time.
+            previous = new Section(*table.sectionAt(0), COPY);
+        }
+        else if (*previous != *table.sectionAt(0)) {
+            // Not the same section, keep it for next time, reusing the previous section object.
+            previous->copy(*table.sectionAt(0));
         }
         else {
             // Same section as previously, ignore it.
@@ -538,6 +629,10 @@ void ts::TablesLogger::handleTable(SectionDemux&, const BinaryTable& table)
         }
     }
 
+    if (_use_json || _use_json_udp) {
+        saveJSON(&table, nullptr);
+    }
+
     if (_use_binary) {
         // In case of rewrite for each table, create a new file.
         if (_rewrite_binary && !createBinaryFile(_bin_destination)) {
@@ -616,9 +711,14 @@ void ts::TablesLogger::handleSection(SectionDemux& demux, const Section& sect)
 
     // Ignore duplicate sections.
     if (_no_duplicate) {
-        if (_allSections[pid].isNull() || *_allSections[pid] != sect) {
-            // Not the same section, keep it for next time.
-            _allSections[pid] = new Section(sect, COPY);
+        SectionPtr& previous(_allSections[pid]);
+        if (previous.isNull()) {
+            // First section on this PID, keep it for next time.
+            previous = new Section(sect, COPY);
+        }
+        else if (*previous != sect) {
+            // Not the same section, keep it for next time, reusing the previous section object.
+            previous->copy(sect);
         }
         else {
             // Same section as previously, ignore it.
@@ -628,6 +728,7 @@ void ts::TablesLogger::handleSection(SectionDemux& demux, const Section& sect)
 
     // Filtering done, now save data.
     // Note that no XML can be produced since valid XML structures contain complete tables only.
+    // JSON sections are described with their raw payload.
 
     if (_use_text) {
         preDisplay(sect.getFirstTSPacketIndex(), sect.getLastTSPacketIndex());
@@ -642,6 +743,10 @@ void ts::TablesLogger::handleSection(SectionDemux& demux, const Section& sect)
         postDisplay();
     }
 
+    if (_use_json || _use_json_udp) {
+        saveJSON(nullptr, &sect);
+    }
+
     if (_use_binary) {
         // In case of rewrite for each section, create a new file.
         if (_rewrite_binary && !createBinaryFile(_bin_destination)) {
@@ -930,6 +1035,120 @@ void ts::TablesLogger::closeXML()
 }
 
 
+//----------------------------------------------------------------------------
+// Open/write/close JSON file, send JSON over UDP.
+//----------------------------------------------------------------------------
+
+bool ts::TablesLogger::createJSON(const ts::UString& name)
+{
+    if (name.empty()) {
+        // Use standard output.
+        _jsonOut.setStream(std::cout);
+    }
+    else if (!_jsonOut.setFile(name)) {
+        _abort = true;
+        return false;
+    }
+    _jsonWriter.setCompact(_json_line);
+    return true;
+}
+
+void ts::TablesLogger::saveJSON(const BinaryTable* table, const Section* section)
+{
+    // Get the XML representation of the table. It is immediately streamed and deleted.
+    // No JSON tree is built and the XML element is never part of a complete document.
+    xml::Element* elem = nullptr;
+    if (table != nullptr) {
+        elem = table->toXML(_duck, _jsonDoc.rootElement(), false);
+        if (elem == nullptr) {
+            // XML conversion error, message already displayed.
+            return;
+        }
+    }
+    else if (section == nullptr) {
+        return;
+    }
+
+    const PID pid = table != nullptr ? table->sourcePID() : section->sourcePID();
+    const PacketCounter first = table != nullptr ? table->getFirstTSPacketIndex() : section->getFirstTSPacketIndex();
+    const PacketCounter last = table != nullptr ? table->getLastTSPacketIndex() : section->getLastTSPacketIndex();
+    const Time now(_time_stamp ? Time::CurrentLocalTime() : Time::Epoch);
+
+    // Save in JSON file.
+    if (_use_json) {
+        if (!_json_line && !_jsonOpen) {
+            // If this is the first table, open the root object with it.
+            _jsonOpen = true;
+            _jsonWriter.beginObject();
+            _jsonWriter.addString(u"#name", u"tsduck");
+            _jsonWriter.beginArray(u"#nodes");
+        }
+        writeJSON(_jsonWriter, elem, section, pid, first, last, now);
+        if (_flush) {
+            _jsonOut.flush();
+        }
+    }
+
+    // Send one compact JSON line over UDP.
+    if (_use_json_udp) {
+        TextFormatter line(_report);
+        line.setString();
+        {
+            json::StreamWriter writer(line, true);
+            writeJSON(writer, elem, section, pid, first, last, now);
+        }
+        const std::string data(line.toString().toUTF8());
+        if (data.size() > IP_MAX_PACKET_SIZE - 1 - IPv4_MIN_HEADER_SIZE - UDP_HEADER_SIZE) {
+            _report.warning(u"JSON description of table too large for UDP (%'d bytes), dropped", {data.size()});
+        }
+        else {
+            _jsonSock.send(data.data(), data.size(), _report);
+        }
+    }
+
+    // Deallocating the element forces the removal from the document through the destructor.
+    delete elem;
+}
+
+void ts::TablesLogger::writeJSON(json::StreamWriter& writer, const xml::Element* table, const Section* section, PID pid, PacketCounter first, PacketCounter last, const Time& time)
+{
+    writer.beginObject();
+    if (table != nullptr) {
+        writer.addXMLContent(table);
+    }
+    else if (section != nullptr) {
+        writer.addString(u"#name", u"section");
+        writer.addInteger(u"table_id", section->tableId());
+        if (section->isLongSection()) {
+            writer.addInteger(u"table_id_ext", section->tableIdExtension());
+            writer.addInteger(u"version", section->version());
+            writer.addBoolean(u"current", section->isCurrent());
+            writer.addInteger(u"section_number", section->sectionNumber());
+            writer.addInteger(u"last_section_number", section->lastSectionNumber());
+        }
+        writer.addString(u"payload", UString::Dump(section->payload(), section->payloadSize(), UString::HEXA | UString::COMPACT));
+    }
+    writer.beginObject(u"#metadata");
+    writer.addInteger(u"PID", pid);
+    if (_time_stamp) {
+        writer.addString(u"time", UString(time));
+    }
+    if (_packet_index) {
+        writer.addInteger(u"first_packet", first);
+        writer.addInteger(u"last_packet", last);
+    }
+    writer.endObject();
+    writer.endObject();
+}
+
+void ts::TablesLogger::closeJSON()
+{
+    _jsonWriter.close();
+    _jsonOpen = false;
+    _jsonOut.close();
+}
+
+
 //----------------------------------------------------------------------------
 //  Log a table (option --log)
 //----------------------------------------------------------------------------
@@ -45,6 +45,7 @@
 #include "tsCASMapper.h"
 #include "tsxmlTweaks.h"
 #include "tsxmlDocument.h"
+#include "tsjsonStreamWriter.h"
 
 namespace ts {
     //!
@@ -146,15 +147,20 @@ namespace ts {
         // Command line options:
         bool                     _use_text;          // Produce formatted human-readable tables.
         bool                     _use_xml;           // Produce XML tables.
+        bool                     _use_json;          // Produce JSON tables.
+        bool                     _use_json_udp;      // Send JSON tables using UDP/IP.
         bool                     _use_binary;        // Save binary sections.
         bool                     _use_udp;           // Send sections using UDP/IP.
         UString                  _text_destination;  // Text output file name.
         UString                  _xml_destination;   // XML output file name.
+        UString                  _json_destination;  // JSON output file name.
+        UString                  _json_udp;          // JSON UDP/IP destination address:port.
         UString                  _bin_destination;   // Binary output file name.
         UString                  _udp_destination;   // UDP/IP destination address:port.
         bool                     _multi_files;       // Multiple binary output files (one per section).
         bool                     _flush;             // Flush output file.
         bool                     _rewrite_xml;       // Rewrite a new XML file for each table.
+        bool                     _json_line;         // Line-delimited JSON output, one table per line.
         bool                     _rewrite_binary;    // Rewrite a new binary file for each table.
         UString                  _udp_local;         // Name of outgoing local address (empty if unspecified).
         int                      _udp_ttl;           // Time-to-live socket option.
@@ -183,11 +189,17 @@ namespace ts {
         bool                     _exit;
         uint32_t                 _table_count;
         PacketCounter            _packet_count;
+        SectionPool              _pool;              // Pool of recycled sections for the demux.
         SectionDemux             _demux;
         CASMapper                _cas_mapper;
         TextFormatter            _xmlOut;            // XML output formatter.
         xml::Document            _xmlDoc;            // XML root document.
         bool                     _xmlOpen;           // The XML root element is open.
+        TextFormatter            _jsonOut;           // JSON output formatter.
+        json::StreamWriter       _jsonWriter;        // JSON streaming writer on _jsonOut.
+        xml::Document            _jsonDoc;           // Transient XML document, to convert tables before JSON output.
+        bool                     _jsonOpen;          // The JSON root object is open.
+        UDPSocket                _jsonSock;          // Output socket for JSON tables.
         std::ofstream            _binfile;           // Binary output file.
         UDPSocket                _sock;              // Output socket.
         std::map<PID,SectionPtr> _shortSections;     // Tracking duplicate short sections by PID.
@@ -206,6 +218,12 @@ namespace ts {
         void saveXML(const BinaryTable& table);
         void closeXML();
 
+        // Open/write/close JSON tables and sections, send them over UDP.
+        bool createJSON(const UString& name);
+        void saveJSON(const BinaryTable* table, const Section* section);
+        void writeJSON(json::StreamWriter& writer, const xml::Element* table, const Section* section, PID pid, PacketCounter first, PacketCounter last, const Time& time);
+        void closeJSON();
+
         // Send UDP table and section.
         void sendUDP(const BinaryTable& table);
         void sendUDP(const Section& section);
@@ -30,6 +30,7 @@
 #include "tsTimeShiftBuffer.h"
 #include "tsNullReport.h"
 #include "tsSysUtils.h"
+#include "tsThread.h"
 TSDUCK_SOURCE;
 
 #if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
@@ -37,9 +38,34 @@ constexpr size_t ts::TimeShiftBuffer::MIN_TOTAL_PACKETS;
 constexpr size_t ts::TimeShiftBuffer::DEFAULT_TOTAL_PACKETS;
 constexpr size_t ts::TimeShiftBuffer::MIN_MEMORY_PACKETS;
 constexpr size_t ts::TimeShiftBuffer::DEFAULT_MEMORY_PACKETS;
+constexpr size_t ts::TimeShiftBuffer::MIN_SEGMENT_PACKETS;
+constexpr size_t ts::TimeShiftBuffer::DEFAULT_SEGMENT_PACKETS;
+constexpr size_t ts::TimeShiftBuffer::CHUNK_COUNT;
 #endif
 
 
+//----------------------------------------------------------------------------
+// The thread which performs all disk I/O.
+//----------------------------------------------------------------------------
+
+class ts::TimeShiftBuffer::IOThread : private Thread
+{
+    TS_NOBUILD_NOCOPY(IOThread);
+public:
+    // Constructor, start the thread.
+    IOThread(TimeShiftBuffer& buffer) : Thread(), _buffer(buffer) { start(); }
+
+    // Destructor, wait for the termination of the thread (must be requested first).
+    virtual ~IOThread() override { waitForTermination(); }
+
+private:
+    TimeShiftBuffer& _buffer;
+
+    // Implementation of Thread.
+    virtual void main() override { _buffer.processIO(); }
+};
+
+
 //----------------------------------------------------------------------------
 // Constructors and destructors
 //----------------------------------------------------------------------------
@@ -49,17 +75,34 @@ ts::TimeShiftBuffer::TimeShiftBuffer(size_t count) :
     _cur_packets(0),
     _total_packets(std::max(count, MIN_TOTAL_PACKETS)),
     _mem_packets(DEFAULT_MEMORY_PACKETS),
+    _seg_packets(DEFAULT_SEGMENT_PACKETS),
     _directory(),
-    _file(),
+    _io_stalls(0),
     _next_read(0),
     _next_write(0),
-    _wcache_next(0),
-    _rcache_end(0),
-    _rcache_next(0),
-    _wcache(),
-    _rcache(),
-    _wmdata(),
-    _rmdata()
+    _packets(),
+    _mdata(),
+    _file_prefix(),
+    _seg_count(0),
+    _chunk_packets(0),
+    _wchunks(),
+    _rchunks(),
+    _wnext(0),
+    _rnext(0),
+    _wfill(0),
+    _wdone(0),
+    _rfill(0),
+    _rdone(0),
+    _io_terminate(false),
+    _io_failed(false),
+    _mutex(),
+    _cond(),
+    _io_thread(),
+    _io_report(),
+    _wfile(),
+    _rfile(),
+    _wseg(0),
+    _rseg(0)
 {
 }
 
@@ -95,6 +138,17 @@ bool ts::TimeShiftBuffer::setMemoryPackets(size_t count)
     }
 }
 
+bool ts::TimeShiftBuffer::setSegmentPackets(size_t count)
+{
+    if (_is_open) {
+        return false;
+    }
+    else {
+        _seg_packets = std::max(count, MIN_SEGMENT_PACKETS);
+        return true;
+    }
+}
+
 bool ts::TimeShiftBuffer::setBackupDirectory(const UString& directory)
 {
     if (_is_open) {
@@ -119,19 +173,17 @@ bool ts::TimeShiftBuffer::open(Report& report)
     }
 
     if (memoryResident()) {
-        // The buffer is entirely memory-resident in _wcache.
-        _wcache.resize(_total_packets);
-        _wmdata.resize(_total_packets);
-        _rcache.clear();
-        _rmdata.clear();
+        // The buffer is entirely memory-resident.
+        _packets.resize(_total_packets);
+        _mdata.resize(_total_packets);
     }
     else {
-        // The buffer is backed up on disk.
-        // Get the name of a temporary file. If a directory is specified, we will use the base name only.
-        UString filename(TempFile());
+        // The buffer is backed up on disk, in a rotating set of segment files.
+        // Get a prefix for the names of the segment files. If a directory is specified, we will use the base name only.
+        _file_prefix = TempFile(u"");
         if (!_directory.empty()) {
             if (IsDirectory(_directory)) {
-                filename = _directory + PathSeparator + BaseName(filename);
+                _file_prefix = _directory + PathSeparator + BaseName(_file_prefix);
             }
             else {
                 report.error(u"directory %s does not exist", {_directory});
@@ -139,24 +191,36 @@ bool ts::TimeShiftBuffer::open(Report& report)
             }
         }
 
-        // Create the backup file. The flag temporary means that it will be deleted on close.
-        // Use TSDuck proprietary format to save the packet metadata.
-        if (!_file.open(filename, TSFile::READ | TSFile::WRITE | TSFile::TEMPORARY, report, TSFile::FMT_DUCK)) {
-            return false;
+        // A segment file is overwritten only when all its packets have been read.
+        // Two additional segments are used for the ones which are partially read and written.
+        _seg_count = (_total_packets + _seg_packets - 1) / _seg_packets + 2;
+
+        // The read and write caches use half of memory quota each, in chunks of packets.
+        // Since the size of the buffer is larger than the memory quota, the packets to
+        // read are always on disk before the shift() needs them.
+        _chunk_packets = std::max<size_t>(1, _mem_packets / (2 * CHUNK_COUNT));
+        _wchunks.resize(CHUNK_COUNT);
+        _rchunks.resize(CHUNK_COUNT);
+        for (size_t i = 0; i < CHUNK_COUNT; ++i) {
+            _wchunks[i].packets.resize(_chunk_packets);
+            _wchunks[i].mdata.resize(_chunk_packets);
+            _rchunks[i].packets.resize(_chunk_packets);
+            _rchunks[i].mdata.resize(_chunk_packets);
         }
-
-        // The read and write buffers use half of memory quota each.
-        // Since the size of the file is larger than the sum of the two,
-        // the read and write caches never overlap when the buffer is full.
-        _wcache.resize(_mem_packets / 2);
-        _wmdata.resize(_mem_packets / 2);
-        _rcache.resize(_mem_packets / 2);
-        _rmdata.resize(_mem_packets / 2);
+        _wnext = _rnext = 0;
+        _wfill = _wdone = _rfill = _rdone = 0;
+        _wseg = _rseg = 0;
+        _io_terminate = _io_failed = false;
+        _io_report.resetMessages();
+
+        // Start the I/O thread.
+        _io_thread = new IOThread(*this);
+        report.debug(u"time-shift buffer: %d segment files of %'d packets, I/O by chunks of %'d packets", {_seg_count, _seg_packets, _chunk_packets});
     }
 
     _cur_packets = 0;
     _next_read = _next_write = 0;
-    _wcache_next = _rcache_end = _rcache_next = 0;
+    _io_stalls = 0;
     _is_open = true;
     return true;
 }
@@ -172,13 +236,39 @@ bool ts::TimeShiftBuffer::close(Report& report)
         return false;
     }
 
+    bool ok = true;
+
+    if (!_io_thread.isNull()) {
+        // Terminate the I/O thread. The destructor of the thread object waits for its termination.
+        {
+            GuardCondition lock(_mutex, _cond);
+            _io_terminate = true;
+            lock.signal();
+        }
+        _io_thread.clear();
+
+        // Close and delete all segment files.
+        ok = (!_wfile.isOpen() || _wfile.close(report)) && ok;
+        ok = (!_rfile.isOpen() || _rfile.close(report)) && ok;
+        for (size_t slot = 0; slot < _seg_count; ++slot) {
+            const UString name(segmentFileName(slot));
+            if (FileExists(name) && DeleteFile(name) != SYS_SUCCESS) {
+                report.error(u"error deleting %s", {name});
+                ok = false;
+            }
+        }
+        if (_io_stalls > 0) {
+            report.verbose(u"time-shift buffer waited %'d times for disk I/O", {_io_stalls});
+        }
+    }
+
     _is_open = false;
     _cur_packets = 0;
-    _wcache.clear();
-    _wmdata.clear();
-    _rcache.clear();
-    _rmdata.clear();
-    return !_file.isOpen() || _file.close(report);
+    _packets.clear();
+    _mdata.clear();
+    _wchunks.clear();
+    _rchunks.clear();
+    return ok;
 }
 
 
@@ -198,75 +288,82 @@ bool ts::TimeShiftBuffer::shift(TSPacket& packet, TSPacketMetadata& mdata, Repor
     const bool was_full = full();
 
     assert(_cur_packets <= _total_packets);
-    assert(_next_read < _total_packets);
-    assert(_next_write < _total_packets);
 
     if (memoryResident()) {
-        // The buffer is entirely memory-resident in _wcache.
-        assert(_wcache.size() == _total_packets);
+        // The buffer is entirely memory-resident.
+        assert(_packets.size() == _total_packets);
+        assert(_next_read < _total_packets);
+        assert(_next_write < _total_packets);
         if (was_full) {
             // Buffer full: return oldest packet.
-            ret_packet = _wcache[_next_read];
-            ret_mdata = _wmdata[_next_read];
-            _next_read = (_next_read + 1) % _wcache.size();
+            ret_packet = _packets[_next_read];
+            ret_mdata = _mdata[_next_read];
+            _next_read = (_next_read + 1) % _packets.size();
         }
         else {
             // Buffer not full, increase the packet count.
             _cur_packets++;
         }
-        _wcache[_next_write] = packet;
-        _wmdata[_next_write] = mdata;
-        _next_write = (_next_write + 1) % _wcache.size();
+        _packets[_next_write] = packet;
+        _mdata[_next_write] = mdata;
+        _next_write = (_next_write + 1) % _packets.size();
     }
     else {
-        // The buffer uses a backup file.
-        if (!was_full) {
-            // While the buffer is not full, simply write the packet in the file.
-            if (!_file.writePackets(&packet, &mdata, 1, report)) {
-                return false;
+        // The buffer uses backup files. The _mutex is used only at chunk boundaries.
+        // The counters _rdone and _wfill are modified in this thread only and can be read without lock.
+        if (was_full) {
+            // At the start of a read chunk, wait for the I/O thread to load it (normally already done).
+            if (_rnext == 0) {
+                GuardCondition lock(_mutex, _cond);
+                if (_rdone >= _rfill && !_io_failed) {
+                    _io_stalls++;
+                    do {
+                        lock.waitCondition();
+                    } while (_rdone >= _rfill && !_io_failed);
+                }
+                if (_io_failed) {
+                    report.error(u"time-shift buffer I/O error: %s", {_io_report.getMessages()});
+                    return false;
+                }
+            }
+            // Return oldest packet from the read cache.
+            const Chunk& rchunk(_rchunks[_rdone % CHUNK_COUNT]);
+            ret_packet = rchunk.packets[_rnext];
+            ret_mdata = rchunk.mdata[_rnext];
+            if (++_rnext >= _chunk_packets) {
+                // Read chunk completely consumed, release it for the next read-ahead.
+                GuardCondition lock(_mutex, _cond);
+                _rdone++;
+                _rnext = 0;
+                lock.signal();
             }
-            _cur_packets++;
         }
         else {
-            // The buffer is full, now read and write in caches.
-            // First, make sure the read cache is filled.
-            if (_rcache_next >= _rcache_end) {
-                // Read cache is empty, load it.
-                const size_t count = std::min(_rcache.size(), _total_packets - _next_read);
-                _rcache_next = 0;
-                _rcache_end = readFile(_next_read, &_rcache[0], &_rmdata[0], count, report);
-                if (_rcache_end == 0) {
-                    report.error(u"error reading time-shift file");
-                    return false;
-                }
+            // Buffer not full, increase the packet count.
+            _cur_packets++;
+        }
+
+        // Store the new packet in the write cache.
+        Chunk& wchunk(_wchunks[_wfill % CHUNK_COUNT]);
+        wchunk.packets[_wnext] = packet;
+        wchunk.mdata[_wnext] = mdata;
+        if (++_wnext >= _chunk_packets) {
+            // Write chunk full, pass it to the I/O thread and make sure that the next one is free.
+            GuardCondition lock(_mutex, _cond);
+            _wfill++;
+            _wnext = 0;
+            lock.signal();
+            if (_wfill - _wdone >= CHUNK_COUNT && !_io_failed) {
+                _io_stalls++;
+                do {
+                    lock.waitCondition();
+                } while (_wfill - _wdone >= CHUNK_COUNT && !_io_failed);
             }
-            // Return oldest packet from memory cache.
-            ret_packet = _rcache[_rcache_next];
-            ret_mdata = _rmdata[_rcache_next++];
-            _next_read = (_next_read + 1) % _total_packets;
-            // Flush the write cache if necessary.
-            if (_wcache_next >= _wcache.size()) {
-                // Flush the entire write cache on disk.
-                // Split in two operations if exceeds the end of file.
-                // Write index in file of the start of the write cache:
-                const size_t file_index = _next_write >= _wcache.size() ? _next_write - _wcache.size() : _total_packets + _next_write - _wcache.size();
-                assert(file_index < _total_packets);
-                const size_t count = std::min(_wcache.size(), _total_packets - file_index);
-                if (!writeFile(file_index, &_wcache[0], &_wmdata[0], count, report)) {
-                    return false;
-                }
-                // Write second part at begining of file if required.
-                if (count < _wcache.size() && !writeFile(0, &_wcache[count], &_wmdata[count], _wcache.size() - count, report)) {
-                    return false;
-                }
-                // Write cache is now empty.
-                _wcache_next = 0;
+            if (_io_failed) {
+                report.error(u"time-shift buffer I/O error: %s", {_io_report.getMessages()});
+                return false;
             }
-            // Write the next packet in the write cache.
-            _wcache[_wcache_next] = packet;
-            _wmdata[_wcache_next++] = mdata;
         }
-        _next_write = (_next_write + 1) % _total_packets;
     }
 
     // Returned packet. It is a null packet when the buffer was not yet full.
@@ -284,56 +381,138 @@ bool ts::TimeShiftBuffer::shift(TSPacket& packet, TSPacketMetadata& mdata, Repor
 
 
 //----------------------------------------------------------------------------
-// Seek in the backup file.
+// Body of the I/O thread.
 //----------------------------------------------------------------------------
 
-bool ts::TimeShiftBuffer::seekFile(size_t index, Report& report)
+void ts::TimeShiftBuffer::processIO()
 {
-    if (_file.seek(index, report)) {
-        return true;
-    }
-    else {
-        report.error(u"error seeking time-shift file at packet index %d", {index});
-        return false;
+    for (;;) {
+        bool write = false;
+        PacketCounter chunk = 0;
+
+        // Wait for a chunk to write or a chunk to read.
+        // Writes have priority, they free the memory of the writer.
+        // A chunk can be read when it is on disk and a slot is free in the read cache.
+        {
+            GuardCondition lock(_mutex, _cond);
+            while (!_io_terminate && _wdone >= _wfill && (_rfill >= _wdone || _rfill - _rdone >= CHUNK_COUNT)) {
+                lock.waitCondition();
+            }
+            if (_io_terminate) {
+                return;
+            }
+            write = _wdone < _wfill;
+            chunk = write ? _wdone : _rfill;
+        }
+
+        // Perform the I/O outside the mutex. The chunk slot is not accessed by shift() in the meantime.
+        const bool success = write ? writeChunk(chunk) : readChunk(chunk);
+
+        // Notify completion.
+        GuardCondition lock(_mutex, _cond);
+        if (!success) {
+            _io_failed = true;
+        }
+        else if (write) {
+            _wdone++;
+        }
+        else {
+            _rfill++;
+        }
+        lock.signal();
+        if (!success) {
+            return;
+        }
     }
 }
 
 
 //----------------------------------------------------------------------------
-// Seek and write in the backup file.
+// Name of the segment file for an absolute segment index.
 //----------------------------------------------------------------------------
 
-bool ts::TimeShiftBuffer::writeFile(size_t index, const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, Report& report)
+ts::UString ts::TimeShiftBuffer::segmentFileName(PacketCounter segment) const
 {
-    if (!seekFile(index, report)) {
-        return false;
-    }
-    else if (_file.writePackets(buffer, mdata, count, report)) {
-        report.debug(u"written %d packets in time-shift file at packet index %d", {count, index});
-        return true;
-    }
-    else {
-        report.error(u"error writing %d packets in time-shift file at packet index %d", {count, index});
-        return false;
-    }
+    return UString::Format(u"%s-%d.tsd", {_file_prefix, segment % _seg_count});
 }
 
 
 //----------------------------------------------------------------------------
-// Seek and read in the backup file.
+// Write a chunk in the segment files, from the I/O thread.
 //----------------------------------------------------------------------------
 
-size_t ts::TimeShiftBuffer::readFile(size_t index, TSPacket* buffer, TSPacketMetadata* mdata, size_t count, Report& report)
+bool ts::TimeShiftBuffer::writeChunk(PacketCounter chunk)
 {
-    if (!seekFile(index, report)) {
-        return false;
-    }
-    const size_t retcount = _file.readPackets(buffer, mdata, count, report);
-    if (retcount == 0) {
-        report.error(u"error reading %d packets in time-shift file at packet index %d", {count, index});
+    const Chunk& wchunk(_wchunks[chunk % CHUNK_COUNT]);
+    const PacketCounter first = chunk * _chunk_packets;
+
+    // A chunk may span two segment files or more.
+    for (size_t done = 0; done < _chunk_packets; ) {
+        const PacketCounter segment = (first + done) / _seg_packets;
+        const size_t offset = size_t((first + done) % _seg_packets);
+        const size_t count = std::min(_chunk_packets - done, _seg_packets - offset);
+
+        // Switch to a new segment file when necessary. The previous one is complete.
+        if (!_wfile.isOpen() || segment != _wseg) {
+            if (_wfile.isOpen() && !_wfile.close(_io_report)) {
+                return false;
+            }
+            if (!_wfile.open(segmentFileName(segment), TSFile::READ | TSFile::WRITE, _io_report, TSFile::FMT_DUCK)) {
+                return false;
+            }
+            _wseg = segment;
+        }
+
+        // The file may have been used to read the beginning of the segment, always seek first.
+        if (!_wfile.seek(offset, _io_report) || !_wfile.writePackets(&wchunk.packets[done], &wchunk.mdata[done], count, _io_report)) {
+            _io_report.error(u"error writing %d packets in time-shift file %s at packet index %d", {count, _wfile.getFileName(), offset});
+            return false;
+        }
+        done += count;
     }
-    else {
-        report.debug(u"read %d packets in time-shift file at packet index %d", {retcount, index});
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Read a chunk from the segment files, from the I/O thread.
+//----------------------------------------------------------------------------
+
+bool ts::TimeShiftBuffer::readChunk(PacketCounter chunk)
+{
+    Chunk& rchunk(_rchunks[chunk % CHUNK_COUNT]);
+    const PacketCounter first = chunk * _chunk_packets;
+
+    // A chunk may span two segment files or more.
+    for (size_t done = 0; done < _chunk_packets; ) {
+        const PacketCounter segment = (first + done) / _seg_packets;
+        const size_t offset = size_t((first + done) % _seg_packets);
+        const size_t count = std::min(_chunk_packets - done, _seg_packets - offset);
+
+        // When the reader leaves a segment, it will never come back, delete the file. This is
+        // also true when the segment was read using _wfile: the writer has already left it.
+        if (segment != _rseg) {
+            if (_rfile.isOpen() && !_rfile.close(_io_report)) {
+                return false;
+            }
+            DeleteFile(segmentFileName(_rseg));
+            _rseg = segment;
+        }
+
+        // Read the segment which is currently written using the same file.
+        TSFile* file = &_wfile;
+        if (!_wfile.isOpen() || segment != _wseg) {
+            file = &_rfile;
+            if (!_rfile.isOpen() && !_rfile.open(segmentFileName(segment), TSFile::READ, _io_report, TSFile::FMT_DUCK)) {
+                return false;
+            }
+        }
+
+        if (!file->seek(offset, _io_report) || file->readPackets(&rchunk.packets[done], &rchunk.mdata[done], count, _io_report) != count) {
+            _io_report.error(u"error reading %d packets in time-shift file %s at packet index %d", {count, file->getFileName(), offset});
+            return false;
+        }
+        done += count;
     }
-    return retcount;
+    return true;
 }
@@ -36,7 +36,9 @@
 #include "tsUString.h"
 #include "tsTSFile.h"
 #include "tsTSPacketMetadata.h"
-#include "tsReport.h"
+#include "tsReportBuffer.h"
+#include "tsGuardCondition.h"
+#include "tsSafePtr.h"
 
 namespace ts {
 
@@ -47,6 +49,13 @@ namespace ts {
     //! The buffer is partly implemented in virtual memory and partly on disk.
     //! @ingroup mpeg
     //!
+    //! When the buffer is larger than the memory cache, the packets are stored in
+    //! a rotating set of segment files on disk. All disk I/O are performed by an
+    //! internal thread, in batches of packets: the packets are written in the
+    //! background and read back in advance. The memory which is used by the
+    //! buffer never exceeds the size of the memory cache. The caller of shift()
+    //! is blocked only when the disk is not fast enough to absorb the bitrate.
+    //!
     class TSDUCKDLL TimeShiftBuffer
     {
         TS_NOCOPY(TimeShiftBuffer);
@@ -66,7 +75,15 @@ namespace ts {
         //!
         //! Default number of cached packets in memory.
         //!
-        static constexpr size_t DEFAULT_MEMORY_PACKETS = 128;
+        static constexpr size_t DEFAULT_MEMORY_PACKETS = 16384;
+        //!
+        //! Minimum number of packets per segment file on disk.
+        //!
+        static constexpr size_t MIN_SEGMENT_PACKETS = 16;
+        //!
+        //! Default number of packets per segment file on disk.
+        //!
+        static constexpr size_t DEFAULT_SEGMENT_PACKETS = 131072;
 
         //!
         //! Constructor.
@@ -96,12 +113,20 @@ namespace ts {
         bool setMemoryPackets(size_t count);
 
         //!
-        //! Set the directory for the backup file on disk.
+        //! Set the number of packets per segment file on disk.
         //! Must be called before open().
-        //! By default, the file is created in the system-dependent temporary directory.
+        //! @param [in] count Max number of packets in each segment file.
+        //! @return True on success, false if already open.
+        //!
+        bool setSegmentPackets(size_t count);
+
+        //!
+        //! Set the directory for the backup files on disk.
+        //! Must be called before open().
+        //! By default, the files are created in the system-dependent temporary directory.
         //! When the maximum number of cached packets in memory is larger than the
         //! buffer size, the buffer is entirely resident in memory and no file is created.
-        //! The back file is automatically deleted when the time-shift buffer is closed.
+        //! The backup files are automatically deleted when the time-shift buffer is closed.
         //! @param [in] directory Directory name.
         //! @return True on success, false if already open or too small.
         //!
@@ -116,7 +141,7 @@ namespace ts {
 
         //!
         //! Close the buffer.
-        //! The memory is freed and the disk backup file is deleted.
+        //! The I/O thread is terminated, the memory is freed and the disk backup files are deleted.
         //! @param [in,out] report Where to report errors.
         //! @return True on success, false on error.
         //!
@@ -158,6 +183,14 @@ namespace ts {
         //!
         bool memoryResident() const { return _total_packets <= _mem_packets; }
 
+        //!
+        //! Get the number of times shift() had to wait for the completion of disk I/O.
+        //! A non-zero value means that the disk is not fast enough to absorb the bitrate
+        //! or that the memory cache is too small to compensate the disk latency.
+        //! @return The number of times shift() waited for the I/O thread since open().
+        //!
+        PacketCounter ioStalls() const { return _io_stalls; }
+
         //!
         //! Push a packet in the time-shift buffer and pull the oldest one.
         //!
@@ -176,25 +209,71 @@ namespace ts {
         bool shift(TSPacket& packet, TSPacketMetadata& metadata, Report& report);
 
     private:
-        bool    _is_open;                // Buffer is open.
-        size_t  _cur_packets;            // Current number of packets in the buffer.
-        size_t  _total_packets;          // Total capacity of the buffer.
-        size_t  _mem_packets;            // Max packets in memory.
-        UString _directory;              // Where to store the backup file.
-        TSFile  _file;                   // Backup file on disk.
-        size_t  _next_read;              // Index in buffer of next packet to read.
-        size_t  _next_write;             // Index in buffer of next packet to write.
-        size_t  _wcache_next;            // Next index to write in _wcache (up to end of _wcache).
-        size_t  _rcache_end;             // End index in _rcache (after last loaded packet).
-        size_t  _rcache_next;            // Next index to read in _rcache.
-        TSPacketVector         _wcache;  // Write cache (or complete buffer if in memory).
-        TSPacketVector         _rcache;  // Read cache.
-        TSPacketMetadataVector _wmdata;  // Packet metadata for _wcache.
-        TSPacketMetadataVector _rmdata;  // Packet metadata for _rcache.
-
-        // Seek, read, write in the backup file.
-        bool seekFile(size_t index, Report& report);
-        bool writeFile(size_t index, const TSPacket* buffer, const TSPacketMetadata* mdata, size_t count, Report& report);
-        size_t readFile(size_t index, TSPacket* buffer, TSPacketMetadata* mdata, size_t count, Report& report);
+        // Number of chunks of packets in each of the read and write caches, when backed up on disk.
+        static constexpr size_t CHUNK_COUNT = 4;
+
+        // A chunk of packets, the unit of disk I/O.
+        struct Chunk
+        {
+            TSPacketVector         packets;
+            TSPacketMetadataVector mdata;
+            Chunk() : packets(), mdata() {}
+        };
+        typedef std::vector<Chunk> ChunkVector;
+
+        // The thread which performs all disk I/O.
+        class IOThread;
+        typedef SafePtr<IOThread, NullMutex> IOThreadPtr;
+
+        bool           _is_open;         // Buffer is open.
+        size_t         _cur_packets;     // Current number of packets in the buffer.
+        size_t         _total_packets;   // Total capacity of the buffer.
+        size_t         _mem_packets;     // Max packets in memory.
+        size_t         _seg_packets;     // Max packets per segment file.
+        UString        _directory;       // Where to store the backup files.
+        PacketCounter  _io_stalls;       // Number of times shift() waited for the I/O thread.
+
+        // Memory-resident buffer.
+        size_t                 _next_read;   // Index in buffer of next packet to read.
+        size_t                 _next_write;  // Index in buffer of next packet to write.
+        TSPacketVector         _packets;     // Complete buffer.
+        TSPacketMetadataVector _mdata;       // Packet metadata for _packets.
+
+        // Disk-backed buffer. Chunk counters are absolute: chunk N contains the packets
+        // N * _chunk_packets to (N + 1) * _chunk_packets - 1 since the buffer was opened.
+        // The chunk N uses the slot N % CHUNK_COUNT in the read or write cache.
+        UString        _file_prefix;     // Prefix of segment file names.
+        size_t         _seg_count;       // Number of segment files in the rotating set.
+        size_t         _chunk_packets;   // Number of packets per chunk.
+        ChunkVector    _wchunks;         // Write cache.
+        ChunkVector    _rchunks;         // Read cache.
+        size_t         _wnext;           // Next packet index in current write chunk.
+        size_t         _rnext;           // Next packet index in current read chunk.
+        PacketCounter  _wfill;           // Number of chunks filled by shift(), ready to write.
+        PacketCounter  _wdone;           // Number of chunks written on disk by the I/O thread.
+        PacketCounter  _rfill;           // Number of chunks read from disk by the I/O thread.
+        PacketCounter  _rdone;           // Number of chunks consumed by shift().
+        bool           _io_terminate;    // Request to terminate the I/O thread.
+        bool           _io_failed;       // The I/O thread failed and terminated.
+        Mutex          _mutex;           // Protect the chunk counters and flags.
+        Condition      _cond;            // Signaled when one of the chunk counters or flags is modified.
+        IOThreadPtr    _io_thread;       // The I/O thread.
+
+        // Used by the I/O thread only.
+        ReportBuffer<> _io_report;       // Error messages from the I/O thread.
+        TSFile         _wfile;           // Segment file being written.
+        TSFile         _rfile;           // Segment file being read, when not the one being written.
+        PacketCounter  _wseg;            // Absolute index of segment in _wfile.
+        PacketCounter  _rseg;            // Absolute index of segment which is read, in _rfile or _wfile.
+
+        // Body of the I/O thread.
+        void processIO();
+
+        // Write or read a chunk in the segment files, from the I/O thread.
+        bool writeChunk(PacketCounter chunk);
+        bool readChunk(PacketCounter chunk);
+
+        // Name of the segment file for an absolute segment index.
+        UString segmentFileName(PacketCounter segment) const;
     };
 }
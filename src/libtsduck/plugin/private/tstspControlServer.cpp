@@ -29,6 +29,7 @@
 
 #include "tstspControlServer.h"
 #include "tstspPluginExecutor.h"
+#include "tstspTelemetryMonitor.h"
 #include "tsNullMutex.h"
 #include "tsNullReport.h"
 #include "tsReportBuffer.h"
@@ -58,7 +59,8 @@ ts::tsp::ControlServer::ControlServer(TSProcessorArgs& options, Report& log, Mut
               {TSPControlCommand::CMD_LIST,    &ControlServer::executeList},
               {TSPControlCommand::CMD_SUSPEND, &ControlServer::executeSuspend},
               {TSPControlCommand::CMD_RESUME,  &ControlServer::executeResume},
-              {TSPControlCommand::CMD_RESTART, &ControlServer::executeRestart}}
+              {TSPControlCommand::CMD_RESTART, &ControlServer::executeRestart},
+              {TSPControlCommand::CMD_STATS,   &ControlServer::executeStats}}
 {
     // Locate output plugin, count packet processor plugins.
     if (_input != nullptr) {
@@ -356,3 +358,35 @@ void ts::tsp::ControlServer::executeRestart(const Args* args, Report& response)
         plugin->restart(params, response);
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Stats command.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ControlServer::executeStats(const Args* args, Report& response)
+{
+    if (args->present(u"json")) {
+        response.info(TelemetryMonitor::BuildReport(_input)->printed());
+    }
+    else {
+        statsOnePlugin(0, u'I', _input, response);
+        size_t index = 1;
+        for (size_t i = 0; i < _plugins.size(); ++i) {
+            statsOnePlugin(index++, u'P', _plugins[i], response);
+        }
+        statsOnePlugin(index, u'O', _output, response);
+    }
+
+    if (args->present(u"reset")) {
+        PluginExecutor* proc = _input;
+        do {
+            proc->resetTelemetry();
+        } while ((proc = proc->ringNext<PluginExecutor>()) != _input);
+    }
+}
+
+void ts::tsp::ControlServer::statsOnePlugin(size_t index, UChar type, PluginExecutor* plugin, Report& response)
+{
+    response.info(u"%2d: %c-%s: %s", {index, type, plugin->pluginName(), plugin->telemetry().toText()});
+}
@@ -106,6 +106,8 @@ namespace ts {
             void executeResume(const Args*, Report&);
             void executeSuspendResume(bool state, const Args*, Report&);
             void executeRestart(const Args*, Report&);
+            void executeStats(const Args*, Report&);
+            void statsOnePlugin(size_t index, UChar type, PluginExecutor* plugin, Report& report);
         };
     }
 }
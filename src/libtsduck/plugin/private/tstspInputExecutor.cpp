@@ -104,6 +104,7 @@ bool ts::tsp::InputExecutor::initAllBuffers(PacketBuffer* buffer, PacketMetadata
     // Indicate that the loaded packets are now available to the next packet processor.
     PluginExecutor* next = ringNext<PluginExecutor>();
     next->initBuffer(buffer, metadata, 0, pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
+    _telemetry.flushed(pkt_read);
 
     // The rest of the buffer belongs to this input processor for reading additional packets.
     initBuffer(buffer, metadata, pkt_read % buffer->count(), buffer->count() - pkt_read, pkt_read == 0, pkt_read == 0, init_bitrate);
@@ -60,6 +60,23 @@ ts::tsp::JointTermination::JointTermination(const TSProcessorArgs& options,
 {
 }
 
+ts::tsp::JointTermination::~JointTermination()
+{
+    // All plugin threads are terminated when the executors are deleted.
+    if (_use_jt) {
+        Guard lock(_global_mutex);
+        _jt_users--;
+        if (!_jt_completed) {
+            _jt_remaining--;
+        }
+        if (_jt_users == 0) {
+            _jt_hightest_pkt = 0;
+        }
+        assert(_jt_users >= 0);
+        assert(_jt_remaining >= 0);
+    }
+}
+
 
 //----------------------------------------------------------------------------
 // Implementation of "joint termination", inherited from TSP.
@@ -65,6 +65,13 @@ namespace ts {
                              Mutex& global_mutex,
                              Report* report);
 
+            //!
+            //! Destructor.
+            //! The plugin is withdrawn from "joint termination" so that the next
+            //! TS processor in the same process starts with a clean state.
+            //!
+            virtual ~JointTermination();
+
             // Implementation of "joint termination", inherited from TSP.
             virtual void useJointTermination(bool on) override;
             virtual void jointTerminate() override;
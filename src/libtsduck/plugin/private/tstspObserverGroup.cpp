@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tstspObserverGroup.h"
+#include "tsGuardCondition.h"
+#include "tsGuard.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// Constructor.
+//----------------------------------------------------------------------------
+
+ts::tsp::ObserverGroup::ObserverGroup(size_t count) :
+    _mutex(),
+    _progressed(),
+    _progress(count, 0),
+    _end(std::numeric_limits<PacketCounter>::max())
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Report the progress or the termination of a member of the group.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ObserverGroup::setProgress(size_t member, PacketCounter total)
+{
+    GuardCondition lock(_mutex, _progressed);
+    if (member < _progress.size() && _progress[member] != std::numeric_limits<PacketCounter>::max()) {
+        _progress[member] = total;
+        lock.signal();
+    }
+}
+
+void ts::tsp::ObserverGroup::terminate(size_t member)
+{
+    GuardCondition lock(_mutex, _progressed);
+    if (member < _progress.size()) {
+        _progress[member] = std::numeric_limits<PacketCounter>::max();
+        lock.signal();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Wait until all members, except the last one, have processed some packets.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ObserverGroup::waitProgress(PacketCounter total)
+{
+    GuardCondition lock(_mutex, _progressed);
+    for (size_t i = 0; i + 1 < _progress.size(); ) {
+        if (_progress[i] >= total) {
+            ++i;
+        }
+        else {
+            lock.waitCondition();
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Request or get the termination of the stream.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ObserverGroup::requestEnd(PacketCounter position)
+{
+    Guard lock(_mutex);
+    _end = std::min(_end, position);
+}
+
+ts::PacketCounter ts::tsp::ObserverGroup::endPosition()
+{
+    Guard lock(_mutex);
+    return _end;
+}
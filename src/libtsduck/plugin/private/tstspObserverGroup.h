@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Transport stream processor: Group of parallel observer plugins
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsMPEG.h"
+#include "tsSafePtr.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+
+namespace ts {
+    namespace tsp {
+        //!
+        //! Synchronization of a group of consecutive observer plugins in tsp.
+        //!
+        //! Observer plugins never modify packets. In a group of consecutive observers,
+        //! each member except the last one passes its window of packets to the next
+        //! member before processing it. All members therefore process the same packets
+        //! at the same time in their own thread. The last member of the group passes the
+        //! packets to the rest of the chain only when all members have processed them.
+        //!
+        //! The progress of each member is the total number of packets it has processed
+        //! since the beginning. Since all members see the same sequence of packets, the
+        //! progress values can be compared, whatever the sizes of the individual windows.
+        //!
+        //! This class is internal to the TSDuck library and cannot be called by applications.
+        //! @ingroup plugin
+        //!
+        class ObserverGroup
+        {
+            TS_NOBUILD_NOCOPY(ObserverGroup);
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] count Number of plugins in the group.
+            //!
+            explicit ObserverGroup(size_t count);
+
+            //!
+            //! Get the number of plugins in the group.
+            //! @return The number of plugins in the group.
+            //!
+            size_t size() const { return _progress.size(); }
+
+            //!
+            //! Report the progress of a member of the group.
+            //! @param [in] member Index of the member in the group.
+            //! @param [in] total Total number of packets which were processed by this member.
+            //!
+            void setProgress(size_t member, PacketCounter total);
+
+            //!
+            //! Declare that a member of the group has terminated.
+            //! It no longer prevents the other members from passing packets.
+            //! @param [in] member Index of the member in the group.
+            //!
+            void terminate(size_t member);
+
+            //!
+            //! Wait until all members of the group, except the last one, have processed some packets.
+            //! This method is called by the last member of the group.
+            //! @param [in] total Total number of packets which must have been processed by all members.
+            //!
+            void waitProgress(PacketCounter total);
+
+            //!
+            //! Request the termination of the stream by a member of the group.
+            //! Must be called before reporting a progress which includes the position.
+            //! @param [in] position Number of packets before the end of stream, as counted by the members.
+            //!
+            void requestEnd(PacketCounter position);
+
+            //!
+            //! Get the position of the end of stream, as requested by a member of the group.
+            //! This method is called by the last member of the group, after waitProgress().
+            //! @return The number of packets before the end of stream or the maximum
+            //! value of PacketCounter if no termination was requested.
+            //!
+            PacketCounter endPosition();
+
+        private:
+            Mutex                      _mutex;
+            Condition                  _progressed;  // Signaled when a member makes progress.
+            std::vector<PacketCounter> _progress;    // Progress of each member, accessed under mutex.
+            PacketCounter              _end;         // Requested end of stream, accessed under mutex.
+        };
+
+        //!
+        //! Safe pointer to an ObserverGroup (thread-safe).
+        //!
+        typedef SafePtr<ObserverGroup, Mutex> ObserverGroupPtr;
+    }
+}
@@ -51,8 +51,11 @@ ts::tsp::PluginExecutor::PluginExecutor(const TSProcessorArgs& options,
     _buffer(nullptr),
     _metadata(nullptr),
     _suspended(false),
+    _telemetry(),
     _handlers(handlers),
     _to_do(),
+    _to_do_mutex(),
+    _waiting(false),
     _pkt_first(0),
     _pkt_cnt(0),
     _input_end(false),
@@ -128,6 +131,14 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, BitRate bitrate, bool in
 
     log(10, u"passPackets(count = %'d, bitrate = %'d, input_end = %s, aborted = %s)", {count, bitrate, input_end, aborted});
 
+    if (count > 0) {
+        _telemetry.flushed(count);
+    }
+
+    if (_options.lock_free) {
+        return passPacketsLockFree(count, bitrate, input_end, aborted);
+    }
+
     // We access data under the protection of the global mutex.
     Guard lock(_global_mutex);
 
@@ -165,6 +176,69 @@ bool ts::tsp::PluginExecutor::passPackets(size_t count, BitRate bitrate, bool in
 }
 
 
+//----------------------------------------------------------------------------
+// Signal that the specified number of packets have been processed.
+// Lock-free version: the global mutex is not used.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::PluginExecutor::passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted)
+{
+    // Our own starting index is modified by this thread only.
+    _pkt_first = (_pkt_first + count) % _buffer->count();
+    _pkt_cnt -= count;
+
+    // Update next processor's buffer. The order of the atomic operations matters:
+    // the packets must be published before the end of input so that the next processor
+    // cannot see the end of input without all the preceding packets.
+    PluginExecutor* next = ringNext<PluginExecutor>();
+    next->_bitrate = bitrate;
+    next->_pkt_cnt += count;
+    if (input_end) {
+        next->_input_end = true;
+    }
+
+    // Wake the next processor when there is some data and it is waiting for it.
+    if (count > 0 || input_end) {
+        next->signalWork(false);
+    }
+
+    // Force to abort our processor when the next one is aborting.
+    // Don't do that if current is output and next is input.
+    if (plugin()->type() != OUTPUT_PLUGIN) {
+        aborted = aborted || next->_tsp_aborting;
+    }
+
+    // Wake the previous processor when we abort
+    if (aborted) {
+        _tsp_aborting = true; // volatile bool in TSP superclass
+        ringPrevious<PluginExecutor>()->signalWork(true);
+    }
+
+    // Return false when the current processor shall stop.
+    return !input_end && !aborted;
+}
+
+
+//----------------------------------------------------------------------------
+// Notify the plugin thread that there is something to do.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::signalWork(bool force)
+{
+    if (!_options.lock_free) {
+        // Mutex-based ring, the global mutex is already held by the caller.
+        _to_do.signal();
+    }
+    else if (force || _waiting) {
+        // Lock-free ring: the plugin thread sets _waiting before checking its packet area
+        // under _to_do_mutex. Acquiring that mutex here guarantees that the signal cannot
+        // be lost between the check and the wait.
+        Guard lock(_to_do_mutex);
+        _to_do.signal();
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // This method sets the current processor in an abort state.
 //----------------------------------------------------------------------------
@@ -173,7 +247,7 @@ void ts::tsp::PluginExecutor::setAbort()
 {
     Guard lock(_global_mutex);
     _tsp_aborting = true;
-    ringPrevious<PluginExecutor>()->_to_do.signal();
+    ringPrevious<PluginExecutor>()->signalWork(true);
 }
 
 
@@ -195,6 +269,30 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first, size_t& pkt_cnt, BitRa
 {
     log(10, u"waitWork(...)");
 
+    // The time between two waits is the processing time of the previous window.
+    _telemetry.startWait();
+
+    if (_options.lock_free) {
+        waitWorkLockFree(pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout);
+    }
+    else {
+        waitWorkMutex(pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout);
+    }
+
+    _telemetry.endWait(pkt_cnt);
+
+    log(10, u"waitWork(pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
+        {pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout});
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for packets to process or some error condition.
+// Mutex-based version: everything is accessed under the global mutex.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitWorkMutex(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted, bool &timeout)
+{
     // We access data under the protection of the global mutex.
     GuardCondition lock(_global_mutex, _to_do);
 
@@ -211,7 +309,7 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first, size_t& pkt_cnt, BitRa
     }
 
     pkt_first = _pkt_first;
-    pkt_cnt = timeout ? 0 : std::min(_pkt_cnt, _buffer->count() - _pkt_first);
+    pkt_cnt = timeout ? 0 : std::min(_pkt_cnt.load(), _buffer->count() - _pkt_first);
     bitrate = _bitrate;
     input_end = _input_end && pkt_cnt == _pkt_cnt;
 
@@ -219,9 +317,44 @@ void ts::tsp::PluginExecutor::waitWork(size_t& pkt_first, size_t& pkt_cnt, BitRa
     // Don't do that if current is output and next is input because
     // there is no propagation of packets from output back to input.
     aborted = plugin()->type() != OUTPUT_PLUGIN && next->_tsp_aborting;
+}
 
-    log(10, u"waitWork(pkt_first = %'d, pkt_cnt = %'d, bitrate = %'d, input_end = %s, aborted = %s, timeout = %s)",
-        {pkt_first, pkt_cnt, bitrate, input_end, aborted, timeout});
+
+//----------------------------------------------------------------------------
+// Wait for packets to process or some error condition.
+// Lock-free version: block on _to_do only when the packet area is empty.
+//----------------------------------------------------------------------------
+
+void ts::tsp::PluginExecutor::waitWorkLockFree(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted, bool &timeout)
+{
+    PluginExecutor* next = ringNext<PluginExecutor>();
+    timeout = false;
+
+    while (_pkt_cnt == 0 && !_input_end && !timeout && !next->_tsp_aborting) {
+        bool signaled = true;
+        {
+            // Declare that we are waiting before checking again the packet area.
+            // The previous processor checks _waiting after updating our packet area.
+            GuardCondition lock(_to_do_mutex, _to_do);
+            _waiting = true;
+            if (_pkt_cnt == 0 && !_input_end && !next->_tsp_aborting) {
+                signaled = lock.waitCondition(_tsp_timeout);
+            }
+            _waiting = false;
+        }
+        // The timeout handler is called outside _to_do_mutex since it may use the global mutex.
+        timeout = !signaled && !plugin()->handlePacketTimeout();
+    }
+
+    // Read the end of input before the packet count (reverse order of passPacketsLockFree()).
+    const bool end = _input_end;
+    const size_t available = _pkt_cnt;
+
+    pkt_first = _pkt_first;
+    pkt_cnt = timeout ? 0 : std::min(available, _buffer->count() - _pkt_first);
+    bitrate = _bitrate;
+    input_end = end && pkt_cnt == available;
+    aborted = plugin()->type() != OUTPUT_PLUGIN && next->_tsp_aborting;
 }
 
 
@@ -259,7 +392,7 @@ void ts::tsp::PluginExecutor::restart(const RestartDataPtr& rd)
     // Acquire the global mutex to modify global data.
     // To avoid deadlocks, always acquire the global mutex first, then a RestartData mutex.
     {
-        GuardCondition lock1(_global_mutex, _to_do);
+        Guard lock1(_global_mutex);
 
         // If there was a previous pending restart operation, cancel it.
         if (!_restart_data.isNull()) {
@@ -275,7 +408,7 @@ void ts::tsp::PluginExecutor::restart(const RestartDataPtr& rd)
         _restart = true;
 
         // Signal the plugin thread that there is something to do.
-        lock1.signal();
+        signalWork(true);
     }
 
     // Now wait for the restart operation to complete.
@@ -292,6 +425,11 @@ void ts::tsp::PluginExecutor::restart(const RestartDataPtr& rd)
 
 bool ts::tsp::PluginExecutor::processPendingRestart()
 {
+    // Fast path without the global mutex, this is called on each window of packets.
+    if (!_restart) {
+        return true;
+    }
+
     // Run under the protection of the global mutex.
     // To avoid deadlocks, always acquire the global mutex first, then a RestartData mutex.
     Guard lock1(_global_mutex);
@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tstspJointTermination.h"
+#include "tstspPluginTelemetry.h"
 #include "tsRingNode.h"
 #include "tsTSProcessorArgs.h"
 #include "tsPluginEventHandlerRegistry.h"
@@ -42,6 +43,7 @@
 #include "tsCondition.h"
 #include "tsMutex.h"
 #include "tsThread.h"
+#include <atomic>
 
 namespace ts {
     namespace tsp {
@@ -143,6 +145,19 @@ namespace ts {
             //!
             void restart(Report& report);
 
+            //!
+            //! Get the execution statistics of the plugin.
+            //! The statistics are updated by the plugin thread and can be read from any thread.
+            //! @return A constant reference to the execution statistics.
+            //!
+            const PluginTelemetry& telemetry() const { return _telemetry; }
+
+            //!
+            //! Reset the execution statistics of the plugin.
+            //! Can be called from any thread, the reset is effective at the next window of packets.
+            //!
+            void resetTelemetry() { _telemetry.requestReset(); }
+
             // Implementation of TSP virtual methods.
             virtual size_t pluginCount() const override;
             virtual void signalPluginEvent(uint32_t event_code, Object* plugin_data = nullptr) const override;
@@ -151,6 +166,7 @@ namespace ts {
             PacketBuffer*         _buffer;    //!< Description of shared packet buffer.
             PacketMetadataBuffer* _metadata;  //!< Description of shared packet metadata buffer.
             volatile bool         _suspended; //!< The plugin is suspended / resumed.
+            PluginTelemetry       _telemetry; //!< Execution statistics, updated by the plugin thread only.
 
             //!
             //! Pass processed packets to the next packet processor.
@@ -209,15 +225,19 @@ namespace ts {
             class RestartData;
             typedef SafePtr<RestartData,Mutex> RestartDataPtr;
 
-            // The following private data must be accessed exclusively under the protection of the global mutex.
+            // With the mutex-based ring, the following private data must be accessed exclusively under the
+            // protection of the global mutex. With the lock-free ring, the packet area is published using
+            // atomic operations and _to_do is associated with _to_do_mutex instead of the global mutex.
             // Implementation details: see the file src/docs/developing-plugins.dox
-            Condition      _to_do;         // Notify processor to do something.
-            size_t         _pkt_first;     // Starting index of packets area
-            size_t         _pkt_cnt;       // Size of packets area
-            bool           _input_end;     // No more packet after current ones
-            BitRate        _bitrate;       // Input bitrate (set by previous plugin)
-            bool           _restart;       // Restart the plugni asap using _restart_data
-            RestartDataPtr _restart_data;  // How to restart the plugin
+            Condition             _to_do;         // Notify processor to do something.
+            Mutex                 _to_do_mutex;   // Mutex for _to_do with the lock-free ring (never hold another mutex inside).
+            std::atomic<bool>     _waiting;       // The plugin thread waits on _to_do (lock-free ring only).
+            size_t                _pkt_first;     // Starting index of packets area (modified by plugin thread only)
+            std::atomic<size_t>   _pkt_cnt;       // Size of packets area
+            std::atomic<bool>     _input_end;     // No more packet after current ones
+            std::atomic<BitRate>  _bitrate;       // Input bitrate (set by previous plugin)
+            std::atomic<bool>     _restart;       // Restart the plugin asap using _restart_data
+            RestartDataPtr        _restart_data;  // How to restart the plugin
 
             // Description of a restart operation.
             class RestartData
@@ -237,6 +257,18 @@ namespace ts {
 
             // Restart this plugin.
             void restart(const RestartDataPtr&);
+
+            // Notify the plugin thread that there is something to do.
+            // With the mutex-based ring, the global mutex must be held by the caller.
+            // With the lock-free ring, the condition is signaled only when the plugin thread is waiting, unless force is true.
+            void signalWork(bool force);
+
+            // Implementation of waitWork() for the mutex-based ring.
+            void waitWorkMutex(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted, bool &timeout);
+
+            // Implementation of passPackets() and waitWork() for the lock-free ring.
+            bool passPacketsLockFree(size_t count, BitRate bitrate, bool input_end, bool aborted);
+            void waitWorkLockFree(size_t& pkt_first, size_t& pkt_cnt, BitRate& bitrate, bool& input_end, bool& aborted, bool &timeout);
         };
     }
 }
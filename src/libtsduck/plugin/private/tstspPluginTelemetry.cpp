@@ -0,0 +1,215 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tstspPluginTelemetry.h"
+#include "tsjsonObject.h"
+#include "tsjsonArray.h"
+#include "tsjsonNumber.h"
+TSDUCK_SOURCE;
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::tsp::PluginTelemetry::Histogram::BUCKET_COUNT;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Histogram.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginTelemetry::Histogram::Histogram() :
+    _count(0),
+    _total(0),
+    _max(0),
+    _buckets()
+{
+    clear();
+}
+
+void ts::tsp::PluginTelemetry::Histogram::clear()
+{
+    _count.store(0, std::memory_order_relaxed);
+    _total.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void ts::tsp::PluginTelemetry::Histogram::add(uint64_t value)
+{
+    // Bucket index is the number of significant bits in the value.
+    size_t index = 0;
+    for (uint64_t v = value; v != 0 && index < BUCKET_COUNT - 1; v >>= 1) {
+        index++;
+    }
+    increment(_buckets[index]);
+    increment(_count);
+    increment(_total, value);
+    if (value > _max.load(std::memory_order_relaxed)) {
+        _max.store(value, std::memory_order_relaxed);
+    }
+}
+
+uint64_t ts::tsp::PluginTelemetry::Histogram::average() const
+{
+    const uint64_t cnt = count();
+    return cnt == 0 ? 0 : total() / cnt;
+}
+
+uint64_t ts::tsp::PluginTelemetry::Histogram::percentile(size_t percent) const
+{
+    const uint64_t cnt = count();
+    const uint64_t max = maximum();
+    if (cnt == 0) {
+        return 0;
+    }
+
+    // Nearest-rank method: rank (1-based) of the percentile value.
+    const uint64_t rank = std::max<uint64_t>(1, (cnt * std::min<size_t>(percent, 100) + 99) / 100);
+
+    // Locate the bucket which contains that rank. The counters are not read atomically
+    // with the others. If the buckets do not contain enough values, use the maximum.
+    uint64_t cumul = 0;
+    for (size_t i = 0; i < BUCKET_COUNT - 1; ++i) {
+        cumul += _buckets[i].load(std::memory_order_relaxed);
+        if (cumul >= rank) {
+            return std::min(max, (uint64_t(1) << i) - 1);
+        }
+    }
+    return max;
+}
+
+ts::json::ValuePtr ts::tsp::PluginTelemetry::Histogram::toJSON() const
+{
+    json::Object* obj = new json::Object;
+    json::ValuePtr result(obj);
+    obj->add(u"count", json::ValuePtr(new json::Number(int64_t(count()))));
+    obj->add(u"total", json::ValuePtr(new json::Number(int64_t(total()))));
+    obj->add(u"average", json::ValuePtr(new json::Number(int64_t(average()))));
+    obj->add(u"p50", json::ValuePtr(new json::Number(int64_t(percentile(50)))));
+    obj->add(u"p99", json::ValuePtr(new json::Number(int64_t(percentile(99)))));
+    obj->add(u"max", json::ValuePtr(new json::Number(int64_t(maximum()))));
+
+    // Non-empty buckets, described by their upper bound.
+    json::Array* buckets = new json::Array;
+    obj->add(u"buckets", json::ValuePtr(buckets));
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        const uint64_t cnt = _buckets[i].load(std::memory_order_relaxed);
+        if (cnt > 0) {
+            json::Object* b = new json::Object;
+            b->add(u"up-to", i < BUCKET_COUNT - 1 ? json::ValuePtr(new json::Number(int64_t((uint64_t(1) << i) - 1))) : json::ValuePtr());
+            b->add(u"count", json::ValuePtr(new json::Number(int64_t(cnt))));
+            buckets->set(json::ValuePtr(b));
+        }
+    }
+    return result;
+}
+
+
+//----------------------------------------------------------------------------
+// Plugin telemetry.
+//----------------------------------------------------------------------------
+
+ts::tsp::PluginTelemetry::PluginTelemetry() :
+    _start_wait(),
+    _end_wait(),
+    _started(false),
+    _pending_ns(0),
+    _pending_packets(0),
+    _reset(false),
+    _packets(0),
+    _process_ns(0),
+    _flushes(0),
+    _wait(),
+    _process(),
+    _window()
+{
+}
+
+void ts::tsp::PluginTelemetry::startWait()
+{
+    _start_wait.getSystemTime();
+
+    // Account the processing time since the end of the previous wait.
+    // The time is accumulated until some packets are actually passed to the next plugin.
+    if (_started) {
+        _pending_ns += std::max<NanoSecond>(0, _start_wait - _end_wait);
+    }
+    if (_pending_packets > 0) {
+        increment(_process_ns, uint64_t(_pending_ns));
+        _process.add(uint64_t(_pending_ns) / _pending_packets);
+        _pending_ns = 0;
+        _pending_packets = 0;
+    }
+
+    // Process pending reset from another thread.
+    if (_reset) {
+        _reset = false;
+        _packets.store(0, std::memory_order_relaxed);
+        _process_ns.store(0, std::memory_order_relaxed);
+        _flushes.store(0, std::memory_order_relaxed);
+        _wait.clear();
+        _process.clear();
+        _window.clear();
+    }
+}
+
+void ts::tsp::PluginTelemetry::endWait(size_t pkt_cnt)
+{
+    _end_wait.getSystemTime();
+    _started = true;
+    _wait.add(uint64_t(std::max<NanoSecond>(0, _end_wait - _start_wait)));
+    if (pkt_cnt > 0) {
+        _window.add(pkt_cnt);
+    }
+}
+
+ts::json::ValuePtr ts::tsp::PluginTelemetry::toJSON() const
+{
+    json::Object* obj = new json::Object;
+    json::ValuePtr result(obj);
+    obj->add(u"packets", json::ValuePtr(new json::Number(int64_t(processedPackets()))));
+    obj->add(u"process-ns", json::ValuePtr(new json::Number(int64_t(processNanoSeconds()))));
+    obj->add(u"flushes", json::ValuePtr(new json::Number(int64_t(flushCount()))));
+    obj->add(u"wait-ns", _wait.toJSON());
+    obj->add(u"process-ns-per-packet", _process.toJSON());
+    obj->add(u"window-packets", _window.toJSON());
+    return result;
+}
+
+ts::UString ts::tsp::PluginTelemetry::toText() const
+{
+    const uint64_t packets = processedPackets();
+    return UString::Format(u"packets: %'d, process: %'d ns/pkt (p99 %'d, max %'d), wait: %'d ns (p99 %'d, max %'d), window: %'d pkt (max %'d), flushes: %'d", {
+                           packets,
+                           packets == 0 ? 0 : processNanoSeconds() / packets, _process.percentile(99), _process.maximum(),
+                           _wait.average(), _wait.percentile(99), _wait.maximum(),
+                           _window.average(), _window.maximum(),
+                           flushCount()});
+}
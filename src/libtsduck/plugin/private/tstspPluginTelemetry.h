@@ -0,0 +1,235 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Transport stream processor: Execution statistics of a plugin
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsjsonValue.h"
+#include "tsMonotonic.h"
+#include <atomic>
+
+namespace ts {
+    namespace tsp {
+        //!
+        //! Execution statistics of a tsp plugin executor.
+        //!
+        //! The statistics are updated by the plugin thread only and can be read at any time
+        //! by other threads. All counters are atomic but updated without read-modify-write
+        //! instructions since there is only one writer. A consistent snapshot between
+        //! distinct counters is not guaranteed, this is acceptable for monitoring purpose.
+        //!
+        //! This class is internal to the TSDuck library and cannot be called by applications.
+        //! It is exported for the unitary tests only.
+        //! @ingroup plugin
+        //!
+        class TSDUCKDLL PluginTelemetry
+        {
+            TS_NOCOPY(PluginTelemetry);
+        public:
+            //!
+            //! Constructor.
+            //!
+            PluginTelemetry();
+
+            //!
+            //! Histogram of positive values with power-of-two buckets.
+            //! Bucket 0 counts zero values, bucket N counts values from 2^(N-1) to 2^N-1.
+            //!
+            class TSDUCKDLL Histogram
+            {
+                TS_NOCOPY(Histogram);
+            public:
+                static constexpr size_t BUCKET_COUNT = 48;  //!< Number of buckets, the last one includes all larger values.
+
+                //!
+                //! Constructor.
+                //!
+                Histogram();
+
+                //!
+                //! Add a value in the histogram. Must be called from the writer thread only.
+                //! @param [in] value The value to add.
+                //!
+                void add(uint64_t value);
+
+                //!
+                //! Clear the histogram. Must be called from the writer thread only.
+                //!
+                void clear();
+
+                //!
+                //! Get the number of values in the histogram.
+                //! @return The number of values in the histogram.
+                //!
+                uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+
+                //!
+                //! Get the sum of all values in the histogram.
+                //! @return The sum of all values in the histogram.
+                //!
+                uint64_t total() const { return _total.load(std::memory_order_relaxed); }
+
+                //!
+                //! Get the maximum value in the histogram.
+                //! @return The maximum value in the histogram.
+                //!
+                uint64_t maximum() const { return _max.load(std::memory_order_relaxed); }
+
+                //!
+                //! Get the average value in the histogram.
+                //! @return The average value in the histogram.
+                //!
+                uint64_t average() const;
+
+                //!
+                //! Get an estimate of a percentile of the values in the histogram.
+                //! The nearest-rank value is located in its bucket and the upper bound of that
+                //! bucket is returned. The result is never larger than the maximum value.
+                //! @param [in] percent The percentile, from 0 to 100.
+                //! @return The estimated percentile of the values, zero if the histogram is empty.
+                //!
+                uint64_t percentile(size_t percent) const;
+
+                //!
+                //! Build a JSON description of the histogram.
+                //! Only the non-empty buckets are described.
+                //! @return A JSON object.
+                //!
+                json::ValuePtr toJSON() const;
+
+            private:
+                std::atomic<uint64_t> _count;
+                std::atomic<uint64_t> _total;
+                std::atomic<uint64_t> _max;
+                std::atomic<uint64_t> _buckets[BUCKET_COUNT];
+            };
+
+            //!
+            //! Report the start of a wait for work in the plugin thread.
+            //! The time since the previous end of wait is accounted as processing time
+            //! of the packets which were flushed in the meantime.
+            //!
+            void startWait();
+
+            //!
+            //! Report the end of a wait for work in the plugin thread.
+            //! @param [in] pkt_cnt Size of the returned window of packets.
+            //!
+            void endWait(size_t pkt_cnt);
+
+            //!
+            //! Report a flush of packets to the next plugin in the plugin thread.
+            //! @param [in] count Number of flushed packets.
+            //!
+            void flushed(size_t count)
+            {
+                increment(_flushes);
+                increment(_packets, count);
+                _pending_packets += count;
+            }
+
+            //!
+            //! Request a reset of all statistics.
+            //! Can be called from any thread. The reset is performed by the plugin thread at the next wait.
+            //!
+            void requestReset() { _reset = true; }
+
+            //!
+            //! Get the histogram of wait durations in nanoseconds.
+            //! @return A constant reference to the histogram.
+            //!
+            const Histogram& waitTime() const { return _wait; }
+
+            //!
+            //! Get the histogram of processing durations in nanoseconds per packet, one value per window.
+            //! @return A constant reference to the histogram.
+            //!
+            const Histogram& processTime() const { return _process; }
+
+            //!
+            //! Get the histogram of packet window sizes.
+            //! @return A constant reference to the histogram.
+            //!
+            const Histogram& windowSize() const { return _window; }
+
+            //!
+            //! Get the total number of processed packets.
+            //! @return The total number of processed packets.
+            //!
+            uint64_t processedPackets() const { return _packets.load(std::memory_order_relaxed); }
+
+            //!
+            //! Get the total processing time in nanoseconds.
+            //! @return The total processing time in nanoseconds.
+            //!
+            uint64_t processNanoSeconds() const { return _process_ns.load(std::memory_order_relaxed); }
+
+            //!
+            //! Get the number of flushes to the next plugin.
+            //! @return The number of flushes to the next plugin.
+            //!
+            uint64_t flushCount() const { return _flushes.load(std::memory_order_relaxed); }
+
+            //!
+            //! Build a JSON description of the statistics.
+            //! @return A JSON object.
+            //!
+            json::ValuePtr toJSON() const;
+
+            //!
+            //! Build a one-line text description of the statistics, as displayed by the tspcontrol "stats" command.
+            //! @return A text description of the statistics.
+            //!
+            UString toText() const;
+
+        private:
+            Monotonic             _start_wait;       // Start time of current wait.
+            Monotonic             _end_wait;         // End time of last wait (start of processing).
+            bool                  _started;          // First wait completed, _end_wait is valid.
+            NanoSecond            _pending_ns;       // Processing time which is not yet accounted.
+            size_t                _pending_packets;  // Packets flushed since last accounting.
+            std::atomic<bool>     _reset;        // Reset requested by another thread.
+            std::atomic<uint64_t> _packets;      // Total processed packets.
+            std::atomic<uint64_t> _process_ns;   // Total processing time.
+            std::atomic<uint64_t> _flushes;      // Number of flushes.
+            Histogram             _wait;         // Wait time in nanoseconds.
+            Histogram             _process;      // Processing time in nanoseconds per packet, one value per window.
+            Histogram             _window;       // Window sizes in packets.
+
+            // Update counters from the writer thread.
+            static void increment(std::atomic<uint64_t>& counter, uint64_t value = 1)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+        };
+    }
+}
@@ -30,6 +30,10 @@
 #include "tstspProcessorExecutor.h"
 TSDUCK_SOURCE;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::tsp::ProcessorExecutor::MAX_BATCH_PACKETS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Constructor
@@ -44,11 +48,27 @@ ts::tsp::ProcessorExecutor::ProcessorExecutor(const TSProcessorArgs& options,
 
     PluginExecutor(options, handlers, PROCESSOR_PLUGIN, options.plugins[plugin_index], attributes, global_mutex, report),
     _processor(dynamic_cast<ProcessorPlugin*>(PluginThread::plugin())),
-    _plugin_index(1 + plugin_index) // include first input plugin in the count
+    _plugin_index(1 + plugin_index), // include first input plugin in the count
+    _use_batch(true),
+    _batch_status(MAX_BATCH_PACKETS, ProcessorPlugin::TSP_OK),
+    _batch_null(MAX_BATCH_PACKETS, false),
+    _group(),
+    _group_index(0)
 {
 }
 
 
+//----------------------------------------------------------------------------
+// Declare the plugin as a member of a group of parallel observers.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ProcessorExecutor::setObserverGroup(const ObserverGroupPtr& group, size_t index)
+{
+    _group = group;
+    _group_index = index;
+}
+
+
 //----------------------------------------------------------------------------
 // Implementation of TSP: return the packet index in the chain.
 //----------------------------------------------------------------------------
@@ -67,6 +87,12 @@ void ts::tsp::ProcessorExecutor::main()
 {
     debug(u"packet processing thread started");
 
+    // Plugins in a group of parallel observers use a distinct processing loop.
+    if (!_group.isNull()) {
+        observerMain();
+        return;
+    }
+
     const TSPacketMetadata::LabelSet only_labels(_processor->getOnlyLabelOption());
     PacketCounter passed_packets = 0;
     PacketCounter dropped_packets = 0;
@@ -119,9 +145,19 @@ void ts::tsp::ProcessorExecutor::main()
         // Now process the packets.
         size_t pkt_done = 0;
         size_t pkt_flush = 0;
+        size_t batch_cnt = 0;    // Number of packets in current batch.
+        size_t batch_index = 0;  // Index of next packet in current batch.
 
         while (pkt_done < pkt_cnt && !aborted) {
 
+            // When the previous batch is exhausted, try to process a new batch of packets in one call to the plugin.
+            // The batch does not go beyond the next periodic flush to keep the same flush policy.
+            if (batch_index >= batch_cnt) {
+                const size_t max_flush = _options.max_flush_pkt > 0 ? _options.max_flush_pkt - pkt_flush : pkt_cnt;
+                batch_cnt = processBatch(pkt_first + pkt_done, std::min(pkt_cnt - pkt_done, max_flush), only_labels);
+                batch_index = 0;
+            }
+
             TSPacket* const pkt = _buffer->base() + pkt_first + pkt_done;
             TSPacketMetadata* const pkt_data = _metadata->base() + pkt_first + pkt_done;
 
@@ -134,19 +170,27 @@ void ts::tsp::ProcessorExecutor::main()
             }
             else {
                 // Apply the processing routine to the packet
-                const bool was_null = pkt->getPID() == PID_NULL;
-                pkt_data->setFlush(false);
-                pkt_data->setBitrateChanged(false);
+                bool was_null = pkt->getPID() == PID_NULL;
                 ProcessorPlugin::Status status = ProcessorPlugin::TSP_OK;
-                if (!_suspended && (only_labels.none() || pkt_data->hasAnyLabel(only_labels))) {
-                    // Either no --only-label option or the packet has a specified label => process it.
-                    status = _processor->processPacket(*pkt, *pkt_data);
-                    addPluginPackets(1);
+                if (batch_index < batch_cnt) {
+                    // The packet was already processed in the current batch.
+                    was_null = _batch_null[batch_index];
+                    status = _batch_status[batch_index];
+                    batch_index++;
                 }
                 else {
-                    // The plugin is suspended or some --only-label was specified but the packet does
-                    // not have any required label. Pass the packet without submitting it to the plugin.
-                    addNonPluginPackets(1);
+                    pkt_data->setFlush(false);
+                    pkt_data->setBitrateChanged(false);
+                    if (!_suspended && (only_labels.none() || pkt_data->hasAnyLabel(only_labels))) {
+                        // Either no --only-label option or the packet has a specified label => process it.
+                        status = _processor->processPacket(*pkt, *pkt_data);
+                        addPluginPackets(1);
+                    }
+                    else {
+                        // The plugin is suspended or some --only-label was specified but the packet does
+                        // not have any required label. Pass the packet without submitting it to the plugin.
+                        addNonPluginPackets(1);
+                    }
                 }
 
                 // Use the returned status
@@ -212,3 +256,163 @@ void ts::tsp::ProcessorExecutor::main()
     debug(u"packet processing thread %s after %'d packets, %'d passed, %'d dropped, %'d nullified",
           {input_end ? u"terminated" : u"aborted", pluginPackets(), passed_packets, dropped_packets, nullified_packets});
 }
+
+
+//----------------------------------------------------------------------------
+// Submit a batch of contiguous packets to the plugin.
+//----------------------------------------------------------------------------
+
+size_t ts::tsp::ProcessorExecutor::processBatch(size_t pkt_index, size_t max_count, const TSPacketMetadata::LabelSet& only_labels)
+{
+    // A batch is possible only when all packets are submitted to the plugin.
+    // With joint termination, the termination point is the current packet count when
+    // jointTerminate() is called, which is not updated inside a batch: use packet mode.
+    if (!_use_batch || _suspended || only_labels.any() || useJointTermination()) {
+        return 0;
+    }
+
+    TSPacket* const pkt = _buffer->base() + pkt_index;
+    TSPacketMetadata* const pkt_data = _metadata->base() + pkt_index;
+
+    // Collect contiguous packets which were not dropped by a previous plugin.
+    size_t count = 0;
+    max_count = std::min(max_count, MAX_BATCH_PACKETS);
+    while (count < max_count && pkt[count].b[0] != 0) {
+        _batch_null[count] = pkt[count].getPID() == PID_NULL;
+        _batch_status[count] = ProcessorPlugin::TSP_OK;
+        pkt_data[count].setFlush(false);
+        pkt_data[count].setBitrateChanged(false);
+        count++;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+    else if (!_processor->processPacketBatch(pkt, pkt_data, count, _batch_status.data())) {
+        // The plugin does not support batch processing, never try again.
+        _use_batch = false;
+        return 0;
+    }
+    else {
+        // Count packets up to the first TSP_END, as in packet per packet mode.
+        size_t processed = 0;
+        while (processed < count && _batch_status[processed++] != ProcessorPlugin::TSP_END) {
+        }
+        addPluginPackets(processed);
+        return count;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Processing loop of a plugin in a group of parallel observers.
+//----------------------------------------------------------------------------
+
+void ts::tsp::ProcessorExecutor::observerMain()
+{
+    const TSPacketMetadata::LabelSet only_labels(_processor->getOnlyLabelOption());
+    const bool last = _group_index + 1 >= _group->size();
+    PacketCounter processed = 0;  // Total number of packets in processed windows.
+    bool observing = true;        // The plugin has not yet terminated its processing.
+    bool input_end = false;
+    bool aborted = false;
+
+    debug(u"parallel observer %d in a group of %d", {_group_index + 1, _group->size()});
+
+    do {
+        // Wait for packets to process
+        size_t pkt_first = 0;
+        size_t pkt_cnt = 0;
+        bool timeout = false;
+        waitWork(pkt_first, pkt_cnt, _tsp_bitrate, input_end, aborted, timeout);
+
+        // Process restart requests.
+        if (!processPendingRestart()) {
+            timeout = true;
+        }
+
+        // Same termination conditions as other packet processors.
+        if (timeout) {
+            passPackets(0, _tsp_bitrate, true, true);
+            aborted = true;
+            break;
+        }
+        if (aborted && !input_end) {
+            passPackets(0, _tsp_bitrate, true, true);
+            break;
+        }
+        if (pkt_cnt == 0 && input_end) {
+            passPackets(0, _tsp_bitrate, true, false);
+            break;
+        }
+
+        if (!last) {
+            // Immediately pass the packets to the next observer in the group and process them in parallel.
+            // The packets cannot be overwritten before the last observer of the group passes them.
+            aborted = !passPackets(pkt_cnt, _tsp_bitrate, input_end, false) && !input_end;
+            observing = observePackets(pkt_first, pkt_cnt, processed, only_labels, observing);
+            processed += pkt_cnt;
+            _group->setProgress(_group_index, processed);
+        }
+        else {
+            // Last observer: process the packets, wait for the other observers, then pass the packets.
+            // Perform periodic flush to avoid waiting too long before passing packets to the next processor.
+            size_t pkt_done = 0;
+            while (pkt_done < pkt_cnt && !aborted) {
+                size_t count = _options.max_flush_pkt > 0 ? std::min(pkt_cnt - pkt_done, _options.max_flush_pkt) : pkt_cnt - pkt_done;
+                observing = observePackets(pkt_first + pkt_done, count, processed, only_labels, observing);
+                pkt_done += count;
+                processed += count;
+                _group->waitProgress(processed);
+                const PacketCounter end = _group->endPosition();
+                if (end < processed) {
+                    // One observer requested the end of the stream. Pass the packets before
+                    // the end, signal end of input to successors and abort to predecessors.
+                    count -= size_t(std::min<PacketCounter>(count, processed - end));
+                    input_end = aborted = true;
+                }
+                aborted = !passPackets(count, _tsp_bitrate, input_end && (aborted || pkt_done == pkt_cnt), aborted);
+            }
+        }
+
+    } while (!input_end && !aborted);
+
+    // This observer no longer blocks the other ones.
+    _group->terminate(_group_index);
+
+    // Close the packet processor
+    _processor->stop();
+
+    debug(u"parallel observer thread %s after %'d packets", {input_end ? u"terminated" : u"aborted", pluginPackets()});
+}
+
+
+//----------------------------------------------------------------------------
+// Submit contiguous packets to an observer plugin.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::ProcessorExecutor::observePackets(size_t pkt_index, size_t count, PacketCounter position, const TSPacketMetadata::LabelSet& only_labels, bool observing)
+{
+    TSPacket* const pkt = _buffer->base() + pkt_index;
+    TSPacketMetadata* const pkt_data = _metadata->base() + pkt_index;
+
+    for (size_t i = 0; i < count; ++i) {
+        // Skip packets which were dropped by a previous packet processor, when the plugin is suspended
+        // or when some --only-label was specified but the packet does not have any required label.
+        if (observing && pkt[i].b[0] != 0 && !_suspended && (only_labels.none() || pkt_data[i].hasAnyLabel(only_labels))) {
+            // The packets and metadata are shared by all observers of the group, do not reset the metadata flags.
+            // Only the end of processing is significant in the returned status.
+            const ProcessorPlugin::Status status = _processor->processPacket(pkt[i], pkt_data[i]);
+            addPluginPackets(1);
+            if (status == ProcessorPlugin::TSP_END) {
+                verbose(u"end of processing requested by parallel observer");
+                _group->requestEnd(position + i);
+                observing = false;
+            }
+        }
+        else {
+            addNonPluginPackets(1);
+        }
+    }
+    return observing;
+}
@@ -34,6 +34,7 @@
 
 #pragma once
 #include "tstspPluginExecutor.h"
+#include "tstspObserverGroup.h"
 #include "tsProcessorPlugin.h"
 
 namespace ts {
@@ -63,15 +64,47 @@ namespace ts {
                               Mutex& global_mutex,
                               Report* report);
 
+            //!
+            //! Check if the plugin is declared as a parallel observer (option --observer).
+            //! @return True if the plugin is declared as a parallel observer.
+            //!
+            bool isObserver() const { return _processor != nullptr && _processor->getObserverOption(); }
+
+            //!
+            //! Declare the plugin as a member of a group of parallel observers.
+            //! Must be executed in synchronous environment, before starting all executor threads.
+            //! @param [in] group The group of parallel observers.
+            //! @param [in] index Index of this plugin in the group.
+            //!
+            void setObserverGroup(const ObserverGroupPtr& group, size_t index);
+
             // Overridden methods.
             virtual size_t pluginIndex() const override;
 
         private:
+            static constexpr size_t MAX_BATCH_PACKETS = 512;  // Max number of packets in a batch.
+
             ProcessorPlugin* _processor;
             const size_t     _plugin_index;
+            bool             _use_batch;     // The plugin may support batch processing.
+            std::vector<ProcessorPlugin::Status> _batch_status;  // Statuses of packets in last batch.
+            std::vector<bool> _batch_null;   // Packets in last batch were null packets before processing.
+            ObserverGroupPtr _group;         // Group of parallel observers, if any.
+            size_t           _group_index;   // Index of this plugin in _group.
 
             // Inherited from Thread
             virtual void main() override;
+
+            // Submit a batch of contiguous packets to the plugin, starting at pkt_index.
+            // Return the number of processed packets, zero if no batch processing was possible.
+            size_t processBatch(size_t pkt_index, size_t max_count, const TSPacketMetadata::LabelSet& only_labels);
+
+            // Processing loop of a plugin in a group of parallel observers.
+            void observerMain();
+
+            // Submit contiguous packets to an observer plugin, starting at pkt_index. The packet statuses are ignored.
+            // Position is the number of packets before pkt_index in the group. Return false if the plugin terminated its processing.
+            bool observePackets(size_t pkt_index, size_t count, PacketCounter position, const TSPacketMetadata::LabelSet& only_labels, bool observing);
         };
     }
 }
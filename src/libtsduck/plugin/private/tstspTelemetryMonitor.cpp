@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tstspTelemetryMonitor.h"
+#include "tsjsonObject.h"
+#include "tsjsonArray.h"
+#include "tsjsonNumber.h"
+#include "tsjsonString.h"
+#include "tsjsonTrue.h"
+#include "tsjsonFalse.h"
+#include "tsGuardCondition.h"
+#include "tsTime.h"
+TSDUCK_SOURCE;
+
+// Stack size for the telemetry thread
+#define TELEMETRY_STACK_SIZE (128 * 1024)
+
+
+//----------------------------------------------------------------------------
+// Constructor and destructor.
+//----------------------------------------------------------------------------
+
+ts::tsp::TelemetryMonitor::TelemetryMonitor(const TSProcessorArgs& options, Report& log, PluginExecutor* input) :
+    Thread(ThreadAttributes().setPriority(ThreadAttributes::GetMinimumPriority()).setStackSize(TELEMETRY_STACK_SIZE)),
+    _options(options),
+    _log(log),
+    _input(input),
+    _file(),
+    _mutex(),
+    _wake_up(),
+    _terminate(false),
+    _started(false)
+{
+}
+
+ts::tsp::TelemetryMonitor::~TelemetryMonitor()
+{
+    close();
+}
+
+
+//----------------------------------------------------------------------------
+// Start/stop the periodic reports.
+//----------------------------------------------------------------------------
+
+bool ts::tsp::TelemetryMonitor::open()
+{
+    if (_options.telemetry_interval <= 0 || _input == nullptr) {
+        // No periodic report, do nothing.
+        return true;
+    }
+    else if (_started) {
+        _log.error(u"tsp telemetry already started");
+        return false;
+    }
+
+    if (!_options.telemetry_file.empty()) {
+        _file.open(_options.telemetry_file.toUTF8().c_str(), std::ios::out | std::ios::app);
+        if (!_file) {
+            _log.error(u"error creating %s", {_options.telemetry_file});
+            return false;
+        }
+    }
+
+    _terminate = false;
+    _started = start();
+    return _started;
+}
+
+void ts::tsp::TelemetryMonitor::close()
+{
+    if (_started) {
+        {
+            GuardCondition lock(_mutex, _wake_up);
+            _terminate = true;
+            lock.signal();
+        }
+        waitForTermination();
+        _started = false;
+    }
+    if (_file.is_open()) {
+        _file.close();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Thread main code.
+//----------------------------------------------------------------------------
+
+void ts::tsp::TelemetryMonitor::main()
+{
+    bool terminate = false;
+
+    // Report periodically. A last report is produced at termination.
+    while (!terminate) {
+
+        // Wait until due time or termination request.
+        {
+            GuardCondition lock(_mutex, _wake_up);
+            if (!_terminate) {
+                lock.waitCondition(_options.telemetry_interval);
+            }
+            terminate = _terminate;
+        }
+
+        // Build a report on one line.
+        UString line(BuildReport(_input)->printed(0));
+        line.remove(u'\n');
+
+        if (_file.is_open()) {
+            _file << line << std::endl;
+        }
+        else {
+            _log.info(u"[TELEMETRY] %s", {line});
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Build a JSON report of the execution statistics of all plugins.
+//----------------------------------------------------------------------------
+
+ts::json::ValuePtr ts::tsp::TelemetryMonitor::BuildReport(const PluginExecutor* input)
+{
+    json::Object* root = new json::Object;
+    json::ValuePtr result(root);
+    json::Array* plugins = new json::Array;
+
+    root->add(u"time", json::ValuePtr(new json::String(Time::CurrentLocalTime().format(Time::DATETIME))));
+    root->add(u"plugins", json::ValuePtr(plugins));
+
+    // The plugin chain is not modified while tsp is running, no need to lock the global mutex.
+    const PluginExecutor* proc = input;
+    if (proc != nullptr) {
+        do {
+            json::ValuePtr stats(proc->telemetry().toJSON());
+            stats->add(u"index", json::ValuePtr(new json::Number(int64_t(proc->pluginIndex()))));
+            stats->add(u"name", json::ValuePtr(new json::String(proc->pluginName())));
+            stats->add(u"type", json::ValuePtr(new json::String(PluginTypeNames.name(proc->plugin()->type()))));
+            stats->add(u"suspended", json::ValuePtr(proc->getSuspended() ? static_cast<json::Value*>(new json::True) : static_cast<json::Value*>(new json::False)));
+            plugins->set(stats);
+        } while ((proc = proc->ringNext<PluginExecutor>()) != input);
+    }
+    return result;
+}
@@ -0,0 +1,98 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//!
+//!  @file
+//!  Transport stream processor: Periodic report of plugin execution statistics
+//!
+//----------------------------------------------------------------------------
+
+#pragma once
+#include "tsTSProcessorArgs.h"
+#include "tstspPluginExecutor.h"
+#include "tsThread.h"
+#include "tsMutex.h"
+#include "tsCondition.h"
+
+namespace ts {
+    namespace tsp {
+        //!
+        //! Periodic report of the execution statistics of all plugins in tsp.
+        //! This class is internal to the TSDuck library and cannot be called by applications.
+        //! @ingroup plugin
+        //!
+        class TelemetryMonitor : private Thread
+        {
+            TS_NOBUILD_NOCOPY(TelemetryMonitor);
+        public:
+            //!
+            //! Constructor.
+            //! @param [in] options Command line options for tsp.
+            //! @param [in,out] log Log report.
+            //! @param [in] input Input plugin executor (start of plugin chain).
+            //!
+            TelemetryMonitor(const TSProcessorArgs& options, Report& log, PluginExecutor* input);
+
+            //!
+            //! Destructor.
+            //!
+            virtual ~TelemetryMonitor();
+
+            //!
+            //! Start the periodic reports, if requested in the tsp options.
+            //! @return True on success, false on error.
+            //!
+            bool open();
+
+            //!
+            //! Stop the periodic reports.
+            //!
+            void close();
+
+            //!
+            //! Build a JSON report of the execution statistics of all plugins.
+            //! @param [in] input Input plugin executor (start of plugin chain).
+            //! @return A JSON object.
+            //!
+            static json::ValuePtr BuildReport(const PluginExecutor* input);
+
+        private:
+            const TSProcessorArgs& _options;
+            Report&                _log;
+            PluginExecutor*        _input;
+            std::ofstream          _file;
+            Mutex                  _mutex;
+            Condition              _wake_up;    // accessed under mutex
+            bool                   _terminate;  // accessed under mutex
+            bool                   _started;
+
+            // Implementation of Thread.
+            virtual void main() override;
+        };
+    }
+}
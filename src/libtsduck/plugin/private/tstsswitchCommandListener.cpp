@@ -84,57 +84,28 @@ void ts::tsswitch::CommandListener::main()
 {
     _log.debug(u"UDP server thread started");
 
-    char inbuf[1024];
-    size_t insize = 0;
-    SocketAddress sender;
-    SocketAddress destination;
+    // Several commands can be received at once.
+    static constexpr size_t MAX_MESSAGES = 16;
+    static constexpr size_t MAX_MESSAGE_SIZE = 1024;
+    ByteBlock inbuf(MAX_MESSAGES * MAX_MESSAGE_SIZE);
+    std::vector<UDPSocket::Datagram> msgs(MAX_MESSAGES);
+    size_t count = 0;
 
     // Get receive errors in a buffer since some errors are normal.
     ReportBuffer<NullMutex> error(_log.maxSeverity());
 
     // Loop on incoming messages.
-    while (_sock.receive(inbuf, sizeof(inbuf), insize, sender, destination, nullptr, error)) {
-
-        // Filter out unauthorized remote systems.
-        if (!_opt.allowedRemote.empty() && _opt.allowedRemote.find(sender) == _opt.allowedRemote.end()) {
-            _log.warning(u"rejected remote command from unauthorized host %s", {sender});
-            continue;
-        }
-
-        // We expect ASCII commands. Locate first non-ASCII character in message.
-        size_t len = 0;
-        while (len < insize && inbuf[len] >= 0x20 && inbuf[len] <= 0x7E) {
-            len++;
-        }
-
-        // Extract trimmed lowercase ASCII command.
-        UString cmd(UString::FromUTF8(inbuf, len));
-        cmd.toLower();
-        cmd.trim();
-        _log.verbose(u"received command \"%s\", from %s (%d bytes)", {cmd, sender, insize});
-
-        // Process the command (case insensitive).
-        size_t index = 0;
-        if (cmd.toInteger(index)) {
-            _core.setInput(index);
-        }
-        else if (cmd == u"next") {
-            _core.nextInput();
+    for (;;) {
+        // Each message slot always uses its own area in the input buffer.
+        for (size_t i = 0; i < msgs.size(); ++i) {
+            msgs[i].data = inbuf.data() + i * MAX_MESSAGE_SIZE;
+            msgs[i].max_size = MAX_MESSAGE_SIZE;
         }
-        else if (cmd.startWith(u"prev")) {
-            _core.previousInput();
+        if (!_sock.receiveBatch(msgs.data(), msgs.size(), count, nullptr, error)) {
+            break;
         }
-        else if (cmd == u"quit" || cmd == u"exit") {
-            _core.stop(true);
-        }
-        else if (cmd == u"halt" || cmd == u"abort") {
-            // Extremely rude way of exiting the process.
-            static const char err[] = "\n\n*** Emergency abort requested\n\n";
-            static const size_t err_size = sizeof(err) - 1;
-            FatalError(err, err_size);
-        }
-        else {
-            _log.error(u"received invalid command \"%s\" from remote control at %s", {cmd, sender});
+        for (size_t i = 0; i < count; ++i) {
+            execute(msgs[i]);
         }
     }
 
@@ -144,3 +115,57 @@ void ts::tsswitch::CommandListener::main()
     }
     _log.debug(u"UDP server thread completed");
 }
+
+
+//----------------------------------------------------------------------------
+// Process one received command message.
+//----------------------------------------------------------------------------
+
+void ts::tsswitch::CommandListener::execute(const UDPSocket::Datagram& msg)
+{
+    const char* const inbuf = reinterpret_cast<const char*>(msg.data);
+    const size_t insize = msg.size;
+    const SocketAddress& sender(msg.sender);
+
+    // Filter out unauthorized remote systems.
+    if (!_opt.allowedRemote.empty() && _opt.allowedRemote.find(sender) == _opt.allowedRemote.end()) {
+        _log.warning(u"rejected remote command from unauthorized host %s", {sender});
+        return;
+    }
+
+    // We expect ASCII commands. Locate first non-ASCII character in message.
+    size_t len = 0;
+    while (len < insize && inbuf[len] >= 0x20 && inbuf[len] <= 0x7E) {
+        len++;
+    }
+
+    // Extract trimmed lowercase ASCII command.
+    UString cmd(UString::FromUTF8(inbuf, len));
+    cmd.toLower();
+    cmd.trim();
+    _log.verbose(u"received command \"%s\", from %s (%d bytes)", {cmd, sender, insize});
+
+    // Process the command (case insensitive).
+    size_t index = 0;
+    if (cmd.toInteger(index)) {
+        _core.setInput(index);
+    }
+    else if (cmd == u"next") {
+        _core.nextInput();
+    }
+    else if (cmd.startWith(u"prev")) {
+        _core.previousInput();
+    }
+    else if (cmd == u"quit" || cmd == u"exit") {
+        _core.stop(true);
+    }
+    else if (cmd == u"halt" || cmd == u"abort") {
+        // Extremely rude way of exiting the process.
+        static const char err[] = "\n\n*** Emergency abort requested\n\n";
+        static const size_t err_size = sizeof(err) - 1;
+        FatalError(err, err_size);
+    }
+    else {
+        _log.error(u"received invalid command \"%s\" from remote control at %s", {cmd, sender});
+    }
+}
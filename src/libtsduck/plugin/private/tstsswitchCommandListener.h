@@ -84,6 +84,9 @@ namespace ts {
 
             // Implementation of Thread.
             virtual void main() override;
+
+            // Process one received command message.
+            void execute(const UDPSocket::Datagram& msg);
         };
     }
 }
@@ -37,7 +37,7 @@ TSDUCK_SOURCE;
 // Input constructor
 //----------------------------------------------------------------------------
 
-ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_, size_t buffer_size, const UString& description, const UString& syntax) :
+ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_, size_t buffer_size, const UString& description, const UString& syntax, size_t max_datagrams) :
     InputPlugin(tsp_, description, syntax),
     _eval_time(0),
     _display_time(0),
@@ -51,8 +51,13 @@ ts::AbstractDatagramInputPlugin::AbstractDatagramInputPlugin(TSP* tsp_, size_t b
     _inbuf_count(0),
     _inbuf_next(0),
     _mdata_next(0),
-    _inbuf(std::max(buffer_size, 7 * PKT_SIZE)),
-    _mdata(_inbuf.size() / PKT_SIZE)
+    _dgram_size(std::max(buffer_size, 7 * PKT_SIZE)),
+    _dgram_count(0),
+    _dgram_next(0),
+    _inbuf(_dgram_size * std::max<size_t>(max_datagrams, 1)),
+    _dgram_sizes(std::max<size_t>(max_datagrams, 1)),
+    _dgram_timestamps(_dgram_sizes.size()),
+    _mdata(_dgram_size / PKT_SIZE)
 {
     option(u"display-interval", 'd', POSITIVE);
     help(u"display-interval",
@@ -100,6 +105,7 @@ bool ts::AbstractDatagramInputPlugin::start()
 {
     // Initialize working data.
     _inbuf_count = _inbuf_next = _mdata_next = 0;
+    _dgram_count = _dgram_next = 0;
     _start = _start_0 = _start_1 = _next_display = Time::Epoch;
     _packets = _packets_0 = _packets_1 = 0;
     return true;
@@ -125,6 +131,21 @@ ts::BitRate ts::AbstractDatagramInputPlugin::getBitrate()
 }
 
 
+//----------------------------------------------------------------------------
+// Default implementation of the reception of several datagrams.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDatagramInputPlugin::receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t* ret_sizes, MicroSecond* timestamps, size_t& ret_count)
+{
+    ret_count = 0;
+    if (max_count == 0 || !receiveDatagram(buffer, buffer_size, ret_sizes[0], timestamps[0])) {
+        return false;
+    }
+    ret_count = 1;
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Input method
 //----------------------------------------------------------------------------
@@ -140,22 +161,34 @@ size_t ts::AbstractDatagramInputPlugin::receive(TSPacket* buffer, TSPacketMetada
     // Loop until we get some TS packets.
     while (_inbuf_count == 0) {
 
-        // Wait for a datagram message
-        size_t insize = 0;
-        if (!receiveDatagram(_inbuf.data(), _inbuf.size(), insize, timestamp)) {
-            return 0;
+        // Wait for datagram messages when all previously received ones are processed.
+        if (_dgram_next >= _dgram_count) {
+            _dgram_count = _dgram_next = 0;
+            if (!receiveDatagrams(_inbuf.data(), _dgram_size, _dgram_sizes.size(), _dgram_sizes.data(), _dgram_timestamps.data(), _dgram_count)) {
+                return 0;
+            }
+            continue;
         }
 
+        // Next datagram message to process.
+        const size_t index = _dgram_next++;
+        const uint8_t* const dgram = _inbuf.data() + index * _dgram_size;
+        const size_t insize = _dgram_sizes[index];
+        timestamp = _dgram_timestamps[index];
+
         // Look for TS packets in the UDP message.
-        new_packets = TSPacket::Locate(_inbuf.data(), insize, _inbuf_next, _inbuf_count);
+        new_packets = TSPacket::Locate(dgram, insize, _inbuf_next, _inbuf_count);
 
         if (new_packets) {
 
             // If no timestamp was returned by the kernel for the datagram, look for a RTP header before the first packet.
             // There is no clear proof of the presence of the RTP header. We check if the header size is large enough
             // for an RTP header and if the "RTP payload type" is MPEG-2 TS.
-            const bool use_rtp_timestamp = timestamp < 0 && _inbuf_next >= RTP_HEADER_SIZE && (_inbuf[1] & 0x7F) == RTP_PT_MP2T;
-            const uint32_t rtp_timestamp = use_rtp_timestamp ? GetUInt32(_inbuf.data() + 4) : 0;
+            const bool use_rtp_timestamp = timestamp < 0 && _inbuf_next >= RTP_HEADER_SIZE && (dgram[1] & 0x7F) == RTP_PT_MP2T;
+            const uint32_t rtp_timestamp = use_rtp_timestamp ? GetUInt32(dgram + 4) : 0;
+
+            // Index of first TS packet in the complete input buffer.
+            _inbuf_next += index * _dgram_size;
 
             // Build time stamps in packet metadata.
             _mdata_next = 0;
@@ -56,8 +56,10 @@ namespace ts {
         //! @param [in] description A short one-line description, eg. "Wonderful File Copier".
         //! @param [in] syntax A short one-line syntax summary, eg. "[options] filename ...".
         //! Must be large enough to contain the largest datagram.
+        //! @param [in] max_datagrams Maximum number of datagrams which can be received at once
+        //! using receiveDatagrams(). The input buffer is allocated for that number of datagrams.
         //!
-        AbstractDatagramInputPlugin(TSP* tsp, size_t buffer_size, const UString& description = UString(), const UString& syntax = UString());
+        AbstractDatagramInputPlugin(TSP* tsp, size_t buffer_size, const UString& description = UString(), const UString& syntax = UString(), size_t max_datagrams = 1);
 
         // Implementation of plugin API.
         virtual bool getOptions() override;
@@ -78,6 +80,22 @@ namespace ts {
         //!
         virtual bool receiveDatagram(void* buffer, size_t buffer_size, size_t& ret_size, MicroSecond& timestamp) = 0;
 
+        //!
+        //! Receive several datagram messages at once.
+        //! The default implementation calls receiveDatagram() once. Subclasses which can
+        //! receive several messages in one operation should override this method.
+        //! @param [out] buffer Address of the buffer for the received messages. The message
+        //! at index @e i is stored at offset @e i * @a buffer_size.
+        //! @param [in] buffer_size Size in bytes of the reception buffer of each message.
+        //! @param [in] max_count Maximum number of messages to receive.
+        //! @param [out] ret_sizes Array of @a max_count elements receiving the size in bytes of each message.
+        //! @param [out] timestamps Array of @a max_count elements receiving the timestamp of each
+        //! message in micro-seconds or -1 if not available.
+        //! @param [out] ret_count Number of received messages.
+        //! @return True on success, false on error.
+        //!
+        virtual bool receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t* ret_sizes, MicroSecond* timestamps, size_t& ret_count);
+
     private:
         MilliSecond   _eval_time;          // Bitrate evaluation interval in milli-seconds
         MilliSecond   _display_time;       // Bitrate display interval in milli-seconds
@@ -91,7 +109,12 @@ namespace ts {
         size_t        _inbuf_count;        // Number of remaining TS packets in inbuf
         size_t        _inbuf_next;         // Byte index in _inbuf of next TS packet to return
         size_t        _mdata_next;         // Index in _mdata of next TS packet metadata to return
-        ByteBlock     _inbuf;              // Input buffer
-        TSPacketMetadataVector _mdata;     // Metadata for packets in _inbuf
+        size_t        _dgram_size;         // Buffer size of one datagram in _inbuf
+        size_t        _dgram_count;        // Number of datagrams in _inbuf
+        size_t        _dgram_next;         // Index in _inbuf of next datagram to process
+        ByteBlock     _inbuf;              // Input buffer, for several datagrams
+        std::vector<size_t>      _dgram_sizes;       // Size of each datagram in _inbuf
+        std::vector<MicroSecond> _dgram_timestamps;  // Receive timestamp of each datagram in _inbuf
+        TSPacketMetadataVector   _mdata;             // Metadata for packets in current datagram
     };
 }
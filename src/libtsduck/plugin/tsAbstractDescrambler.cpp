@@ -57,6 +57,11 @@ ts::AbstractDescrambler::AbstractDescrambler(TSP* tsp_, const UString& descripti
     _mutex(),
     _ecm_to_do(),
     _ecm_thread(this),
+    _batch_mode(false),
+    _batch_ecm(),
+    _batch_scrambling(nullptr),
+    _batch(),
+    _batch_error(nullptr),
     _stop_thread(false)
 {
     // We need to define character sets to specify service names.
@@ -520,7 +525,7 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     // If there is a user-specified list of PID's, we don't manage a service
     // and there is nothing else to do.
     if (_pids.any()) {
-        return !_pids.test(pid) || _scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+        return !_pids.test(pid) || descramble(pkt, ECMStreamPtr()) ? TSP_OK : TSP_END;
     }
 
     // Filter sections to locate the service and grab ECM's.
@@ -542,7 +547,7 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
 
     // Without ECM's, we descramble using fixed control words.
     if (!_need_ecm) {
-        return _scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+        return descramble(pkt, ECMStreamPtr()) ? TSP_OK : TSP_END;
     }
 
     // Get PID context. If the PID is not known as a scrambled PID,
@@ -571,7 +576,11 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     // Flags new_cw_even/odd are "write-protected, read-volatile", no mutex needed.
     if ((scv == SC_EVEN_KEY && pecm->new_cw_even) || (scv == SC_ODD_KEY && pecm->new_cw_odd)) {
 
-        // A new CW was deciphered.
+        // A new CW was deciphered. Postponed packets use the previous CW.
+        if (!flushPackets()) {
+            return TSP_END;
+        }
+
         // In asynchronous mode, the CW are accessed under mutex protection.
         if (!_synchronous) {
             _mutex.acquire();
@@ -595,5 +604,67 @@ ts::ProcessorPlugin::Status ts::AbstractDescrambler::processPacket(TSPacket& pkt
     }
 
     // Descramble the packet payload.
-    return pecm->scrambling.decrypt(pkt) ? TSP_OK : TSP_END;
+    return descramble(pkt, pecm) ? TSP_OK : TSP_END;
+}
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDescrambler::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // Consecutive packets using the same descrambler are collected and descrambled
+    // together, which is much faster with DVB-CSA2. They are flushed before any CW change.
+    _batch_mode = true;
+    _batch_error = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        status[i] = processPacket(pkt[i], pkt_data[i]);
+        if (status[i] == TSP_END) {
+            break;
+        }
+    }
+    _batch_mode = false;
+    flushPackets();
+
+    // If some packets could not be descrambled, stop before the first one.
+    if (_batch_error != nullptr) {
+        status[_batch_error - pkt] = TSP_END;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Descramble a packet, or postpone it in batch mode.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractDescrambler::descramble(TSPacket& pkt, const ECMStreamPtr& pecm)
+{
+    TSScrambling& scrambling(pecm.isNull() ? _scrambling : pecm->scrambling);
+    if (!_batch_mode) {
+        return scrambling.decrypt(pkt);
+    }
+    else if (&scrambling != _batch_scrambling && !flushPackets()) {
+        return false;
+    }
+    else {
+        // The ECM stream is referenced to remain valid until the batch is flushed.
+        _batch_scrambling = &scrambling;
+        _batch_ecm = pecm;
+        _batch.push_back(&pkt);
+        return true;
+    }
+}
+
+bool ts::AbstractDescrambler::flushPackets()
+{
+    const bool ok = _batch.empty() || _batch_scrambling->decrypt(_batch.data(), _batch.size());
+    if (!ok && _batch_error == nullptr) {
+        _batch_error = _batch.front();
+    }
+    _batch.clear();
+    _batch_scrambling = nullptr;
+    _batch_ecm.clear();
+    return ok;
 }
@@ -62,6 +62,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     protected:
         //!
@@ -256,6 +257,12 @@ namespace ts {
         // releases the mutex while deciphering the ECM and relocks it before exiting.
         void processECM(ECMStream&);
 
+        // Descramble a packet using the CW of an ECM stream (or fixed CW if null). Postponed in batch mode.
+        bool descramble(TSPacket& pkt, const ECMStreamPtr& pecm);
+
+        // Descramble all postponed packets.
+        bool flushPackets();
+
         // Analyze a list of descriptors from the PMT, looking for ECM PID's
         void analyzeDescriptors(const DescriptorList& dlist, std::set<PID>& ecm_pids, uint8_t& scrambling);
 
@@ -275,6 +282,11 @@ namespace ts {
         Mutex              _mutex;             // Exclusive access to protected areas
         Condition          _ecm_to_do;         // Notify thread to process ECM.
         ECMThread          _ecm_thread;        // Thread which deciphers ECM's.
+        bool               _batch_mode;        // Processing a batch of packets, postpone descrambling.
+        ECMStreamPtr       _batch_ecm;         // ECM stream of postponed packets (null with fixed CW).
+        TSScrambling*      _batch_scrambling;  // Descrambler for postponed packets.
+        std::vector<TSPacket*> _batch;         // Postponed packets to descramble.
+        TSPacket*          _batch_error;       // First packet which failed to be descrambled in batch.
         // -- start of protected area --
         bool               _stop_thread;       // Terminate ECM processing thread
         // -- end of protected area --
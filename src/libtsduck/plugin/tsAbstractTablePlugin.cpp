@@ -58,7 +58,9 @@ ts::AbstractTablePlugin::AbstractTablePlugin(TSP* tsp_,
     _set_version(false),
     _new_version(0),
     _demux(duck, this),
-    _pzer(duck, pid)
+    _pzer(duck, pid),
+    _use_cache(true),
+    _cache()
 {
     option(u"bitrate", 'b', POSITIVE);
     help(u"bitrate",
@@ -130,10 +132,74 @@ void ts::AbstractTablePlugin::setPID(PID pid)
         _demux.addPID(_pid);
         _pzer.reset();
         _pzer.setPID(_pid);
+        _cache.clear();
     }
 }
 
 
+//----------------------------------------------------------------------------
+// Enable or disable the reuse of previous results for unchanged tables.
+//----------------------------------------------------------------------------
+
+void ts::AbstractTablePlugin::useTableCache(bool on)
+{
+    _use_cache = on;
+    if (!on) {
+        _cache.clear();
+    }
+}
+
+ts::AbstractTablePlugin::CachedTable::CachedTable() :
+    input(),
+    output(),
+    is_target(true),
+    reinsert(true)
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Check if two tables have the same content, except the version number.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractTablePlugin::SameContent(const BinaryTable& table1, const BinaryTable& table2)
+{
+    if (table1.sectionCount() != table2.sectionCount()) {
+        return false;
+    }
+    for (size_t si = 0; si < table1.sectionCount(); ++si) {
+        const SectionPtr& sect1(table1.sectionAt(si));
+        const SectionPtr& sect2(table2.sectionAt(si));
+        if (sect1.isNull() || sect2.isNull()) {
+            if (sect1.isNull() != sect2.isNull()) {
+                return false;
+            }
+            continue;
+        }
+        const size_t size = sect1->size();
+        const uint8_t* data1 = sect1->content();
+        const uint8_t* data2 = sect2->content();
+        if (sect2->size() != size) {
+            return false;
+        }
+        else if (!sect1->isLongSection()) {
+            if (::memcmp(data1, data2, size) != 0) {
+                return false;
+            }
+        }
+        else if (size < LONG_SECTION_HEADER_SIZE + SECTION_CRC32_SIZE ||
+                 ::memcmp(data1, data2, 5) != 0 ||
+                 (data1[5] & 0xC1) != (data2[5] & 0xC1) ||
+                 ::memcmp(data1 + 6, data2 + 6, size - 6 - SECTION_CRC32_SIZE) != 0)
+        {
+            // Different content, excluding the version number and the CRC32 which depends on it.
+            return false;
+        }
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Start method
 //----------------------------------------------------------------------------
@@ -149,6 +215,7 @@ bool ts::AbstractTablePlugin::start()
     // Reset other states
     _found_pid = _found_table = false;
     _pkt_create = _pkt_insert = tsp->pluginPackets();
+    _cache.clear();
 
     return true;
 }
@@ -165,13 +232,41 @@ void ts::AbstractTablePlugin::handleTable(SectionDemux& demux, const BinaryTable
         return;
     }
 
-    // Build a modifiable version of the table.
-    BinaryTable table(intable, SHARE);
-
-    // Call subclass to process the table.
+    BinaryTable table;
     bool is_target = true;
     bool reinsert = true;
-    modifyTable(table, is_target, reinsert);
+
+    // Look for a previous version of the same table with the same content.
+    const ETID etid(intable.isShortSection() ? ETID(intable.tableId()) : ETID(intable.tableId(), intable.tableIdExtension()));
+    const auto cached = _use_cache ? _cache.find(etid) : _cache.end();
+
+    if (cached != _cache.end() && SameContent(cached->second.input, intable)) {
+        // Same content, reuse the previous result. If the version of the previous result
+        // was the input one, use the new input version.
+        tsp->debug(u"%s version %d unchanged, reusing previous result", {_table_name, intable.version()});
+        table.copy(cached->second.output);
+        is_target = cached->second.is_target;
+        reinsert = cached->second.reinsert;
+        if (table.version() == cached->second.input.version() && table.version() != intable.version()) {
+            table.patchVersion(intable.version());
+        }
+    }
+    else if (!patchTable(intable, table, is_target, reinsert)) {
+        // The subclass cannot patch the binary table, full processing.
+        table = intable;
+        is_target = reinsert = true;
+        modifyTable(table, is_target, reinsert);
+    }
+
+    // Keep the result for the next versions. The output table is copied because its
+    // sections are modified in place when the version is changed.
+    if (_use_cache) {
+        CachedTable& entry(_cache[etid]);
+        entry.input = intable;
+        entry.output.copy(table);
+        entry.is_target = is_target;
+        entry.reinsert = reinsert;
+    }
 
     // Place modified table in the packetizer.
     if (reinsert) {
@@ -180,12 +275,25 @@ void ts::AbstractTablePlugin::handleTable(SectionDemux& demux, const BinaryTable
 }
 
 
+//----------------------------------------------------------------------------
+// Default implementation of the binary patch of a table: not supported.
+//----------------------------------------------------------------------------
+
+bool ts::AbstractTablePlugin::patchTable(const BinaryTable&, BinaryTable&, bool&, bool&)
+{
+    return false;
+}
+
+
 //----------------------------------------------------------------------------
 // Called by the subclass when some external event forces an update of the table.
 //----------------------------------------------------------------------------
 
 void ts::AbstractTablePlugin::forceTableUpdate(BinaryTable& table)
 {
+    // The results of previous tables are no longer relevant.
+    _cache.clear();
+
     // Common processing of target table.
     reinsertTable(table, true);
 
@@ -210,10 +318,10 @@ void ts::AbstractTablePlugin::reinsertTable(BinaryTable& table, bool is_target_t
 
         // Modify the table version.
         if (_incr_version) {
-            table.setVersion((table.version() + 1) & SVERSION_MASK);
+            table.patchVersion((table.version() + 1) & SVERSION_MASK);
         }
         else if (_set_version) {
-            table.setVersion(_new_version);
+            table.patchVersion(_new_version);
         }
     }
 
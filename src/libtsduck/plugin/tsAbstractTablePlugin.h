@@ -36,6 +36,7 @@
 #include "tsProcessorPlugin.h"
 #include "tsSectionDemux.h"
 #include "tsCyclingPacketizer.h"
+#include "tsETID.h"
 
 namespace ts {
     //!
@@ -97,6 +98,27 @@ namespace ts {
         //!
         virtual void modifyTable(BinaryTable& table, bool& is_target, bool& reinsert) = 0;
 
+        //!
+        //! Try to modify one table from the PID to process directly in binary form.
+        //! This is a fast path for simple modifications which do not change the structure
+        //! of the table, typically fixed-size fields such as identifiers or PID values.
+        //! The sections are patched in place, with an incremental update of their CRC32
+        //! (see BinaryTable::patchTableIdExtension() and Section::patchBytes()). When this
+        //! method returns false, modifyTable() is called to perform a complete decoding.
+        //! The default implementation always returns false.
+        //! @param [in] intable A table from the processed PID. Its sections are shared with
+        //! the demux and must not be modified.
+        //! @param [out] table The modified table. When the subclass patches the table, it
+        //! shall first make a private copy of @a intable using BinaryTable::copy().
+        //! @param [in,out] is_target Indicate that @a intable is the one we are looking for.
+        //! Same as in modifyTable().
+        //! @param [in,out] reinsert Indicate that the modified @a table shall be reinserted in the
+        //! PID. Same as in modifyTable().
+        //! @return True if @a table was built by patching @a intable, false if modifyTable()
+        //! must be used.
+        //!
+        virtual bool patchTable(const BinaryTable& intable, BinaryTable& table, bool& is_target, bool& reinsert);
+
         //!
         //! Create a new empty table when none is found in the PID.
         //! Must be implemented by subclasses.
@@ -112,6 +134,17 @@ namespace ts {
         //!
         void forceTableUpdate(BinaryTable& table);
 
+        //!
+        //! Enable or disable the reuse of previous results for unchanged tables.
+        //! By default, when a new version of a table is received with the same content as
+        //! a previously processed version (except the version number), the previous result
+        //! is reused without calling patchTable() or modifyTable(). A subclass shall disable
+        //! this when the modification of a table depends on something else than its content
+        //! and the command line options.
+        //! @param [in] on True to reuse previous results, false to always process tables.
+        //!
+        void useTableCache(bool on);
+
         //!
         //! Set the error flag to terminate the processing asap.
         //! @param [in] on Error state (true by default).
@@ -144,8 +177,25 @@ namespace ts {
         uint8_t           _new_version;      // New table version.
         SectionDemux      _demux;            // Section demux.
         CyclingPacketizer _pzer;             // Packetizer for modified tables.
+        bool              _use_cache;        // Reuse previous results for unchanged tables.
+
+        // Last processed table for one table id and table id extension.
+        class CachedTable
+        {
+            TS_NOCOPY(CachedTable);
+        public:
+            CachedTable();
+            BinaryTable input;      // Input table, sections shared with the demux.
+            BinaryTable output;     // Result of the processing of the input table, before version options.
+            bool        is_target;  // Result of the processing of the input table.
+            bool        reinsert;   // Result of the processing of the input table.
+        };
+        std::map<ETID, CachedTable> _cache;
 
         // Reinsert a table in the target PID.
         void reinsertTable(BinaryTable& table, bool is_target_table);
+
+        // Check if two tables have the same content, except the version number.
+        static bool SameContent(const BinaryTable& table1, const BinaryTable& table2);
     };
 }
@@ -54,6 +54,7 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
     _start_offset(0),
     _base_label(0),
     _file_format(TSFile::FMT_AUTODETECT),
+    _read_args(),
     _filenames(),
     _eof(),
     _files()
@@ -114,6 +115,9 @@ ts::FileInputPlugin::FileInputPlugin(TSP* tsp_) :
     help(u"repeat",
          u"Repeat the playout of each file the specified number of times (default: only once). "
          u"This option is allowed only if all input files are regular files.");
+
+    // Read mode of input files.
+    _read_args.defineArgs(*this);
 }
 
 
@@ -132,6 +136,7 @@ bool ts::FileInputPlugin::getOptions()
     _first_terminate = present(u"first-terminate");
     _base_label = intValue<size_t>(u"label-base", TSPacketMetadata::LABEL_MAX + 1);
     _file_format = enumValue<TSFile::PacketFormat>(u"format", TSFile::FMT_AUTODETECT);
+    _read_args.loadArgs(duck, *this);
 
     // If there is no file, then this is the standard input, an empty file name.
     if (_filenames.empty()) {
@@ -172,6 +177,7 @@ bool ts::FileInputPlugin::openFile(size_t name_index, size_t file_index)
     }
 
     // Actually open the file.
+    _read_args.apply(_files[file_index]);
     return _files[file_index].openRead(name, _repeat_count, _start_offset, *tsp, _file_format);
 }
 
@@ -35,6 +35,7 @@
 #pragma once
 #include "tsInputPlugin.h"
 #include "tsTSFile.h"
+#include "tsTSFileReadArgs.h"
 
 namespace ts {
     //!
@@ -75,6 +76,7 @@ namespace ts {
         uint64_t       _start_offset;
         size_t         _base_label;
         TSFile::PacketFormat _file_format;
+        TSFileReadArgs       _read_args;    // Read mode of input files.
         UStringVector        _filenames;
         std::set<size_t>     _eof;          // Set of file indexes having reached end of file.
         std::vector<TSFile>  _files;        // Array of open files, only one without interleave.
@@ -47,13 +47,17 @@ ts::ForkInputPlugin::ForkInputPlugin(TSP* tsp_) :
     _nowait(false),
     _format(TSForkPipe::FMT_AUTODETECT),
     _buffer_size(0),
-    _pipe()
+    _use_ring(false),
+    _pipe(),
+    _ring()
 {
     option(u"", 0, STRING, 1, 1);
     help(u"", u"Specifies the command line to execute in the created process.");
 
     option(u"buffered-packets", 'b', POSITIVE);
-    help(u"buffered-packets", u"Windows only: Specifies the pipe buffer size in number of TS packets.");
+    help(u"buffered-packets",
+         u"Windows only: Specifies the pipe buffer size in number of TS packets. "
+         u"With --shared-memory, specifies the size of the shared memory ring in number of TS packets.");
 
     option(u"format", 0, TSForkPipe::FormatEnum);
     help(u"format", u"name",
@@ -63,6 +67,15 @@ ts::ForkInputPlugin::ForkInputPlugin(TSP* tsp_) :
          u"(for instance when the first time-stamp of an M2TS file starts with 0x47). "
          u"Using this option forces a specific format.");
 
+    option(u"shared-memory", 's');
+    help(u"shared-memory",
+         u"Receive the TS packets through a shared memory ring instead of the standard output of the created process. "
+         u"The command shall be a tsp command using the output plugin shm (-O shm), "
+         u"the name of the ring is passed in the environment variable " + UString(TSPacketSharedRing::ENVIRONMENT_VARIABLE) + u". "
+         u"The packets are not copied through the kernel. "
+         u"The option --format is ignored. "
+         u"Not supported on Windows.");
+
     option(u"nowait", 'n');
     help(u"nowait", u"Do not wait for child process termination at end of its output.");
 }
@@ -79,12 +92,28 @@ bool ts::ForkInputPlugin::getOptions()
     _nowait = present(u"nowait");
     _format = enumValue<TSForkPipe::PacketFormat>(u"format", TSForkPipe::FMT_AUTODETECT);
     _buffer_size = intValue<size_t>(u"buffered-packets", 0);
+    _use_ring = present(u"shared-memory");
     return true;
 }
 
 
 bool ts::ForkInputPlugin::start()
 {
+    // With a shared memory ring, the process uses no pipe, its output is the ring.
+    if (_use_ring) {
+        if (!_ring.create(TSPacketSharedRing::CONSUMER, _buffer_size > 0 ? _buffer_size : TSPacketSharedRing::DEFAULT_SIZE, *tsp)) {
+            return false;
+        }
+        _pipe.setEnvironment(TSPacketSharedRing::ENVIRONMENT_VARIABLE, _ring.name());
+        if (!_pipe.open(_command, _nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS, 0, *tsp, ForkPipe::KEEP_BOTH, ForkPipe::STDIN_NONE)) {
+            _ring.close(*tsp);
+            return false;
+        }
+        // Detect a process which terminates before using the ring.
+        _ring.setPeerProcess(_pipe.processId());
+        return true;
+    }
+
     // Create pipe & process.
     return _pipe.open(_command,
                       _nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS,
@@ -97,16 +126,24 @@ bool ts::ForkInputPlugin::start()
 
 bool ts::ForkInputPlugin::stop()
 {
+    // Closing the ring first makes the created process stop writing.
+    _ring.close(*tsp);
     return _pipe.close(*tsp);
 }
 
 bool ts::ForkInputPlugin::abortInput()
 {
+    _ring.abort();
     _pipe.abortPipeReadWrite();
     return true;
 }
 
 size_t ts::ForkInputPlugin::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
 {
-    return _pipe.readPackets(buffer, pkt_data, max_packets, *tsp);
+    if (_use_ring) {
+        return _ring.read(buffer, pkt_data, max_packets, tsp);
+    }
+    else {
+        return _pipe.readPackets(buffer, pkt_data, max_packets, *tsp);
+    }
 }
@@ -47,19 +47,32 @@ ts::ForkOutputPlugin::ForkOutputPlugin(TSP* tsp_) :
     _nowait(false),
     _format(TSForkPipe::FMT_TS),
     _buffer_size(0),
-    _pipe()
+    _use_ring(false),
+    _pipe(),
+    _ring()
 {
     option(u"", 0, STRING, 1, 1);
     help(u"", u"Specifies the command line to execute in the created process.");
 
     option(u"buffered-packets", 'b', POSITIVE);
-    help(u"buffered-packets", u"Windows only: Specifies the pipe buffer size in number of TS packets.");
+    help(u"buffered-packets",
+         u"Windows only: Specifies the pipe buffer size in number of TS packets. "
+         u"With --shared-memory, specifies the size of the shared memory ring in number of TS packets.");
 
     option(u"format", 0, TSForkPipe::FormatEnum);
     help(u"format", u"name",
          u"Specify the format of the output TS stream. "
          u"By default, the format is a standard TS.");
 
+    option(u"shared-memory", 's');
+    help(u"shared-memory",
+         u"Send the TS packets through a shared memory ring instead of the standard input of the created process. "
+         u"The command shall be a tsp command using the input plugin shm (-I shm), "
+         u"the name of the ring is passed in the environment variable " + UString(TSPacketSharedRing::ENVIRONMENT_VARIABLE) + u". "
+         u"The packets are not copied through the kernel. "
+         u"The option --format is ignored. "
+         u"Not supported on Windows.");
+
     option(u"nowait", 'n');
     help(u"nowait", u"Do not wait for child process termination at end of input.");
 }
@@ -75,12 +88,28 @@ bool ts::ForkOutputPlugin::getOptions()
     _nowait = present(u"nowait");
     _format = enumValue<TSForkPipe::PacketFormat>(u"format", TSForkPipe::FMT_TS);
     _buffer_size = intValue<size_t>(u"buffered-packets", 0);
+    _use_ring = present(u"shared-memory");
     return true;
 }
 
 
 bool ts::ForkOutputPlugin::start()
 {
+    // With a shared memory ring, the process uses no pipe, its input is the ring.
+    if (_use_ring) {
+        if (!_ring.create(TSPacketSharedRing::PRODUCER, _buffer_size > 0 ? _buffer_size : TSPacketSharedRing::DEFAULT_SIZE, *tsp)) {
+            return false;
+        }
+        _pipe.setEnvironment(TSPacketSharedRing::ENVIRONMENT_VARIABLE, _ring.name());
+        if (!_pipe.open(_command, _nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS, 0, *tsp, ForkPipe::KEEP_BOTH, ForkPipe::STDIN_NONE)) {
+            _ring.close(*tsp);
+            return false;
+        }
+        // Detect a process which terminates before using the ring.
+        _ring.setPeerProcess(_pipe.processId());
+        return true;
+    }
+
     // Create pipe & process.
     return _pipe.open(_command,
                       _nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS,
@@ -93,10 +122,23 @@ bool ts::ForkOutputPlugin::start()
 
 bool ts::ForkOutputPlugin::stop()
 {
-    return _pipe.close(*tsp);
+    // Report the end of stream in the ring and let the created process read the last packets.
+    _ring.setEOF();
+    const bool ok = _pipe.close(*tsp);
+    _ring.close(*tsp);
+    return ok;
 }
 
 bool ts::ForkOutputPlugin::send(const TSPacket* buffer, const TSPacketMetadata* pkt_data, size_t packet_count)
 {
-    return _pipe.writePackets(buffer, pkt_data, packet_count, *tsp);
+    if (!_use_ring) {
+        return _pipe.writePackets(buffer, pkt_data, packet_count, *tsp);
+    }
+    else if (_ring.write(buffer, pkt_data, packet_count, tsp)) {
+        return true;
+    }
+    else if (_ring.stopped()) {
+        tsp->error(u"created process no longer reads the shared memory ring");
+    }
+    return false;
 }
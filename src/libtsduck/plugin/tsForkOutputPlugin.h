@@ -36,6 +36,7 @@
 #pragma once
 #include "tsOutputPlugin.h"
 #include "tsTSForkPipe.h"
+#include "tsTSPacketSharedRing.h"
 
 namespace ts {
     //!
@@ -69,6 +70,8 @@ namespace ts {
         bool                     _nowait;       // Don't wait for children termination.
         TSForkPipe::PacketFormat _format;       // Packet format on the pipe
         size_t                   _buffer_size;  // Pipe buffer size in packets.
+        bool                     _use_ring;     // Use a shared memory ring instead of the pipe.
         TSForkPipe               _pipe;         // The pipe device.
+        TSPacketSharedRing       _ring;         // The shared memory ring.
     };
 }
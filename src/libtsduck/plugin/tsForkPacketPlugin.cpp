@@ -50,7 +50,9 @@ ts::ForkPacketPlugin::ForkPacketPlugin(TSP* tsp_) :
     _buffer_count(0),
     _buffer(),
     _mdata(),
-    _pipe()
+    _use_ring(false),
+    _pipe(),
+    _ring()
 {
     option(u"", 0, STRING, 1, 1);
     help(u"", u"Specifies the command line to execute in the created process.");
@@ -60,7 +62,8 @@ ts::ForkPacketPlugin::ForkPacketPlugin(TSP* tsp_) :
          u"Specifies the number of TS packets to buffer before sending them through "
          u"the pipe to the forked process. When set to zero, the packets are not "
          u"buffered and sent one by one. The default is 500 packets in real-time mode "
-         u"and 1000 packets in offline mode.");
+         u"and 1000 packets in offline mode. "
+         u"With --shared-memory, specifies the size of the shared memory ring in number of TS packets.");
 
     option(u"format", 0, TSForkPipe::FormatEnum);
     help(u"format", u"name",
@@ -72,6 +75,15 @@ ts::ForkPacketPlugin::ForkPacketPlugin(TSP* tsp_) :
          u"Ignore early termination of child process. By default, if the child "
          u"process aborts and no longer reads the packets, tsp also aborts.");
 
+    option(u"shared-memory", 's');
+    help(u"shared-memory",
+         u"Send the TS packets through a shared memory ring instead of the standard input of the created process. "
+         u"The command shall be a tsp command using the input plugin shm (-I shm), "
+         u"the name of the ring is passed in the environment variable " + UString(TSPacketSharedRing::ENVIRONMENT_VARIABLE) + u". "
+         u"The packets are not copied through the kernel. "
+         u"The option --format is ignored. "
+         u"Not supported on Windows.");
+
     option(u"nowait", 'n');
     help(u"nowait", u"Do not wait for child process termination at end of input.");
 }
@@ -89,10 +101,17 @@ bool ts::ForkPacketPlugin::getOptions()
     _nowait = present(u"nowait");
     _format = enumValue<TSForkPipe::PacketFormat>(u"format", TSForkPipe::FMT_TS);
     _buffer_size = intValue<size_t>(u"buffered-packets", tsp->realtime() ? 500 : 1000);
+    _use_ring = present(u"shared-memory");
     _pipe.setIgnoreAbort(present(u"ignore-abort"));
 
+    // With a shared memory ring, the packets are directly written in the ring.
+    if (_use_ring) {
+        _buffer_size = intValue<size_t>(u"buffered-packets", TSPacketSharedRing::DEFAULT_SIZE);
+    }
+
     // If packet buffering is requested, allocate the buffer
-    _buffer.resize(_buffer_size);
+    _buffer.resize(_use_ring ? 0 : _buffer_size);
+    _mdata.resize(_buffer.size());
 
     return true;
 }
@@ -103,6 +122,21 @@ bool ts::ForkPacketPlugin::start()
     // Reset buffer usage.
     _buffer_count = 0;
 
+    // With a shared memory ring, the process uses no pipe, its input is the ring.
+    if (_use_ring) {
+        if (!_ring.create(TSPacketSharedRing::PRODUCER, _buffer_size, *tsp)) {
+            return false;
+        }
+        _pipe.setEnvironment(TSPacketSharedRing::ENVIRONMENT_VARIABLE, _ring.name());
+        if (!_pipe.open(_command, _nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS, 0, *tsp, ForkPipe::KEEP_BOTH, ForkPipe::STDIN_NONE)) {
+            _ring.close(*tsp);
+            return false;
+        }
+        // Detect a process which terminates before using the ring.
+        _ring.setPeerProcess(_pipe.processId());
+        return true;
+    }
+
     // Create pipe & process.
     return _pipe.open(_command,
                       _nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS,
@@ -121,13 +155,29 @@ bool ts::ForkPacketPlugin::stop()
         _pipe.writePackets(_buffer.data(), _mdata.data(), _buffer_count, *tsp);
     }
 
+    // Report the end of stream in the ring and let the created process read the last packets.
+    _ring.setEOF();
+
     // Close the pipe
-    return _pipe.close(*tsp);
+    const bool ok = _pipe.close(*tsp);
+    _ring.close(*tsp);
+    return ok;
 }
 
 
 ts::ProcessorPlugin::Status ts::ForkPacketPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
+    // With a shared memory ring, write the packet directly in the ring.
+    if (_use_ring) {
+        if (_ring.write(&pkt, &pkt_data, 1, tsp) || (_ring.stopped() && _pipe.getIgnoreAbort())) {
+            return TSP_OK;
+        }
+        if (_ring.stopped()) {
+            tsp->error(u"created process no longer reads the shared memory ring");
+        }
+        return TSP_END;
+    }
+
     // If packets are sent one by one, just send it.
     if (_buffer_size == 0) {
         return _pipe.writePackets(&pkt, &pkt_data, 1, *tsp) ? TSP_OK : TSP_END;
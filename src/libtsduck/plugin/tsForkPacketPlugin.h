@@ -36,6 +36,7 @@
 #pragma once
 #include "tsProcessorPlugin.h"
 #include "tsTSForkPipe.h"
+#include "tsTSPacketSharedRing.h"
 
 namespace ts {
     //!
@@ -72,6 +73,8 @@ namespace ts {
         size_t                   _buffer_count;  // Number of packets currently in buffer.
         TSPacketVector           _buffer;        // Packet buffer.
         TSPacketMetadataVector   _mdata;         // Metadata for packets in buffer.
+        bool                     _use_ring;      // Use a shared memory ring instead of the pipe.
         TSForkPipe               _pipe;          // The pipe device.
+        TSPacketSharedRing       _ring;          // The shared memory ring.
     };
 }
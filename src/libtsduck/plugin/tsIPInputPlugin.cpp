@@ -38,14 +38,19 @@ TS_REGISTER_INPUT_PLUGIN(u"ip", ts::IPInputPlugin);
 // A dummy storage value to force inclusion of this module when using the static library.
 const int ts::IPInputPlugin::REFERENCE = 0;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::IPInputPlugin::MAX_DATAGRAMS;
+#endif
+
 
 //----------------------------------------------------------------------------
 // Input constructor
 //----------------------------------------------------------------------------
 
 ts::IPInputPlugin::IPInputPlugin(TSP* tsp_) :
-    AbstractDatagramInputPlugin(tsp_, IP_MAX_PACKET_SIZE, u"Receive TS packets from UDP/IP, multicast or unicast", u"[options] [address:]port"),
-    _sock(*tsp_)
+    AbstractDatagramInputPlugin(tsp_, IP_MAX_PACKET_SIZE, u"Receive TS packets from UDP/IP, multicast or unicast", u"[options] [address:]port", MAX_DATAGRAMS),
+    _sock(*tsp_),
+    _msgs(MAX_DATAGRAMS)
 {
     // Add UDP receiver common options.
     _sock.defineArgs(*this);
@@ -119,3 +124,26 @@ bool ts::IPInputPlugin::receiveDatagram(void* buffer, size_t buffer_size, size_t
     SocketAddress destination;
     return _sock.receive(buffer, buffer_size, ret_size, sender, destination, tsp, *tsp, &timestamp);
 }
+
+
+//----------------------------------------------------------------------------
+// Reception of several datagrams in one system call when possible.
+//----------------------------------------------------------------------------
+
+bool ts::IPInputPlugin::receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t* ret_sizes, MicroSecond* timestamps, size_t& ret_count)
+{
+    max_count = std::min(max_count, _msgs.size());
+    for (size_t i = 0; i < max_count; ++i) {
+        _msgs[i].data = buffer + i * buffer_size;
+        _msgs[i].max_size = buffer_size;
+    }
+    if (!_sock.receiveBatch(_msgs.data(), max_count, ret_count, tsp, *tsp)) {
+        ret_count = 0;
+        return false;
+    }
+    for (size_t i = 0; i < ret_count; ++i) {
+        ret_sizes[i] = _msgs[i].size;
+        timestamps[i] = _msgs[i].timestamp;
+    }
+    return true;
+}
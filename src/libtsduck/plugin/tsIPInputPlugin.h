@@ -66,8 +66,12 @@ namespace ts {
     protected:
         // Implementation of AbstractDatagramInputPlugin.
         virtual bool receiveDatagram(void* buffer, size_t buffer_size, size_t& ret_size, MicroSecond& timestamp) override;
+        virtual bool receiveDatagrams(uint8_t* buffer, size_t buffer_size, size_t max_count, size_t* ret_sizes, MicroSecond* timestamps, size_t& ret_count) override;
 
     private:
-        UDPReceiver _sock; // Incoming socket with associated command line options.
+        static constexpr size_t MAX_DATAGRAMS = 16;  // Max number of datagrams per receive operation.
+
+        UDPReceiver _sock;  // Incoming socket with associated command line options.
+        std::vector<UDPSocket::Datagram> _msgs;  // Descriptions of datagrams in batch receive.
     };
 }
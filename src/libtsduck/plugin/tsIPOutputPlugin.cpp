@@ -37,11 +37,21 @@ TS_REGISTER_OUTPUT_PLUGIN(u"ip", ts::IPOutputPlugin);
 // A dummy storage value to force inclusion of this module when using the static library.
 const int ts::IPOutputPlugin::REFERENCE = 0;
 
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t ts::IPOutputPlugin::MAX_BATCH;
+#endif
+
 // Grouping TS packets in UDP packets
 
 #define DEF_PACKET_BURST    7  // 1316 B, fits (with headers) in Ethernet MTU
 #define MAX_PACKET_BURST  128  // ~ 48 kB
 
+// With pacing, resynchronize when the output is late by more than this.
+#define MAX_PACING_LATE  (100 * NanoSecPerMilliSec)
+
+// With PCR pacing, resynchronize on PCR gaps larger than this (in PCR units).
+#define MAX_PACING_PCR_GAP  SYSTEM_CLOCK_FREQ
+
 
 //----------------------------------------------------------------------------
 // Output constructor
@@ -56,6 +66,7 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
     _tos(-1),
     _pkt_burst(DEF_PACKET_BURST),
     _enforce_burst(false),
+    _pacing(PACING_NONE),
     _use_rtp(false),
     _rtp_pt(RTP_PT_MP2T),
     _rtp_fixed_sequence(false),
@@ -73,7 +84,13 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
     _pkt_count(0),
     _sock(false, *tsp_),
     _out_count(0),
-    _out_buffer()
+    _out_buffer(),
+    _batch_count(0),
+    _batch(MAX_BATCH),
+    _rtp_headers(MAX_BATCH * RTP_HEADER_SIZE),
+    _pace_started(false),
+    _pace_time(),
+    _pace_pcr(0)
 {
     option(u"", 0, STRING, 1, 1);
     help(u"",
@@ -103,6 +120,18 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
          u"Specifies the maximum number of TS packets per UDP packet. "
          u"The default is " TS_STRINGIFY(DEF_PACKET_BURST) u", the maximum is " TS_STRINGIFY(MAX_PACKET_BURST) u".");
 
+    option(u"pacing", 0, Enumeration({
+        {u"bitrate", PACING_BITRATE},
+        {u"pcr",     PACING_PCR},
+    }), 0, 1, true);
+    help(u"pacing",
+         u"Space the output datagrams evenly in time instead of sending them in bursts. "
+         u"Without pacing, all datagrams from one output buffer of tsp are sent at once, "
+         u"which creates microbursts that some receivers cannot handle. "
+         u"With --pacing bitrate (the default mode), the datagrams are spaced according to the TS bitrate. "
+         u"With --pacing pcr, the datagrams are spaced according to the PCR's "
+         u"of the reference PID (see option --pcr-pid).");
+
     option(u"tos", 's', INTEGER, 0, 1, 1, 255);
     help(u"tos",
          u"Specifies the TOS (Type-Of-Service) socket option. Setting this value "
@@ -127,7 +156,7 @@ ts::IPOutputPlugin::IPOutputPlugin(TSP* tsp_) :
 
     option(u"pcr-pid", 0, PIDVAL);
     help(u"pcr-pid",
-        u"With --rtp, specify the PID containing the PCR's which are used as reference for RTP timestamps. "
+        u"With --rtp or --pacing pcr, specify the PID containing the PCR's which are used as reference for RTP timestamps and pacing. "
         u"By default, use the first PID containing PCR's.");
 
     option(u"start-sequence-number", 0, UINT16);
@@ -166,6 +195,7 @@ bool ts::IPOutputPlugin::getOptions()
     _tos = intValue<int>(u"tos", -1);
     _pkt_burst = intValue<size_t>(u"packet-burst", DEF_PACKET_BURST);
     _enforce_burst = present(u"enforce-burst");
+    _pacing = present(u"pacing") ? intValue<int>(u"pacing", PACING_BITRATE) : int(PACING_NONE);
     _use_rtp = present(u"rtp");
     _rtp_pt = intValue<uint8_t>(u"payload-type", RTP_PT_MP2T);
     _rtp_fixed_sequence = present(u"start-sequence-number");
@@ -233,6 +263,9 @@ bool ts::IPOutputPlugin::start()
     _last_rtp_pcr_pkt = 0;
     _rtp_pcr_offset = 0;
     _pkt_count = 0;
+    _batch_count = 0;
+    _pace_started = false;
+    _pace_pcr = 0;
 
     return true;
 }
@@ -291,6 +324,11 @@ bool ts::IPOutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pkt_d
         packet_count -= count;
     }
 
+    // Send all queued datagrams before returning since they point into the caller's buffer.
+    if (!flushDatagrams()) {
+        return false;
+    }
+
     // If remaining packets are present, save them in output buffer.
     if (packet_count > 0) {
         assert(_enforce_burst);
@@ -304,110 +342,182 @@ bool ts::IPOutputPlugin::send(const TSPacket* pkt, const TSPacketMetadata* pkt_d
 
 
 //----------------------------------------------------------------------------
-// Send contiguous packets in one single datagram.
+// Queue contiguous packets as one datagram in the current batch.
 //----------------------------------------------------------------------------
 
 bool ts::IPOutputPlugin::sendDatagram(const TSPacket* pkt, size_t packet_count)
 {
-    bool status = true;
+    // Send the current batch when full.
+    if (_batch_count >= _batch.size() && !flushDatagrams()) {
+        return false;
+    }
 
+    // Get current bitrate to compute timestamps and pacing.
+    const BitRate bitrate = tsp->bitrate();
+
+    // The timestamp of the datagram is required for RTP and PCR pacing.
+    const uint64_t timestamp = _use_rtp || _pacing == PACING_PCR ? computeTimestamp(pkt, packet_count, bitrate) : 0;
+
+    // With pacing, wait until it is time to send this datagram.
+    if (_pacing != PACING_NONE && !paceDatagram(packet_count, timestamp, bitrate)) {
+        return false;
+    }
+
+    UDPSocket::OutputDatagram& dgram(_batch[_batch_count]);
     if (_use_rtp) {
-        // RTP datagram are relatively trivial to build, except the time stamp.
-        // We cannot use the wall clock time because the plugin is likely to burst its output.
-        // So, we try to synchronize RTP timestamps with PCR's from one PID.
-        // But this is not trivial since the PCR may not be accurate or may loop back.
-        // As long as the first PCR is not seen, increment timestamps from zero, using TS bitrate as reference.
-        // At the first PCR, compute the difference between the current RTP timestamp and this PCR.
-        // Then keep this difference and resynchronize at each PCR.
-        // But never jump back in RTP timestamps, only increase "more slowly" when adjusting.
-
-        // Build an RTP datagram. Use a simple RTP header without options nor extensions.
-        ByteBlock buffer(RTP_HEADER_SIZE + packet_count * PKT_SIZE);
-
-        // Build the RTP header, except the timestamp.
-        buffer[0] = 0x80;             // Version = 2, P = 0, X = 0, CC = 0
-        buffer[1] = _rtp_pt & 0x7F;   // M = 0, payload type
-        PutUInt16(&buffer[2], _rtp_sequence++);
-        PutUInt32(&buffer[8], _rtp_ssrc);
-
-        // Get current bitrate to compute timestamps.
-        const BitRate bitrate = tsp->bitrate();
-
-        // Look for a PCR in one of the packets to send.
-        // If found, we adjust this PCR for the first packet in the datagram.
-        uint64_t pcr = INVALID_PCR;
-        for (size_t i = 0; i < packet_count; i++) {
-            const bool hasPCR = pkt[i].hasPCR();
-            const PID pid = pkt[i].getPID();
-
-            // Detect PCR PID if not yet known.
-            if (hasPCR && _pcr_pid == PID_NULL) {
-                _pcr_pid = pid;
-            }
+        // Build an RTP header in the preallocated area. Use a simple RTP header without options nor extensions.
+        uint8_t* const header = &_rtp_headers[_batch_count * RTP_HEADER_SIZE];
+        header[0] = 0x80;             // Version = 2, P = 0, X = 0, CC = 0
+        header[1] = _rtp_pt & 0x7F;   // M = 0, payload type
+        PutUInt16(header + 2, _rtp_sequence++);
+        PutUInt32(header + 4, uint32_t((timestamp * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ));
+        PutUInt32(header + 8, _rtp_ssrc);
+        dgram = UDPSocket::OutputDatagram(pkt, packet_count * PKT_SIZE, header, RTP_HEADER_SIZE);
+    }
+    else {
+        // No RTP, send TS packets directly as datagram.
+        dgram = UDPSocket::OutputDatagram(pkt, packet_count * PKT_SIZE);
+    }
+    _batch_count++;
 
-            // Detect PCR presence.
-            if (hasPCR && pid == _pcr_pid) {
-                pcr = pkt[i].getPCR();
-                // If the bitrate is known and the packet containing the PCR is not the first one,
-                // compute the theoretical timestamp of the first packet in the datagram.
-                if (i > 0 && bitrate > 0) {
-                    pcr -= (i * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
-                }
-                break;
-            }
+    // Count packets datagram per datagram.
+    _pkt_count += packet_count;
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Send all queued datagrams.
+//----------------------------------------------------------------------------
+
+bool ts::IPOutputPlugin::flushDatagrams()
+{
+    const bool status = _sock.sendBatch(_batch.data(), _batch_count, *tsp);
+    _batch_count = 0;
+    return status;
+}
+
+
+//----------------------------------------------------------------------------
+// Wait until it is time to send the next datagram in pacing mode.
+//----------------------------------------------------------------------------
+
+bool ts::IPOutputPlugin::paceDatagram(size_t packet_count, uint64_t timestamp, BitRate bitrate)
+{
+    // Without reference, no pacing is possible, send as soon as possible.
+    if ((_pacing == PACING_BITRATE && bitrate == 0) || (_pacing == PACING_PCR && _last_pcr == INVALID_PCR)) {
+        _pace_started = false;
+        return true;
+    }
+
+    const Monotonic now(true);
+
+    if (!_pace_started || (_pacing == PACING_PCR && (timestamp < _pace_pcr || timestamp - _pace_pcr > MAX_PACING_PCR_GAP))) {
+        // First paced datagram or PCR discontinuity, send now.
+        _pace_started = true;
+        _pace_time = now;
+    }
+    else if (_pacing == PACING_PCR) {
+        // Space datagrams according to the PCR-based timestamps.
+        _pace_time += NanoSecond(((timestamp - _pace_pcr) * NanoSecPerSec) / SYSTEM_CLOCK_FREQ);
+    }
+    else {
+        // Space datagrams according to the transmission duration of the previous datagram.
+        // The duration of the previous datagram is approximated with the size of the current one.
+        _pace_time += NanoSecond((packet_count * PKT_SIZE * 8 * NanoSecPerSec) / bitrate);
+    }
+    _pace_pcr = timestamp;
+
+    if (_pace_time > now) {
+        // Too early: send queued datagrams now and wait for the due time of this one.
+        if (!flushDatagrams()) {
+            return false;
         }
+        _pace_time.wait();
+    }
+    else if (now - _pace_time > MAX_PACING_LATE) {
+        // We are too late (eg. input starvation), do not burst to catch up, resynchronize.
+        _pace_time = now;
+    }
+    return true;
+}
+
 
-        // Extrapolate the RTP timestamp from the previous one, using current bitrate.
-        // This value may be replaced if a valid PCR is present in this datagram.
-        uint64_t rtp_pcr = _last_rtp_pcr;
-        if (bitrate > 0) {
-            rtp_pcr += ((_pkt_count - _last_rtp_pcr_pkt) * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
+//----------------------------------------------------------------------------
+// Compute the timestamp of a datagram in PCR units, synchronized with the PCR's.
+//----------------------------------------------------------------------------
+
+uint64_t ts::IPOutputPlugin::computeTimestamp(const TSPacket* pkt, size_t packet_count, BitRate bitrate)
+{
+    // RTP datagrams are relatively trivial to build, except the time stamp.
+    // We cannot use the wall clock time because the plugin is likely to burst its output.
+    // So, we try to synchronize RTP timestamps with PCR's from one PID.
+    // But this is not trivial since the PCR may not be accurate or may loop back.
+    // As long as the first PCR is not seen, increment timestamps from zero, using TS bitrate as reference.
+    // At the first PCR, compute the difference between the current RTP timestamp and this PCR.
+    // Then keep this difference and resynchronize at each PCR.
+    // But never jump back in RTP timestamps, only increase "more slowly" when adjusting.
+
+    // Look for a PCR in one of the packets to send.
+    // If found, we adjust this PCR for the first packet in the datagram.
+    uint64_t pcr = INVALID_PCR;
+    for (size_t i = 0; i < packet_count; i++) {
+        const bool hasPCR = pkt[i].hasPCR();
+        const PID pid = pkt[i].getPID();
+
+        // Detect PCR PID if not yet known.
+        if (hasPCR && _pcr_pid == PID_NULL) {
+            _pcr_pid = pid;
         }
 
-        // If the current datagram contains a PCR, recompute the RTP timestamp more precisely.
-        if (pcr != INVALID_PCR) {
-            if (_last_pcr == INVALID_PCR || pcr < _last_pcr) {
-                // This is the first PCR in the stream or the PCR has jumped back in the past.
-                // For this time only, we keep the extrapolated PCR.
-                // Compute the difference between PCR and RTP timestamps.
-                _rtp_pcr_offset = pcr - rtp_pcr;
-                tsp->verbose(u"RTP timestamps resynchronized with PCR PID 0x%X (%d)", {_pcr_pid, _pcr_pid});
-                tsp->debug(u"new PCR-RTP offset: %d", {_rtp_pcr_offset});
-            }
-            else {
-                // PCR are normally increasing, drop extrapolated value, resynchronize with PCR.
-                uint64_t adjusted_rtp_pcr = pcr - _rtp_pcr_offset;
-                if (adjusted_rtp_pcr <= _last_rtp_pcr) {
-                    // The adjustment would make the RTP timestamp go backward. We do not want that.
-                    // We increase the RTP timestamp "more slowly", by 25% of the extrapolated value.
-                    tsp->debug(u"RTP adjustment from PCR would step backward by %d", {((_last_rtp_pcr - adjusted_rtp_pcr) * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ});
-                    adjusted_rtp_pcr = _last_rtp_pcr + (rtp_pcr - _last_rtp_pcr) / 4;
-                }
-                rtp_pcr = adjusted_rtp_pcr;
+        // Detect PCR presence.
+        if (hasPCR && pid == _pcr_pid) {
+            pcr = pkt[i].getPCR();
+            // If the bitrate is known and the packet containing the PCR is not the first one,
+            // compute the theoretical timestamp of the first packet in the datagram.
+            if (i > 0 && bitrate > 0) {
+                pcr -= (i * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
             }
-
-            // Keep last PCR value.
-            _last_pcr = pcr;
+            break;
         }
+    }
 
-        // Insert the RTP timestamp in RTP clock units.
-        PutUInt32(&buffer[4], uint32_t((rtp_pcr * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ));
+    // Extrapolate the RTP timestamp from the previous one, using current bitrate.
+    // This value may be replaced if a valid PCR is present in this datagram.
+    uint64_t rtp_pcr = _last_rtp_pcr;
+    if (bitrate > 0) {
+        rtp_pcr += ((_pkt_count - _last_rtp_pcr_pkt) * 8 * PKT_SIZE * uint64_t(SYSTEM_CLOCK_FREQ)) / bitrate;
+    }
 
-        // Remember position and value of last datagram.
-        _last_rtp_pcr = rtp_pcr;
-        _last_rtp_pcr_pkt = _pkt_count;
+    // If the current datagram contains a PCR, recompute the RTP timestamp more precisely.
+    if (pcr != INVALID_PCR) {
+        if (_last_pcr == INVALID_PCR || pcr < _last_pcr) {
+            // This is the first PCR in the stream or the PCR has jumped back in the past.
+            // For this time only, we keep the extrapolated PCR.
+            // Compute the difference between PCR and RTP timestamps.
+            _rtp_pcr_offset = pcr - rtp_pcr;
+            tsp->verbose(u"RTP timestamps resynchronized with PCR PID 0x%X (%d)", {_pcr_pid, _pcr_pid});
+            tsp->debug(u"new PCR-RTP offset: %d", {_rtp_pcr_offset});
+        }
+        else {
+            // PCR are normally increasing, drop extrapolated value, resynchronize with PCR.
+            uint64_t adjusted_rtp_pcr = pcr - _rtp_pcr_offset;
+            if (adjusted_rtp_pcr <= _last_rtp_pcr) {
+                // The adjustment would make the RTP timestamp go backward. We do not want that.
+                // We increase the RTP timestamp "more slowly", by 25% of the extrapolated value.
+                tsp->debug(u"RTP adjustment from PCR would step backward by %d", {((_last_rtp_pcr - adjusted_rtp_pcr) * RTP_RATE_MP2T) / SYSTEM_CLOCK_FREQ});
+                adjusted_rtp_pcr = _last_rtp_pcr + (rtp_pcr - _last_rtp_pcr) / 4;
+            }
+            rtp_pcr = adjusted_rtp_pcr;
+        }
 
-        // Copy the TS packets after the RTP header and send the packets.
-        ::memcpy(buffer.data() + RTP_HEADER_SIZE, pkt, packet_count * PKT_SIZE);
-        status = _sock.send(buffer.data(), buffer.size(), *tsp);
-    }
-    else {
-        // No RTP, send TS packets directly as datagram.
-        status = _sock.send(pkt, packet_count * PKT_SIZE, *tsp);
+        // Keep last PCR value.
+        _last_pcr = pcr;
     }
 
-    // Count packets datagram per datagram.
-    _pkt_count += packet_count;
+    // Remember position and value of last datagram.
+    _last_rtp_pcr = rtp_pcr;
+    _last_rtp_pcr_pkt = _pkt_count;
 
-    return status;
+    return rtp_pcr;
 }
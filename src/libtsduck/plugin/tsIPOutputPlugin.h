@@ -35,6 +35,7 @@
 #pragma once
 #include "tsOutputPlugin.h"
 #include "tsUDPSocket.h"
+#include "tsMonotonic.h"
 
 namespace ts {
     //!
@@ -64,6 +65,16 @@ namespace ts {
         //! @endcond
 
     private:
+        // Pacing modes of output datagrams.
+        enum {
+            PACING_NONE,     // No pacing, send datagrams as soon as possible.
+            PACING_BITRATE,  // Space datagrams according to the TS bitrate.
+            PACING_PCR,      // Space datagrams according to the PCR's.
+        };
+
+        // Max number of datagrams to send in one batch.
+        static constexpr size_t MAX_BATCH = 64;
+
         UString        _destination;        // Destination address/port.
         UString        _local_addr;         // Local address.
         uint16_t       _local_port;         // Local UDP source port.
@@ -71,6 +82,7 @@ namespace ts {
         int            _tos;                // Type of service option.
         size_t         _pkt_burst;          // Number of TS packets per UDP message
         bool           _enforce_burst;      // Option --enforce-burst
+        int            _pacing;             // Pacing mode of datagrams.
         bool           _use_rtp;            // Use real-time transport protocol
         uint8_t        _rtp_pt;             // RTP payload type.
         bool           _rtp_fixed_sequence; // RTP sequence number starts with a fixed value
@@ -89,8 +101,23 @@ namespace ts {
         UDPSocket      _sock;               // Outgoing socket
         size_t         _out_count;          // Number of packets in _out_buffer
         TSPacketVector _out_buffer;         // Buffered packets for output with --enforce-burst
+        size_t         _batch_count;        // Number of datagrams in _batch
+        std::vector<UDPSocket::OutputDatagram> _batch;  // Datagrams to send in one operation
+        ByteBlock      _rtp_headers;        // RTP headers of datagrams in _batch
+        bool           _pace_started;       // Pacing is synchronized
+        Monotonic      _pace_time;          // Due time of last datagram with pacing
+        uint64_t       _pace_pcr;           // Stream time of last datagram, in PCR units, with PCR pacing
 
-        // Send contiguous packets in one single datagram.
+        // Queue contiguous packets as one datagram in the current batch.
         bool sendDatagram(const TSPacket* pkt, size_t packet_count);
+
+        // Send all queued datagrams.
+        bool flushDatagrams();
+
+        // Compute the timestamp of a datagram in PCR units, synchronized with the PCR's.
+        uint64_t computeTimestamp(const TSPacket* pkt, size_t packet_count, BitRate bitrate);
+
+        // Wait until it is time to send the next datagram in pacing mode.
+        bool paceDatagram(size_t packet_count, uint64_t timestamp, BitRate bitrate);
     };
 }
@@ -45,6 +45,17 @@ ts::ProcessorPlugin::ProcessorPlugin(TSP* tsp_, const UString& description, cons
          u"Other packets are transparently passed to the next plugin, without going through this one. "
          u"Several --only-label options may be specified. "
          u"This is a generic option which is defined in all packet processing plugins.");
+
+    // The option --observer is defined in all packet processing plugins.
+    option(u"observer");
+    help(u"observer",
+         u"Declare this plugin as a parallel observer. Consecutive observer plugins in the chain "
+         u"form a group. All plugins in a group process the same packets at the same time in their own thread. "
+         u"The packets are passed to the rest of the chain when all plugins of the group have processed them. "
+         u"Use this option only with plugins which never modify, drop or nullify packets, such as analysis "
+         u"or monitoring plugins. In a group, packet modifications by the plugins are ignored and an end "
+         u"of processing from any plugin terminates the stream. "
+         u"This is a generic option which is defined in all packet processing plugins.");
 }
 
 
@@ -60,6 +71,16 @@ ts::TSPacketMetadata::LabelSet ts::ProcessorPlugin::getOnlyLabelOption() const
 }
 
 
+//----------------------------------------------------------------------------
+// Get the content of the --observer option (packet processing plugins).
+//----------------------------------------------------------------------------
+
+bool ts::ProcessorPlugin::getObserverOption() const
+{
+    return present(u"observer");
+}
+
+
 //----------------------------------------------------------------------------
 // Default implementations of virtual methods.
 //----------------------------------------------------------------------------
@@ -68,3 +89,9 @@ ts::PluginType ts::ProcessorPlugin::type() const
 {
     return PROCESSOR_PLUGIN;
 }
+
+bool ts::ProcessorPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // Batch processing is not supported by default.
+    return false;
+}
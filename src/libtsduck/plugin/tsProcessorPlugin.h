@@ -83,6 +83,37 @@ namespace ts {
         //!
         virtual Status processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data) = 0;
 
+        //!
+        //! Packet batch processing interface.
+        //!
+        //! The main application invokes processPacketBatch() to let the shared library
+        //! process a contiguous set of TS packets in one call. This is an optional
+        //! optimization for simple plugins with a short per-packet processing.
+        //! The default implementation returns false, meaning that the plugin does not
+        //! support batch processing. In that case, the application permanently reverts
+        //! to processPacket() for each packet.
+        //!
+        //! All packets in the batch are valid packets (no packet was previously dropped)
+        //! and all of them shall be processed by the plugin. During the processing of a
+        //! batch, @c tsp->pluginPackets() returns the number of packets before the first
+        //! packet of the batch. If the plugin returns TSP_END for a packet, all subsequent
+        //! packets in the batch are ignored by the application.
+        //!
+        //! Batches are not used when the plugin uses "joint termination" because
+        //! the termination point of jointTerminate() is the current packet count.
+        //! In that case, processPacket() is invoked for each packet.
+        //!
+        //! @param [in,out] pkt Address of the first TS packet to process.
+        //! @param [in,out] pkt_data Address of the metadata of the first TS packet.
+        //! @param [in] count Number of packets in the batch.
+        //! @param [in,out] status Address of an array of @a count processing statuses,
+        //! one per packet. On input, all statuses are initialized to TSP_OK. The plugin
+        //! needs to update only the statuses of the packets which are not TSP_OK.
+        //! @return True if the batch was processed, false if the plugin does not support
+        //! batch processing. When false is returned, the packets shall not be modified.
+        //!
+        virtual bool processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status);
+
         //!
         //! Get the content of the --only-label options.
         //! The value of the option is fetched each time this method is called.
@@ -90,6 +121,13 @@ namespace ts {
         //!
         TSPacketMetadata::LabelSet getOnlyLabelOption() const;
 
+        //!
+        //! Get the content of the --observer option.
+        //! The value of the option is fetched each time this method is called.
+        //! @return True if the plugin is declared as a parallel observer.
+        //!
+        bool getObserverOption() const;
+
         // Implementation of inherited interface.
         virtual PluginType type() const override;
 
@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedMemoryInputPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+TS_REGISTER_INPUT_PLUGIN(u"shm", ts::SharedMemoryInputPlugin);
+
+// A dummy storage value to force inclusion of this module when using the static library.
+const int ts::SharedMemoryInputPlugin::REFERENCE = 0;
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryInputPlugin::SharedMemoryInputPlugin(TSP* tsp_) :
+    InputPlugin(tsp_, u"Receive TS packets from a parent process through shared memory", u"[options] [name]"),
+    _name(),
+    _ring()
+{
+    option(u"", 0, STRING, 0, 1);
+    help(u"",
+         u"Name of the shared memory ring to read. "
+         u"By default, use the value of the environment variable " + UString(TSPacketSharedRing::ENVIRONMENT_VARIABLE) + u". "
+         u"This variable is defined by the plugins which start a process with option --shared-memory, "
+         u"such as merge or fork. This plugin shall be used in the command of these plugins.");
+}
+
+
+//----------------------------------------------------------------------------
+// Input methods
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryInputPlugin::getOptions()
+{
+    _name = value(u"", GetEnvironment(TSPacketSharedRing::ENVIRONMENT_VARIABLE).c_str());
+    if (_name.empty()) {
+        tsp->error(u"no shared memory ring specified and %s is not defined", {TSPacketSharedRing::ENVIRONMENT_VARIABLE});
+        return false;
+    }
+    return true;
+}
+
+bool ts::SharedMemoryInputPlugin::start()
+{
+    return _ring.attach(_name, TSPacketSharedRing::CONSUMER, *tsp);
+}
+
+bool ts::SharedMemoryInputPlugin::stop()
+{
+    return _ring.close(*tsp);
+}
+
+bool ts::SharedMemoryInputPlugin::abortInput()
+{
+    _ring.abort();
+    return true;
+}
+
+size_t ts::SharedMemoryInputPlugin::receive(TSPacket* buffer, TSPacketMetadata* pkt_data, size_t max_packets)
+{
+    return _ring.read(buffer, pkt_data, max_packets, tsp);
+}
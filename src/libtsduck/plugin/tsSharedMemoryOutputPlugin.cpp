@@ -0,0 +1,92 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+
+#include "tsSharedMemoryOutputPlugin.h"
+#include "tsPluginRepository.h"
+#include "tsSysUtils.h"
+TSDUCK_SOURCE;
+
+TS_REGISTER_OUTPUT_PLUGIN(u"shm", ts::SharedMemoryOutputPlugin);
+
+// A dummy storage value to force inclusion of this module when using the static library.
+const int ts::SharedMemoryOutputPlugin::REFERENCE = 0;
+
+
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+
+ts::SharedMemoryOutputPlugin::SharedMemoryOutputPlugin(TSP* tsp_) :
+    OutputPlugin(tsp_, u"Send TS packets to a parent process through shared memory", u"[options] [name]"),
+    _name(),
+    _ring()
+{
+    option(u"", 0, STRING, 0, 1);
+    help(u"",
+         u"Name of the shared memory ring to write. "
+         u"By default, use the value of the environment variable " + UString(TSPacketSharedRing::ENVIRONMENT_VARIABLE) + u". "
+         u"This variable is defined by the plugins which start a process with option --shared-memory, "
+         u"such as merge or fork. This plugin shall be used in the command of these plugins.");
+}
+
+
+//----------------------------------------------------------------------------
+// Output methods
+//----------------------------------------------------------------------------
+
+bool ts::SharedMemoryOutputPlugin::getOptions()
+{
+    _name = value(u"", GetEnvironment(TSPacketSharedRing::ENVIRONMENT_VARIABLE).c_str());
+    if (_name.empty()) {
+        tsp->error(u"no shared memory ring specified and %s is not defined", {TSPacketSharedRing::ENVIRONMENT_VARIABLE});
+        return false;
+    }
+    return true;
+}
+
+bool ts::SharedMemoryOutputPlugin::start()
+{
+    return _ring.attach(_name, TSPacketSharedRing::PRODUCER, *tsp);
+}
+
+bool ts::SharedMemoryOutputPlugin::stop()
+{
+    return _ring.close(*tsp);
+}
+
+bool ts::SharedMemoryOutputPlugin::send(const TSPacket* buffer, const TSPacketMetadata* pkt_data, size_t packet_count)
+{
+    if (_ring.write(buffer, pkt_data, packet_count, tsp)) {
+        return true;
+    }
+    if (_ring.stopped()) {
+        tsp->error(u"shared memory ring %s closed by consumer", {_name});
+    }
+    return false;
+}
@@ -38,6 +38,7 @@ const ts::Enumeration ts::TSPControlCommand::ControlCommandEnum({
     {u"suspend", ts::TSPControlCommand::ControlCommand::CMD_SUSPEND},
     {u"resume",  ts::TSPControlCommand::ControlCommand::CMD_RESUME},
     {u"restart", ts::TSPControlCommand::ControlCommand::CMD_RESTART},
+    {u"stats",   ts::TSPControlCommand::ControlCommand::CMD_STATS},
 });
 
 
@@ -87,6 +88,15 @@ ts::TSPControlCommand::TSPControlCommand() :
     arg->help(u"same",
               u"Restart the plugin with the same options and parameters. "
               u"By default, when no plugin options are specified, restart with no option at all.");
+
+    arg = newCommand(CMD_STATS, u"Report execution statistics of all plugins", u"[options]");
+    arg->setIntro(u"Report the execution statistics of all plugins: time waiting for packets, "
+                  u"processing time per packet, size of the packet windows, number of flushes "
+                  u"to the next plugin. Times are in nanoseconds.");
+    arg->option(u"json", 'j');
+    arg->help(u"json", u"Report the statistics in JSON format.");
+    arg->option(u"reset", 'r');
+    arg->help(u"reset", u"Reset the statistics of all plugins after reporting them.");
 }
 
 
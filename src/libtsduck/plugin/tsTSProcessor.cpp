@@ -32,6 +32,7 @@
 #include "tstspOutputExecutor.h"
 #include "tstspProcessorExecutor.h"
 #include "tstspControlServer.h"
+#include "tstspTelemetryMonitor.h"
 #include "tsMonotonic.h"
 #include "tsGuard.h"
 TSDUCK_SOURCE;
@@ -51,6 +52,7 @@ ts::TSProcessor::TSProcessor(Report& report) :
     _output(nullptr),
     _monitor(nullptr),
     _control(nullptr),
+    _telemetry(nullptr),
     _packet_buffer(nullptr),
     _metadata_buffer(nullptr)
 {
@@ -111,6 +113,12 @@ void ts::TSProcessor::cleanupInternal()
         delete _control;
         _control = nullptr;
     }
+
+    if (_telemetry != nullptr) {
+        // Deleting the object terminates the telemetry thread.
+        delete _telemetry;
+        _telemetry = nullptr;
+    }
 }
 
 
@@ -191,6 +199,29 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
             }
         } while ((proc = proc->ringNext<ts::tsp::PluginExecutor>()) != _input);
 
+        // Build groups of consecutive packet processors which are declared as parallel observers.
+        std::vector<tsp::ProcessorExecutor*> observers;
+        for (proc = _input->ringNext<tsp::PluginExecutor>(); ; proc = proc->ringNext<tsp::PluginExecutor>()) {
+            tsp::ProcessorExecutor* pe = dynamic_cast<tsp::ProcessorExecutor*>(proc);
+            if (pe != nullptr && pe->isObserver()) {
+                observers.push_back(pe);
+            }
+            else {
+                // End of a sequence of observers. A single observer is a plain packet processor.
+                if (observers.size() > 1) {
+                    const tsp::ObserverGroupPtr group(new tsp::ObserverGroup(observers.size()));
+                    for (size_t i = 0; i < observers.size(); ++i) {
+                        observers[i]->setObserverGroup(group, i);
+                    }
+                    _report.debug(u"tsp: group of %d parallel observers, starting at %s", {observers.size(), observers.front()->pluginName()});
+                }
+                observers.clear();
+                if (proc == _output) {
+                    break;
+                }
+            }
+        }
+
         // Allocate a memory-resident buffer of TS packets
         _packet_buffer = new PacketBuffer(_args.ts_buffer_size / ts::PKT_SIZE);
         CheckNonNull(_packet_buffer);
@@ -249,6 +280,11 @@ bool ts::TSProcessor::start(const TSProcessorArgs& args)
     CheckNonNull(_control);
     _control->open();
 
+    // Create a telemetry thread for periodic reports. Display but ignore errors (not a fatal error).
+    _telemetry = new tsp::TelemetryMonitor(_args, _report, _input);
+    CheckNonNull(_telemetry);
+    _telemetry->open();
+
     return true;
 }
 
@@ -296,8 +332,10 @@ void ts::TSProcessor::waitForTermination()
             proc->waitForTermination();
         } while ((proc = proc->ringNext<tsp::PluginExecutor>()) != _input);
 
-        // Make sure the control server thread is terminated before deleting plugins.
+        // Make sure the control server and telemetry threads are terminated before deleting plugins.
+        // The telemetry thread produces a last report when it terminates.
         _control->close();
+        _telemetry->close();
 
         // Deallocate all plugins and plugin executor
         cleanupInternal();
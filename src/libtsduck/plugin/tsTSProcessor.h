@@ -47,6 +47,7 @@ namespace ts {
         class InputExecutor;
         class OutputExecutor;
         class ControlServer;
+        class TelemetryMonitor;
     }
     //! @endcond
 
@@ -112,6 +113,7 @@ namespace ts {
         tsp::OutputExecutor*  _output;           // Output processor execution thread.
         SystemMonitor*        _monitor;          // System monitor thread.
         tsp::ControlServer*   _control;          // TSP control command server thread.
+        tsp::TelemetryMonitor* _telemetry;       // Periodic report of plugin execution statistics.
         PacketBuffer*         _packet_buffer;    // Global TS packet buffer.
         PacketMetadataBuffer* _metadata_buffer;  // Global packet metabata buffer.
 
@@ -54,6 +54,7 @@ ts::TSProcessorArgs::TSProcessorArgs() :
     app_name(),
     monitor(false),
     ignore_jt(false),
+    lock_free(false),
     ts_buffer_size(DEFAULT_BUFFER_SIZE),
     max_flush_pkt(0),
     max_input_pkt(0),
@@ -72,6 +73,8 @@ ts::TSProcessorArgs::TSProcessorArgs() :
     control_reuse(false),
     control_sources(),
     control_timeout(DEF_CONTROL_TIMEOUT),
+    telemetry_interval(0),
+    telemetry_file(),
     duck_args(),
     input(),
     plugins(),
@@ -180,6 +183,13 @@ void ts::TSProcessorArgs::defineArgs(Args& args) const
               u"Equivalent to the same --receive-timeout options in some plugins. "
               u"By default, there is no input timeout.");
 
+    args.option(u"lock-free-ring");
+    args.help(u"lock-free-ring",
+              u"Pass packets from one plugin to the next one using lock-free atomic counters "
+              u"instead of the global mutex. A plugin thread blocks only when there is no packet "
+              u"to process. This can reduce the contention between plugin threads with long "
+              u"chains of plugins at high bitrates.");
+
     args.option(u"max-flushed-packets", 0, Args::POSITIVE);
     args.help(u"max-flushed-packets",
               u"Specify the maximum number of packets to be processed before flushing "
@@ -210,6 +220,19 @@ void ts::TSProcessorArgs::defineArgs(Args& args) const
               u"are enforced. The explicit values 'no', 'false', 'off' are used to enforce "
               u"the offline defaults and the explicit values 'yes', 'true', 'on' are used "
               u"to enforce the real-time defaults.");
+
+    args.option(u"telemetry-file", 0, Args::STRING);
+    args.help(u"telemetry-file", u"filename",
+              u"With --telemetry-interval, append the periodic reports to the specified file, "
+              u"one JSON object per line. By default, the reports are logged as messages.");
+
+    args.option(u"telemetry-interval", 0, Args::POSITIVE);
+    args.help(u"telemetry-interval", u"seconds",
+              u"Periodically report the execution statistics of all plugins in JSON format. "
+              u"The statistics include the time waiting for packets, the processing time per packet, "
+              u"the size of the packet windows and the number of flushes to the next plugin. "
+              u"The same statistics are available at any time using the tspcontrol command \"stats\". "
+              u"By default, there is no periodic report.");
 }
 
 
@@ -230,11 +253,14 @@ bool ts::TSProcessorArgs::loadArgs(DuckContext& duck, Args& args)
     instuff_start = args.intValue<size_t>(u"add-start-stuffing", 0);
     instuff_stop = args.intValue<size_t>(u"add-stop-stuffing", 0);
     ignore_jt = args.present(u"ignore-joint-termination");
+    lock_free = args.present(u"lock-free-ring");
     realtime = args.tristateValue(u"realtime");
     receive_timeout = args.intValue<MilliSecond>(u"receive-timeout", 0);
     control_port = args.intValue<uint16_t>(u"control-port", 0);
     control_timeout = args.intValue<MilliSecond>(u"control-timeout", DEF_CONTROL_TIMEOUT);
     control_reuse = args.present(u"control-reuse-port");
+    telemetry_interval = MilliSecPerSec * args.intValue<MilliSecond>(u"telemetry-interval", 0);
+    args.getValue(telemetry_file, u"telemetry-file");
 
     // Convert MB in MiB for buffer size for compatibility with original versions.
     ts_buffer_size = size_t((uint64_t(ts_buffer_size) * 1024 * 1024) / 1000000);
@@ -49,6 +49,7 @@ namespace ts {
         UString         app_name;         //!< Application name, for help messages.
         bool            monitor;          //!< Run a resource monitoring thread.
         bool            ignore_jt;        //!< Ignore "joint termination" options in plugins.
+        bool            lock_free;        //!< Use lock-free packet handoff between plugin threads instead of the global mutex.
         size_t          ts_buffer_size;   //!< Size in bytes of the global TS packet buffer.
         size_t          max_flush_pkt;    //!< Max processed packets before flush.
         size_t          max_input_pkt;    //!< Max packets per input operation.
@@ -67,6 +68,8 @@ namespace ts {
         bool            control_reuse;    //!< Set the 'reuse port' socket option on the control TCP server port.
         IPAddressVector control_sources;  //!< Remote IP addresses which are allowed to send control commands.
         MilliSecond     control_timeout;  //!< Reception timeout in milliseconds for control commands.
+        MilliSecond     telemetry_interval; //!< Interval between periodic reports of plugin execution statistics, zero if none.
+        UString         telemetry_file;   //!< File receiving periodic reports of plugin execution statistics, log if empty.
         DuckContext::SavedArgs duck_args; //!< Default TSDuck context options for all plugins. Each plugin can override them in its context.
         PluginOptions          input;     //!< Input plugin description.
         PluginOptionsVector    plugins;   //!< Packet processor plugins descriptions.
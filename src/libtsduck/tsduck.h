@@ -313,6 +313,7 @@
 #include "tsjsonNull.h"
 #include "tsjsonNumber.h"
 #include "tsjsonObject.h"
+#include "tsjsonStreamWriter.h"
 #include "tsjsonString.h"
 #include "tsjsonTrue.h"
 #include "tsjsonValue.h"
@@ -392,6 +393,7 @@
 #include "tsPESDemux.h"
 #include "tsPESHandlerInterface.h"
 #include "tsPESPacket.h"
+#include "tsPIDIndexedMap.h"
 #include "tsPIDOperator.h"
 #include "tsPlatform.h"
 #include "tsPlugin.h"
@@ -432,6 +434,7 @@
 #include "tsS2XSatelliteDeliverySystemDescriptor.h"
 #include "tsSafePtr.h"
 #include "tsSatelliteDeliverySystemDescriptor.h"
+#include "tsScatteredPESPacket.h"
 #include "tsSchedulingDescriptor.h"
 #include "tsScramblingDescriptor.h"
 #include "tsSCTE35.h"
@@ -441,6 +444,7 @@
 #include "tsSectionDemux.h"
 #include "tsSectionFile.h"
 #include "tsSectionHandlerInterface.h"
+#include "tsSectionPool.h"
 #include "tsSectionProviderInterface.h"
 #include "tsSelectionInformationTable.h"
 #include "tsSeriesDescriptor.h"
@@ -458,6 +462,8 @@
 #include "tsSHA256.h"
 #include "tsSHA512.h"
 #include "tsSharedLibrary.h"
+#include "tsSharedMemoryInputPlugin.h"
+#include "tsSharedMemoryOutputPlugin.h"
 #include "tsSHDeliverySystemDescriptor.h"
 #include "tsShortEventDescriptor.h"
 #include "tsShortNodeInformationDescriptor.h"
@@ -586,12 +592,14 @@
 #include "tsTSFile.h"
 #include "tsTSFileInputBuffered.h"
 #include "tsTSFileOutputResync.h"
+#include "tsTSFileReadArgs.h"
 #include "tsTSForkPipe.h"
 #include "tsTSInformationDescriptor.h"
 #include "tsTSP.h"
 #include "tsTSPacket.h"
 #include "tsTSPacketMetadata.h"
 #include "tsTSPacketQueue.h"
+#include "tsTSPacketSharedRing.h"
 #include "tsTSPacketStream.h"
 #include "tsTSPControlCommand.h"
 #include "tsTSProcessor.h"
@@ -599,6 +607,7 @@
 #include "tsTSScanner.h"
 #include "tsTSScrambling.h"
 #include "tsTSSpeedMetrics.h"
+#include "tsTSSyncScanner.h"
 #include "tsTuner.h"
 #include "tsTunerArgs.h"
 #include "tsTVCT.h"
@@ -636,6 +645,8 @@
 #include "tsxmlDocument.h"
 #include "tsxmlElement.h"
 #include "tsxmlNode.h"
+#include "tsxmlPullParser.h"
+#include "tsxmlStreamWriter.h"
 #include "tsxmlText.h"
 #include "tsxmlTweaks.h"
 #include "tsxmlUnknown.h"
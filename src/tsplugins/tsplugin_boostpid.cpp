@@ -50,6 +50,7 @@ namespace ts {
         virtual bool getOptions() override;
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         // Command line options:
@@ -169,3 +170,17 @@ ts::ProcessorPlugin::Status ts::BoostPIDPlugin::processPacket(TSPacket& pkt, TSP
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::BoostPIDPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // All packets are passed, no need to update the status.
+    for (size_t i = 0; i < count; ++i) {
+        BoostPIDPlugin::processPacket(pkt[i], pkt_data[i]);
+    }
+    return true;
+}
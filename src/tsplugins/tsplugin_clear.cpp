@@ -56,6 +56,7 @@ namespace ts {
         ClearPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         bool          _abort;           // Error (service not found, etc)
@@ -370,3 +371,18 @@ ts::ProcessorPlugin::Status ts::ClearPlugin::processPacket(TSPacket& pkt, TSPack
 
     return _pass_packets ? TSP_OK : _drop_status;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::ClearPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if ((status[i] = ClearPlugin::processPacket(pkt[i], pkt_data[i])) == TSP_END) {
+            break;
+        }
+    }
+    return true;
+}
@@ -53,6 +53,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         // This structure is used at each --interval.
@@ -81,6 +82,9 @@ namespace ts {
         IntervalReport _last_report;        // Last report content
         PacketCounter  _counters[PID_MAX];  // Packet counter per PID
 
+        // Count one packet, index is the packet index in the plugin.
+        void countPacket(const TSPacket& pkt, PacketCounter index);
+
         // Report a line
         void report(const UChar* fmt, const std::initializer_list<ArgMixIn> args);
     };
@@ -264,6 +268,22 @@ void ts::CountPlugin::report(const UChar* fmt, const std::initializer_list<ArgMi
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    countPacket(pkt, tsp->pluginPackets());
+    return TSP_OK;
+}
+
+bool ts::CountPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // All packets are passed, no need to update the status.
+    const PacketCounter first = tsp->pluginPackets();
+    for (size_t i = 0; i < count; ++i) {
+        countPacket(pkt[i], first + i);
+    }
+    return true;
+}
+
+void ts::CountPlugin::countPacket(const TSPacket& pkt, PacketCounter index)
 {
     // Check if the packet must be counted
     const PID pid = pkt.getPID();
@@ -274,18 +294,18 @@ ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, TSPack
 
     // Process reporting intervals.
     if (_report_interval > 0) {
-        if (tsp->pluginPackets() == 0) {
+        if (index == 0) {
             // Set initial interval
             _last_report.start = Time::CurrentUTC();
             _last_report.counted_packets = 0;
             _last_report.total_packets = 0;
         }
-        else if (tsp->pluginPackets() % _report_interval == 0) {
+        else if (index % _report_interval == 0) {
             // It is time to produce a report.
             // Get current state.
             IntervalReport now;
             now.start = Time::CurrentUTC();
-            now.total_packets = tsp->pluginPackets();
+            now.total_packets = index;
             now.counted_packets = 0;
             for (size_t p = 0; p < PID_MAX; p++) {
                 now.counted_packets += _counters[p];
@@ -311,14 +331,12 @@ ts::ProcessorPlugin::Status ts::CountPlugin::processPacket(TSPacket& pkt, TSPack
     if (ok) {
         if (_report_all) {
             if (_brief_report) {
-                report(u"%d %d", {tsp->pluginPackets(), pid});
+                report(u"%d %d", {index, pid});
             }
             else {
-                report(u"%spacket: %10'd, PID: %4d (0x%04X)", {_tag, tsp->pluginPackets(), pid, pid});
+                report(u"%spacket: %10'd, PID: %4d (0x%04X)", {_tag, index, pid, pid});
             }
         }
         _counters[pid]++;
     }
-
-    return TSP_OK;
 }
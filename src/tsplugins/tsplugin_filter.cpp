@@ -52,6 +52,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         // Packet intervals and list of them.
@@ -96,6 +97,9 @@ namespace ts {
         // Working data:
         PacketCounter   _filtered_packets;   // Number of filtered packets
         PIDSet          _stream_id_pid;      // PID values selected from stream ids.
+
+        // Filter one packet, index is the packet index in the plugin.
+        Status filterPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter index);
     };
 }
 
@@ -434,11 +438,24 @@ bool ts::FilterPlugin::stop()
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    return filterPacket(pkt, pkt_data, tsp->pluginPackets());
+}
+
+bool ts::FilterPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    const PacketCounter first = tsp->pluginPackets();
+    for (size_t i = 0; i < count; ++i) {
+        status[i] = filterPacket(pkt[i], pkt_data[i], first + i);
+    }
+    return true;
+}
+
+ts::ProcessorPlugin::Status ts::FilterPlugin::filterPacket(TSPacket& pkt, TSPacketMetadata& pkt_data, PacketCounter packetIndex)
 {
     const PID pid = pkt.getPID();
 
     // Pass initial packets without filtering.
-    const PacketCounter packetIndex = tsp->pluginPackets();
     if (packetIndex < _after_packets) {
         return TSP_OK;
     }
@@ -471,7 +488,7 @@ ts::ProcessorPlugin::Status ts::FilterPlugin::processPacket(TSPacket& pkt, TSPac
         (_min_af >= 0 && int(pkt.getAFSize()) >= _min_af) ||
         (int(pkt.getAFSize()) <= _max_af) ||
         pkt_data.hasAnyLabel(_labels) ||
-        (_every_packets > 0 && (tsp->pluginPackets() - _after_packets) % _every_packets == 0) ||
+        (_every_packets > 0 && (packetIndex - _after_packets) % _every_packets == 0) ||
         (_with_pes && pkt.startPES());
 
     // Search binary patterns in packets.
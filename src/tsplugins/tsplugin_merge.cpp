@@ -35,6 +35,7 @@
 #include "tsPluginRepository.h"
 #include "tsTSForkPipe.h"
 #include "tsTSPacketQueue.h"
+#include "tsTSPacketSharedRing.h"
 #include "tsPSIMerger.h"
 #include "tsThread.h"
 TSDUCK_SOURCE;
@@ -61,7 +62,8 @@ namespace ts {
     private:
         // Definitions:
         // - Main stream: the TS which is processed by tsp, including this plugin.
-        // - Merged stream: the additional TS which is read by this plugin through a pipe.
+        // - Merged stream: the additional TS which is read by this plugin through a pipe
+        //   or a shared memory ring.
 
         // Each PID with PCR's in the merged stream is described by a structure like this.
         class PIDContext
@@ -88,6 +90,8 @@ namespace ts {
         PacketCounter     _pkt_count;         // Packet counter in the main stream.
         TSForkPipe        _pipe;              // Executed command.
         TSPacketQueue     _queue;             // TS packet queur from merge to main.
+        bool              _use_ring;          // Use a shared memory ring instead of the pipe and queue.
+        TSPacketSharedRing _ring;             // Shared memory ring from the created process.
         PIDSet            _main_pids;         // Set of detected PID's in main stream.
         PIDSet            _merge_pids;        // Set of detected PID's in merged stream that we pass in main stream.
         PIDContextMap     _pcr_pids;          // Description of PID's with PCR's from the merged stream.
@@ -101,6 +105,8 @@ namespace ts {
 
         // There is one thread which receives packet from the created process and passes
         // them to the main plugin thread. The following method is the thread main code.
+        // This thread is not used with a shared memory ring, the packets are directly
+        // read from the ring by the plugin thread.
         virtual void main() override;
 
         // Process one packet coming from the merged stream.
@@ -128,6 +134,8 @@ ts::MergePlugin::MergePlugin(TSP* tsp_) :
     _pkt_count(0),
     _pipe(),
     _queue(),
+    _use_ring(false),
+    _ring(),
     _main_pids(),
     _merge_pids(),
     _pcr_pids(),
@@ -201,6 +209,15 @@ ts::MergePlugin::MergePlugin(TSP* tsp_) :
          u"passed. This can be modified using options --drop and --pass. Several "
          u"options --pass can be specified.");
 
+    option(u"shared-memory", 's');
+    help(u"shared-memory",
+         u"Receive the merged stream through a shared memory ring instead of the standard output of the created process. "
+         u"The command shall be a tsp command using the output plugin shm (-O shm), "
+         u"the name of the ring is passed in the environment variable " + UString(TSPacketSharedRing::ENVIRONMENT_VARIABLE) + u". "
+         u"The packets are not copied through the kernel and no intermediate thread is used. "
+         u"The option --max-queue specifies the size of the ring. The option --format is ignored. "
+         u"Not supported on Windows.");
+
     option(u"terminate");
     help(u"terminate",
         u"Terminate packet processing when the merged stream is terminated. "
@@ -242,6 +259,7 @@ bool ts::MergePlugin::start()
     _pcr_restamp = !present(u"no-pcr-restamp");
     _ignore_conflicts = transparent || present(u"ignore-conflicts");
     _terminate = present(u"terminate");
+    _use_ring = present(u"shared-memory");
     tsp->useJointTermination(present(u"joint-termination"));
     getIntValues(_setLabels, u"set-label");
     getIntValues(_resetLabels, u"reset-label");
@@ -289,6 +307,21 @@ bool ts::MergePlugin::start()
     _got_eof = false;
     _abort = false;
 
+    // With a shared memory ring, the process uses no pipe and there is no receiver thread.
+    if (_use_ring) {
+        if (!_ring.create(TSPacketSharedRing::CONSUMER, max_queue, *tsp)) {
+            return false;
+        }
+        _pipe.setEnvironment(TSPacketSharedRing::ENVIRONMENT_VARIABLE, _ring.name());
+        if (!_pipe.open(command, nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS, 0, *tsp, ForkPipe::KEEP_BOTH, ForkPipe::STDIN_NONE)) {
+            _ring.close(*tsp);
+            return false;
+        }
+        // Detect a process which terminates before using the ring.
+        _ring.setPeerProcess(_pipe.processId());
+        return true;
+    }
+
     // Create pipe & process
     const bool ok = _pipe.open(command,
                                nowait ? ForkPipe::ASYNCHRONOUS : ForkPipe::SYNCHRONOUS,
@@ -348,6 +381,12 @@ bool ts::MergePlugin::processDropPassOption(const UChar* option, bool allowed)
 
 bool ts::MergePlugin::stop()
 {
+    // With a shared memory ring, closing the ring makes the created process stop writing.
+    if (_use_ring) {
+        _ring.close(*tsp);
+        return _pipe.close(*tsp);
+    }
+
     // Send the stop condition to the internal packet queue.
     _queue.stop();
 
@@ -451,11 +490,12 @@ ts::ProcessorPlugin::Status ts::MergePlugin::processPacket(TSPacket& pkt, TSPack
 ts::ProcessorPlugin::Status ts::MergePlugin::processMergePacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
 {
     BitRate merge_bitrate = 0;
+    TSPacketMetadata merge_data;
 
     // Replace current null packet in main stream with next packet from merged stream.
-    if (!_queue.getPacket(pkt, merge_bitrate)) {
+    if (!(_use_ring ? _ring.getPacket(pkt, merge_data) : _queue.getPacket(pkt, merge_bitrate))) {
         // No packet available, keep original null packet.
-        if (!_got_eof && _queue.eof()) {
+        if (!_got_eof && (_use_ring ? _ring.eof() : _queue.eof())) {
             // Report end of input stream once.
             _got_eof = true;
             tsp->verbose(u"end of merged stream");
@@ -298,6 +298,10 @@ bool ts::NITPlugin::start()
     _last_sdt_act.invalidate();
     _collected_sld.clear();
 
+    // When building service list descriptors, the modified NIT depends on the collected PAT and SDT,
+    // not only on the input NIT. Previous results for unchanged NIT's cannot be reused in that case.
+    useTableCache(!_build_sld);
+
     // When we need to build service list descriptors, we need to analyze the PAT and SDT.
     _demux.reset();
     if (_build_sld && !_use_nit_other) {
@@ -63,6 +63,7 @@ namespace ts {
         // Implementation of AbstractTablePlugin.
         virtual void createNewTable(BinaryTable& table) override;
         virtual void modifyTable(BinaryTable& table, bool& is_target, bool& reinsert) override;
+        virtual bool patchTable(const BinaryTable& intable, BinaryTable& table, bool& is_target, bool& reinsert) override;
     };
 }
 
@@ -200,3 +201,63 @@ void ts::PATPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
     // Reserialize modified PAT.
     pat.serialize(duck, table);
 }
+
+
+//----------------------------------------------------------------------------
+// Invoked by the superclass to try a binary patch of a table.
+//----------------------------------------------------------------------------
+
+bool ts::PATPlugin::patchTable(const BinaryTable& intable, BinaryTable& table, bool&, bool&)
+{
+    if (intable.tableId() != TID_PAT) {
+        return false;
+    }
+
+    // Locate all services in the binary PAT, including the NIT as service id 0.
+    // Index: service id, value: section index and offset of PID in section.
+    std::map<uint16_t, std::pair<size_t, size_t>> location;
+    for (size_t si = 0; si < intable.sectionCount(); ++si) {
+        const SectionPtr& sect(intable.sectionAt(si));
+        if (sect.isNull() || !sect->isValid() || sect->payloadSize() % 4 != 0) {
+            return false;
+        }
+        const uint8_t* data = sect->payload();
+        for (size_t i = 0; i < sect->payloadSize(); i += 4) {
+            if (!location.insert(std::make_pair(GetUInt16(data + i), std::make_pair(si, sect->headerSize() + i + 2))).second) {
+                return false; // duplicated service, let the full decoding cleanup the PAT.
+            }
+        }
+    }
+
+    // Only modifications of existing PID values can be patched. Adding or removing entries
+    // modifies the structure of the PAT.
+    const bool has_nit = location.find(0) != location.end();
+    if ((_new_nit_pid != PID_NULL && !has_nit) || (_new_nit_pid == PID_NULL && _remove_nit && has_nit)) {
+        return false;
+    }
+    for (std::vector<uint16_t>::const_iterator it = _remove_serv.begin(); it != _remove_serv.end(); ++it) {
+        if (location.find(*it) != location.end()) {
+            return false;
+        }
+    }
+    for (ServiceVector::const_iterator it = _add_serv.begin(); it != _add_serv.end(); ++it) {
+        if (it->getId() == 0 || location.find(it->getId()) == location.end()) {
+            return false;
+        }
+    }
+
+    // Patch a private copy of the PAT.
+    table.copy(intable);
+    if (_set_tsid) {
+        table.patchTableIdExtension(_new_tsid);
+    }
+    if (_new_nit_pid != PID_NULL) {
+        const std::pair<size_t, size_t>& loc(location[0]);
+        table.sectionAt(loc.first)->patchUInt16(loc.second, 0xE000 | _new_nit_pid);
+    }
+    for (ServiceVector::const_iterator it = _add_serv.begin(); it != _add_serv.end(); ++it) {
+        const std::pair<size_t, size_t>& loc(location[it->getId()]);
+        table.sectionAt(loc.first)->patchUInt16(loc.second, 0xE000 | it->getPMTPID());
+    }
+    return true;
+}
@@ -102,6 +102,7 @@ namespace ts {
         // Implementation of AbstractTablePlugin.
         virtual void createNewTable(BinaryTable& table) override;
         virtual void modifyTable(BinaryTable& table, bool& is_target, bool& reinsert) override;
+        virtual bool patchTable(const BinaryTable& intable, BinaryTable& table, bool& is_target, bool& reinsert) override;
 
         // Add a descriptor for a given PID in _add_pid_descs.
         void addComponentDescriptor(PID pid, const AbstractDescriptor& desc);
@@ -675,6 +676,83 @@ void ts::PMTPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
 }
 
 
+//----------------------------------------------------------------------------
+// Invoked by the superclass to try a binary patch of a table.
+//----------------------------------------------------------------------------
+
+bool ts::PMTPlugin::patchTable(const BinaryTable& intable, BinaryTable& table, bool&, bool&)
+{
+    // Only the service id, the PCR PID and the PID of existing components can be patched.
+    // All other modifications change the structure of the PMT.
+    if (intable.tableId() != TID_PMT ||
+        (_service.hasId() && intable.tableIdExtension() != _service.getId()) ||
+        intable.sectionCount() != 1 ||
+        !_removed_pid.empty() ||
+        !_removed_desc.empty() ||
+        !_removed_stream.empty() ||
+        !_added_pid.empty() ||
+        _add_stream_id ||
+        _ac3_atsc2dvb ||
+        _eac3_atsc2dvb ||
+        _cleanup_priv_desc ||
+        !_add_descs.empty() ||
+        !_add_pid_descs.empty() ||
+        !_languages.empty())
+    {
+        return false;
+    }
+
+    // Locate all components in the binary PMT.
+    // Index: component PID, value: offset of PID in section.
+    const SectionPtr& sect(intable.sectionAt(0));
+    if (sect.isNull() || !sect->isValid() || sect->payloadSize() < 4) {
+        return false;
+    }
+    const uint8_t* const data = sect->payload();
+    const size_t size = sect->payloadSize();
+    size_t pos = 4 + (GetUInt16(data + 2) & 0x0FFF);
+    std::map<PID, size_t> location;
+    while (pos + 5 <= size) {
+        if (!location.insert(std::make_pair(GetUInt16(data + pos + 1) & 0x1FFF, sect->headerSize() + pos + 1)).second) {
+            return false; // duplicated component, let the full decoding cleanup the PMT.
+        }
+        pos += 5 + (GetUInt16(data + pos + 3) & 0x0FFF);
+    }
+    if (pos != size) {
+        return false; // invalid PMT, let the full decoding report it.
+    }
+
+    // Apply the PID remapping on the locations, in the same order as modifyTable().
+    // Moving a component to an existing one modifies the structure of the PMT.
+    for (std::map<PID, PID>::const_iterator it = _moved_pid.begin(); it != _moved_pid.end(); ++it) {
+        const auto loc = location.find(it->first);
+        if (it->first != it->second && loc != location.end()) {
+            if (location.find(it->second) != location.end()) {
+                return false;
+            }
+            location[it->second] = loc->second;
+            location.erase(loc);
+        }
+    }
+
+    // Patch a private copy of the PMT.
+    table.copy(intable);
+    const SectionPtr& patched(table.sectionAt(0));
+    if (_set_servid) {
+        table.patchTableIdExtension(_new_servid);
+    }
+    if (_set_pcrpid) {
+        patched->patchUInt16(sect->headerSize(), 0xE000 | _new_pcrpid);
+    }
+    for (std::map<PID, size_t>::const_iterator it = location.begin(); it != location.end(); ++it) {
+        if (it->first != (GetUInt16(sect->content() + it->second) & 0x1FFF)) {
+            patched->patchUInt16(it->second, 0xE000 | it->first);
+        }
+    }
+    return true;
+}
+
+
 //----------------------------------------------------------------------------
 // Packet processing method
 //----------------------------------------------------------------------------
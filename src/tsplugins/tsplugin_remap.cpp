@@ -59,6 +59,7 @@ namespace ts {
         virtual bool getOptions() override;
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         typedef SafePtr<CyclingPacketizer, NullMutex> CyclingPacketizerPtr;
@@ -298,3 +299,18 @@ ts::ProcessorPlugin::Status ts::RemapPlugin::processPacket(TSPacket& pkt, TSPack
 
     return TSP_OK;
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::RemapPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if ((status[i] = RemapPlugin::processPacket(pkt[i], pkt_data[i])) == TSP_END) {
+            break;
+        }
+    }
+    return true;
+}
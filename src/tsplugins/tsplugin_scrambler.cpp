@@ -104,6 +104,7 @@ namespace ts {
         virtual bool start() override;
         virtual bool stop() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         // Description of a crypto-period.
@@ -195,6 +196,9 @@ namespace ts {
         size_t            _current_ecm;         // Index to current ECM (ECM being broadcast)
         TSScrambling      _scrambling;          // Scrambler
         CyclingPacketizer _pzer_pmt;            // Packetizer for modified PMT
+        bool              _batch_mode;          // Processing a batch of packets, postpone scrambling.
+        std::vector<TSPacket*> _batch;          // Postponed packets to scramble.
+        TSPacket*         _batch_error;         // First packet which failed to be scrambled in batch.
 
         // Return current/next CryptoPeriod for CW or ECM
         CryptoPeriod& currentCW()  { return _cp[_current_cw]; }
@@ -202,6 +206,12 @@ namespace ts {
         CryptoPeriod& currentECM() { return _cp[_current_ecm]; }
         CryptoPeriod& nextECM()    { return _cp[(_current_ecm + 1) & 0x01]; }
 
+        // Scramble a packet or postpone it in batch mode.
+        bool scramblePacket(TSPacket& pkt);
+
+        // Scramble all postponed packets.
+        bool flushPackets();
+
         // Perform CW and ECM transition
         bool changeCW();
         void changeECM();
@@ -264,7 +274,10 @@ ts::ScramblerPlugin::ScramblerPlugin(TSP* tsp_) :
     _current_cw(0),
     _current_ecm(0),
     _scrambling(*tsp),
-    _pzer_pmt(duck)
+    _pzer_pmt(duck),
+    _batch_mode(false),
+    _batch(),
+    _batch_error(nullptr)
 {
     // We need to define character sets to specify service names.
     duck.defineArgsForCharset(*this);
@@ -494,6 +507,14 @@ bool ts::ScramblerPlugin::stop()
 {
     // Disconnect from ECMG
     if (_ecmg.isConnected()) {
+        if (tsp->verbose()) {
+            ECMGClient::LatencyStatistics stats;
+            _ecmg.getLatencyStatistics(stats);
+            if (stats.count > 0) {
+                tsp->verbose(u"ECMG latency over %'d ECM's: min: %'d us, median: %'d us, 90%%: %'d us, 99%%: %'d us, max: %'d us",
+                             {stats.count, stats.min, stats.p50, stats.p90, stats.p99, stats.max});
+            }
+        }
         _ecmg.disconnect();
     }
 
@@ -683,6 +704,11 @@ bool ts::ScramblerPlugin::tryExitDegradedMode()
 
 bool ts::ScramblerPlugin::changeCW()
 {
+    // Packets which were postponed in the current batch use the previous CW.
+    if (!flushPackets()) {
+        return false;
+    }
+
     if (_scrambling.hasFixedCW()) {
         // A list of fixed CW was loaded from a file.
 
@@ -849,7 +875,7 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
     }
 
     // Scramble the packet payload.
-    if (!_scrambling.encrypt(pkt)) {
+    if (!scramblePacket(pkt)) {
         return TSP_END;
     }
     _scrambled_count++;
@@ -858,6 +884,59 @@ ts::ProcessorPlugin::Status ts::ScramblerPlugin::processPacket(TSPacket& pkt, TS
 }
 
 
+//----------------------------------------------------------------------------
+// Packet batch processing method.
+//----------------------------------------------------------------------------
+
+bool ts::ScramblerPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // All packets to scramble in the batch are collected and scrambled together,
+    // which is much faster with DVB-CSA2. They are flushed before any CW change.
+    _batch_mode = true;
+    _batch_error = nullptr;
+    for (size_t i = 0; i < count; ++i) {
+        status[i] = processPacket(pkt[i], pkt_data[i]);
+        if (status[i] == TSP_END) {
+            break;
+        }
+    }
+    _batch_mode = false;
+    flushPackets();
+
+    // If some packets could not be scrambled, stop before the first one.
+    if (_batch_error != nullptr) {
+        status[_batch_error - pkt] = TSP_END;
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Scramble a packet or postpone it in batch mode.
+//----------------------------------------------------------------------------
+
+bool ts::ScramblerPlugin::scramblePacket(TSPacket& pkt)
+{
+    if (_batch_mode) {
+        _batch.push_back(&pkt);
+        return true;
+    }
+    else {
+        return _scrambling.encrypt(pkt);
+    }
+}
+
+bool ts::ScramblerPlugin::flushPackets()
+{
+    const bool ok = _batch.empty() || _scrambling.encrypt(_batch.data(), _batch.size());
+    if (!ok && _batch_error == nullptr) {
+        _batch_error = _batch.front();
+    }
+    _batch.clear();
+    return ok;
+}
+
+
 //----------------------------------------------------------------------------
 // CryptoPeriod default constructor.
 //----------------------------------------------------------------------------
@@ -63,6 +63,7 @@ namespace ts {
         // Implementation of AbstractTablePlugin.
         virtual void createNewTable(BinaryTable& table) override;
         virtual void modifyTable(BinaryTable& table, bool& is_target, bool& reinsert) override;
+        virtual bool patchTable(const BinaryTable& intable, BinaryTable& table, bool& is_target, bool& reinsert) override;
     };
 }
 
@@ -300,3 +301,86 @@ void ts::SDTPlugin::modifyTable(BinaryTable& table, bool& is_target, bool& reins
     // Reserialize modified SDT.
     sdt.serialize(duck, table);
 }
+
+
+//----------------------------------------------------------------------------
+// Invoked by the superclass to try a binary patch of a table.
+//----------------------------------------------------------------------------
+
+bool ts::SDTPlugin::patchTable(const BinaryTable& intable, BinaryTable& table, bool&, bool&)
+{
+    // The TS id, the original network id and the flags of an existing service can be patched.
+    // Names, providers and service types are in a service_descriptor of variable size.
+    // All other modifications change the structure of the SDT.
+    const bool target =
+        (!_use_other && intable.tableId() == TID_SDT_ACT) ||
+        (_use_other && intable.tableId() == TID_SDT_OTH && intable.tableIdExtension() == _other_ts_id);
+    if (!target || _service.hasName() || _service.hasProvider() || _service.hasTypeDVB() || _cleanup_priv_desc) {
+        return false;
+    }
+
+    // Locate all services in the binary SDT.
+    // Index: service id, value: section index and offset of service entry in section.
+    std::map<uint16_t, std::pair<size_t, size_t>> location;
+    for (size_t si = 0; si < intable.sectionCount(); ++si) {
+        const SectionPtr& sect(intable.sectionAt(si));
+        if (sect.isNull() || !sect->isValid() || sect->payloadSize() < 3) {
+            return false;
+        }
+        const uint8_t* const data = sect->payload();
+        const size_t size = sect->payloadSize();
+        size_t pos = 3;
+        while (pos + 5 <= size) {
+            if (!location.insert(std::make_pair(GetUInt16(data + pos), std::make_pair(si, sect->headerSize() + pos))).second) {
+                return false; // duplicated service, let the full decoding cleanup the SDT.
+            }
+            pos += 5 + (GetUInt16(data + pos + 3) & 0x0FFF);
+        }
+        if (pos != size) {
+            return false; // invalid SDT, let the full decoding report it.
+        }
+    }
+
+    // Creating or removing services modifies the structure of the SDT.
+    if (_service.hasId() && location.find(_service.getId()) == location.end()) {
+        return false;
+    }
+    for (std::vector<uint16_t>::const_iterator it = _remove_serv.begin(); it != _remove_serv.end(); ++it) {
+        if (location.find(*it) != location.end()) {
+            return false;
+        }
+    }
+
+    // Patch a private copy of the SDT.
+    table.copy(intable);
+    if (_service.hasTSId()) {
+        table.patchTableIdExtension(_service.getTSId());
+    }
+    if (_service.hasONId()) {
+        for (size_t si = 0; si < table.sectionCount(); ++si) {
+            const SectionPtr& sect(table.sectionAt(si));
+            sect->patchUInt16(sect->headerSize(), _service.getONId());
+        }
+    }
+    if (_service.hasId()) {
+        const std::pair<size_t, size_t>& loc(location[_service.getId()]);
+        const SectionPtr& sect(table.sectionAt(loc.first));
+        uint8_t flags = sect->content()[loc.second + 2];
+        uint16_t status = GetUInt16(sect->content() + loc.second + 3);
+        if (_service.hasEITsPresent()) {
+            flags = (flags & ~0x02) | (_service.getEITsPresent() ? 0x02 : 0x00);
+        }
+        if (_service.hasEITpfPresent()) {
+            flags = (flags & ~0x01) | (_service.getEITpfPresent() ? 0x01 : 0x00);
+        }
+        if (_service.hasRunningStatus()) {
+            status = (status & 0x1FFF) | uint16_t((_service.getRunningStatus() & 0x07) << 13);
+        }
+        if (_service.hasCAControlled()) {
+            status = (status & ~0x1000) | (_service.getCAControlled() ? 0x1000 : 0x0000);
+        }
+        sect->patchUInt8(loc.second + 2, flags);
+        sect->patchUInt16(loc.second + 3, status);
+    }
+    return true;
+}
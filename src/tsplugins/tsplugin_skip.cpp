@@ -49,6 +49,7 @@ namespace ts {
         SkipPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         PacketCounter skip_count;
@@ -102,3 +103,19 @@ ts::ProcessorPlugin::Status ts::SkipPlugin::processPacket(TSPacket& pkt, TSPacke
         return use_stuffing ? TSP_NULL : TSP_DROP;
     }
 }
+
+
+//----------------------------------------------------------------------------
+// Packet batch processing method
+//----------------------------------------------------------------------------
+
+bool ts::SkipPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // Only the leading packets need to be updated, all others are TSP_OK.
+    const Status skip_status = use_stuffing ? TSP_NULL : TSP_DROP;
+    for (size_t i = 0; i < count && skip_count > 0; ++i) {
+        status[i] = skip_status;
+        skip_count--;
+    }
+    return true;
+}
@@ -79,9 +79,10 @@ ts::TimeShiftPlugin::TimeShiftPlugin (TSP* tsp_) :
 {
     option(u"directory", 0, STRING);
     help(u"directory", u"path",
-         u"Specify a directory where the temporary buffer file is created. "
+         u"Specify a directory where the temporary buffer files are created. "
          u"By default, the system-specific area for temporary files is used. "
-         u"The temporary file is hidden and automatically deleted on termination. "
+         u"The buffer is stored in a rotating set of segment files which are automatically deleted on termination. "
+         u"All disk I/O are performed in the background by a dedicated thread. "
          u"Specifying another location can be useful to redirect very large buffers to another disk. "
          u"If the reserved memory area is large enough to hold the buffer, no file is created.");
 
@@ -93,7 +94,8 @@ ts::TimeShiftPlugin::TimeShiftPlugin (TSP* tsp_) :
     option(u"memory-packets", 'm', UNSIGNED);
     help(u"memory-packets",
          u"Specify the number of packets which are cached in memory. "
-         u"Having a larger memory cache improves the performances. "
+         u"Having a larger memory cache improves the performances and absorbs the latency of the disk. "
+         u"The total memory usage of the buffer never exceeds this number of packets. "
          u"By default, the size of the memory cache is " +
          UString::Decimal(TimeShiftBuffer::DEFAULT_MEMORY_PACKETS) + u" packets.");
 
@@ -102,6 +104,12 @@ ts::TimeShiftPlugin::TimeShiftPlugin (TSP* tsp_) :
          u"Specify the size of the time-shift buffer in packets. "
          u"There is no default, the size of the buffer shall be specified either using --packets or --time.");
 
+    option(u"segment-packets", 's', UNSIGNED);
+    help(u"segment-packets",
+         u"Specify the maximum number of packets in each segment file on disk. "
+         u"By default, a segment file contains up to " +
+         UString::Decimal(TimeShiftBuffer::DEFAULT_SEGMENT_PACKETS) + u" packets.");
+
     option(u"time", 't', UNSIGNED);
     help(u"time", u"milliseconds",
          u"Specify the size of the time-shift buffer in milliseconds. "
@@ -123,6 +131,7 @@ bool ts::TimeShiftPlugin::getOptions()
     const size_t packets = intValue<size_t>(u"packets", 0);
     _buffer.setBackupDirectory(value(u"directory"));
     _buffer.setMemoryPackets(intValue<size_t>(u"memory-packets", TimeShiftBuffer::DEFAULT_MEMORY_PACKETS));
+    _buffer.setSegmentPackets(intValue<size_t>(u"segment-packets", TimeShiftBuffer::DEFAULT_SEGMENT_PACKETS));
 
     if ((packets > 0 && _time_shift_ms > 0) || (packets == 0 && _time_shift_ms == 0)) {
         tsp->error(u"specify exactly one of --packets and --time for time-shift buffer sizing");
@@ -50,6 +50,7 @@ namespace ts {
         UntilPlugin(TSP*);
         virtual bool start() override;
         virtual Status processPacket(TSPacket&, TSPacketMetadata&) override;
+        virtual bool processPacketBatch(TSPacket*, TSPacketMetadata*, size_t, Status*) override;
 
     private:
         bool           _exclude_last;     // Exclude packet which triggers the condition
@@ -64,6 +65,9 @@ namespace ts {
         bool           _started;          // First packet was received
         bool           _terminated;       // Final condition is met
         bool           _transparent;      // Pass all packets, no longer check conditions
+
+        // Check one packet, index is the packet index in the plugin.
+        Status checkPacket(const TSPacket& pkt, PacketCounter index);
     };
 }
 
@@ -151,6 +155,23 @@ bool ts::UntilPlugin::start()
 //----------------------------------------------------------------------------
 
 ts::ProcessorPlugin::Status ts::UntilPlugin::processPacket(TSPacket& pkt, TSPacketMetadata& pkt_data)
+{
+    return checkPacket(pkt, tsp->pluginPackets());
+}
+
+bool ts::UntilPlugin::processPacketBatch(TSPacket* pkt, TSPacketMetadata* pkt_data, size_t count, Status* status)
+{
+    // Once transparent, all packets are passed.
+    const PacketCounter first = tsp->pluginPackets();
+    for (size_t i = 0; i < count && !_transparent; ++i) {
+        if ((status[i] = checkPacket(pkt[i], first + i)) == TSP_END) {
+            break;
+        }
+    }
+    return true;
+}
+
+ts::ProcessorPlugin::Status ts::UntilPlugin::checkPacket(const TSPacket& pkt, PacketCounter index)
 {
     // Check if no longer check condition
     if (_transparent) {
@@ -186,7 +207,7 @@ ts::ProcessorPlugin::Status ts::UntilPlugin::processPacket(TSPacket& pkt, TSPack
 
     // Check if the packet matches one of the selected conditions
     _terminated =
-        (_pack_max > 0 && tsp->pluginPackets() + 1 >= _pack_max) ||
+        (_pack_max > 0 && index + 1 >= _pack_max) ||
         (_null_seq_max > 0 && _null_seq_cnt >= _null_seq_max) ||
         (_unit_start_max > 0 && _unit_start_cnt >= _unit_start_max) ||
         (_msec_max && Time::CurrentUTC() - _start_time >= _msec_max);
@@ -34,12 +34,20 @@
 #include "tsMain.h"
 #include "tsTSAnalyzerReport.h"
 #include "tsTSAnalyzerOptions.h"
-#include "tsInputRedirector.h"
+#include "tsTSFileReadArgs.h"
 #include "tsPagerArgs.h"
 #include "tsDuckContext.h"
+#include "tsSysUtils.h"
+#include "tsThread.h"
+#include "tsGuard.h"
 TSDUCK_SOURCE;
 TS_MAIN(MainCode);
 
+// Number of packets which are preloaded before a chunk of input in parallel analysis.
+// This is the window in which the PSI structure and the sections or PES packets
+// which overlap the start of the chunk are collected.
+#define PRELOAD_PACKETS 100000
+
 
 //----------------------------------------------------------------------------
 //  Command line options
@@ -54,28 +62,36 @@ namespace {
 
         ts::DuckContext       duck;      // TSDuck execution context.
         ts::BitRate           bitrate;   // Expected bitrate (188-byte packets)
-        ts::UString           infile;    // Input file name
+        ts::UStringVector     infiles;   // Input file names
+        size_t                threads;   // Number of analysis threads
         ts::TSAnalyzerOptions analysis;  // Analysis options.
         ts::PagerArgs         pager;     // Output paging options.
+        ts::TSFileReadArgs    read;      // Input file read mode.
     };
 }
 
 Options::Options(int argc, char *argv[]) :
-    ts::Args(u"Analyze the structure of a transport stream", u"[options] [filename]"),
+    ts::Args(u"Analyze the structure of a transport stream", u"[options] [filename ...]"),
     duck(this),
     bitrate(0),
-    infile(),
+    infiles(),
+    threads(1),
     analysis(),
-    pager(true, true)
+    pager(true, true),
+    read()
 {
     // Define all standard analysis options.
     duck.defineArgsForStandards(*this);
     duck.defineArgsForCharset(*this);
     pager.defineArgs(*this);
     analysis.defineArgs(*this);
+    read.defineArgs(*this);
 
-    option(u"", 0, STRING, 0, 1);
-    help(u"", u"Input MPEG capture file (standard input if omitted).");
+    option(u"", 0, STRING, 0, UNLIMITED_COUNT);
+    help(u"",
+         u"Input MPEG capture files (standard input if omitted). "
+         u"When several files are specified, they are analyzed as one single "
+         u"transport stream, made of the concatenation of all files.");
 
     option(u"bitrate", 'b', UNSIGNED);
     help(u"bitrate",
@@ -83,20 +99,285 @@ Options::Options(int argc, char *argv[]) :
          u"(based on 188-byte packets). By default, the bitrate is "
          u"evaluated using the PCR in the transport stream.");
 
+    option(u"threads", 0, INTEGER, 0, 1, 1, 1024);
+    help(u"threads", u"count",
+         u"Number of threads which analyze the input files in parallel. "
+         u"The input files are split into chunks, at packet boundaries, which are analyzed "
+         u"in parallel. The analyses of all chunks are then merged into one single report, "
+         u"identical to a sequential analysis, except for the detection of suspect packets "
+         u"(see option --suspect-min-error-count) which is performed in each chunk independently. "
+         u"Parallel analysis is possible on regular files only, not on the standard input. "
+         u"The default is 1 (sequential analysis).");
+
     analyze(argc, argv);
 
     // Define all standard analysis options.
     duck.loadArgs(*this);
     pager.loadArgs(duck, *this);
     analysis.loadArgs(duck, *this);
+    read.loadArgs(duck, *this);
 
-    infile = value(u"");
+    getValues(infiles, u"");
     bitrate = intValue<ts::BitRate>(u"bitrate");
+    threads = intValue<size_t>(u"threads", 1);
 
     exitOnError();
 }
 
 
+//----------------------------------------------------------------------------
+//  Description of an input file.
+//----------------------------------------------------------------------------
+
+namespace {
+    class InputFile
+    {
+    public:
+        ts::UString                  name;         // File name, empty for standard input.
+        ts::TSFile::PacketFormat     format;       // Packet format.
+        size_t                       packet_size;  // Packet size in the file, including header.
+        uint64_t                     packet_count; // Number of packets, zero if unknown.
+
+        // Constructor.
+        InputFile(const ts::UString& file_name = ts::UString()) :
+            name(file_name),
+            format(ts::TSFile::FMT_AUTODETECT),
+            packet_size(ts::PKT_SIZE),
+            packet_count(0)
+        {
+        }
+
+        // Get the packet format and packet count of a file.
+        bool getCharacteristics(Options& opt);
+
+        // Read a range of packets from the file and pass them to an analyzer.
+        // A zero count means up to the end of file.
+        bool analyze(Options& opt, ts::TSAnalyzer& analyzer, uint64_t first = 0, uint64_t count = 0, bool preload = false) const;
+    };
+}
+
+bool InputFile::getCharacteristics(Options& opt)
+{
+    // Read the first packet to get the packet format.
+    ts::TSFile file;
+    ts::TSPacket pkt;
+    opt.read.apply(file);
+    if (!file.openRead(name, 1, 0, opt)) {
+        return false;
+    }
+    file.readPackets(&pkt, nullptr, 1, opt);
+    format = file.packetFormat();
+    packet_size = ts::PKT_SIZE + file.packetHeaderSize();
+    file.close(opt);
+
+    // Files which are not regular files cannot be split.
+    const int64_t size = ts::GetFileSize(name);
+    packet_count = size < 0 ? 0 : uint64_t(size) / packet_size;
+    return true;
+}
+
+bool InputFile::analyze(Options& opt, ts::TSAnalyzer& analyzer, uint64_t first, uint64_t count, bool preload) const
+{
+    ts::TSFile file;
+    ts::TSPacketVector buffer(1024);
+    uint64_t remain = count == 0 ? std::numeric_limits<uint64_t>::max() : count;
+    size_t ret = 0;
+
+    opt.read.apply(file);
+    if (!file.openRead(name, 1, first * packet_size, opt, format)) {
+        return false;
+    }
+    while (remain > 0 && (ret = file.readPackets(buffer.data(), nullptr, size_t(std::min<uint64_t>(remain, buffer.size())), opt)) > 0) {
+        for (size_t i = 0; i < ret; ++i) {
+            if (preload) {
+                analyzer.preloadPacket(buffer[i]);
+            }
+            else {
+                analyzer.feedPacket(buffer[i]);
+            }
+        }
+        remain -= ret;
+    }
+    return file.close(opt);
+}
+
+
+//----------------------------------------------------------------------------
+//  A chunk of input, for parallel analysis.
+//----------------------------------------------------------------------------
+
+namespace {
+    class Chunk
+    {
+        TS_NOBUILD_NOCOPY(Chunk);
+    public:
+        const InputFile* file;           // Input file.
+        uint64_t         first;          // Index of first packet in file.
+        uint64_t         count;          // Number of packets, zero up to end of file.
+        const InputFile* preload_file;   // File containing the preloaded packets, if any.
+        uint64_t         preload_first;  // Index of first preloaded packet.
+        uint64_t         preload_count;  // Number of preloaded packets.
+        ts::DuckContext  duck;           // Private TSDuck context of the analysis.
+        ts::TSAnalyzer   analyzer;       // Analysis of the chunk.
+        bool             success;        // Analysis was successful.
+
+        // Constructor.
+        Chunk(Options& opt, const ts::DuckContext::SavedArgs& args, const InputFile* f, uint64_t start, uint64_t size);
+
+        // Analyze the chunk.
+        void analyze(Options& opt);
+    };
+
+    typedef ts::SafePtr<Chunk> ChunkPtr;
+    typedef std::vector<ChunkPtr> ChunkPtrVector;
+}
+
+Chunk::Chunk(Options& opt, const ts::DuckContext::SavedArgs& args, const InputFile* f, uint64_t start, uint64_t size) :
+    file(f),
+    first(start),
+    count(size),
+    preload_file(nullptr),
+    preload_first(0),
+    preload_count(0),
+    duck(&opt),
+    analyzer(duck, opt.bitrate),
+    success(false)
+{
+    duck.restoreArgs(args);
+    analyzer.setMinErrorCountBeforeSuspect(opt.analysis.suspect_min_error_count);
+    analyzer.setMaxConsecutiveSuspectCount(opt.analysis.suspect_max_consecutive);
+}
+
+void Chunk::analyze(Options& opt)
+{
+    success = (preload_count == 0 || preload_file->analyze(opt, analyzer, preload_first, preload_count, true)) &&
+              file->analyze(opt, analyzer, first, count);
+}
+
+
+//----------------------------------------------------------------------------
+//  A thread which analyzes chunks of input.
+//----------------------------------------------------------------------------
+
+namespace {
+    class AnalysisThread: public ts::Thread
+    {
+        TS_NOBUILD_NOCOPY(AnalysisThread);
+    public:
+        // Constructor and destructor.
+        AnalysisThread(Options& opt, ChunkPtrVector& chunks, size_t& next, ts::Mutex& mutex);
+        virtual ~AnalysisThread() override;
+
+    private:
+        Options&        _opt;
+        ChunkPtrVector& _chunks;
+        size_t&         _next;   // Index of next chunk to analyze, shared by all threads.
+        ts::Mutex&      _mutex;  // Protect _next.
+
+        // Implementation of Thread.
+        virtual void main() override;
+    };
+}
+
+AnalysisThread::AnalysisThread(Options& opt, ChunkPtrVector& chunks, size_t& next, ts::Mutex& mutex) :
+    ts::Thread(ts::ThreadAttributes()),
+    _opt(opt),
+    _chunks(chunks),
+    _next(next),
+    _mutex(mutex)
+{
+}
+
+AnalysisThread::~AnalysisThread()
+{
+    waitForTermination();
+}
+
+void AnalysisThread::main()
+{
+    for (;;) {
+        size_t index = 0;
+        {
+            ts::Guard lock(_mutex);
+            if (_next >= _chunks.size()) {
+                break;
+            }
+            index = _next++;
+        }
+        _chunks[index]->analyze(_opt);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+//  Parallel analysis of all input files.
+//----------------------------------------------------------------------------
+
+namespace {
+    bool ParallelAnalysis(Options& opt, ts::TSAnalyzer& analyzer)
+    {
+        // Get the characteristics of all files.
+        std::vector<InputFile> files;
+        files.reserve(opt.infiles.size());
+        for (auto it = opt.infiles.begin(); it != opt.infiles.end(); ++it) {
+            files.push_back(InputFile(*it));
+            if (!files.back().getCharacteristics(opt)) {
+                return false;
+            }
+        }
+
+        // Split all files in chunks. Each chunk is preloaded with the packets which precede it
+        // (possibly from the previous file). Chunks are not smaller than the preloaded area.
+        ts::DuckContext::SavedArgs args;
+        opt.duck.saveArgs(args);
+        ChunkPtrVector chunks;
+        const uint64_t chunks_per_file = std::max<uint64_t>(1, opt.threads / files.size());
+        for (size_t fi = 0; fi < files.size(); ++fi) {
+            const InputFile& file(files[fi]);
+            const uint64_t total = file.packet_count;
+            const uint64_t nchunks = std::max<uint64_t>(1, std::min<uint64_t>(chunks_per_file, total / PRELOAD_PACKETS));
+            for (uint64_t ci = 0; ci < nchunks; ++ci) {
+                const uint64_t first = (total * ci) / nchunks;
+                const uint64_t count = ci + 1 == nchunks ? 0 : (total * (ci + 1)) / nchunks - first;
+                ChunkPtr chunk(new Chunk(opt, args, &file, first, count));
+                if (first > 0) {
+                    chunk->preload_file = &file;
+                    chunk->preload_count = std::min<uint64_t>(first, PRELOAD_PACKETS);
+                    chunk->preload_first = first - chunk->preload_count;
+                }
+                else if (fi > 0 && files[fi - 1].packet_count > 0) {
+                    chunk->preload_file = &files[fi - 1];
+                    chunk->preload_count = std::min<uint64_t>(files[fi - 1].packet_count, PRELOAD_PACKETS);
+                    chunk->preload_first = files[fi - 1].packet_count - chunk->preload_count;
+                }
+                chunks.push_back(chunk);
+            }
+        }
+        opt.debug(u"analyzing %d files in %d chunks using %d threads", {files.size(), chunks.size(), std::min(opt.threads, chunks.size())});
+
+        // Run the analysis threads. The destructors of the threads wait for their termination.
+        {
+            ts::Mutex mutex;
+            size_t next = 0;
+            std::vector<ts::SafePtr<AnalysisThread>> threads;
+            for (size_t i = 0; i < opt.threads && i < chunks.size(); ++i) {
+                threads.push_back(new AnalysisThread(opt, chunks, next, mutex));
+                threads.back()->start();
+            }
+        }
+
+        // Merge the analyses of all chunks, in stream order.
+        bool success = true;
+        for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+            success = success && (*it)->success;
+            analyzer.merge((*it)->analyzer);
+            opt.duck.addStandards((*it)->duck.standards());
+        }
+        return success;
+    }
+}
+
+
 //----------------------------------------------------------------------------
 //  Program entry point
 //----------------------------------------------------------------------------
@@ -105,14 +386,26 @@ int MainCode(int argc, char *argv[])
 {
     Options opt(argc, argv);
     ts::TSAnalyzerReport analyzer(opt.duck, opt.bitrate);
-    ts::InputRedirector input(opt.infile, opt);
-    ts::TSPacket pkt;
+    bool success = true;
 
     analyzer.setAnalysisOptions(opt.analysis);
 
-    // Read input file and perform analysis.
-    while (pkt.read(std::cin, true, opt)) {
-        analyzer.feedPacket(pkt);
+    // Perform analysis.
+    if (opt.threads > 1 && !opt.infiles.empty()) {
+        success = ParallelAnalysis(opt, analyzer);
+    }
+    else if (opt.infiles.empty()) {
+        // Standard input.
+        success = InputFile().analyze(opt, analyzer);
+    }
+    else {
+        // Sequential analysis of all files.
+        for (auto it = opt.infiles.begin(); success && it != opt.infiles.end(); ++it) {
+            success = InputFile(*it).analyze(opt, analyzer);
+        }
+    }
+    if (!success) {
+        return EXIT_FAILURE;
     }
 
     // Report analysis.
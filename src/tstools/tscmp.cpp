@@ -34,6 +34,8 @@
 #include "tsMain.h"
 #include "tsMemory.h"
 #include "tsTSFileInputBuffered.h"
+#include "tsTSFileReadArgs.h"
+#include "tsDuckContext.h"
 #include "tsBinaryTable.h"
 #include "tsSection.h"
 #include "tsPMT.h"
@@ -55,6 +57,8 @@ namespace {
     public:
         Options(int argc, char *argv[]);
 
+        ts::DuckContext    duck;
+        ts::TSFileReadArgs read;
         ts::UString filename1;
         ts::UString filename2;
         uint64_t    byte_offset;
@@ -75,6 +79,8 @@ namespace {
 
 Options::Options(int argc, char *argv[]) :
     Args(u"Compare two transport stream files", u"[options] filename-1 filename-2"),
+    duck(this),
+    read(),
     filename1(),
     filename2(),
     byte_offset(0),
@@ -147,8 +153,11 @@ Options::Options(int argc, char *argv[]) :
          u"different and the first file is read ahead. The default is zero, which "
          u"means that two packets must be strictly identical to declare them equal.");
 
+    read.defineArgs(*this);
+
     analyze(argc, argv);
 
+    read.loadArgs(duck, *this);
     getValue(filename1, u"", u"", 0);
     getValue(filename2, u"", u"", 1);
 
@@ -304,6 +313,8 @@ int MainCode(int argc, char *argv[])
     ts::TSFileInputBuffered file2(opt.buffered_packets);
 
     // Open files
+    opt.read.apply(file1);
+    opt.read.apply(file2);
     file1.openRead(opt.filename1, 1, opt.byte_offset, opt);
     file2.openRead(opt.filename2, 1, opt.byte_offset, opt);
     opt.exitOnError();
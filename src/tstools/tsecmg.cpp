@@ -36,11 +36,16 @@
 #include "tsAsyncReport.h"
 #include "tsFatal.h"
 #include "tsMutex.h"
+#include "tsCondition.h"
+#include "tsGuardCondition.h"
 #include "tsThread.h"
+#include "tsMessageQueue.h"
+#include "tsMonotonic.h"
 #include "tsSysUtils.h"
 #include "tsECMGSCS.h"
 #include "tsTCPServer.h"
 #include "tstlvConnection.h"
+#include "tstlvMessageFactory.h"
 #include "tsDuckProtocol.h"
 #include "tsVariable.h"
 #include "tsOneShotPacketizer.h"
@@ -55,10 +60,14 @@ namespace {
     static const int16_t  DEFAULT_DELAY_STOP        = 200;
     static const int16_t  DEFAULT_TRANS_DELAY_START = -500;
     static const int16_t  DEFAULT_TRANS_DELAY_STOP  = 0;
+    static const size_t   DEFAULT_WORKER_THREADS    = 4;
 
-    // Stack size for execution of the client connection thread
+    // Stack size for execution of the client connection and worker threads
     static const size_t CLIENT_STACK_SIZE = 128 * 1024;
 
+    // Size of one read operation on a client connection in event loop mode.
+    static const size_t READ_SIZE = 65536;
+
     // Instantiation of a TCP connection in a multi-thread context for TLV messages.
     typedef ts::tlv::Connection<ts::Mutex> ECMGConnection;
     typedef ts::SafePtr<ECMGConnection, ts::Mutex> ECMGConnectionPtr;
@@ -80,7 +89,10 @@ namespace {
         int                        log_protocol;   // Log level for ECMG <=> SCS protocol.
         int                        log_data;       // Log level for CW/ECM data messages.
         bool                       once;           // Accept only one client.
+        size_t                     maxSessions;    // Max number of client sessions in event loop mode, zero means unlimited.
         bool                       reusePort;      // Socket option.
+        bool                       eventLoop;      // Multiplex all clients in one event loop.
+        size_t                     workerThreads;  // Number of worker threads in event loop mode.
         ts::MilliSecond            ecmCompTime;    // ECM computation time.
         ts::SocketAddress          serverAddress;  // TCP server local address.
         ts::ecmgscs::ChannelStatus channelStatus;  // Standard parameters required by this ECMG.
@@ -94,7 +106,10 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
     log_protocol(ts::Severity::Debug),
     log_data(ts::Severity::Debug),
     once(false),
+    maxSessions(0),
     reusePort(false),
+    eventLoop(false),
+    workerThreads(0),
     ecmCompTime(0),
     serverAddress(),
     channelStatus(),
@@ -139,6 +154,16 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
          u"Specify the version of the ECMG <=> SCS DVB SimulCrypt protocol. "
          u"Valid values are 2 and 3. The default is 2.");
 
+    option(u"event-loop", 0);
+    help(u"event-loop",
+         u"Use one event loop to wait for messages on all client connections, instead "
+         u"of one thread per connection. The messages are processed by a small pool of "
+         u"worker threads (see --worker-threads) and the ECM responses are delayed by "
+         u"timers instead of blocking the connection during the computation time (see "
+         u"--comp-time). This mode scales to many connections and ECM streams. "
+         u"In both modes, the latency statistics of the ECM's are reported for each "
+         u"channel in verbose mode when the channel is closed.");
+
     option(u"log-data", 0, ts::Severity::Enums, 0, 1, true);
     help(u"log-data", u"level",
          u"Same as --log-protocol but applies to CW_provision and ECM_response "
@@ -151,6 +176,12 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
          u"option is not present, the messages are logged at debug level only. If the "
          u"option is present without value, the messages are logged at info level.");
 
+    option(u"max-sessions", 0, POSITIVE);
+    help(u"max-sessions",
+         u"With --event-loop, stop accepting connections after the specified number of "
+         u"clients and exit at the end of their sessions. By default, accept clients "
+         u"indefinitely. With --event-loop, --once is the same as --max-sessions 1.");
+
     option(u"max-comp-time", 0, UNSIGNED);
     help(u"max-comp-time",
          u"Specify the maximum ECM computation time in milliseconds. This option sets "
@@ -187,11 +218,19 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
          u"This option sets the DVB SimulCrypt option 'transition_delay_stop', in "
          u"milliseconds. Default: " + ts::UString::Decimal(DEFAULT_TRANS_DELAY_STOP) + u" ms.");
 
+    option(u"worker-threads", 0, POSITIVE);
+    help(u"worker-threads",
+         u"With --event-loop, specify the number of worker threads which process the "
+         u"client messages. Default: " + ts::UString::Decimal(DEFAULT_WORKER_THREADS) + u".");
+
     analyze(argc, argv);
 
     serverAddress.setPort(intValue<uint16_t>(u"port", DEFAULT_SERVER_PORT));
     once = present(u"once");
     reusePort = !present(u"no-reuse-port");
+    eventLoop = present(u"event-loop");
+    maxSessions = once ? 1 : intValue<size_t>(u"max-sessions", 0);
+    workerThreads = intValue<size_t>(u"worker-threads", DEFAULT_WORKER_THREADS);
     ecmCompTime = intValue<ts::MilliSecond>(u"comp-time", 0);
     log_protocol = present(u"log-protocol") ? intValue<int>(u"log-protocol", ts::Severity::Info) : ts::Severity::Debug;
     log_data = present(u"log-data") ? intValue<int>(u"log-data", ts::Severity::Info) : log_protocol;
@@ -223,6 +262,10 @@ ECMGOptions::ECMGOptions(int argc, char *argv[]) :
     channelStatus.min_CP_duration = 10;  // Minimum crypto period in 100 x ms, 1 second here.
     streamStatus.access_criteria_transfer_mode = false;  // We don't really need access criteria.
 
+    if (present(u"max-sessions") && !eventLoop) {
+        error(u"--max-sessions requires --event-loop");
+    }
+
     exitOnError();
 }
 
@@ -294,29 +337,309 @@ bool ECMGSharedData::closeChannel(uint16_t id)
 
 
 //----------------------------------------------------------------------------
-// A class implementing a thread which manages a client connection.
+// ECM latency statistics of a channel, from the reception of the
+// CW_provision to the transmission of the ECM_response.
 //----------------------------------------------------------------------------
 
-class ECMGClientHandler: public ts::Thread
+class ECMGLatency
 {
-    TS_NOBUILD_NOCOPY(ECMGClientHandler);
 public:
     // Constructor.
-    // When deleteWhenTerminated is true, this object is automatically deleted
-    // when the thread terminates.
-    ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated);
+    ECMGLatency() : _count(0), _min(0), _max(0), _total(0) {}
+
+    // Add a latency value.
+    void add(ts::NanoSecond latency);
+
+    // Number of values.
+    ts::PacketCounter count() const { return _count; }
+
+    // Reset the statistics.
+    void reset() { _count = _min = _max = _total = 0; }
+
+    // Format the statistics as a string.
+    ts::UString toString() const;
+
+private:
+    ts::PacketCounter _count;
+    ts::NanoSecond    _min;
+    ts::NanoSecond    _max;
+    ts::NanoSecond    _total;
+};
+
+// Add a latency value.
+void ECMGLatency::add(ts::NanoSecond latency)
+{
+    if (_count++ == 0) {
+        _min = _max = latency;
+    }
+    else {
+        _min = std::min(_min, latency);
+        _max = std::max(_max, latency);
+    }
+    _total += latency;
+}
+
+// Format the statistics as a string, in microseconds.
+ts::UString ECMGLatency::toString() const
+{
+    return ts::UString::Format(u"%'d ECM, latency min: %'d us, avg: %'d us, max: %'d us",
+                               {_count,
+                                _min / ts::NanoSecPerMicroSec,
+                                _count == 0 ? 0 : _total / ts::NanoSecond(_count) / ts::NanoSecPerMicroSec,
+                                _max / ts::NanoSecPerMicroSec});
+}
+
+
+//----------------------------------------------------------------------------
+// Output side of a client connection. Shared between the client session
+// and its delayed ECM responses which are sent later by the timer thread.
+//----------------------------------------------------------------------------
+
+class ECMGOutput
+{
+    TS_NOBUILD_NOCOPY(ECMGOutput);
+public:
+    // Constructor.
+    ECMGOutput(const ECMGConnectionPtr& conn, ECMGSharedData* shared);
+
+    // Send a message. Return false on error.
+    bool send(const ts::tlv::Message* msg);
+
+    // Send an ECM response and account for its latency. Return false on error.
+    // The response is dropped if the channel was closed since the given generation.
+    bool sendECM(const ts::ecmgscs::ECMResponse* msg, const ts::Monotonic& received, uint32_t generation);
+
+    // Current generation of the channel, incremented each time the channel is closed.
+    uint32_t channelGeneration();
+
+    // Close the channel: report and reset its ECM latency statistics, drop its delayed responses.
+    void closeChannel(const ts::UString& peer, uint16_t channel_id);
+
+    // Close the output, delayed responses are then dropped.
+    void close();
+
+private:
+    ts::Mutex         _mutex;    // Serialize sending and closing.
+    ECMGConnectionPtr _conn;
+    ECMGSharedData*   _shared;
+    bool              _closed;
+    uint32_t          _generation;  // Generation of the current channel.
+    ECMGLatency       _latency;     // Latency statistics of the current channel.
+};
+
+typedef ts::SafePtr<ECMGOutput, ts::Mutex> ECMGOutputPtr;
+
+// Constructor.
+ECMGOutput::ECMGOutput(const ECMGConnectionPtr& conn, ECMGSharedData* shared) :
+    _mutex(),
+    _conn(conn),
+    _shared(shared),
+    _closed(false),
+    _generation(0),
+    _latency()
+{
+}
+
+// Send a message.
+bool ECMGOutput::send(const ts::tlv::Message* msg)
+{
+    ts::Guard lock(_mutex);
+    return !_closed && _conn->send(*msg, _shared->logger());
+}
+
+// Send an ECM response and account for its latency.
+bool ECMGOutput::sendECM(const ts::ecmgscs::ECMResponse* msg, const ts::Monotonic& received, uint32_t generation)
+{
+    ts::Guard lock(_mutex);
+    if (generation != _generation) {
+        // Delayed response of a closed channel, silently dropped.
+        return true;
+    }
+    if (_closed || !_conn->send(*msg, _shared->logger())) {
+        return false;
+    }
+    _latency.add(ts::Monotonic(true) - received);
+    return true;
+}
+
+// Current generation of the channel.
+uint32_t ECMGOutput::channelGeneration()
+{
+    ts::Guard lock(_mutex);
+    return _generation;
+}
+
+// Close the channel.
+void ECMGOutput::closeChannel(const ts::UString& peer, uint16_t channel_id)
+{
+    ts::Guard lock(_mutex);
+    _generation++;
+    if (_latency.count() > 0) {
+        _shared->report().verbose(u"%s: channel %d: %s", {peer, channel_id, _latency.toString()});
+        _latency.reset();
+    }
+}
+
+// Close the output.
+void ECMGOutput::close()
+{
+    ts::Guard lock(_mutex);
+    _closed = true;
+}
+
+
+//----------------------------------------------------------------------------
+// A thread which sends the delayed ECM responses in event loop mode.
+// The ECM computation time is emulated without blocking any thread.
+//----------------------------------------------------------------------------
+
+class ECMGTimers: public ts::Thread
+{
+    TS_NOCOPY(ECMGTimers);
+public:
+    // Constructor.
+    ECMGTimers();
+
+    // Schedule an ECM response to be sent at a given time.
+    void schedule(const ECMGOutputPtr& output, const ts::ecmgscs::ECMResponse& resp, const ts::Monotonic& received, const ts::Monotonic& due);
+
+    // Terminate the thread.
+    void stop();
 
     // Main code of the thread.
     virtual void main() override;
 
+private:
+    // A delayed ECM response.
+    class Response
+    {
+    public:
+        ECMGOutputPtr               output;
+        ts::ecmgscs::ECMResponse    resp;
+        ts::Monotonic               received;
+        uint32_t                    generation;  // Channel generation when the request was received.
+        Response(const ECMGOutputPtr& out, const ts::ecmgscs::ECMResponse& msg, const ts::Monotonic& recv) :
+            output(out), resp(msg), received(recv), generation(out->channelGeneration()) {}
+    };
+
+    ts::Mutex     _mutex;      // Protect the queue.
+    ts::Condition _condition;  // Signaled when the earliest due time changes.
+    bool          _terminate;
+    std::multimap<ts::Monotonic, Response> _queue;  // Indexed by due time.
+};
+
+// Constructor.
+ECMGTimers::ECMGTimers() :
+    ts::Thread(),
+    _mutex(),
+    _condition(),
+    _terminate(false),
+    _queue()
+{
+}
+
+// Schedule an ECM response to be sent at a given time.
+void ECMGTimers::schedule(const ECMGOutputPtr& output, const ts::ecmgscs::ECMResponse& resp, const ts::Monotonic& received, const ts::Monotonic& due)
+{
+    ts::GuardCondition lock(_mutex, _condition);
+    const auto it = _queue.insert(std::make_pair(due, Response(output, resp, received)));
+    if (it == _queue.begin()) {
+        // New earliest response, wake up the thread to recompute its wait time.
+        lock.signal();
+    }
+}
+
+// Terminate the thread.
+void ECMGTimers::stop()
+{
+    ts::GuardCondition lock(_mutex, _condition);
+    _terminate = true;
+    lock.signal();
+}
+
+// Main code of the thread.
+void ECMGTimers::main()
+{
+    _mutex.acquire();
+    while (!_terminate) {
+        if (_queue.empty()) {
+            _condition.wait(_mutex, ts::Infinite);
+            continue;
+        }
+        const ts::NanoSecond wait = _queue.begin()->first - ts::Monotonic(true);
+        if (wait > 0) {
+            // Round up to the next millisecond to avoid a busy loop.
+            _condition.wait(_mutex, (wait + ts::NanoSecPerMilliSec - 1) / ts::NanoSecPerMilliSec);
+            continue;
+        }
+        // Send the response without holding the mutex, new responses can be scheduled meanwhile.
+        const Response resp(_queue.begin()->second);
+        _queue.erase(_queue.begin());
+        _mutex.release();
+        resp.output->sendECM(&resp.resp, resp.received, resp.generation);
+        _mutex.acquire();
+    }
+    _mutex.release();
+}
+
+
+//----------------------------------------------------------------------------
+// A class implementing the ECMG protocol for a client connection.
+// Used by one thread per connection or by the event loop worker threads.
+//----------------------------------------------------------------------------
+
+class ECMGSession
+{
+    TS_NOBUILD_NOCOPY(ECMGSession);
+public:
+    // Constructor. The timers are used in event loop mode only, null otherwise.
+    ECMGSession(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, ECMGTimers* timers);
+
+    // Get the client connection.
+    const ECMGConnectionPtr& connection() const { return _conn; }
+
+    // Start and end the session.
+    void start();
+    void end();
+
+    // Handle a message from the client. Return false on error, the session must be closed.
+    bool handleMessage(const ts::tlv::MessagePtr& msg, const ts::Monotonic& received);
+
+    // Event loop mode: read the data which are available on the connection and queue the complete messages.
+    // The read buffer is owned by the event loop and shared by all sessions. Only an incomplete
+    // message at end of buffer is kept in the session until the next read.
+    // Return false on disconnection. The session must be queued to the workers when 'schedule' is true.
+    bool receiveAvailable(ts::ByteBlock& buffer, bool& schedule);
+
+    // Event loop mode: queue the end of session after disconnection. Return true when the session must be queued to the workers.
+    bool postEnd();
+
+    // Event loop mode: process all queued messages in a worker thread.
+    void processMessages();
+
 private:
     const ECMGOptions&          _opt;
     ECMGSharedData*             _shared;
+    ECMGTimers*                 _timers;
     ECMGConnectionPtr           _conn;
+    ECMGOutputPtr               _output;
     ts::UString                 _peer;
     ts::Variable<uint16_t>      _channel;  // Current channel id.
     std::map<uint16_t,uint16_t> _streams;  // Map of current stream id => ECM id.
 
+    // Event loop mode: messages from the client, waiting for a worker thread.
+    // A null message means end of session.
+    typedef std::pair<ts::tlv::MessagePtr, ts::Monotonic> PendingMessage;
+    ts::Mutex                   _mutex;    // Protect the fields below.
+    std::list<PendingMessage>   _pending;  // Received messages, not yet processed.
+    bool                        _queued;   // The session is queued to the workers or being processed.
+    bool                        _failed;   // Error on the connection, ignore subsequent messages.
+    ts::ByteBlock               _input;    // Incomplete input message (event loop thread only).
+    size_t                      _invalid;  // Number of consecutive invalid messages (event loop thread only).
+
+    // Queue one message from the client.
+    bool post(const ts::tlv::MessagePtr& msg, const ts::Monotonic& received);
+
     // Handle the various ECMG client messages.
     bool handleChannelSetup(ts::ecmgscs::ChannelSetup* msg);
     bool handleChannelTest(ts::ecmgscs::ChannelTest* msg);
@@ -324,12 +647,12 @@ private:
     bool handleStreamSetup(ts::ecmgscs::StreamSetup* msg);
     bool handleStreamTest(ts::ecmgscs::StreamTest* msg);
     bool handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg);
-    bool handleCWProvision(ts::ecmgscs::CWProvision* msg);
+    bool handleCWProvision(ts::ecmgscs::CWProvision* msg, const ts::Monotonic& received);
 
     // Send a response message.
     bool send(const ts::tlv::Message* msg)
     {
-        return _conn->send(*msg, _shared->logger());
+        return _output->send(msg);
     }
 
     // Send an error related to the msg.
@@ -342,87 +665,52 @@ private:
     }
 };
 
+typedef ts::SafePtr<ECMGSession, ts::Mutex> ECMGSessionPtr;
+
 
 //----------------------------------------------------------------------------
-// ECMG client constructor.
+// ECMG session constructor.
 //----------------------------------------------------------------------------
 
-ECMGClientHandler::ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated) :
-    ts::Thread(),
+ECMGSession::ECMGSession(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, ECMGTimers* timers) :
     _opt(opt),
     _shared(shared),
+    _timers(timers),
     _conn(conn),
+    _output(new ECMGOutput(conn, shared)),
     _peer(),
     _channel(),
-    _streams()
+    _streams(),
+    _mutex(),
+    _pending(),
+    _queued(false),
+    _failed(false),
+    _input(),
+    _invalid(0)
 {
-    // Set thread attributes. Beware of deleteWhenTerminated...
-    ts::ThreadAttributes attr;
-    attr.setStackSize(CLIENT_STACK_SIZE);
-    attr.setDeleteWhenTerminated(deleteWhenTerminated);
-    setAttributes(attr);
 }
 
 
 //----------------------------------------------------------------------------
-// Main code of the client connection thread.
+// Start and end the session.
 //----------------------------------------------------------------------------
 
-void ECMGClientHandler::main()
+void ECMGSession::start()
 {
     _peer = _conn->peerName();
     _shared->report().verbose(u"%s: %s: session started", {_peer, TimeStamp()});
+}
 
-    // Normally, an ECMG should handle incoming and outgoing messages independently.
-    // However, here we have a minimal implementation. We never send any request to
-    // the client and the ECM generation is instantaneous. So, we simply wait for
-    // requests from the client and respond to them immediately.
-
-    // Loop on message reception
-    ts::tlv::MessagePtr msg;
-    bool ok = true;
-    while (ok && _conn->receive(msg, nullptr, _shared->logger())) {
-        switch (msg->tag()) {
-            case ts::ecmgscs::Tags::channel_setup:
-                ok = handleChannelSetup(dynamic_cast<ts::ecmgscs::ChannelSetup*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::channel_test:
-                ok = handleChannelTest(dynamic_cast<ts::ecmgscs::ChannelTest*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::channel_close:
-                ok = handleChannelClose(dynamic_cast<ts::ecmgscs::ChannelClose*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::stream_setup:
-                ok = handleStreamSetup(dynamic_cast<ts::ecmgscs::StreamSetup*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::stream_test:
-                ok = handleStreamTest(dynamic_cast<ts::ecmgscs::StreamTest*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::stream_close_request:
-                ok = handleStreamCloseRequest(dynamic_cast<ts::ecmgscs::StreamCloseRequest*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::CW_provision:
-                ok = handleCWProvision(dynamic_cast<ts::ecmgscs::CWProvision*>(msg.pointer()));
-                break;
-            case ts::ecmgscs::Tags::channel_status:
-            case ts::ecmgscs::Tags::stream_status:
-            case ts::ecmgscs::Tags::channel_error:
-            case ts::ecmgscs::Tags::stream_error:
-                // Silently ignore unsollicited status or error messages.
-                break;
-            default:
-                // Received an invalid message for ECMG.
-                ok = sendErrorResponse(msg.pointer(), ts::ecmgscs::Errors::inv_message);
-                break;
-        }
-    }
-
+void ECMGSession::end()
+{
     // Error while receiving or sending messages, most likely a client disconnection.
+    _output->close();
     _conn->disconnect(NULLREP);
     _conn->close(_shared->report());
 
     // Make sure to release the channel if not done by the clients.
     if (_channel.set()) {
+        _output->closeChannel(_peer, _channel.value());
         _shared->closeChannel(_channel.value());
         _channel.reset();
     }
@@ -431,11 +719,153 @@ void ECMGClientHandler::main()
 }
 
 
+//----------------------------------------------------------------------------
+// Handle a message from the client.
+//----------------------------------------------------------------------------
+
+bool ECMGSession::handleMessage(const ts::tlv::MessagePtr& msg, const ts::Monotonic& received)
+{
+    switch (msg->tag()) {
+        case ts::ecmgscs::Tags::channel_setup:
+            return handleChannelSetup(dynamic_cast<ts::ecmgscs::ChannelSetup*>(msg.pointer()));
+        case ts::ecmgscs::Tags::channel_test:
+            return handleChannelTest(dynamic_cast<ts::ecmgscs::ChannelTest*>(msg.pointer()));
+        case ts::ecmgscs::Tags::channel_close:
+            return handleChannelClose(dynamic_cast<ts::ecmgscs::ChannelClose*>(msg.pointer()));
+        case ts::ecmgscs::Tags::stream_setup:
+            return handleStreamSetup(dynamic_cast<ts::ecmgscs::StreamSetup*>(msg.pointer()));
+        case ts::ecmgscs::Tags::stream_test:
+            return handleStreamTest(dynamic_cast<ts::ecmgscs::StreamTest*>(msg.pointer()));
+        case ts::ecmgscs::Tags::stream_close_request:
+            return handleStreamCloseRequest(dynamic_cast<ts::ecmgscs::StreamCloseRequest*>(msg.pointer()));
+        case ts::ecmgscs::Tags::CW_provision:
+            return handleCWProvision(dynamic_cast<ts::ecmgscs::CWProvision*>(msg.pointer()), received);
+        case ts::ecmgscs::Tags::channel_status:
+        case ts::ecmgscs::Tags::stream_status:
+        case ts::ecmgscs::Tags::channel_error:
+        case ts::ecmgscs::Tags::stream_error:
+            // Silently ignore unsollicited status or error messages.
+            return true;
+        default:
+            // Received an invalid message for ECMG.
+            return sendErrorResponse(msg.pointer(), ts::ecmgscs::Errors::inv_message);
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Event loop mode: read available data and queue the complete messages.
+// Same message framing and error handling as tlv::Connection::receive().
+//----------------------------------------------------------------------------
+
+bool ECMGSession::receiveAvailable(ts::ByteBlock& buffer, bool& schedule)
+{
+    schedule = false;
+
+    // Start with the incomplete message from the previous read, if any. The buffer is
+    // reallocated only when it is too small, typically never after the first reads.
+    const size_t previous = _input.size();
+    buffer.resize(previous + READ_SIZE);
+    if (previous > 0) {
+        ::memcpy(buffer.data(), _input.data(), previous);  // Flawfinder: ignore: memcpy()
+    }
+
+    // Read what is available, the socket is known to be readable.
+    size_t got = 0;
+    if (!_conn->ts::TCPConnection::receive(buffer.data() + previous, READ_SIZE, got, nullptr, _shared->report())) {
+        return false;
+    }
+    const size_t size = previous + got;
+
+    const ts::tlv::Protocol* const protocol = ts::ecmgscs::Protocol::Instance();
+    const size_t header_size = protocol->hasVersion() ? 5 : 4;
+    const size_t length_offset = protocol->hasVersion() ? 3 : 2;
+    const ts::Monotonic received(true);
+
+    // Extract all complete messages.
+    size_t start = 0;
+    while (size - start >= header_size) {
+        const size_t msg_size = header_size + ts::GetUInt16(buffer.data() + start + length_offset);
+        if (size - start < msg_size) {
+            break;
+        }
+        ts::tlv::MessageFactory mf(buffer.data() + start, msg_size, protocol);
+        start += msg_size;
+        if (mf.errorStatus() == ts::tlv::OK) {
+            _invalid = 0;
+            ts::tlv::MessagePtr msg;
+            mf.factory(msg);
+            if (!msg.isNull()) {
+                _shared->logger().log(*msg, u"received message from " + _peer);
+                schedule = post(msg, received) || schedule;
+            }
+        }
+        else {
+            // Received an invalid message, send back an error message.
+            ts::tlv::MessagePtr resp;
+            mf.buildErrorResponse(resp);
+            if (!_output->send(resp.pointer()) || ++_invalid >= 3) {
+                _shared->report().error(u"too many invalid messages from %s, disconnecting", {_peer});
+                return false;
+            }
+        }
+    }
+
+    // Keep only the incomplete message, with the exact required size, usually none.
+    ts::ByteBlock(buffer.data() + start, size - start).swap(_input);
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Event loop mode: queue messages and process them in a worker thread.
+//----------------------------------------------------------------------------
+
+bool ECMGSession::post(const ts::tlv::MessagePtr& msg, const ts::Monotonic& received)
+{
+    ts::Guard lock(_mutex);
+    _pending.push_back(std::make_pair(msg, received));
+    const bool schedule = !_queued;
+    _queued = true;
+    return schedule;
+}
+
+bool ECMGSession::postEnd()
+{
+    return post(ts::tlv::MessagePtr(), ts::Monotonic());
+}
+
+void ECMGSession::processMessages()
+{
+    // The messages of a session are processed in sequence by only one worker at a time.
+    for (;;) {
+        PendingMessage pm;
+        {
+            ts::Guard lock(_mutex);
+            if (_pending.empty()) {
+                _queued = false;
+                return;
+            }
+            pm = _pending.front();
+            _pending.pop_front();
+        }
+        if (pm.first.isNull()) {
+            end();
+        }
+        else if (!_failed && !handleMessage(pm.first, pm.second)) {
+            // Break the connection, the event loop will be notified and will end the session.
+            _failed = true;
+            _conn->disconnect(NULLREP);
+        }
+    }
+}
+
+
 //----------------------------------------------------------------------------
 // Send an error related to the msg.
 //----------------------------------------------------------------------------
 
-bool ECMGClientHandler::sendErrorResponse(const ts::tlv::Message* msg, uint16_t errorStatus)
+bool ECMGSession::sendErrorResponse(const ts::tlv::Message* msg, uint16_t errorStatus)
 {
     const ts::tlv::ChannelMessage* channelMsg = nullptr;
     const ts::tlv::StreamMessage* streamMsg = nullptr;
@@ -473,7 +903,7 @@ bool ECMGClientHandler::sendErrorResponse(const ts::tlv::Message* msg, uint16_t
 // Handle the various types of messages from the client.
 //----------------------------------------------------------------------------
 
-bool ECMGClientHandler::handleChannelSetup(ts::ecmgscs::ChannelSetup* msg)
+bool ECMGSession::handleChannelSetup(ts::ecmgscs::ChannelSetup* msg)
 {
     assert(msg != nullptr);
     if (_channel.set()) {
@@ -494,7 +924,7 @@ bool ECMGClientHandler::handleChannelSetup(ts::ecmgscs::ChannelSetup* msg)
 }
 
 
-bool ECMGClientHandler::handleChannelTest(ts::ecmgscs::ChannelTest* msg)
+bool ECMGSession::handleChannelTest(ts::ecmgscs::ChannelTest* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -511,7 +941,7 @@ bool ECMGClientHandler::handleChannelTest(ts::ecmgscs::ChannelTest* msg)
 }
 
 
-bool ECMGClientHandler::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
+bool ECMGSession::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -520,6 +950,7 @@ bool ECMGClientHandler::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
     }
     else {
         // Channel ok, close everything, no response expected.
+        _output->closeChannel(_peer, msg->channel_id);
         _shared->closeChannel(msg->channel_id);
         _channel.reset();
         _streams.clear();
@@ -528,7 +959,7 @@ bool ECMGClientHandler::handleChannelClose(ts::ecmgscs::ChannelClose* msg)
 }
 
 
-bool ECMGClientHandler::handleStreamSetup(ts::ecmgscs::StreamSetup* msg)
+bool ECMGSession::handleStreamSetup(ts::ecmgscs::StreamSetup* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -551,7 +982,7 @@ bool ECMGClientHandler::handleStreamSetup(ts::ecmgscs::StreamSetup* msg)
 }
 
 
-bool ECMGClientHandler::handleStreamTest(ts::ecmgscs::StreamTest* msg)
+bool ECMGSession::handleStreamTest(ts::ecmgscs::StreamTest* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -573,7 +1004,7 @@ bool ECMGClientHandler::handleStreamTest(ts::ecmgscs::StreamTest* msg)
 }
 
 
-bool ECMGClientHandler::handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg)
+bool ECMGSession::handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest* msg)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -595,7 +1026,7 @@ bool ECMGClientHandler::handleStreamCloseRequest(ts::ecmgscs::StreamCloseRequest
 }
 
 
-bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
+bool ECMGSession::handleCWProvision(ts::ecmgscs::CWProvision* msg, const ts::Monotonic& received)
 {
     assert(msg != nullptr);
     if (_channel != msg->channel_id) {
@@ -672,10 +1103,363 @@ bool ECMGClientHandler::handleCWProvision(ts::ecmgscs::CWProvision* msg)
 
         // Emulate the computation time of a real ECMG.
         if (_opt.ecmCompTime > 0) {
+            if (_timers != nullptr) {
+                // Event loop mode: the response is sent later by the timer thread.
+                ts::Monotonic due(received);
+                due += _opt.ecmCompTime * ts::NanoSecPerMilliSec;
+                _timers->schedule(_output, resp, received, due);
+                return true;
+            }
             ts::SleepThread(_opt.ecmCompTime);
         }
 
-        return send(&resp);
+        return _output->sendECM(&resp, received, _output->channelGeneration());
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// A class implementing a thread which manages a client connection.
+//----------------------------------------------------------------------------
+
+class ECMGClientHandler: public ts::Thread
+{
+    TS_NOBUILD_NOCOPY(ECMGClientHandler);
+public:
+    // Constructor.
+    // When deleteWhenTerminated is true, this object is automatically deleted
+    // when the thread terminates.
+    ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated);
+
+    // Main code of the thread.
+    virtual void main() override;
+
+private:
+    ECMGSharedData* _shared;
+    ECMGSession     _session;
+};
+
+// Constructor.
+ECMGClientHandler::ECMGClientHandler(const ECMGOptions& opt, const ECMGConnectionPtr& conn, ECMGSharedData* shared, bool deleteWhenTerminated) :
+    ts::Thread(),
+    _shared(shared),
+    _session(opt, conn, shared, nullptr)
+{
+    // Set thread attributes. Beware of deleteWhenTerminated...
+    ts::ThreadAttributes attr;
+    attr.setStackSize(CLIENT_STACK_SIZE);
+    attr.setDeleteWhenTerminated(deleteWhenTerminated);
+    setAttributes(attr);
+}
+
+// Main code of the client connection thread.
+void ECMGClientHandler::main()
+{
+    _session.start();
+
+    // Normally, an ECMG should handle incoming and outgoing messages independently.
+    // However, here we have a minimal implementation. We never send any request to
+    // the client and the ECM generation is instantaneous. So, we simply wait for
+    // requests from the client and respond to them immediately.
+
+    // Loop on message reception
+    ts::tlv::MessagePtr msg;
+    bool ok = true;
+    while (ok && _session.connection()->receive(msg, nullptr, _shared->logger())) {
+        ok = _session.handleMessage(msg, ts::Monotonic(true));
+    }
+
+    _session.end();
+}
+
+
+//----------------------------------------------------------------------------
+// A worker thread in event loop mode. Process the queued messages of sessions.
+//----------------------------------------------------------------------------
+
+// The queue contains pointers to sessions because it takes ownership of its messages.
+typedef ts::MessageQueue<ECMGSessionPtr, ts::Mutex> ECMGWorkQueue;
+
+class ECMGWorker: public ts::Thread
+{
+    TS_NOBUILD_NOCOPY(ECMGWorker);
+public:
+    // Constructor.
+    ECMGWorker(ECMGWorkQueue& queue);
+
+    // Main code of the thread. Terminate on a null session.
+    virtual void main() override;
+
+private:
+    ECMGWorkQueue& _queue;
+};
+
+// Constructor.
+ECMGWorker::ECMGWorker(ECMGWorkQueue& queue) :
+    ts::Thread(ts::ThreadAttributes().setStackSize(CLIENT_STACK_SIZE)),
+    _queue(queue)
+{
+}
+
+// Main code of the worker thread.
+void ECMGWorker::main()
+{
+    ECMGWorkQueue::MessagePtr session;
+    while (_queue.dequeue(session) && !session->isNull()) {
+        (*session)->processMessages();
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Wait for readable sockets. Use epoll on Linux, poll() elsewhere.
+//----------------------------------------------------------------------------
+
+class ECMGPoller
+{
+    TS_NOCOPY(ECMGPoller);
+public:
+    // Constructor and destructor.
+    ECMGPoller();
+    ~ECMGPoller();
+
+    // Initialize the poller.
+    bool open(ts::Report& report);
+
+    // Add or remove a socket.
+    bool add(TS_SOCKET_T sock, ts::Report& report);
+    bool remove(TS_SOCKET_T sock, ts::Report& report);
+
+    // Wait until some sockets are readable.
+    bool wait(std::vector<TS_SOCKET_T>& ready, ts::Report& report);
+
+private:
+#if defined(TS_LINUX)
+    int _epoll;
+    std::vector<::epoll_event> _events;
+#else
+    std::vector<::pollfd> _fds;
+#endif
+};
+
+#if defined(TS_LINUX)
+
+ECMGPoller::ECMGPoller() :
+    _epoll(-1),
+    _events(256)
+{
+}
+
+ECMGPoller::~ECMGPoller()
+{
+    if (_epoll >= 0) {
+        ::close(_epoll);
+    }
+}
+
+bool ECMGPoller::open(ts::Report& report)
+{
+    if (_epoll < 0 && (_epoll = ::epoll_create1(EPOLL_CLOEXEC)) < 0) {
+        report.error(u"epoll_create error: %s", {ts::ErrorCodeMessage()});
+        return false;
+    }
+    return true;
+}
+
+bool ECMGPoller::add(TS_SOCKET_T sock, ts::Report& report)
+{
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    ev.events = EPOLLIN;
+    ev.data.fd = sock;
+    if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, sock, &ev) < 0) {
+        report.error(u"epoll_ctl error: %s", {ts::ErrorCodeMessage()});
+        return false;
+    }
+    return true;
+}
+
+bool ECMGPoller::remove(TS_SOCKET_T sock, ts::Report& report)
+{
+    ::epoll_event ev;
+    TS_ZERO(ev);
+    if (::epoll_ctl(_epoll, EPOLL_CTL_DEL, sock, &ev) < 0) {
+        report.error(u"epoll_ctl error: %s", {ts::ErrorCodeMessage()});
+        return false;
+    }
+    return true;
+}
+
+bool ECMGPoller::wait(std::vector<TS_SOCKET_T>& ready, ts::Report& report)
+{
+    ready.clear();
+    int count = 0;
+    while ((count = ::epoll_wait(_epoll, _events.data(), int(_events.size()), -1)) < 0) {
+        if (errno != EINTR) {
+            report.error(u"epoll_wait error: %s", {ts::ErrorCodeMessage()});
+            return false;
+        }
+    }
+    for (int i = 0; i < count; ++i) {
+        ready.push_back(_events[i].data.fd);
+    }
+    return true;
+}
+
+#else
+
+ECMGPoller::ECMGPoller() :
+    _fds()
+{
+}
+
+ECMGPoller::~ECMGPoller()
+{
+}
+
+bool ECMGPoller::open(ts::Report&)
+{
+    return true;
+}
+
+bool ECMGPoller::add(TS_SOCKET_T sock, ts::Report&)
+{
+    ::pollfd pfd;
+    TS_ZERO(pfd);
+    pfd.fd = sock;
+    pfd.events = POLLIN;
+    _fds.push_back(pfd);
+    return true;
+}
+
+bool ECMGPoller::remove(TS_SOCKET_T sock, ts::Report&)
+{
+    for (auto it = _fds.begin(); it != _fds.end(); ++it) {
+        if (it->fd == sock) {
+            _fds.erase(it);
+            break;
+        }
+    }
+    return true;
+}
+
+bool ECMGPoller::wait(std::vector<TS_SOCKET_T>& ready, ts::Report& report)
+{
+    ready.clear();
+    for (;;) {
+#if defined(TS_WINDOWS)
+        const int count = ::WSAPoll(_fds.data(), ULONG(_fds.size()), -1);
+#else
+        const int count = ::poll(_fds.data(), ::nfds_t(_fds.size()), -1);
+#endif
+        if (count >= 0) {
+            break;
+        }
+        const ts::SocketErrorCode err = ts::LastSocketErrorCode();
+#if !defined(TS_WINDOWS)
+        if (err == EINTR) {
+            continue;
+        }
+#endif
+        report.error(u"poll error: %s", {ts::SocketErrorCodeMessage(err)});
+        return false;
+    }
+    for (auto it = _fds.begin(); it != _fds.end(); ++it) {
+        if ((it->revents & (POLLIN | POLLERR | POLLHUP)) != 0) {
+            ready.push_back(it->fd);
+        }
+    }
+    return true;
+}
+
+#endif
+
+
+//----------------------------------------------------------------------------
+// Event loop mode: all client connections are multiplexed in the main
+// thread, the messages are processed by a pool of worker threads and the
+// delayed ECM responses are sent by a timer thread.
+//----------------------------------------------------------------------------
+
+namespace {
+    int RunEventLoop(const ECMGOptions& opt, ECMGSharedData& shared, ts::TCPServer& server)
+    {
+        ts::Report& report(shared.report());
+        ECMGPoller poller;
+        if (!poller.open(report) || !poller.add(server.getSocket(), report)) {
+            return EXIT_FAILURE;
+        }
+
+        // Start the timer and worker threads.
+        ECMGTimers timers;
+        timers.start();
+        ECMGWorkQueue queue;
+        std::vector<ts::SafePtr<ECMGWorker>> workers(opt.workerThreads);
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i] = new ECMGWorker(queue);
+            workers[i]->start();
+        }
+        report.verbose(u"event loop started with %d worker threads", {workers.size()});
+
+        // Active sessions, indexed by socket.
+        std::map<TS_SOCKET_T, ECMGSessionPtr> sessions;
+        size_t session_count = 0;
+        bool accepting = true;
+
+        // One read buffer for all connections, they are read one at a time.
+        ts::ByteBlock buffer;
+        bool ok = true;
+        std::vector<TS_SOCKET_T> ready;
+
+        while (ok && (accepting || !sessions.empty()) && poller.wait(ready, report)) {
+            for (auto it = ready.begin(); ok && it != ready.end(); ++it) {
+                if (accepting && *it == server.getSocket()) {
+                    // Accept one incoming connection.
+                    ts::SocketAddress clientAddress;
+                    ECMGConnectionPtr conn(new ECMGConnection(ts::ecmgscs::Protocol::Instance(), true, 3));
+                    ts::CheckNonNull(conn.pointer());
+                    ok = server.accept(*conn, clientAddress, report);
+                    if (ok && poller.add(conn->getSocket(), report)) {
+                        ECMGSessionPtr session(new ECMGSession(opt, conn, &shared, &timers));
+                        ts::CheckNonNull(session.pointer());
+                        session->start();
+                        sessions[conn->getSocket()] = session;
+                    }
+                    if (opt.maxSessions > 0 && ++session_count >= opt.maxSessions) {
+                        // With --once or --max-sessions, stop accepting connections.
+                        accepting = false;
+                        poller.remove(server.getSocket(), report);
+                    }
+                    continue;
+                }
+                const auto sit = sessions.find(*it);
+                if (sit != sessions.end()) {
+                    // Receive messages from the client.
+                    ECMGSessionPtr session(sit->second);
+                    bool schedule = false;
+                    if (!session->receiveAvailable(buffer, schedule)) {
+                        // Disconnection, the session is terminated by a worker, after its pending messages.
+                        poller.remove(sit->first, report);
+                        sessions.erase(sit);
+                        schedule = session->postEnd();
+                    }
+                    if (schedule) {
+                        queue.forceEnqueue(new ECMGSessionPtr(session));
+                    }
+                }
+            }
+        }
+
+        // Terminate all threads. Each worker terminates on a null session, after the pending ones.
+        for (size_t i = 0; i < workers.size(); ++i) {
+            queue.forceEnqueue(new ECMGSessionPtr);
+        }
+        for (size_t i = 0; i < workers.size(); ++i) {
+            workers[i]->waitForTermination();
+        }
+        timers.stop();
+        timers.waitForTermination();
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 }
 
@@ -703,6 +1487,11 @@ int MainCode(int argc, char *argv[])
     shared.report().verbose(u"TCP server listening on %s, using ECMG <=> SCS protocol version %d",
                             {opt.serverAddress, ts::ecmgscs::Protocol::Instance()->version()});
 
+    // In event loop mode, all connections are managed in the main thread.
+    if (opt.eventLoop) {
+        return RunEventLoop(opt, shared, server);
+    }
+
     // Manage incoming client connections.
     for (;;) {
 
@@ -35,6 +35,7 @@
 #include "tsInputRedirector.h"
 #include "tsOutputRedirector.h"
 #include "tsByteBlock.h"
+#include "tsTSSyncScanner.h"
 #include "tsFatal.h"
 #include "tsMPEG.h"
 TSDUCK_SOURCE;
@@ -159,12 +160,10 @@ public:
         _in_header_size = 0;
     }
 
-    // Look for MPEG packets in a buffer, according to an assumed packet size.
-    // If the complete buffer matches the packet size, set input and output packet
-    // sizes and return true. Return false otherwise.
-    bool checkSync(const uint8_t* buf, size_t buf_size, size_t pkt_size, size_t header_size);
+    // Set input and output packet sizes, as found by the synchronization scanner.
+    void setPacketSize(size_t pkt_size, size_t header_size);
 
-    // Get packet sizes, as determined by checkSync(). Size is zero if no valid packet size found.
+    // Get packet sizes, as set by setPacketSize(). Size is zero if no valid packet size found.
     size_t inputPacketSize() const {return _in_pkt_size;}
     size_t inputHeaderSize() const {return _in_header_size;}
     size_t outputPacketSize() const {return _out_pkt_size;}
@@ -181,8 +180,8 @@ public:
     // Read input data, return read size (zero on end of file or error)
     size_t readData(uint8_t* buf, size_t size);
 
-    // Write one output packet from input packet.
-    bool writePacket(const uint8_t* input_packet);
+    // Write output packets from consecutive input packets.
+    bool writePackets(const uint8_t* input_packets, size_t count);
 
     // Constructor
     Resynchronizer(bool keep_packet_size) :
@@ -216,12 +215,12 @@ size_t Resynchronizer::readData(uint8_t* buf, size_t size)
     std::streamsize got = 0;
     std::streamsize remain = std::streamsize(size);
     while (remain > 0) {
-        if (std::cin.read(reinterpret_cast <char*> (buf + got), remain)) {
-            const std::streamsize count = std::cin.gcount();
-            got += count;
-            remain -= count;
-        }
-        else {
+        // On end of file, the read operation fails but may have returned some data.
+        const bool success = bool(std::cin.read(reinterpret_cast <char*> (buf + got), remain));
+        const std::streamsize count = std::cin.gcount();
+        got += count;
+        remain -= count;
+        if (!success) {
             if (got == 0) {
                 _status = RS_EOF;
             }
@@ -233,47 +232,49 @@ size_t Resynchronizer::readData(uint8_t* buf, size_t size)
 
 
 //----------------------------------------------------------------------------
-// Write one output packet from input packet.
+// Write output packets from consecutive input packets.
 //----------------------------------------------------------------------------
 
-bool Resynchronizer::writePacket(const uint8_t* input_packet)
+bool Resynchronizer::writePackets(const uint8_t* input_packets, size_t count)
 {
-    const char* out_pkt = reinterpret_cast<const char*>(input_packet + _in_header_size - _out_header_size);
-    if (std::cout.write(out_pkt, std::streamsize(_out_pkt_size))) {
-        _out_size += _out_pkt_size;
-        return true;
+    bool success = true;
+    if (_out_pkt_size == _in_pkt_size) {
+        // Same packet size, bulk write.
+        const size_t size = count * _in_pkt_size;
+        success = bool(std::cout.write(reinterpret_cast<const char*>(input_packets), std::streamsize(size)));
+        if (success) {
+            _out_size += size;
+        }
     }
     else {
+        // Write packets one by one, stripping extra data.
+        for (size_t i = 0; success && i < count; ++i) {
+            const char* out_pkt = reinterpret_cast<const char*>(input_packets + i * _in_pkt_size + _in_header_size - _out_header_size);
+            success = bool(std::cout.write(out_pkt, std::streamsize(_out_pkt_size)));
+            if (success) {
+                _out_size += _out_pkt_size;
+            }
+        }
+    }
+    if (!success) {
         std::cerr << "* Error writing output file" << std::endl;
         _status = RS_ERROR;
-        return false;
     }
+    return success;
 }
 
 
 //----------------------------------------------------------------------------
-//  Look for MPEG packets in a buffer, according to an assumed packet size.
+//  Set input and output packet sizes.
 //----------------------------------------------------------------------------
 
-bool Resynchronizer::checkSync(const uint8_t* buf, size_t buf_size, size_t pkt_size, size_t header_size)
+void Resynchronizer::setPacketSize(size_t pkt_size, size_t header_size)
 {
     assert(pkt_size >= header_size + ts::PKT_SIZE);
-    const uint8_t* end = buf + buf_size - pkt_size + 1;
-
-    // Check if the buffer contains packets with the appropriate size
-    while (buf < end) {
-        if (buf[header_size] != ts::SYNC_BYTE) {
-            return false; // not found
-        }
-        buf += pkt_size;
-    }
-
-    // Packets found all along the buffer
     _in_pkt_size = pkt_size;
     _in_header_size = header_size;
     _out_pkt_size = _keep_packet_size ? pkt_size : ts::PKT_SIZE;
     _out_header_size = _keep_packet_size ? header_size : 0;
-    return true;
 }
 
 
@@ -288,6 +289,12 @@ int MainCode(int argc, char *argv[])
     ts::OutputRedirector output(opt.outfile, opt);
     Resynchronizer resync(opt.keep);
 
+    // Packet synchronization scanner, with standard or user-specified encapsulation.
+    ts::TSSyncScanner scanner;
+    if (opt.packet_size > 0) {
+        scanner.setFormat(opt.packet_size, opt.header_size);
+    }
+
     // Synchronization buffer
     ts::ByteBlock sync_buf_bb(opt.sync_size + opt.contig_size);
     uint8_t* const sync_buf = sync_buf_bb.data();
@@ -312,34 +319,14 @@ int MainCode(int argc, char *argv[])
             prefix_fn = "next";
         }
 
-        // Look for a range of packets for at least --min-contiguous bytes
+        // Look for a range of packets for at least --min-contiguous bytes.
+        // Try all expected packet sizes at each position.
         size_t const search_size = std::min(opt.contig_size, sync_size);
-        uint8_t* const end_search = sync_end - search_size + 1;
-
-        // Search a range of valid packets. Try all expected packet sizes.
-        const uint8_t* start;
-        for (start = sync_buf; start < end_search; start++) {
-            if (opt.packet_size > 0) {
-                if (resync.checkSync(start, search_size, opt.packet_size, opt.header_size)) {
-                    // Found user-specified encapsulation of TS packets
-                    break;
-                }
-            }
-            else {
-                if (resync.checkSync(start, search_size, ts::PKT_SIZE, 0)) {
-                    // Found standard TS packets
-                    break;
-                }
-                if (resync.checkSync(start, search_size, ts::PKT_RS_SIZE, 0)) {
-                    // Found TS packets with trailing Reed-Solomon outer FEC
-                    break;
-                }
-                if (resync.checkSync(start, search_size, ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE)) {
-                    // Found TS packets with leading 4-byte timestamp (M2TS format, blu-ray discs)
-                    break;
-                }
-            }
+        size_t start_offset = 0;
+        if (scanner.lock(sync_buf, sync_size, search_size, start_offset)) {
+            resync.setPacketSize(scanner.packetSize(), scanner.headerSize());
         }
+        const uint8_t* start = sync_buf + start_offset;
         if (resync.inputPacketSize() == 0) {
             std::cerr << "* Cannot find MPEG TS packets after " << ts::UString::Decimal(search_size) << " bytes" << std::endl;
             resync.setStatus (RS_ERROR);
@@ -355,15 +342,11 @@ int MainCode(int argc, char *argv[])
         }
 
         // Output initial sync buffer, starting at first valid packet, writing all valid packets
-        while (start <= sync_end - resync.inputPacketSize() && start[resync.inputHeaderSize()] == ts::SYNC_BYTE) {
-            if (!resync.writePacket(start)) {
-                break;
-            }
-            start += resync.inputPacketSize();
-        }
-        if (resync.status() != RS_OK) {
+        const size_t initial_count = scanner.countPackets(start, sync_end - start);
+        if (!resync.writePackets(start, initial_count)) {
             break;
         }
+        start += initial_count * resync.inputPacketSize();
 
         // Compact sync buffer
         if (start >= sync_end) {
@@ -379,24 +362,31 @@ int MainCode(int argc, char *argv[])
             resync.setStatus(RS_SYNC_LOST);
         }
 
-        // Read the rest of the input file
+        // Read the rest of the input file, using the synchronization buffer for large reads.
         while (resync.status() == RS_OK) {
             assert(sync_pre_size < resync.inputPacketSize());
-            // Read the next packet
-            const size_t remain_size = resync.inputPacketSize() - sync_pre_size;
-            if (resync.readData(sync_buf + sync_pre_size, remain_size) != remain_size) {
+            const size_t size = sync_pre_size + resync.readData(sync_buf + sync_pre_size, sync_buf_size - sync_pre_size);
+            if (size < resync.inputPacketSize()) {
+                // Truncated packet at end of file.
                 resync.setStatus(RS_EOF);
+                break;
+            }
+            // Write all valid packets up to the first invalid one.
+            const size_t count = scanner.countPackets(sync_buf, size);
+            if (!resync.writePackets(sync_buf, count)) {
+                break;
             }
-            else if (sync_buf[resync.inputHeaderSize()] != ts::SYNC_BYTE) {
+            const size_t end = count * resync.inputPacketSize();
+            sync_pre_size = size - end;
+            if (sync_pre_size >= resync.inputPacketSize()) {
+                const uint8_t sync = sync_buf[end + resync.inputHeaderSize()];
                 std::cerr << ts::UString::Format(u"*** Synchronization lost after %'d TS packets", {resync.outputFilePackets()}) << std::endl
-                          << ts::UString::Format(u"*** Got 0x%X instead of 0x%X at start of TS packet", {sync_buf[resync.inputHeaderSize()], ts::SYNC_BYTE}) << std::endl;
+                          << ts::UString::Format(u"*** Got 0x%X instead of 0x%X at start of TS packet", {sync, ts::SYNC_BYTE}) << std::endl;
                 resync.setStatus(RS_SYNC_LOST);
-                // Will resynchronize with sync buffer pre-loaded
-                sync_pre_size = resync.inputPacketSize();
+                // Will resynchronize with sync buffer pre-loaded, starting at the invalid packet.
             }
-            else {
-                resync.writePacket(sync_buf);
-                sync_pre_size = 0;
+            if (sync_pre_size > 0) {
+                ::memmove(sync_buf, sync_buf + end, sync_pre_size);
             }
         }
 
@@ -255,23 +255,14 @@ namespace {
             return false;
         }
         else if (compile) {
-            // Load XML file and save binary sections.
+            // Convert XML file into binary sections, one table at a time.
             opt.verbose(u"Compiling %s to %s", {infile, outname});
-            return file.loadXML(infile, report) && file.saveBinary(outname, report);
+            return file.convertXMLToBinary(infile, outname, report);
         }
         else {
-            // Load binary sections and save XML file.
+            // Convert binary sections into XML file, one table at a time.
             opt.verbose(u"Decompiling %s to %s", {infile, outname});
-            if (!file.loadBinary(infile, report)) {
-                return false;
-            }
-            if (opt.packAndFlush) {
-                const size_t packed = file.packOrphanSections();
-                if (packed > 0) {
-                    opt.verbose(u"Packed %d incomplete tables, may be invalid", {packed});
-                }
-            }
-            return file.saveXML(outname, report);
+            return file.convertBinaryToXML(infile, outname, opt.packAndFlush, report);
         }
     }
 }
@@ -33,8 +33,8 @@
 
 #include "tsMain.h"
 #include "tsDuckContext.h"
-#include "tsInputRedirector.h"
 #include "tsTablesLogger.h"
+#include "tsTSFileReadArgs.h"
 #include "tsPagerArgs.h"
 TSDUCK_SOURCE;
 TS_MAIN(MainCode);
@@ -57,11 +57,12 @@ namespace {
     public:
         Options(int argc, char *argv[]);
 
-        ts::DuckContext   duck;     // TSDuck execution context.
-        ts::TablesDisplay display;  // Table formatting.
-        ts::TablesLogger  logger;   // Table logging.
-        ts::PagerArgs     pager;    // Output paging options.
-        ts::UString       infile;   // Input file name.
+        ts::DuckContext    duck;     // TSDuck execution context.
+        ts::TablesDisplay  display;  // Table formatting.
+        ts::TablesLogger   logger;   // Table logging.
+        ts::PagerArgs      pager;    // Output paging options.
+        ts::TSFileReadArgs read;     // Input file read mode.
+        ts::UString        infile;   // Input file name.
     };
 }
 
@@ -71,6 +72,7 @@ Options::Options(int argc, char *argv[]) :
     display(duck),
     logger(display),
     pager(true, true),
+    read(),
     infile()
 {
     duck.defineArgsForCAS(*this);
@@ -80,6 +82,7 @@ Options::Options(int argc, char *argv[]) :
     pager.defineArgs(*this);
     logger.defineArgs(*this);
     display.defineArgs(*this);
+    read.defineArgs(*this);
 
     option(u"", 0, STRING, 0, 1);
     help(u"", u"Input MPEG capture file (standard input if omitted).");
@@ -90,6 +93,7 @@ Options::Options(int argc, char *argv[]) :
     pager.loadArgs(duck, *this);
     logger.loadArgs(duck, *this);
     display.loadArgs(duck, *this);
+    read.loadArgs(duck, *this);
 
     infile = value(u"");
 
@@ -104,8 +108,15 @@ Options::Options(int argc, char *argv[]) :
 int MainCode(int argc, char *argv[])
 {
     Options opt(argc, argv);
-    ts::InputRedirector input(opt.infile, opt);
-    ts::TSPacket pkt;
+    ts::TSFile file;
+    ts::TSPacketVector buffer(1024);
+    size_t count = 0;
+
+    // Open the input file, standard input if no file name is specified.
+    opt.read.apply(file);
+    if (!file.openRead(opt.infile, 1, 0, opt)) {
+        return EXIT_FAILURE;
+    }
 
     // Redirect display on pager process or stdout only.
     opt.duck.setOutput(&opt.pager.output(opt), false);
@@ -114,10 +125,13 @@ int MainCode(int argc, char *argv[])
     if (!opt.logger.open()) {
         return EXIT_FAILURE;
     }
-    while (!opt.logger.completed() && pkt.read(std::cin, true, opt)) {
-        opt.logger.feedPacket(pkt);
+    while (!opt.logger.completed() && (count = file.readPackets(buffer.data(), nullptr, buffer.size(), opt)) > 0) {
+        for (size_t i = 0; i < count && !opt.logger.completed(); ++i) {
+            opt.logger.feedPacket(buffer[i]);
+        }
     }
     opt.logger.close();
+    file.close(opt);
 
     // Report errors
     if (opt.verbose() && !opt.logger.hasErrors()) {
@@ -38,12 +38,37 @@
 //    (a new source file in the same directory). Each test suite is
 //    automatically registered using the macro TSUNIT_REGISTER (see files).
 //
+//  Names cache:
+//    The compiled names files are cached in a private temporary directory,
+//    deleted at the end of the tests, not in the cache directory of the user.
+//
 //----------------------------------------------------------------------------
 
 #include "tsunit.h"
+#include "tsNames.h"
+#include "tsSysUtils.h"
 
 int main(int argc, char* argv[])
 {
+    // Use a private cache directory for names files, unless explicitly specified.
+    ts::UString cacheDir;
+    if (!ts::EnvironmentExists(ts::Names::CACHE_ENVIRONMENT_VARIABLE)) {
+        cacheDir = ts::TempFile(u"");
+        ts::SetEnvironment(ts::Names::CACHE_ENVIRONMENT_VARIABLE, cacheDir);
+    }
+
     tsunit::Main test(argc, argv);
-    return test.run();
+    const int status = test.run();
+
+    // Delete the private cache directory.
+    if (!cacheDir.empty()) {
+        ts::UStringVector files;
+        ts::ExpandWildcard(files, cacheDir + ts::PathSeparator + u"*");
+        for (auto it = files.begin(); it != files.end(); ++it) {
+            ts::DeleteFile(*it);
+        }
+        ts::DeleteFile(cacheDir);
+        ts::DeleteEnvironment(ts::Names::CACHE_ENVIRONMENT_VARIABLE);
+    }
+    return status;
 }
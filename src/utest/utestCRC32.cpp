@@ -0,0 +1,243 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::CRC32.
+//
+//----------------------------------------------------------------------------
+
+#include "tsCRC32.h"
+#include "tsSection.h"
+#include "tsByteBlock.h"
+#include "tsMonotonic.h"
+#include "tsunit.h"
+#include "tables/psi_bat_tvnum_sections.h"
+#include "tables/psi_nit_tntv23_sections.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class CRC32Test: public tsunit::Test
+{
+public:
+    CRC32Test();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testReference();
+    void testSections();
+    void testAlgorithms();
+    void testUpdate();
+    void testThroughput();
+
+    TSUNIT_TEST_BEGIN(CRC32Test);
+    TSUNIT_TEST(testReference);
+    TSUNIT_TEST(testSections);
+    TSUNIT_TEST(testAlgorithms);
+    TSUNIT_TEST(testUpdate);
+    TSUNIT_TEST(testThroughput);
+    TSUNIT_TEST_END();
+
+private:
+    ts::CRC32::Algorithm _previous;
+    std::vector<ts::CRC32::Algorithm> _algos;
+};
+
+TSUNIT_REGISTER(CRC32Test);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+CRC32Test::CRC32Test() :
+    _previous(ts::CRC32::AUTO),
+    _algos()
+{
+}
+
+// Test suite initialization method.
+void CRC32Test::beforeTest()
+{
+    _previous = ts::CRC32::GetAlgorithm();
+
+    // List of algorithms which are supported on this CPU.
+    _algos.clear();
+    _algos.push_back(ts::CRC32::BYTEWISE);
+    _algos.push_back(ts::CRC32::SLICE8);
+    if (ts::CRC32::IsSupported(ts::CRC32::CLMUL)) {
+        _algos.push_back(ts::CRC32::CLMUL);
+    }
+}
+
+// Test suite cleanup method.
+void CRC32Test::afterTest()
+{
+    ts::CRC32::SetAlgorithm(_previous);
+}
+
+namespace {
+    // Build a block of pseudo-random data (deterministic).
+    void FillData(ts::ByteBlock& data, size_t size)
+    {
+        uint32_t seed = 0x12345678;
+        data.resize(size);
+        for (size_t i = 0; i < size; ++i) {
+            seed = seed * 1103515245 + 12345;
+            data[i] = uint8_t(seed >> 16);
+        }
+    }
+
+    const char* AlgoName(ts::CRC32::Algorithm algo)
+    {
+        switch (algo) {
+            case ts::CRC32::BYTEWISE: return "bytewise";
+            case ts::CRC32::SLICE8: return "slice8";
+            case ts::CRC32::CLMUL: return "clmul";
+            default: return "auto";
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+// Reference value for CRC-32/MPEG-2.
+void CRC32Test::testReference()
+{
+    for (auto it = _algos.begin(); it != _algos.end(); ++it) {
+        TSUNIT_ASSERT(ts::CRC32::SetAlgorithm(*it));
+        TSUNIT_EQUAL(*it, ts::CRC32::GetAlgorithm());
+        TSUNIT_EQUAL(0x0376E6E7, ts::CRC32("123456789", 9).value());
+        TSUNIT_EQUAL(0xFFFFFFFF, ts::CRC32(nullptr, 0).value());
+    }
+}
+
+// CRC32 of real sections, the CRC32 of a complete section is zero.
+void CRC32Test::testSections()
+{
+    for (auto it = _algos.begin(); it != _algos.end(); ++it) {
+        TSUNIT_ASSERT(ts::CRC32::SetAlgorithm(*it));
+        ts::Section sec1(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections), ts::PID_BAT, ts::CRC32::CHECK);
+        TSUNIT_ASSERT(sec1.isValid());
+        TSUNIT_EQUAL(0, ts::CRC32(sec1.content(), sec1.size()).value());
+        ts::Section sec2(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections), ts::PID_NIT, ts::CRC32::CHECK);
+        TSUNIT_ASSERT(sec2.isValid());
+        TSUNIT_EQUAL(0, ts::CRC32(sec2.content(), sec2.size()).value());
+    }
+}
+
+// Incremental update must give the same result as a full computation.
+void CRC32Test::testUpdate()
+{
+    ts::ByteBlock data;
+    FillData(data, 4096);
+
+    for (size_t total = 1; total < data.size(); total = total * 3 + 1) {
+        for (size_t offset = 0; offset < total; offset += 1 + total / 5) {
+            for (size_t size = 0; offset + size <= total && size < 9; size += 2) {
+                ts::ByteBlock modified(data.data(), total);
+                for (size_t i = 0; i < size; ++i) {
+                    modified[offset + i] ^= uint8_t(0x5A + i);
+                }
+                const uint32_t crc = ts::CRC32(data.data(), total).value();
+                TSUNIT_EQUAL(ts::CRC32(modified.data(), total).value(),
+                             ts::CRC32::Update(crc, total, offset, &data[offset], &modified[offset], size));
+            }
+        }
+    }
+
+    // The CRC32 of a complete section remains zero after patching its content and CRC32.
+    ts::ByteBlock sec(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections));
+    const size_t crc_offset = sec.size() - 4;
+    const uint8_t version = 0x0B;
+    const uint32_t crc = ts::CRC32::Update(ts::GetUInt32(&sec[crc_offset]), crc_offset, 5, &sec[5], &version, 1);
+    sec[5] = version;
+    ts::PutUInt32(&sec[crc_offset], crc);
+    TSUNIT_EQUAL(0, ts::CRC32(sec.data(), sec.size()).value());
+}
+
+// All algorithms must give the same result on all sizes and alignments.
+void CRC32Test::testAlgorithms()
+{
+    ts::ByteBlock data;
+    FillData(data, 5000);
+
+    for (size_t size = 0; size < 600; size += (size < 200 ? 1 : 7)) {
+        for (size_t offset = 0; offset < 8; offset += 3) {
+            TSUNIT_ASSERT(ts::CRC32::SetAlgorithm(ts::CRC32::BYTEWISE));
+            const uint32_t ref = ts::CRC32(&data[offset], size).value();
+            for (auto it = _algos.begin(); it != _algos.end(); ++it) {
+                TSUNIT_ASSERT(ts::CRC32::SetAlgorithm(*it));
+                TSUNIT_EQUAL(ref, ts::CRC32(&data[offset], size).value());
+                // Same thing in two parts.
+                ts::CRC32 crc(&data[offset], size / 3);
+                crc.add(&data[offset + size / 3], size - size / 3);
+                TSUNIT_EQUAL(ref, crc.value());
+            }
+        }
+    }
+
+    // Large area.
+    TSUNIT_ASSERT(ts::CRC32::SetAlgorithm(ts::CRC32::BYTEWISE));
+    const uint32_t ref = ts::CRC32(data.data(), data.size()).value();
+    for (auto it = _algos.begin(); it != _algos.end(); ++it) {
+        TSUNIT_ASSERT(ts::CRC32::SetAlgorithm(*it));
+        TSUNIT_EQUAL(ref, ts::CRC32(data.data(), data.size()).value());
+    }
+}
+
+// Compare the throughput of all algorithms on typical section sizes.
+void CRC32Test::testThroughput()
+{
+    const size_t sizes[] = {184, 1024, 4096};
+    const size_t total = 8 * 1024 * 1024;
+
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+        ts::ByteBlock data;
+        FillData(data, sizes[si]);
+        for (auto it = _algos.begin(); it != _algos.end(); ++it) {
+            TSUNIT_ASSERT(ts::CRC32::SetAlgorithm(*it));
+            uint32_t sum = 0;
+            const ts::Monotonic start(true);
+            for (size_t done = 0; done < total; done += data.size()) {
+                sum ^= ts::CRC32(data.data(), data.size()).value();
+            }
+            const ts::NanoSecond ns = ts::Monotonic(true) - start;
+            debug() << "CRC32Test: " << AlgoName(*it) << ", " << sizes[si] << "-byte areas: "
+                    << (ns <= 0 ? 0 : (total * ts::NanoSecPerSec) / (ns * 1024 * 1024)) << " MB/s (" << sum << ")" << std::endl;
+        }
+    }
+}
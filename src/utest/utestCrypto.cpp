@@ -51,6 +51,7 @@
 #include "tsIDSA.h"
 #include "tsTSPacket.h"
 #include "tsSystemRandomGenerator.h"
+#include "tsMonotonic.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
 
@@ -88,6 +89,9 @@ public:
     void testAES_CTS3();
     void testAES_CTS4();
     void testAES_DVS042();
+    void testAESImplementations();
+    void testAESThroughput();
+    void testAESBlocksKeyUsage();
     void testDES();
     void testTDES();
     void testTDES_CBC();
@@ -111,6 +115,9 @@ public:
     TSUNIT_TEST(testAES_CTS3);
     TSUNIT_TEST(testAES_CTS4);
     TSUNIT_TEST(testAES_DVS042);
+    TSUNIT_TEST(testAESImplementations);
+    TSUNIT_TEST(testAESThroughput);
+    TSUNIT_TEST(testAESBlocksKeyUsage);
     TSUNIT_TEST(testDES);
     TSUNIT_TEST(testTDES);
     TSUNIT_TEST(testTDES_CBC);
@@ -150,6 +157,13 @@ private:
 
     void testChainingSizes(ts::CipherChaining& algo, int sizes, ...);
 
+    // Compare the results of the software and AES-NI implementations.
+    void testAESCompare(ts::CipherChaining& algo);
+
+    // Supported AES implementations on this system.
+    static std::vector<ts::AES::Implementation> AESImplementations();
+    static ts::UString AESImplementationName(ts::AES::Implementation impl);
+
     void testHash(ts::Hash& algo,
                   size_t tv_index,
                   size_t tv_count,
@@ -173,6 +187,26 @@ void CryptoTest::beforeTest()
 // Test suite cleanup method.
 void CryptoTest::afterTest()
 {
+    ts::AES::SetImplementation(ts::AES::IMPL_AUTO);
+}
+
+std::vector<ts::AES::Implementation> CryptoTest::AESImplementations()
+{
+    std::vector<ts::AES::Implementation> impls;
+    impls.push_back(ts::AES::IMPL_SOFTWARE);
+    if (ts::AES::IsSupported(ts::AES::IMPL_AESNI)) {
+        impls.push_back(ts::AES::IMPL_AESNI);
+    }
+    return impls;
+}
+
+ts::UString CryptoTest::AESImplementationName(ts::AES::Implementation impl)
+{
+    switch (impl) {
+        case ts::AES::IMPL_SOFTWARE: return u"software";
+        case ts::AES::IMPL_AESNI: return u"AES-NI";
+        default: return u"auto";
+    }
 }
 
 
@@ -417,6 +451,134 @@ void CryptoTest::testAES_DVS042()
     testChainingSizes(dvs042_aes, 16, 17, 23, 31, 32, 33, 45, 64, 67, 184, 12345, 0);
 }
 
+// Run all AES tests with each implementation.
+void CryptoTest::testAESImplementations()
+{
+    const std::vector<ts::AES::Implementation> impls(AESImplementations());
+    for (auto it = impls.begin(); it != impls.end(); ++it) {
+        debug() << "CryptoTest: testing AES with " << AESImplementationName(*it) << " implementation" << std::endl;
+        TSUNIT_ASSERT(ts::AES::SetImplementation(*it));
+        TSUNIT_EQUAL(*it, ts::AES::GetImplementation());
+        testAES();
+        testAES_ECB();
+        testAES_CBC();
+        testAES_CTR();
+        testAES_CTS1();
+        testAES_CTS2();
+        testAES_DVS042();
+        testDVBCISSA();
+        testIDSA();
+    }
+
+    // Compare implementations on random data, all sizes up to several groups of parallel blocks.
+    ts::ECB<ts::AES> ecb;
+    ts::CBC<ts::AES> cbc;
+    ts::CTR<ts::AES> ctr;
+    ts::DVS042<ts::AES> dvs042;
+    testAESCompare(ecb);
+    testAESCompare(cbc);
+    testAESCompare(ctr);
+    testAESCompare(dvs042);
+}
+
+void CryptoTest::testAESCompare(ts::CipherChaining& algo)
+{
+    const std::vector<ts::AES::Implementation> impls(AESImplementations());
+    ts::SystemRandomGenerator prng;
+    ts::ByteBlock key(algo.maxKeySize());
+    ts::ByteBlock iv(algo.maxIVSize());
+    ts::ByteBlock plain(600);
+    TSUNIT_ASSERT(prng.read(key.data(), key.size()));
+    TSUNIT_ASSERT(prng.read(iv.data(), iv.size()));
+    TSUNIT_ASSERT(prng.read(plain.data(), plain.size()));
+
+    for (size_t size = algo.minMessageSize(); size <= plain.size(); size += algo.residueAllowed() ? 1 : algo.blockSize()) {
+        ts::ByteBlock ref(size);
+        for (auto it = impls.begin(); it != impls.end(); ++it) {
+            TSUNIT_ASSERT(ts::AES::SetImplementation(*it));
+            TSUNIT_ASSERT(algo.setKey(key.data(), key.size()));
+            TSUNIT_ASSERT(algo.setIV(iv.data(), iv.size()));
+            ts::ByteBlock cipher(size);
+            ts::ByteBlock decipher(size);
+            size_t retsize = 0;
+            TSUNIT_ASSERT(algo.encrypt(plain.data(), size, cipher.data(), cipher.size(), &retsize));
+            TSUNIT_EQUAL(size, retsize);
+            TSUNIT_ASSERT(algo.decrypt(cipher.data(), size, decipher.data(), decipher.size(), &retsize));
+            TSUNIT_EQUAL(size, retsize);
+            TSUNIT_ASSERT(::memcmp(plain.data(), decipher.data(), size) == 0);
+            if (it == impls.begin()) {
+                ref = cipher;
+            }
+            else if (cipher != ref) {
+                debug() << "CryptoTest: " << algo.name() << " on " << size << " bytes, "
+                        << AESImplementationName(*it) << " differs from " << AESImplementationName(impls.front()) << std::endl;
+                TSUNIT_FAIL("CryptoTest: AES implementations differ");
+            }
+        }
+    }
+}
+
+// Compare the throughput of all AES implementations in the main chaining modes.
+void CryptoTest::testAESThroughput()
+{
+    const std::vector<ts::AES::Implementation> impls(AESImplementations());
+    const size_t sizes[] = {176, 4096}; // 176 = largest multiple of 16 in a TS packet payload
+    const size_t total = 4 * 1024 * 1024;
+    const uint8_t key[16] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+
+    ts::ECB<ts::AES> ecb;
+    ts::CBC<ts::AES> cbc;
+    ts::CTR<ts::AES> ctr;
+    ts::CipherChaining* const algos[] = {&ecb, &cbc, &ctr};
+
+    for (size_t si = 0; si < sizeof(sizes) / sizeof(sizes[0]); ++si) {
+        ts::ByteBlock data(sizes[si], 0x5A);
+        for (size_t ai = 0; ai < sizeof(algos) / sizeof(algos[0]); ++ai) {
+            ts::CipherChaining& algo(*algos[ai]);
+            for (auto it = impls.begin(); it != impls.end(); ++it) {
+                TSUNIT_ASSERT(ts::AES::SetImplementation(*it));
+                TSUNIT_ASSERT(algo.setKey(key, sizeof(key)));
+                TSUNIT_ASSERT(algo.setIV(key, algo.maxIVSize()));
+                for (int decrypt = 0; decrypt < 2; ++decrypt) {
+                    const ts::Monotonic start(true);
+                    for (size_t done = 0; done < total; done += data.size()) {
+                        TSUNIT_ASSERT(decrypt ? algo.decryptInPlace(data.data(), data.size()) : algo.encryptInPlace(data.data(), data.size()));
+                    }
+                    const ts::NanoSecond ns = ts::Monotonic(true) - start;
+                    debug() << "CryptoTest: " << algo.name() << " " << (decrypt ? "decrypt" : "encrypt") << ", "
+                            << AESImplementationName(*it) << ", " << sizes[si] << "-byte messages: "
+                            << (ns <= 0 ? 0 : (total * ts::NanoSecPerSec) / (ns * 1024 * 1024)) << " MB/s" << std::endl;
+                }
+            }
+        }
+    }
+}
+
+// Each block processed by encryptBlocks() and decryptBlocks() is one use of the key.
+void CryptoTest::testAESBlocksKeyUsage()
+{
+    const uint8_t key[16] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    ts::ByteBlock data(8 * ts::AES::BLOCK_SIZE, 0x5A);
+    ts::AES aes;
+
+    TSUNIT_ASSERT(aes.setKey(key, sizeof(key)));
+    aes.setEncryptionMax(10);
+    aes.setDecryptionMax(8);
+
+    TSUNIT_ASSERT(aes.encryptBlocks(data.data(), data.data(), 8));
+    TSUNIT_EQUAL(8, aes.encryptionCount());
+    TSUNIT_ASSERT(!aes.encryptBlocks(data.data(), data.data(), 3));
+    TSUNIT_EQUAL(8, aes.encryptionCount());
+    TSUNIT_ASSERT(aes.encryptBlocks(data.data(), data.data(), 2));
+    TSUNIT_EQUAL(10, aes.encryptionCount());
+    TSUNIT_ASSERT(!aes.encrypt(data.data(), ts::AES::BLOCK_SIZE, data.data(), ts::AES::BLOCK_SIZE));
+
+    TSUNIT_ASSERT(aes.decryptBlocks(data.data(), data.data(), 8));
+    TSUNIT_EQUAL(8, aes.decryptionCount());
+    TSUNIT_ASSERT(!aes.decryptBlocks(data.data(), data.data(), 1));
+    TSUNIT_EQUAL(8, aes.decryptionCount());
+}
+
 void CryptoTest::testDES()
 {
     ts::DES des;
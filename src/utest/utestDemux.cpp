@@ -33,6 +33,7 @@
 
 #include "tsSectionDemux.h"
 #include "tsStandaloneTableDemux.h"
+#include "tsPESDemux.h"
 #include "tsOneShotPacketizer.h"
 #include "tsDuckContext.h"
 #include "tsTSPacket.h"
@@ -93,6 +94,7 @@ public:
     void testTDT();
     void testTOT();
     void testHEVC();
+    void testScatteredPES();
 
     TSUNIT_TEST_BEGIN(DemuxTest);
     TSUNIT_TEST(testPAT);
@@ -106,6 +108,7 @@ public:
     TSUNIT_TEST(testTDT);
     TSUNIT_TEST(testTOT);
     TSUNIT_TEST(testHEVC);
+    TSUNIT_TEST(testScatteredPES);
     TSUNIT_TEST_END();
 
 private:
@@ -490,3 +493,109 @@ void DemuxTest::testHEVC()
 {
     TEST_TABLE("PMT with HEVC descriptor", pmt_hevc);
 }
+
+
+//----------------------------------------------------------------------------
+// PES demux: compare contiguous and scattered PES packets.
+//----------------------------------------------------------------------------
+
+namespace {
+    class PESCollector: public ts::PESHandlerInterface
+    {
+    public:
+        std::vector<ts::ByteBlock> packets;
+        PESCollector() : packets() {}
+
+        virtual void handlePESPacket(ts::PESDemux&, const ts::PESPacket& pes) override
+        {
+            packets.push_back(ts::ByteBlock(pes.content(), pes.size()));
+        }
+
+        virtual void handleScatteredPESPacket(ts::PESDemux&, const ts::ScatteredPESPacket& pes) override
+        {
+            ts::ByteBlock data;
+            pes.getContent(data);
+            TSUNIT_EQUAL(data.size(), pes.size());
+            TSUNIT_ASSERT(pes.isValid());
+            TSUNIT_EQUAL(data[3], pes.getStreamId());
+            // Random access in the middle of the slices.
+            if (data.size() > 300) {
+                uint8_t buf[200];
+                TSUNIT_EQUAL(sizeof(buf), pes.read(100, buf, sizeof(buf)));
+                TSUNIT_EQUAL(0, ::memcmp(buf, data.data() + 100, sizeof(buf)));
+            }
+            packets.push_back(data);
+        }
+    };
+}
+
+void DemuxTest::testScatteredPES()
+{
+    const ts::PID pid = 100;
+    const size_t sizes[] = {100, 184, 185, 1000, 5000, 70000, 369, 200};
+    std::vector<ts::ByteBlock> ref;
+    ts::TSPacketVector packets;
+    uint8_t cc = 0;
+
+    // Build PES packets on one PID, bounded except the largest one.
+    // The last one is delivered before the end of the stream since it spans two TS packets.
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        ts::ByteBlock pes(sizes[i]);
+        for (size_t j = 0; j < pes.size(); ++j) {
+            pes[j] = uint8_t(i + j * 7);
+        }
+        pes[0] = 0x00;
+        pes[1] = 0x00;
+        pes[2] = 0x01;
+        pes[3] = 0xE0;
+        ts::PutUInt16(&pes[4], uint16_t(pes.size() > 0xFFFF ? 0 : pes.size() - 6));
+        pes[6] = 0x80;
+        pes[7] = 0x00;
+        pes[8] = 0x00;
+        ref.push_back(pes);
+
+        for (size_t offset = 0; offset < pes.size(); ) {
+            ts::TSPacket pkt;
+            pkt.init(pid, cc, 0);
+            cc = (cc + 1) % ts::CC_MAX;
+            pkt.setPUSI(offset == 0);
+            const size_t size = std::min(pes.size() - offset, ts::PKT_SIZE - 4);
+            TSUNIT_ASSERT(pkt.setPayloadSize(size));
+            ::memcpy(pkt.getPayload(), &pes[offset], size);
+            offset += size;
+            packets.push_back(pkt);
+        }
+    }
+
+    ts::DuckContext duck;
+
+    // Contiguous PES packets, one TS packet at a time.
+    PESCollector contiguous;
+    ts::PESDemux demux1(duck, &contiguous);
+    for (size_t i = 0; i < packets.size(); ++i) {
+        demux1.feedPacket(packets[i]);
+    }
+    TSUNIT_ASSERT(contiguous.packets == ref);
+
+    // Scattered PES packets, with PES packets across batches.
+    PESCollector scattered;
+    ts::PESDemux demux2(duck, &scattered);
+    demux2.setScatterMode(true);
+    TSUNIT_ASSERT(demux2.scatterMode());
+    for (size_t i = 0; i < packets.size(); i += 7) {
+        // Overwrite the fed packets after each batch, the demux must have copied what it needs.
+        ts::TSPacketVector batch(packets.begin() + i, packets.begin() + std::min(i + 7, packets.size()));
+        demux2.feedPackets(batch.data(), batch.size());
+        for (auto it = batch.begin(); it != batch.end(); ++it) {
+            it->init();
+        }
+    }
+    TSUNIT_ASSERT(scattered.packets == ref);
+
+    // Scattered PES packets, all in one batch.
+    PESCollector oneshot;
+    ts::PESDemux demux3(duck, &oneshot);
+    demux3.setScatterMode(true);
+    demux3.feedPackets(packets.data(), packets.size());
+    TSUNIT_ASSERT(oneshot.packets == ref);
+}
@@ -0,0 +1,609 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::ECMGClient
+//
+//----------------------------------------------------------------------------
+
+#include "tsECMGClient.h"
+#include "tsECMGSCS.h"
+#include "tsTCPServer.h"
+#include "tsTCPConnection.h"
+#include "tsIPUtils.h"
+#include "tsGuardCondition.h"
+#include "tsForkPipe.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "tsCerrReport.h"
+#include "utestTSUnitThread.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class ECMGClientTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testLatencyStatistics();
+    void testRequestWindow();
+    void testConcurrentGenerate();
+    void testEventLoopServer();
+
+    TSUNIT_TEST_BEGIN(ECMGClientTest);
+    TSUNIT_TEST(testLatencyStatistics);
+    TSUNIT_TEST(testRequestWindow);
+    TSUNIT_TEST(testConcurrentGenerate);
+    TSUNIT_TEST(testEventLoopServer);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(ECMGClientTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void ECMGClientTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void ECMGClientTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// A minimal fake ECMG, accepting one client in a thread.
+// ECM requests for CP numbers below SILENT_CP are answered after RESPONSE_DELAY.
+// ECM requests for CP numbers starting at SILENT_CP are never answered.
+//----------------------------------------------------------------------------
+
+namespace {
+    class FakeECMG: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(FakeECMG);
+    public:
+        static constexpr uint16_t SILENT_CP = 100;
+        static constexpr ts::MilliSecond RESPONSE_DELAY = 200;
+
+        // Constructor: start listening.
+        explicit FakeECMG(const ts::SocketAddress& address) :
+            utest::TSUnitThread(),
+            _server()
+        {
+            TSUNIT_ASSERT(_server.open(CERR));
+            TSUNIT_ASSERT(_server.reusePort(true, CERR));
+            TSUNIT_ASSERT(_server.bind(address, CERR));
+            TSUNIT_ASSERT(_server.listen(5, CERR));
+        }
+
+        // Destructor
+        ~FakeECMG()
+        {
+            waitForTermination();
+            _server.close(NULLREP);
+        }
+
+        // Thread execution
+        virtual void test() override
+        {
+            ts::tlv::Connection<ts::NullMutex> conn(ts::ecmgscs::Protocol::Instance());
+            ts::SocketAddress client;
+            TSUNIT_ASSERT(_server.accept(conn, client, CERR));
+
+            ts::tlv::MessagePtr msg;
+            while (conn.receive(msg, nullptr, NULLREP)) {
+                switch (msg->tag()) {
+                    case ts::ecmgscs::Tags::channel_setup: {
+                        ts::ecmgscs::ChannelSetup* const req = dynamic_cast<ts::ecmgscs::ChannelSetup*>(msg.pointer());
+                        TSUNIT_ASSERT(req != nullptr);
+                        ts::ecmgscs::ChannelStatus resp;
+                        resp.channel_id = req->channel_id;
+                        resp.section_TSpkt_flag = true;
+                        resp.ECM_rep_period = 100;
+                        resp.min_CP_duration = 10;
+                        resp.lead_CW = 1;
+                        resp.CW_per_msg = 2;
+                        resp.max_comp_time = 100;
+                        TSUNIT_ASSERT(conn.send(resp, CERR));
+                        break;
+                    }
+                    case ts::ecmgscs::Tags::stream_setup: {
+                        ts::ecmgscs::StreamSetup* const req = dynamic_cast<ts::ecmgscs::StreamSetup*>(msg.pointer());
+                        TSUNIT_ASSERT(req != nullptr);
+                        ts::ecmgscs::StreamStatus resp;
+                        resp.channel_id = req->channel_id;
+                        resp.stream_id = req->stream_id;
+                        resp.ECM_id = req->ECM_id;
+                        TSUNIT_ASSERT(conn.send(resp, CERR));
+                        break;
+                    }
+                    case ts::ecmgscs::Tags::stream_close_request: {
+                        ts::ecmgscs::StreamCloseRequest* const req = dynamic_cast<ts::ecmgscs::StreamCloseRequest*>(msg.pointer());
+                        TSUNIT_ASSERT(req != nullptr);
+                        ts::ecmgscs::StreamCloseResponse resp;
+                        resp.channel_id = req->channel_id;
+                        resp.stream_id = req->stream_id;
+                        TSUNIT_ASSERT(conn.send(resp, CERR));
+                        break;
+                    }
+                    case ts::ecmgscs::Tags::CW_provision: {
+                        ts::ecmgscs::CWProvision* const req = dynamic_cast<ts::ecmgscs::CWProvision*>(msg.pointer());
+                        TSUNIT_ASSERT(req != nullptr);
+                        if (req->CP_number < SILENT_CP) {
+                            ts::SleepThread(RESPONSE_DELAY);
+                            ts::ecmgscs::ECMResponse resp;
+                            resp.channel_id = req->channel_id;
+                            resp.stream_id = req->stream_id;
+                            resp.CP_number = req->CP_number;
+                            resp.ECM_datagram.resize(ts::PKT_SIZE, 0xFF);
+                            TSUNIT_ASSERT(conn.send(resp, CERR));
+                        }
+                        break;
+                    }
+                    default: {
+                        // channel_close and others, no response.
+                        break;
+                    }
+                }
+            }
+            conn.disconnect(NULLREP);
+            conn.close(NULLREP);
+        }
+
+    private:
+        ts::TCPServer _server;
+    };
+}
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint16_t FakeECMG::SILENT_CP;
+constexpr ts::MilliSecond FakeECMG::RESPONSE_DELAY;
+#endif
+
+
+//----------------------------------------------------------------------------
+// A handler of asynchronous ECM's, collecting the CP numbers.
+//----------------------------------------------------------------------------
+
+namespace {
+    class ECMHandler: public ts::ECMGClientHandlerInterface
+    {
+        TS_NOCOPY(ECMHandler);
+    public:
+        ECMHandler() : _mutex(), _cond(), _cp_numbers() {}
+
+        virtual void handleECM(const ts::ecmgscs::ECMResponse& response) override
+        {
+            ts::GuardCondition lock(_mutex, _cond);
+            _cp_numbers.insert(response.CP_number);
+            lock.signal();
+        }
+
+        // Wait until some number of ECM's are received, return the set of CP numbers.
+        std::set<uint16_t> wait(size_t count, ts::MilliSecond timeout)
+        {
+            ts::GuardCondition lock(_mutex, _cond);
+            while (_cp_numbers.size() < count && lock.waitCondition(timeout)) {
+            }
+            return _cp_numbers;
+        }
+
+    private:
+        ts::Mutex          _mutex;
+        ts::Condition      _cond;
+        std::set<uint16_t> _cp_numbers;
+    };
+}
+
+
+//----------------------------------------------------------------------------
+// A thread which synchronously generates ECM's on one ECM stream.
+//----------------------------------------------------------------------------
+
+namespace {
+    class ECMGenerator: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(ECMGenerator);
+    public:
+        static constexpr uint16_t ECM_COUNT = 2;
+
+        ECMGenerator(ts::ECMGClient& client, uint16_t stream_id) :
+            utest::TSUnitThread(),
+            _client(client),
+            _stream_id(stream_id)
+        {
+        }
+
+        ~ECMGenerator()
+        {
+            waitForTermination();
+        }
+
+        // Each response must be the one of our own request.
+        virtual void test() override
+        {
+            const ts::ByteBlock cw(8, uint8_t(_stream_id));
+            for (uint16_t cp = 0; cp < ECM_COUNT; ++cp) {
+                ts::ecmgscs::ECMResponse response;
+                TSUNIT_ASSERT(_client.generateECM(_stream_id, cp, cw, cw, ts::ByteBlock(), 0, response));
+                TSUNIT_EQUAL(_stream_id, response.stream_id);
+                TSUNIT_EQUAL(cp, response.CP_number);
+            }
+        }
+
+    private:
+        ts::ECMGClient& _client;
+        uint16_t        _stream_id;
+    };
+}
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint16_t ECMGenerator::ECM_COUNT;
+#endif
+
+
+//----------------------------------------------------------------------------
+// A thread which uses one ECMG channel with several ECM streams.
+//----------------------------------------------------------------------------
+
+namespace {
+    class ECMGChannel: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(ECMGChannel);
+    public:
+        static constexpr uint16_t STREAM_COUNT = 3;
+        static constexpr uint16_t ECM_COUNT = 5;
+
+        ECMGChannel(const ts::SocketAddress& address, uint16_t channel_id, ts::Report& report) :
+            utest::TSUnitThread(),
+            _address(address),
+            _channel_id(channel_id),
+            _report(report),
+            _connected(false)
+        {
+        }
+
+        // Check if the channel was connected to the server, valid after termination.
+        bool connected() const { return _connected; }
+
+        ~ECMGChannel()
+        {
+            waitForTermination();
+        }
+
+        virtual void test() override
+        {
+            ts::ECMGClientArgs args;
+            args.ecmg_address = _address;
+            args.ecm_channel_id = _channel_id;
+            args.ecm_stream_id = 1;
+            args.ecm_id = 100 * _channel_id + 1;
+            args.cp_duration = 10000;
+            args.max_ecm_requests = 4;
+
+            // The server may not listen yet, retry during a few seconds.
+            ts::ECMGClient client;
+            ts::ecmgscs::ChannelStatus channel_status;
+            ts::ecmgscs::StreamStatus stream_status;
+            ts::tlv::Logger logger(ts::Severity::Debug, &_report);
+            // Do not assert on connection failure, the main thread must still terminate the server.
+            for (int retry = 0; !client.connect(args, channel_status, stream_status, nullptr, logger); ++retry) {
+                if (retry >= 50) {
+                    return;
+                }
+                ts::SleepThread(100);
+            }
+            _connected = true;
+            TSUNIT_EQUAL(_channel_id, channel_status.channel_id);
+            for (uint16_t id = 2; id <= STREAM_COUNT; ++id) {
+                TSUNIT_ASSERT(client.addStream(id, 100 * _channel_id + id, args.cp_duration, stream_status));
+                TSUNIT_EQUAL(id, stream_status.stream_id);
+            }
+
+            // Asynchronous ECM's on all streams, the CP numbers are distinct on all streams.
+            const ts::ByteBlock cw(8, uint8_t(_channel_id));
+            ECMHandler handler;
+            for (uint16_t cp = 0; cp < ECM_COUNT; ++cp) {
+                for (uint16_t id = 1; id <= STREAM_COUNT; ++id) {
+                    TSUNIT_ASSERT(client.submitECM(id, 100 * id + cp, cw, cw, ts::ByteBlock(), 0, &handler));
+                }
+            }
+            TSUNIT_EQUAL(STREAM_COUNT * ECM_COUNT, handler.wait(STREAM_COUNT * ECM_COUNT, 5000).size());
+
+            // One synchronous ECM per stream.
+            for (uint16_t id = 1; id <= STREAM_COUNT; ++id) {
+                ts::ecmgscs::ECMResponse response;
+                TSUNIT_ASSERT(client.generateECM(id, 1000, cw, cw, ts::ByteBlock(), 0, response));
+                TSUNIT_EQUAL(_channel_id, response.channel_id);
+                TSUNIT_EQUAL(id, response.stream_id);
+                TSUNIT_EQUAL(1000, response.CP_number);
+                TSUNIT_ASSERT(!response.ECM_datagram.empty());
+            }
+
+            for (uint16_t id = 2; id <= STREAM_COUNT; ++id) {
+                TSUNIT_ASSERT(client.removeStream(id));
+            }
+            TSUNIT_ASSERT(client.disconnect());
+        }
+
+    private:
+        ts::SocketAddress _address;
+        uint16_t          _channel_id;
+        ts::Report&       _report;
+        volatile bool     _connected;
+    };
+}
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr uint16_t ECMGChannel::STREAM_COUNT;
+constexpr uint16_t ECMGChannel::ECM_COUNT;
+#endif
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void ECMGClientTest::testLatencyStatistics()
+{
+    ts::ECMGClient::LatencyStatistics stats;
+    std::vector<ts::NanoSecond> lat;
+
+    stats.compute(lat);
+    TSUNIT_EQUAL(0, stats.count);
+    TSUNIT_EQUAL(0, stats.min);
+    TSUNIT_EQUAL(0, stats.max);
+
+    // One single value, all statistics are the same.
+    lat.push_back(7 * ts::NanoSecPerMicroSec);
+    stats.compute(lat);
+    TSUNIT_EQUAL(1, stats.count);
+    TSUNIT_EQUAL(7, stats.min);
+    TSUNIT_EQUAL(7, stats.p50);
+    TSUNIT_EQUAL(7, stats.p90);
+    TSUNIT_EQUAL(7, stats.p99);
+    TSUNIT_EQUAL(7, stats.max);
+
+    // 1 to 100 microseconds, not in order.
+    lat.clear();
+    for (ts::NanoSecond i = 0; i < 100; ++i) {
+        lat.push_back(((i * 37) % 100 + 1) * ts::NanoSecPerMicroSec);
+    }
+    stats.compute(lat);
+    TSUNIT_EQUAL(100, stats.count);
+    TSUNIT_EQUAL(1, stats.min);
+    TSUNIT_EQUAL(50, stats.p50);
+    TSUNIT_EQUAL(90, stats.p90);
+    TSUNIT_EQUAL(99, stats.p99);
+    TSUNIT_EQUAL(100, stats.max);
+    TSUNIT_EQUAL(1 * ts::NanoSecPerMicroSec, lat.front());
+    TSUNIT_EQUAL(100 * ts::NanoSecPerMicroSec, lat.back());
+
+    // 10, 20, ... 100 microseconds: nearest rank, the 99th percentile is the maximum.
+    lat.clear();
+    for (ts::NanoSecond i = 10; i >= 1; --i) {
+        lat.push_back(i * 10 * ts::NanoSecPerMicroSec);
+    }
+    stats.compute(lat);
+    TSUNIT_EQUAL(10, stats.count);
+    TSUNIT_EQUAL(10, stats.min);
+    TSUNIT_EQUAL(50, stats.p50);
+    TSUNIT_EQUAL(90, stats.p90);
+    TSUNIT_EQUAL(100, stats.p99);
+    TSUNIT_EQUAL(100, stats.max);
+}
+
+void ECMGClientTest::testRequestWindow()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const ts::SocketAddress address(ts::IPAddress::LocalHost, 12350);
+    FakeECMG ecmg(address);
+    ecmg.start();
+
+    ts::ECMGClientArgs args;
+    args.ecmg_address = address;
+    args.ecm_channel_id = 1;
+    args.ecm_stream_id = 1;
+    args.ecm_id = 1;
+    args.cp_duration = 10000;
+    args.max_ecm_requests = 2;
+
+    ts::ECMGClient client;
+    ts::ecmgscs::ChannelStatus channel_status;
+    ts::ecmgscs::StreamStatus stream_status;
+    ts::tlv::Logger logger(ts::Severity::Debug, debugMode() ? static_cast<ts::Report*>(&CERR) : static_cast<ts::Report*>(&NULLREP));
+    TSUNIT_ASSERT(client.connect(args, channel_status, stream_status, nullptr, logger));
+    TSUNIT_ASSERT(client.isConnected());
+
+    const ts::ByteBlock cw(8, 0x55);
+    ECMHandler handler;
+
+    // The first two requests fill the window, they do not wait.
+    ts::Monotonic start(true);
+    TSUNIT_ASSERT(client.submitECM(0, cw, cw, ts::ByteBlock(), 0, &handler));
+    TSUNIT_ASSERT(client.submitECM(1, cw, cw, ts::ByteBlock(), 0, &handler));
+    ts::MilliSecond ms = (ts::Monotonic(true) - start) / ts::NanoSecPerMilliSec;
+    debug() << "ECMGClientTest::testRequestWindow: 2 requests submitted in " << ms << " ms" << std::endl;
+    TSUNIT_ASSERT(ms < FakeECMG::RESPONSE_DELAY);
+
+    // The third request waits for the completion of the first one.
+    TSUNIT_ASSERT(client.submitECM(2, cw, cw, ts::ByteBlock(), 0, &handler));
+    ms = (ts::Monotonic(true) - start) / ts::NanoSecPerMilliSec;
+    debug() << "ECMGClientTest::testRequestWindow: third request submitted after " << ms << " ms" << std::endl;
+    TSUNIT_ASSERT(ms >= FakeECMG::RESPONSE_DELAY / 2);
+
+    const std::set<uint16_t> cps(handler.wait(3, 10 * FakeECMG::RESPONSE_DELAY));
+    TSUNIT_EQUAL(3, cps.size());
+    TSUNIT_EQUAL(1, cps.count(0));
+    TSUNIT_EQUAL(1, cps.count(1));
+    TSUNIT_EQUAL(1, cps.count(2));
+
+    ts::ECMGClient::LatencyStatistics stats;
+    client.getLatencyStatistics(stats);
+    debug() << "ECMGClientTest::testRequestWindow: latency min: " << stats.min << ", max: " << stats.max << " us" << std::endl;
+    TSUNIT_EQUAL(3, stats.count);
+    TSUNIT_ASSERT(stats.min >= (FakeECMG::RESPONSE_DELAY / 2) * ts::MicroSecPerMilliSec);
+    TSUNIT_ASSERT(stats.max >= stats.min);
+
+    // Two requests which are never answered fill the window. The next one waits
+    // until the lost requests expire and their slots are recovered.
+    start.getSystemTime();
+    TSUNIT_ASSERT(client.submitECM(FakeECMG::SILENT_CP, cw, cw, ts::ByteBlock(), 0, &handler));
+    TSUNIT_ASSERT(client.submitECM(FakeECMG::SILENT_CP + 1, cw, cw, ts::ByteBlock(), 0, &handler));
+    TSUNIT_ASSERT(client.submitECM(3, cw, cw, ts::ByteBlock(), 0, &handler));
+    ms = (ts::Monotonic(true) - start) / ts::NanoSecPerMilliSec;
+    debug() << "ECMGClientTest::testRequestWindow: slot recovered after " << ms << " ms" << std::endl;
+    TSUNIT_ASSERT(ms >= 4000);
+
+    // The request in the recovered slot is normally answered. Lost requests are never notified.
+    const std::set<uint16_t> cps2(handler.wait(4, 10 * FakeECMG::RESPONSE_DELAY));
+    TSUNIT_EQUAL(4, cps2.size());
+    TSUNIT_EQUAL(1, cps2.count(3));
+    TSUNIT_EQUAL(0, cps2.count(FakeECMG::SILENT_CP));
+    TSUNIT_EQUAL(0, cps2.count(FakeECMG::SILENT_CP + 1));
+
+    // The window is no longer full, the next request does not wait.
+    start.getSystemTime();
+    TSUNIT_ASSERT(client.submitECM(4, cw, cw, ts::ByteBlock(), 0, &handler));
+    ms = (ts::Monotonic(true) - start) / ts::NanoSecPerMilliSec;
+    TSUNIT_ASSERT(ms < FakeECMG::RESPONSE_DELAY);
+    TSUNIT_EQUAL(5, handler.wait(5, 10 * FakeECMG::RESPONSE_DELAY).size());
+
+    TSUNIT_ASSERT(client.disconnect());
+}
+
+void ECMGClientTest::testConcurrentGenerate()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const ts::SocketAddress address(ts::IPAddress::LocalHost, 12351);
+    FakeECMG ecmg(address);
+    ecmg.start();
+
+    ts::ECMGClientArgs args;
+    args.ecmg_address = address;
+    args.ecm_channel_id = 1;
+    args.ecm_stream_id = 1;
+    args.ecm_id = 1;
+    args.cp_duration = 10000;
+    args.max_ecm_requests = 2;
+
+    ts::ECMGClient client;
+    ts::ecmgscs::ChannelStatus channel_status;
+    ts::ecmgscs::StreamStatus stream_status;
+    ts::tlv::Logger logger(ts::Severity::Debug, debugMode() ? static_cast<ts::Report*>(&CERR) : static_cast<ts::Report*>(&NULLREP));
+    TSUNIT_ASSERT(client.connect(args, channel_status, stream_status, nullptr, logger));
+
+    // Several application threads generate ECM's on distinct streams at the same time.
+    static constexpr uint16_t STREAM_COUNT = 4;
+    for (uint16_t id = 2; id <= STREAM_COUNT; ++id) {
+        TSUNIT_ASSERT(client.addStream(id, id, args.cp_duration, stream_status));
+        TSUNIT_EQUAL(id, stream_status.stream_id);
+    }
+    {
+        std::vector<ts::SafePtr<ECMGenerator>> generators;
+        for (uint16_t id = 1; id <= STREAM_COUNT; ++id) {
+            generators.push_back(new ECMGenerator(client, id));
+            generators.back()->start();
+        }
+        // Wait for the termination of all threads.
+        generators.clear();
+    }
+
+    ts::ECMGClient::LatencyStatistics stats;
+    client.getLatencyStatistics(stats);
+    TSUNIT_EQUAL(STREAM_COUNT * ECMGenerator::ECM_COUNT, stats.count);
+
+    TSUNIT_ASSERT(client.removeStream(STREAM_COUNT));
+    TSUNIT_ASSERT(client.disconnect());
+}
+
+void ECMGClientTest::testEventLoopServer()
+{
+    // Use the real tsecmg, in event loop mode, which is built in the same directory as the test program.
+    const ts::UString tsecmg(ts::DirectoryName(ts::ExecutableFile()) + ts::PathSeparator + u"tsecmg" + TS_EXECUTABLE_SUFFIX);
+    if (!ts::FileExists(tsecmg)) {
+        debug() << "ECMGClientTest::testEventLoopServer: " << tsecmg << " not found, skipped" << std::endl;
+        return;
+    }
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    // The server exits at the end of the sessions of all channels. It uses the same protocol version as the client.
+    static constexpr uint16_t CHANNEL_COUNT = 4;
+    const ts::SocketAddress address(ts::IPAddress::LocalHost, 12352);
+    const ts::UString command(ts::UString::Format(u"\"%s\" --event-loop --worker-threads 2 --comp-time 20 --max-sessions %d --port %d --ecmg-scs-version %d%s",
+                                                  {tsecmg, CHANNEL_COUNT, address.port(), ts::ecmgscs::Protocol::Instance()->version(), debugMode() ? u" --verbose" : u""}));
+    debug() << "ECMGClientTest::testEventLoopServer: " << command << std::endl;
+
+    ts::Report& report(debugMode() ? static_cast<ts::Report&>(CERR) : NULLREP);
+    ts::ForkPipe server;
+    TSUNIT_ASSERT(server.open(command, ts::ForkPipe::SYNCHRONOUS, 0, report, ts::ForkPipe::KEEP_BOTH, ts::ForkPipe::STDIN_NONE));
+
+    // All channels are simultaneously used, each one on its own TCP connection.
+    size_t failed = 0;
+    {
+        std::vector<ts::SafePtr<ECMGChannel>> channels;
+        for (uint16_t id = 1; id <= CHANNEL_COUNT; ++id) {
+            channels.push_back(new ECMGChannel(address, id, report));
+            channels.back()->start();
+        }
+        // Wait for the termination of all threads.
+        for (size_t i = 0; i < channels.size(); ++i) {
+            channels[i]->waitForTermination();
+            if (!channels[i]->connected()) {
+                failed++;
+            }
+        }
+    }
+
+    // The server exits after all its sessions only. Open and close the sessions of the
+    // channels which could not connect. Otherwise, waiting for the server would hang.
+    for (size_t i = 0; i < failed; ++i) {
+        ts::TCPConnection session;
+        if (session.open(report) && session.connect(address, report)) {
+            session.disconnect(report);
+        }
+        session.close(report);
+    }
+
+    // Wait for the termination of the server process.
+    TSUNIT_ASSERT(server.close(report));
+    TSUNIT_EQUAL(0, failed);
+}
@@ -40,6 +40,9 @@
 #include "tsjsonString.h"
 #include "tsjsonObject.h"
 #include "tsjsonArray.h"
+#include "tsjsonStreamWriter.h"
+#include "tsxmlDocument.h"
+#include "tsxmlElement.h"
 #include "tsCerrReport.h"
 #include "tsNullReport.h"
 #include "tsunit.h"
@@ -58,10 +61,16 @@ public:
 
     void testSimple();
     void testGitHub();
+    void testStreamWriter();
+    void testStreamWriterCompact();
+    void testStreamWriterXML();
 
     TSUNIT_TEST_BEGIN(JsonTest);
     TSUNIT_TEST(testSimple);
     TSUNIT_TEST(testGitHub);
+    TSUNIT_TEST(testStreamWriter);
+    TSUNIT_TEST(testStreamWriterCompact);
+    TSUNIT_TEST(testStreamWriterXML);
     TSUNIT_TEST_END();
 };
 
@@ -603,3 +612,98 @@ void JsonTest::testGitHub()
         u"}",
         jv->printed());
 }
+
+void JsonTest::testStreamWriter()
+{
+    ts::TextFormatter out;
+    out.setString();
+    ts::json::StreamWriter json(out);
+
+    json.beginObject();
+    json.addInteger(u"ab", 67);
+    json.addString(u"foo", u"b\"ar");
+    json.beginArray(u"list");
+    json.addBoolean(u"ignored", true);
+    json.addNull(ts::UString());
+    json.beginObject();
+    json.endObject();
+    json.endArray();
+    TSUNIT_EQUAL(1, json.depth());
+    json.close();
+    TSUNIT_EQUAL(0, json.depth());
+
+    TSUNIT_EQUAL(
+        u"{\n"
+        u"  \"ab\": 67,\n"
+        u"  \"foo\": \"b\\\"ar\",\n"
+        u"  \"list\": [\n"
+        u"    true,\n"
+        u"    null,\n"
+        u"    {}\n"
+        u"  ]\n"
+        u"}\n",
+        out.toString());
+
+    // Streamed output must be parsed back.
+    ts::json::ValuePtr jv;
+    TSUNIT_ASSERT(ts::json::Parse(jv, out.toString(), CERR));
+    TSUNIT_ASSERT(!jv.isNull());
+    TSUNIT_ASSERT(jv->isObject());
+    TSUNIT_EQUAL(67, jv->value(u"ab").toInteger());
+    TSUNIT_EQUAL(u"b\"ar", jv->value(u"foo").toString());
+    TSUNIT_EQUAL(3, jv->value(u"list").size());
+}
+
+void JsonTest::testStreamWriterCompact()
+{
+    ts::TextFormatter out;
+    out.setString();
+    ts::json::StreamWriter json(out, true);
+
+    json.beginObject();
+    json.addInteger(u"a", 0x10);
+    json.addBoolean(u"b", false);
+    json.addString(u"c", u"0012");
+    json.addString(u"d", u"foo");
+    json.endObject();
+
+    // A second top-level value goes on its own line.
+    ts::json::ValuePtr jv;
+    TSUNIT_ASSERT(ts::json::Parse(jv, u"[ 1, {\"x\": null, \"y\": \"z\"} ]", CERR));
+    json.addValue(ts::UString(), *jv);
+
+    TSUNIT_EQUAL(
+        u"{\"a\":16,\"b\":false,\"c\":\"0012\",\"d\":\"foo\"}\n"
+        u"[1,{\"x\":null,\"y\":\"z\"}]\n",
+        out.toString());
+}
+
+void JsonTest::testStreamWriterXML()
+{
+    ts::xml::Document doc(CERR);
+    TSUNIT_ASSERT(doc.parse(
+        u"<?xml version='1.0' encoding='UTF-8'?>\n"
+        u"<tsduck>\n"
+        u"  <PAT version='2' current='true' transport_stream_id='0x0012'>\n"
+        u"    <!-- comment -->\n"
+        u"    <service service_id='0x0001' program_map_PID='0x0100'/>\n"
+        u"    <name service_name='112' number='1,234'/>\n"
+        u"    <data>\n"
+        u"      01 02 03\n"
+        u"      04 05\n"
+        u"    </data>\n"
+        u"  </PAT>\n"
+        u"</tsduck>"));
+
+    ts::TextFormatter out;
+    out.setString();
+    ts::json::StreamWriter json(out, true);
+    json.addXML(ts::UString(), doc.rootElement()->firstChildElement());
+
+    TSUNIT_EQUAL(
+        u"{\"#name\":\"PAT\",\"version\":\"2\",\"current\":\"true\",\"transport_stream_id\":\"0x0012\",\"#nodes\":["
+        u"{\"#name\":\"service\",\"service_id\":\"0x0001\",\"program_map_PID\":\"0x0100\"},"
+        u"{\"#name\":\"name\",\"service_name\":\"112\",\"number\":\"1,234\"},"
+        u"{\"#name\":\"data\",\"#nodes\":[\"01 02 03 04 05\"]}]}\n",
+        out.toString());
+}
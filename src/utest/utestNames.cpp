@@ -85,6 +85,8 @@ public:
     void testAudioType();
     void testT2MIPacketType();
     void testPlatformId();
+    void testSectionHandle();
+    void testCache();
 
     TSUNIT_TEST_BEGIN(NamesTest);
     TSUNIT_TEST(testConfigFile);
@@ -123,6 +125,8 @@ public:
     TSUNIT_TEST(testAudioType);
     TSUNIT_TEST(testT2MIPacketType);
     TSUNIT_TEST(testPlatformId);
+    TSUNIT_TEST(testSectionHandle);
+    TSUNIT_TEST(testCache);
     TSUNIT_TEST_END();
 };
 
@@ -404,3 +408,82 @@ void NamesTest::testPlatformId()
     TSUNIT_EQUAL(u"0x000004 (TV digitale mobile, Telecom Italia)", ts::names::PlatformId(4, ts::names::FIRST));
     TSUNIT_EQUAL(u"VTC Mobile TV (0x704001)", ts::names::PlatformId(0x704001, ts::names::VALUE));
 }
+
+void NamesTest::testSectionHandle()
+{
+    const ts::NamesMain* repo = ts::NamesMain::Instance();
+    const ts::Names::SectionHandle section = repo->getSection(u"StreamType");
+    TSUNIT_ASSERT(section != nullptr);
+    TSUNIT_ASSERT(section == repo->getSection(u"  streamtype "));
+    TSUNIT_ASSERT(section == repo->getSection(u"STREAMTYPE"));
+    TSUNIT_ASSERT(repo->getSection(u"StreamTyp") == nullptr);
+    TSUNIT_ASSERT(repo->getSection(u"StreamTypeX") == nullptr);
+    TSUNIT_ASSERT(repo->getSection(u"") == nullptr);
+
+    TSUNIT_ASSERT(repo->nameExists(section, 0x1B));
+    TSUNIT_ASSERT(!repo->nameExists(nullptr, 0x1B));
+    TSUNIT_EQUAL(repo->nameFromSection(u"StreamType", 0x1B, ts::names::VALUE), repo->nameFromSection(section, 0x1B, ts::names::VALUE));
+    TSUNIT_EQUAL(u"unknown (0x1B)", repo->nameFromSection(nullptr, 0x1B, ts::names::NAME, 8));
+}
+
+void NamesTest::testCache()
+{
+    // Use private configuration and cache files.
+    const ts::UString cacheDir(ts::TempFile(u""));
+    const ts::UString fileName(ts::TempFile(u".names"));
+    const ts::UString cacheFile(cacheDir + ts::PathSeparator + ts::BaseName(fileName) + u".cache");
+    const bool hadEnv = ts::EnvironmentExists(ts::Names::CACHE_ENVIRONMENT_VARIABLE);
+    const ts::UString savedEnv(ts::GetEnvironment(ts::Names::CACHE_ENVIRONMENT_VARIABLE));
+    ts::SetEnvironment(ts::Names::CACHE_ENVIRONMENT_VARIABLE, cacheDir);
+
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringVector({
+        u"[Foo]",
+        u"Bits = 8",
+        u"0x01 = one",
+        u"0x10-0x1F = tens",
+        u"[Bar]",
+        u"100 = hundred",
+    }), fileName));
+
+    {
+        // First load, parse the configuration file and create the cache file.
+        ts::Names names(fileName);
+        TSUNIT_EQUAL(0, names.errorCount());
+        TSUNIT_ASSERT(!names.loadedFromCache());
+        TSUNIT_ASSERT(ts::FileExists(cacheFile));
+        TSUNIT_EQUAL(u"tens (0x12)", names.nameFromSection(u"foo", 0x12, ts::names::VALUE));
+    }
+    {
+        // Second load, map the cache file.
+        ts::Names names(fileName);
+        TSUNIT_ASSERT(names.loadedFromCache());
+        const ts::Names::SectionHandle foo = names.getSection(u"Foo");
+        TSUNIT_ASSERT(foo != nullptr);
+        TSUNIT_EQUAL(u"one", names.nameFromSection(foo, 0x01));
+        TSUNIT_EQUAL(u"tens (0x1F)", names.nameFromSection(foo, 0x1F, ts::names::VALUE));
+        TSUNIT_EQUAL(u"unknown (0x20)", names.nameFromSection(foo, 0x20, ts::names::VALUE));
+        TSUNIT_EQUAL(u"unknown (0x00)", names.nameFromSection(foo, 0x00, ts::names::VALUE));
+        TSUNIT_EQUAL(u"hundred", names.nameFromSection(u"BAR", 100));
+        TSUNIT_EQUAL(u"one", names.nameFromSectionWithFallback(foo, 0x02, 0x01));
+    }
+
+    // Modify the configuration file, the cache file is obsolete.
+    TSUNIT_ASSERT(ts::UString::Save(ts::UStringVector({u"[Foo]", u"0x01 = first"}), fileName));
+    {
+        ts::Names names(fileName);
+        TSUNIT_ASSERT(!names.loadedFromCache());
+        TSUNIT_EQUAL(u"first", names.nameFromSection(u"Foo", 0x01));
+        TSUNIT_ASSERT(names.getSection(u"Bar") == nullptr);
+    }
+
+    // Cleanup.
+    if (hadEnv) {
+        ts::SetEnvironment(ts::Names::CACHE_ENVIRONMENT_VARIABLE, savedEnv);
+    }
+    else {
+        ts::DeleteEnvironment(ts::Names::CACHE_ENVIRONMENT_VARIABLE);
+    }
+    ts::DeleteFile(cacheFile);
+    ts::DeleteFile(cacheDir);
+    ts::DeleteFile(fileName);
+}
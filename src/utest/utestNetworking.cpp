@@ -39,6 +39,9 @@
 #include "tsTCPConnection.h"
 #include "tsTCPServer.h"
 #include "tsUDPSocket.h"
+#include "tsUDPReceiver.h"
+#include "tsDuckContext.h"
+#include "tsArgs.h"
 #include "tsThread.h"
 #include "tsSysUtils.h"
 #include "tsIPUtils.h"
@@ -69,6 +72,8 @@ public:
     void testSocketAddress();
     void testTCPSocket();
     void testUDPSocket();
+    void testUDPBatch();
+    void testUDPBatchFiltered();
     void testIPHeader();
 
     TSUNIT_TEST_BEGIN(NetworkingTest);
@@ -81,6 +86,8 @@ public:
     TSUNIT_TEST(testSocketAddress);
     TSUNIT_TEST(testTCPSocket);
     TSUNIT_TEST(testUDPSocket);
+    TSUNIT_TEST(testUDPBatch);
+    TSUNIT_TEST(testUDPBatchFiltered);
     TSUNIT_TEST(testIPHeader);
     TSUNIT_TEST_END();
 
@@ -680,6 +687,128 @@ void NetworkingTest::testUDPSocket()
     CERR.debug(u"UDPSocketTest: main thread: reply sent");
 }
 
+// Test batch emission and reception of UDP messages.
+void NetworkingTest::testUDPBatch()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t portNumber = 12346;
+    const size_t msgCount = 20;
+    const size_t headerSize = 12;
+    const size_t payloadSize = 7 * 188;
+
+    // Create receiver socket
+    ts::UDPSocket receiver;
+    TSUNIT_ASSERT(receiver.open(CERR));
+    TSUNIT_ASSERT(receiver.reusePort(true, CERR));
+    TSUNIT_ASSERT(receiver.setReceiveBufferSize(1024 * 1024, CERR));
+    TSUNIT_ASSERT(receiver.bind(ts::SocketAddress(ts::IPAddress::LocalHost, portNumber), CERR));
+
+    // Create sender socket
+    ts::UDPSocket sender(true);
+    TSUNIT_ASSERT(sender.isOpen());
+    TSUNIT_ASSERT(sender.setDefaultDestination(ts::SocketAddress(ts::IPAddress::LocalHost, portNumber), CERR));
+
+    // Build messages: distinct headers, one common payload. The last message is shorter.
+    ts::ByteBlock headers(msgCount * headerSize);
+    ts::ByteBlock payload(payloadSize);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = uint8_t(i);
+    }
+    std::vector<ts::UDPSocket::OutputDatagram> out(msgCount);
+    for (size_t i = 0; i < msgCount; ++i) {
+        ::memset(&headers[i * headerSize], int(i), headerSize);
+        out[i] = ts::UDPSocket::OutputDatagram(payload.data(), i == msgCount - 1 ? 188 : payloadSize, &headers[i * headerSize], headerSize);
+    }
+    TSUNIT_ASSERT(sender.sendBatch(out.data(), out.size(), CERR));
+
+    // Receive all messages, possibly in several batches.
+    ts::ByteBlock buffer(msgCount * 2048);
+    std::vector<ts::UDPSocket::Datagram> in;
+    for (size_t i = 0; i < msgCount; ++i) {
+        in.push_back(ts::UDPSocket::Datagram(&buffer[i * 2048], 2048));
+    }
+    size_t received = 0;
+    while (received < msgCount) {
+        size_t count = 0;
+        TSUNIT_ASSERT(receiver.receiveBatch(&in[received], msgCount - received, count, nullptr, CERR));
+        TSUNIT_ASSERT(count > 0);
+        received += count;
+    }
+    TSUNIT_EQUAL(msgCount, received);
+
+    for (size_t i = 0; i < msgCount; ++i) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(in[i].data);
+        TSUNIT_EQUAL(headerSize + out[i].size, in[i].size);
+        TSUNIT_EQUAL(i, data[0]);
+        TSUNIT_EQUAL(i, data[headerSize - 1]);
+        TSUNIT_EQUAL(0, ::memcmp(data + headerSize, payload.data(), out[i].size));
+        TSUNIT_ASSERT(ts::IPAddress(in[i].sender) == ts::IPAddress::LocalHost);
+    }
+}
+
+// Test batch reception of UDP messages with a filtered source.
+void NetworkingTest::testUDPBatchFiltered()
+{
+    TSUNIT_ASSERT(ts::IPInitialize());
+
+    const uint16_t portNumber = 12347;
+    const uint16_t goodPort = 12348;
+    const uint16_t badPort = 12349;
+    const size_t msgCount = 10;
+    const size_t bufferSize = 2048;
+
+    // Create receiver, accepting messages from one source only.
+    ts::DuckContext duck;
+    ts::Args args(u"test", u"", ts::Args::NO_EXIT_ON_ERROR);
+    ts::UDPReceiver receiver(CERR);
+    receiver.defineArgs(args);
+    TSUNIT_ASSERT(args.analyze(u"test", {u"--source", ts::UString::Format(u"127.0.0.1:%d", {goodPort}), ts::UString::Decimal(portNumber, 0, true, u"")}));
+    TSUNIT_ASSERT(receiver.loadArgs(duck, args));
+    TSUNIT_ASSERT(receiver.open(CERR));
+
+    // Create two senders, one accepted, one rejected.
+    const ts::SocketAddress destination(ts::IPAddress::LocalHost, portNumber);
+    ts::UDPSocket good(true);
+    ts::UDPSocket bad(true);
+    TSUNIT_ASSERT(good.bind(ts::SocketAddress(ts::IPAddress::LocalHost, goodPort), CERR));
+    TSUNIT_ASSERT(bad.bind(ts::SocketAddress(ts::IPAddress::LocalHost, badPort), CERR));
+
+    // Interleave rejected and accepted messages, starting with a rejected one.
+    for (size_t i = 0; i < msgCount; ++i) {
+        const ts::ByteBlock bad_msg(100, uint8_t(0xF0 + i));
+        const ts::ByteBlock good_msg(200 + i, uint8_t(i));
+        TSUNIT_ASSERT(bad.send(bad_msg.data(), bad_msg.size(), destination, CERR));
+        TSUNIT_ASSERT(good.send(good_msg.data(), good_msg.size(), destination, CERR));
+    }
+
+    // Receive all accepted messages, possibly in several batches.
+    ts::ByteBlock buffer(2 * msgCount * bufferSize);
+    std::vector<ts::UDPSocket::Datagram> in;
+    for (size_t i = 0; i < 2 * msgCount; ++i) {
+        in.push_back(ts::UDPSocket::Datagram(&buffer[i * bufferSize], bufferSize));
+    }
+    size_t received = 0;
+    while (received < msgCount) {
+        size_t count = 0;
+        TSUNIT_ASSERT(receiver.receiveBatch(&in[received], in.size() - received, count, nullptr, CERR));
+        TSUNIT_ASSERT(count > 0);
+        received += count;
+    }
+    TSUNIT_EQUAL(msgCount, received);
+
+    // Each accepted message must be in the buffer of its own slot.
+    for (size_t i = 0; i < msgCount; ++i) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(in[i].data);
+        TSUNIT_ASSERT(data == &buffer[i * bufferSize]);
+        TSUNIT_EQUAL(bufferSize, in[i].max_size);
+        TSUNIT_EQUAL(200 + i, in[i].size);
+        TSUNIT_EQUAL(goodPort, in[i].sender.port());
+        TSUNIT_EQUAL(i, data[0]);
+        TSUNIT_EQUAL(i, data[in[i].size - 1]);
+    }
+}
+
 // Test IP header
 void NetworkingTest::testIPHeader()
 {
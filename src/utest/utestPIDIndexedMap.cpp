@@ -0,0 +1,253 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::PIDIndexedMap
+//
+//----------------------------------------------------------------------------
+
+#include "tsPIDIndexedMap.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PIDIndexedMapTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testAccess();
+    void testIterator();
+    void testErase();
+    void testCopy();
+
+    TSUNIT_TEST_BEGIN(PIDIndexedMapTest);
+    TSUNIT_TEST(testAccess);
+    TSUNIT_TEST(testIterator);
+    TSUNIT_TEST(testErase);
+    TSUNIT_TEST(testCopy);
+    TSUNIT_TEST_END();
+
+private:
+    // A PID context which counts its instances.
+    struct Context
+    {
+        int value;
+        static int instances;
+        Context() : value(0) { instances++; }
+        Context(const Context& other) : value(other.value) { instances++; }
+        Context& operator=(const Context& other) = default;
+        ~Context() { instances--; }
+    };
+    typedef ts::PIDIndexedMap<Context> ContextMap;
+
+    // Get the list of PID's in a map, in iteration order.
+    static std::vector<ts::PID> PIDs(const ContextMap& map);
+};
+
+TSUNIT_REGISTER(PIDIndexedMapTest);
+
+int PIDIndexedMapTest::Context::instances = 0;
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PIDIndexedMapTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void PIDIndexedMapTest::afterTest()
+{
+}
+
+std::vector<ts::PID> PIDIndexedMapTest::PIDs(const ContextMap& map)
+{
+    std::vector<ts::PID> pids;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        pids.push_back(it->first);
+    }
+    return pids;
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PIDIndexedMapTest::testAccess()
+{
+    {
+        ContextMap map;
+        TSUNIT_ASSERT(map.empty());
+        TSUNIT_EQUAL(0, map.size());
+        TSUNIT_ASSERT(map.begin() == map.end());
+        TSUNIT_ASSERT(map.find(100) == map.end());
+        TSUNIT_EQUAL(0, Context::instances);
+
+        map[100].value = 12;
+        map[ts::PID_NULL].value = 34;
+        TSUNIT_ASSERT(!map.empty());
+        TSUNIT_EQUAL(2, map.size());
+        TSUNIT_EQUAL(2, Context::instances);
+        TSUNIT_EQUAL(1, map.count(100));
+        TSUNIT_EQUAL(0, map.count(101));
+        TSUNIT_EQUAL(0, map.count(ts::PID_MAX));
+
+        auto it = map.find(100);
+        TSUNIT_ASSERT(it != map.end());
+        TSUNIT_EQUAL(100, it->first);
+        TSUNIT_EQUAL(12, it->second.value);
+
+        // Existing contexts are not recreated.
+        Context& ctx(map[ts::PID_NULL]);
+        TSUNIT_EQUAL(34, ctx.value);
+        TSUNIT_EQUAL(2, map.size());
+
+        // References remain valid when other contexts are created.
+        for (ts::PID pid = 0; pid < ts::PID_MAX; pid += 3) {
+            map[pid];
+        }
+        TSUNIT_EQUAL(34, ctx.value);
+        TSUNIT_EQUAL(12, map[100].value);
+    }
+    TSUNIT_EQUAL(0, Context::instances);
+}
+
+void PIDIndexedMapTest::testIterator()
+{
+    ContextMap map;
+    map[4000].value = 3;
+    map[0].value = 1;
+    map[ts::PID_NULL].value = 4;
+    map[33].value = 2;
+
+    // Same order as a std::map.
+    const std::vector<ts::PID> pids(PIDs(map));
+    TSUNIT_EQUAL(4, pids.size());
+    TSUNIT_EQUAL(0, pids[0]);
+    TSUNIT_EQUAL(33, pids[1]);
+    TSUNIT_EQUAL(4000, pids[2]);
+    TSUNIT_EQUAL(ts::PID_NULL, pids[3]);
+
+    int expected = 1;
+    for (const auto& it : map) {
+        TSUNIT_EQUAL(expected++, it.second.value);
+    }
+
+    for (auto& it : map) {
+        it.second.value *= 10;
+    }
+    TSUNIT_EQUAL(40, map[ts::PID_NULL].value);
+
+    const ContextMap& cmap(map);
+    ContextMap::const_iterator cit = cmap.find(4000);
+    TSUNIT_ASSERT(cit != cmap.end());
+    TSUNIT_EQUAL(30, cit->second.value);
+    ++cit;
+    TSUNIT_EQUAL(ts::PID_NULL, cit->first);
+    cit++;
+    TSUNIT_ASSERT(cit == cmap.end());
+
+    // An iterator converts to a const_iterator, not the reverse.
+    cit = map.find(33);
+    TSUNIT_EQUAL(20, cit->second.value);
+    TSUNIT_ASSERT((std::is_convertible<ContextMap::iterator, ContextMap::const_iterator>::value));
+    TSUNIT_ASSERT((!std::is_convertible<ContextMap::const_iterator, ContextMap::iterator>::value));
+}
+
+void PIDIndexedMapTest::testErase()
+{
+    ContextMap map;
+    for (ts::PID pid = 10; pid < 20; ++pid) {
+        map[pid].value = int(pid);
+    }
+    TSUNIT_EQUAL(10, map.size());
+    TSUNIT_EQUAL(10, Context::instances);
+
+    TSUNIT_EQUAL(1, map.erase(12));
+    TSUNIT_EQUAL(0, map.erase(12));
+    TSUNIT_EQUAL(0, map.erase(1000));
+    TSUNIT_EQUAL(9, map.size());
+    TSUNIT_EQUAL(9, Context::instances);
+
+    // Erase odd PID's while iterating.
+    for (auto it = map.begin(); it != map.end(); ) {
+        if (it->first % 2 != 0) {
+            it = map.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    const std::vector<ts::PID> pids(PIDs(map));
+    TSUNIT_EQUAL(4, pids.size());
+    TSUNIT_EQUAL(10, pids[0]);
+    TSUNIT_EQUAL(14, pids[1]);
+    TSUNIT_EQUAL(16, pids[2]);
+    TSUNIT_EQUAL(18, pids[3]);
+    TSUNIT_EQUAL(4, Context::instances);
+
+    map.clear();
+    TSUNIT_ASSERT(map.empty());
+    TSUNIT_ASSERT(map.begin() == map.end());
+    TSUNIT_EQUAL(0, Context::instances);
+}
+
+void PIDIndexedMapTest::testCopy()
+{
+    {
+        ContextMap map1;
+        map1[1].value = 10;
+        map1[2].value = 20;
+
+        ContextMap map2(map1);
+        TSUNIT_EQUAL(2, map2.size());
+        TSUNIT_EQUAL(4, Context::instances);
+        map2[1].value = 11;
+        TSUNIT_EQUAL(10, map1[1].value);
+        TSUNIT_EQUAL(11, map2[1].value);
+
+        ContextMap map3;
+        map3[3].value = 30;
+        map3 = map1;
+        TSUNIT_EQUAL(2, map3.size());
+        TSUNIT_EQUAL(0, map3.count(3));
+        TSUNIT_EQUAL(20, map3[2].value);
+        TSUNIT_EQUAL(6, Context::instances);
+    }
+    TSUNIT_EQUAL(0, Context::instances);
+}
@@ -59,14 +59,24 @@ public:
     virtual void afterTest() override;
 
     void testPacketizer();
+    void testReplace();
+    void testCache();
 
     TSUNIT_TEST_BEGIN(PacketizerTest);
     TSUNIT_TEST(testPacketizer);
+    TSUNIT_TEST(testReplace);
+    TSUNIT_TEST(testCache);
     TSUNIT_TEST_END();
 
 private:
     // Demux one table from a list of packets
     static void DemuxTable(ts::BinaryTablePtr& binTable, const char* name, const uint8_t* packets, size_t packets_size);
+
+    // Check that two packets are identical, except the continuity counter.
+    static bool SameButCC(const ts::TSPacket& pkt1, const ts::TSPacket& pkt2);
+
+    // Check that two packetizers generate exactly the same packets and have the same state.
+    static void CheckSamePackets(ts::CyclingPacketizer& pzer, ts::CyclingPacketizer& ref, size_t count);
 };
 
 TSUNIT_REGISTER(PacketizerTest);
@@ -178,3 +188,174 @@ void PacketizerTest::testPacketizer()
     TSUNIT_ASSERT(pmt_count == 4);
     TSUNIT_ASSERT(sdt_count >= 15 && sdt_count <= 18);
 }
+
+void PacketizerTest::testReplace()
+{
+    ts::DuckContext duck;
+    ts::BinaryTablePtr binpat;
+    ts::BinaryTablePtr binsdt;
+
+    DemuxTable(binpat, "PAT", psi_pat_r4_packets, sizeof(psi_pat_r4_packets));
+    DemuxTable(binsdt, "SDT", psi_sdt_r3_packets, sizeof(psi_sdt_r3_packets));
+
+    // Replace the tables several times in the packetizer, as a table update would do.
+    // Released section descriptors are reused by the next tables.
+
+    const ts::BitRate bitrate = ts::PKT_SIZE * 8 * 10; // 10 packets per second
+    ts::CyclingPacketizer pzer(duck, ts::PID_PAT, ts::CyclingPacketizer::ALWAYS, bitrate);
+
+    for (int iter = 0; iter < 4; ++iter) {
+        if (iter % 2 == 0) {
+            pzer.removeAll();
+        }
+        else {
+            pzer.removeSections(ts::TID_PAT);
+            pzer.removeSections(ts::TID_SDT_ACT, binsdt->tableIdExtension());
+        }
+        TSUNIT_EQUAL(0, pzer.storedSectionCount());
+
+        pzer.addTable(*binpat);
+        pzer.addTable(*binsdt, 250);
+        TSUNIT_EQUAL(2, pzer.storedSectionCount());
+
+        ts::SectionCounter pat_count = 0;
+        ts::SectionCounter sdt_count = 0;
+        for (int pi = 0; pi < 20; ++pi) {
+            ts::TSPacket pkt;
+            pzer.getNextPacket(pkt);
+            TSUNIT_EQUAL(ts::SYNC_BYTE, pkt.b[0]);
+            switch (pkt.b[5]) {
+                case ts::TID_PAT:
+                    pat_count++;
+                    break;
+                case ts::TID_SDT_ACT:
+                    sdt_count++;
+                    break;
+                default:
+                    TSUNIT_FAIL("unexpected TID");
+            }
+        }
+        debug() << "PacketizerTest: iteration " << iter << ": " << pat_count << " PAT, " << sdt_count << " SDT" << std::endl;
+        TSUNIT_ASSERT(sdt_count >= 7 && sdt_count <= 10);
+        TSUNIT_ASSERT(pat_count >= 10);
+    }
+}
+
+bool PacketizerTest::SameButCC(const ts::TSPacket& pkt1, const ts::TSPacket& pkt2)
+{
+    return ::memcmp(pkt1.b, pkt2.b, 3) == 0 && (pkt1.b[3] & 0xF0) == (pkt2.b[3] & 0xF0) && ::memcmp(pkt1.b + 4, pkt2.b + 4, ts::PKT_SIZE - 4) == 0;
+}
+
+void PacketizerTest::CheckSamePackets(ts::CyclingPacketizer& pzer, ts::CyclingPacketizer& ref, size_t count)
+{
+    for (size_t pi = 0; pi < count; ++pi) {
+        ts::TSPacket pkt1;
+        ts::TSPacket pkt2;
+        const bool ok1 = pzer.getNextPacket(pkt1);
+        const bool ok2 = ref.getNextPacket(pkt2);
+        TSUNIT_EQUAL(ok2, ok1);
+        TSUNIT_ASSERT(pkt1 == pkt2);
+        TSUNIT_EQUAL(ref.packetCount(), pzer.packetCount());
+        TSUNIT_EQUAL(ref.sectionCount(), pzer.sectionCount());
+        TSUNIT_EQUAL(ref.atCycleBoundary(), pzer.atCycleBoundary());
+    }
+}
+
+void PacketizerTest::testCache()
+{
+    ts::DuckContext duck;
+    ts::BinaryTablePtr binpat;
+    ts::BinaryTablePtr binpmt;
+    ts::BinaryTablePtr binsdt;
+
+    DemuxTable(binpat, "PAT", psi_pat_r4_packets, sizeof(psi_pat_r4_packets));
+    DemuxTable(binpmt, "PMT", psi_pmt_planete_packets, sizeof(psi_pmt_planete_packets));
+    DemuxTable(binsdt, "SDT", psi_sdt_r3_packets, sizeof(psi_sdt_r3_packets));
+
+    // Sections are packed inside a cycle: the first cycle is packetized, the next ones are replayed from the cache.
+    ts::CyclingPacketizer pzer(duck, ts::PID_PAT, ts::CyclingPacketizer::AT_END);
+    TSUNIT_ASSERT(pzer.cacheEnabled());
+    pzer.addTable(*binpat);
+    pzer.addTable(*binsdt);
+    pzer.addTable(*binpmt);
+
+    // Reference packetizer without cache, all its packets are built from the sections.
+    ts::CyclingPacketizer ref(duck, ts::PID_PAT, ts::CyclingPacketizer::AT_END);
+    ref.setCacheEnabled(false);
+    TSUNIT_ASSERT(!ref.cacheEnabled());
+    ref.addTable(*binpat);
+    ref.addTable(*binsdt);
+    ref.addTable(*binpmt);
+
+    ts::TSPacketVector cycle;
+    do {
+        cycle.resize(cycle.size() + 1);
+        TSUNIT_ASSERT(pzer.getNextPacket(cycle.back()));
+        ts::TSPacket pkt;
+        TSUNIT_ASSERT(ref.getNextPacket(pkt));
+        TSUNIT_ASSERT(pkt == cycle.back());
+    } while (!pzer.atCycleBoundary());
+    debug() << "PacketizerTest::testCache: " << cycle.size() << " packets per cycle" << std::endl;
+    TSUNIT_ASSERT(cycle.size() > 1);
+    TSUNIT_EQUAL(3, pzer.sectionCount());
+
+    uint8_t cc = pzer.nextContinuityCounter();
+    for (int count = 1; count <= 5; ++count) {
+        for (size_t pi = 0; pi < cycle.size(); ++pi) {
+            ts::TSPacket pkt;
+            TSUNIT_ASSERT(pzer.getNextPacket(pkt));
+            TSUNIT_ASSERT(SameButCC(cycle[pi], pkt));
+            TSUNIT_EQUAL(cc, pkt.getCC());
+            cc = (cc + 1) & 0x0F;
+            TSUNIT_EQUAL(pi + 1 == cycle.size(), pzer.atCycleBoundary());
+            ts::TSPacket pkt_ref;
+            TSUNIT_ASSERT(ref.getNextPacket(pkt_ref));
+            TSUNIT_ASSERT(pkt_ref == pkt);
+        }
+        TSUNIT_EQUAL((count + 1) * cycle.size(), pzer.packetCount());
+        TSUNIT_EQUAL(3 * (count + 1), pzer.sectionCount());
+        TSUNIT_EQUAL(ref.sectionCount(), pzer.sectionCount());
+    }
+
+    // Modify the sections at various points of a replayed cycle: the cache is invalidated
+    // and the result must be exactly the same as without cache, including the CC's.
+    const size_t offsets[] = {0, 1, cycle.size() / 2, cycle.size() - 1};
+    for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+        CheckSamePackets(pzer, ref, offsets[i]);
+        pzer.removeSections(ts::TID_SDT_ACT);
+        ref.removeSections(ts::TID_SDT_ACT);
+        pzer.addTable(*binsdt);
+        ref.addTable(*binsdt);
+        TSUNIT_EQUAL(3, pzer.storedSectionCount());
+        CheckSamePackets(pzer, ref, 3 * cycle.size());
+    }
+
+    // Change the stuffing policy in the middle of a replayed cycle.
+    CheckSamePackets(pzer, ref, cycle.size() / 2);
+    pzer.setStuffingPolicy(ts::CyclingPacketizer::ALWAYS);
+    ref.setStuffingPolicy(ts::CyclingPacketizer::ALWAYS);
+    CheckSamePackets(pzer, ref, 6 * cycle.size());
+
+    // Disable and enable the cache in the middle of a replayed cycle.
+    CheckSamePackets(pzer, ref, cycle.size() / 2);
+    pzer.setCacheEnabled(false);
+    CheckSamePackets(pzer, ref, 3 * cycle.size());
+    pzer.setCacheEnabled(true);
+    CheckSamePackets(pzer, ref, 6 * cycle.size());
+
+    // Reset the two packetizers in the middle of a replayed cycle, then reload the same sections.
+    CheckSamePackets(pzer, ref, cycle.size() / 2);
+    pzer.reset();
+    ref.reset();
+    TSUNIT_ASSERT(pzer.cacheEnabled());
+    TSUNIT_ASSERT(!ref.cacheEnabled());
+    TSUNIT_EQUAL(0, pzer.storedSectionCount());
+    CheckSamePackets(pzer, ref, 2);
+    pzer.addTable(*binpat);
+    pzer.addTable(*binsdt);
+    pzer.addTable(*binpmt);
+    ref.addTable(*binpat);
+    ref.addTable(*binsdt);
+    ref.addTable(*binpmt);
+    CheckSamePackets(pzer, ref, 6 * cycle.size());
+}
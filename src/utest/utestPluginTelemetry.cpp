@@ -0,0 +1,233 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::tsp::PluginTelemetry
+//
+//----------------------------------------------------------------------------
+
+#include "private/tstspPluginTelemetry.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class PluginTelemetryTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testHistogram();
+    void testPercentile();
+    void testReset();
+    void testText();
+
+    TSUNIT_TEST_BEGIN(PluginTelemetryTest);
+    TSUNIT_TEST(testHistogram);
+    TSUNIT_TEST(testPercentile);
+    TSUNIT_TEST(testReset);
+    TSUNIT_TEST(testText);
+    TSUNIT_TEST_END();
+};
+
+TSUNIT_REGISTER(PluginTelemetryTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void PluginTelemetryTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void PluginTelemetryTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void PluginTelemetryTest::testHistogram()
+{
+    ts::tsp::PluginTelemetry::Histogram hist;
+    TSUNIT_EQUAL(0, hist.count());
+    TSUNIT_EQUAL(0, hist.total());
+    TSUNIT_EQUAL(0, hist.maximum());
+    TSUNIT_EQUAL(0, hist.average());
+
+    for (uint64_t value : {0, 1, 2, 3, 4, 7, 8, 1000}) {
+        hist.add(value);
+    }
+    TSUNIT_EQUAL(8, hist.count());
+    TSUNIT_EQUAL(1025, hist.total());
+    TSUNIT_EQUAL(1000, hist.maximum());
+    TSUNIT_EQUAL(128, hist.average());
+
+    // Non-empty buckets only, by increasing upper bound.
+    ts::json::ValuePtr json(hist.toJSON());
+    debug() << "PluginTelemetryTest::testHistogram: " << json->printed() << std::endl;
+    TSUNIT_EQUAL(8, json->value(u"count").toInteger());
+    TSUNIT_EQUAL(1025, json->value(u"total").toInteger());
+    TSUNIT_EQUAL(128, json->value(u"average").toInteger());
+    TSUNIT_EQUAL(1000, json->value(u"max").toInteger());
+
+    const ts::json::Value& buckets(json->value(u"buckets"));
+    TSUNIT_ASSERT(buckets.isArray());
+    TSUNIT_EQUAL(6, buckets.size());
+    TSUNIT_EQUAL(0, buckets.at(0).value(u"up-to").toInteger());
+    TSUNIT_EQUAL(1, buckets.at(0).value(u"count").toInteger());
+    TSUNIT_EQUAL(1, buckets.at(1).value(u"up-to").toInteger());
+    TSUNIT_EQUAL(1, buckets.at(1).value(u"count").toInteger());
+    TSUNIT_EQUAL(3, buckets.at(2).value(u"up-to").toInteger());
+    TSUNIT_EQUAL(2, buckets.at(2).value(u"count").toInteger());
+    TSUNIT_EQUAL(7, buckets.at(3).value(u"up-to").toInteger());
+    TSUNIT_EQUAL(2, buckets.at(3).value(u"count").toInteger());
+    TSUNIT_EQUAL(15, buckets.at(4).value(u"up-to").toInteger());
+    TSUNIT_EQUAL(1, buckets.at(4).value(u"count").toInteger());
+    TSUNIT_EQUAL(1023, buckets.at(5).value(u"up-to").toInteger());
+    TSUNIT_EQUAL(1, buckets.at(5).value(u"count").toInteger());
+
+    // Huge values go into the last bucket, without upper bound.
+    hist.add(std::numeric_limits<uint64_t>::max());
+    json = hist.toJSON();
+    TSUNIT_EQUAL(7, json->value(u"buckets").size());
+    TSUNIT_ASSERT(json->value(u"buckets").at(6).value(u"up-to").isNull());
+    TSUNIT_EQUAL(1, json->value(u"buckets").at(6).value(u"count").toInteger());
+
+    hist.clear();
+    TSUNIT_EQUAL(0, hist.count());
+    TSUNIT_EQUAL(0, hist.total());
+    TSUNIT_EQUAL(0, hist.maximum());
+    TSUNIT_EQUAL(0, hist.toJSON()->value(u"buckets").size());
+}
+
+void PluginTelemetryTest::testPercentile()
+{
+    ts::tsp::PluginTelemetry::Histogram hist;
+    TSUNIT_EQUAL(0, hist.percentile(50));
+
+    // One single value: never more than the maximum.
+    hist.add(5);
+    TSUNIT_EQUAL(5, hist.percentile(0));
+    TSUNIT_EQUAL(5, hist.percentile(50));
+    TSUNIT_EQUAL(5, hist.percentile(100));
+
+    // Values 1 to 100: the percentile is the upper bound of the bucket of the nearest-rank value.
+    hist.clear();
+    for (uint64_t value = 100; value > 0; --value) {
+        hist.add(value);
+    }
+    TSUNIT_EQUAL(1, hist.percentile(0));
+    TSUNIT_EQUAL(1, hist.percentile(1));
+    TSUNIT_EQUAL(3, hist.percentile(2));
+    TSUNIT_EQUAL(15, hist.percentile(10));
+    TSUNIT_EQUAL(31, hist.percentile(16));
+    TSUNIT_EQUAL(63, hist.percentile(50));
+    TSUNIT_EQUAL(63, hist.percentile(63));
+    TSUNIT_EQUAL(100, hist.percentile(64));
+    TSUNIT_EQUAL(100, hist.percentile(99));
+    TSUNIT_EQUAL(100, hist.percentile(100));
+    TSUNIT_EQUAL(100, hist.percentile(1000));
+
+    ts::json::ValuePtr json(hist.toJSON());
+    TSUNIT_EQUAL(63, json->value(u"p50").toInteger());
+    TSUNIT_EQUAL(100, json->value(u"p99").toInteger());
+}
+
+void PluginTelemetryTest::testReset()
+{
+    ts::tsp::PluginTelemetry tm;
+
+    // One window of 1000 packets.
+    tm.startWait();
+    tm.endWait(1000);
+    tm.flushed(600);
+    tm.flushed(400);
+    tm.startWait();
+
+    TSUNIT_EQUAL(1000, tm.processedPackets());
+    TSUNIT_EQUAL(2, tm.flushCount());
+    TSUNIT_EQUAL(1, tm.waitTime().count());
+    TSUNIT_EQUAL(1, tm.processTime().count());
+    TSUNIT_EQUAL(1, tm.windowSize().count());
+    TSUNIT_EQUAL(1000, tm.windowSize().maximum());
+
+    // The reset is performed at the next wait.
+    tm.requestReset();
+    TSUNIT_EQUAL(1000, tm.processedPackets());
+    tm.startWait();
+    TSUNIT_EQUAL(0, tm.processedPackets());
+    TSUNIT_EQUAL(0, tm.processNanoSeconds());
+    TSUNIT_EQUAL(0, tm.flushCount());
+    TSUNIT_EQUAL(0, tm.waitTime().count());
+    TSUNIT_EQUAL(0, tm.processTime().count());
+    TSUNIT_EQUAL(0, tm.windowSize().count());
+    TSUNIT_EQUAL(0, tm.windowSize().maximum());
+
+    // Statistics restart after the reset.
+    tm.endWait(10);
+    tm.flushed(10);
+    tm.startWait();
+    TSUNIT_EQUAL(10, tm.processedPackets());
+    TSUNIT_EQUAL(1, tm.flushCount());
+    TSUNIT_EQUAL(10, tm.windowSize().maximum());
+}
+
+void PluginTelemetryTest::testText()
+{
+    ts::tsp::PluginTelemetry tm;
+    TSUNIT_EQUAL(u"packets: 0, process: 0 ns/pkt (p99 0, max 0), wait: 0 ns (p99 0, max 0), window: 0 pkt (max 0), flushes: 0", tm.toText());
+
+    tm.startWait();
+    tm.endWait(2000);
+    tm.flushed(2000);
+    tm.startWait();
+
+    const ts::UString text(tm.toText());
+    debug() << "PluginTelemetryTest::testText: " << text << std::endl;
+    TSUNIT_ASSERT(text.startWith(u"packets: 2,000, process: "));
+    TSUNIT_ASSERT(text.endWith(u", window: 2,000 pkt (max 2,000), flushes: 1"));
+
+    ts::json::ValuePtr json(tm.toJSON());
+    debug() << "PluginTelemetryTest::testText: " << json->printed() << std::endl;
+    TSUNIT_EQUAL(2000, json->value(u"packets").toInteger());
+    TSUNIT_EQUAL(1, json->value(u"flushes").toInteger());
+    TSUNIT_EQUAL(1, json->value(u"wait-ns").value(u"count").toInteger());
+    TSUNIT_EQUAL(1, json->value(u"process-ns-per-packet").value(u"count").toInteger());
+    TSUNIT_EQUAL(2000, json->value(u"window-packets").value(u"max").toInteger());
+    TSUNIT_EQUAL(2000, json->value(u"window-packets").value(u"p50").toInteger());
+}
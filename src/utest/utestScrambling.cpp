@@ -32,6 +32,8 @@
 //----------------------------------------------------------------------------
 
 #include "tsDVBCSA2.h"
+#include "tsTSScrambling.h"
+#include "tsNullReport.h"
 #include "tsTSPacket.h"
 #include "tsNames.h"
 #include "tsunit.h"
@@ -49,9 +51,15 @@ public:
     virtual void afterTest() override;
 
     void testScrambling();
+    void testBatch();
+    void testTSScrambling();
+    void testThreads();
 
     TSUNIT_TEST_BEGIN(ScramblingTest);
     TSUNIT_TEST(testScrambling);
+    TSUNIT_TEST(testBatch);
+    TSUNIT_TEST(testTSScrambling);
+    TSUNIT_TEST(testThreads);
     TSUNIT_TEST_END();
 };
 
@@ -70,6 +78,7 @@ void ScramblingTest::beforeTest()
 // Test suite cleanup method.
 void ScramblingTest::afterTest()
 {
+    ts::DVBCSA2::SetBatchMode(ts::DVBCSA2::BATCH_AUTO);
 }
 
 
@@ -211,3 +220,159 @@ void ScramblingTest::testScrambling()
         TSUNIT_ASSERT(::memcmp(pkt.b + header_size, vec->cipher.b + header_size, payload_size) == 0);
     }
 }
+
+// Batch scrambling and descrambling, on all implementations.
+void ScramblingTest::testBatch()
+{
+    const size_t vec_count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+    const ts::DVBCSA2::BatchMode modes[] = {
+        ts::DVBCSA2::BATCH_SERIAL,
+        ts::DVBCSA2::BATCH_BITSLICE64,
+        ts::DVBCSA2::BATCH_SSE2,
+        ts::DVBCSA2::BATCH_AVX2,
+    };
+
+    // All test vectors use the even key. Use various batch sizes to check partial groups.
+    const size_t counts[] = {1, 7, 64, 200, 600};
+
+    for (size_t mi = 0; mi < sizeof(modes) / sizeof(modes[0]); ++mi) {
+        if (!ts::DVBCSA2::SetBatchMode(modes[mi])) {
+            debug() << "ScramblingTest: batch mode " << int(modes[mi]) << " not supported" << std::endl;
+            continue;
+        }
+        TSUNIT_EQUAL(modes[mi], ts::DVBCSA2::GetBatchMode());
+
+        for (size_t ci = 0; ci < sizeof(counts) / sizeof(counts[0]); ++ci) {
+            const size_t count = counts[ci];
+            ts::DVBCSA2 scrambler;
+            TSUNIT_ASSERT(scrambler.setKey(scrambling_test_vectors[0].cw_even, ts::DVBCSA2::KEY_SIZE));
+
+            ts::TSPacketVector packets(count);
+            std::vector<ts::DVBCSA2::BatchEntry> entries(count);
+
+            // Descrambling test
+            for (size_t i = 0; i < count; ++i) {
+                packets[i] = scrambling_test_vectors[i % vec_count].cipher;
+                entries[i].data = packets[i].getPayload();
+                entries[i].size = packets[i].getPayloadSize();
+            }
+            TSUNIT_ASSERT(scrambler.decryptBatch(entries.data(), entries.size()));
+            for (size_t i = 0; i < count; ++i) {
+                const ts::TSPacket& plain(scrambling_test_vectors[i % vec_count].plain);
+                TSUNIT_ASSERT(::memcmp(packets[i].getPayload(), plain.getPayload(), plain.getPayloadSize()) == 0);
+            }
+
+            // Scrambling test
+            for (size_t i = 0; i < count; ++i) {
+                packets[i] = scrambling_test_vectors[i % vec_count].plain;
+            }
+            TSUNIT_ASSERT(scrambler.encryptBatch(entries.data(), entries.size()));
+            for (size_t i = 0; i < count; ++i) {
+                const ts::TSPacket& cipher(scrambling_test_vectors[i % vec_count].cipher);
+                TSUNIT_ASSERT(::memcmp(packets[i].getPayload(), cipher.getPayload(), cipher.getPayloadSize()) == 0);
+            }
+        }
+    }
+}
+
+// Batch descrambling of TS packets with alternating parities.
+void ScramblingTest::testTSScrambling()
+{
+    const size_t vec_count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+    const size_t count = 300;
+
+    ts::TSScrambling scrambling(NULLREP);
+    TSUNIT_ASSERT(scrambling.setScramblingType(ts::SCRAMBLING_DVB_CSA2));
+    scrambling.setEntropyMode(ts::DVBCSA2::FULL_CW);
+    TSUNIT_ASSERT(scrambling.setCW(ts::ByteBlock(scrambling_test_vectors[0].cw_even, ts::DVBCSA2::KEY_SIZE), ts::SC_EVEN_KEY));
+    TSUNIT_ASSERT(scrambling.setCW(ts::ByteBlock(scrambling_test_vectors[0].cw_even, ts::DVBCSA2::KEY_SIZE), ts::SC_ODD_KEY));
+
+    // Packets are marked with even and odd parity, by runs of various sizes, plus a few clear packets.
+    ts::TSPacketVector packets(count);
+    std::vector<ts::TSPacket*> pointers(count);
+    for (size_t i = 0; i < count; ++i) {
+        packets[i] = scrambling_test_vectors[i % vec_count].cipher;
+        packets[i].setScrambling((i / 50) % 2 == 0 ? ts::SC_EVEN_KEY : ts::SC_ODD_KEY);
+        if (i % 97 == 0) {
+            packets[i] = scrambling_test_vectors[i % vec_count].plain;
+        }
+        pointers[i] = &packets[i];
+    }
+
+    TSUNIT_ASSERT(scrambling.decrypt(pointers.data(), pointers.size()));
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_EQUAL(ts::SC_CLEAR, packets[i].getScrambling());
+        TSUNIT_ASSERT(packets[i] == scrambling_test_vectors[i % vec_count].plain);
+    }
+
+    TSUNIT_ASSERT(scrambling.setEncryptParity(ts::SC_EVEN_KEY));
+    TSUNIT_ASSERT(scrambling.encrypt(pointers.data(), pointers.size()));
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_ASSERT(packets[i] == scrambling_test_vectors[i % vec_count].cipher);
+    }
+}
+
+// Parallel scrambling and descrambling with several threads, all algorithms.
+void ScramblingTest::testThreads()
+{
+    const size_t vec_count = sizeof(scrambling_test_vectors) / sizeof(ScramblingTestVector);
+    const size_t count = 500;
+    const uint8_t types[] = {
+        ts::SCRAMBLING_DVB_CSA2,
+        ts::SCRAMBLING_DVB_CISSA1,
+        ts::SCRAMBLING_ATIS_IIF_IDSA,
+        ts::SCRAMBLING_DUCK_AES_CBC,
+        ts::SCRAMBLING_DUCK_AES_CTR,
+    };
+
+    for (size_t ti = 0; ti < sizeof(types) / sizeof(types[0]); ++ti) {
+
+        // Reference: serial processing. Same packets with various payload sizes.
+        ts::TSScrambling serial(NULLREP);
+        ts::TSScrambling parallel(NULLREP);
+        TSUNIT_ASSERT(serial.setScramblingType(types[ti]));
+        TSUNIT_ASSERT(parallel.setScramblingType(types[ti]));
+        parallel.setThreadCount(4);
+        TSUNIT_EQUAL(1, serial.threadCount());
+        TSUNIT_EQUAL(4, parallel.threadCount());
+
+        const ts::ByteBlock even(serial.cwSize(), 0x5A);
+        const ts::ByteBlock odd(serial.cwSize(), 0xA5);
+        TSUNIT_ASSERT(serial.setCW(even, ts::SC_EVEN_KEY));
+        TSUNIT_ASSERT(serial.setCW(odd, ts::SC_ODD_KEY));
+        TSUNIT_ASSERT(parallel.setCW(even, ts::SC_EVEN_KEY));
+        TSUNIT_ASSERT(parallel.setCW(odd, ts::SC_ODD_KEY));
+
+        ts::TSPacketVector ref(count);
+        ts::TSPacketVector packets(count);
+        std::vector<ts::TSPacket*> ref_pointers(count);
+        std::vector<ts::TSPacket*> pointers(count);
+        for (size_t i = 0; i < count; ++i) {
+            ref[i] = packets[i] = scrambling_test_vectors[i % vec_count].plain;
+            ref_pointers[i] = &ref[i];
+            pointers[i] = &packets[i];
+        }
+
+        // Encrypt with alternating parities, by chunks of various sizes.
+        int parity = 0;
+        for (size_t start = 0; start < count; start += 123) {
+            const size_t size = std::min<size_t>(123, count - start);
+            TSUNIT_ASSERT(serial.setEncryptParity(parity));
+            TSUNIT_ASSERT(parallel.setEncryptParity(parity));
+            TSUNIT_ASSERT(serial.encrypt(ref_pointers.data() + start, size));
+            TSUNIT_ASSERT(parallel.encrypt(pointers.data() + start, size));
+            parity ^= 1;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(packets[i] == ref[i]);
+            TSUNIT_ASSERT(packets[i].isScrambled() || !packets[i].hasPayload());
+        }
+
+        // Decrypt all packets at once, with runs of both parities.
+        TSUNIT_ASSERT(parallel.decrypt(pointers.data(), pointers.size()));
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_ASSERT(packets[i] == scrambling_test_vectors[i % vec_count].plain);
+        }
+        TSUNIT_ASSERT(parallel.stop());
+    }
+}
@@ -33,6 +33,7 @@
 
 #include "tsSection.h"
 #include "tsBinaryTable.h"
+#include "tsSectionPool.h"
 #include "tsNames.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
@@ -59,6 +60,8 @@ public:
     void testAssign();
     void testPackSections();
     void testSize();
+    void testPool();
+    void testPatch();
 
     TSUNIT_TEST_BEGIN(SectionTest);
     TSUNIT_TEST(testTOT);
@@ -68,6 +71,8 @@ public:
     TSUNIT_TEST(testAssign);
     TSUNIT_TEST(testPackSections);
     TSUNIT_TEST(testSize);
+    TSUNIT_TEST(testPool);
+    TSUNIT_TEST(testPatch);
     TSUNIT_TEST_END();
 
 private:
@@ -292,3 +297,110 @@ void SectionTest::testSize()
     TSUNIT_EQUAL(366, table.totalSize());
     TSUNIT_EQUAL(2, table.packetCount());
 }
+
+void SectionTest::testPool()
+{
+    ts::SectionPool pool(2);
+    TSUNIT_EQUAL(0, pool.size());
+    TSUNIT_EQUAL(2, pool.maxSize());
+
+    const uint64_t instances = ts::Section::InstanceCount();
+    const uint64_t buffers = ts::Section::BufferCount();
+
+    // Two sections are kept by the application, they cannot be reused.
+    ts::SectionPtr s1(pool.newSection(psi_tot_tnt_sections, sizeof(psi_tot_tnt_sections), ts::PID_TOT, ts::CRC32::CHECK));
+    ts::SectionPtr s2(pool.newSection(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections), ts::PID_BAT, ts::CRC32::CHECK));
+    TSUNIT_ASSERT(s1->isValid());
+    TSUNIT_ASSERT(s2->isValid());
+    TSUNIT_EQUAL(ts::TID_TOT, s1->tableId());
+    TSUNIT_EQUAL(ts::TID_BAT, s2->tableId());
+    TSUNIT_EQUAL(2, pool.size());
+    TSUNIT_EQUAL(2, pool.allocatedCount());
+    TSUNIT_EQUAL(0, pool.recycledCount());
+    TSUNIT_EQUAL(instances + 2, ts::Section::InstanceCount());
+    TSUNIT_EQUAL(buffers + 2, ts::Section::BufferCount());
+
+    // Release the first one, it is reused, including its content buffer.
+    const ts::Section* const addr1 = s1.pointer();
+    s1.clear();
+    ts::SectionPtr s3(pool.newSection(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections), ts::PID_NIT, ts::CRC32::CHECK));
+    TSUNIT_ASSERT(s3.pointer() == addr1);
+    TSUNIT_ASSERT(s3->isValid());
+    TSUNIT_EQUAL(ts::TID_NIT_ACT, s3->tableId());
+    TSUNIT_EQUAL(ts::PID_NIT, s3->sourcePID());
+    TSUNIT_EQUAL(sizeof(psi_nit_tntv23_sections), s3->size());
+    TSUNIT_EQUAL(0, ::memcmp(s3->content(), psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections)));
+    TSUNIT_EQUAL(2, pool.allocatedCount());
+    TSUNIT_EQUAL(1, pool.recycledCount());
+    TSUNIT_EQUAL(instances + 2, ts::Section::InstanceCount());
+
+    // A section with a shared content is reused but not its content buffer.
+    ts::Section shared(*s3, ts::SHARE);
+    s3.clear();
+    ts::SectionPtr s4(pool.newSection(psi_tot_tnt_sections, sizeof(psi_tot_tnt_sections), ts::PID_TOT, ts::CRC32::CHECK));
+    TSUNIT_ASSERT(s4.pointer() == addr1);
+    TSUNIT_EQUAL(ts::TID_TOT, s4->tableId());
+    TSUNIT_EQUAL(ts::TID_NIT_ACT, shared.tableId());
+    TSUNIT_EQUAL(0, ::memcmp(shared.content(), psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections)));
+    TSUNIT_EQUAL(2, pool.recycledCount());
+
+    // All sections in the full pool are used, a new one is allocated.
+    ts::SectionPtr s5(pool.newSection(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections), ts::PID_BAT, ts::CRC32::CHECK));
+    TSUNIT_ASSERT(s5->isValid());
+    TSUNIT_EQUAL(2, pool.size());
+    TSUNIT_EQUAL(3, pool.allocatedCount());
+    TSUNIT_EQUAL(2, pool.recycledCount());
+    TSUNIT_EQUAL(ts::TID_TOT, s4->tableId());
+    TSUNIT_EQUAL(ts::TID_BAT, s2->tableId());
+
+    pool.clear();
+    TSUNIT_EQUAL(0, pool.size());
+    TSUNIT_ASSERT(s2->isValid());
+    TSUNIT_ASSERT(s4->isValid());
+    TSUNIT_ASSERT(s5->isValid());
+}
+
+void SectionTest::testPatch()
+{
+    ts::Section sec(psi_nit_tntv23_sections, sizeof(psi_nit_tntv23_sections), ts::PID_NIT, ts::CRC32::CHECK);
+    TSUNIT_ASSERT(sec.isValid());
+    ts::Section ref(sec, ts::COPY);
+
+    // Patch header fields, compare with full recomputation of CRC32.
+    TSUNIT_ASSERT(sec.patchUInt16(3, 0x1234));
+    ref.setTableIdExtension(0x1234);
+    TSUNIT_EQUAL(0x1234, sec.tableIdExtension());
+    TSUNIT_ASSERT(sec == ref);
+
+    TSUNIT_ASSERT(sec.patchUInt8(5, uint8_t((sec.content()[5] & 0xC1) | (17 << 1))));
+    ref.setVersion(17);
+    TSUNIT_EQUAL(17, sec.version());
+    TSUNIT_ASSERT(sec == ref);
+
+    // Patch the payload.
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05};
+    TSUNIT_ASSERT(sec.patchBytes(sec.headerSize() + 10, data, sizeof(data)));
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        ref.setUInt8(10 + i, data[i]);
+    }
+    TSUNIT_ASSERT(sec == ref);
+    TSUNIT_EQUAL(0, ts::CRC32(sec.content(), sec.size()).value());
+
+    // Cannot patch the CRC32.
+    TSUNIT_ASSERT(!sec.patchBytes(sec.size() - 6, data, 3));
+    TSUNIT_ASSERT(sec.patchBytes(sec.size() - 6, data, 2));
+
+    // Same thing on complete tables.
+    ts::BinaryTable table;
+    TSUNIT_ASSERT(table.addSection(ts::SectionPtr(new ts::Section(psi_bat_tvnum_sections, sizeof(psi_bat_tvnum_sections), ts::PID_BAT, ts::CRC32::CHECK))));
+    TSUNIT_ASSERT(table.isValid());
+    ts::BinaryTable reftable;
+    reftable.copy(table);
+    table.patchVersion(9);
+    table.patchTableIdExtension(0xABCD);
+    reftable.setVersion(9);
+    reftable.setTableIdExtension(0xABCD);
+    TSUNIT_EQUAL(9, table.version());
+    TSUNIT_EQUAL(0xABCD, table.tableIdExtension());
+    TSUNIT_ASSERT(table == reftable);
+}
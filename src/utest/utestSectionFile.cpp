@@ -70,6 +70,7 @@ public:
     void testSCTE35();
     void testAllTables();
     void testBuildSections();
+    void testConvertErrors();
 
     TSUNIT_TEST_BEGIN(SectionFileTest);
     TSUNIT_TEST(testConfigurationFile);
@@ -80,6 +81,7 @@ public:
     TSUNIT_TEST(testSCTE35);
     TSUNIT_TEST(testAllTables);
     TSUNIT_TEST(testBuildSections);
+    TSUNIT_TEST(testConvertErrors);
     TSUNIT_TEST_END();
 
 private:
@@ -473,3 +475,33 @@ void SectionFileTest::testBuildSections()
     ts::TDT xmlTDT(duck, *xmlFile.tables()[2]);
     TSUNIT_ASSERT(tdtTime == xmlTDT.utc_time);
 }
+
+void SectionFileTest::testConvertErrors()
+{
+    ts::DuckContext duck;
+    ts::SectionFile file(duck);
+
+    // A complete section followed by a truncated one.
+    {
+        std::ofstream strm(_tempFileNameBin.toUTF8().c_str(), std::ios::out | std::ios::binary);
+        strm.write(reinterpret_cast<const char*>(psi_pat1_sections), sizeof(psi_pat1_sections));
+        strm.write(reinterpret_cast<const char*>(psi_pat1_sections), 10);
+    }
+    TSUNIT_ASSERT(!file.convertBinaryToXML(_tempFileNameBin, _tempFileNameXML, false, NULLREP));
+    TSUNIT_ASSERT(!ts::FileExists(_tempFileNameXML));
+
+    // Same without the truncated section.
+    {
+        std::ofstream strm(_tempFileNameBin.toUTF8().c_str(), std::ios::out | std::ios::binary);
+        strm.write(reinterpret_cast<const char*>(psi_pat1_sections), sizeof(psi_pat1_sections));
+    }
+    TSUNIT_ASSERT(file.convertBinaryToXML(_tempFileNameBin, _tempFileNameXML, false, report()));
+    TSUNIT_ASSERT(ts::FileExists(_tempFileNameXML));
+    TSUNIT_ASSERT(file.loadXML(_tempFileNameXML, report()));
+    TSUNIT_EQUAL(1, file.tables().size());
+
+#if defined(TS_LINUX)
+    // Write errors are reported, the disk is always full on /dev/full.
+    TSUNIT_ASSERT(!file.saveXML(u"/dev/full", NULLREP));
+#endif
+}
@@ -0,0 +1,337 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSAnalyzer
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSAnalyzerReport.h"
+#include "tsCyclingPacketizer.h"
+#include "tsDuckContext.h"
+#include "tsISO639LanguageDescriptor.h"
+#include "tsPAT.h"
+#include "tsPMT.h"
+#include "tsSDT.h"
+#include "tsjson.h"
+#include "tsCerrReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSAnalyzerTest: public tsunit::Test
+{
+public:
+    TSAnalyzerTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testMerge();
+    void testJSON();
+
+    TSUNIT_TEST_BEGIN(TSAnalyzerTest);
+    TSUNIT_TEST(testMerge);
+    TSUNIT_TEST(testJSON);
+    TSUNIT_TEST_END();
+
+private:
+    ts::TSPacketVector _stream;
+
+    // Build a synthetic transport stream.
+    void buildStream();
+
+    // Get a normalized report, without system times.
+    static ts::UString NormalizedReport(ts::TSAnalyzerReport& analyzer);
+
+    // Analyze the stream in chunks, starting at the specified packet indexes, and merge the analyses.
+    ts::UString chunkedReport(const std::vector<size_t>& starts, size_t preload);
+};
+
+TSUNIT_REGISTER(TSAnalyzerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TSAnalyzerTest::TSAnalyzerTest() :
+    _stream()
+{
+}
+
+// Test suite initialization method.
+void TSAnalyzerTest::beforeTest()
+{
+    if (_stream.empty()) {
+        buildStream();
+    }
+}
+
+// Test suite cleanup method.
+void TSAnalyzerTest::afterTest()
+{
+}
+
+
+//----------------------------------------------------------------------------
+// Build a synthetic transport stream:
+// - PAT and PMT, one packet every 100 packets, PMT version changes halfway.
+// - SDT spanning several packets, one packet every 50 packets.
+// - Video PID with PCR's, PES starts, one discontinuity and one duplicated packet.
+// - Audio PID with crypto-periods.
+// - Null packets.
+//----------------------------------------------------------------------------
+
+void TSAnalyzerTest::buildStream()
+{
+    const size_t total = 4000;
+    const ts::PID pmt_pid = 100;
+    const ts::PID video_pid = 200;
+    const ts::PID audio_pid = 300;
+    const uint64_t bitrate = 4000000;
+
+    ts::DuckContext duck;
+
+    ts::PAT pat(1, true, 0x1234);
+    pat.pmts[1] = pmt_pid;
+    ts::CyclingPacketizer pz_pat(duck, ts::PID_PAT);
+    pz_pat.addTable(duck, pat);
+
+    ts::PMT pmt(1, true, 1, video_pid);
+    pmt.streams[video_pid].stream_type = ts::ST_MPEG2_VIDEO;
+    pmt.streams[audio_pid].stream_type = ts::ST_MPEG2_AUDIO;
+    pmt.streams[audio_pid].descs.add(duck, ts::ISO639LanguageDescriptor(u"fra", 0));
+    ts::CyclingPacketizer pz_pmt(duck, pmt_pid);
+    pz_pmt.addTable(duck, pmt);
+
+    ts::SDT sdt(true, 3, true, 0x1234, 0x5678);
+    for (uint16_t id = 1; id <= 20; ++id) {
+        sdt.services[id].setName(duck, ts::UString::Format(u"Service number %d with a rather long name", {id}));
+        sdt.services[id].setProvider(duck, u"TSDuck");
+    }
+    ts::CyclingPacketizer pz_sdt(duck, ts::PID_SDT);
+    pz_sdt.addTable(duck, sdt);
+
+    uint8_t video_cc = 0;
+    uint8_t audio_cc = 0;
+    size_t video_index = 0;
+    size_t audio_index = 0;
+
+    _stream.resize(total);
+    for (size_t i = 0; i < total; ++i) {
+        ts::TSPacket& pkt(_stream[i]);
+        if (i == total / 2) {
+            pmt.version = 2;
+            pz_pmt.removeAll();
+            pz_pmt.addTable(duck, pmt);
+        }
+        if (i % 100 == 0) {
+            pz_pat.getNextPacket(pkt);
+        }
+        else if (i % 100 == 1) {
+            pz_pmt.getNextPacket(pkt);
+        }
+        else if (i % 50 == 25) {
+            pz_sdt.getNextPacket(pkt);
+        }
+        else if (i % 7 == 3) {
+            pkt = ts::NullPacket;
+        }
+        else if (i % 3 != 0) {
+            if (i == 1234) {
+                video_cc++;  // unexpected discontinuity
+            }
+            if (i == 3001) {
+                video_cc--;  // duplicated packet
+            }
+            pkt.init(video_pid, video_cc, 0xA5);
+            video_cc = (video_cc + 1) % ts::CC_MAX;
+            if (video_index % 20 == 0) {
+                pkt.setPUSI();
+                pkt.b[4] = pkt.b[5] = 0x00;
+                pkt.b[6] = 0x01;
+                pkt.b[7] = 0xE0;
+            }
+            if (video_index % 10 == 0) {
+                pkt.setPCR(1 + (uint64_t(i) * ts::PKT_SIZE * 8 * ts::SYSTEM_CLOCK_FREQ) / bitrate, true);
+            }
+            if (i == 2600) {
+                pkt.setDiscontinuityIndicator(true);
+            }
+            video_index++;
+        }
+        else {
+            pkt.init(audio_pid, audio_cc, 0x5A);
+            audio_cc = (audio_cc + 1) % ts::CC_MAX;
+            if (audio_index % 10 == 0) {
+                pkt.setPUSI();
+                pkt.b[4] = pkt.b[5] = 0x00;
+                pkt.b[6] = 0x01;
+                pkt.b[7] = 0xC0;
+            }
+            if (audio_index >= 100) {
+                pkt.setScrambling((audio_index / 150) % 2 == 0 ? ts::SC_EVEN_KEY : ts::SC_ODD_KEY);
+            }
+            audio_index++;
+        }
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Get a normalized report, without system times.
+//----------------------------------------------------------------------------
+
+ts::UString TSAnalyzerTest::NormalizedReport(ts::TSAnalyzerReport& analyzer)
+{
+    std::ostringstream strm;
+    analyzer.reportNormalized(strm);
+
+    ts::UStringList lines;
+    ts::UString::FromUTF8(strm.str()).toRemoved(u"\r").split(lines, u'\n', false, true);
+
+    ts::UString report;
+    for (auto it = lines.begin(); it != lines.end(); ++it) {
+        if (!it->contain(u":system:")) {
+            report.append(*it);
+            report.append(u"\n");
+        }
+    }
+    return report;
+}
+
+
+//----------------------------------------------------------------------------
+// Analyze the stream in chunks and merge the analyses.
+//----------------------------------------------------------------------------
+
+ts::UString TSAnalyzerTest::chunkedReport(const std::vector<size_t>& starts, size_t preload)
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzerReport merged(duck);
+
+    for (size_t ci = 0; ci < starts.size(); ++ci) {
+        const size_t first = starts[ci];
+        const size_t last = ci + 1 < starts.size() ? starts[ci + 1] : _stream.size();
+        ts::TSAnalyzer chunk(duck);
+        for (size_t i = first - std::min(first, preload); i < first; ++i) {
+            chunk.preloadPacket(_stream[i]);
+        }
+        for (size_t i = first; i < last; ++i) {
+            chunk.feedPacket(_stream[i]);
+        }
+        merged.merge(chunk);
+    }
+    return NormalizedReport(merged);
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSAnalyzerTest::testMerge()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzerReport sequential(duck);
+    for (size_t i = 0; i < _stream.size(); ++i) {
+        sequential.feedPacket(_stream[i]);
+    }
+    const ts::UString reference(NormalizedReport(sequential));
+    debug() << "TSAnalyzerTest::testMerge: sequential analysis:" << std::endl << reference;
+
+    // Split at various places: PSI packets, inside the multi-packet SDT, around the
+    // discontinuities, inside and at the end of crypto-periods, near PCR's.
+    TSUNIT_EQUAL(reference, chunkedReport({0}, 500));
+    TSUNIT_EQUAL(reference, chunkedReport({0, 2000}, 500));
+    TSUNIT_EQUAL(reference, chunkedReport({0, 1, 2, 26, 27, 100, 101}, 500));
+    TSUNIT_EQUAL(reference, chunkedReport({0, 1233, 1234, 1235, 2600, 2601, 3001, 3002}, 500));
+    TSUNIT_EQUAL(reference, chunkedReport({0, 270, 750, 751, 1650, 3999}, 500));
+
+    std::vector<size_t> starts;
+    for (size_t i = 0; i < _stream.size(); i += 337) {
+        starts.push_back(i);
+    }
+    TSUNIT_EQUAL(reference, chunkedReport(starts, 500));
+}
+
+void TSAnalyzerTest::testJSON()
+{
+    ts::DuckContext duck;
+    ts::TSAnalyzerReport analyzer(duck);
+    for (size_t i = 0; i < _stream.size(); ++i) {
+        analyzer.feedPacket(_stream[i]);
+    }
+
+    // Indented JSON report, must be valid JSON.
+    std::ostringstream strm;
+    analyzer.reportJSON(strm, u"foo");
+    const ts::UString text(ts::UString::FromUTF8(strm.str()));
+    debug() << "TSAnalyzerTest::testJSON: " << text << std::endl;
+
+    ts::json::ValuePtr root;
+    TSUNIT_ASSERT(ts::json::Parse(root, text, CERR));
+    TSUNIT_ASSERT(!root.isNull());
+    TSUNIT_ASSERT(root->isObject());
+    TSUNIT_EQUAL(u"foo", root->value(u"title").toString());
+    TSUNIT_EQUAL(0x1234, root->value(u"ts").value(u"id").toInteger());
+    TSUNIT_EQUAL(int64_t(_stream.size()), root->value(u"ts").value(u"packets").value(u"total").toInteger());
+    // One service in the PAT, 20 services in the SDT, only the first one is scrambled.
+    TSUNIT_EQUAL(20, root->value(u"ts").value(u"services").value(u"total").toInteger());
+    TSUNIT_EQUAL(1, root->value(u"ts").value(u"services").value(u"scrambled").toInteger());
+
+    const ts::json::Value& services(root->value(u"services"));
+    TSUNIT_ASSERT(services.isArray());
+    TSUNIT_EQUAL(20, services.size());
+    TSUNIT_EQUAL(1, services.at(0).value(u"id").toInteger());
+    TSUNIT_EQUAL(100, services.at(0).value(u"pmt-pid").toInteger());
+    TSUNIT_EQUAL(200, services.at(0).value(u"pcr-pid").toInteger());
+    TSUNIT_EQUAL(u"Service number 1 with a rather long name", services.at(0).value(u"name").toString());
+    TSUNIT_EQUAL(u"TSDuck", services.at(0).value(u"provider").toString());
+    TSUNIT_EQUAL(20, services.at(19).value(u"id").toInteger());
+    TSUNIT_EQUAL(u"Service number 20 with a rather long name", services.at(19).value(u"name").toString());
+
+    // Compact report: same content on one single line (--json-line).
+    std::ostringstream line;
+    analyzer.reportJSON(line, u"foo", true);
+    const ts::UString compact(ts::UString::FromUTF8(line.str()));
+    debug() << "TSAnalyzerTest::testJSON: " << compact << std::endl;
+    TSUNIT_ASSERT(!compact.empty());
+    TSUNIT_EQUAL(compact.size() - 1, compact.find(u'\n'));
+
+    ts::json::ValuePtr root_line;
+    TSUNIT_ASSERT(ts::json::Parse(root_line, compact, CERR));
+    TSUNIT_ASSERT(!root_line.isNull());
+    TSUNIT_EQUAL(root->printed(), root_line->printed());
+}
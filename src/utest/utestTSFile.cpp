@@ -34,6 +34,7 @@
 #include "tsTSFile.h"
 #include "tsTSPacket.h"
 #include "tsTSPacketMetadata.h"
+#include "tsByteBlock.h"
 #include "tsCerrReport.h"
 #include "tsSysUtils.h"
 #include "tsunit.h"
@@ -55,15 +56,22 @@ public:
     void testTS();
     void testM2TS();
     void testDuck();
+    void testReadModes();
+    void testResync();
 
     TSUNIT_TEST_BEGIN(TSFileTest);
     TSUNIT_TEST(testTS);
     TSUNIT_TEST(testM2TS);
     TSUNIT_TEST(testDuck);
+    TSUNIT_TEST(testReadModes);
+    TSUNIT_TEST(testResync);
     TSUNIT_TEST_END();
 
 private:
     ts::UString _tempFileName;
+
+    void checkReadMode(ts::TSFile::ReadMode mode, ts::TSFile::PacketFormat format, size_t packet_count);
+    void checkResync(ts::TSFile::ReadMode mode);
 };
 
 TSUNIT_REGISTER(TSFileTest);
@@ -265,3 +273,117 @@ void TSFileTest::testDuck()
     TSUNIT_EQUAL(0, file.readPackets(&packet, &mdata, 1, CERR));
     TSUNIT_ASSERT(file.close(CERR));
 }
+
+void TSFileTest::testReadModes()
+{
+    // Large enough to use several direct read requests.
+    checkReadMode(ts::TSFile::READ_STANDARD, ts::TSFile::FMT_TS, 20000);
+    checkReadMode(ts::TSFile::READ_MMAP, ts::TSFile::FMT_TS, 20000);
+    checkReadMode(ts::TSFile::READ_DIRECT, ts::TSFile::FMT_TS, 20000);
+    checkReadMode(ts::TSFile::READ_MMAP, ts::TSFile::FMT_M2TS, 1000);
+    checkReadMode(ts::TSFile::READ_DIRECT, ts::TSFile::FMT_M2TS, 1000);
+    checkReadMode(ts::TSFile::READ_MMAP, ts::TSFile::FMT_DUCK, 1000);
+    checkReadMode(ts::TSFile::READ_DIRECT, ts::TSFile::FMT_DUCK, 1000);
+}
+
+void TSFileTest::checkReadMode(ts::TSFile::ReadMode mode, ts::TSFile::PacketFormat format, size_t packet_count)
+{
+    debug() << "TSFileTest::checkReadMode: mode " << ts::TSFile::ReadModeEnum.name(mode) << ", format " << ts::TSFile::FormatEnum.name(format) << std::endl;
+    ts::DeleteFile(_tempFileName);
+
+    // Write packets with distinct PID's and timestamps.
+    ts::TSFile file;
+    ts::TSPacketVector packets(packet_count);
+    ts::TSPacketMetadataVector mdata(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        packets[i] = ts::NullPacket;
+        packets[i].setPID(ts::PID(i % 8000));
+        mdata[i].setInputTimeStamp(i, ts::SYSTEM_CLOCK_FREQ);
+    }
+    TSUNIT_ASSERT(file.open(_tempFileName, ts::TSFile::WRITE, CERR, format));
+    TSUNIT_ASSERT(file.writePackets(packets.data(), mdata.data(), packets.size(), CERR));
+    TSUNIT_ASSERT(file.close(CERR));
+
+    // Read the file twice, starting at packet 3, in odd-sized chunks.
+    const size_t start = 3;
+    const size_t header_size = format == ts::TSFile::FMT_M2TS ? 4 : (format == ts::TSFile::FMT_DUCK ? 14 : 0);
+    file.setReadMode(mode, 2);
+    TSUNIT_EQUAL(mode, file.readMode());
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 2, start * (header_size + ts::PKT_SIZE), CERR, format));
+
+    ts::TSPacketVector inpackets(37);
+    ts::TSPacketMetadataVector inmdata(inpackets.size());
+    size_t index = start;
+    size_t total = 0;
+    size_t count = 0;
+    while ((count = file.readPackets(inpackets.data(), inmdata.data(), inpackets.size(), CERR)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            if (index >= packet_count) {
+                index = start;
+            }
+            TSUNIT_EQUAL(index % 8000, inpackets[i].getPID());
+            if (format != ts::TSFile::FMT_TS) {
+                TSUNIT_EQUAL(index, inmdata[i].getInputTimeStamp());
+            }
+            index++;
+        }
+        total += count;
+    }
+    TSUNIT_EQUAL(2 * (packet_count - start), total);
+    TSUNIT_ASSERT(file.close(CERR));
+
+    // Seek in a rewindable file.
+    TSUNIT_ASSERT(file.openRead(_tempFileName, start * (header_size + ts::PKT_SIZE), CERR, format));
+    TSUNIT_EQUAL(1, file.readPackets(inpackets.data(), inmdata.data(), 1, CERR));
+    TSUNIT_EQUAL(start, inpackets[0].getPID());
+    TSUNIT_ASSERT(file.seek(packet_count - start - 10, CERR));
+    TSUNIT_EQUAL(10, file.readPackets(inpackets.data(), inmdata.data(), inpackets.size(), CERR));
+    TSUNIT_EQUAL((packet_count - 10) % 8000, inpackets[0].getPID());
+    TSUNIT_ASSERT(file.rewind(CERR));
+    TSUNIT_EQUAL(1, file.readPackets(inpackets.data(), inmdata.data(), 1, CERR));
+    TSUNIT_EQUAL(start, inpackets[0].getPID());
+    TSUNIT_ASSERT(file.close(CERR));
+}
+
+void TSFileTest::testResync()
+{
+    checkResync(ts::TSFile::READ_STANDARD);
+    checkResync(ts::TSFile::READ_MMAP);
+    checkResync(ts::TSFile::READ_DIRECT);
+}
+
+void TSFileTest::checkResync(ts::TSFile::ReadMode mode)
+{
+    debug() << "TSFileTest::checkResync: mode " << ts::TSFile::ReadModeEnum.name(mode) << std::endl;
+
+    // Leading garbage and a few packets, less than required to lock in the middle of a stream.
+    const size_t garbage = 7;
+    const size_t packet_count = 10;
+    ts::ByteBlock data(garbage, 0x01);
+    for (size_t i = 0; i < packet_count; ++i) {
+        ts::TSPacket pkt(ts::NullPacket);
+        pkt.setPID(ts::PID(100 + i));
+        data.append(pkt.b, ts::PKT_SIZE);
+    }
+    TSUNIT_ASSERT(data.saveToFile(_tempFileName, &CERR));
+
+    // Read the file three times in small chunks. The end of each pass is still buffered
+    // when the end of file is reached and it must not be prepended to the next pass.
+    ts::TSFile file;
+    file.setReadMode(mode);
+    file.setResync(true);
+    TSUNIT_ASSERT(file.openRead(_tempFileName, 3, 0, CERR));
+
+    ts::TSPacketVector inpackets(3);
+    size_t total = 0;
+    size_t count = 0;
+    while ((count = file.readPackets(inpackets.data(), nullptr, inpackets.size(), CERR)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_EQUAL(100 + (total + i) % packet_count, inpackets[i].getPID());
+        }
+        total += count;
+    }
+    TSUNIT_EQUAL(3 * packet_count, total);
+    TSUNIT_EQUAL(3 * garbage, file.resyncSkippedBytes());
+    TSUNIT_ASSERT(file.close(CERR));
+}
@@ -0,0 +1,310 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSPacketSharedRing
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSPacketSharedRing.h"
+#include "tsNullReport.h"
+#include "tsCerrReport.h"
+#include "utestTSUnitThread.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSPacketSharedRingTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testReadWrite();
+    void testTermination();
+    void testThreads();
+
+    TSUNIT_TEST_BEGIN(TSPacketSharedRingTest);
+    TSUNIT_TEST(testReadWrite);
+    TSUNIT_TEST(testTermination);
+    TSUNIT_TEST(testThreads);
+    TSUNIT_TEST_END();
+
+public:
+    // Build a packet with a recognizable content.
+    static void MakePacket(ts::TSPacket& pkt, uint32_t index);
+};
+
+TSUNIT_REGISTER(TSPacketSharedRingTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TSPacketSharedRingTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void TSPacketSharedRingTest::afterTest()
+{
+}
+
+void TSPacketSharedRingTest::MakePacket(ts::TSPacket& pkt, uint32_t index)
+{
+    pkt = ts::NullPacket;
+    pkt.setPID(ts::PID(index % ts::PID_NULL));
+    pkt.setCC(uint8_t(index % 16));
+    ts::PutUInt32(pkt.getPayload(), index);
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+// The shared memory rings are not supported on Windows.
+#if defined(TS_WINDOWS)
+
+void TSPacketSharedRingTest::testReadWrite()
+{
+    ts::TSPacketSharedRing ring;
+    TSUNIT_ASSERT(!ring.create(ts::TSPacketSharedRing::PRODUCER, 10, NULLREP));
+}
+
+void TSPacketSharedRingTest::testTermination()
+{
+}
+
+void TSPacketSharedRingTest::testThreads()
+{
+}
+
+#else
+
+void TSPacketSharedRingTest::testReadWrite()
+{
+    ts::TSPacketSharedRing producer;
+    ts::TSPacketSharedRing consumer;
+
+    TSUNIT_ASSERT(!producer.isOpen());
+    TSUNIT_ASSERT(producer.create(ts::TSPacketSharedRing::PRODUCER, 10, CERR));
+    TSUNIT_ASSERT(producer.isOpen());
+    TSUNIT_EQUAL(10, producer.bufferSize());
+    TSUNIT_ASSERT(!producer.name().empty());
+    debug() << "TSPacketSharedRingTest: ring name: " << producer.name() << std::endl;
+
+    // Same role as creator, must fail.
+    TSUNIT_ASSERT(!consumer.attach(producer.name(), ts::TSPacketSharedRing::PRODUCER, NULLREP));
+    TSUNIT_ASSERT(!consumer.isOpen());
+
+    TSUNIT_ASSERT(consumer.attach(producer.name(), ts::TSPacketSharedRing::CONSUMER, CERR));
+    TSUNIT_ASSERT(consumer.isOpen());
+    TSUNIT_EQUAL(10, consumer.bufferSize());
+
+    // Only one process can attach.
+    ts::TSPacketSharedRing other;
+    TSUNIT_ASSERT(!other.attach(producer.name(), ts::TSPacketSharedRing::CONSUMER, NULLREP));
+
+    ts::TSPacket pkt[8];
+    ts::TSPacketMetadata mdata[8];
+    ts::TSPacket in[8];
+    ts::TSPacketMetadata in_mdata[8];
+
+    // Empty ring.
+    TSUNIT_ASSERT(!consumer.getPacket(in[0], in_mdata[0]));
+    TSUNIT_ASSERT(!consumer.eof());
+
+    // Write 6 packets, read 6 packets, several times to wrap around the end of the ring.
+    uint32_t wr_index = 0;
+    uint32_t rd_index = 0;
+    for (int loop = 0; loop < 5; ++loop) {
+        for (size_t i = 0; i < 6; ++i) {
+            MakePacket(pkt[i], wr_index);
+            mdata[i].reset();
+            mdata[i].setLabel(wr_index % ts::TSPacketMetadata::LABEL_COUNT);
+            wr_index++;
+        }
+        TSUNIT_ASSERT(producer.write(pkt, mdata, 6));
+
+        // The first packet is read alone.
+        TSUNIT_ASSERT(consumer.getPacket(in[0], in_mdata[0]));
+        TSUNIT_EQUAL(rd_index, ts::GetUInt32(in[0].getPayload()));
+        TSUNIT_ASSERT(in_mdata[0].hasLabel(rd_index % ts::TSPacketMetadata::LABEL_COUNT));
+        rd_index++;
+
+        // The other packets may be read in two chunks at the end of the ring.
+        size_t remain = 5;
+        while (remain > 0) {
+            const size_t count = consumer.read(in, in_mdata, 8);
+            TSUNIT_ASSERT(count > 0);
+            TSUNIT_ASSERT(count <= remain);
+            for (size_t i = 0; i < count; ++i) {
+                TSUNIT_EQUAL(rd_index, ts::GetUInt32(in[i].getPayload()));
+                TSUNIT_EQUAL(rd_index % 16, in[i].getCC());
+                TSUNIT_ASSERT(in_mdata[i].hasLabel(rd_index % ts::TSPacketMetadata::LABEL_COUNT));
+                rd_index++;
+            }
+            remain -= count;
+        }
+        TSUNIT_ASSERT(!consumer.getPacket(in[0], in_mdata[0]));
+    }
+    TSUNIT_EQUAL(wr_index, rd_index);
+
+    // Packets without metadata.
+    MakePacket(pkt[0], 1234);
+    TSUNIT_ASSERT(producer.write(pkt, nullptr, 1));
+    in_mdata[0].setLabel(3);
+    TSUNIT_EQUAL(1, consumer.read(in, in_mdata, 8));
+    TSUNIT_EQUAL(1234, ts::GetUInt32(in[0].getPayload()));
+    TSUNIT_ASSERT(!in_mdata[0].hasAnyLabel());
+
+    TSUNIT_ASSERT(consumer.close(CERR));
+    TSUNIT_ASSERT(producer.close(CERR));
+    TSUNIT_ASSERT(!producer.isOpen());
+    TSUNIT_ASSERT(!consumer.isOpen());
+}
+
+void TSPacketSharedRingTest::testTermination()
+{
+    ts::TSPacket pkt[4];
+    ts::TSPacketMetadata mdata[4];
+    for (uint32_t i = 0; i < 4; ++i) {
+        MakePacket(pkt[i], i);
+    }
+
+    // End of file: the consumer gets the last packets first.
+    {
+        ts::TSPacketSharedRing producer;
+        ts::TSPacketSharedRing consumer;
+        TSUNIT_ASSERT(consumer.create(ts::TSPacketSharedRing::CONSUMER, 10, CERR));
+        TSUNIT_ASSERT(producer.attach(consumer.name(), ts::TSPacketSharedRing::PRODUCER, CERR));
+        TSUNIT_ASSERT(producer.write(pkt, mdata, 3));
+        TSUNIT_ASSERT(producer.close(CERR));
+        TSUNIT_ASSERT(!consumer.eof());
+        TSUNIT_EQUAL(3, consumer.read(pkt, mdata, 4));
+        TSUNIT_ASSERT(consumer.eof());
+        TSUNIT_EQUAL(0, consumer.read(pkt, mdata, 4));
+    }
+
+    // Stop: the producer can no longer write.
+    {
+        ts::TSPacketSharedRing producer;
+        ts::TSPacketSharedRing consumer;
+        TSUNIT_ASSERT(producer.create(ts::TSPacketSharedRing::PRODUCER, 2, CERR));
+        TSUNIT_ASSERT(consumer.attach(producer.name(), ts::TSPacketSharedRing::CONSUMER, CERR));
+        TSUNIT_ASSERT(!producer.stopped());
+        TSUNIT_ASSERT(producer.write(pkt, mdata, 2));
+        TSUNIT_ASSERT(consumer.close(CERR));
+        TSUNIT_ASSERT(producer.stopped());
+        TSUNIT_ASSERT(!producer.write(pkt, mdata, 1));
+    }
+
+    // Abort: a blocked producer is released.
+    {
+        ts::TSPacketSharedRing producer;
+        ts::TSPacketSharedRing consumer;
+        TSUNIT_ASSERT(producer.create(ts::TSPacketSharedRing::PRODUCER, 2, CERR));
+        TSUNIT_ASSERT(consumer.attach(producer.name(), ts::TSPacketSharedRing::CONSUMER, CERR));
+        producer.abort();
+        TSUNIT_ASSERT(!producer.write(pkt, mdata, 4));
+    }
+}
+
+// Thread for testThreads()
+namespace {
+    class SharedRingTestThread: public utest::TSUnitThread
+    {
+        TS_NOBUILD_NOCOPY(SharedRingTestThread);
+    private:
+        ts::UString _name;
+        uint32_t    _count;
+    public:
+        SharedRingTestThread(const ts::UString& name, uint32_t count) :
+            utest::TSUnitThread(),
+            _name(name),
+            _count(count)
+        {
+        }
+
+        virtual ~SharedRingTestThread() override
+        {
+            waitForTermination();
+        }
+
+        // Producer thread, write packets in chunks of various sizes.
+        virtual void test() override
+        {
+            ts::TSPacketSharedRing ring;
+            TSUNIT_ASSERT(ring.attach(_name, ts::TSPacketSharedRing::PRODUCER, CERR));
+            ts::TSPacket pkt[7];
+            uint32_t index = 0;
+            while (index < _count) {
+                const size_t count = std::min<size_t>(1 + index % 7, _count - index);
+                for (size_t i = 0; i < count; ++i) {
+                    TSPacketSharedRingTest::MakePacket(pkt[i], index++);
+                }
+                TSUNIT_ASSERT(ring.write(pkt, nullptr, count));
+            }
+            TSUNIT_ASSERT(ring.close(CERR));
+        }
+    };
+}
+
+void TSPacketSharedRingTest::testThreads()
+{
+    const uint32_t total = 100000;
+
+    // A small ring, the producer and the consumer must wait for each other.
+    ts::TSPacketSharedRing ring;
+    TSUNIT_ASSERT(ring.create(ts::TSPacketSharedRing::CONSUMER, 16, CERR));
+
+    SharedRingTestThread thread(ring.name(), total);
+    TSUNIT_ASSERT(thread.start());
+
+    ts::TSPacket pkt[10];
+    uint32_t index = 0;
+    size_t count = 0;
+    while ((count = ring.read(pkt, nullptr, 10)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            TSUNIT_EQUAL(index, ts::GetUInt32(pkt[i].getPayload()));
+            index++;
+        }
+    }
+    TSUNIT_EQUAL(total, index);
+    TSUNIT_ASSERT(ring.eof());
+    TSUNIT_ASSERT(ring.close(CERR));
+}
+
+#endif
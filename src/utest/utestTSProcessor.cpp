@@ -33,7 +33,10 @@
 
 #include "tsTSProcessor.h"
 #include "tsPluginRepository.h"
+#include "tsOutputPlugin.h"
 #include "tsCerrReport.h"
+#include "tsTime.h"
+#include "tsMemory.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
 
@@ -49,10 +52,34 @@ public:
     virtual void afterTest() override;
 
     void testProcessing();
+    void testLockFreeRing();
+    void testBatch();
+    void testBatchEnd();
+    void testBatchJointTermination();
+    void testObservers();
+    void testObserverEnd();
+    void testObserverFlush();
 
     TSUNIT_TEST_BEGIN(TSProcessorTest);
     TSUNIT_TEST(testProcessing);
+    TSUNIT_TEST(testLockFreeRing);
+    TSUNIT_TEST(testBatch);
+    TSUNIT_TEST(testBatchEnd);
+    TSUNIT_TEST(testBatchJointTermination);
+    TSUNIT_TEST(testObservers);
+    TSUNIT_TEST(testObserverEnd);
+    TSUNIT_TEST(testObserverFlush);
     TSUNIT_TEST_END();
+
+private:
+    // Run a chain of pass-through plugins, return the duration in milliseconds.
+    ts::MilliSecond runChain(size_t plugin_count, size_t packet_count, bool lock_free);
+
+    // Run a chain with a joint termination plugin, return the number of output packets.
+    ts::PacketCounter runJointTermination(bool batch);
+
+    // Run a chain with a group of 3 observers between two sequence checkers.
+    void runObservers(const ts::UString& name, size_t packet_count, size_t max_flush_pkt, const ts::UStringVector& observer1_args);
 };
 
 TSUNIT_REGISTER(TSProcessorTest);
@@ -178,6 +205,316 @@ TestPlugin::Status TestPlugin::processPacket(ts::TSPacket& pkt, ts::TSPacketMeta
 }
 
 
+//----------------------------------------------------------------------------
+// Internal packet processing plugin class using batch processing.
+// Drop one packet out of two.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestBatchPlugin : ts::ProcessorPlugin
+    {
+    public:
+        // Constructor.
+        TestBatchPlugin(ts::TSP* t) : ts::ProcessorPlugin(t, u"Test batch plugin", u"[options]") {}
+
+        // Implementation of plugin API.
+        virtual Status processPacket(ts::TSPacket&, ts::TSPacketMetadata&) override;
+        virtual bool processPacketBatch(ts::TSPacket*, ts::TSPacketMetadata*, size_t, Status*) override;
+
+        // A factory static method which creates an instance of that class.
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new TestBatchPlugin(t); }
+
+        // Number of processed batches (static since there is no access to the plugin instance).
+        static size_t batches;
+    };
+
+    size_t TestBatchPlugin::batches = 0;
+}
+
+TestBatchPlugin::Status TestBatchPlugin::processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata& metadata)
+{
+    return tsp->pluginPackets() % 2 == 0 ? TSP_OK : TSP_DROP;
+}
+
+bool TestBatchPlugin::processPacketBatch(ts::TSPacket* pkt, ts::TSPacketMetadata* metadata, size_t count, Status* status)
+{
+    batches++;
+    for (size_t i = 0; i < count; ++i) {
+        if ((tsp->pluginPackets() + i) % 2 != 0) {
+            status[i] = TSP_DROP;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Internal packet processing plugin class using batch processing.
+// Terminate the processing at a given packet in the middle of a batch.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestBatchEndPlugin : ts::ProcessorPlugin
+    {
+    public:
+        // Constructor.
+        TestBatchEndPlugin(ts::TSP* t) : ts::ProcessorPlugin(t, u"Test batch end plugin", u"[options]") {}
+
+        // Implementation of plugin API.
+        virtual bool stop() override;
+        virtual Status processPacket(ts::TSPacket&, ts::TSPacketMetadata&) override;
+        virtual bool processPacketBatch(ts::TSPacket*, ts::TSPacketMetadata*, size_t, Status*) override;
+
+        // A factory static method which creates an instance of that class.
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new TestBatchEndPlugin(t); }
+
+        // Index of the packet which terminates the processing.
+        static constexpr ts::PacketCounter END_PACKET = 1234;
+
+        // Number of packets which were counted for the plugin when it stopped.
+        static ts::PacketCounter stop_packets;
+    };
+
+    ts::PacketCounter TestBatchEndPlugin::stop_packets = 0;
+}
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::PacketCounter TestBatchEndPlugin::END_PACKET;
+#endif
+
+bool TestBatchEndPlugin::stop()
+{
+    stop_packets = tsp->pluginPackets();
+    return true;
+}
+
+TestBatchEndPlugin::Status TestBatchEndPlugin::processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata& metadata)
+{
+    return tsp->pluginPackets() == END_PACKET ? TSP_END : TSP_OK;
+}
+
+bool TestBatchEndPlugin::processPacketBatch(ts::TSPacket* pkt, ts::TSPacketMetadata* metadata, size_t count, Status* status)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (tsp->pluginPackets() + i == END_PACKET) {
+            status[i] = TSP_END;
+        }
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Internal packet processing plugin class using "joint termination".
+// Declare the termination at a given packet, optionally in the middle of a batch.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestJointPlugin : ts::ProcessorPlugin
+    {
+    public:
+        // Constructor.
+        TestJointPlugin(ts::TSP*);
+
+        // Implementation of plugin API.
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual Status processPacket(ts::TSPacket&, ts::TSPacketMetadata&) override;
+        virtual bool processPacketBatch(ts::TSPacket*, ts::TSPacketMetadata*, size_t, Status*) override;
+
+        // A factory static method which creates an instance of that class.
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new TestJointPlugin(t); }
+
+        // Index of the packet which completes the plugin for joint termination.
+        static constexpr ts::PacketCounter END_PACKET = 1234;
+
+    private:
+        bool _batch;
+        bool _terminated;
+        void checkPacket(ts::PacketCounter index);
+    };
+}
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr ts::PacketCounter TestJointPlugin::END_PACKET;
+#endif
+
+TestJointPlugin::TestJointPlugin(ts::TSP* t) :
+    ts::ProcessorPlugin(t, u"Test joint termination plugin", u"[options]"),
+    _batch(false),
+    _terminated(false)
+{
+    option(u"batch");
+    help(u"batch", u"Accept batch processing.");
+}
+
+bool TestJointPlugin::getOptions()
+{
+    _batch = present(u"batch");
+    return true;
+}
+
+bool TestJointPlugin::start()
+{
+    _terminated = false;
+    tsp->useJointTermination(true);
+    return true;
+}
+
+void TestJointPlugin::checkPacket(ts::PacketCounter index)
+{
+    if (!_terminated && index == END_PACKET) {
+        _terminated = true;
+        tsp->jointTerminate();
+    }
+}
+
+TestJointPlugin::Status TestJointPlugin::processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata& metadata)
+{
+    checkPacket(tsp->pluginPackets());
+    return TSP_OK;
+}
+
+bool TestJointPlugin::processPacketBatch(ts::TSPacket* pkt, ts::TSPacketMetadata* metadata, size_t count, Status* status)
+{
+    if (!_batch) {
+        return false;
+    }
+    const ts::PacketCounter first = tsp->pluginPackets();
+    for (size_t i = 0; i < count; ++i) {
+        checkPacket(first + i);
+    }
+    return true;
+}
+
+
+//----------------------------------------------------------------------------
+// Internal output plugin class counting output packets.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestCountOutputPlugin : ts::OutputPlugin
+    {
+    public:
+        // Constructor.
+        TestCountOutputPlugin(ts::TSP* t) : ts::OutputPlugin(t, u"Test counting output plugin", u"[options]") {}
+
+        // Implementation of plugin API.
+        virtual bool send(const ts::TSPacket*, const ts::TSPacketMetadata*, size_t count) override { packets += count; return true; }
+
+        // A factory static method which creates an instance of that class.
+        static ts::OutputPlugin* CreateInstance(ts::TSP* t) { return new TestCountOutputPlugin(t); }
+
+        // Number of output packets (static since there is no access to the plugin instance).
+        static ts::PacketCounter packets;
+    };
+
+    ts::PacketCounter TestCountOutputPlugin::packets = 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Internal packet processing plugin class checking sequences of packets.
+// With --stamp, write the sequence number of each packet in its payload.
+// Otherwise, check that the packets are received in sequence.
+//----------------------------------------------------------------------------
+
+namespace {
+    class TestSequencePlugin : ts::ProcessorPlugin
+    {
+    public:
+        // Constructor.
+        TestSequencePlugin(ts::TSP*);
+
+        // Implementation of plugin API.
+        virtual bool getOptions() override;
+        virtual bool start() override;
+        virtual bool stop() override;
+        virtual Status processPacket(ts::TSPacket&, ts::TSPacketMetadata&) override;
+
+        // A factory static method which creates an instance of that class.
+        static ts::ProcessorPlugin* CreateInstance(ts::TSP* t) { return new TestSequencePlugin(t); }
+
+        // Results of each plugin instance, indexed by --id (static since there is no access to the plugin instance).
+        // Written by the plugin thread in stop(), read after the termination of the processing.
+        static constexpr size_t MAX_ID = 4;
+        struct Result
+        {
+            ts::PacketCounter packets;   // Number of processed packets.
+            ts::PacketCounter errors;    // Number of packets out of sequence.
+        };
+        static Result results[MAX_ID];
+
+    private:
+        // Command line options:
+        bool              _stamp;
+        size_t            _id;
+        ts::PacketCounter _end;
+        // Working data:
+        ts::PacketCounter _packets;
+        ts::PacketCounter _errors;
+    };
+
+    TestSequencePlugin::Result TestSequencePlugin::results[TestSequencePlugin::MAX_ID];
+}
+
+#if defined(TS_NEED_STATIC_CONST_DEFINITIONS)
+constexpr size_t TestSequencePlugin::MAX_ID;
+#endif
+
+TestSequencePlugin::TestSequencePlugin(ts::TSP* t) :
+    ts::ProcessorPlugin(t, u"Test sequence plugin", u"[options]"),
+    _stamp(false),
+    _id(0),
+    _end(0),
+    _packets(0),
+    _errors(0)
+{
+    option(u"stamp");
+    help(u"stamp", u"Write the sequence number of each packet in its payload.");
+
+    option(u"id", 0, INTEGER, 0, 1, 0, MAX_ID - 1);
+    help(u"id", u"Index of the results of this plugin.");
+
+    option(u"end", 0, UNSIGNED);
+    help(u"end", u"Terminate the processing at the packet with that sequence number.");
+}
+
+bool TestSequencePlugin::getOptions()
+{
+    _stamp = present(u"stamp");
+    _id = intValue<size_t>(u"id", 0);
+    _end = intValue<ts::PacketCounter>(u"end", std::numeric_limits<ts::PacketCounter>::max());
+    return true;
+}
+
+bool TestSequencePlugin::start()
+{
+    _packets = _errors = 0;
+    return true;
+}
+
+bool TestSequencePlugin::stop()
+{
+    if (!_stamp) {
+        results[_id].packets = _packets;
+        results[_id].errors = _errors;
+    }
+    return true;
+}
+
+TestSequencePlugin::Status TestSequencePlugin::processPacket(ts::TSPacket& pkt, ts::TSPacketMetadata& metadata)
+{
+    if (_stamp) {
+        ts::PutUInt64(pkt.b + 4, _packets);
+    }
+    else if (ts::GetUInt64(pkt.b + 4) != _packets) {
+        _errors++;
+    }
+    return _packets++ == _end ? TSP_END : TSP_OK;
+}
+
+
 //----------------------------------------------------------------------------
 // A test plugin event handler.
 // We don't do the TSUNIT assertions in the event handler (called in plugin
@@ -325,3 +662,234 @@ void TSProcessorTest::testProcessing()
     TSUNIT_EQUAL(3,          handler2.logs[0].count);
     TSUNIT_EQUAL(26,         handler2.logs[0].packets);
 }
+
+
+//----------------------------------------------------------------------------
+// Compare the throughput of the mutex-based and lock-free packet rings.
+//----------------------------------------------------------------------------
+
+ts::MilliSecond TSProcessorTest::runChain(size_t plugin_count, size_t packet_count, bool lock_free)
+{
+    // Register our custom plugin with the name "test1".
+    ts::PluginRepository::Instance()->registerProcessor(u"test1", TestPlugin::CreateInstance);
+
+    // Chain of plugins which never signal packet events.
+    ts::TSProcessorArgs opt;
+    opt.app_name = u"TSProcessorTest::testLockFreeRing";
+    opt.lock_free = lock_free;
+    opt.ts_buffer_size = 1000 * ts::PKT_SIZE;
+    opt.input = {u"null", {ts::UString::Decimal(packet_count, 0, true, u"")}};
+    for (size_t i = 0; i < plugin_count; ++i) {
+        opt.plugins.push_back({u"test1", {u"--count", ts::UString::Decimal(2 * packet_count, 0, true, u"")}});
+    }
+    opt.output = {u"drop"};
+
+    ts::TSProcessor tsproc(CERR);
+    TestEventHandler handler;
+    ts::TSProcessor::Criteria crit;
+    crit.event_code = TestPlugin::EVENT_STOP;
+    tsproc.registerEventHandler(&handler, crit);
+
+    const ts::Time start(ts::Time::CurrentUTC());
+    TSUNIT_ASSERT(tsproc.start(opt));
+    tsproc.waitForTermination();
+    const ts::MilliSecond duration = ts::Time::CurrentUTC() - start;
+
+    // All plugins must have seen all packets.
+    TSUNIT_EQUAL(plugin_count, handler.logs.size());
+    for (size_t i = 0; i < handler.logs.size(); ++i) {
+        TSUNIT_EQUAL(packet_count, handler.logs[i].packets);
+    }
+    return duration;
+}
+
+void TSProcessorTest::testLockFreeRing()
+{
+    const size_t packet_count = 100000;
+    const size_t plugin_counts[] = {2, 8, 32};
+
+    for (size_t i = 0; i < sizeof(plugin_counts) / sizeof(plugin_counts[0]); ++i) {
+        const ts::MilliSecond mutex_ms = runChain(plugin_counts[i], packet_count, false);
+        const ts::MilliSecond lockfree_ms = runChain(plugin_counts[i], packet_count, true);
+        debug() << "TSProcessorTest: " << plugin_counts[i] << " plugins, " << packet_count << " packets, "
+                << "mutex ring: " << mutex_ms << " ms (" << (packet_count * 1000) / std::max<ts::MilliSecond>(1, mutex_ms) << " pkt/s), "
+                << "lock-free ring: " << lockfree_ms << " ms (" << (packet_count * 1000) / std::max<ts::MilliSecond>(1, lockfree_ms) << " pkt/s)"
+                << std::endl;
+    }
+}
+
+
+//----------------------------------------------------------------------------
+// Test batch processing of packets.
+//----------------------------------------------------------------------------
+
+void TSProcessorTest::testBatch()
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"test1", TestPlugin::CreateInstance);
+    ts::PluginRepository::Instance()->registerProcessor(u"testbatch", TestBatchPlugin::CreateInstance);
+
+    ts::TSProcessorArgs opt;
+    opt.app_name = u"TSProcessorTest::testBatch";
+    opt.input = {u"null", {u"10000"}};
+    opt.plugins = {
+        {u"testbatch", {}},
+        {u"test1", {u"--count", u"100000"}},
+    };
+    opt.output = {u"drop"};
+
+    ts::TSProcessor tsproc(CERR);
+    TestEventHandler handler;
+    ts::TSProcessor::Criteria crit;
+    crit.event_code = TestPlugin::EVENT_STOP;
+    tsproc.registerEventHandler(&handler, crit);
+
+    TestBatchPlugin::batches = 0;
+    TSUNIT_ASSERT(tsproc.start(opt));
+    tsproc.waitForTermination();
+
+    // The batch plugin dropped one packet out of two.
+    TSUNIT_ASSERT(TestBatchPlugin::batches > 0);
+    TSUNIT_EQUAL(1, handler.logs.size());
+    TSUNIT_EQUAL(5000, handler.logs[0].packets);
+}
+
+void TSProcessorTest::testBatchEnd()
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"test1", TestPlugin::CreateInstance);
+    ts::PluginRepository::Instance()->registerProcessor(u"testbatchend", TestBatchEndPlugin::CreateInstance);
+
+    ts::TSProcessorArgs opt;
+    opt.app_name = u"TSProcessorTest::testBatchEnd";
+    opt.input = {u"null", {u"10000"}};
+    opt.plugins = {
+        {u"testbatchend", {}},
+        {u"test1", {u"--count", u"100000"}},
+    };
+    opt.output = {u"drop"};
+
+    ts::TSProcessor tsproc(CERR);
+    TestEventHandler handler;
+    ts::TSProcessor::Criteria crit;
+    crit.event_code = TestPlugin::EVENT_STOP;
+    tsproc.registerEventHandler(&handler, crit);
+
+    TestBatchEndPlugin::stop_packets = 0;
+    TSUNIT_ASSERT(tsproc.start(opt));
+    tsproc.waitForTermination();
+
+    // The plugin counted the packets up to and including the one which returned TSP_END, as in packet mode.
+    TSUNIT_EQUAL(TestBatchEndPlugin::END_PACKET + 1, TestBatchEndPlugin::stop_packets);
+    TSUNIT_EQUAL(1, handler.logs.size());
+    TSUNIT_EQUAL(TestBatchEndPlugin::END_PACKET, handler.logs[0].packets);
+}
+
+
+ts::PacketCounter TSProcessorTest::runJointTermination(bool batch)
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"testjoint", TestJointPlugin::CreateInstance);
+    ts::PluginRepository::Instance()->registerOutput(u"testcount", TestCountOutputPlugin::CreateInstance);
+
+    ts::TSProcessorArgs opt;
+    opt.app_name = u"TSProcessorTest::testBatchJointTermination";
+    opt.input = {u"null", {u"10000"}};
+    opt.plugins = {
+        {u"testjoint", batch ? ts::UStringVector({u"--batch"}) : ts::UStringVector()},
+    };
+    opt.output = {u"testcount"};
+
+    ts::TSProcessor tsproc(CERR);
+    TestCountOutputPlugin::packets = 0;
+    TSUNIT_ASSERT(tsproc.start(opt));
+    tsproc.waitForTermination();
+    return TestCountOutputPlugin::packets;
+}
+
+void TSProcessorTest::testBatchJointTermination()
+{
+    // The termination point does not depend on the batch processing capability of the plugin.
+    const ts::PacketCounter packet_mode = runJointTermination(false);
+    const ts::PacketCounter batch_mode = runJointTermination(true);
+    debug() << "TSProcessorTest::testBatchJointTermination: " << packet_mode << " packets in packet mode, " << batch_mode << " in batch mode" << std::endl;
+    TSUNIT_EQUAL(TestJointPlugin::END_PACKET, packet_mode);
+    TSUNIT_EQUAL(packet_mode, batch_mode);
+}
+
+
+//----------------------------------------------------------------------------
+// Test groups of parallel observers.
+//----------------------------------------------------------------------------
+
+void TSProcessorTest::runObservers(const ts::UString& name, size_t packet_count, size_t max_flush_pkt, const ts::UStringVector& observer1_args)
+{
+    ts::PluginRepository::Instance()->registerProcessor(u"testseq", TestSequencePlugin::CreateInstance);
+
+    // Checker 3 is after the group of observers 0, 1, 2.
+    ts::UStringVector args1({u"--observer", u"--id", u"1"});
+    args1.insert(args1.end(), observer1_args.begin(), observer1_args.end());
+
+    ts::TSProcessorArgs opt;
+    opt.app_name = u"TSProcessorTest::" + name;
+    opt.ts_buffer_size = 1000 * ts::PKT_SIZE;
+    opt.max_flush_pkt = max_flush_pkt;
+    opt.input = {u"null", {ts::UString::Decimal(packet_count, 0, true, u"")}};
+    opt.plugins = {
+        {u"testseq", {u"--stamp"}},
+        {u"testseq", {u"--observer", u"--id", u"0"}},
+        {u"testseq", args1},
+        {u"testseq", {u"--observer", u"--id", u"2"}},
+        {u"testseq", {u"--id", u"3"}},
+    };
+    opt.output = {u"drop"};
+
+    for (size_t i = 0; i < TestSequencePlugin::MAX_ID; ++i) {
+        TestSequencePlugin::results[i].packets = TestSequencePlugin::results[i].errors = 0;
+    }
+
+    ts::TSProcessor tsproc(CERR);
+    TSUNIT_ASSERT(tsproc.start(opt));
+    tsproc.waitForTermination();
+
+    for (size_t i = 0; i < TestSequencePlugin::MAX_ID; ++i) {
+        debug() << "TSProcessorTest::" << name << ": plugin " << i << ": "
+                << TestSequencePlugin::results[i].packets << " packets, "
+                << TestSequencePlugin::results[i].errors << " errors" << std::endl;
+    }
+}
+
+void TSProcessorTest::testObservers()
+{
+    // All observers and the next plugin see all packets, in order.
+    runObservers(u"testObservers", 10000, 0, {});
+    for (size_t i = 0; i < TestSequencePlugin::MAX_ID; ++i) {
+        TSUNIT_EQUAL(10000, TestSequencePlugin::results[i].packets);
+        TSUNIT_EQUAL(0, TestSequencePlugin::results[i].errors);
+    }
+}
+
+void TSProcessorTest::testObserverEnd()
+{
+    // TSP_END from the first observer of the group. The plugin after the group
+    // receives exactly the packets before the one which ended the stream.
+    runObservers(u"testObserverEnd", 10000, 0, {u"--end", u"4321"});
+    TSUNIT_EQUAL(4322, TestSequencePlugin::results[1].packets);
+    TSUNIT_EQUAL(4321, TestSequencePlugin::results[3].packets);
+    for (size_t i = 0; i < TestSequencePlugin::MAX_ID; ++i) {
+        TSUNIT_EQUAL(0, TestSequencePlugin::results[i].errors);
+    }
+}
+
+void TSProcessorTest::testObserverFlush()
+{
+    // Flush after very few packets, much smaller than the windows of packets.
+    // The processing must terminate and all packets must be passed in order.
+    runObservers(u"testObserverFlush", 10000, 7, {});
+    for (size_t i = 0; i < TestSequencePlugin::MAX_ID; ++i) {
+        TSUNIT_EQUAL(10000, TestSequencePlugin::results[i].packets);
+        TSUNIT_EQUAL(0, TestSequencePlugin::results[i].errors);
+    }
+
+    // Same thing when the end of the stream is requested in the middle of a flushed chunk.
+    runObservers(u"testObserverFlush", 10000, 7, {u"--end", u"1003"});
+    TSUNIT_EQUAL(1003, TestSequencePlugin::results[3].packets);
+    TSUNIT_EQUAL(0, TestSequencePlugin::results[3].errors);
+}
@@ -0,0 +1,341 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for class ts::TSSyncScanner
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSSyncScanner.h"
+#include "tsTSPacketStream.h"
+#include "tsTSPacketMetadata.h"
+#include "tsByteBlock.h"
+#include "tsMPEG.h"
+#include "tsNullReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TSSyncScannerTest: public tsunit::Test
+{
+public:
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testFindSyncByte();
+    void testCountPackets();
+    void testLock();
+    void testResyncStream();
+    void testResyncShortStream();
+
+    TSUNIT_TEST_BEGIN(TSSyncScannerTest);
+    TSUNIT_TEST(testFindSyncByte);
+    TSUNIT_TEST(testCountPackets);
+    TSUNIT_TEST(testLock);
+    TSUNIT_TEST(testResyncStream);
+    TSUNIT_TEST(testResyncShortStream);
+    TSUNIT_TEST_END();
+
+public:
+    // Build a sequence of packets with a given encapsulation.
+    // The sync byte of packet number 'bad' (if any) is corrupted.
+    static void MakePackets(ts::ByteBlock& data, size_t count, size_t packet_size, size_t header_size, uint8_t first_value, size_t bad = ts::NPOS);
+
+    // Memory input stream, returning data in small chunks.
+    class MemoryReader: public ts::AbstractReadStreamInterface
+    {
+    public:
+        MemoryReader(const ts::ByteBlock& data, size_t chunk) : _data(data), _chunk(chunk), _next(0) {}
+        virtual bool readStreamPartial(void* addr, size_t max_size, size_t& ret_size, ts::Report& report) override;
+        virtual bool endOfStream() override { return _next >= _data.size(); }
+    private:
+        const ts::ByteBlock& _data;
+        size_t _chunk;
+        size_t _next;
+    };
+};
+
+TSUNIT_REGISTER(TSSyncScannerTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Test suite initialization method.
+void TSSyncScannerTest::beforeTest()
+{
+}
+
+// Test suite cleanup method.
+void TSSyncScannerTest::afterTest()
+{
+    ts::TSSyncScanner::SetScanMode(ts::TSSyncScanner::SCAN_AUTO);
+}
+
+
+//----------------------------------------------------------------------------
+// Test helpers.
+//----------------------------------------------------------------------------
+
+namespace {
+    const ts::TSSyncScanner::ScanMode all_modes[] = {
+        ts::TSSyncScanner::SCAN_SCALAR,
+        ts::TSSyncScanner::SCAN_SSE2,
+        ts::TSSyncScanner::SCAN_AVX2,
+    };
+}
+
+void TSSyncScannerTest::MakePackets(ts::ByteBlock& data, size_t count, size_t packet_size, size_t header_size, uint8_t first_value, size_t bad)
+{
+    for (size_t i = 0; i < count; ++i) {
+        const size_t start = data.size();
+        data.resize(start + packet_size);
+        uint8_t* pkt = &data[start];
+        // Fill the packet with values which never contain a sync byte.
+        for (size_t j = 0; j < packet_size; ++j) {
+            pkt[j] = uint8_t((first_value + i + j) % 0x40);
+        }
+        pkt[header_size] = i == bad ? 0x00 : ts::SYNC_BYTE;
+    }
+}
+
+bool TSSyncScannerTest::MemoryReader::readStreamPartial(void* addr, size_t max_size, size_t& ret_size, ts::Report& report)
+{
+    ret_size = std::min(std::min(max_size, _chunk), _data.size() - _next);
+    ::memcpy(addr, _data.data() + _next, ret_size);
+    _next += ret_size;
+    return ret_size > 0;
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+void TSSyncScannerTest::testFindSyncByte()
+{
+    ts::ByteBlock data(1000, 0x00);
+
+    for (size_t mi = 0; mi < sizeof(all_modes) / sizeof(all_modes[0]); ++mi) {
+        if (!ts::TSSyncScanner::SetScanMode(all_modes[mi])) {
+            debug() << "TSSyncScannerTest: scan mode " << int(all_modes[mi]) << " not supported" << std::endl;
+            continue;
+        }
+        TSUNIT_EQUAL(all_modes[mi], ts::TSSyncScanner::GetScanMode());
+
+        TSUNIT_EQUAL(0, ts::TSSyncScanner::FindSyncByte(data.data(), 0));
+        TSUNIT_EQUAL(1000, ts::TSSyncScanner::FindSyncByte(data.data(), data.size()));
+
+        // Try all positions, including unaligned ones and in the scalar tail.
+        for (size_t pos = 0; pos < 100; ++pos) {
+            data[pos] = ts::SYNC_BYTE;
+            TSUNIT_EQUAL(pos, ts::TSSyncScanner::FindSyncByte(data.data(), data.size()));
+            TSUNIT_EQUAL(pos, ts::TSSyncScanner::FindSyncByte(data.data(), pos + 1));
+            TSUNIT_EQUAL(pos, ts::TSSyncScanner::FindSyncByte(data.data(), pos));
+            if (pos >= 7) {
+                TSUNIT_EQUAL(pos - 7, ts::TSSyncScanner::FindSyncByte(data.data() + 7, pos - 7 + 1));
+            }
+            data[pos] = 0x00;
+        }
+
+        // Two sync bytes in the same vector.
+        data[40] = data[45] = ts::SYNC_BYTE;
+        TSUNIT_EQUAL(40, ts::TSSyncScanner::FindSyncByte(data.data(), data.size()));
+        TSUNIT_EQUAL(4, ts::TSSyncScanner::FindSyncByte(data.data() + 41, data.size() - 41));
+        data[40] = data[45] = 0x00;
+    }
+}
+
+void TSSyncScannerTest::testCountPackets()
+{
+    for (size_t mi = 0; mi < sizeof(all_modes) / sizeof(all_modes[0]); ++mi) {
+        if (!ts::TSSyncScanner::SetScanMode(all_modes[mi])) {
+            continue;
+        }
+        for (size_t bad = 0; bad < 30; ++bad) {
+            ts::ByteBlock data;
+            MakePackets(data, 25, ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE, 0, bad);
+            const size_t expected = std::min<size_t>(bad, 25);
+            TSUNIT_EQUAL(expected, ts::TSSyncScanner::CountPackets(data.data(), data.size(), ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE));
+            // Truncated last packet.
+            TSUNIT_EQUAL(std::min<size_t>(expected, 24), ts::TSSyncScanner::CountPackets(data.data(), data.size() - 1, ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE));
+        }
+        ts::ByteBlock data;
+        MakePackets(data, 20, ts::PKT_SIZE, 0, 3);
+        TSUNIT_EQUAL(20, ts::TSSyncScanner::CountPackets(data.data(), data.size(), ts::PKT_SIZE, 0));
+        TSUNIT_EQUAL(0, ts::TSSyncScanner::CountPackets(data.data() + 1, data.size() - 1, ts::PKT_SIZE, 0));
+        TSUNIT_EQUAL(1, ts::TSSyncScanner::CountPackets(data.data(), data.size(), ts::PKT_RS_SIZE, 0));
+        TSUNIT_EQUAL(0, ts::TSSyncScanner::CountPackets(data.data(), ts::PKT_SIZE - 1, ts::PKT_SIZE, 0));
+    }
+}
+
+void TSSyncScannerTest::testLock()
+{
+    for (size_t mi = 0; mi < sizeof(all_modes) / sizeof(all_modes[0]); ++mi) {
+        if (!ts::TSSyncScanner::SetScanMode(all_modes[mi])) {
+            continue;
+        }
+
+        // Garbage with isolated sync bytes, then 204-byte packets.
+        ts::ByteBlock data(1000, 0x01);
+        data[10] = data[10 + ts::PKT_SIZE] = ts::SYNC_BYTE;
+        MakePackets(data, 30, ts::PKT_RS_SIZE, 0, 5);
+
+        ts::TSSyncScanner scanner;
+        size_t offset = 0;
+        TSUNIT_ASSERT(!scanner.isLocked());
+        TSUNIT_EQUAL(0, scanner.packetSize());
+        TSUNIT_ASSERT(scanner.lock(data.data(), data.size(), 10 * ts::PKT_RS_SIZE, offset));
+        TSUNIT_ASSERT(scanner.isLocked());
+        TSUNIT_EQUAL(1000, offset);
+        TSUNIT_EQUAL(ts::PKT_RS_SIZE, scanner.packetSize());
+        TSUNIT_EQUAL(0, scanner.headerSize());
+        TSUNIT_EQUAL(30, scanner.countPackets(data.data() + offset, data.size() - offset));
+
+        // Not enough packets.
+        TSUNIT_ASSERT(!scanner.lock(data.data(), data.size(), 31 * ts::PKT_RS_SIZE, offset));
+        TSUNIT_ASSERT(!scanner.isLocked());
+        TSUNIT_EQUAL(0, scanner.countPackets(data.data() + 1000, data.size() - 1000));
+
+        // The minimum size is larger than the buffer, all complete packets must be valid.
+        TSUNIT_ASSERT(scanner.lock(data.data() + 1000, data.size() - 1000, data.size(), offset));
+        TSUNIT_EQUAL(0, offset);
+
+        // Same thing after leading garbage, all offsets are tried.
+        TSUNIT_ASSERT(scanner.lock(data.data() + 995, data.size() - 995, data.size(), offset));
+        TSUNIT_EQUAL(5, offset);
+        TSUNIT_EQUAL(ts::PKT_RS_SIZE, scanner.packetSize());
+
+        // Short buffer after leading garbage.
+        data.clear();
+        data.resize(5, 0x01);
+        MakePackets(data, 10, ts::PKT_SIZE, 0, 3);
+        TSUNIT_ASSERT(scanner.lock(data.data(), data.size(), 16 * ts::PKT_SIZE, offset));
+        TSUNIT_EQUAL(5, offset);
+        TSUNIT_EQUAL(ts::PKT_SIZE, scanner.packetSize());
+
+        // Same thing with an invalid packet, lock on the valid packets after it.
+        data.clear();
+        data.resize(5, 0x01);
+        MakePackets(data, 10, ts::PKT_SIZE, 0, 3, 3);
+        TSUNIT_ASSERT(scanner.lock(data.data(), data.size(), 16 * ts::PKT_SIZE, offset));
+        TSUNIT_EQUAL(5 + 4 * ts::PKT_SIZE, offset);
+        TSUNIT_EQUAL(ts::PKT_SIZE, scanner.packetSize());
+
+        // No complete packet.
+        TSUNIT_ASSERT(!scanner.lock(data.data(), ts::PKT_SIZE + 4, 16 * ts::PKT_SIZE, offset));
+
+        // M2TS packets, the timestamps are not sync bytes.
+        data.clear();
+        data.resize(77, 0x02);
+        MakePackets(data, 20, ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE, 7);
+        TSUNIT_ASSERT(scanner.lock(data.data(), data.size(), 2048, offset));
+        TSUNIT_EQUAL(77, offset);
+        TSUNIT_EQUAL(ts::PKT_M2TS_SIZE, scanner.packetSize());
+        TSUNIT_EQUAL(ts::M2TS_HEADER_SIZE, scanner.headerSize());
+
+        // User-specified encapsulation.
+        data.clear();
+        data.resize(3, 0x02);
+        MakePackets(data, 20, 200, 8, 9);
+        TSUNIT_ASSERT(!scanner.lock(data.data(), data.size(), 2048, offset));
+        scanner.setFormat(200, 8);
+        TSUNIT_ASSERT(scanner.lock(data.data(), data.size(), 2048, offset));
+        TSUNIT_EQUAL(3, offset);
+        TSUNIT_EQUAL(200, scanner.packetSize());
+        TSUNIT_EQUAL(8, scanner.headerSize());
+    }
+}
+
+void TSSyncScannerTest::testResyncStream()
+{
+    // Garbage, 100 TS packets, truncated packet, garbage, 50 M2TS packets, truncated packet.
+    ts::ByteBlock data(500, 0x01);
+    MakePackets(data, 100, ts::PKT_SIZE, 0, 1);
+    data.resize(data.size() - 50);
+    data.resize(data.size() + 1000, 0x03);
+    MakePackets(data, 50, ts::PKT_M2TS_SIZE, ts::M2TS_HEADER_SIZE, 2);
+    data.resize(data.size() - 10);
+
+    MemoryReader reader(data, 1000);
+    ts::TSPacketStream stream(ts::TSPacketStream::FMT_AUTODETECT, &reader, nullptr);
+    stream.setResync(true);
+    TSUNIT_ASSERT(stream.resync());
+
+    ts::TSPacketVector packets(200);
+    ts::TSPacketMetadataVector mdata(200);
+    size_t count = 0;
+    size_t got = 0;
+    while ((got = stream.readPackets(&packets[count], &mdata[count], packets.size() - count, NULLREP)) > 0) {
+        count += got;
+    }
+
+    // The truncated TS packet is completed with garbage, the truncated M2TS packet is lost.
+    TSUNIT_EQUAL(100 + 49, count);
+    TSUNIT_EQUAL(100 + 49, stream.readPacketsCount());
+    TSUNIT_EQUAL(ts::TSPacketStream::FMT_M2TS, stream.packetFormat());
+    TSUNIT_EQUAL(500 + 1000 - 50 + ts::PKT_M2TS_SIZE - 10, stream.resyncSkippedBytes());
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_EQUAL(ts::SYNC_BYTE, packets[i].b[0]);
+        TSUNIT_EQUAL(i >= 100, mdata[i].hasInputTimeStamp());
+    }
+    TSUNIT_EQUAL(uint8_t((1 + 0 + 1) % 0x40), packets[0].b[1]);
+    TSUNIT_EQUAL(uint8_t(0x03), packets[99].b[ts::PKT_SIZE - 1]);
+    TSUNIT_EQUAL(uint8_t((2 + 0 + ts::M2TS_HEADER_SIZE + 1) % 0x40), packets[100].b[1]);
+}
+
+void TSSyncScannerTest::testResyncShortStream()
+{
+    // Garbage and less packets than required to lock in the middle of a stream.
+    ts::ByteBlock data(5, 0x01);
+    MakePackets(data, 10, ts::PKT_SIZE, 0, 1);
+
+    MemoryReader reader(data, 1000);
+    ts::TSPacketStream stream(ts::TSPacketStream::FMT_AUTODETECT, &reader, nullptr);
+    stream.setResync(true);
+
+    ts::TSPacketVector packets(20);
+    size_t count = 0;
+    size_t got = 0;
+    while ((got = stream.readPackets(&packets[count], nullptr, packets.size() - count, NULLREP)) > 0) {
+        count += got;
+    }
+
+    TSUNIT_EQUAL(10, count);
+    TSUNIT_EQUAL(5, stream.resyncSkippedBytes());
+    TSUNIT_EQUAL(ts::TSPacketStream::FMT_TS, stream.packetFormat());
+    for (size_t i = 0; i < count; ++i) {
+        TSUNIT_EQUAL(ts::SYNC_BYTE, packets[i].b[0]);
+        TSUNIT_EQUAL(uint8_t((1 + i + 1) % 0x40), packets[i].b[1]);
+    }
+}
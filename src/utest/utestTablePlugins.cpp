@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------
+//
+// TSDuck - The MPEG Transport Stream Toolkit
+// Copyright (c) 2005-2020, Thierry Lelegard
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+// THE POSSIBILITY OF SUCH DAMAGE.
+//
+//----------------------------------------------------------------------------
+//
+//  TSUnit test suite for the table plugins (AbstractTablePlugin subclasses).
+//
+//----------------------------------------------------------------------------
+
+#include "tsTSProcessor.h"
+#include "tsTSFile.h"
+#include "tsOneShotPacketizer.h"
+#include "tsStandaloneTableDemux.h"
+#include "tsNIT.h"
+#include "tsSDT.h"
+#include "tsServiceListDescriptor.h"
+#include "tsDuckContext.h"
+#include "tsSysUtils.h"
+#include "tsNullReport.h"
+#include "tsCerrReport.h"
+#include "tsunit.h"
+TSDUCK_SOURCE;
+
+
+//----------------------------------------------------------------------------
+// The test fixture
+//----------------------------------------------------------------------------
+
+class TablePluginsTest: public tsunit::Test
+{
+public:
+    TablePluginsTest();
+
+    virtual void beforeTest() override;
+    virtual void afterTest() override;
+
+    void testNITCache();
+    void testNITServiceList();
+
+    TSUNIT_TEST_BEGIN(TablePluginsTest);
+    TSUNIT_TEST(testNITCache);
+    TSUNIT_TEST(testNITServiceList);
+    TSUNIT_TEST_END();
+
+private:
+    ts::UString _inFile;
+    ts::UString _outFile;
+
+    // Run the plugin "nit" on NIT v0, SDT, NIT v1 with the same content.
+    // Get the first and last NIT in the output.
+    void runNIT(const ts::UStringVector& args, ts::NIT& first, ts::NIT& last);
+};
+
+TSUNIT_REGISTER(TablePluginsTest);
+
+
+//----------------------------------------------------------------------------
+// Initialization.
+//----------------------------------------------------------------------------
+
+// Constructor.
+TablePluginsTest::TablePluginsTest() :
+    _inFile(),
+    _outFile()
+{
+}
+
+// Test suite initialization method.
+void TablePluginsTest::beforeTest()
+{
+    if (_inFile.empty()) {
+        _inFile = ts::TempFile(u".in.ts");
+        _outFile = ts::TempFile(u".out.ts");
+    }
+    ts::DeleteFile(_inFile);
+    ts::DeleteFile(_outFile);
+}
+
+// Test suite cleanup method.
+void TablePluginsTest::afterTest()
+{
+    ts::DeleteFile(_inFile);
+    ts::DeleteFile(_outFile);
+}
+
+
+//----------------------------------------------------------------------------
+// Use the loaded plugin "nit" in a processing chain.
+//----------------------------------------------------------------------------
+
+void TablePluginsTest::runNIT(const ts::UStringVector& args, ts::NIT& first, ts::NIT& last)
+{
+    ts::DuckContext duck;
+    const ts::TransportStreamId tsid(10, 1);
+
+    ts::NIT nit0(true, 0, true, 1);
+    nit0.transports[tsid];
+    ts::NIT nit1(nit0);
+    nit1.version = 1;
+
+    ts::SDT sdt(true, 0, true, tsid.transport_stream_id, tsid.original_network_id);
+    sdt.services[100].setType(0x01);
+
+    ts::BinaryTable bin_nit0, bin_nit1, bin_sdt;
+    nit0.serialize(duck, bin_nit0);
+    nit1.serialize(duck, bin_nit1);
+    sdt.serialize(duck, bin_sdt);
+
+    // Input file: NIT v0, SDT, NIT v1 (same content as v0), then repetitions of NIT v1.
+    ts::OneShotPacketizer nit_pzer(duck, ts::PID_NIT);
+    ts::OneShotPacketizer sdt_pzer(duck, ts::PID_SDT);
+    ts::TSPacketVector packets;
+    ts::TSFile file;
+    TSUNIT_ASSERT(file.open(_inFile, ts::TSFile::WRITE, CERR));
+    nit_pzer.addTable(bin_nit0);
+    nit_pzer.getPackets(packets);
+    TSUNIT_ASSERT(file.writePackets(packets.data(), nullptr, packets.size(), CERR));
+    sdt_pzer.addTable(bin_sdt);
+    sdt_pzer.getPackets(packets);
+    TSUNIT_ASSERT(file.writePackets(packets.data(), nullptr, packets.size(), CERR));
+    for (int i = 0; i < 10; ++i) {
+        nit_pzer.addTable(bin_nit1);
+        nit_pzer.getPackets(packets);
+        TSUNIT_ASSERT(file.writePackets(packets.data(), nullptr, packets.size(), CERR));
+    }
+    TSUNIT_ASSERT(file.close(CERR));
+
+    ts::TSProcessorArgs opt;
+    opt.app_name = u"TablePluginsTest::runNIT";
+    opt.input = {u"file", {_inFile}};
+    opt.plugins = {{u"nit", args}};
+    opt.output = {u"file", {_outFile}};
+
+    ts::TSProcessor tsproc(debugMode() ? *static_cast<ts::Report*>(&CERR) : *static_cast<ts::Report*>(&NULLREP));
+    TSUNIT_ASSERT(tsproc.start(opt));
+    tsproc.waitForTermination();
+
+    // Collect the successive versions of the NIT in the output file.
+    ts::StandaloneTableDemux demux(duck, ts::NoPID);
+    demux.addPID(ts::PID_NIT);
+    TSUNIT_ASSERT(file.openRead(_outFile, 0, CERR));
+    ts::TSPacket pkt;
+    while (file.readPackets(&pkt, nullptr, 1, CERR) == 1) {
+        demux.feedPacket(pkt);
+    }
+    TSUNIT_ASSERT(file.close(CERR));
+    TSUNIT_EQUAL(2, demux.tableCount());
+
+    first.deserialize(duck, *demux.tableAt(0));
+    TSUNIT_ASSERT(first.isValid());
+    last.deserialize(duck, *demux.tableAt(demux.tableCount() - 1));
+    TSUNIT_ASSERT(last.isValid());
+}
+
+
+//----------------------------------------------------------------------------
+// Unitary tests.
+//----------------------------------------------------------------------------
+
+// Without service list descriptors to build, the modified NIT depends on the input NIT only.
+// The new version of the NIT with an unchanged content gets the same modifications.
+void TablePluginsTest::testNITCache()
+{
+    ts::NIT first, last;
+    runNIT({u"--network-id", u"2"}, first, last);
+
+    TSUNIT_EQUAL(0, first.version);
+    TSUNIT_EQUAL(2, first.network_id);
+    TSUNIT_EQUAL(1, first.transports.size());
+
+    TSUNIT_EQUAL(1, last.version);
+    TSUNIT_EQUAL(2, last.network_id);
+    TSUNIT_EQUAL(1, last.transports.size());
+    TSUNIT_EQUAL(1, last.transports.count(ts::TransportStreamId(10, 1)));
+}
+
+// When building service list descriptors, the modified NIT also depends on the SDT.
+// The NIT v0 is processed before the SDT is received. The NIT v1 has the same content
+// but it must be processed again, now that the SDT is known.
+void TablePluginsTest::testNITServiceList()
+{
+    ts::NIT first, last;
+    runNIT({u"--build-service-list-descriptors"}, first, last);
+
+    TSUNIT_EQUAL(0, first.version);
+    TSUNIT_EQUAL(1, last.version);
+    TSUNIT_EQUAL(1, last.network_id);
+    TSUNIT_EQUAL(1, last.transports.size());
+
+    ts::DuckContext duck;
+    const ts::DescriptorList& dlist(last.transports.begin()->second.descs);
+    const size_t index = dlist.search(ts::DID_SERVICE_LIST);
+    TSUNIT_ASSERT(index < dlist.count());
+    const ts::ServiceListDescriptor sld(duck, *dlist[index]);
+    TSUNIT_ASSERT(sld.isValid());
+    TSUNIT_EQUAL(1, sld.entries.size());
+    TSUNIT_EQUAL(100, sld.entries.front().service_id);
+    TSUNIT_EQUAL(0x01, sld.entries.front().service_type);
+}
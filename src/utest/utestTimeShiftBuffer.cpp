@@ -33,6 +33,7 @@
 
 #include "tsTimeShiftBuffer.h"
 #include "tsCerrReport.h"
+#include "tsSysUtils.h"
 #include "tsunit.h"
 TSDUCK_SOURCE;
 
@@ -50,15 +51,17 @@ public:
     void testMinimum();
     void testMemory();
     void testFile();
+    void testSegments();
 
     TSUNIT_TEST_BEGIN(TimeShiftBufferTest);
     TSUNIT_TEST(testMinimum);
     TSUNIT_TEST(testMemory);
     TSUNIT_TEST(testFile);
+    TSUNIT_TEST(testSegments);
     TSUNIT_TEST_END();
 
 private:
-    void testCommon(uint8_t total, uint8_t memory);
+    void testCommon(uint8_t total, uint8_t memory, size_t segment = ts::TimeShiftBuffer::DEFAULT_SEGMENT_PACKETS, const ts::UString& directory = ts::UString());
 };
 
 TSUNIT_REGISTER(TimeShiftBufferTest);
@@ -83,10 +86,12 @@ void TimeShiftBufferTest::afterTest()
 // Unitary tests.
 //----------------------------------------------------------------------------
 
-void TimeShiftBufferTest::testCommon(uint8_t total, uint8_t memory)
+void TimeShiftBufferTest::testCommon(uint8_t total, uint8_t memory, size_t segment, const ts::UString& directory)
 {
     ts::TimeShiftBuffer buf(total);
     TSUNIT_ASSERT(buf.setMemoryPackets(memory));
+    TSUNIT_ASSERT(buf.setSegmentPackets(segment));
+    TSUNIT_ASSERT(buf.setBackupDirectory(directory));
     TSUNIT_ASSERT(!buf.isOpen());
     TSUNIT_ASSERT(buf.open(CERR));
     TSUNIT_ASSERT(buf.isOpen());
@@ -167,3 +172,16 @@ void TimeShiftBufferTest::testFile()
 {
     testCommon(20, 4);
 }
+
+void TimeShiftBufferTest::testSegments()
+{
+    // Small segment files, rotated several times. All files must be deleted on close.
+    const ts::UString dir(ts::TempFile(u""));
+    TSUNIT_EQUAL(ts::SYS_SUCCESS, ts::CreateDirectory(dir));
+    testCommon(80, 16, 16, dir);
+
+    ts::UStringVector files;
+    TSUNIT_ASSERT(ts::ExpandWildcard(files, dir + ts::PathSeparator + u"*"));
+    TSUNIT_ASSERT(files.empty());
+    TSUNIT_EQUAL(ts::SYS_SUCCESS, ts::DeleteFile(dir));
+}
@@ -33,6 +33,8 @@
 
 #include "tsxmlDocument.h"
 #include "tsxmlElement.h"
+#include "tsxmlPullParser.h"
+#include "tsxmlStreamWriter.h"
 #include "tsSectionFile.h"
 #include "tsTextFormatter.h"
 #include "tsCerrReport.h"
@@ -63,6 +65,9 @@ public:
     void testEscape();
     void testTweaks();
     void testChannels();
+    void testPullParser();
+    void testPullParserInvalid();
+    void testStreamWriter();
 
     TSUNIT_TEST_BEGIN(XMLTest);
     TSUNIT_TEST(testDocument);
@@ -74,6 +79,9 @@ public:
     TSUNIT_TEST(testEscape);
     TSUNIT_TEST(testTweaks);
     TSUNIT_TEST(testChannels);
+    TSUNIT_TEST(testPullParser);
+    TSUNIT_TEST(testPullParserInvalid);
+    TSUNIT_TEST(testStreamWriter);
     TSUNIT_TEST_END();
 
 private:
@@ -485,3 +493,116 @@ void XMLTest::testChannels()
     ts::xml::Document model(report());
     TSUNIT_ASSERT(model.load(TS_XML_TABLES_MODEL));
 }
+
+void XMLTest::testPullParser()
+{
+    const ts::UString text(
+        u"<?xml version='1.0' encoding='UTF-8'?>\n"
+        u"<root attr1=\"val1\">\n"
+        u"  <node1 a1=\"v1\">Text in node1</node1>\n"
+        u"  <!-- comment -->\n"
+        u"  <node2 a2=\"v2\">\n"
+        u"    <sub a3=\"v3\"/>\n"
+        u"  </node2>\n"
+        u"  <node3/>\n"
+        u"</root>\n"
+        u"<!-- trailing comment -->\n");
+
+    ts::xml::PullParser parser(report());
+    TSUNIT_ASSERT(parser.openText(text));
+    TSUNIT_ASSERT(parser.success());
+    TSUNIT_ASSERT(!parser.endOfDocument());
+
+    const ts::xml::Element* root = parser.rootElement();
+    TSUNIT_ASSERT(root != nullptr);
+    TSUNIT_EQUAL(u"root", root->name());
+    TSUNIT_EQUAL(u"val1", root->attribute(u"attr1").value());
+    TSUNIT_ASSERT(!root->hasChildren());
+
+    const ts::xml::Element* elem = parser.nextElement();
+    TSUNIT_ASSERT(elem != nullptr);
+    TSUNIT_EQUAL(u"node1", elem->name());
+    TSUNIT_EQUAL(3, elem->lineNumber());
+    TSUNIT_EQUAL(u"v1", elem->attribute(u"a1").value());
+    TSUNIT_EQUAL(u"Text in node1", elem->text());
+    TSUNIT_ASSERT(root->firstChildElement() == elem);
+
+    elem = parser.nextElement();
+    TSUNIT_ASSERT(elem != nullptr);
+    TSUNIT_EQUAL(u"node2", elem->name());
+    TSUNIT_EQUAL(5, elem->lineNumber());
+    TSUNIT_ASSERT(root->firstChildElement() == elem);
+    TSUNIT_ASSERT(root->firstChildElement()->nextSiblingElement() == nullptr);
+    const ts::xml::Element* sub = elem->firstChildElement();
+    TSUNIT_ASSERT(sub != nullptr);
+    TSUNIT_EQUAL(u"sub", sub->name());
+    TSUNIT_EQUAL(u"v3", sub->attribute(u"a3").value());
+
+    elem = parser.nextElement();
+    TSUNIT_ASSERT(elem != nullptr);
+    TSUNIT_EQUAL(u"node3", elem->name());
+
+    TSUNIT_ASSERT(parser.nextElement() == nullptr);
+    TSUNIT_ASSERT(parser.success());
+    TSUNIT_ASSERT(parser.endOfDocument());
+    TSUNIT_ASSERT(!root->hasChildren());
+}
+
+void XMLTest::testPullParserInvalid()
+{
+    ts::ReportBuffer<> rep;
+    ts::xml::PullParser parser(rep);
+    TSUNIT_ASSERT(parser.openText(
+        u"<?xml version='1.0' encoding='UTF-8'?>\n"
+        u"<root>\n"
+        u"  <node1/>\n"
+        u"  <node2>\n"
+        u"</root>\n"));
+
+    const ts::xml::Element* elem = parser.nextElement();
+    TSUNIT_ASSERT(elem != nullptr);
+    TSUNIT_EQUAL(u"node1", elem->name());
+    TSUNIT_ASSERT(parser.success());
+
+    TSUNIT_ASSERT(parser.nextElement() == nullptr);
+    TSUNIT_ASSERT(!parser.success());
+    TSUNIT_EQUAL(u"Error: line 5: parsing error, expected </node2> to match <node2> at line 4", rep.getMessages());
+}
+
+void XMLTest::testStreamWriter()
+{
+    // Build the reference document in memory.
+    ts::xml::Document doc(report());
+    ts::xml::Element* root = doc.initialize(u"root");
+    TSUNIT_ASSERT(root != nullptr);
+    root->setAttribute(u"attr1", u"val1");
+    for (int i = 0; i < 3; ++i) {
+        ts::xml::Element* node = root->addElement(u"node");
+        node->setIntAttribute(u"index", i);
+        node->addElement(u"sub")->addText(u"text");
+    }
+
+    // Write the same document element by element.
+    std::ostringstream strm;
+    ts::xml::StreamWriter writer(report());
+    TSUNIT_ASSERT(writer.open(strm, u"root"));
+    TSUNIT_ASSERT(writer.isOpen());
+    writer.rootElement()->setAttribute(u"attr1", u"val1");
+    for (int i = 0; i < 3; ++i) {
+        ts::xml::Element* node = writer.rootElement()->addElement(u"node");
+        node->setIntAttribute(u"index", i);
+        node->addElement(u"sub")->addText(u"text");
+        writer.flush();
+        TSUNIT_ASSERT(!writer.rootElement()->hasChildren());
+    }
+    writer.close();
+    TSUNIT_ASSERT(!writer.isOpen());
+
+    TSUNIT_EQUAL(doc.toString(), ts::UString::FromUTF8(strm.str()));
+
+    // Empty document.
+    std::ostringstream empty;
+    TSUNIT_ASSERT(writer.open(empty, u"root"));
+    writer.close();
+    TSUNIT_EQUAL(u"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root/>\n", ts::UString::FromUTF8(empty.str()));
+}